@@ -22,6 +22,9 @@ typedef struct {
     MSD_BOOL isOpen;//是否打开设备的标志
 }DeviceConfig;
 
+//交换机中断处理函数，在设备锁内被事件任务调用
+typedef MSD_STATUS (*EventHandler)(IN MSD_U8 devNum);
+
  /****************************************************************************************
   * @brief init_open_bus_interface 打开设备
   * @return
@@ -51,8 +54,30 @@ typedef struct {
   ****************************************************************************************/
  MSD_STATUS initStopCallAPI(IN MSD_U8 devNum);
 
+ /****************************************************************************************
+  * @brief initSetEventHandler 设置某个交换机中断的处理函数
+  * @param devNum
+  * @param cause Global Status寄存器中的中断位：MSD_VTU_PROB、MSD_ATU_PROB、MSD_TCAM_INT、
+  * MSD_STATS_DONE、MSD_DEVICE_INT、MSD_DEVICE2_INT、MSD_AVB_INT
+  * @param handler 处理函数，需要读取相应状态以清除中断源；为NULL时关闭该中断
+  * @return
+  * MSD_OK:success
+  * MSD_FAIL:fail
+  * MSD_BAD_PARAM:dev_num越界或不支持的cause
+  ****************************************************************************************/
+ MSD_STATUS initSetEventHandler(IN MSD_U8 devNum, IN MSD_U16 cause, IN EventHandler handler);
+
+ /****************************************************************************************
+  * @brief initNotifyEventFromISR 在交换机INTn引脚的中断服务函数中调用，唤醒事件任务
+  * 定义SWITCH_INTN_EIRQ(INTn所接的SIUL2 EIRQ通道)时apiInit.c自带该中断服务函数，
+  * 否则事件任务按EVENT_POLL_FALLBACK_MS周期轮询
+  * @param devNum
+  * @param higherPriorityTaskWoken 传给portYIELD_FROM_ISR
+  ****************************************************************************************/
+ void initNotifyEventFromISR(IN MSD_U8 devNum, OUT BaseType_t *higherPriorityTaskWoken);
+
  /*****************************************************************************************
-  * @brief init_close_device 关闭设备
+  * @brief init_close_device 关闭设备，停止MAC统计任务并删除事件任务
   *****************************************************************************************/
  void initCloseDevice(IN MSD_U8 devNum);
 
@@ -260,6 +260,24 @@ typedef struct {
   *************************************************************************************************************************************************/
  MSD_STATUS deviceFilterModuleClearFilters(IN MSD_U8 devNum);
 
+ /*************************************************************************************************************************************************
+  * @brief deviceFilterModuleDefragTcam 整理过滤器使用的TCAM条目
+  * TCAM从下标号小的条目开始匹配，过滤器编号越小优先级越高。整理后所有过滤器按编号从条目0开始连续排列，空闲条目都在最后。
+  * 添加过滤器时如果前后过滤器之间没有足够的条目会自动整理，该接口用于手动整理。
+  * 移动时先写入新的条目再删除原来的条目，移动过程中过滤器一直有效，失败时移动中的过滤器恢复到原来的条目。
+  * 被占位的过滤器只会临时放到编号比它小的过滤器之后、编号比它大的过滤器之前的空闲条目(优先使用条目128 ~ 199)，整理过程中一直按编号的优先级匹配。
+  * 目标位置被过滤器自己占用且没有临时位置时，该过滤器保留在原来的条目
+  * @param dev_num 设备编号
+  * @param moveCount 移动的TCAM条目个数
+  * @return
+  *  MSD_OK - on success.
+  *  MSD_FAIL - on error.
+  *  MSD_NO_SPACE - 不改变过滤器之间的先后顺序时没有足够的临时条目用于移动，不移动任何条目
+  *  MSD_FEATRUE_NOT_ALLOW - 没有开启过滤器功能
+  *  MSD_BAD_PARAM - if invalid parameter is given
+  *************************************************************************************************************************************************/
+ MSD_STATUS deviceFilterModuleDefragTcam(IN MSD_U8 devNum, OUT int *moveCount);
+
 
  /*************************************************************************************************************************************************
  * @brief device_filter_module_find_filter_by_filter_num
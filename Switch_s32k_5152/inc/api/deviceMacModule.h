@@ -33,6 +33,9 @@ typedef enum {
 #define  MAX_STATIC_ATU_ENTRIES   64   //交换机可以存储的最大静态ATU条目个数
 #define  MAX_AUTO_ATU_ENTRIES  4096   //在没有静态ATU条目的情况下，交换机最多可以存储的动态ATU条目个数，Function 2.10.3.1中描述
 
+//定义后内存中只保存静态MAC条目(节省约40KB SRAM)，动态条目不再缓存，deviceAtuModuleGetAllVidAutoEntriesFromConfiguration直接从交换机读取
+//#define  ATU_SHADOW_STATIC_ONLY
+
 #define MAX_FID_VALUE   4095
 
 #define  ALL_FID_VALUE  -1  //ATU操作全部FID
@@ -74,6 +77,96 @@ typedef struct {
     MSD_U8 staticMacEntryCount;//static_mac_entry的实际个数
 }AtuConfiguration;
 
+/**
+ * 应用静态MAC配置时下发到交换机的操作个数
+ */
+typedef struct {
+    MSD_U32 addCount;//新增的静态条目
+    MSD_U32 deleteCount;//删除的静态条目
+    MSD_U32 modifyCount;//端口改变的静态条目
+    MSD_BOOL isFullRewrite;//交换机中的静态条目太多，清空后重新添加了所有条目，deleteCount为内存中的静态条目数
+    MSD_U32 sweepCount;//内存中有但交换机中已经不存在的静态条目，从内存中删除的个数
+    MSD_U32 getNextOps;//读取交换机中的静态条目以及查找条目下发的GetNext操作个数
+    MSD_U32 dumpFrames;//使用RMU时读取ATU表的dump帧数
+}AtuApplyStats;
+
+/**
+ * 清空静态MAC条目时下发到交换机的ATU操作个数
+ */
+typedef struct {
+    MSD_U32 fidCount;//处理的FID个数
+    MSD_U32 skippedFids;//根据条目计数跳过的FID(没有条目或者没有静态条目)
+    MSD_U32 walkedFids;//有静态条目，遍历逐条删除的FID
+    MSD_U32 countReads;//读取FID条目计数的次数，每次读取每个统计bin各需要一次ATU操作
+    MSD_U32 getNextOps;//遍历的GetNext操作个数
+    MSD_U32 deleteOps;//逐条删除的操作个数
+    MSD_U32 deletedEntries;//删除的静态条目个数
+}AtuFlushStats;
+
+#define  ATU_PORT_LEARN_LIMIT_MAX  1023  //端口学习个数的硬件上限(Port ATU Control寄存器的LearnLimit字段)
+#define  ATU_LEARN_POLICY_HEADROOM  16  //再平衡时在端口当前学习个数之上预留的余量，也是预算每次恢复的步长
+#define  ATU_LEARN_POLICY_INTERVAL_MS  5000  //事件任务中周期再平衡的间隔
+
+/**
+ * 端口学习个数的分配策略：受管理的端口从总预算中分配交换机的学习上限，
+ * 学满的端口在再平衡时从空闲预算中增加上限，ATU满时缩小预算并清空超出最多的端口的动态条目
+ */
+typedef struct {
+    MSD_BOOL isEnable;//是否启用
+    MSD_U16 totalBudget;//受管理端口的学习上限之和的最大值，0为MAX_AUTO_ATU_ENTRIES - MAX_STATIC_ATU_ENTRIES
+    MSD_U16 minLimit[MSD_MAX_SWITCH_PORTS];//端口保证的学习个数，0代表该端口不受管理(不限制学习，如上联口和CPU口)
+    MSD_U16 maxLimit[MSD_MAX_SWITCH_PORTS];//端口最多的学习个数，不超过ATU_PORT_LEARN_LIMIT_MAX，小于minLimit时按minLimit
+}AtuLearnPolicy;
+
+/**
+ * 学习策略的运行状态
+ */
+typedef struct {
+    MSD_U16 limit[MSD_MAX_SWITCH_PORTS];//当前写入交换机的学习上限，0为不限制
+    MSD_U16 learnCount[MSD_MAX_SWITCH_PORTS];//最近一次再平衡读取的学习个数，不受管理的端口交换机不计数
+    MSD_U16 budget;//当前生效的总预算，ATU满之后缩小，之后每次再平衡恢复ATU_LEARN_POLICY_HEADROOM
+    MSD_U32 rebalanceCount;//再平衡次数
+    MSD_U32 fullViolations;//处理的ATU full violation个数
+    MSD_U32 quarantineCount;//因为ATU满清空端口动态条目的次数
+    MSD_U8  lastQuarantinePort;//最近一次被清空动态条目的端口
+    MSD_U32 shadowDrops;//内存中没有空闲位置而没有保存的动态条目个数
+}AtuLearnPolicyStatus;
+
+#define  ATU_ITERATOR_ALL_PORTS  0  //迭代器不按端口过滤
+
+/**
+ * ATU迭代器，保存(FID,上一个MAC)游标，由调用者分配，不占用堆空间
+ */
+typedef struct {
+    MSD_U8  devNum;
+    MSD_U8  entryType;//AtuEntryType
+    MSD_U8  state;//0-开始一个FID，1-FID中，2-结束
+    MSD_U8  reserved;
+    MSD_U16 vid;//只迭代该VID(FID)的条目，MAX_FID_VALUE+1为迭代所有FID
+    MSD_U16 fid;//当前FID
+    MSD_U32 portVec;//条目的portVec和它有交集时才返回，ATU_ITERATOR_ALL_PORTS为不过滤
+    MSD_ETHERADDR lastMac;//当前FID中最后读取的MAC
+}AtuIterator;
+
+/**
+ * @brief AtuChangeType 内存中MAC条目的变更类型
+ */
+typedef enum {
+    ATU_CHANGE_ADD = 1,/* 1-新增条目 */
+    ATU_CHANGE_MOVE = 2,/* 2-条目的端口改变 */
+    ATU_CHANGE_AGE_OUT = 3,/* 3-动态条目老化，刷新时交换机中已经不存在 */
+    ATU_CHANGE_DELETE = 4,/* 4-条目被删除 */
+}AtuChangeType;
+
+/**
+ * 一次MAC条目的变更
+ */
+typedef struct {
+    MSD_U32 generation;//变更对应的generation
+    AtuChangeType changeType;//变更类型
+    MacEntry entry;//变更之后的条目，删除和老化时为删除之前的条目
+}AtuChange;
+
 /********************************************************************************
   * @brief device_atu_module_set_fid
   * 设置MAC条目使用的FID，如果FID设置为ALL_FID_VALUE，则可以使用多FID（默认值），
@@ -392,8 +485,227 @@ typedef struct {
   * MSD_BAD_PARAM - If invalid parameter is given
   * MSD_NOT_SUPPORTED - Device not support</returns>
   **************************************************************************************************/
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleFlushStaticEntries
+  * 清空静态MAC条目，每个FID先读取条目计数：跳过没有静态条目的FID，其余FID遍历逐条删除静态条目，
+  * 动态条目(包括清空过程中新学习的条目)保留
+  * deviceAtuModuleFlushEntries(MSD_FLUSH_ALL_STATIC)使用该接口，操作个数可以用deviceAtuModuleGetLastFlushStats读取
+  * @param devNum
+  * @param fid 要清空的FID，ALL_FID_VALUE为所有有MAC条目的FID
+  * @param stats 下发的ATU操作个数，可以为NULL
+  * @return
+  * MSD_OK - On success
+  * MSD_FAIL - On error
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleFlushStaticEntries(IN MSD_U8 devNum, IN int fid, OUT AtuFlushStats* stats);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleGetLastFlushStats
+  * 读取最近一次清空静态MAC条目下发的ATU操作个数
+  * @param devNum
+  * @param stats
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleGetLastFlushStats(IN MSD_U8 devNum, OUT AtuFlushStats* stats);
+
  MSD_STATUS deviceAtuModuleSaveAtuConfiguration(IN MSD_U8 devNum);
 
+ /**************************************************************************************************
+  * @brief deviceAtuModuleApplyStaticConfiguration
+  * 比较配置中的静态条目和交换机中的静态条目，只删除配置中没有的条目，修改端口不同的条目，添加交换机中没有的条目，
+  * 没有变化的条目不会被重新写入，转发不会中断。交换机中已经不存在的静态条目同时从内存中删除
+  * @param devNum
+  * @param stats 下发的操作个数，可以为NULL
+  * @return
+  * MSD_OK - On success
+  * MSD_FAIL - On error
+  * MSD_BAD_PARAM - If invalid parameter is given
+  * MSD_NO_SPACE - malloc memory space failed.
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleApplyStaticConfiguration(IN MSD_U8 devNum, OUT AtuApplyStats* stats);
+
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleGetGeneration
+  * 获取内存中MAC条目的当前generation，每次条目新增，端口改变，老化和删除都会加1
+  * 定义ATU_SHADOW_STATIC_ONLY时只记录静态条目的变更
+  * @param devNum 设备编号
+  * @param generation 当前的generation
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleGetGeneration(IN MSD_U8 devNum, OUT MSD_U32* generation);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleGetChangesSince
+  * 获取generation之后的MAC条目变更，按generation从旧到新排列。调用者保存lastGeneration，下次从它开始获取
+  * 变更记录只保存最近的变更，如果需要的变更已经被覆盖，needResync为MSD_TRUE，调用者需要重新获取全部条目，
+  * 然后从lastGeneration(当前generation)开始获取变更
+  * @param devNum 设备编号
+  * @param generation 已经同步到的generation，第一次调用时使用deviceAtuModuleGetGeneration获取
+  * @param changes 存储变更
+  * @param changeMaxSize changes的最大可存储个数
+  * @param changeCount 获取到的变更个数，等于changeMaxSize时可能还有变更没有获取
+  * @param lastGeneration 已经获取到的最后一个generation
+  * @param needResync 是否需要重新获取全部条目
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleGetChangesSince(IN MSD_U8 devNum, IN MSD_U32 generation, OUT AtuChange* changes, IN int changeMaxSize,
+     OUT int* changeCount, OUT MSD_U32* lastGeneration, OUT MSD_BOOL* needResync);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleGetEntryGeneration
+  * 获取内存中一个MAC条目最后一次变更的generation，由变更记录得到；
+  * 条目最后一次变更早于最近ATU_CHANGE_JOURNAL_SIZE次变更时，返回不小于实际值的generation
+  * @param devNum 设备编号
+  * @param address MAC地址
+  * @param vid 条目对应的VID
+  * @param isStatic 是否是静态条目
+  * @param generation 条目最后一次变更的generation
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  * MSD_NO_SUCH - 内存中没有该条目
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleGetEntryGeneration(IN MSD_U8 devNum, IN MSD_ETHERADDR address, IN MSD_U16 vid, IN MSD_BOOL isStatic, OUT MSD_U32* generation);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleIteratorOpen
+  * 打开一个ATU迭代器，之后用deviceAtuModuleIteratorNext分批读取条目，用于在固定内存中遍历任意大小的ATU表
+  * @param devNum 设备编号
+  * @param iterator 迭代器
+  * @param entryType 要获取的条目类型
+  * @param vid 只获取该VID(FID)的条目，ALL_FID_VALUE为获取所有FID的条目
+  * @param portVec 只获取portVec有交集的条目，ATU_ITERATOR_ALL_PORTS为获取所有端口的条目
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleIteratorOpen(IN MSD_U8 devNum, OUT AtuIterator* iterator, IN AtuEntryType entryType, IN int vid, IN MSD_U32 portVec);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleIteratorNext
+  * 从游标处继续读取最多atuEntryMaxSize个条目，两次调用之间ATU表可以变化，游标按MAC顺序继续
+  * @param iterator 迭代器
+  * @param atuEntries 存储条目
+  * @param atuEntryMaxSize atuEntries的最大可存储个数
+  * @param atuEntryCount 读取到的条目个数
+  * @param isEnd 是否已经读取完所有条目
+  * @return
+  * MSD_OK - On success
+  * MSD_FAIL - On error，可以再次调用从游标处重试
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleIteratorNext(INOUT AtuIterator* iterator, OUT MSD_ATU_ENTRY* atuEntries, IN int atuEntryMaxSize,
+     OUT int* atuEntryCount, OUT MSD_BOOL* isEnd);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleIteratorClose
+  * 关闭ATU迭代器，之后deviceAtuModuleIteratorNext不再返回条目
+  * @param iterator 迭代器
+  **************************************************************************************************/
+ void deviceAtuModuleIteratorClose(INOUT AtuIterator* iterator);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleCheckConsistency
+  * 检查内存中MAC条目的索引：沿每个VID的条目链表重新计数，和增量维护的有MAC条目的VID个数以及条目总数比较，
+  * 并检查VID链表头表的每一项都能由其VID找到，不一致时打印错误信息。用于调试
+  * @param devNum 设备编号
+  * @return
+  * MSD_OK - 一致
+  * MSD_FAIL - 不一致
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleCheckConsistency(IN MSD_U8 devNum);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleSetMacEntryVidFlagAndSize
+  * VID是否还有MAC条目，由内存中该VID的条目链表是否为空决定，VLAN模块删除VTU条目之前调用
+  * @param devNum 设备编号
+  * @param vidNum vid
+  * @param flag MSD_FALSE:询问是否可以删除该VID的VTU条目
+  * @return
+  * MSD_TRUE - flag为MSD_TRUE，或者该VID没有MAC条目
+  * MSD_FALSE - 该VID还有MAC条目
+  **************************************************************************************************/
+ MSD_BOOL deviceAtuModuleSetMacEntryVidFlagAndSize(IN MSD_U8 devNum, IN MSD_U16 vidNum, IN MSD_BOOL flag);
+
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleSetLearnPolicy
+  * 设置端口学习个数的分配策略并写入交换机。端口开始受管理时按照交换机的要求先关闭该端口的学习，
+  * 清空该端口的动态条目(内存中同步删除)，设置上限之后再打开学习；不再受管理的端口上限设置为0
+  * @param devNum 设备编号
+  * @param policy 策略，受管理端口的minLimit之和不能超过totalBudget
+  * @return
+  * MSD_OK - On success
+  * MSD_FAIL - On error
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleSetLearnPolicy(IN MSD_U8 devNum, IN const AtuLearnPolicy* policy);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleGetLearnPolicy 获取端口学习个数的分配策略
+  * @param devNum 设备编号
+  * @param policy
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleGetLearnPolicy(IN MSD_U8 devNum, OUT AtuLearnPolicy* policy);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleGetLearnPolicyStatus 获取学习策略的运行状态
+  * @param devNum 设备编号
+  * @param status
+  * @return
+  * MSD_OK - On success
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleGetLearnPolicyStatus(IN MSD_U8 devNum, OUT AtuLearnPolicyStatus* status);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleLearnPolicyRebalance
+  * 读取受管理端口的学习个数重新分配上限：每个端口先分配minLimit，剩余预算按
+  * (学习个数 + ATU_LEARN_POLICY_HEADROOM)超出minLimit的部分按比例分配，不超过maxLimit
+  * @param devNum 设备编号
+  * @return
+  * MSD_OK - On success，没有启用策略时不做任何操作
+  * MSD_FAIL - On error
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleLearnPolicyRebalance(IN MSD_U8 devNum);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleLearnPolicyPoll
+  * 由事件任务在设备锁内每次唤醒时调用，距离上次再平衡超过ATU_LEARN_POLICY_INTERVAL_MS时再平衡
+  * @param devNum 设备编号
+  * @return
+  * MSD_OK - On success
+  * MSD_FAIL - On error
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleLearnPolicyPoll(IN MSD_U8 devNum);
+
+ /**************************************************************************************************
+  * @brief deviceAtuModuleLearnPolicyHandleViolation
+  * 由ATU中断处理函数调用。ATU full violation时把预算缩小到受管理端口当前学习个数之和的7/8(不小于minLimit之和)
+  * 并再平衡，然后清空学习个数超出新上限最多的端口的动态条目，其他端口的条目保留
+  * @param devNum 设备编号
+  * @param atuIntStatus msdFdbViolationGet读取的violation
+  * @return
+  * MSD_OK - On success
+  * MSD_FAIL - On error
+  * MSD_BAD_PARAM - If invalid parameter is given
+  **************************************************************************************************/
+ MSD_STATUS deviceAtuModuleLearnPolicyHandleViolation(IN MSD_U8 devNum, IN const MSD_ATU_INT_STATUS* atuIntStatus);
 
 ////EES 交换机API相关类型的接口 end
 
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "umsdUtil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define  MAC_TELEMETRY_HISTORY_SIZE  64   //保存的采样个数，环形缓冲区
+#define  MAC_TELEMETRY_FLAP_TABLE_SIZE  16   //跟踪端口切换的MAC地址个数，满时替换最久没有出现的地址
+
+#define  MAC_TELEMETRY_DEFAULT_INTERVAL_MS  1000  //默认采样周期
+#define  MAC_TELEMETRY_DEFAULT_FLAP_WINDOW_MS  10000  //默认MAC漂移的判定窗口
+#define  MAC_TELEMETRY_DEFAULT_FLAP_THRESHOLD  3  //默认窗口内端口切换次数达到该值判定为MAC漂移
+
+/**
+ * @brief MAC学习统计的配置
+ */
+typedef struct {
+    MSD_U32 intervalMs;//采样周期(ms)，0使用默认值
+    MSD_U32 flapWindowMs;//MAC漂移的判定窗口(ms)，0使用默认值
+    MSD_U32 flapThreshold;//窗口内端口切换次数达到该值判定为MAC漂移，0使用默认值
+}MacTelemetryConfig;
+
+/**
+ * @brief 一次采样，读取交换机的ATU条目计数和各端口的学习计数
+ */
+typedef struct {
+    MSD_U32 timestamp;//采样时间(ms，从系统启动开始)
+    MSD_U16 entryCount;//ATU有效条目个数
+    MSD_U16 nonStaticCount;//ATU动态条目个数
+    MSD_U16 learnCount[MSD_MAX_SWITCH_PORTS];//各端口当前学习到的动态条目个数，学习上限为0的端口交换机不计数(见deviceAtuModuleSetLearnPolicy)
+}MacTelemetrySample;
+
+/**
+ * @brief 端口的学习统计
+ */
+typedef struct {
+    MSD_U16 learnCount;//最近一次采样的学习计数
+    MSD_U16 learnRate;//历史窗口内平均每分钟新学习的条目个数
+    MSD_U32 learnedTotal;//开始统计以来学习计数增加的总数
+    MSD_U32 removedTotal;//开始统计以来学习计数减少的总数(老化，刷新或者迁移到其他端口)
+    MSD_U32 memberViolations;//该端口上的ATU member violation个数
+    MSD_U32 ageOutViolations;//该端口上的ATU age out violation个数
+}MacTelemetryPortStats;
+
+/**
+ * @brief MAC学习统计的汇总
+ * 采样开销的单位为msdTimeStamp的单位:开启OsIf系统定时器时为定时器计数，否则为FreeRTOS tick
+ */
+typedef struct {
+    MacTelemetryConfig config;//当前配置
+    MSD_BOOL isRunning;//是否正在采样
+    MSD_U32 sampleCount;//开始统计以来的采样次数
+    MSD_U32 skippedSamples;//因为设备被占用或者读取失败跳过的采样次数
+    MSD_U32 lastSampleCost;//最近一次采样的开销
+    MSD_U32 maxSampleCost;//最大的采样开销
+    MSD_U32 avgSampleCost;//平均的采样开销
+    MSD_U16 entryCount;//最近一次采样的ATU有效条目个数
+    MSD_U16 nonStaticCount;//最近一次采样的ATU动态条目个数
+    MSD_U8 portCount;//端口个数，ports中有效的个数
+    MacTelemetryPortStats ports[MSD_MAX_SWITCH_PORTS];
+    MSD_U32 memberViolations;//ATU violation的个数，按原因分类
+    MSD_U32 missViolations;
+    MSD_U32 fullViolations;
+    MSD_U32 ageOutViolations;
+    MSD_U32 moveCount;//检测到的MAC地址端口切换次数
+    MSD_U32 flapEvents;//判定为MAC漂移的次数
+}MacTelemetryStatus;
+
+/**
+ * @brief 一个被跟踪端口切换的MAC地址
+ */
+typedef struct {
+    MSD_ETHERADDR macAddr;
+    MSD_U16 fid;
+    MSD_U8 lastPort;//最近一次出现的端口
+    MSD_BOOL isFlapping;//是否判定为MAC漂移
+    MSD_U16 portVec;//判定窗口内出现过的端口
+    MSD_U16 moveCount;//判定窗口内的端口切换次数
+    MSD_U32 windowStart;//判定窗口的开始时间(ms)
+    MSD_U32 lastSeen;//最近一次出现的时间(ms)
+}MacFlapEntry;
+
+/*****************************************************************************************************************
+ * @brief deviceMacTelemetryModuleStart
+ * 开始MAC学习统计：创建采样任务，按周期读取ATU条目计数和各端口的学习计数，保存到环形缓冲区。
+ * 重复调用时使用新的配置并清空之前的统计
+ * @param devNum
+ * @param config 配置，为NULL时使用默认配置
+ * @return
+ * MSD_OK - On success
+ * MSD_FAIL - On error
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceMacTelemetryModuleStart(IN MSD_U8 devNum, IN const MacTelemetryConfig* config);
+
+/*****************************************************************************************************************
+ * @brief deviceMacTelemetryModuleStop 停止采样并删除采样任务，已有的统计保留
+ * initCloseDevice在删除设备锁之前调用
+ * @param devNum
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceMacTelemetryModuleStop(IN MSD_U8 devNum);
+
+/*****************************************************************************************************************
+ * @brief deviceMacTelemetryModuleRecordViolation
+ * 记录一次ATU violation，在ATU中断处理函数中读取violation之后调用。
+ * member violation表示MAC地址出现在条目端口向量以外的端口上(静态条目或者锁定的端口)，用于检测MAC漂移
+ * @param devNum
+ * @param atuIntStatus msdFdbViolationGet读取的violation
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceMacTelemetryModuleRecordViolation(IN MSD_U8 devNum, IN const MSD_ATU_INT_STATUS* atuIntStatus);
+
+/*****************************************************************************************************************
+ * @brief deviceMacTelemetryModuleGetStatus 获取MAC学习统计的汇总
+ * @param devNum
+ * @param status
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceMacTelemetryModuleGetStatus(IN MSD_U8 devNum, OUT MacTelemetryStatus* status);
+
+/*****************************************************************************************************************
+ * @brief deviceMacTelemetryModuleGetHistory 获取保存的采样，按时间从旧到新
+ * @param devNum
+ * @param samples
+ * @param samplesMaxSize samples的大小，最多MAC_TELEMETRY_HISTORY_SIZE个
+ * @param samplesCount 获取到的个数
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceMacTelemetryModuleGetHistory(IN MSD_U8 devNum, OUT MacTelemetrySample* samples, IN int samplesMaxSize, OUT int* samplesCount);
+
+/*****************************************************************************************************************
+ * @brief deviceMacTelemetryModuleGetFlaps 获取被跟踪端口切换的MAC地址，判定窗口之外的地址不再标记为漂移
+ * @param devNum
+ * @param entries
+ * @param entriesMaxSize entries的大小，最多MAC_TELEMETRY_FLAP_TABLE_SIZE个
+ * @param entriesCount 获取到的个数
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceMacTelemetryModuleGetFlaps(IN MSD_U8 devNum, OUT MacFlapEntry* entries, IN int entriesMaxSize, OUT int* entriesCount);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "umsdUtil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define  TCAM_MODULE_ENTRY_NUM   512 //IngressTCAM的条目个数(Fir为512)
+#define  TCAM_MODULE_OWNER_ID_MAX  0xFFF //所有者编号的最大值(过滤器编号或者VID)
+#define  TCAM_MODULE_QINQ_START  200 //QinQ VLAN使用的第一个条目，之前的条目用于过滤器
+
+/**
+ * @brief IngressTCAM条目的所有者
+ * TCAM查询时从下标号小的开始匹配，因此过滤器使用小的下标号，QinQ VLAN使用固定的下标号(200 ~ 265)
+ */
+typedef enum {
+    TCAM_OWNER_FREE = 0, //没有使用
+    TCAM_OWNER_FILTER, //过滤器，所有者编号为过滤器编号
+    TCAM_OWNER_QINQ, //QinQ VLAN的出口处理，所有者编号为VID(无标签帧的条目为0)
+    TCAM_OWNER_UNKNOWN, //初始化时交换机中已经存在，但是不知道所有者的条目
+    TCAM_OWNER_TYPE_NUM
+}TcamOwnerType;
+
+/**
+ * @brief IngressTCAM条目的使用情况
+ */
+typedef struct {
+    MSD_U16 usedCount;//已使用的条目个数
+    MSD_U16 ownerCount[TCAM_OWNER_TYPE_NUM];//按所有者统计的条目个数，ownerCount[TCAM_OWNER_FREE]为没有使用的条目个数
+    MSD_U16 largestFreeRange;//最大的连续未使用条目个数
+    MSD_U32 allocCount;//分配成功的次数
+    MSD_U32 allocFailCount;//因为没有足够的条目分配失败的次数
+    MSD_U32 rebuildOps;//初始化时从交换机重建分配表使用的TCAM操作次数
+}TcamUsage;
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleInitialTcamInfo
+ * 从交换机重建IngressTCAM的分配表，仅在设备初始化时调用一次。
+ * 使用TCAM的Get Next操作只读取有效的条目，已存在的条目标记为TCAM_OWNER_UNKNOWN。
+ * 之后的分配和释放都只修改内存中的分配表，不再读取交换机
+ * @param devNum
+ * @return
+ * MSD_OK - On success
+ * MSD_FAIL - On error
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleInitialTcamInfo(IN MSD_U8 devNum);
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleReset 将所有条目标记为未使用，在msdTcamAllDelete之后调用
+ * @param devNum
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleReset(IN MSD_U8 devNum);
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleAllocEntries
+ * 在[start, end)范围内分配count个条目，优先分配下标号最小的连续条目，没有足够的连续条目时从小到大分配不连续的条目。
+ * 分配的条目按下标号从小到大保存在pointers中
+ * @param devNum
+ * @param ownerType 所有者
+ * @param ownerId 所有者编号，最大为TCAM_MODULE_OWNER_ID_MAX
+ * @param start 范围的开始下标号
+ * @param end 范围的结束下标号(不包含)，最大为TCAM_MODULE_ENTRY_NUM
+ * @param count 需要的条目个数
+ * @param pointers 分配的条目
+ * @return
+ * MSD_OK - On success
+ * MSD_NO_SPACE - 范围内没有足够的未使用条目
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleAllocEntries(IN MSD_U8 devNum, IN TcamOwnerType ownerType, IN MSD_U16 ownerId,
+                                        IN MSD_U32 start, IN MSD_U32 end, IN int count, OUT MSD_U32* pointers);
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleReserveEntry
+ * 将固定下标号的条目标记为已使用(QinQ VLAN使用固定的下标号)。条目已经属于同一种所有者时替换所有者编号
+ * @param devNum
+ * @param pointer 条目下标号
+ * @param ownerType 所有者
+ * @param ownerId 所有者编号
+ * @return
+ * MSD_OK - On success
+ * MSD_ALREADY_EXIST - 条目已经属于其他的所有者
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleReserveEntry(IN MSD_U8 devNum, IN MSD_U32 pointer, IN TcamOwnerType ownerType, IN MSD_U16 ownerId);
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleFreeEntries 将条目标记为未使用，在msdTcamEntryDelete之后调用
+ * @param devNum
+ * @param pointers 条目下标号
+ * @param count pointers的个数
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleFreeEntries(IN MSD_U8 devNum, IN const MSD_U32* pointers, IN int count);
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleGetOwner 获取条目的所有者，不读取交换机
+ * @param devNum
+ * @param pointer 条目下标号
+ * @param ownerType 所有者，未使用时为TCAM_OWNER_FREE
+ * @param ownerId 所有者编号
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleGetOwner(IN MSD_U8 devNum, IN MSD_U32 pointer, OUT TcamOwnerType* ownerType, OUT MSD_U16* ownerId);
+
+/*****************************************************************************************************************
+ * @brief deviceTcamModuleGetUsage 获取IngressTCAM条目的使用情况
+ * @param devNum
+ * @param usage
+ * @return
+ * MSD_OK - On success
+ * MSD_BAD_PARAM - If invalid parameter is given
+ *****************************************************************************************************************/
+MSD_STATUS deviceTcamModuleGetUsage(IN MSD_U8 devNum, OUT TcamUsage* usage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,12 +8,25 @@ extern "C" {
 
 #define ALL_PORT_PARAM  -1   //代表所有端口
 #define ALL_VLAN_PAGE_PARMA -1 //include vlan  page 0 and page 1
-#define ALLOW_OPERATION_MAX_VLAN_NUM  64  //可以最多设置出口端口的64个VID的出口方式（不是其成员，Unmodified,Tagged, UnTagged），但是不是说一个端口仅仅只能允许64个VID的帧可以从这个端口出口。
+//可以最多设置出口方式（不是其成员，Unmodified,Tagged, UnTagged）的VID个数，即VID记录池的大小，但是不是说一个端口仅仅只能允许这些VID的帧可以从这个端口出口。
+//每个VID记录8个字节，每个VlanMemberTagAndEgressModeInfo另外固定使用约0.9KB(VID位图和索引)，模块中有2份(交换机中的设置和配置):
+//64个VID约1.4KB，512个VID约4.9KB，4096个VID约33KB。QinQ模式下有端口Untagged出口的VID最多64个(见QinQ的IngressTCAM范围)
+#ifndef ALLOW_OPERATION_MAX_VLAN_NUM
+#define ALLOW_OPERATION_MAX_VLAN_NUM  512
+#endif
 #define UNVALID_VID -1  //无效的VID
 #define PORT_DISABLE_VLAN_VID 1//
 #define PORT_DEFAULT_VID  2   //默认VID 也是允许操作的最小VID
 #define MAX_OPERATION_VID 4095 //允许操作的最大VID
 #define MAX_VID_VALUE   4096
+#define VLAN_VID_BITMAP_WORDS  (MAX_VID_VALUE / 32) //VID位图的字数，每个VID一位
+
+#if MSD_MAX_SWITCH_PORTS > 16
+#error "VlanPerInfo.memberTags only holds 16 ports"
+#endif
+//获取和设置VlanPerInfo.memberTags中端口的memberTag，每个端口2位
+#define VLAN_MEMBER_TAG_GET(TAGS,PORT)  ((MSD_PORT_MEMBER_TAG)(((TAGS) >> ((PORT) * 2)) & 0x3))
+#define VLAN_MEMBER_TAG_SET(TAGS,PORT,TAG)  ((TAGS) = ((TAGS) & ~((MSD_U32)0x3 << ((PORT) * 2))) | (((MSD_U32)(TAG) & 0x3) << ((PORT) * 2)))
 
 
 /**
@@ -47,9 +60,9 @@ typedef struct {
  * @brief 每个vid的描述
  */
 typedef struct{
-    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];/* 所有端口的memberTag */
-    MSD_16 vid;/* vid,如果大于等于0，代表有效，-1为无效VID，使用-1代表无效的VTU条目，由于可能频繁的删除和添加，使用-1可以消除数组频繁的移动操作。*/
-    MSD_BOOL isShow;/*是否前端显示，如果是通过MAC条目添加的VTU条目，不是由VLAN功能主动添加的，不会显示出来，或者本来被VLAN添加了，但是后续又被VLAN操作删除了，但MAC条目需要该条目*/
+    MSD_U32 memberTags;/* 所有端口的memberTag，每个端口2位，使用VLAN_MEMBER_TAG_GET和VLAN_MEMBER_TAG_SET访问 */
+    MSD_U16 vid;/* vid */
+    MSD_U8 isShow;/*是否前端显示，如果是通过MAC条目添加的VTU条目，不是由VLAN功能主动添加的，不会显示出来，或者本来被VLAN添加了，但是后续又被VLAN操作删除了，但MAC条目需要该条目*/
 }VlanPerInfo;
 
 /**
@@ -62,10 +75,15 @@ typedef struct {
 
 /**
  * @brief  EES交换机的方式实现VLAN功能的结构
+ * VID记录按VID从小到大连续保存在vidInfo的前vidInfoSize个下标中，vidBits记录VID是否存在，
+ * VID的下标为rankBase[VID / 32]加上vidBits[VID / 32]中比VID小的位的个数，查询不需要遍历vidInfo。
+ * 使用deviceVlanModuleVlanTableXxx接口修改，不要直接修改vidInfo
  */
 typedef struct {
     VlanPerPortVlanInfo portVlanInfo[MSD_MAX_SWITCH_PORTS];/*与端口相关的VLAN信息描述， 实际个数由交换机的Port数决定。序号和端口号一一对应，即下标为0的代表端口号0 */
-    VlanPerInfo vidInfo[ALLOW_OPERATION_MAX_VLAN_NUM];/* 每个VID的描述 */
+    MSD_U32 vidBits[VLAN_VID_BITMAP_WORDS];/* VID是否存在，每个VID一位 */
+    MSD_U16 rankBase[VLAN_VID_BITMAP_WORDS];/* rankBase[i]为vidBits[0] ~ vidBits[i - 1]中VID的个数，即vidBits[i]中第一个VID的下标 */
+    VlanPerInfo vidInfo[ALLOW_OPERATION_MAX_VLAN_NUM];/* 每个VID的描述，按VID从小到大排列 */
     MSD_U32 vidInfoSize;/* 所有操作vid条目的个数 */
 }VlanMemberTagAndEgressModeInfo;
 
@@ -78,6 +96,26 @@ typedef struct {
     VlanMemberTagAndEgressModeInfo  portVlanMemberTagInfo;/* VLAN功能的结构 */
 }VlanConfigInfo;
 
+/**
+ * @brief 最近一次设置VLAN出口方式(deviceVlanModuleSetVlanEgressModeAndMemberTagInfo)对交换机的操作次数
+ */
+typedef struct {
+    MSD_BOOL isFullRebuild;/* 是否清空之后重建(第一次设置，Q模式改变，VTU被清空或者上一次设置失败)，否则只写入变化的部分 */
+    MSD_U16 vtuAdds;/* 添加的VTU条目个数 */
+    MSD_U16 vtuModifies;/* 修改的VTU条目个数 */
+    MSD_U16 vtuDeletes;/* 删除的VTU条目个数，清空VTU计为1次 */
+    MSD_U16 vtuUnchanged;/* 没有变化，不需要写入的VTU条目个数 */
+    MSD_U16 portModeWrites;/* 设置端口802.1Q模式的次数 */
+    MSD_U16 defaultVidWrites;/* 设置端口默认VID的次数 */
+    MSD_U16 allowVidZeroWrites;/* QinQ模式下设置端口是否允许VID 0的次数 */
+    MSD_U16 ingressTcamWrites;/* QinQ模式下写入的IngressTCAM条目个数 */
+    MSD_U16 ingressTcamDeletes;/* 删除的IngressTCAM条目个数 */
+    MSD_U16 egressTcamWrites;/* QinQ模式下写入的EgressTCAM条目个数 */
+    MSD_U16 egressTcamDeletes;/* 删除的EgressTCAM条目个数，清空时每个下标号的所有端口计为1次 */
+    MSD_U32 applyCount;/* 开机以来设置的次数 */
+    MSD_U32 fullRebuildCount;/* 开机以来清空之后重建的次数 */
+}VlanApplyStats;
+
 /******************************************************************************************************************
   * @brief device_vlan_module_add_or_modify_vlan
   *  添加和删除vlan，当存在vlan时，为修改vlan信息
@@ -360,6 +398,7 @@ typedef struct {
   * 2：allow memberlist:允许对添加的vid做操作（不允许出口和以各种方式(unmodified,untagged,tagged)出口）
   * 3: allow all but not exclusion:允许所有vid，但是可以排除指定的vid列表。
   *  注：如果VID还不属于VTU条目，在还没达到最多VID条目列表时，会添加到VTU条目中
+  *  注：和当前的设置比较，只写入变化的VTU条目，端口设置和QinQ的TCAM条目。第一次设置或者Q模式改变之后清空VTU和QinQ的TCAM条目之后重建
   * @param dev_num 设备编号
   * @param port_vlan_member_tag 本次要修改的所有端口及其所有vid的memberTag信息
   * @return
@@ -371,6 +410,7 @@ typedef struct {
   *     (1)已经添加到最大VID数目，无法继续添加
   *     (2)当前处于非全局模式下，该API目前仅仅支持全局模式下的设置
   *     (3)全局模式下，Q Mode is Disable VLAN
+  *     (4)QinQ模式下，有端口Untagged出口的VID超过64个
   *****************************************************************************************************************/
  MSD_STATUS deviceVlanModuleSetVlanEgressModeAndMemberTagInfo(IN MSD_U8 devNum, IN VlanMemberTagAndEgressModeInfo* portVlanMemberTag/*, MSD_BOOL is_reset*/);
  /*****************************************************************************************************************
@@ -384,6 +424,64 @@ typedef struct {
   ******************************************************************************************************************/
  MSD_STATUS deviceVlanModuleGetVlanEgressModeMemberTagInfo(IN MSD_U8 devNum, OUT VlanMemberTagAndEgressModeInfo* allPortVlanMemberTag);
 
+ /*****************************************************************************************************************
+  * @brief deviceVlanModuleGetApplyStats
+  * 获取最近一次设置VLAN出口方式对交换机的操作次数，参考VlanApplyStats
+  * @param devNum 设备编号
+  * @param stats 操作次数
+  * @return
+  * MSD_OK - on success
+  * MSD_BAD_PARAM - if invalid parameter is given
+  ******************************************************************************************************************/
+ MSD_STATUS deviceVlanModuleGetApplyStats(IN MSD_U8 devNum, OUT VlanApplyStats* stats);
+
+ /*****************************************************************************************************************
+  * @brief deviceVlanModuleVlanTableReset 清空VID记录，端口的VLAN信息不修改
+  * @param vlanInfo
+  *****************************************************************************************************************/
+ void deviceVlanModuleVlanTableReset(OUT VlanMemberTagAndEgressModeInfo* vlanInfo);
+
+ /*****************************************************************************************************************
+  * @brief deviceVlanModuleVlanTableFind 查找VID记录的下标，不遍历记录
+  * @param vlanInfo
+  * @param vid
+  * @return
+  *   -1：不存在
+  *   >=0 ：VID记录在vidInfo中的下标
+  *****************************************************************************************************************/
+ int deviceVlanModuleVlanTableFind(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid);
+
+ /*****************************************************************************************************************
+  * @brief deviceVlanModuleVlanTableSet 添加或者修改VID记录，添加时之后的记录后移一位
+  * @param vlanInfo
+  * @param vid 2 ~ 4095
+  * @param memberTag 所有端口的memberTag
+  * @param isShow 是否前端显示
+  * @return
+  * MSD_OK - on success
+  * MSD_BAD_PARAM - if invalid parameter is given
+  * MSD_FEATRUE_NOT_ALLOW - 已经添加到最大VID数目(ALLOW_OPERATION_MAX_VLAN_NUM)，无法继续添加
+  *****************************************************************************************************************/
+ MSD_STATUS deviceVlanModuleVlanTableSet(INOUT VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid,
+                                         IN const MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS], IN MSD_BOOL isShow);
+
+ /*****************************************************************************************************************
+  * @brief deviceVlanModuleVlanTableRemove 删除VID记录，之后的记录前移一位
+  * @param vlanInfo
+  * @param vid
+  * @return VID记录是否存在
+  *****************************************************************************************************************/
+ MSD_BOOL deviceVlanModuleVlanTableRemove(INOUT VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid);
+
+ /*****************************************************************************************************************
+  * @brief deviceVlanModuleVlanTableGetMemberTag 获取VID记录中所有端口的memberTag
+  * @param vlanInfo
+  * @param index VID记录在vidInfo中的下标
+  * @param memberTag
+  *****************************************************************************************************************/
+ void deviceVlanModuleVlanTableGetMemberTag(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN int index,
+                                            OUT MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS]);
+
  /******************************************************************************************************************
   * @brief deviceVlanModuleSetProviderPortDealWithNoProviderTagFrame
   *  该接口目前没有进行测试，不知道是否需要，默认情况下，provider port 不会对非provider 帧做任何处理
@@ -31,6 +31,7 @@ extern "C" {
 #include "Fir_msdSysCtrl.h"
 #include "Fir_msdTCAM.h"
 #include "Fir_msdHwAccess.h"
+#include "Fir_msdRMU.h"
 #ifdef __cplusplus
 }
 #endif
@@ -148,6 +148,29 @@ typedef struct
     MSD_U16   vid;
 } FIR_MSD_VTU_INT_STATUS;
 
+/*
+ *  typedef: struct FIR_MSD_VTU_LOAD_WORDS
+ *
+ *  Description: VTU entry pre-packed into the register words of a Load operation.
+ *        Filled by Fir_gvtuPackEntry and written by Fir_gvtuLoadEntries, so a set
+ *        of entries can be converted once and loaded without per entry parsing.
+ *
+ *  Fields:
+ *      vidReg  - VTU VID register (vid, valid bit and vtuPage)
+ *      data1   - VTU Data register 1 (memberTag of ports 0 to 7)
+ *      data2   - VTU Data register 2 (memberTag of ports 8 to 10 and priority override)
+ *      sidReg  - STU SID register (sid, dontLearn, filter and snoop bits)
+ *      fidReg  - VTU FID register (DBNum and vidPolicy)
+ */
+typedef struct
+{
+    MSD_U16   vidReg;
+    MSD_U16   data1;
+    MSD_U16   data2;
+    MSD_U16   sidReg;
+    MSD_U16   fidReg;
+} FIR_MSD_VTU_LOAD_WORDS;
+
 /*
  *  typedef: enum FIR_MSD_VTU_MODE
  *
@@ -327,6 +350,71 @@ MSD_STATUS Fir_gvtuAddEntryIntf
     IN MSD_VTU_ENTRY *vtuEntry
 );
 /*******************************************************************************
+* Fir_gvtuPackEntry
+*
+* DESCRIPTION:
+*       Converts a VTU entry into the register words of a Load operation, for
+*       loading with Fir_gvtuLoadEntries. No register is accessed.
+*
+* INPUTS:
+*       vtuEntry - vtu entry to be packed.
+*
+* OUTPUTS:
+*       words - the packed register words.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS Fir_gvtuPackEntry
+(
+    IN  MSD_QD_DEV   *dev,
+    IN  FIR_MSD_VTU_ENTRY *vtuEntry,
+    OUT FIR_MSD_VTU_LOAD_WORDS *words
+);
+MSD_STATUS Fir_gvtuPackEntryIntf
+(
+    IN  MSD_QD_DEV   *dev,
+    IN  MSD_VTU_ENTRY *vtuEntry,
+    OUT FIR_MSD_VTU_LOAD_WORDS *words
+);
+/*******************************************************************************
+* Fir_gvtuLoadEntries
+*
+* DESCRIPTION:
+*       Creates or updates a set of VTU entries packed by Fir_gvtuPackEntry.
+*       The VTU registers are held once for the whole set, the Load operations
+*       are streamed in register batches and each entry only waits for the
+*       previous operation to finish.
+*
+* INPUTS:
+*       words - the packed entries to load.
+*       count - number of entries in words.
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL- on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       Data, SID and FID registers equal to the previous entry of the same
+*       batch are not written again.
+*
+*******************************************************************************/
+MSD_STATUS Fir_gvtuLoadEntries
+(
+    IN  MSD_QD_DEV   *dev,
+    IN  const FIR_MSD_VTU_LOAD_WORDS *words,
+    IN  MSD_U32      count
+);
+/*******************************************************************************
 * Fir_gvtuDelEntry
 *
 * DESCRIPTION:
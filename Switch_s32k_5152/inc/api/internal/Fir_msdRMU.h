@@ -0,0 +1,92 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+/*******************************************************************************
+* Fir_msdRMU.h
+*
+* DESCRIPTION:
+*       API/Structure definitions for Marvell RMU table dumps.
+*
+* DEPENDENCIES:
+*       None.
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+#ifndef Fir_msdRMU_h
+#define Fir_msdRMU_h
+
+#include "msdApiTypes.h"
+#include "msdSysConfig.h"
+#include "msdUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************************/
+/* Exported RMU Types			 			                                   */
+/****************************************************************************/
+
+/*
+ * Dump ATU response layout. The data field starts with the 16-bit
+ * continuation code followed by up to MSD_RMU_MAX_ATUS entries:
+ *      word 0    - ATU Data register (EntryState, PortVec, LAG)
+ *      word 1..3 - ATU MAC address registers
+ *      word 4    - ATU FID register (FID in bits 11:0)
+ *      word 5    - ATU Operation register (MACFPri bits 2:0, MACQPri bits 10:8)
+ *      word 6    - reserved
+ * An entry with EntryState 0 ends the list. A continuation code of 0 means
+ * the whole table has been dumped.
+ */
+#define FIR_RMU_ATU_ENTRY_SIZE		14U
+#define FIR_RMU_ATU_DUMP_DONE		0U
+
+/****************************************************************************/
+/* Exported RMU Functions		 			                                   */
+/****************************************************************************/
+
+/*******************************************************************************
+* Fir_msdRmuAtuDumpIntf
+*
+* DESCRIPTION:
+*       Dump ATU entries from the specified starting address with one RMU
+*       Dump ATU frame.
+*
+* INPUTS:
+*       startAddr - starting address to search the valid entry, 0 for the
+*                   first frame
+*
+* OUTPUTS:
+*       startAddr  - continuation code for the next frame, 0 when the whole
+*                    table has been dumped
+*       numOfEntry - number of returned valid entries, at most MSD_RMU_MAX_ATUS
+*       atuEntry   - returned valid ATU entries
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*       MSD_NOT_SUPPORTED - RMU is not the register access interface
+*
+* COMMENTS:
+*       atuEntry must hold MSD_RMU_MAX_ATUS pointers to valid storage.
+*
+*******************************************************************************/
+MSD_STATUS Fir_msdRmuAtuDumpIntf
+(
+    IN MSD_QD_DEV *dev,
+    INOUT MSD_U32 *startAddr,
+    OUT MSD_U32 *numOfEntry,
+    OUT MSD_ATU_ENTRY **atuEntry
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __Fir_msdRMU_h */
@@ -39,6 +39,7 @@ extern "C" {
 #include "msdSysCtrl.h"
 #include "msdTCAM.h"
 #include "msdQosMap.h"
+#include "msdRMU.h"
 #ifdef __cplusplus
 }
 #endif
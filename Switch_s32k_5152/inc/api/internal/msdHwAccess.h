@@ -24,6 +24,7 @@
 
 #include "msdApiTypes.h"
 #include "msdSysConfig.h"
+#include "msdTrace.h"
 
 
 #ifdef __cplusplus
@@ -228,6 +229,40 @@ MSD_STATUS msdGetAnyRegField
     OUT MSD_U16   *data
 );
 
+/*******************************************************************************
+* msdGetAnyRegBurst
+*
+* DESCRIPTION:
+*       This function reads count consecutive registers of one device address.
+*       Over RMU the reads travel in one register R/W frame; over SMI they use
+*       the BSP burst read (Clause 45 post-read-increment) when it is provided.
+*
+* INPUTS:
+*       devAddr - device address to read the registers for.
+*       regAddr - The first register's address.
+*       count   - number of registers, regAddr + count must not exceed 32.
+*
+* OUTPUTS:
+*       data    - The read registers' data, count entries.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS msdGetAnyRegBurst
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    count,
+    OUT MSD_U16   *data
+);
+
 
 /*******************************************************************************
 * msdSetAnyExtendedReg
@@ -716,6 +751,514 @@ MSD_STATUS msdRmuTxRxPkt
 	OUT MSD_U32	*rspPktLen
 );
 
+/****************************************************************************/
+/* Pipelined RMU functions.                                                 */
+/****************************************************************************/
+
+#define MSD_RMU_PIPE_DEPTH		4U		/* requests in flight per device */
+#define MSD_RMU_PIPE_REQ_SIZE	512U	/* largest request frame */
+#define MSD_RMU_PIPE_RSP_SIZE	1536U	/* largest response frame */
+#define MSD_RMU_PIPE_TIMEOUT	100U	/* ms to wait for the next response */
+#define MSD_RMU_PIPE_RETRY		2U		/* retransmissions before a request fails */
+#define MSD_RMU_PIPE_MAX_IDLE	((MSD_RMU_PIPE_RETRY + 1U) * 4U)	/* rounds without a completion before the pipe gives up */
+
+/*
+ * Completion callback of a pipelined RMU request. status is MSD_OK with the
+ * response frame, or MSD_FAIL with rspPkt NULL once all retries timed out.
+ * rspPkt is only valid during the call. The callback runs with the device
+ * multiAddrSem held, it may submit further requests but must not call
+ * msdGetAnyReg/msdSetAnyReg.
+ */
+typedef void (*MSD_RMU_DONE_CB)(
+	MSD_U8		devNum,
+	MSD_STATUS	status,
+	MSD_U8		*rspPkt,
+	MSD_U32		rspPktLen,
+	void		*arg);
+
+typedef struct {
+	MSD_BOOL         used;
+	MSD_U8           seqNum;	/* DSA SeqNum the response must carry */
+	MSD_U8           retry;
+	MSD_U32          reqLen;
+	MSD_U8           req[MSD_RMU_PIPE_REQ_SIZE];	/* kept for retransmission */
+	MSD_RMU_DONE_CB  done;
+	void             *arg;
+#ifdef MSD_TRACE
+	MSD_U32          startTime;	/* msdTimeStamp of the first transmission */
+#endif
+} MSD_RMU_PIPE_SLOT;
+
+typedef struct {
+	MSD_BOOL           active;
+	MSD_STATUS         status;	/* first error seen since msdRmuPipeBegin */
+	MSD_U32            nPending;
+	MSD_RMU_PIPE_SLOT  slot[MSD_RMU_PIPE_DEPTH];
+	MSD_U8             rsp[MSD_RMU_PIPE_RSP_SIZE];
+} MSD_RMU_PIPE;
+
+/*******************************************************************************
+* msdRmuPipeBegin
+*
+* DESCRIPTION:
+*       This function starts a pipelined RMU session. The device register
+*       semaphore is taken here and held until msdRmuPipeEnd.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_NOT_SUPPORTED - no RMU send/receive function registered
+*
+* COMMENTS:
+*       A call while another task has a session open waits on the semaphore
+*       until that session ends.
+*
+*******************************************************************************/
+MSD_STATUS msdRmuPipeBegin
+(
+    IN  MSD_U8    devNum
+);
+
+/*******************************************************************************
+* msdRmuPipeSubmit
+*
+* DESCRIPTION:
+*       This function sends one RMU request frame without waiting for its
+*       response. The response is matched by DSA SeqNum and handed to done.
+*       When MSD_RMU_PIPE_DEPTH requests are in flight, responses are
+*       processed first until a slot frees up. That wait is bounded by
+*       MSD_RMU_PIPE_MAX_IDLE rounds without a completion, after which the
+*       requests in flight fail.
+*
+* INPUTS:
+*       devNum    - physical device number
+*       reqPkt    - request frame built with msdRmuReqPktCreate/msdRmuPackEthReqPkt
+*       reqPktLen - request frame length
+*       done      - completion callback
+*       arg       - passed to done
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error, or no slot freed up in time
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       Without rmu_tx/rmu_rx the request is executed through rmu_tx_rx and
+*       done is called before this function returns. The return value is
+*       then the status passed to done. The first error is also reported
+*       by msdRmuPipeEnd.
+*
+*******************************************************************************/
+MSD_STATUS msdRmuPipeSubmit
+(
+    IN  MSD_U8          devNum,
+    IN  MSD_U8          *reqPkt,
+    IN  MSD_U32         reqPktLen,
+    IN  MSD_RMU_DONE_CB done,
+    IN  void            *arg
+);
+
+/*******************************************************************************
+* msdRmuPipeEnd
+*
+* DESCRIPTION:
+*       This function waits for every request in flight to complete or fail,
+*       with the same MSD_RMU_PIPE_MAX_IDLE bound as msdRmuPipeSubmit, ends
+*       the session and releases the semaphore taken by msdRmuPipeBegin.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - every request completed
+*       MSD_FAIL  - a request failed, or on error
+*       other - the first error returned by rmu_tx since msdRmuPipeBegin
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS msdRmuPipeEnd
+(
+    IN  MSD_U8    devNum
+);
+
+/****************************************************************************/
+/* Batched register access functions.                                       */
+/****************************************************************************/
+
+#define MSD_REG_BATCH_MAX_CMDS		MSD_RMU_MAX_REGCMDS	/* one MSD_RegRW frame */
+#define MSD_REG_BATCH_WAIT_LOOP		10000U	/* SMI polls per wait-on-bit command */
+#define MSD_REG_BURST_MAX			32U		/* registers per device address */
+
+typedef enum {
+	MSD_REG_BATCH_OP_READ = 0,
+	MSD_REG_BATCH_OP_WRITE,
+	MSD_REG_BATCH_OP_WAIT_ON_BIT
+} MSD_REG_BATCH_OP;
+
+/*
+ * typedef: struct MSD_REG_BATCH_CMD
+ *
+ * Description: One queued register command.
+ *
+ * Fields:
+ *      op       - read, write or wait-on-bit
+ *      devAddr  - device address
+ *      regAddr  - register address
+ *      bitNum   - bit index polled by a wait-on-bit command
+ *      data     - data to write, or bit value to wait for
+ *      readData - storage for the read value, filled when the batch is flushed
+ */
+typedef struct {
+	MSD_U8   op;
+	MSD_U8   devAddr;
+	MSD_U8   regAddr;
+	MSD_U8   bitNum;
+	MSD_U16  data;
+	MSD_U16  *readData;
+} MSD_REG_BATCH_CMD;
+
+typedef struct {
+	MSD_BOOL           active;
+	MSD_STATUS         status;	/* first error seen since msdRegBatchBegin */
+	MSD_U32            nCmd;
+	MSD_REG_BATCH_CMD  cmd[MSD_REG_BATCH_MAX_CMDS];
+} MSD_REG_BATCH;
+
+/*******************************************************************************
+* msdRegBatchBegin
+*
+* DESCRIPTION:
+*       This function opens a register batch on the device. The SMI/RMU access
+*       semaphore is taken here and held until msdRegBatchCommit.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       msdSetAnyReg/msdGetAnyReg must not be called between msdRegBatchBegin
+*       and msdRegBatchCommit, and batches must not be nested.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchBegin
+(
+    IN  MSD_U8    devNum
+);
+
+/*******************************************************************************
+* msdRegBatchRead
+*
+* DESCRIPTION:
+*       This function queues a register read into the open batch.
+*
+* INPUTS:
+*       devNum  - physical device number
+*       devAddr - device address.
+*       regAddr - The register's address.
+*
+* OUTPUTS:
+*       data    - The read register's data, valid after msdRegBatchCommit.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Errors are latched in the batch and returned again by msdRegBatchCommit.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchRead
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    OUT MSD_U16   *data
+);
+
+/*******************************************************************************
+* msdRegBatchWrite
+*
+* DESCRIPTION:
+*       This function queues a register write into the open batch.
+*
+* INPUTS:
+*       devNum  - physical device number
+*       devAddr - device address.
+*       regAddr - The register's address.
+*       data    - The data to be written.
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Errors are latched in the batch and returned again by msdRegBatchCommit.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchWrite
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U16   data
+);
+
+/*******************************************************************************
+* msdRegBatchWaitOnBit
+*
+* DESCRIPTION:
+*       This function queues a command that waits until one bit of a register
+*       reaches the given value, e.g. the Busy bit of a table operation register.
+*
+* INPUTS:
+*       devNum   - physical device number
+*       devAddr  - device address.
+*       regAddr  - The register's address.
+*       bitNum   - The bit index. (0 - 15)
+*       bitValue - The value to wait for. (0 or 1)
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       On SMI the bit is polled at most MSD_REG_BATCH_WAIT_LOOP times.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchWaitOnBit
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    bitNum,
+    IN  MSD_U8    bitValue
+);
+
+/*******************************************************************************
+* msdRegBatchCommit
+*
+* DESCRIPTION:
+*       This function executes the queued commands in order, stores the read
+*       results and releases the semaphore taken by msdRegBatchBegin.
+*       With RMU the commands are sent as one MSD_RegRW frame, on SMI they are
+*       executed back to back under a single semaphore hold.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_NOT_SUPPORTED - device not support
+*
+* COMMENTS:
+*       Queueing more than MSD_REG_BATCH_MAX_CMDS commands flushes the batch
+*       early, so a read result is only guaranteed after this call.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchCommit
+(
+    IN  MSD_U8    devNum
+);
+
+/****************************************************************************/
+/* Shadow register cache functions.                                         */
+/****************************************************************************/
+
+/*******************************************************************************
+* msdRegCacheEnable
+*
+* DESCRIPTION:
+*       This function enables or disables the shadow register cache. Reads of
+*       cacheable registers are served from RAM after the first hardware
+*       access, writes go through to the hardware and update the RAM copy.
+*
+* INPUTS:
+*       devNum - physical device number
+*       enable - MSD_TRUE to enable, MSD_FALSE to disable
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Every cached value is dropped, the cacheable set is kept.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheEnable
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_BOOL  enable
+);
+
+/*******************************************************************************
+* msdRegCacheSetCacheable
+*
+* DESCRIPTION:
+*       This function marks one register as cacheable (static configuration)
+*       or volatile. Reads of a volatile register always access the hardware.
+*
+* INPUTS:
+*       devNum    - physical device number
+*       devAddr   - device register.
+*       regAddr   - The register's address.
+*       cacheable - MSD_TRUE for a static register, MSD_FALSE for a volatile one
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       Every register is volatile after msdLoadDriver. Status, counter and
+*       busy/operation registers must stay volatile.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheSetCacheable
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_BOOL  cacheable
+);
+
+/*******************************************************************************
+* msdRegCacheInvalidate
+*
+* DESCRIPTION:
+*       This function drops every cached value, the next read of each
+*       register goes to the hardware.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Call it after a switch reset, an EEPROM load or any other change made
+*       behind the driver.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheInvalidate
+(
+    IN  MSD_U8    devNum
+);
+
+/*******************************************************************************
+* msdRegCacheResync
+*
+* DESCRIPTION:
+*       This function reads back every cached register from the hardware,
+*       refreshes the RAM copy and counts the registers that did not match.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       mismatch - number of cached values that differed from the hardware,
+*                  may be NULL
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheResync
+(
+    IN  MSD_U8    devNum,
+    OUT MSD_U32   *mismatch
+);
+
+/*******************************************************************************
+* msdRegCacheStatsGet
+*
+* DESCRIPTION:
+*       This function gets the number of register reads served from RAM and
+*       the number of cacheable reads that went to the hardware.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       hits   - reads served from RAM
+*       misses - reads of cacheable registers that accessed the hardware
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       The counters are cleared by msdRegCacheEnable.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheStatsGet
+(
+    IN  MSD_U8    devNum,
+    OUT MSD_U32   *hits,
+    OUT MSD_U32   *misses
+);
+
+#if defined(MSD_TRACE) && !defined(MSD_TRACE_NO_WRAP)
+/* Charge the bus transactions of these calls to the calling function */
+#define msdGetAnyReg(devNum, devAddr, regAddr, data) \
+            msdTraceGetAnyReg(__func__, (devNum), (devAddr), (regAddr), (data))
+#define msdSetAnyReg(devNum, devAddr, regAddr, data) \
+            msdTraceSetAnyReg(__func__, (devNum), (devAddr), (regAddr), (data))
+#define msdGetAnyRegField(devNum, devAddr, regAddr, fieldOffset, fieldLength, data) \
+            msdTraceGetAnyRegField(__func__, (devNum), (devAddr), (regAddr), (fieldOffset), (fieldLength), (data))
+#define msdSetAnyRegField(devNum, devAddr, regAddr, fieldOffset, fieldLength, data) \
+            msdTraceSetAnyRegField(__func__, (devNum), (devAddr), (regAddr), (fieldOffset), (fieldLength), (data))
+#define msdRegBatchBegin(devNum)        msdTraceRegBatchBegin(__func__, (devNum))
+#define msdRegBatchCommit(devNum)       msdTraceRegBatchCommit(__func__, (devNum))
+#define msdRmuPipeBegin(devNum)         msdTraceRmuPipeBegin(__func__, (devNum))
+#define msdRmuPipeEnd(devNum)           msdTraceRmuPipeEnd(__func__, (devNum))
+#endif
+
 #ifdef __cplusplus
 }
 #endif
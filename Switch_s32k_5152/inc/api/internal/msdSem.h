@@ -35,6 +35,12 @@ extern "C" {
 #define OS_HW_SEMAPHORE_DEV_REG     0x1B
 #define OS_HW_SEMAPHORE_REG         0x15
 
+#define MSD_HW_SEM_FAST_SPINS       4U      /* write/read attempts before backing off */
+#define MSD_HW_SEM_BACKOFF_MIN      10U     /* first backoff delay in uSec */
+#define MSD_HW_SEM_BACKOFF_MAX      1000U   /* backoff delay limit in uSec */
+#define MSD_HW_SEM_TIMEOUT          100000U /* total backoff before giving up, in uSec */
+#define MSD_HW_SEM_TICK_US          1000U   /* msdDelay resolution in uSec, a backoff waits at least this long */
+
 #define OS_MAX_TASKS                30
 #define OS_MAX_TASK_NAME_LENGTH     10
 
@@ -155,6 +161,57 @@ MSD_STATUS msdSemGive
     IN MSD_SEM       smid
 );
 
+/*******************************************************************************
+* msdHwSemStatsGet
+*
+* DESCRIPTION:
+*       Get the hardware semaphore statistics of the device.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       stats  - acquisition, contention and hold time counters
+*
+* RETURNS:
+*       MSD_OK   - on success
+*       MSD_FAIL - on error
+*
+* COMMENTS:
+*       Hold times are in msdTimeStamp units.
+*
+*******************************************************************************/
+MSD_STATUS msdHwSemStatsGet
+(
+    IN  MSD_U8	    devNum,
+    OUT MSD_HW_SEM_STATS *stats
+);
+
+/*******************************************************************************
+* msdHwSemStatsClear
+*
+* DESCRIPTION:
+*       Clear the hardware semaphore statistics of the device.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK   - on success
+*       MSD_FAIL - on error
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_STATUS msdHwSemStatsClear
+(
+    IN MSD_U8	    devNum
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,518 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+
+/********************************************************************************
+* msdSim.h
+*
+* DESCRIPTION:
+*       Register level model of a Fir switch (88Q5151/88Q5152/88Q5192) behind
+*       the MSD_BSP_FUNCTIONS callbacks, so the driver and the device modules
+*       can run without a board. Built only when MSD_SIM is defined.
+*
+*       Modelled: the port, Global 1, Global 2 and TCAM register files, the
+*       ATU, VTU and ingress/egress TCAM tables with their operation state
+*       machines, the busy bits of the operation registers, RMU multiple
+*       register R/W and Dump ATU frames and counting semaphores. The msdSimMdioXxx
+*       functions serve the frames of a bit-banged MDIO bus, Clause 22 and
+*       the Clause 45 ADDRESS, write, read and post read increment frames.
+*       Learning is driven by msdSimLearn: it honours the port's learn enable
+*       (PAV) and learn limit, and raises the ATU full violation.
+*       Not modelled: traffic, aging, the other violations, indirect tables
+*       behind the Global 2 pointer/data registers and the statistics counters.
+*
+*       Time is simulated: every access advances a clock by the configured
+*       latency and an operation keeps its busy bit set until the clock has
+*       advanced past its duration. The optional delay hook turns simulated
+*       time into real time.
+*
+* DEPENDENCIES:
+*       None.
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+#ifndef msdSim_H
+#define msdSim_H
+
+#include "msdApiTypes.h"
+#include "msdSysConfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSD_SIM_ATU_SIZE            4096U   /* ATU entries */
+#define MSD_SIM_VTU_SIZE            4096U   /* VTU entries */
+#define MSD_SIM_TCAM_SIZE           512U    /* ingress TCAM entries */
+#define MSD_SIM_TCAM_EGR_SIZE       64U     /* egress TCAM entries per port */
+#define MSD_SIM_MAX_SEMAPHORES      64U
+
+#define MSD_SIM_DEVICE_ID           0xB520U /* 88Q5152 rev 0, returned by port offset 0x3 */
+
+/*
+ * Typedef: struct MSD_SIM_CONFIG
+ *
+ * Description: Latency model, all times in simulated nSec.
+ *
+ * Fields:
+ *   smiAccessTime - one MII register read or write
+ *   burstReadTime - each register after the first one of a burst read
+ *   rmuFrameTime  - one RMU request/response round trip
+ *   rmuCmdTime    - each register command inside an RMU frame, each entry
+ *                   of a Dump ATU response
+ *   atuOpTime     - ATU operation busy time
+ *   vtuOpTime     - VTU operation busy time
+ *   tcamOpTime    - TCAM operation busy time
+ *   otherOpTime   - busy time of the other self clearing operation registers
+ *   mdioFrameTime - one frame of the msdSimMdioXxx functions
+ *   delay         - optional, called with the simulated time of each access
+ */
+typedef struct
+{
+    MSD_U32     smiAccessTime;
+    MSD_U32     burstReadTime;
+    MSD_U32     rmuFrameTime;
+    MSD_U32     rmuCmdTime;
+    MSD_U32     atuOpTime;
+    MSD_U32     vtuOpTime;
+    MSD_U32     tcamOpTime;
+    MSD_U32     otherOpTime;
+    MSD_U32     mdioFrameTime;
+    void        (*delay)(MSD_U32 nSec);
+} MSD_SIM_CONFIG;
+
+/*
+ * Typedef: struct MSD_SIM_STATS
+ *
+ * Description: Access counters since the last msdSimStatsClear.
+ *
+ * Fields:
+ *   clock       - simulated time in nSec
+ *   reads       - MII register reads, burst reads count each register
+ *   writes      - MII register writes
+ *   bursts      - burst read calls and post read increment frame runs
+ *   addrFrames  - Clause 45 ADDRESS frames
+ *   rmuFrames   - RMU frames
+ *   rmuCmds     - register commands carried by RMU frames
+ *   busyPolls   - reads which returned a set busy bit
+ *   atuOps      - ATU operations started
+ *   vtuOps      - VTU operations started
+ *   tcamOps     - TCAM operations started
+ */
+typedef struct
+{
+    MSD_U64     clock;
+    MSD_U32     reads;
+    MSD_U32     writes;
+    MSD_U32     bursts;
+    MSD_U32     addrFrames;
+    MSD_U32     rmuFrames;
+    MSD_U32     rmuCmds;
+    MSD_U32     busyPolls;
+    MSD_U32     atuOps;
+    MSD_U32     vtuOps;
+    MSD_U32     tcamOps;
+} MSD_SIM_STATS;
+
+#ifdef MSD_SIM
+
+/*******************************************************************************
+* msdSimInit
+*
+* DESCRIPTION:
+*       Reset the simulated switch to its power up state: empty tables, zero
+*       registers except the switch identifier, and load the latency model.
+*
+* INPUTS:
+*       cfg - latency model, NULL for the default model of a 2.5MHz MDC clock
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK - on success
+*
+* COMMENTS:
+*       Call before msdLoadDriver. Semaphores handed out earlier stay valid.
+*
+*******************************************************************************/
+MSD_STATUS msdSimInit
+(
+    IN const MSD_SIM_CONFIG *cfg
+);
+
+/*******************************************************************************
+* msdSimConfigGet
+*
+* DESCRIPTION:
+*       Get the latency model in use.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       cfg - the latency model
+*
+* RETURNS:
+*       MSD_OK        - on success
+*       MSD_BAD_PARAM - if cfg is NULL
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_STATUS msdSimConfigGet
+(
+    OUT MSD_SIM_CONFIG *cfg
+);
+
+/*******************************************************************************
+* msdSimConfigSet
+*
+* DESCRIPTION:
+*       Load a new latency model without resetting the simulated switch.
+*
+* INPUTS:
+*       cfg - latency model, NULL for the default model of a 2.5MHz MDC clock
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK - on success
+*
+* COMMENTS:
+*       A test may install a delay hook this way to look at the device state
+*       between two register accesses of a driver call.
+*
+*******************************************************************************/
+MSD_STATUS msdSimConfigSet
+(
+    IN const MSD_SIM_CONFIG *cfg
+);
+
+/*******************************************************************************
+* msdSimBspGet
+*
+* DESCRIPTION:
+*       Fill the BSP callbacks with the simulator: readMii, writeMii,
+*       readMiiBurst, rmu_tx_rx and the semaphore functions.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       bsp - the callbacks to pass in MSD_SYS_CONFIG
+*
+* RETURNS:
+*       MSD_OK        - on success
+*       MSD_BAD_PARAM - if bsp is NULL
+*
+* COMMENTS:
+*       The semaphores are plain counters for a single threaded host, a
+*       target build should keep its OS semaphores.
+*
+*******************************************************************************/
+MSD_STATUS msdSimBspGet
+(
+    OUT MSD_BSP_FUNCTIONS *bsp
+);
+
+/*******************************************************************************
+* msdSimLearn
+*
+* DESCRIPTION:
+*       Learn a source address as if a frame with it had been received on a
+*       port: a new dynamic entry, or a move of an existing dynamic entry to
+*       the port.
+*
+* INPUTS:
+*       port    - the ingress port
+*       fid     - the FID the frame was classified to
+*       macAddr - the unicast source address
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK        - learned, or already known
+*       MSD_FAIL      - learning is disabled on the port
+*       MSD_NO_SPACE  - the port reached its learn limit, or the ATU is full
+*                       and an ATU full violation is raised
+*       MSD_BAD_PARAM - on bad parameter
+*
+* COMMENTS:
+*       No simulated time passes, learning does not use the SMI.
+*
+*******************************************************************************/
+MSD_STATUS msdSimLearn
+(
+    IN MSD_U8 port,
+    IN MSD_U16 fid,
+    IN const MSD_ETHERADDR *macAddr
+);
+
+/*******************************************************************************
+* msdSimMdioC22Read
+*
+* DESCRIPTION:
+*       Serve one Clause 22 read frame.
+*
+* INPUTS:
+*       phyAddr - PHY address of the frame, the switch device address
+*       regAddr - register address
+*
+* OUTPUTS:
+*       value   - the register value
+*
+* RETURNS:
+*       MSD_OK        - on success
+*       MSD_BAD_PARAM - if value is NULL
+*
+* COMMENTS:
+*       Each frame of the msdSimMdioXxx functions costs mdioFrameTime.
+*
+*******************************************************************************/
+MSD_STATUS msdSimMdioC22Read
+(
+    IN  MSD_U8  phyAddr,
+    IN  MSD_U8  regAddr,
+    OUT MSD_U16 *value
+);
+
+/*******************************************************************************
+* msdSimMdioC22Write
+*
+* DESCRIPTION:
+*       Serve one Clause 22 write frame.
+*
+* INPUTS:
+*       phyAddr - PHY address of the frame, the switch device address
+*       regAddr - register address
+*       value   - data to write
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK - on success
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_STATUS msdSimMdioC22Write
+(
+    IN MSD_U8  phyAddr,
+    IN MSD_U8  regAddr,
+    IN MSD_U16 value
+);
+
+/*******************************************************************************
+* msdSimMdioC45Address
+*
+* DESCRIPTION:
+*       Serve one Clause 45 ADDRESS frame: load the address register of
+*       phyAddr for the data frames that follow.
+*
+* INPUTS:
+*       phyAddr - PHY address of the frame, the switch device address
+*       devType - MMD device type of the frame
+*       address - register address, 0x8000 + register for a switch register
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK - on success
+*
+* COMMENTS:
+*       Counted in addrFrames.
+*
+*******************************************************************************/
+MSD_STATUS msdSimMdioC45Address
+(
+    IN MSD_U8  phyAddr,
+    IN MSD_U8  devType,
+    IN MSD_U16 address
+);
+
+/*******************************************************************************
+* msdSimMdioC45Read
+*
+* DESCRIPTION:
+*       Serve one Clause 45 read or post read increment frame at the address
+*       register of phyAddr. A post read increment frame advances the address
+*       register after the read.
+*
+* INPUTS:
+*       phyAddr       - PHY address of the frame, the switch device address
+*       devType       - MMD device type of the frame
+*       postIncrement - MSD_TRUE for a post read increment frame
+*
+* OUTPUTS:
+*       value   - the register value
+*
+* RETURNS:
+*       MSD_OK        - on success
+*       MSD_FAIL      - the device type is not 3 or the address register is
+*                       not at a switch register (0x8000 to 0x801F), nothing
+*                       answers the frame
+*       MSD_BAD_PARAM - if value is NULL
+*
+* COMMENTS:
+*       A run of post read increment frames on one PHY address counts one
+*       burst.
+*
+*******************************************************************************/
+MSD_STATUS msdSimMdioC45Read
+(
+    IN  MSD_U8   phyAddr,
+    IN  MSD_U8   devType,
+    IN  MSD_BOOL postIncrement,
+    OUT MSD_U16  *value
+);
+
+/*******************************************************************************
+* msdSimMdioC45Write
+*
+* DESCRIPTION:
+*       Serve one Clause 45 write frame at the address register of phyAddr.
+*
+* INPUTS:
+*       phyAddr - PHY address of the frame, the switch device address
+*       devType - MMD device type of the frame
+*       value   - data to write
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK   - on success
+*       MSD_FAIL - the address register is not at a switch register
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_STATUS msdSimMdioC45Write
+(
+    IN MSD_U8  phyAddr,
+    IN MSD_U8  devType,
+    IN MSD_U16 value
+);
+
+/*******************************************************************************
+* msdSimHwSemSet
+*
+* DESCRIPTION:
+*       Set the hardware semaphore (Global 1 offset 0x15) as another host
+*       would: a non zero owner holds it, 0x0 releases it. While it is held a
+*       write of another non zero value is ignored.
+*
+* INPUTS:
+*       owner - semaphore value of the other host, 0x0 to release
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK - on success
+*
+* COMMENTS:
+*       No simulated time passes, the other host does not use this SMI.
+*
+*******************************************************************************/
+MSD_STATUS msdSimHwSemSet
+(
+    IN MSD_U16 owner
+);
+
+/*******************************************************************************
+* msdSimStatsGet
+*
+* DESCRIPTION:
+*       Get the access counters and the simulated clock.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       stats - the counters
+*
+* RETURNS:
+*       MSD_OK        - on success
+*       MSD_BAD_PARAM - if stats is NULL
+*
+* COMMENTS:
+*       A host build may return stats.clock from msdTimeStamp so that the
+*       register trace reports simulated latencies.
+*
+*******************************************************************************/
+MSD_STATUS msdSimStatsGet
+(
+    OUT MSD_SIM_STATS *stats
+);
+
+/*******************************************************************************
+* msdSimStatsClear
+*
+* DESCRIPTION:
+*       Clear the access counters, the simulated clock keeps running.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       None
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+void msdSimStatsClear
+(
+    void
+);
+
+/*******************************************************************************
+* msdSimStatsDump
+*
+* DESCRIPTION:
+*       Print the access counters and the table occupancy through the debug
+*       print callback.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       None
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+void msdSimStatsDump
+(
+    void
+);
+
+#endif /* MSD_SIM */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* msdSim_H */
+/* Do Not Add Anything Below This Line */
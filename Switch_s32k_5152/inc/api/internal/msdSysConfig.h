@@ -149,6 +149,13 @@ typedef MSD_STATUS(*MSD_FMSD_WRITE_MII)(
                         MSD_U8		 phyAddr, 
                         MSD_U8		 miiReg, 
                         MSD_U16		 value);
+/* read count consecutive registers starting at miiReg, optional */
+typedef MSD_STATUS(*MSD_FMSD_READ_MII_BURST)(
+                        MSD_U8	     devNum,
+                        MSD_U8		 phyAddr,
+                        MSD_U8		 miiReg,
+                        MSD_U8		 count,
+                        MSD_U16*	 values);
 
 /*
 send_and_receive_packet
@@ -171,6 +178,23 @@ typedef MSD_STATUS(*MSD_RMU_TX_RX_PAK)(
 	MSD_U8	**rsp_pkt,
 	MSD_U32	*rsp_pkt_len);
 
+/*
+* Split RMU send/receive functions, optional, used by the pipelined RMU engine
+* (msdRmuPipeSubmit) to keep several requests in flight.
+* rmu_tx: queue one request frame for transmission and return without waiting.
+* rmu_rx: copy the next received RMU response frame (headers included) into
+*         rsp_pkt, at most *rsp_pkt_len bytes, and update *rsp_pkt_len.
+*         Return MSD_FAIL if no frame arrives within timeOut milliseconds.
+* The engine matches responses to requests by DSA SeqNum itself.
+*/
+typedef MSD_STATUS(*MSD_RMU_TX_PAK)(
+	MSD_U8	*req_pkt,
+	MSD_U32	req_pkt_len);
+typedef MSD_STATUS(*MSD_RMU_RX_PAK)(
+	MSD_U8	*rsp_pkt,
+	MSD_U32	*rsp_pkt_len,
+	MSD_U32	timeOut);
+
 typedef enum
 {
     MSD_INTERFACE_SMI = 0x0,
@@ -1582,6 +1606,83 @@ typedef MSD_STATUS (*MSD_FMSD_SEM_TAKE)(
 typedef MSD_STATUS (*MSD_FMSD_SEM_GIVE)(
                         MSD_SEM semId);
 						
+/*
+ * Typedef: struct MSD_REG_CACHE
+ *
+ * Description: Shadow copy of the switch registers. A register is addressed
+ *              by the index (devAddr << 5) | regAddr, one bit per register in
+ *              the bitmaps.
+ *
+ * Fields:
+ *   enable    - MSD_TRUE when reads of cacheable registers are served from RAM
+ *   cacheable - set for static configuration registers, clear for volatile
+ *               registers (status, counters, busy bits) which always go to hardware
+ *   valid     - set when data holds the current hardware value
+ *   data      - the cached register values
+ *   hits      - number of reads served from RAM
+ *   misses    - number of reads of cacheable registers that went to hardware
+ */
+#define MSD_REG_CACHE_SIZE      1024U
+#define MSD_REG_CACHE_WORDS     (MSD_REG_CACHE_SIZE / 32U)
+
+typedef struct
+{
+    MSD_BOOL    enable;
+    MSD_U32     cacheable[MSD_REG_CACHE_WORDS];
+    MSD_U32     valid[MSD_REG_CACHE_WORDS];
+    MSD_U16     data[MSD_REG_CACHE_SIZE];
+    MSD_U32     hits;
+    MSD_U32     misses;
+} MSD_REG_CACHE;
+
+/*
+ * Typedef: struct MSD_HW_SEM_STATS
+ *
+ * Description: Hardware semaphore statistics, see msdHwSemStatsGet.
+ *
+ * Fields:
+ *   acquires    - number of times the semaphore register was taken
+ *   nested      - number of takes served from RAM while the semaphore was already held
+ *   contended   - acquisitions that needed more than one write/read attempt
+ *   spins       - total write/read attempts of contended acquisitions
+ *   maxSpins    - largest number of attempts of a single acquisition
+ *   timeouts    - acquisitions abandoned after MSD_HW_SEM_TIMEOUT
+ *   holdTime    - accumulated hold time, in msdTimeStamp units
+ *   maxHoldTime - longest single hold, in msdTimeStamp units
+ */
+typedef struct
+{
+    MSD_U32     acquires;
+    MSD_U32     nested;
+    MSD_U32     contended;
+    MSD_U32     spins;
+    MSD_U32     maxSpins;
+    MSD_U32     timeouts;
+    MSD_U32     holdTime;
+    MSD_U32     maxHoldTime;
+} MSD_HW_SEM_STATS;
+
+/*
+ * Typedef: struct MSD_HW_SEM_STATE
+ *
+ * Description: RAM copy of the hardware semaphore (Global1 offset 0x15) state.
+ *              The semaphore is owned by the host, not by a task, so a single
+ *              hold count per device covers every task nested inside it.
+ *
+ * Fields:
+ *   guard     - software semaphore protecting holdCnt, taken through semTake directly
+ *   holdCnt   - outstanding msdSemTake calls while the host owns the semaphore
+ *   holdStart - msdTimeStamp value when the semaphore was taken
+ *   stats     - acquisition statistics
+ */
+typedef struct
+{
+    MSD_SEM             guard;
+    MSD_U32             holdCnt;
+    MSD_U32             holdStart;
+    MSD_HW_SEM_STATS    stats;
+} MSD_HW_SEM_STATE;
+
 /*
  * Typedef: struct MSD_QD_DEV
  *
@@ -1612,12 +1713,17 @@ typedef MSD_STATUS (*MSD_FMSD_SEM_GIVE)(
  *                    such as Trunk Tables and Device Table
  *   eepromRegsSem  - Semaphore for eeprom control access
  *   phyRegsSem     - Semaphore for PHY Device access
+ *   rmu_tx_rx      - platform specific RMU request/response function
+ *   rmu_tx, rmu_rx - optional split RMU send and receive functions
  *   fgtReadMii     - platform specific SMI register Read function
  *   fgtWriteMii    - platform specific SMI register Write function
+ *   fgtReadMiiBurst - optional platform specific SMI burst Read function
  *   semCreate      - function to create semapore
  *   semDelete      - function to delete the semapore
  *   semTake        - function to get a semapore
  *   semGive        - function to return semaphore
+ *   regCache       - shadow register cache, see msdRegCacheEnable
+ *   hwSem          - hardware semaphore hold count and statistics
  */
 struct MSD_QD_DEV_
 {
@@ -1658,12 +1764,15 @@ struct MSD_QD_DEV_
 	MSD_SEM      apbRegsSem;
 
 	MSD_RMU_TX_RX_PAK rmu_tx_rx;
+	MSD_RMU_TX_PAK rmu_tx;
+	MSD_RMU_RX_PAK rmu_rx;
     MSD_RMU_MODE rmuMode;
     MSD_U32 eTypeValue;
 	MSD_U8	reqSeqNum;
 
     MSD_FMSD_READ_MII  	fgtReadMii;
     MSD_FMSD_WRITE_MII 	fgtWriteMii;
+    MSD_FMSD_READ_MII_BURST fgtReadMiiBurst;
 
     MSD_FMSD_SEM_CREATE  semCreate;     	/* create semaphore */
     MSD_FMSD_SEM_DELETE  semDelete;     	/* delete the semaphore */
@@ -1674,6 +1783,9 @@ struct MSD_QD_DEV_
 
 	MSD_BOOL           hwSemaphoreSupport;    /* true means the device support Hardware semaphore, false means do not support*/
 	MSD_HWSEMAPHORE    HWSemaphore;
+    MSD_HW_SEM_STATE   hwSem;
+
+    MSD_REG_CACHE      regCache;
 
     SwitchDevObj_ SwitchDevObj;
 };
@@ -1682,9 +1794,12 @@ struct MSD_QD_DEV_
 typedef struct BSP_FUNCTIONS_
 {
     MSD_RMU_TX_RX_PAK   rmu_tx_rx;      /* Send-Receive RMU Packets*/
+    MSD_RMU_TX_PAK      rmu_tx;         /* Send RMU Packet, optional */
+    MSD_RMU_RX_PAK      rmu_rx;         /* Receive RMU Packet, optional */
  
     MSD_FMSD_READ_MII     readMii;       /* read MII Registers */
     MSD_FMSD_WRITE_MII     writeMii;     /* write MII Registers */
+    MSD_FMSD_READ_MII_BURST readMiiBurst; /* read consecutive MII Registers, optional */
 
     MSD_FMSD_SEM_CREATE    semCreate;    /* create semapore */
     MSD_FMSD_SEM_DELETE    semDelete;    /* delete the semapore */
@@ -0,0 +1,376 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+
+/********************************************************************************
+* msdTrace.h
+*
+* DESCRIPTION:
+*       Register access tracing. Built only when MSD_TRACE is defined.
+*       Every bus transaction is recorded where it leaves the driver: the
+*       BSP readMii/writeMii/readMiiBurst functions are hooked when the
+*       device is loaded, and RMU frames are recorded by msdRmuTxRxPkt and
+*       the RMU pipeline. Outside msdHwAccess.c the register access, batch
+*       and pipeline entry points are routed through msdTraceXxx, which set
+*       the calling function as the tag of the device for the duration of
+*       the call, so batched TCAM/ATU/VTU traffic is charged to its caller.
+*
+* DEPENDENCIES:
+*       msdTimeStamp provided by the MSD user.
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+#ifndef msdTrace_H
+#define msdTrace_H
+
+#include "msdApiTypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSD_TRACE_RING_SIZE         256U    /* records kept, power of 2 */
+#define MSD_TRACE_MAX_TAGS          48U     /* distinct callers counted */
+#define MSD_TRACE_HIST_BUCKETS      12U     /* latency bucket n counts [2^(n-1), 2^n) time stamp units */
+
+#define MSD_TRACE_TAG_NONE          "(untagged)"    /* accesses outside a traced call */
+
+typedef enum
+{
+    MSD_TRACE_OP_READ,          /* one MII register read */
+    MSD_TRACE_OP_WRITE,         /* one MII register write */
+    MSD_TRACE_OP_READ_BURST,    /* one readMiiBurst call */
+    MSD_TRACE_OP_RMU,           /* one RMU request/response */
+    MSD_TRACE_OP_NUM
+} MSD_TRACE_OP;
+
+/*
+ * Typedef: struct MSD_TRACE_RECORD
+ *
+ * Description: One register access in the trace ring.
+ *
+ * Fields:
+ *   tag       - name of the calling function, MSD_TRACE_TAG_NONE if none
+ *   timeStamp - msdTimeStamp value when the access started
+ *   latency   - duration of the access, in msdTimeStamp units
+ *   devNum    - physical device number
+ *   devAddr   - MII device address, 0 for RMU
+ *   regAddr   - MII register address, 0 for RMU
+ *   op        - MSD_TRACE_OP
+ *   status    - returned MSD_STATUS
+ */
+typedef struct
+{
+    const char  *tag;
+    MSD_U32     timeStamp;
+    MSD_U32     latency;
+    MSD_U8      devNum;
+    MSD_U8      devAddr;
+    MSD_U8      regAddr;
+    MSD_U8      op;
+    MSD_U8      status;
+} MSD_TRACE_RECORD;
+
+/*
+ * Typedef: struct MSD_TRACE_STATS
+ *
+ * Description: Per caller counters.
+ *
+ * Fields:
+ *   tag        - name of the calling function, NULL for a free slot
+ *   count      - bus transactions per MSD_TRACE_OP
+ *   errors     - accesses which did not return MSD_OK
+ *   totalTime  - accumulated latency
+ *   maxTime    - largest latency
+ *   hist       - latency histogram
+ */
+typedef struct
+{
+    const char  *tag;
+    MSD_U32     count[MSD_TRACE_OP_NUM];
+    MSD_U32     errors;
+    MSD_U32     totalTime;
+    MSD_U32     maxTime;
+    MSD_U32     hist[MSD_TRACE_HIST_BUCKETS];
+} MSD_TRACE_STATS;
+
+#ifdef MSD_TRACE
+
+struct MSD_QD_DEV_;
+
+/*******************************************************************************
+* msdTraceRecord
+*
+* DESCRIPTION:
+*       Append one bus transaction to the trace ring and account it to the
+*       tag.
+*
+* INPUTS:
+*       tag       - name of the calling function, must be a static string
+*       op        - MSD_TRACE_OP
+*       devNum    - physical device number
+*       devAddr   - device address
+*       regAddr   - register address
+*       startTime - msdTimeStamp value taken before the access
+*       status    - returned status of the access
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       None
+*
+* COMMENTS:
+*       Lock free, may be called from any task.
+*
+*******************************************************************************/
+void msdTraceRecord
+(
+    IN const char   *tag,
+    IN MSD_TRACE_OP op,
+    IN MSD_U8       devNum,
+    IN MSD_U8       devAddr,
+    IN MSD_U8       regAddr,
+    IN MSD_U32      startTime,
+    IN MSD_STATUS   status
+);
+
+MSD_STATUS msdTraceGetAnyReg
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    OUT MSD_U16   *data
+);
+
+MSD_STATUS msdTraceSetAnyReg
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U16   data
+);
+
+MSD_STATUS msdTraceGetAnyRegField
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    fieldOffset,
+    IN  MSD_U8    fieldLength,
+    OUT MSD_U16   *data
+);
+
+MSD_STATUS msdTraceSetAnyRegField
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    fieldOffset,
+    IN  MSD_U8    fieldLength,
+    IN  MSD_U16   data
+);
+
+/*******************************************************************************
+* msdTraceHookBus
+*
+* DESCRIPTION:
+*       Replace the MII access functions of the device with recording
+*       wrappers. Called by msdLoadDriver after the BSP functions are
+*       registered.
+*
+* INPUTS:
+*       dev - device whose fgtReadMii/fgtWriteMii/fgtReadMiiBurst are hooked
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       None
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+void msdTraceHookBus
+(
+    INOUT struct MSD_QD_DEV_ *dev
+);
+
+/*******************************************************************************
+* msdTraceTagSet
+*
+* DESCRIPTION:
+*       Set the tag that bus transactions of the device are charged to.
+*
+* INPUTS:
+*       devNum - physical device number
+*       tag    - name of the calling function, NULL for none
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       The previous tag, to be restored by the caller.
+*
+* COMMENTS:
+*       The tag belongs to the device, not to the task. It is exact as long
+*       as one task at a time accesses the device, which the application
+*       ensures with the device mutex.
+*
+*******************************************************************************/
+const char* msdTraceTagSet
+(
+    IN MSD_U8       devNum,
+    IN const char   *tag
+);
+
+/*******************************************************************************
+* msdTraceTagGet
+*
+* DESCRIPTION:
+*       Get the tag that bus transactions of the device are charged to.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       The tag, MSD_TRACE_TAG_NONE outside a traced call.
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+const char* msdTraceTagGet
+(
+    IN MSD_U8       devNum
+);
+
+MSD_STATUS msdTraceRegBatchBegin
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+);
+
+MSD_STATUS msdTraceRegBatchCommit
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+);
+
+MSD_STATUS msdTraceRmuPipeBegin
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+);
+
+MSD_STATUS msdTraceRmuPipeEnd
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+);
+
+/*******************************************************************************
+* msdTraceStatsGet
+*
+* DESCRIPTION:
+*       Get the counters of the index-th traced caller.
+*
+* INPUTS:
+*       index - 0 to MSD_TRACE_MAX_TAGS - 1
+*
+* OUTPUTS:
+*       stats - counters of the caller
+*
+* RETURNS:
+*       MSD_OK        - on success
+*       MSD_NO_SUCH   - no caller at this index
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_STATUS msdTraceStatsGet
+(
+    IN  MSD_U32 index,
+    OUT MSD_TRACE_STATS *stats
+);
+
+/*******************************************************************************
+* msdTraceClear
+*
+* DESCRIPTION:
+*       Clear the trace ring and all caller counters.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       None
+*
+* COMMENTS:
+*       Accesses running concurrently may be partially accounted.
+*
+*******************************************************************************/
+void msdTraceClear
+(
+    void
+);
+
+/*******************************************************************************
+* msdTraceDump
+*
+* DESCRIPTION:
+*       Print the caller counters, latency histograms and the last numOfRecord
+*       trace records through the debug print callback.
+*
+* INPUTS:
+*       numOfRecord - records to print, 0 for counters only
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       None
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+void msdTraceDump
+(
+    IN MSD_U32 numOfRecord
+);
+
+/* record a bus transaction of devNum under the tag of the device */
+#define MSD_TRACE_BUS_ACCESS(op, devNum, devAddr, regAddr, startTime, status) \
+            msdTraceRecord(msdTraceTagGet(devNum), (op), (devNum), (devAddr), (regAddr), (startTime), (status))
+
+#else
+
+#define MSD_TRACE_BUS_ACCESS(op, devNum, devAddr, regAddr, startTime, status)
+
+#endif /* MSD_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* msdTrace_H */
+/* Do Not Add Anything Below This Line */
@@ -282,6 +282,33 @@ void msdDelay
     IN const unsigned int delayTime
 );
 
+/*******************************************************************************
+* msdTimeStamp
+*
+* DESCRIPTION:
+*       Return a free running time stamp.
+*        The unit is system dependent, only the difference between two values
+*        is meaningful. Since this function is System and/or OS dependent, it
+*        should be provided by each MSD user.
+*
+* INPUTS:
+*       None
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       current time stamp
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_U32 msdTimeStamp
+(
+    void
+);
+
 MSD_U32 msd_htonl
 (
 	MSD_U32 hostlong
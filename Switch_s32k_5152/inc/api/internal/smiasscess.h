@@ -13,10 +13,49 @@ typedef void* HANDLE;
     extern "C" {
 #endif
 
+/**
+ * @brief MDIO后端接口，readRegister/readC45Register等函数通过当前后端访问MDIO总线
+ * Clause 45访问二选一：
+ * 1.c45Read/c45Write：一次完成ADDRESS帧和数据帧，硬件MDIO控制器实现
+ * 2.c45AddrFrame/c45ReadFrame/c45WriteFrame：单独发送每一帧，连续访问同一寄存器时跳过ADDRESS帧
+ * c45ReadIncFrame可选：Post Read Increment帧，读取后PHY地址寄存器自动加1，用于连续寄存器的突发读取
+ * 读函数返回寄存器值，失败返回负数；写函数成功返回0，失败返回负数
+ */
+typedef struct MdioBackend_
+{
+	const char* name;
+	int (*c22Read)(unsigned int phyAddr, unsigned int regAddr);
+	int (*c22Write)(unsigned int phyAddr, unsigned int regAddr, unsigned int data);
+	int (*c45Read)(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr);
+	int (*c45Write)(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int data);
+	int (*c45AddrFrame)(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr);
+	int (*c45ReadFrame)(unsigned int phyAddr, unsigned int devAddr);
+	int (*c45WriteFrame)(unsigned int phyAddr, unsigned int devAddr, unsigned int data);
+	int (*c45ReadIncFrame)(unsigned int phyAddr, unsigned int devAddr);
+} MdioBackend;
+
+extern const MdioBackend g_mdioGmacBackend;  //S32K GMAC MDIO控制器
+#ifdef MDIO_USE_GPIO
+extern const MdioBackend g_mdioGpioBackend;  //GPIO模拟MDIO时序，需要链接smi.h的实现
+#endif
+
+/**
+ * @brief mdioInit 选择MDIO后端并清空Clause 45地址缓存，第一次调用时创建MDIO总线互斥量
+ * @param backend 为NULL时使用默认后端(定义MDIO_USE_GPIO时为GPIO，否则为GMAC)
+ * @return 成功返回0，失败返回-1
+ */
+extern int mdioInit(const MdioBackend* backend);
+
 extern int readRegister(unsigned int phyAddr,unsigned int regAddr);
 extern int writeRegister(unsigned int phyAddr,unsigned int regAddr,unsigned int data);
 extern int readC45Register(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr);
 extern int writeC45Register(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int data);
+/**
+ * @brief readC45RegisterBurst 读取从regAddr开始的count个连续寄存器
+ * 后端支持Post Read Increment帧时只发送一个ADDRESS帧，否则逐个读取
+ * @return 成功返回0，失败返回负数
+ */
+extern int readC45RegisterBurst(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int count, unsigned short* values);
 
 
 #ifdef __cplusplus 
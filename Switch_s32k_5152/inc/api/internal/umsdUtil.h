@@ -71,6 +71,58 @@ int boolarrayToInt(MSD_BOOL array[], int size);
 ******************************************************************************/
 int numberIsInArr(int* arr, int arrSize, int num);
 
+#define FID_SET_WORDS  128  //4096个FID,每个FID一位
+
+/**
+ * FID集合(也可以存放VID),0 ~ 4095每个值占一位,共512个字节
+ */
+typedef struct {
+    MSD_U32 bits[FID_SET_WORDS];
+}FidSet;
+
+//fid加入集合
+static inline void fidSetAdd(FidSet* set, MSD_U16 fid)
+{
+    set->bits[(fid >> 5) & (FID_SET_WORDS - 1)] |= (1U << (fid & 0x1F));
+}
+
+//fid从集合中删除
+static inline void fidSetRemove(FidSet* set, MSD_U16 fid)
+{
+    set->bits[(fid >> 5) & (FID_SET_WORDS - 1)] &= ~(1U << (fid & 0x1F));
+}
+
+//fid是否在集合中
+static inline MSD_BOOL fidSetHas(const FidSet* set, MSD_U16 fid)
+{
+    return ((set->bits[(fid >> 5) & (FID_SET_WORDS - 1)] >> (fid & 0x1F)) & 1U) ? MSD_TRUE : MSD_FALSE;
+}
+
+/******************************************************************************
+ * @brief fidSetClear 清空集合
+ * @param set
+ ******************************************************************************/
+void fidSetClear(FidSet* set);
+
+/******************************************************************************
+ * @brief fidSetCount 集合中fid的个数
+ * @param set
+ * @return fid的个数
+ ******************************************************************************/
+int fidSetCount(const FidSet* set);
+
+/******************************************************************************
+ * @brief fidSetNext 查找集合中大于等于fid的第一个fid,按32位逐字查找
+ * 遍历方式: for (int fid = fidSetNext(set, 0); fid >= 0; fid = fidSetNext(set, fid + 1))
+ * 遍历过程中可以删除当前的fid
+ * @param set
+ * @param fid 开始查找的fid
+ * @return
+ *   -1: 不存在
+ *   >=0: 找到的fid
+ ******************************************************************************/
+int fidSetNext(const FidSet* set, int fid);
+
 
 
 
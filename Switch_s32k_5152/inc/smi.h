@@ -45,10 +45,11 @@
 #define MDIO_PORT_               MDIO_CPU_PORT
 #define MDC_PIN_                 MDC_CPU_PIN
 #define MDC_PORT_                MDC_CPU_PORT
+#define MDIO_MSCR_BASE_          MDIO_CPU_MSCR_BASE	//MDIO引脚所在的PORTx_L/H_HALF，收发切换时修改MSCR方向
 
 
-#define MDIO_DELAY          2600	// us
-#define MDIO_READ_DELAY     2600  	// us
+#define MDIO_DELAY          2600	//半个MDC周期的空循环次数
+#define MDIO_READ_DELAY     2600  	//MDC下降沿后等待PHY驱动数据的空循环次数
 
 
 /*  Or MII_ADDR_C45 into regnum for read/write on mii_bus to enable the 21 bit
@@ -57,10 +58,10 @@
 
 
 
-#define MDIO_CL45_ADDR  	0x00
-#define MDIO_CL45_WRITE 	0x01
-#define MDIO_CL45_READ  	0x11
-#define MDIO_CL45_READ_INC 	0x10
+#define MDIO_CL45_ADDR  	0x0		//00
+#define MDIO_CL45_WRITE 	0x1		//01
+#define MDIO_CL45_READ  	0x3		//11
+#define MDIO_CL45_READ_INC 	0x2		//10
 
 
 #define MDIO_CL22_READ  	0x2
@@ -89,6 +90,7 @@ int  mdio_read_bits_num( int nBits);
 void cl45_mdio_frame_addr(int phyAddr, int device, int regAddr);
 void cl45_mdio_frame_write(int phyAddr, int device, int data);
 int  cl45_mdio_frame_read(int phyAddr, int device);
+int  cl45_mdio_frame_read_inc(int phyAddr, int device);
 
 void cl45_mdio_write(int phyAddr, int device, int regAddr, int data);
 int  cl45_mdio_read(int phyAddr, int device, int regAddr);
@@ -93,6 +93,20 @@ bool glue_file_close_file_upload(void *context);
 bool glue_file_write_file_upload(void *context, void *buf, size_t len);
 size_t glue_graph_get_graph1(uint32_t from, uint32_t to,
                               uint32_t *x_values, double *y_values, size_t len);
+
+// mac_table: streamed as a chunked JSON array, one batch per poll
+#define GLUE_MAC_TABLE_BATCH 8      // ATU entries printed per chunk
+#define GLUE_MAC_TABLE_CURSOR 6     // Cursor size, uint32_t words
+bool glue_mac_table_open(uint32_t *cursor, int type, int vid,
+                         unsigned long port_vec);
+size_t glue_mac_table_print(void (*out)(char, void *), void *ptr, va_list *ap);
+
+// mac_telemetry: MAC learning counters, flapping stations and sample history
+bool glue_mac_telemetry_set(bool enable, unsigned long interval_ms,
+                            unsigned long flap_window_ms,
+                            unsigned long flap_threshold);
+size_t glue_mac_telemetry_print(void (*out)(char, void *), void *ptr,
+                                va_list *ap);
 struct state {
   int speed;
   int temperature;
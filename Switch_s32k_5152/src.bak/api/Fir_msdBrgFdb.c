@@ -2171,6 +2171,10 @@ static MSD_STATUS Fir_atuOperationPerform
     MSD_U16          opcodeData;    /* Data to be set into the register. */
     MSD_U8           i;
     MSD_U16          portMask;
+    MSD_U16          fidData;
+    MSD_U16          opReg;
+    MSD_U16          atuData;
+    MSD_U16          macData[3];
 
     if (IS_SMI_MULTICHIP_SUPPORTED(dev) == 1)
     {
@@ -2181,38 +2185,40 @@ static MSD_STATUS Fir_atuOperationPerform
 
 	portMask = (MSD_U16)(((MSD_U16)1 << dev->maxPorts) - (MSD_U16)1);
 
-	/*Check if in SplitATU mode, if yes, set the E-CID mode as 0 for ATU operation*/
-	data = (MSD_U16)0;
-	retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, (MSD_U8)15, (MSD_U8)1, &data);
+    /* Wait until the ATU in ready, then read the FID and Operation registers in one batch */
+	fidData = 0;
+	opReg = 0;
+	retVal = msdRegBatchBegin(dev->devNum);
 	if (retVal != MSD_OK)
 	{
 		msdSemGive(dev->devNum, dev->atuRegsSem);
 		return retVal;
 	}
-	if (data == (MSD_U16)1)
+	(void)msdRegBatchWaitOnBit(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)15, (MSD_U8)0);
+	(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, &fidData);
+	(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, &opReg);
+	retVal = msdRegBatchCommit(dev->devNum);
+	if (retVal != MSD_OK)
 	{
-		retVal = msdSetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, (MSD_U8)14, (MSD_U8)1, (MSD_U16)0);
-		if (retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->atuRegsSem);
-			return retVal;
-		}
+		msdSemGive(dev->devNum, dev->atuRegsSem);
+		return retVal;
 	}
 
-    /* Wait until the ATU in ready. */
-	data = (MSD_U16)1;
-	while (data == (MSD_U16)1)
-    {
-		retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-        if(retVal != MSD_OK)
-        {
-            msdSemGive(dev->devNum, dev->atuRegsSem);
-            return retVal;
-        }
-    }
+	/*Check if in SplitATU mode, if yes, set the E-CID mode as 0 for ATU operation*/
+	if ((fidData & (MSD_U16)0x8000) != (MSD_U16)0)
+	{
+		fidData &= (MSD_U16)~(MSD_U16)0x4000;
+	}
 
     opcodeData = 0;
 
+	retVal = msdRegBatchBegin(dev->devNum);
+	if (retVal != MSD_OK)
+	{
+		msdSemGive(dev->devNum, dev->atuRegsSem);
+		return retVal;
+	}
+
     switch (atuOp)
     {
         case FIR_LOAD_PURGE_ENTRY:
@@ -2225,24 +2231,14 @@ static MSD_STATUS Fir_atuOperationPerform
                 data = (MSD_U16)((MSD_U16)((entry->portVec & portMask) << 4) | ((entry->entryState) & 0xF));
             }
 			opcodeData |= (MSD_U16)((entry->exPrio.macQPri & (MSD_U16)0x7) << 8) | (MSD_U16)(entry->exPrio.macFPri & (MSD_U16)0x7);
-			retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->atuRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, data);
 			/* pass thru */
 
         case FIR_GET_NEXT_ENTRY:
 			for(i = 0; i < 3U; i++)
 			{
 				data = (MSD_U16)((MSD_U16)entry->macAddr.arEther[2U * i] << 8) | (MSD_U16)entry->macAddr.arEther[1U + (2U * i)];
-				retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_MAC_BASE + i, data);
-				if(retVal != MSD_OK)
-				{
-					msdSemGive(dev->devNum, dev->atuRegsSem);
-					return retVal;
-				}
+				(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_MAC_BASE + i, data);
 			}
 
 			break;
@@ -2259,46 +2255,46 @@ static MSD_STATUS Fir_atuOperationPerform
 			{
 				data = 0;
 			}
-			retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->atuRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, data);
 			break;
 
         case FIR_SERVICE_VIOLATIONS:
 			break;
 
         default:
+			(void)msdRegBatchCommit(dev->devNum);
 			msdSemGive(dev->devNum, dev->atuRegsSem);
             return MSD_FAIL;
 			break;
     }
 
     /* Set DBNum */
-	retVal = msdSetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, (MSD_U8)0, (MSD_U8)12, (MSD_U16)(entry->DBNum & (MSD_U16)0xFFF));
-	if(retVal != MSD_OK)
-	{
-		msdSemGive(dev->devNum, dev->atuRegsSem);
-		return retVal;
-	}
+	fidData = (MSD_U16)((fidData & (MSD_U16)~(MSD_U16)0xFFF) | (entry->DBNum & (MSD_U16)0xFFF));
+	(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, fidData);
 
     /* Set the ATU Operation register in addtion to DBNum setup  */
-	retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, &data);
-	if(retVal != MSD_OK)
-	{
-		msdSemGive(dev->devNum, dev->atuRegsSem);
-		return retVal;
-	}
-	data &= (MSD_U16)0x0fff;
+	data = opReg & (MSD_U16)0x0fff;
 	if(atuOp == FIR_LOAD_PURGE_ENTRY)
 	{
 		data &= (MSD_U16)0x0f8;
 	}
 	opcodeData |= (MSD_U16)((MSD_U16)0x8000 | (MSD_U16)((MSD_U16)atuOp << 12) | data);
+	(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, opcodeData);
+
+    /* Service violation and get next wait for the response and read it back in the same batch */
+    if((atuOp == FIR_SERVICE_VIOLATIONS) || (atuOp == FIR_GET_NEXT_ENTRY))
+    {
+		(void)msdRegBatchWaitOnBit(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)15, (MSD_U8)0);
+		(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, &opReg);
+		(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, &fidData);
+		(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, &atuData);
+		for(i = 0; i < 3U; i++)
+		{
+			(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_MAC_BASE + i, &macData[i]);
+		}
+    }
 
-	retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, opcodeData);
+	retVal = msdRegBatchCommit(dev->devNum);
     if(retVal != MSD_OK)
     {
         msdSemGive(dev->devNum, dev->atuRegsSem);
@@ -2308,25 +2304,8 @@ static MSD_STATUS Fir_atuOperationPerform
     /* If the operation is to service violation operation wait for the response   */
     if(atuOp == FIR_SERVICE_VIOLATIONS)
     {
-        /* Wait until the VTU in ready. */
-		data = (MSD_U16)1;
-		while (data == (MSD_U16)1)
-        {
-			retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-            if(retVal != MSD_OK)
-            {
-                msdSemGive(dev->devNum, dev->atuRegsSem);
-                return retVal;
-            }
-        }
-
         /* Fir_get the Interrupt Cause */
-		retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)4, (MSD_U8)4, &data);
-        if(retVal != MSD_OK)
-        {
-            msdSemGive(dev->devNum, dev->atuRegsSem);
-            return retVal;
-        }
+		data = (MSD_U16)((opReg >> 4) & (MSD_U16)0xF);
 
         switch (data)
         {
@@ -2350,92 +2329,35 @@ static MSD_STATUS Fir_atuOperationPerform
         }
 
         /* Fir_get the DBNum that was involved in the violation */
-
-        entry->DBNum = 0;
-		
-		retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_FID_REG, (MSD_U8)0, (MSD_U8)12, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->atuRegsSem);
-			return retVal;
-		}
-		entry->DBNum = (MSD_U16)data;
+		entry->DBNum = (MSD_U16)(fidData & (MSD_U16)0xFFF);
 
         /* Fir_get the Source Port ID that was involved in the violation */
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, &data);
-        if(retVal != MSD_OK)
-        {
-            msdSemGive(dev->devNum, dev->atuRegsSem);
-            return retVal;
-        }
-
-		entry->entryState = (MSD_U8)(data & (MSD_U8)0xF);
+		entry->entryState = (MSD_U8)(atuData & (MSD_U8)0xF);
 
         /* Get the Mac address  */
         for(i = 0; i < 3U; i++)
         {
-			retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_MAC_BASE + i, &data);
-            if(retVal != MSD_OK)
-            {
-                msdSemGive(dev->devNum, dev->atuRegsSem);
-                return retVal;
-            }
-			entry->macAddr.arEther[2U * i] = (MSD_U8)((data >> 8) & (MSD_U16)0x00FF);
-			entry->macAddr.arEther[1U + (2U * i)] = (MSD_U8)(data & (MSD_U16)0xFF);
+			entry->macAddr.arEther[2U * i] = (MSD_U8)((macData[i] >> 8) & (MSD_U16)0x00FF);
+			entry->macAddr.arEther[1U + (2U * i)] = (MSD_U8)(macData[i] & (MSD_U16)0xFF);
         }
     } /* end of service violations */
 	
     /* If the operation is a get next operation wait for the response   */
     if(atuOp == FIR_GET_NEXT_ENTRY)
     {
-        entry->LAG = MSD_FALSE;
-        entry->exPrio.macFPri = 0;
-        entry->exPrio.macQPri = 0;
-
-        /* Wait until the ATU in ready. */
-		data = (MSD_U16)1;
-		while (data == (MSD_U16)1)
-        {
-			retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-            if(retVal != MSD_OK)
-            {
-                msdSemGive(dev->devNum, dev->atuRegsSem);
-                return retVal;
-            }
-        }
-
         /* Get the Mac address  */
         for(i = 0; i < 3U; i++)
         {
-			retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_MAC_BASE + i, &data);
-            if(retVal != MSD_OK)
-            {
-                msdSemGive(dev->devNum, dev->atuRegsSem);
-                return retVal;
-            }
-			entry->macAddr.arEther[2U * i] = (MSD_U8)((data >> 8) & (MSD_U16)0x00FF);
-			entry->macAddr.arEther[1U + (2U * i)] = (MSD_U8)(data & (MSD_U16)0xFF);
-        }
-
-		/* Fir register offset 0xC extended*/
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_DATA_REG, &data);
-        if(retVal != MSD_OK)
-        {
-            msdSemGive(dev->devNum, dev->atuRegsSem);
-            return retVal;
+			entry->macAddr.arEther[2U * i] = (MSD_U8)((macData[i] >> 8) & (MSD_U16)0x00FF);
+			entry->macAddr.arEther[1U + (2U * i)] = (MSD_U8)(macData[i] & (MSD_U16)0xFF);
         }
 
         /* Get the Atu data register fields */
-		entry->LAG = (data & (MSD_U16)0x8000) == 0x8000U ? MSD_TRUE : MSD_FALSE;
-		entry->portVec = (((data & (MSD_U16)0x3FF0) >> 4)) & portMask;
-		entry->entryState = (MSD_U8)(data & (MSD_U8)0xF);
+		entry->LAG = (atuData & (MSD_U16)0x8000) == 0x8000U ? MSD_TRUE : MSD_FALSE;
+		entry->portVec = (((atuData & (MSD_U16)0x3FF0) >> 4)) & portMask;
+		entry->entryState = (MSD_U8)(atuData & (MSD_U8)0xF);
 
-		retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION, (MSD_U8)0, (MSD_U8)11, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->atuRegsSem);
-			return retVal;
-		}
+		data = (MSD_U16)(opReg & (MSD_U16)0x7FF);
 		entry->exPrio.macFPri = (MSD_U8)(data & (MSD_U8)0x7);
 		entry->exPrio.macQPri = (MSD_U8)((data >> 8) & (MSD_U8)0x7);
     }
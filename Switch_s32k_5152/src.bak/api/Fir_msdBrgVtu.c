@@ -62,6 +62,26 @@ IN  MSD_QD_DEV     *dev,
 OUT FIR_MSD_VTU_MODE   *mode
 );
 
+static void Fir_vtuPackLoadWords
+(
+    IN  MSD_QD_DEV             *dev,
+    IN  FIR_MSD_VTU_ENTRY      *entry,
+    OUT FIR_MSD_VTU_LOAD_WORDS *words
+);
+
+static MSD_STATUS Fir_vtuLoadEntries_MultiChip
+(
+    IN  MSD_QD_DEV                   *dev,
+    IN  const FIR_MSD_VTU_LOAD_WORDS *words,
+    IN  MSD_U32                      count
+);
+
+/* Register commands queued for one entry by Fir_gvtuLoadEntries:
+ * wait on busy, DATA1, DATA2, VID, SID, FID and the operation register.
+ */
+#define FIR_VTU_LOAD_CMDS_PER_ENTRY		7U
+#define FIR_VTU_LOAD_ENTRIES_PER_BATCH	(MSD_REG_BATCH_MAX_CMDS / FIR_VTU_LOAD_CMDS_PER_ENTRY)
+
 
 /*******************************************************************************
 * Fir_gvtuGetEntryNext
@@ -355,15 +375,64 @@ MSD_STATUS Fir_gvtuAddEntry
     IN FIR_MSD_VTU_ENTRY *vtuEntry
 )
 {
-    MSD_U8               valid;
+    MSD_STATUS           retVal;
+    FIR_MSD_VTU_LOAD_WORDS words;
+
+    MSD_DBG_INFO(("Fir_gvtuAddEntry Called.\n"));
+
+	retVal = Fir_gvtuPackEntry(dev, vtuEntry, &words);
+	if (retVal == MSD_OK)
+	{
+		retVal = Fir_gvtuLoadEntries(dev, &words, (MSD_U32)1);
+		if (retVal != MSD_OK)
+		{
+			MSD_DBG_ERROR(("Fir_gvtuLoadEntries load entry returned: %s.\n", msdDisplayStatus(retVal)));
+		}
+	}
+
+    MSD_DBG_INFO(("Fir_gvtuAddEntry Exit.\n"));
+	return retVal;
+}
+
+/*******************************************************************************
+* Fir_gvtuPackEntry
+*
+* DESCRIPTION:
+*       Converts a VTU entry into the register words of a Load operation, for
+*       loading with Fir_gvtuLoadEntries. No register is accessed.
+*
+* INPUTS:
+*       vtuEntry - vtu entry to be packed.
+*
+* OUTPUTS:
+*       words - the packed register words.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS Fir_gvtuPackEntry
+(
+    IN  MSD_QD_DEV   *dev,
+    IN  FIR_MSD_VTU_ENTRY *vtuEntry,
+    OUT FIR_MSD_VTU_LOAD_WORDS *words
+)
+{
     MSD_STATUS           retVal = MSD_OK;
     MSD_U8               port; 
     MSD_LPORT            lport; 
     FIR_MSD_VTU_ENTRY    entry;
 
-    MSD_DBG_INFO(("Fir_gvtuAddEntry Called.\n"));
-
-	if ((vtuEntry->vid > (MSD_U16)0xfff) || (vtuEntry->sid > (MSD_U8)0x3f) || (vtuEntry->DBNum > (MSD_U16)0xfff))
+	if ((vtuEntry == NULL) || (words == NULL))
+	{
+		MSD_DBG_ERROR(("Input param in Fir_gvtuPackEntry is NULL.\n"));
+		retVal = MSD_BAD_PARAM;
+	}
+	else if ((vtuEntry->vid > (MSD_U16)0xfff) || (vtuEntry->sid > (MSD_U8)0x3f) || (vtuEntry->DBNum > (MSD_U16)0xfff))
 	{
 		MSD_DBG_ERROR(("Bad vid or sid or DBNum: vid %d sid %d DBNum %d.\n", vtuEntry->vid, vtuEntry->sid, vtuEntry->DBNum));
 		retVal = MSD_BAD_PARAM;
@@ -374,20 +443,7 @@ MSD_STATUS Fir_gvtuAddEntry
 		entry.vid = vtuEntry->vid;
 		entry.vidPolicy = vtuEntry->vidPolicy;
 		entry.sid = vtuEntry->sid;
-		entry.vidExInfo.useVIDQPri = vtuEntry->vidExInfo.useVIDQPri;
-		entry.vidExInfo.vidQPri = vtuEntry->vidExInfo.vidQPri;
-		entry.vidExInfo.useVIDFPri = vtuEntry->vidExInfo.useVIDFPri;
-		entry.vidExInfo.vidFPri = vtuEntry->vidExInfo.vidFPri;
-		entry.vidExInfo.dontLearn = vtuEntry->vidExInfo.dontLearn;
-		entry.vidExInfo.filterUC = vtuEntry->vidExInfo.filterUC;
-		entry.vidExInfo.filterBC = vtuEntry->vidExInfo.filterBC;
-		entry.vidExInfo.filterMC = vtuEntry->vidExInfo.filterMC;
-		entry.vidExInfo.routeDis = vtuEntry->vidExInfo.routeDis;
-		entry.vidExInfo.mldSnoop = vtuEntry->vidExInfo.mldSnoop;
-		entry.vidExInfo.igmpSnoop = vtuEntry->vidExInfo.igmpSnoop;
-		entry.vidExInfo.vtuPage = vtuEntry->vidExInfo.vtuPage;
-
-		valid = (MSD_U8)1; /* for load operation */
+		entry.vidExInfo = vtuEntry->vidExInfo;
 
 		for (port = 0; port < dev->maxPorts; port++)
 		{
@@ -410,15 +466,155 @@ MSD_STATUS Fir_gvtuAddEntry
 
 		if (retVal != MSD_BAD_PARAM)
 		{
-			retVal = Fir_vtuOperationPerform(dev, FIR_LOAD_PURGE_ENTRY, &valid, &entry);
-			if (retVal != MSD_OK)
+			Fir_vtuPackLoadWords(dev, &entry, words);
+		}
+	}
+
+	return retVal;
+}
+
+/*******************************************************************************
+* Fir_gvtuLoadEntries
+*
+* DESCRIPTION:
+*       Creates or updates a set of VTU entries packed by Fir_gvtuPackEntry.
+*       The VTU registers are held once for the whole set, the Load operations
+*       are streamed in register batches and each entry only waits for the
+*       previous operation to finish.
+*
+* INPUTS:
+*       words - the packed entries to load.
+*       count - number of entries in words.
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL- on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       Data, SID and FID registers equal to the previous entry of the same
+*       batch are not written again.
+*
+*******************************************************************************/
+MSD_STATUS Fir_gvtuLoadEntries
+(
+    IN  MSD_QD_DEV   *dev,
+    IN  const FIR_MSD_VTU_LOAD_WORDS *words,
+    IN  MSD_U32      count
+)
+{
+	MSD_STATUS       retVal;
+	MSD_U16          opReg;
+	MSD_U16          opData;
+	MSD_U32          i;
+	MSD_U32          batchEnd;
+	const FIR_MSD_VTU_LOAD_WORDS *prev;
+	const FIR_MSD_VTU_LOAD_WORDS *cur;
+
+	MSD_DBG_INFO(("Fir_gvtuLoadEntries Called.\n"));
+
+	if ((words == NULL) && (count > 0U))
+	{
+		MSD_DBG_ERROR(("Input param words in Fir_gvtuLoadEntries is NULL.\n"));
+		return MSD_BAD_PARAM;
+	}
+	if (count == 0U)
+	{
+		return MSD_OK;
+	}
+
+	if (IS_SMI_MULTICHIP_SUPPORTED(dev) == 1)
+	{
+		return Fir_vtuLoadEntries_MultiChip(dev, words, count);
+	}
+
+	msdSemTake(dev->devNum, dev->vtuRegsSem, OS_WAIT_FOREVER);
+
+	/* Wait until the VTU in ready and read back the Operation register once for the whole set */
+	opReg = 0;
+	retVal = msdRegBatchBegin(dev->devNum);
+	if (retVal != MSD_OK)
+	{
+		msdSemGive(dev->devNum, dev->vtuRegsSem);
+		return retVal;
+	}
+	(void)msdRegBatchWaitOnBit(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)0);
+	(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, &opReg);
+	retVal = msdRegBatchCommit(dev->devNum);
+	if (retVal != MSD_OK)
+	{
+		msdSemGive(dev->devNum, dev->vtuRegsSem);
+		return retVal;
+	}
+
+	opData = opReg & (MSD_U16)0xC00;
+	opData |= (MSD_U16)0x8000 | (MSD_U16)((MSD_U16)FIR_LOAD_PURGE_ENTRY << 12);
+
+	/* One batch per FIR_VTU_LOAD_ENTRIES_PER_BATCH entries (one MSD_RegRW frame with RMU),
+	 * other SMI/RMU users can access the device between the batches
+	 */
+	for (i = 0; i < count; i = batchEnd)
+	{
+		batchEnd = i + FIR_VTU_LOAD_ENTRIES_PER_BATCH;
+		if (batchEnd > count)
+		{
+			batchEnd = count;
+		}
+
+		retVal = msdRegBatchBegin(dev->devNum);
+		if (retVal != MSD_OK)
+		{
+			break;
+		}
+
+		/* the registers are written again at the start of each batch */
+		prev = NULL;
+		for (; i < batchEnd; i++)
+		{
+			cur = &words[i];
+
+			/* the data registers must not be changed while the previous Load is running */
+			if (i > 0U)
 			{
-				MSD_DBG_ERROR(("Fir_vtuOperationPerform load entry returned: %d.\n", msdDisplayStatus(retVal)));
+				(void)msdRegBatchWaitOnBit(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)0);
 			}
+
+			if ((prev == NULL) || (prev->data1 != cur->data1))
+			{
+				(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, cur->data1);
+			}
+			if ((dev->maxPorts > (MSD_U8)8) && ((prev == NULL) || (prev->data2 != cur->data2)))
+			{
+				(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, cur->data2);
+			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, cur->vidReg);
+			if ((prev == NULL) || (prev->sidReg != cur->sidReg))
+			{
+				(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, cur->sidReg);
+			}
+			if ((prev == NULL) || (prev->fidReg != cur->fidReg))
+			{
+				(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, cur->fidReg);
+			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, opData);
+
+			prev = cur;
+		}
+
+		retVal = msdRegBatchCommit(dev->devNum);
+		if (retVal != MSD_OK)
+		{
+			MSD_DBG_ERROR(("Fir_gvtuLoadEntries batch commit returned: %s.\n", msdDisplayStatus(retVal)));
+			break;
 		}
 	}
 
-    MSD_DBG_INFO(("Fir_gvtuAddEntry Exit.\n"));
+	msdSemGive(dev->devNum, dev->vtuRegsSem);
+
+	MSD_DBG_INFO(("Fir_gvtuLoadEntries Exit.\n"));
 	return retVal;
 }
 
@@ -1261,6 +1457,10 @@ static MSD_STATUS Fir_vtuOperationPerform
 {
 	MSD_STATUS       retVal;         /* Functions return value.*/
 	MSD_U16          data;           /* Data to be set into the register */
+	MSD_U16          opReg;
+	MSD_U16          vidData, sidData, fidData, data1, data2;
+	MSD_BOOL         isLoad;
+	FIR_MSD_VTU_LOAD_WORDS words;
 
     if (IS_SMI_MULTICHIP_SUPPORTED(dev) == 1)
     {
@@ -1276,20 +1476,37 @@ static MSD_STATUS Fir_vtuOperationPerform
        // msdSemTake(dev->devNum, dev->vtuRegsSem, OS_WAIT_FOREVER);//
     }
     // msdSemTake(dev->devNum, dev->vtuRegsSem, OS_WAIT_FOREVER);//2024.12.5 delete
-	data = (MSD_U16)1;
-	while (data == (MSD_U16)1)
-    {
-		retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-        if(retVal != MSD_OK)
-        {
-            msdSemGive(dev->devNum, dev->vtuRegsSem);
-            return retVal;
-        }
-    }
+
+	/* Wait until the VTU in ready and read back the Operation register */
+	opReg = 0;
+	retVal = msdRegBatchBegin(dev->devNum);
+	if(retVal != MSD_OK)
+	{
+		msdSemGive(dev->devNum, dev->vtuRegsSem);
+		return retVal;
+	}
+	(void)msdRegBatchWaitOnBit(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)0);
+	(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, &opReg);
+	retVal = msdRegBatchCommit(dev->devNum);
+	if(retVal != MSD_OK)
+	{
+		msdSemGive(dev->devNum, dev->vtuRegsSem);
+		return retVal;
+	}
+
+	retVal = msdRegBatchBegin(dev->devNum);
+	if(retVal != MSD_OK)
+	{
+		msdSemGive(dev->devNum, dev->vtuRegsSem);
+		return retVal;
+	}
+
+	/* Load writes the words packed by Fir_vtuPackLoadWords below */
+	isLoad = ((vtuOp == FIR_LOAD_PURGE_ENTRY) && (*valid == (MSD_U8)1)) ? MSD_TRUE : MSD_FALSE;
 
 	/* Set the VTU data register    */
 	/* There is no need to setup data reg. on flush, Fir_get next, or service violation */
-	if((vtuOp != FIR_FLUSH_ALL) && (vtuOp != FIR_GET_NEXT_ENTRY) && (vtuOp != FIR_SERVICE_VIOLATIONS))
+	if((vtuOp != FIR_FLUSH_ALL) && (vtuOp != FIR_GET_NEXT_ENTRY) && (vtuOp != FIR_SERVICE_VIOLATIONS) && (isLoad == MSD_FALSE))
 	{
 		/****************** VTU DATA 1 REG *******************/
 
@@ -1299,12 +1516,7 @@ static MSD_STATUS Fir_vtuOperationPerform
 			| (MSD_U16)(((MSD_U16)entry->memberTagP[4] & (MSD_U16)3) << 8) | (MSD_U16)(((MSD_U16)entry->memberTagP[5] & (MSD_U16)3) << 10)
 			| (MSD_U16)(((MSD_U16)entry->memberTagP[6] & (MSD_U16)3) << 12) | (MSD_U16)(((MSD_U16)entry->memberTagP[7] & (MSD_U16)3) << 14));
 
-		retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}
+		(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, data);
 
 	    /****************** VTU DATA 2 REG *******************/
 		if(dev->maxPorts > (MSD_U8)8)
@@ -1323,80 +1535,32 @@ static MSD_STATUS Fir_vtuOperationPerform
 				data |= (MSD_U16)((MSD_U16)1 << 11) | (MSD_U16)(((MSD_U16)entry->vidExInfo.vidFPri & (MSD_U16)0x7) << 8);
 			}
 
-			retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, data);
-			if(retVal != MSD_OK)
-			{
-			  msdSemGive(dev->devNum, dev->vtuRegsSem);
-			  return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, data);
 		}
 	}
 
 	/* Set the VID register (FIR_QD_REG_VTU_VID_REG) */
 	/* There is no need to setup VID reg. on flush and service violation */
-	if((vtuOp != FIR_FLUSH_ALL) && (vtuOp != FIR_SERVICE_VIOLATIONS) )
+	if((vtuOp != FIR_FLUSH_ALL) && (vtuOp != FIR_SERVICE_VIOLATIONS) && (isLoad == MSD_FALSE))
 	{
 		data = 0;
 
 		data |= (MSD_U16)(((MSD_U16)entry->vidExInfo.vtuPage & (MSD_U16)0x1) << 13) | ((entry->vid) & (MSD_U16)0xFFF) | (MSD_U16)((MSD_U16)*valid << 12);
-		retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}        
+		(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, data);
 	}
 
-	/* Set SID, FID, VIDPolicy, if it's Load operation */
-	if ((vtuOp == FIR_LOAD_PURGE_ENTRY) && (*valid == (MSD_U8)1))
+	/* Set data, VID, SID, FID and VIDPolicy, if it's Load operation */
+	if (isLoad == MSD_TRUE)
 	{
-		data = (MSD_U16)((MSD_U16)entry->sid & (MSD_U16)0x3F);
-		if (entry->vidExInfo.dontLearn == MSD_TRUE)
-		{
-			data |= (MSD_U16)0x8000;
-		}
-		if (entry->vidExInfo.filterUC == MSD_TRUE)
-		{
-			data |= (MSD_U16)0x4000;
-		}
-		if (entry->vidExInfo.filterBC == MSD_TRUE)
-		{
-			data |= (MSD_U16)0x2000;
-		}
-		if (entry->vidExInfo.filterMC == MSD_TRUE)
-		{
-			data |= (MSD_U16)0x1000;
-		}
-		if (entry->vidExInfo.routeDis == MSD_TRUE)
-		{
-			data |= (MSD_U16)0x0400;
-		}
-		if (entry->vidExInfo.mldSnoop == MSD_TRUE)
-		{
-			data |= (MSD_U16)0x0200;
-		}
-		if (entry->vidExInfo.igmpSnoop == MSD_TRUE)
+		Fir_vtuPackLoadWords(dev, entry, &words);
+		(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, words.data1);
+		if(dev->maxPorts > (MSD_U8)8)
 		{
-			data |= (MSD_U16)0x0100;
+			(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, words.data2);
 		}
-
-		retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}        
-
-		data = (MSD_U16)((MSD_U16)entry->vidPolicy << 12);
-
-		data |= entry->DBNum & (MSD_U16)0xFFF;
-
-		retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}        
+		(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, words.vidReg);
+		(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, words.sidReg);
+		(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, words.fidReg);
 	}
 
 	/* Start the VTU Operation by defining the DBNum, vtuOp and VTUBusy    */
@@ -1404,56 +1568,43 @@ static MSD_STATUS Fir_vtuOperationPerform
 	 * Flush operation will skip the above two setup (for data and vid), and 
 	 * come to here directly
 	*/
+	data = opReg & (MSD_U16)0xC00;
+	data |= (MSD_U16)0x8000 | (MSD_U16)((MSD_U16)vtuOp << 12);
 
-	retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, &data);
-	if(retVal != MSD_OK)
+	(void)msdRegBatchWrite(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, data);
+
+	/* only two operations need to go through the mess below to Fir_get some data 
+	* after the operations -  service violation and Fir_get next entry
+	*/
+	if((vtuOp == FIR_SERVICE_VIOLATIONS) || (vtuOp == FIR_GET_NEXT_ENTRY))
 	{
-		msdSemGive(dev->devNum, dev->vtuRegsSem);
-		return retVal;
+		/* Wait until the VTU in ready, the result registers are read in the same batch */
+		(void)msdRegBatchWaitOnBit(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)0);
+		(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, &vidData);
+		if(vtuOp == FIR_GET_NEXT_ENTRY)
+		{
+			(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, &sidData);
+			(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, &fidData);
+			(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, &data1);
+			(void)msdRegBatchRead(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, &data2);
+		}
 	}
 
-	data &= (MSD_U16)0xC00;
-	data |= (MSD_U16)0x8000 | (MSD_U16)((MSD_U16)vtuOp << 12);
-
-	retVal = msdSetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, data);
+	retVal = msdRegBatchCommit(dev->devNum);
 	if(retVal != MSD_OK)
 	{
 		msdSemGive(dev->devNum, dev->vtuRegsSem);
 		return retVal;
 	}
 
-	/* only two operations need to go through the mess below to Fir_get some data 
-	* after the operations -  service violation and Fir_get next entry
-	*/
-
 	/* If the operation is to service violation operation wait for the response   */
 	if(vtuOp == FIR_SERVICE_VIOLATIONS)
 	{
-		/* Wait until the VTU in ready. */
-		data = (MSD_U16)1;
-		while (data == (MSD_U16)1)
-		{
-			retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->vtuRegsSem);
-				return retVal;
-			}
-		}
-
-		/* Fir_get the VID that was involved in the violation */
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}
-
 		/* Get the vid - bits 0-11 */
-		entry->vid = data & (MSD_U16)0xFFF;
+		entry->vid = vidData & (MSD_U16)0xFFF;
 
 		/* Get the page vid - bit 12 */
-		entry->vidExInfo.vtuPage = (MSD_U8)((data & (MSD_U16)0x2000) >> 13);
+		entry->vidExInfo.vtuPage = (MSD_U8)((vidData & (MSD_U16)0x2000) >> 13);
 
 	} /* end of service violations */
 
@@ -1469,35 +1620,15 @@ static MSD_STATUS Fir_vtuOperationPerform
 		entry->sid = 0;
 		entry->vidPolicy = MSD_FALSE;
 
-		/* Wait until the VTU in ready. */
-		data = (MSD_U16)1;
-		while (data == (MSD_U16)1)
-		{
-			retVal = msdGetAnyRegField(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->vtuRegsSem);
-				return retVal;
-			}
-		}
-
-
 		/****************** Fir_get the vid *******************/
 
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}
-
 		/* the vid is bits 0-11 */
-		entry->vid = data & (MSD_U16)0xFFF;
+		entry->vid = vidData & (MSD_U16)0xFFF;
 
-		entry->vidExInfo.vtuPage = (MSD_U8)((data >> 13) & (MSD_U8)0x1);
+		entry->vidExInfo.vtuPage = (MSD_U8)((vidData >> 13) & (MSD_U8)0x1);
 
 		/* the vid valid is bits 12 */
-		*valid = (MSD_U8)((data >> 12) & (MSD_U8)0x1);
+		*valid = (MSD_U8)((vidData >> 12) & (MSD_U8)0x1);
 
 		if (*valid == (MSD_U8)0)
 		{
@@ -1506,63 +1637,37 @@ static MSD_STATUS Fir_vtuOperationPerform
 		}
 
 		/****************** Fir_get the SID *******************/
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}        
-		entry->sid = (MSD_U8)(data & (MSD_U8)0x3F);
-		
-		entry->vidExInfo.dontLearn = (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x8000) >> 15);
-		entry->vidExInfo.filterUC =  (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x4000)>>14);
-		entry->vidExInfo.filterBC =  (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x2000)>>13);
-		entry->vidExInfo.filterMC =  (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x1000)>>12);
-		entry->vidExInfo.routeDis =  (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x0400)>>10);
-		entry->vidExInfo.mldSnoop =  (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x0200)>>9);
-		entry->vidExInfo.igmpSnoop = (MSD_BOOL)(MSD_U16)((MSD_U16)(data & (MSD_U16)0x0100)>>8);
-
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}   
+		entry->sid = (MSD_U8)(sidData & (MSD_U8)0x3F);
 		
-		entry->vidPolicy = (MSD_BOOL)(MSD_U16)((MSD_U16)(data >> 12) & (MSD_U16)0x1);
-		entry->DBNum = data & (MSD_U16)0xFFF;
+		entry->vidExInfo.dontLearn = (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x8000) >> 15);
+		entry->vidExInfo.filterUC =  (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x4000)>>14);
+		entry->vidExInfo.filterBC =  (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x2000)>>13);
+		entry->vidExInfo.filterMC =  (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x1000)>>12);
+		entry->vidExInfo.routeDis =  (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x0400)>>10);
+		entry->vidExInfo.mldSnoop =  (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x0200)>>9);
+		entry->vidExInfo.igmpSnoop = (MSD_BOOL)(MSD_U16)((MSD_U16)(sidData & (MSD_U16)0x0100)>>8);
 
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}
+		entry->vidPolicy = (MSD_BOOL)(MSD_U16)((MSD_U16)(fidData >> 12) & (MSD_U16)0x1);
+		entry->DBNum = fidData & (MSD_U16)0xFFF;
 
 		/* Fir_get data from data register for ports 0 to 7 */
-		entry->memberTagP[0] = (FIR_MSD_MEMTAGP)(MSD_U16)(data & (MSD_U16)3);
-		entry->memberTagP[1]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 2) & (MSD_U16)3);
-		entry->memberTagP[2]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 4) & (MSD_U16)3);
-		entry->memberTagP[3]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 6) & (MSD_U16)3);
-		entry->memberTagP[4]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 8) & (MSD_U16)3);
-		entry->memberTagP[5]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 10) & (MSD_U16)3);
-		entry->memberTagP[6]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 12) & (MSD_U16)3);
-		entry->memberTagP[7]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 14) & (MSD_U16)3);
+		entry->memberTagP[0] = (FIR_MSD_MEMTAGP)(MSD_U16)(data1 & (MSD_U16)3);
+		entry->memberTagP[1]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 2) & (MSD_U16)3);
+		entry->memberTagP[2]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 4) & (MSD_U16)3);
+		entry->memberTagP[3]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 6) & (MSD_U16)3);
+		entry->memberTagP[4]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 8) & (MSD_U16)3);
+		entry->memberTagP[5]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 10) & (MSD_U16)3);
+		entry->memberTagP[6]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 12) & (MSD_U16)3);
+		entry->memberTagP[7]  = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data1 >> 14) & (MSD_U16)3);
 
 		/* Fir_get data from data register for ports 8 to 10 */
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, &data);
-		if(retVal != MSD_OK)
-		{
-			msdSemGive(dev->devNum, dev->vtuRegsSem);
-			return retVal;
-		}
-		entry->memberTagP[8] = (FIR_MSD_MEMTAGP)(MSD_U16)(data & (MSD_U16)3);
-		entry->memberTagP[9] = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data >> 2) & (MSD_U16)3);
+		entry->memberTagP[8] = (FIR_MSD_MEMTAGP)(MSD_U16)(data2 & (MSD_U16)3);
+		entry->memberTagP[9] = (FIR_MSD_MEMTAGP)(MSD_U16)((MSD_U16)(data2 >> 2) & (MSD_U16)3);
 
-		if ((data & (MSD_U16)0x8000) != (MSD_U16)0)
+		if ((data2 & (MSD_U16)0x8000) != (MSD_U16)0)
 		{
 			entry->vidExInfo.useVIDQPri = MSD_TRUE;
-			entry->vidExInfo.vidQPri = (MSD_U8)((data >> 12) & (MSD_U8)0x7);
+			entry->vidExInfo.vidQPri = (MSD_U8)((data2 >> 12) & (MSD_U8)0x7);
 		}
 		else
 		{
@@ -1570,10 +1675,10 @@ static MSD_STATUS Fir_vtuOperationPerform
 			entry->vidExInfo.vidQPri = (MSD_U8)0;
 		}
 		
-		if ((data & (MSD_U16)0x800) != (MSD_U16)0)
+		if ((data2 & (MSD_U16)0x800) != (MSD_U16)0)
 		{
 			entry->vidExInfo.useVIDFPri = MSD_TRUE;
-			entry->vidExInfo.vidFPri = (MSD_U8)((data >> 8) & (MSD_U8)0x7);
+			entry->vidExInfo.vidFPri = (MSD_U8)((data2 >> 8) & (MSD_U8)0x7);
 		}
 		else
 		{
@@ -1585,6 +1690,176 @@ static MSD_STATUS Fir_vtuOperationPerform
 	msdSemGive(dev->devNum, dev->vtuRegsSem);
 	return MSD_OK;
 }
+/*******************************************************************************
+* Fir_vtuPackLoadWords
+*
+* DESCRIPTION:
+*       Packs a VTU entry with physical port memberTag into the register words
+*       of a Load operation. Used by Fir_gvtuPackEntry and by the Load of
+*       Fir_vtuOperationPerform.
+*
+* INPUTS:
+*       entry - VTU entry, memberTagP is indexed by physical port.
+*
+* OUTPUTS:
+*       words - the packed register words, the valid bit is set.
+*
+* RETURNS:
+*       None.
+*
+* COMMENTS:
+*		None.
+*
+*******************************************************************************/
+static void Fir_vtuPackLoadWords
+(
+    IN  MSD_QD_DEV             *dev,
+    IN  FIR_MSD_VTU_ENTRY      *entry,
+    OUT FIR_MSD_VTU_LOAD_WORDS *words
+)
+{
+	MSD_U16          data;
+
+	/* memberTag of ports 0 to 7 */
+	words->data1 = (MSD_U16)(((MSD_U16)entry->memberTagP[0] & (MSD_U16)3) | (MSD_U16)(((MSD_U16)entry->memberTagP[1] & (MSD_U16)3) << 2)
+		| (MSD_U16)(((MSD_U16)entry->memberTagP[2] & (MSD_U16)3) << 4) | (MSD_U16)(((MSD_U16)entry->memberTagP[3] & (MSD_U16)3) << 6)
+		| (MSD_U16)(((MSD_U16)entry->memberTagP[4] & (MSD_U16)3) << 8) | (MSD_U16)(((MSD_U16)entry->memberTagP[5] & (MSD_U16)3) << 10)
+		| (MSD_U16)(((MSD_U16)entry->memberTagP[6] & (MSD_U16)3) << 12) | (MSD_U16)(((MSD_U16)entry->memberTagP[7] & (MSD_U16)3) << 14));
+
+	/* memberTag of ports 8 to 10 and the priority override */
+	data = 0;
+	if (dev->maxPorts > (MSD_U8)8)
+	{
+		data = (MSD_U16)((MSD_U16)((MSD_U16)entry->memberTagP[8] & (MSD_U16)3) | (MSD_U16)(((MSD_U16)entry->memberTagP[9] & (MSD_U16)3) << 2)
+			| (MSD_U16)(((MSD_U16)entry->memberTagP[10] & (MSD_U16)3) << 4));
+
+		if (entry->vidExInfo.useVIDQPri == MSD_TRUE)
+		{
+			data |= (MSD_U16)0x8000 | (MSD_U16)(((MSD_U16)entry->vidExInfo.vidQPri & (MSD_U16)0x7) << 12);
+		}
+
+		if (entry->vidExInfo.useVIDFPri == MSD_TRUE)
+		{
+			data |= (MSD_U16)((MSD_U16)1 << 11) | (MSD_U16)(((MSD_U16)entry->vidExInfo.vidFPri & (MSD_U16)0x7) << 8);
+		}
+	}
+	words->data2 = data;
+
+	words->vidReg = (MSD_U16)(((MSD_U16)entry->vidExInfo.vtuPage & (MSD_U16)0x1) << 13) | ((entry->vid) & (MSD_U16)0xFFF) | (MSD_U16)((MSD_U16)1 << 12);
+
+	data = (MSD_U16)((MSD_U16)entry->sid & (MSD_U16)0x3F);
+	if (entry->vidExInfo.dontLearn == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x8000;
+	}
+	if (entry->vidExInfo.filterUC == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x4000;
+	}
+	if (entry->vidExInfo.filterBC == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x2000;
+	}
+	if (entry->vidExInfo.filterMC == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x1000;
+	}
+	if (entry->vidExInfo.routeDis == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x0400;
+	}
+	if (entry->vidExInfo.mldSnoop == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x0200;
+	}
+	if (entry->vidExInfo.igmpSnoop == MSD_TRUE)
+	{
+		data |= (MSD_U16)0x0100;
+	}
+	words->sidReg = data;
+
+	words->fidReg = (MSD_U16)((MSD_U16)entry->vidPolicy << 12) | (entry->DBNum & (MSD_U16)0xFFF);
+}
+
+/*******************************************************************************
+* Fir_vtuLoadEntries_MultiChip
+*
+* DESCRIPTION:
+*       Multi-chip version of Fir_gvtuLoadEntries, the registers are accessed
+*       one by one through the multi-chip indirect access.
+*
+* INPUTS:
+*       words - the packed entries to load.
+*       count - number of entries in words.
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK on success,
+*       MSD_FAIL otherwise.
+*
+* COMMENTS:
+*		None.
+*
+*******************************************************************************/
+static MSD_STATUS Fir_vtuLoadEntries_MultiChip
+(
+    IN  MSD_QD_DEV                   *dev,
+    IN  const FIR_MSD_VTU_LOAD_WORDS *words,
+    IN  MSD_U32                      count
+)
+{
+	MSD_STATUS       retVal = MSD_OK;
+	MSD_U16          data;
+	MSD_U32          i;
+
+	msdSemTake(dev->devNum, dev->vtuRegsSem, OS_WAIT_FOREVER);
+
+	for (i = 0; (i < count) && (retVal == MSD_OK); i++)
+	{
+		data = (MSD_U16)1;
+		while ((data == (MSD_U16)1) && (retVal == MSD_OK))
+		{
+			retVal = Fir_msdDirectGetMultiChipRegField(dev, FIR_VTU_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
+		}
+
+		if (retVal == MSD_OK)
+		{
+			retVal = Fir_msdDirectSetMultiChipReg(dev, FIR_VTU_DATA1_REG, words[i].data1);
+		}
+		if ((retVal == MSD_OK) && (dev->maxPorts > (MSD_U8)8))
+		{
+			retVal = Fir_msdDirectSetMultiChipReg(dev, FIR_VTU_DATA2_REG, words[i].data2);
+		}
+		if (retVal == MSD_OK)
+		{
+			retVal = Fir_msdDirectSetMultiChipReg(dev, FIR_VTU_VID_REG, words[i].vidReg);
+		}
+		if (retVal == MSD_OK)
+		{
+			retVal = Fir_msdDirectSetMultiChipReg(dev, FIR_STU_SID_REG, words[i].sidReg);
+		}
+		if (retVal == MSD_OK)
+		{
+			retVal = Fir_msdDirectSetMultiChipReg(dev, FIR_VTU_FID_REG, words[i].fidReg);
+		}
+		if (retVal == MSD_OK)
+		{
+			retVal = Fir_msdDirectGetMultiChipReg(dev, FIR_VTU_OPERATION, &data);
+		}
+		if (retVal == MSD_OK)
+		{
+			data &= (MSD_U16)0xC00;
+			data |= (MSD_U16)0x8000 | (MSD_U16)((MSD_U16)FIR_LOAD_PURGE_ENTRY << 12);
+			retVal = Fir_msdDirectSetMultiChipReg(dev, FIR_VTU_OPERATION, data);
+		}
+	}
+
+	msdSemGive(dev->devNum, dev->vtuRegsSem);
+	return retVal;
+}
+
 MSD_STATUS Fir_gvtuDump
 (
 IN MSD_QD_DEV    *dev
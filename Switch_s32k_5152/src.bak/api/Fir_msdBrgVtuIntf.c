@@ -190,35 +190,22 @@ MSD_STATUS Fir_gvtuFlushIntf
 	return Fir_gvtuFlush(dev);
 }
 /*******************************************************************************
-* Fir_gvtuAddEntry
+* Fir_vtuEntryFromIntf
 *
 * DESCRIPTION:
-*       Creates the new entry in VTU table based on user input.
-*
-* INPUTS:
-*       vtuEntry - vtu entry to insert to the VTU.
-*
-* OUTPUTS:
-*       None
-*
-* RETURNS:
-*       MSD_OK  - on success
-*       MSD_FAIL- on error
-*       MSD_BAD_PARAM - if invalid parameter is given
-*
-* COMMENTS:
-*       None.
+*       Converts MSD_VTU_ENTRY (logical ports, vtuPage in vid bit 12) into
+*       FIR_MSD_VTU_ENTRY for Fir_gvtuAddEntry and Fir_gvtuPackEntry.
 *
 *******************************************************************************/
-MSD_STATUS Fir_gvtuAddEntryIntf
+static MSD_STATUS Fir_vtuEntryFromIntf
 (
     IN  MSD_QD_DEV   *dev,
-    IN MSD_VTU_ENTRY *vtuEntry
+    IN  MSD_VTU_ENTRY *vtuEntry,
+    OUT FIR_MSD_VTU_ENTRY *entry
 )
 {
 	MSD_U8               port;
 	MSD_LPORT               lport;
-	FIR_MSD_VTU_ENTRY entry;
 
 	if (NULL == vtuEntry)
 	{
@@ -231,22 +218,22 @@ MSD_STATUS Fir_gvtuAddEntryIntf
         return MSD_BAD_PARAM;
     }
 
-	entry.DBNum = vtuEntry->fid;
-	entry.vid = vtuEntry->vid & (MSD_U16)0xfff;
-	entry.vidPolicy = vtuEntry->vidPolicy;
-	entry.sid = vtuEntry->sid;
-	entry.vidExInfo.useVIDFPri = vtuEntry->vidExInfo.useVIDFPri;
-	entry.vidExInfo.vidFPri = vtuEntry->vidExInfo.vidFPri;
-	entry.vidExInfo.dontLearn = vtuEntry->vidExInfo.dontLearn;
-	entry.vidExInfo.filterUC = vtuEntry->vidExInfo.filterUC;
-	entry.vidExInfo.filterBC = vtuEntry->vidExInfo.filterBC;
-	entry.vidExInfo.filterMC = vtuEntry->vidExInfo.filterMC;
-	entry.vidExInfo.routeDis = vtuEntry->vidExInfo.routeDis;
-	entry.vidExInfo.mldSnoop = vtuEntry->vidExInfo.mldSnoop;
-	entry.vidExInfo.igmpSnoop = vtuEntry->vidExInfo.igmpSnoop;
-	entry.vidExInfo.useVIDQPri = vtuEntry->vidExInfo.useVIDQPri;
-	entry.vidExInfo.vidQPri = vtuEntry->vidExInfo.vidQPri;
-	entry.vidExInfo.vtuPage = (MSD_U8)(((MSD_U16)vtuEntry->vid >> 12) & (MSD_U16)0x1);
+	entry->DBNum = vtuEntry->fid;
+	entry->vid = vtuEntry->vid & (MSD_U16)0xfff;
+	entry->vidPolicy = vtuEntry->vidPolicy;
+	entry->sid = vtuEntry->sid;
+	entry->vidExInfo.useVIDFPri = vtuEntry->vidExInfo.useVIDFPri;
+	entry->vidExInfo.vidFPri = vtuEntry->vidExInfo.vidFPri;
+	entry->vidExInfo.dontLearn = vtuEntry->vidExInfo.dontLearn;
+	entry->vidExInfo.filterUC = vtuEntry->vidExInfo.filterUC;
+	entry->vidExInfo.filterBC = vtuEntry->vidExInfo.filterBC;
+	entry->vidExInfo.filterMC = vtuEntry->vidExInfo.filterMC;
+	entry->vidExInfo.routeDis = vtuEntry->vidExInfo.routeDis;
+	entry->vidExInfo.mldSnoop = vtuEntry->vidExInfo.mldSnoop;
+	entry->vidExInfo.igmpSnoop = vtuEntry->vidExInfo.igmpSnoop;
+	entry->vidExInfo.useVIDQPri = vtuEntry->vidExInfo.useVIDQPri;
+	entry->vidExInfo.vidQPri = vtuEntry->vidExInfo.vidQPri;
+	entry->vidExInfo.vtuPage = (MSD_U8)(((MSD_U16)vtuEntry->vid >> 12) & (MSD_U16)0x1);
 
 	for (lport = 0; lport<dev->numOfPorts; lport++)
 	{
@@ -257,11 +244,69 @@ MSD_STATUS Fir_gvtuAddEntryIntf
             return MSD_BAD_PARAM;
         }
 
-		entry.memberTagP[port] = vtuEntry->memberTagP[lport];
+		entry->memberTagP[port] = vtuEntry->memberTagP[lport];
+	}
+
+	return MSD_OK;
+}
+
+/*******************************************************************************
+* Fir_gvtuAddEntry
+*
+* DESCRIPTION:
+*       Creates the new entry in VTU table based on user input.
+*
+* INPUTS:
+*       vtuEntry - vtu entry to insert to the VTU.
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL- on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS Fir_gvtuAddEntryIntf
+(
+    IN  MSD_QD_DEV   *dev,
+    IN MSD_VTU_ENTRY *vtuEntry
+)
+{
+	FIR_MSD_VTU_ENTRY entry;
+	MSD_STATUS retVal;
+
+	retVal = Fir_vtuEntryFromIntf(dev, vtuEntry, &entry);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
 	}
 
 	return Fir_gvtuAddEntry(dev, &entry);
 }
+
+MSD_STATUS Fir_gvtuPackEntryIntf
+(
+    IN  MSD_QD_DEV   *dev,
+    IN  MSD_VTU_ENTRY *vtuEntry,
+    OUT FIR_MSD_VTU_LOAD_WORDS *words
+)
+{
+	FIR_MSD_VTU_ENTRY entry;
+	MSD_STATUS retVal;
+
+	retVal = Fir_vtuEntryFromIntf(dev, vtuEntry, &entry);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+
+	return Fir_gvtuPackEntry(dev, &entry, words);
+}
 /*******************************************************************************
 * Fir_gvtuDelEntry
 *
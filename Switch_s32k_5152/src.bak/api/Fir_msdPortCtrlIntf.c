@@ -1199,8 +1199,6 @@ MSD_STATUS Fir_gprtGetFIDNumber(IN MSD_QD_DEV* dev, IN MSD_LPORT port, OUT MSD_U
 	MSD_U16          tmpData1;       /* to keep the read valve for FID_3 0   */
 	MSD_U16          tmpData2 = 0;       /* to keep the read valve for FID_11 4   */      
 	MSD_U8			 phyAddr;
-	MSD_U8           i;
-	MSD_U8           portLen = 0;
 	MSD_U16          data = 0;
 
 	MSD_DBG_INFO(("Fir_gprtGetFIDNumber Called.\n"));
@@ -1241,8 +1239,7 @@ MSD_STATUS Fir_gprtSetFIDNumber(IN MSD_QD_DEV* dev, IN MSD_LPORT port, IN MSD_U1
 	MSD_U8           hwPort;            /* the physical port number     */
 	MSD_U16          data = 0;          /* to keep the read valve       */
 	MSD_U8			 phyAddr;
-	MSD_U8           i;
-	MSD_U16          tmpData = 0, tmpData1 = 0;
+	MSD_U16          tmpData = 0;
 
 
 	MSD_DBG_INFO(("Fir_gprtSetFIDNumber Called.\n"));
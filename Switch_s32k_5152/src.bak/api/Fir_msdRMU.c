@@ -0,0 +1,220 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+
+/********************************************************************************
+* Fir_msdRMU.c
+*
+* DESCRIPTION:
+*       API definitions for RMU table dumps
+*
+* DEPENDENCIES:
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+#include "Fir_msdRMU.h"
+#include "Fir_msdApiInternal.h"
+#include "msdSem.h"
+#include "msdHwAccess.h"
+#include "msdUtils.h"
+
+/*
+ *  typedef: struct FIR_RMU_ATU_DUMP_CTX
+ *
+ *  Description: state shared with the Dump ATU completion callback
+ *
+ *  Fields:
+ *      dev        - device structure
+ *      startAddr  - continuation code returned by the switch
+ *      numOfEntry - number of parsed entries
+ *      atuEntry   - caller storage for the parsed entries
+ *      status     - parse result
+ */
+typedef struct
+{
+	MSD_QD_DEV     *dev;
+	MSD_U32        startAddr;
+	MSD_U32        numOfEntry;
+	MSD_ATU_ENTRY  **atuEntry;
+	MSD_STATUS     status;
+} FIR_RMU_ATU_DUMP_CTX;
+
+static void Fir_rmuAtuDumpDone(MSD_U8 devNum, MSD_STATUS status, MSD_U8 *rspPkt, MSD_U32 rspPktLen, void *arg);
+static MSD_U16 Fir_rmuGetU16(const MSD_U8 *ptr);
+
+/*******************************************************************************
+* Fir_msdRmuAtuDumpIntf
+*
+* DESCRIPTION:
+*       Dump ATU entries from the specified starting address with one RMU
+*       Dump ATU frame.
+*
+* INPUTS:
+*       startAddr - starting address to search the valid entry, 0 for the
+*                   first frame
+*
+* OUTPUTS:
+*       startAddr  - continuation code for the next frame, 0 when the whole
+*                    table has been dumped
+*       numOfEntry - number of returned valid entries, at most MSD_RMU_MAX_ATUS
+*       atuEntry   - returned valid ATU entries
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*       MSD_NOT_SUPPORTED - RMU is not the register access interface
+*
+* COMMENTS:
+*       The request goes through the pipelined RMU engine so a lost frame is
+*       retried. atuRegsSem is held so no SMI ATU operation runs meanwhile.
+*
+*******************************************************************************/
+MSD_STATUS Fir_msdRmuAtuDumpIntf
+(
+    IN MSD_QD_DEV *dev,
+    INOUT MSD_U32 *startAddr,
+    OUT MSD_U32 *numOfEntry,
+    OUT MSD_ATU_ENTRY **atuEntry
+)
+{
+	MSD_STATUS retVal;
+	MSD_Packet ReqPkt;
+	MSD_U8 reqEthPacket[64];
+	MSD_U32 req_pktlen;
+	MSD_U8 delta;
+	FIR_RMU_ATU_DUMP_CTX ctx;
+
+	MSD_DBG_INFO(("Fir_msdRmuAtuDumpIntf Called.\n"));
+
+	if ((startAddr == NULL) || (numOfEntry == NULL) || (atuEntry == NULL))
+	{
+		MSD_DBG_ERROR(("Input param is NULL.\n"));
+		return MSD_BAD_PARAM;
+	}
+
+	if (!IS_RMU_SUPPORTED(dev))
+	{
+		return MSD_NOT_SUPPORTED;
+	}
+
+	if (dev->rmuMode == MSD_RMU_DSA_MODE)
+		delta = 4;
+	else
+		delta = 0;
+
+	retVal = msdRmuReqPktCreate(dev, MSD_DumpATU, &ReqPkt);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+	ReqPkt.reqData._reqData = (MSD_U16)(*startAddr & 0xFFFFU);
+
+	msdMemSet(reqEthPacket, 0, sizeof(reqEthPacket));
+	retVal = msdRmuPackEthReqPkt(&ReqPkt, MSD_DumpATU, reqEthPacket);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+	req_pktlen = MSD_RMU_PACKET_PREFIX_SIZE - delta + 2U;
+
+	ctx.dev = dev;
+	ctx.startAddr = FIR_RMU_ATU_DUMP_DONE;
+	ctx.numOfEntry = 0;
+	ctx.atuEntry = atuEntry;
+	ctx.status = MSD_FAIL;
+
+	msdSemTake(dev->devNum, dev->atuRegsSem, OS_WAIT_FOREVER);
+	retVal = msdRmuPipeBegin(dev->devNum);
+	if (retVal == MSD_OK)
+	{
+		(void)msdRmuPipeSubmit(dev->devNum, reqEthPacket, req_pktlen, Fir_rmuAtuDumpDone, &ctx);
+		retVal = msdRmuPipeEnd(dev->devNum);
+	}
+	msdSemGive(dev->devNum, dev->atuRegsSem);
+
+	if (retVal == MSD_OK)
+	{
+		retVal = ctx.status;
+	}
+	if (retVal != MSD_OK)
+	{
+		MSD_DBG_ERROR(("RMU Dump ATU returned: %s.\n", msdDisplayStatus(retVal)));
+		return retVal;
+	}
+
+	*startAddr = ctx.startAddr;
+	*numOfEntry = ctx.numOfEntry;
+
+	MSD_DBG_INFO(("Fir_msdRmuAtuDumpIntf Exit.\n"));
+	return MSD_OK;
+}
+
+/****************************************************************************/
+/* Internal functions.                                                      */
+/****************************************************************************/
+
+static MSD_U16 Fir_rmuGetU16(const MSD_U8 *ptr)
+{
+	return (MSD_U16)(((MSD_U16)ptr[0] << 8) | (MSD_U16)ptr[1]);
+}
+
+static void Fir_rmuAtuDumpDone(MSD_U8 devNum, MSD_STATUS status, MSD_U8 *rspPkt, MSD_U32 rspPktLen, void *arg)
+{
+	FIR_RMU_ATU_DUMP_CTX *ctx = (FIR_RMU_ATU_DUMP_CTX *)arg;
+	MSD_QD_DEV *dev = ctx->dev;
+	MSD_U32 offset;
+	MSD_U32 i;
+	MSD_U16 data;
+	MSD_U16 opData;
+	MSD_ATU_ENTRY *entry;
+	MSD_U32 portMask = (MSD_U32)((1U << dev->maxPorts) - 1U);
+
+	(void)devNum;
+	if (status != MSD_OK)
+	{
+		ctx->status = status;
+		return;
+	}
+
+	offset = MSD_RMU_PACKET_PREFIX_SIZE - ((dev->rmuMode == MSD_RMU_DSA_MODE) ? 4U : 0U);
+	if (rspPktLen < (offset + 2U))
+	{
+		MSD_DBG_ERROR(("Dump ATU response too short: %d.\n", (int)rspPktLen));
+		ctx->status = MSD_FAIL;
+		return;
+	}
+
+	ctx->startAddr = Fir_rmuGetU16(rspPkt + offset);
+	offset += 2U;
+
+	for (i = 0; (i < MSD_RMU_MAX_ATUS) && ((offset + FIR_RMU_ATU_ENTRY_SIZE) <= rspPktLen); i++)
+	{
+		data = Fir_rmuGetU16(rspPkt + offset);
+		if ((data & 0xFU) == 0U)
+		{
+			break;
+		}
+
+		entry = ctx->atuEntry[ctx->numOfEntry];
+		msdMemSet((void*)entry, 0, sizeof(MSD_ATU_ENTRY));
+		entry->entryState = (MSD_U8)(data & 0xFU);
+		entry->trunkMemberOrLAG = ((data & 0x8000U) != 0U) ? MSD_TRUE : MSD_FALSE;
+		entry->portVec = MSD_PORTVEC_2_LPORTVEC(((MSD_U32)(data & 0x3FF0U) >> 4) & portMask);
+		msdMemCpy(entry->macAddr.arEther, rspPkt + offset + 2U, 6);
+		entry->fid = (MSD_U16)(Fir_rmuGetU16(rspPkt + offset + 8U) & 0xFFFU);
+		opData = Fir_rmuGetU16(rspPkt + offset + 10U);
+		entry->exPrio.macFPri = (MSD_U8)(opData & 0x7U);
+		entry->exPrio.macQPri = (MSD_U8)((opData >> 8) & 0x7U);
+
+		ctx->numOfEntry++;
+		offset += FIR_RMU_ATU_ENTRY_SIZE;
+	}
+
+	ctx->status = MSD_OK;
+}
@@ -1180,7 +1180,7 @@ IN  MSD_QD_DEV    *dev
 )
 {
 	MSD_STATUS       retVal = MSD_OK; /* Functions return value.      */
-	MSD_U16	         data;
+	MSD_U16	         data[32];
 	MSD_U16          i = 0;
 
 	char desc[32][48] = 
@@ -1223,15 +1223,15 @@ IN  MSD_QD_DEV    *dev
 
 	MSG(("\n------------------------------------------------------\n"));
 
+	retVal = msdGetAnyRegBurst(dev->devNum, FIR_GLOBAL1_DEV_ADDR, 0, 32U, data);
+	if (retVal != MSD_OK)
+	{
+		MSD_DBG_ERROR(("msdGetAnyRegBurst returned: %s.\n", msdDisplayStatus(retVal)));
+		return retVal;
+	}
 	for (i = 0; i < 32U; i++)
 	{
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL1_DEV_ADDR, (MSD_U8)i, &data);
-		if (retVal != MSD_OK)
-		{
-			MSD_DBG_ERROR(("msdGetAnyReg returned: %s.\n", msdDisplayStatus(retVal)));
-			break;
-		}
-		MSG(("%-48s%04x\n", desc[i], data));
+		MSG(("%-48s%04x\n", desc[i], data[i]));
 	}
 
 	MSD_DBG_INFO(("Fir_gsysGlobal1RegDump Exit.\n"));
@@ -1264,7 +1264,7 @@ IN  MSD_QD_DEV    *dev
 )
 {
 	MSD_STATUS       retVal = MSD_OK; /* Functions return value.      */
-	MSD_U16	         data;
+	MSD_U16	         data[32];
 	MSD_U16           i = 0;
 
 	char desc[32][48] =
@@ -1306,15 +1306,15 @@ IN  MSD_QD_DEV    *dev
 	MSD_DBG_INFO(("Fir_gsysGlobal2RegDump Called.\n"));
 
 	MSG(("\n------------------------------------------------\n"));
+	retVal = msdGetAnyRegBurst(dev->devNum, FIR_GLOBAL2_DEV_ADDR, 0, 32U, data);
+	if (retVal != MSD_OK)
+	{
+		MSD_DBG_ERROR(("msdGetAnyRegBurst returned: %s.\n", msdDisplayStatus(retVal)));
+		return retVal;
+	}
 	for (i = 0; i < 32U; i++)
 	{
-		retVal = msdGetAnyReg(dev->devNum, FIR_GLOBAL2_DEV_ADDR, (MSD_U8)i, &data);
-		if (retVal != MSD_OK)
-		{
-			MSD_DBG_ERROR(("msdGetAnyReg returned: %s.\n", msdDisplayStatus(retVal)));
-			break;
-		}
-		MSG(("%-42s%04x\n", desc[i], data));
+		MSG(("%-42s%04x\n", desc[i], data[i]));
 	}
 
 	MSD_DBG_INFO(("Fir_gsysGlobal2RegDump Exit.\n"));
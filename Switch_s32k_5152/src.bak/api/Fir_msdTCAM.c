@@ -1720,7 +1720,7 @@ static MSD_STATUS Fir_tcamSetPage0Data(const MSD_QD_DEV *dev, const FIR_MSD_TCAM
 
 	for(i = 2U; i < 0x1cU; i++)
 	{
-		retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->pg0.frame[i - 2U]);
+		retVal = msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->pg0.frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
@@ -1736,7 +1736,7 @@ static MSD_STATUS Fir_tcamSetPage1Data(const MSD_QD_DEV *dev, const FIR_MSD_TCAM
 
 	for(i = 2U; i < 0x1cU; i++)
 	{
-		retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->pg1.frame[i - 2U]);
+		retVal = msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->pg1.frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
@@ -1753,14 +1753,14 @@ static MSD_STATUS Fir_tcamSetPage2Data(const MSD_QD_DEV *dev, const FIR_MSD_TCAM
 
 	for(i=2U; i<14U; i++)
 	{
-		retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->pg2.frame[i - 2U]);
+		retVal = msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->pg2.frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
 		}
 	}
 
-	retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)0x1B, tcamDataPtr->pg2.frame[25]);
+	retVal = msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)0x1B, tcamDataPtr->pg2.frame[25]);
 	if (retVal != MSD_OK)
 	{
 		return retVal;
@@ -1775,7 +1775,7 @@ static MSD_STATUS Fir_tcamSetPage3Data(const MSD_QD_DEV *dev, const FIR_MSD_TCAM
 
 	for(i=2U; i<6U; i++)
 	{
-		retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->frame[i - 2U]);
+		retVal = msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, tcamDataPtr->frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
@@ -1792,7 +1792,7 @@ static MSD_STATUS Fir_tcamGetPage0Data(const MSD_QD_DEV *dev, FIR_MSD_TCAM_DATA_
 
 	for(i=2U; i<0x1cU; i++)
 	{
-		retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->pg0.frame[i - 2U]);
+		retVal = msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->pg0.frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
@@ -1809,7 +1809,7 @@ static MSD_STATUS Fir_tcamGetPage1Data(const MSD_QD_DEV *dev, FIR_MSD_TCAM_DATA_
 
 	for(i=2U; i<0x1cU; i++)
 	{
-		retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->pg1.frame[i - 2U]);
+		retVal = msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->pg1.frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
@@ -1825,14 +1825,14 @@ static MSD_STATUS Fir_tcamGetPage2Data(const MSD_QD_DEV *dev, FIR_MSD_TCAM_DATA_
 
 	for(i=2U; i<14U; i++)
 	{
-		retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->pg2.frame[i - 2U]);
+		retVal = msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->pg2.frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
 		}
 	}
 
-	retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)0x1B, &tcamDataPtr->pg2.frame[25]);
+	retVal = msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)0x1B, &tcamDataPtr->pg2.frame[25]);
 	if (retVal != MSD_OK)
 	{
 		return retVal;
@@ -1847,7 +1847,7 @@ static MSD_STATUS Fir_tcamGetPage3Data(const MSD_QD_DEV *dev, FIR_MSD_TCAM_EGR_D
 
 	for(i=2U; i<6U; i++)
 	{
-		retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->frame[i - 2U]);
+		retVal = msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)i, &tcamDataPtr->frame[i - 2U]);
 		if(retVal != MSD_OK)
 		{
 			return retVal;
@@ -1858,20 +1858,7 @@ static MSD_STATUS Fir_tcamGetPage3Data(const MSD_QD_DEV *dev, FIR_MSD_TCAM_EGR_D
 }
 static MSD_STATUS Fir_waitTcamReady(const MSD_QD_DEV *dev)
 {
-    MSD_STATUS       retVal;    /* Functions return value */
-
-    MSD_U16          data;     /* temporary Data storage */
-
-	data = 1U;
-	while (data == 1U)
-    {
-		retVal = msdGetAnyRegField(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, (MSD_U8)15, (MSD_U8)1, &data);
-        if(retVal != MSD_OK)
-        {
-            return retVal;
-        }
-    }
-    return MSD_OK;
+	return msdRegBatchWaitOnBit(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, (MSD_U8)15, (MSD_U8)0);
 }
 
 /*******************************************************************************
@@ -1892,6 +1879,9 @@ static MSD_STATUS Fir_waitTcamReady(const MSD_QD_DEV *dev)
 *       MSD_FAIL otherwise.
 *
 * COMMENTS:
+*       The register accesses of one operation are queued into a register
+*       batch, the batch helpers latch the first error and msdRegBatchCommit
+*       returns it.
 *
 *******************************************************************************/
 static MSD_STATUS Fir_tcamOperationPerform
@@ -1903,57 +1893,36 @@ static MSD_STATUS Fir_tcamOperationPerform
 {
 	MSD_STATUS       retVal;    /* Functions return value */
 	MSD_U16          data;     /* temporary Data storage */
+	MSD_U16          data1;
 
 	msdSemTake(dev->devNum,  dev->tblRegsSem, OS_WAIT_FOREVER);
 
-	/* Wait until the tcam in ready. */
-	retVal = Fir_waitTcamReady(dev);
+	retVal = msdRegBatchBegin(dev->devNum);
 	if(retVal != MSD_OK)
 	{
 		msdSemGive(dev->devNum,  dev->tblRegsSem);
 		return retVal;
 	}
 
+	/* Wait until the tcam in ready. */
+	(void)Fir_waitTcamReady(dev);
+
 	/* Set the TCAM Operation register */
 	switch (tcamOp)
 	{
 		case Fir_TCAM_FLUSH_ALL:
 		{
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12));
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
 		case Fir_TCAM_FLUSH_ENTRY:
 		{
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
@@ -1961,261 +1930,94 @@ static MSD_STATUS Fir_tcamOperationPerform
 		/*    case Fir_TCAM_PURGE_ENTRY: */
 		{
 			/* load Page 2 */
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
 			/*Access Ingress Actions from TCAM Frame matches */
-			retVal = Fir_setTcamExtensionReg(dev, 0, 0);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = Fir_tcamSetPage2Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
+			(void)Fir_setTcamExtensionReg(dev, 0, 0);
+			(void)Fir_tcamSetPage2Data(dev, &opData->tcamDataP);
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)Fir_TCAM_LOAD_ENTRY << 12) | (MSD_U16)((MSD_U16)2 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-			/* load Page 1 */
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = Fir_tcamSetPage1Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 
+			/* load Page 1 */
+			(void)Fir_waitTcamReady(dev);
+			(void)Fir_tcamSetPage1Data(dev, &opData->tcamDataP);
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)Fir_TCAM_LOAD_ENTRY << 12) | (MSD_U16)((MSD_U16)1 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 
 			/* load Page 0 */
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = Fir_tcamSetPage0Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
+			(void)Fir_waitTcamReady(dev);
+			(void)Fir_tcamSetPage0Data(dev, &opData->tcamDataP);
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)Fir_TCAM_LOAD_ENTRY << 12) | (MSD_U16)((MSD_U16)0 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 
+			/* Wait until the tcam in ready. */
+			(void)Fir_waitTcamReady(dev);
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
 		case Fir_TCAM_GET_NEXT_ENTRY:
 		{
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
+			(void)Fir_waitTcamReady(dev);
+			(void)msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, &data);
+			(void)msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_P0_KEYS_1, &data1);
+			retVal = msdRegBatchCommit(dev->devNum);
 			if(retVal != MSD_OK)
 			{
 				msdSemGive(dev->devNum,  dev->tblRegsSem);
 				return retVal;
 			}
 
-			retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, &data);
-			if(retVal != MSD_OK)
+			if (((data & (MSD_U16)0x1ff) == (MSD_U16)0x1ff) && (data1 == (MSD_U16)0x00ff))
 			{
+				/* No higher valid TCAM entry */
 				msdSemGive(dev->devNum,  dev->tblRegsSem);
-				return retVal;
-			}
-
-			if ((data & (MSD_U16)0x1ff) == (MSD_U16)0x1ff)
-			{
-				MSD_U16 data1;
-				retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_P0_KEYS_1, &data1);
-				if(retVal != MSD_OK)
-				{
-					msdSemGive(dev->devNum,  dev->tblRegsSem);
-					return retVal;
-				}
-				if (data1 == (MSD_U16)0x00ff)
-				{
-					/* No higher valid TCAM entry */
-					msdSemGive(dev->devNum,  dev->tblRegsSem);
-					return MSD_NO_SUCH;
-				}
-				else
-				{
-					/* The highest valid TCAM entry found*/
-				}
+				return MSD_NO_SUCH;
 			}
 
 			/* Get next entry and read the entry */
 			opData->tcamEntry = (MSD_U32)data & (MSD_U32)0x1ff;
 
-		}
-		case Fir_TCAM_READ_ENTRY:
-		{
-			tcamOp = Fir_TCAM_READ_ENTRY;
-
-			retVal = Fir_waitTcamReady(dev);
+			retVal = msdRegBatchBegin(dev->devNum);
 			if(retVal != MSD_OK)
 			{
 				msdSemGive(dev->devNum,  dev->tblRegsSem);
 				return retVal;
 			}
+			(void)Fir_waitTcamReady(dev);
+		}
+		case Fir_TCAM_READ_ENTRY:
+		{
+			tcamOp = Fir_TCAM_READ_ENTRY;
 
 			/* Read page 0 */
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)0 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = Fir_tcamGetPage0Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+			(void)Fir_waitTcamReady(dev);
+			(void)Fir_tcamGetPage0Data(dev, &opData->tcamDataP);
 
 			/* Read page 1 */
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)1 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = Fir_tcamGetPage1Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+			(void)Fir_waitTcamReady(dev);
+			(void)Fir_tcamGetPage1Data(dev, &opData->tcamDataP);
 
 			/*Access Ingress Actions from TCAM Frame matches*/
-			retVal = Fir_setTcamExtensionReg(dev, 0, 0);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)Fir_setTcamExtensionReg(dev, 0, 0);
 
 			/* Read page 2 */
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)2 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+			(void)Fir_waitTcamReady(dev);
+			(void)Fir_tcamGetPage2Data(dev, &opData->tcamDataP);
 
-			retVal = Fir_tcamGetPage2Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
 		default:
+			(void)msdRegBatchCommit(dev->devNum);
 			retVal = MSD_FAIL;
 			break;
 	}
@@ -2234,241 +2036,113 @@ static MSD_STATUS Fir_tcamEgrOperationPerform
 {
 	MSD_STATUS       retVal;    /* Functions return value */
 	MSD_U16          data;     /* temporary Data storage */
+	MSD_U16          data1, data2, data3;
 
 	msdSemTake(dev->devNum,  dev->tblRegsSem, OS_WAIT_FOREVER);
 
-	/* Wait until the tcam in ready. */
-	retVal = Fir_waitTcamReady(dev);
+	retVal = msdRegBatchBegin(dev->devNum);
 	if(retVal != MSD_OK)
 	{
 		msdSemGive(dev->devNum, dev->tblRegsSem);
 		return retVal;
 	}
 
+	/* Wait until the tcam in ready. */
+	(void)Fir_waitTcamReady(dev);
+
 	/* Set the TCAM Operation register */
 	switch (tcamOp)
 	{
 		case Fir_TCAM_FLUSH_ENTRY:
 		{
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
 			/*Access Egress Actions from Egress Action Pointer */
-			retVal = Fir_setTcamExtensionReg(dev, 0, opData->port);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)Fir_setTcamExtensionReg(dev, 0, opData->port);
 
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)3 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_PORT, 0);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_PORT, 0);
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
 		case Fir_TCAM_LOAD_ENTRY:
 		{
-			/* load Page 2 */
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
 			/*Access Egress Actions from Egress Action Pointer */
-			retVal = Fir_setTcamExtensionReg(dev, 0, opData->port);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			retVal = Fir_tcamSetPage3Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)Fir_setTcamExtensionReg(dev, 0, opData->port);
+			(void)Fir_tcamSetPage3Data(dev, &opData->tcamDataP);
 
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)Fir_TCAM_LOAD_ENTRY << 12) | (MSD_U16)((MSD_U16)3 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 
 			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
+			(void)Fir_waitTcamReady(dev);
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
 		case Fir_TCAM_GET_NEXT_ENTRY:
 		{
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
 			/*Access Egress Actions from Egress Action Pointer */
-			retVal = Fir_setTcamExtensionReg(dev, 0, opData->port);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)Fir_setTcamExtensionReg(dev, 0, opData->port);
 
 			data = (MSD_U16)((MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)3 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 
 			data = (MSD_U16)((MSD_U16)((MSD_U16)1 << 15) | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)3 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
+
 			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
+			(void)Fir_waitTcamReady(dev);
+			(void)msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, &data);
+			(void)msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_ACTION_1, &data1);
+			(void)msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_ACTION_2, &data2);
+			(void)msdRegBatchRead(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_ACTION_3, &data3);
+			retVal = msdRegBatchCommit(dev->devNum);
 			if(retVal != MSD_OK)
 			{
 				msdSemGive(dev->devNum, dev->tblRegsSem);
 				return retVal;
 			}
 
-			retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, &data);
-			if(retVal != MSD_OK)
+			if (((data & (MSD_U16)0x3f) == (MSD_U16)0x3f) && (data1 == 0U) && (data2 == 0U) && (data3 == 0U))
 			{
+				/* No higher valid TCAM entry */
 				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			if ((data & (MSD_U16)0x3f) == (MSD_U16)0x3f)
-			{
-				MSD_U16 data1,data2,data3;
-				retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_ACTION_1, &data1);
-				if(retVal != MSD_OK)
-				{
-					msdSemGive(dev->devNum, dev->tblRegsSem);
-					return retVal;
-				}
-
-				retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_ACTION_2, &data2);
-				if(retVal != MSD_OK)
-				{
-					msdSemGive(dev->devNum, dev->tblRegsSem);
-					return retVal;
-				}
-
-				retVal = msdGetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_EGR_ACTION_3, &data3);
-				if(retVal != MSD_OK)
-				{
-					msdSemGive(dev->devNum, dev->tblRegsSem);
-					return retVal;
-				}
-
-				if((data1 == 0U) && (data2 == 0U) && (data3 == 0U))
-				{
-					/* No higher valid TCAM entry */
-					msdSemGive(dev->devNum, dev->tblRegsSem);
-					return MSD_NO_SUCH;
-				}
-				else
-				{
-					/* The highest valid TCAM entry found*/
-				}
+				return MSD_NO_SUCH;
 			}
 
 			/* Get next entry and read the entry */
 			opData->tcamEntry = (MSD_U32)(data & (MSD_U32)0xff);
 
-		}
-
-		case Fir_TCAM_READ_ENTRY:
-		{
-			tcamOp = Fir_TCAM_READ_ENTRY;
-
-			retVal = Fir_waitTcamReady(dev);
+			retVal = msdRegBatchBegin(dev->devNum);
 			if(retVal != MSD_OK)
 			{
 				msdSemGive(dev->devNum, dev->tblRegsSem);
 				return retVal;
 			}
+			(void)Fir_waitTcamReady(dev);
+		}
+
+		case Fir_TCAM_READ_ENTRY:
+		{
+			tcamOp = Fir_TCAM_READ_ENTRY;
 
 			/*Access Egress Actions from Egress Action Pointer */
-			retVal = Fir_setTcamExtensionReg(dev, 0, opData->port);
-			if (retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)Fir_setTcamExtensionReg(dev, 0, opData->port);
 
 			/* Read page 3 */
 			data = (MSD_U16)((MSD_U16)0x8000 | (MSD_U16)((MSD_U16)tcamOp << 12) | (MSD_U16)((MSD_U16)3 << 10) | (MSD_U16)opData->tcamEntry);
-			retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION, data);
 			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			(void)Fir_waitTcamReady(dev);
+			(void)Fir_tcamGetPage3Data(dev, &opData->tcamDataP);
 
-			retVal = Fir_tcamGetPage3Data(dev, &opData->tcamDataP);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
-
-			/* Wait until the tcam in ready. */
-			retVal = Fir_waitTcamReady(dev);
-			if(retVal != MSD_OK)
-			{
-				msdSemGive(dev->devNum, dev->tblRegsSem);
-				return retVal;
-			}
+			retVal = msdRegBatchCommit(dev->devNum);
 		}
 		break;
 
 		default:
+			(void)msdRegBatchCommit(dev->devNum);
 			retVal = MSD_FAIL;
 			break;
 	}
@@ -2831,7 +2505,7 @@ static MSD_STATUS Fir_setTcamExtensionReg(const MSD_QD_DEV *dev, MSD_U8 block, M
 
 	tmpData = (MSD_U16)((MSD_U16)(((MSD_U16)block & (MSD_U16)0xF) << 12) | (port & (MSD_U16)0x1F));
 
-	retVal = msdSetAnyReg(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)1, tmpData);
+	retVal = msdRegBatchWrite(dev->devNum, FIR_TCAM_DEV_ADDR, (MSD_U8)1, tmpData);
 	if (retVal != MSD_OK)
 	{
 		MSD_DBG_ERROR(("Fir_setTcamExtensionReg returned: %s.\n", msdDisplayStatus(retVal)));
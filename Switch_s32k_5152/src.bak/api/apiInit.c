@@ -1,8 +1,22 @@
 #include <apiInit.h>
 #include <deviceInfoModule.h>
+#include <deviceMacModule.h>
+#include <deviceMacTelemetryModule.h>
 #include <string.h>
 #include <signal.h>
 #include "smiasscess.h"
+#include "OsIf.h"
+#ifdef MSD_SIM
+#include <msdSim.h>
+#endif
+#ifdef USE_REG_CACHE
+#include <msdHwAccess.h>
+#include <Fir_msdDrvSwRegs.h>
+#endif
+#ifdef SWITCH_INTN_EIRQ
+#include "IntCtrl_Ip.h"
+#include "Siul2_Dio_Ip.h"
+#endif
 
 DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
 
@@ -14,6 +28,7 @@ extern MSD_STATUS deviceVlanModuleInitial(void);
 extern MSD_STATUS deviceFilterModuleInitial(void);
 
 extern MSD_STATUS deviceMacModuleInitialMacInfo(IN MSD_U8 devNum);
+extern MSD_STATUS deviceTcamModuleInitialTcamInfo(IN MSD_U8 devNum);
 extern MSD_STATUS deviceVlanModuleInitialVlanInfo(IN MSD_U8 devNum);
 extern MSD_STATUS devicePortSegmentationModuleInitialSegmentationInfo(IN MSD_U8 devNum);
 extern MSD_STATUS deviceFilterModuleInitialFilterInfo(IN MSD_U8 devNum);
@@ -76,6 +91,27 @@ static MSD_STATUS osSemSignal(MSD_SEM smid)
 
 #endif
 
+/**
+ * @brief msdDelay MSD驱动要求用户提供的延时函数，delayTime单位us，按tick向上取整
+ */
+void msdDelay(IN const unsigned int delayTime)
+{
+	vTaskDelay(pdMS_TO_TICKS((delayTime + 999U) / 1000U));
+}
+
+/**
+ * @brief msdTimeStamp MSD驱动要求用户提供的时间戳函数
+ * 开启OsIf系统定时器时为定时器计数值(可用于寄存器访问延时统计)，否则为FreeRTOS tick
+ */
+MSD_U32 msdTimeStamp(void)
+{
+#if (OSIF_USE_SYSTEM_TIMER == STD_ON)
+	return (MSD_U32)OsIf_GetCounter(OSIF_COUNTER_SYSTEM);
+#else
+	return (MSD_U32)xTaskGetTickCount();
+#endif
+}
+
 /*******************************************************************************************
  * @brief init_all_device_config
  * 初始化设备配置对象，在调用任何API接口之前，应该先调用该接口初始化所有设备的配置对象
@@ -137,6 +173,59 @@ static MSD_STATUS smiWrite(MSD_U8 devNum, MSD_U8 phyAddr,
 }
 
 
+/**
+ * SMI协议连续读取多个寄存器，使用Clause 45 Post Read Increment只发送一次地址.
+ *
+ * \param devNum[in]:设备num，暂未使用
+ * \param phyAddr[in]:读取的物理地址0~31
+ * \param miiReg[in]：第一个SMI寄存器地址
+ * \param count[in]：寄存器个数
+ * \param values[out]:存放寄存器的读取结果
+ * \return 成功返回MSD_OK,否则返回MSD_FAIL.
+ */
+static MSD_STATUS smiReadBurst(MSD_U8 devNum, MSD_U8 phyAddr,
+		MSD_U8 miiReg, MSD_U8 count, MSD_U16* values)
+{
+	int ret = readC45RegisterBurst(phyAddr, 3, miiReg | 0x8000, count, values);
+	return ret < 0 ? MSD_FAIL : MSD_OK;
+}
+
+#ifdef USE_REG_CACHE
+/* 只缓存静态配置寄存器，状态、计数器、忙位和操作寄存器始终访问硬件 */
+static const MSD_U8 s_cachedPortRegs[] = {
+	FIR_PORT_CONTROL, FIR_PORT_CONTROL1, FIR_PORT_VLAN_MAP, FIR_PVID, FIR_PORT_CONTROL2,
+	FIR_PAV, FIR_PRI_OVERRIDE, FIR_POLICY_CONTROL, FIR_PORT_CONTROL3
+};
+static const MSD_U8 s_cachedGlobal1Regs[] = {
+	FIR_GLOBAL_CONTROL, FIR_GLOBAL_CONTROL2
+};
+
+/**
+ * 开启寄存器影子缓存，VLAN/端口隔离等配置流程中的读-改-写操作将直接从RAM读取.
+ *
+ * \param devNum[in]:设备编号
+ * \return 成功返回MSD_OK,否则返回错误码.
+ */
+static MSD_STATUS initRegCache(MSD_U8 devNum)
+{
+	MSD_STATUS status = MSD_OK;
+	MSD_QD_DEV *dev = sohoDevGet(devNum);
+	if (dev == NULL)
+		return MSD_FAIL;
+	for (MSD_U8 port = 0; port < dev->numOfPorts && status == MSD_OK; ++port) {
+		for (MSD_U32 i = 0; i < sizeof(s_cachedPortRegs) && status == MSD_OK; ++i) {
+			status = msdRegCacheSetCacheable(devNum, (MSD_U8)(FIR_PORT_START_ADDR + port), s_cachedPortRegs[i], MSD_TRUE);
+		}
+	}
+	for (MSD_U32 i = 0; i < sizeof(s_cachedGlobal1Regs) && status == MSD_OK; ++i) {
+		status = msdRegCacheSetCacheable(devNum, FIR_GLOBAL1_DEV_ADDR, s_cachedGlobal1Regs[i], MSD_TRUE);
+	}
+	if (status != MSD_OK)
+		return status;
+	return msdRegCacheEnable(devNum, MSD_TRUE);
+}
+#endif
+
 /**
  * Register function to BSP.
  *
@@ -152,11 +241,19 @@ static MSD_STATUS startDevice(MSD_U8 devNum, MSD_U8 baseAddr, MSD_INTERFACE busI
 	MSD_SYS_CONFIG   cfg;
 
 	memset((char*)&cfg, 0, sizeof(MSD_SYS_CONFIG));
-
+#ifdef MSD_SIM
+	//交换机模拟器，用于无板卡时的功能和性能测试：MDIO帧由模拟器应答，RMU帧和信号量也由模拟器提供
+	if (msdSimInit(NULL) != MSD_OK || msdSimBspGet(&cfg.BSPFunctions) != MSD_OK)
+		return MSD_FAIL;
+#else
 	//cfg.BSPFunctions.rmu_tx_rx = rmuSendAndReceivePacket; //
 	cfg.BSPFunctions.rmu_tx_rx = NULL;
+#endif
+	if (mdioInit(NULL) != 0)//使用默认MDIO后端
+		return MSD_FAIL;
 	cfg.BSPFunctions.readMii = smiRead;
 	cfg.BSPFunctions.writeMii = smiWrite;
+	cfg.BSPFunctions.readMiiBurst = smiReadBurst;
 	cfg.InterfaceChannel = busInterface;
 #ifdef USE_SEMAPHORE
 	cfg.BSPFunctions.semCreate = osSemCreate; //创建信号量
@@ -176,36 +273,210 @@ static MSD_STATUS startDevice(MSD_U8 devNum, MSD_U8 baseAddr, MSD_INTERFACE busI
 	cfg.eTypeValue = DEFAULT_ETHERTYPE_VALUE;
 	cfg.tempDeviceId = tempDeviceId;
 	status = msdLoadDriver(&cfg);
+#ifdef USE_REG_CACHE
+	if (status == MSD_OK)
+		status = initRegCache(devNum);
+#endif
 	return status;
 }
 
 
+#ifndef EVENT_POLL_FALLBACK_MS
+#define EVENT_POLL_FALLBACK_MS	1000	//未收到INTn中断通知时的兜底轮询周期(ms)
+#endif
+#define EVENT_MAX_DRAIN_COUNT	8		//一次唤醒最多处理的中断轮数，防止中断一直有效时任务无法让出
+#define EVENT_MAX_SELF_NOTIFY	4		//连续给自己补通知的最大次数，中断源无法清除时退回到兜底轮询
+
+//VTU Miss：仅仅在启用了802.1Q的端口，才会发生VTU Miss，这时候创建一个FID和帧的VID相同的VTU项，交换机就会自动创建FID = VID的动态数据库条目。
+static MSD_STATUS vtuProbHandler(MSD_U8 devNum)
+{
+	MSD_VTU_INT_STATUS vlanInt;
+	MSD_BOOL isAddAtu;
+	msdMemSet(&vlanInt, 0, sizeof(MSD_VTU_INT_STATUS));
+	MSD_STATUS ret = msdVlanViolationGet(devNum, &vlanInt);
+	if (ret != MSD_OK || !vlanInt.vtuIntCause.missVio)
+		return ret;
+	ret = checkVlanEntry(devNum, vlanInt.vid, &isAddAtu);
+	if (ret != MSD_OK)
+		return ret;
+	return setFidValue(devNum, vlanInt.vid);
+}
+
+//ATU违例：读取违例数据以清除中断源，交给MAC学习统计检测MAC漂移，ATU满时由端口学习策略处理
+static MSD_STATUS atuProbHandler(MSD_U8 devNum)
+{
+	MSD_ATU_INT_STATUS atuInt;
+	msdMemSet(&atuInt, 0, sizeof(MSD_ATU_INT_STATUS));
+	MSD_STATUS ret = msdFdbViolationGet(devNum, &atuInt);
+	if (ret == MSD_OK) {
+		MSD_DBG(("ATU violation: fid %d, spid %d, member %d, miss %d, full %d\n", atuInt.fid, atuInt.spid,
+				atuInt.atuIntCause.memberVio, atuInt.atuIntCause.missVio, atuInt.atuIntCause.fullVio));
+		(void)deviceMacTelemetryModuleRecordViolation(devNum, &atuInt);
+		ret = deviceAtuModuleLearnPolicyHandleViolation(devNum, &atuInt);
+	}
+	return ret;
+}
+
+typedef struct {
+	MSD_U16 cause;//Global Status寄存器中的中断位，参考MSD_VTU_PROB等
+	EventHandler handler;
+}EventHandlerEntry;
+
+//按中断位分发的默认处理函数表，handler为NULL的中断不使能
+static const EventHandlerEntry s_defaultEventHandlers[] = {
+	{ MSD_VTU_PROB, vtuProbHandler },
+	{ MSD_ATU_PROB, atuProbHandler },
+	{ MSD_TCAM_INT, NULL },
+	{ MSD_STATS_DONE, NULL },
+	{ MSD_DEVICE_INT, NULL },
+	{ MSD_DEVICE2_INT, NULL },
+	{ MSD_AVB_INT, NULL },
+};
+#define EVENT_HANDLER_NUM	(sizeof(s_defaultEventHandlers) / sizeof(s_defaultEventHandlers[0]))
+
+//每台设备一份处理函数表，第一次使用时从默认表复制
+static EventHandlerEntry s_eventHandlers[MAX_SOHO_DEVICES][EVENT_HANDLER_NUM];
+static MSD_BOOL s_eventHandlersLoaded[MAX_SOHO_DEVICES];
+
+static EventHandlerEntry* eventHandlerTable(MSD_U8 devNum)
+{
+	if (!s_eventHandlersLoaded[devNum]) {
+		msdMemCpy(s_eventHandlers[devNum], s_defaultEventHandlers, sizeof(s_defaultEventHandlers));
+		s_eventHandlersLoaded[devNum] = MSD_TRUE;
+	}
+	return s_eventHandlers[devNum];
+}
+
+static MSD_U16 eventHandlerMask(MSD_U8 devNum)
+{
+	const EventHandlerEntry* handlers = eventHandlerTable(devNum);
+	MSD_U16 mask = 0;
+	for (MSD_U32 i = 0; i < EVENT_HANDLER_NUM; ++i) {
+		if (handlers[i].handler != NULL)
+			mask |= handlers[i].cause;
+	}
+	return mask;
+}
+
 static void eventThreadProc(void* param)
 {
 	DeviceConfig *deviceConfig = (DeviceConfig*)param;
+	const EventHandlerEntry* handlers = eventHandlerTable(deviceConfig->devNum);
+	MSD_U32 selfNotify = 0;//连续补通知的次数
 	for(;;){
-		//使用pdMS_TO_TICKS（）以毫秒为单位指定时间，而不是直接以tick为单位指定时间，可以确保在tick频率改变时应用程序中指定的时间不会改变。
-		vTaskDelay(pdMS_TO_TICKS(1000));
+		//等待INTn的EIRQ中断通知(intnIrqHandler)，超时则退化为轮询，只读一次Global Status寄存器
+		(void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(EVENT_POLL_FALLBACK_MS));
 		if (xSemaphoreTake(deviceConfig->xMutex, portMAX_DELAY) == pdTRUE) {
-			MSD_VTU_INT_STATUS vlanInt;
-			msdMemSet(&vlanInt, 0, sizeof(MSD_VTU_INT_STATUS));
-			MSD_STATUS ret = msdVlanViolationGet(deviceConfig->devNum, &vlanInt);
-			if (ret == MSD_OK && vlanInt.vtuIntCause.missVio) { //仅仅在启用了802.1Q的端口，才会发生VTU Miss，这时候创建一个FID和帧的VID相同的VTU项，交换机就会自动创建FID = VID的动态数据库条目。
-				MSD_BOOL isAddAtu;
-				ret = checkVlanEntry(deviceConfig->devNum, vlanInt.vid, &isAddAtu);
-				if (ret != MSD_OK){
-					xSemaphoreGive(deviceConfig->xMutex);
-					continue;
+			MSD_U16 mask = eventHandlerMask(deviceConfig->devNum);
+			MSD_BOOL pending = MSD_FALSE;
+			for (MSD_U32 n = 0; n < EVENT_MAX_DRAIN_COUNT; ++n) {
+				MSD_U16 status = 0;
+				if (msdSysActiveIntStatusGet(deviceConfig->devNum, &status) != MSD_OK)
+					break;
+				status &= mask;
+				pending = (status != 0) ? MSD_TRUE : MSD_FALSE;
+				if (!pending)
+					break;
+				for (MSD_U32 i = 0; i < EVENT_HANDLER_NUM; ++i) {
+					if ((status & handlers[i].cause) != 0 && handlers[i].handler != NULL)
+						(void)handlers[i].handler(deviceConfig->devNum);
 				}
-				setFidValue(deviceConfig->devNum, vlanInt.vid);
 			}
+			(void)deviceAtuModuleLearnPolicyPoll(deviceConfig->devNum);//端口学习策略的周期再平衡
 			xSemaphoreGive(deviceConfig->xMutex);
+			//INTn在中断源清除前一直保持低电平，不会再产生下降沿，达到处理轮数上限时给自己补一次通知
+			//处理函数清除不了中断源时连续补通知会一直占用CPU，超过EVENT_MAX_SELF_NOTIFY次后等待下一次中断或兜底轮询
+			if (!pending) {
+				selfNotify = 0;
+			}
+			else if (selfNotify < EVENT_MAX_SELF_NOTIFY) {
+				selfNotify++;
+				xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+			}
+			else {
+				MSD_DBG_ERROR(("device %d interrupt still active after %d rounds\n", deviceConfig->devNum,
+						(EVENT_MAX_SELF_NOTIFY + 1) * EVENT_MAX_DRAIN_COUNT));
+				selfNotify = 0;
+			}
 		}
 
 	}
 	vTaskDelete(NULL);//删除自身
 }
 
+MSD_STATUS initSetEventHandler(MSD_U8 devNum, MSD_U16 cause, EventHandler handler)
+{
+	CHECK_DEV_NUM_IS_CORRECT;
+	MSD_STATUS status = MSD_BAD_PARAM;
+	EventHandlerEntry* handlers = eventHandlerTable(devNum);
+	for (MSD_U32 i = 0; i < EVENT_HANDLER_NUM; ++i) {
+		if (handlers[i].cause == cause) {
+			handlers[i].handler = handler;
+			status = MSD_OK;
+			break;
+		}
+	}
+	if (status == MSD_OK && g_allDevicesConfig[devNum].isOpen)
+		status = msdSysActiveIntEnableSet(devNum, eventHandlerMask(devNum));
+	return status;
+}
+
+void initNotifyEventFromISR(MSD_U8 devNum, BaseType_t *higherPriorityTaskWoken)
+{
+	if (devNum > (MSD_U8)(MAX_SOHO_DEVICES - 1) || g_allDevicesConfig[devNum].eventLoopHandle == NULL)
+		return;
+	vTaskNotifyGiveFromISR(g_allDevicesConfig[devNum].eventLoopHandle, higherPriorityTaskWoken);
+}
+
+#ifdef SWITCH_INTN_EIRQ
+/*
+ * 交换机INTn(低电平有效、开漏)接到SIUL2的外部中断通道SWITCH_INTN_EIRQ(0~31)，
+ * 引脚的IMCR需要在Pins工具中选择该EIRQ输入。EIRQ0~7、8~15、16~23、24~31分别共用SIUL_0~3_IRQn。
+ * SWITCH_INTN_DEV_NUM为INTn所属交换机的设备编号，其他设备按EVENT_POLL_FALLBACK_MS轮询。
+ */
+#define SWITCH_INTN_EIRQ_MASK	(1UL << (SWITCH_INTN_EIRQ))
+#ifndef SWITCH_INTN_DEV_NUM
+#define SWITCH_INTN_DEV_NUM		0U
+#endif
+#ifndef SWITCH_INTN_IRQN
+#define SWITCH_INTN_IRQN		((IRQn_Type)((MSD_U32)SIUL_0_IRQn + ((SWITCH_INTN_EIRQ) / 8U)))
+#endif
+#ifndef SWITCH_INTN_IRQ_PRIORITY
+#define SWITCH_INTN_IRQ_PRIORITY	(configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1)//需要低于(数值大于)FreeRTOS可调用API的最高优先级
+#endif
+
+//INTn下降沿中断：清除EIRQ标志后通知事件任务，中断源由事件任务读取状态清除
+static void intnIrqHandler(void)
+{
+	BaseType_t higherPriorityTaskWoken = pdFALSE;
+	if ((IP_SIUL2->DISR0 & SWITCH_INTN_EIRQ_MASK) == 0)
+		return;//同一个IRQ上的其他EIRQ通道
+	IP_SIUL2->DISR0 = SWITCH_INTN_EIRQ_MASK;//写1清除
+	initNotifyEventFromISR(SWITCH_INTN_DEV_NUM, &higherPriorityTaskWoken);
+	portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+static void intnIrqEnable(void)
+{
+	IP_SIUL2->DIRER0 &= ~SWITCH_INTN_EIRQ_MASK;
+	IP_SIUL2->DIRSR0 &= ~SWITCH_INTN_EIRQ_MASK;//中断而不是DMA请求
+	IP_SIUL2->IREER0 &= ~SWITCH_INTN_EIRQ_MASK;
+	IP_SIUL2->IFEER0 |= SWITCH_INTN_EIRQ_MASK;//下降沿触发
+	IP_SIUL2->DISR0 = SWITCH_INTN_EIRQ_MASK;//清除使能前残留的标志
+	IntCtrl_Ip_InstallHandler(SWITCH_INTN_IRQN, intnIrqHandler, NULL_PTR);
+	IntCtrl_Ip_SetPriority(SWITCH_INTN_IRQN, SWITCH_INTN_IRQ_PRIORITY);
+	IntCtrl_Ip_ClearPending(SWITCH_INTN_IRQN);
+	IntCtrl_Ip_EnableIrq(SWITCH_INTN_IRQN);
+	IP_SIUL2->DIRER0 |= SWITCH_INTN_EIRQ_MASK;
+}
+
+static void intnIrqDisable(void)
+{
+	IP_SIUL2->DIRER0 &= ~SWITCH_INTN_EIRQ_MASK;//只关闭本通道，共用的IRQ保持使能
+	IP_SIUL2->DISR0 = SWITCH_INTN_EIRQ_MASK;
+}
+#endif
+
 MSD_STATUS initOpenDevice(MSD_U8 devNum)
 {
 	if (devNum > (MSD_U8)(MAX_SOHO_DEVICES - 1)){
@@ -237,6 +508,12 @@ MSD_STATUS initOpenDevice(MSD_U8 devNum)
 			MSD_DBG_ERROR(("device_mac_module_initial_mac_info failed,the status is %d\n",status));
 			break;
 		}
+		//TCAM分配表，VLAN和filter module使用
+		status = deviceTcamModuleInitialTcamInfo(devNum);
+		if (status != MSD_OK) {
+			MSD_DBG_ERROR(("device_tcam_module_initial_tcam_info failed,the status is %d\n",status));
+			break;
+		}
 		//VLAN Module
 		status = deviceVlanModuleInitialVlanInfo(devNum);
 		if (status != MSD_OK) {
@@ -255,6 +532,12 @@ MSD_STATUS initOpenDevice(MSD_U8 devNum)
 			MSD_DBG_ERROR(("device_filter_module_initial_segmentation_info failed,the status is %d\n",status));
 			break;
 		}
+		//使能有处理函数的中断，使其驱动INTn引脚
+		status = msdSysActiveIntEnableSet(devNum, eventHandlerMask(devNum));
+		if (status != MSD_OK) {
+			MSD_DBG_ERROR(("msdSysActiveIntEnableSet failed,the status is %d\n",status));
+			break;
+		}
 	} while (0);
 	if(status != MSD_OK)//相关模块的初始化出现错误
 		status = msdUnLoadDriver(devNum);
@@ -262,6 +545,10 @@ MSD_STATUS initOpenDevice(MSD_U8 devNum)
 		g_allDevicesConfig[devNum].isOpen = MSD_TRUE;
 		BaseType_t ret = xTaskCreate(eventThreadProc, "pollTask",configMINIMAL_STACK_SIZE, &g_allDevicesConfig[devNum],1,&g_allDevicesConfig[devNum].eventLoopHandle);
 		if(ret  == pdPASS){
+#ifdef SWITCH_INTN_EIRQ
+			if (devNum == SWITCH_INTN_DEV_NUM)
+				intnIrqEnable();//任务句柄有效后再打开INTn中断
+#endif
 			vTaskStartScheduler();//启动调度器去执行任务
 		}
 	}
@@ -302,6 +589,19 @@ void initCloseDevice(MSD_U8 devNum)
 {
 	if (!g_allDevicesConfig[devNum].isOpen) return;
 	releaseAllFidValues(devNum);
+#ifdef SWITCH_INTN_EIRQ
+	if (devNum == SWITCH_INTN_DEV_NUM)
+		intnIrqDisable();
+#endif
+	deviceMacTelemetryModuleStop(devNum);
+	//在设备锁内删除事件任务，保证任务不在处理中断的过程中被删除
+	if (g_allDevicesConfig[devNum].eventLoopHandle != NULL) {
+		BaseType_t locked = xSemaphoreTake(g_allDevicesConfig[devNum].xMutex, portMAX_DELAY);
+		vTaskDelete(g_allDevicesConfig[devNum].eventLoopHandle);
+		g_allDevicesConfig[devNum].eventLoopHandle = NULL;
+		if (locked == pdTRUE)
+			xSemaphoreGive(g_allDevicesConfig[devNum].xMutex);
+	}
 	vSemaphoreDelete(g_allDevicesConfig[devNum].xMutex);
 	g_allDevicesConfig[devNum].isOpen = MSD_FALSE;
 	msdUnLoadDriver(devNum);
@@ -1,6 +1,7 @@
 #include <apiInit.h>
 #include <deviceFilterModule.h>
 #include <deviceVlanModule.h>
+#include <deviceTcamModule.h>
 #include <string.h>
 #include <stdlib.h>
 #include "adlist.h"
@@ -17,6 +18,7 @@ static FilterModuleInitType s_filterModuleInit[MAX_SOHO_DEVICES];
 
 // 每个过滤器需要最多的tcam entry 条目，功能说明书说支持144 byte的tcam entry，但是api中好像仅支持96个 byte的tcam entry（但是开启qinq情况，需要双倍的tcam entry，即4个）
 #define  MAX_FILTER_ENTRY_SIZE  4  //
+#define  FILTER_TCAM_POINTER_END  (FILTER_MAX_NUM * MAX_FILTER_ENTRY_SIZE) //过滤器使用的TCAM Entry范围为[0, FILTER_TCAM_POINTER_END)，在QinQ VLAN的条目之前匹配
 /**
  * @brief 用以记录过滤器对象和tcam entry的对应关系的对象
  */
@@ -51,6 +53,8 @@ MSD_STATUS deviceFilterModuleInitialFilterInfo(MSD_U8 devNum)
     ret = deviceFilterModuleSetIsEnableFilter(devNum, MSD_TRUE);//
     if (ret != MSD_OK) return ret;
     ret = msdTcamAllDelete(devNum);
+    if (ret != MSD_OK) return ret;
+    ret = deviceTcamModuleReset(devNum);
     return ret;
 }
 
@@ -118,33 +122,538 @@ MSD_STATUS deviceFilterModuleGetIsEnableFilter(MSD_U8 devNum, MSD_BOOL* isEnable
     return ret;
 }
 
+/*
+ * TCAM从下标号小的条目开始匹配，过滤器编号越小优先级越高(新添加的过滤器编号最大)。
+ * 过滤器的条目总是放在编号比它小的过滤器的条目之后、编号比它大的过滤器的条目之前，没有足够的位置时先整理过滤器的条目。
+ * 整理时先写入新的条目再删除原来的条目(make-before-break)，移动过程中过滤器的规则一直有效。
+ */
+#define  FILTER_TCAM_SCRATCH_END  TCAM_MODULE_QINQ_START //整理时过滤器可以临时使用[0, FILTER_TCAM_SCRATCH_END)中的条目
+#define  FILTER_TCAM_SLOT_FREE  (-1) //规划中没有使用的条目
+#define  FILTER_TCAM_SLOT_OTHER  (-2) //规划中被非过滤器使用的条目
+#define  FILTER_TCAM_MOVE_MAX  (3 * (FILTER_MAX_NUM + 1)) //整理时一个过滤器最多移动3次(向后移动、临时位置、目标位置)
+
+/**
+ * @brief 规划中的一个过滤器，pointers为规划过程中的当前位置
+ */
+typedef struct {
+    FilterEntry *filterEntry;//为NULL时为需要预留位置的过滤器
+    MSD_U8 filterId;
+    MSD_U8 size;
+    MSD_BOOL isPlaced;//是否已经有条目
+    MSD_U32 pointers[MAX_FILTER_ENTRY_SIZE];
+}FilterTcamItem;
+
+/**
+ * @brief 一次过滤器的移动
+ */
+typedef struct {
+    MSD_U8 itemIndex;
+    MSD_U32 pointers[MAX_FILTER_ENTRY_SIZE];
+}FilterTcamMove;
+
+typedef struct {
+    FilterTcamItem items[FILTER_MAX_NUM + 1];//按过滤器编号排序
+    int itemCount;
+    MSD_16 slotOwner[FILTER_TCAM_SCRATCH_END];//条目的所有者(items的下标)，或者FILTER_TCAM_SLOT_FREE/FILTER_TCAM_SLOT_OTHER
+    FilterTcamMove moves[FILTER_TCAM_MOVE_MAX];
+    int moveCount;
+}FilterTcamPlan;
+
+/**
+ * @brief deviceFilterTcamPlanInit 根据过滤器列表和TCAM分配表初始化规划
+ * @param devNum
+ * @param plan
+ * @param reserveFilterId 需要预留位置的过滤器编号，-1为不需要预留
+ * @param reserveSize 需要预留的条目个数
+ * @return
+ */
+static MSD_STATUS deviceFilterTcamPlanInit(MSD_U8 devNum, FilterTcamPlan *plan, int reserveFilterId, int reserveSize)
+{
+    msdMemSet(plan, 0, sizeof(FilterTcamPlan));
+    listIter iter;
+    listRewind(s_filters[devNum], &iter);
+    listNode *node;
+    while((node = listNext(&iter)) != NULL && plan->itemCount < FILTER_MAX_NUM){
+        FilterEntry *filterEntry = (FilterEntry *)node->value;
+        FilterTcamItem *item = &plan->items[plan->itemCount++];
+        item->filterEntry = filterEntry;
+        item->filterId = filterEntry->filter.filterId;
+        item->size = filterEntry->tcamPointerSize;
+        item->isPlaced = MSD_TRUE;
+        msdMemCpy(item->pointers, filterEntry->tcamPointer, sizeof(item->pointers));
+    }
+    if(reserveFilterId >= 0){
+        FilterTcamItem *item = &plan->items[plan->itemCount++];
+        item->filterId = (MSD_U8)reserveFilterId;
+        item->size = (MSD_U8)reserveSize;
+    }
+    //按过滤器编号排序，相同编号时预留位置的过滤器在后
+    for(int i = 1; i < plan->itemCount; ++i){
+        FilterTcamItem temp = plan->items[i];
+        int j = i - 1;
+        while(j >= 0 && (plan->items[j].filterId > temp.filterId
+                         || (plan->items[j].filterId == temp.filterId && plan->items[j].filterEntry == NULL))){
+            plan->items[j + 1] = plan->items[j];
+            --j;
+        }
+        plan->items[j + 1] = temp;
+    }
+    for(int i = 0; i < FILTER_TCAM_SCRATCH_END; ++i){
+        TcamOwnerType ownerType;
+        MSD_U16 ownerId;
+        MSD_STATUS ret = deviceTcamModuleGetOwner(devNum, (MSD_U32)i, &ownerType, &ownerId);
+        if(ret != MSD_OK) return ret;
+        plan->slotOwner[i] = ownerType == TCAM_OWNER_FREE ? FILTER_TCAM_SLOT_FREE : FILTER_TCAM_SLOT_OTHER;
+    }
+    for(int i = 0; i < plan->itemCount; ++i){
+        FilterTcamItem *item = &plan->items[i];
+        for(int j = 0; item->isPlaced && j < item->size; ++j){
+            if(item->pointers[j] < FILTER_TCAM_SCRATCH_END)
+                plan->slotOwner[item->pointers[j]] = (MSD_16)i;
+        }
+    }
+    return MSD_OK;
+}
+
+/**
+ * @brief deviceFilterTcamPlanFindFree 在[start, end)中找到count个规划中未使用的条目，优先使用连续的条目
+ * @return 是否找到
+ */
+static MSD_BOOL deviceFilterTcamPlanFindFree(const FilterTcamPlan *plan, int start, int end, int count, MSD_U32 *pointers)
+{
+    if(end > FILTER_TCAM_SCRATCH_END) end = FILTER_TCAM_SCRATCH_END;
+    int run = 0;
+    for(int i = start; i < end; ++i){
+        run = plan->slotOwner[i] == FILTER_TCAM_SLOT_FREE ? run + 1 : 0;
+        if(run == count){
+            for(int j = 0; j < count; ++j){
+                pointers[j] = (MSD_U32)(i + 1 - count + j);
+            }
+            return MSD_TRUE;
+        }
+    }
+    int found = 0;
+    for(int i = start; i < end && found < count; ++i){
+        if(plan->slotOwner[i] == FILTER_TCAM_SLOT_FREE){
+            pointers[found++] = (MSD_U32)i;
+        }
+    }
+    return found == count ? MSD_TRUE : MSD_FALSE;
+}
+
+/**
+ * @brief deviceFilterTcamPlanMove 规划中将过滤器移动到pointers，新的条目写入之后原来的条目才释放。预留位置的过滤器只占用条目，不记录移动
+ * @return 移动的记录已满时返回MSD_FALSE
+ */
+static MSD_BOOL deviceFilterTcamPlanMove(FilterTcamPlan *plan, int itemIndex, const MSD_U32 *pointers)
+{
+    FilterTcamItem *item = &plan->items[itemIndex];
+    if(item->filterEntry != NULL && plan->moveCount >= FILTER_TCAM_MOVE_MAX)
+        return MSD_FALSE;
+    for(int i = 0; i < item->size; ++i){
+        plan->slotOwner[pointers[i]] = (MSD_16)itemIndex;
+    }
+    if(item->filterEntry != NULL){
+        FilterTcamMove *move = &plan->moves[plan->moveCount++];
+        move->itemIndex = (MSD_U8)itemIndex;
+        msdMemCpy(move->pointers, pointers, sizeof(MSD_U32) * item->size);
+        for(int i = 0; item->isPlaced && i < item->size; ++i){
+            if(item->pointers[i] < FILTER_TCAM_SCRATCH_END)
+                plan->slotOwner[item->pointers[i]] = FILTER_TCAM_SLOT_FREE;
+        }
+    }
+    msdMemCpy(item->pointers, pointers, sizeof(MSD_U32) * item->size);
+    item->isPlaced = MSD_TRUE;
+    return MSD_TRUE;
+}
+
+static void deviceFilterTcamItemRange(const FilterTcamItem *item, int *minPointer, int *maxPointer)
+{
+    *minPointer = FILTER_TCAM_SCRATCH_END;
+    *maxPointer = -1;
+    for(int i = 0; i < item->size; ++i){
+        if((int)item->pointers[i] < *minPointer) *minPointer = (int)item->pointers[i];
+        if((int)item->pointers[i] > *maxPointer) *maxPointer = (int)item->pointers[i];
+    }
+}
+
+/**
+ * @brief deviceFilterTcamPlanKeepOrdered
+ * 移动最少的条目：保留已经按编号排好顺序的过滤器(条目总数最多的一组)，其余的过滤器移动到前后保留的过滤器之间的空闲条目中
+ * @return 其余的过滤器是否都可以放下
+ */
+static MSD_BOOL deviceFilterTcamPlanKeepOrdered(FilterTcamPlan *plan)
+{
+    int keepSize[FILTER_MAX_NUM + 1];//以该过滤器结束时保留的条目总数
+    int prev[FILTER_MAX_NUM + 1];
+    MSD_BOOL isKeep[FILTER_MAX_NUM + 1] = {MSD_FALSE};
+    int minPointer[FILTER_MAX_NUM + 1], maxPointer[FILTER_MAX_NUM + 1];
+    int best = -1;
+    for(int i = 0; i < plan->itemCount; ++i){
+        keepSize[i] = 0;
+        prev[i] = -1;
+        deviceFilterTcamItemRange(&plan->items[i], &minPointer[i], &maxPointer[i]);
+        if(!plan->items[i].isPlaced || maxPointer[i] >= FILTER_TCAM_POINTER_END) continue;
+        keepSize[i] = plan->items[i].size;
+        for(int j = 0; j < i; ++j){
+            if(keepSize[j] > 0 && maxPointer[j] < minPointer[i] && keepSize[j] + plan->items[i].size > keepSize[i]){
+                keepSize[i] = keepSize[j] + plan->items[i].size;
+                prev[i] = j;
+            }
+        }
+        if(best < 0 || keepSize[i] > keepSize[best]) best = i;
+    }
+    for(int i = best; i >= 0; i = prev[i]){
+        isKeep[i] = MSD_TRUE;
+    }
+    int start = 0;
+    for(int i = 0; i < plan->itemCount; ++i){
+        if(isKeep[i]){
+            start = maxPointer[i] + 1;
+            continue;
+        }
+        int end = FILTER_TCAM_POINTER_END;
+        for(int j = i + 1; j < plan->itemCount; ++j){
+            if(isKeep[j]){
+                end = minPointer[j];
+                break;
+            }
+        }
+        MSD_U32 pointers[MAX_FILTER_ENTRY_SIZE];
+        if(!deviceFilterTcamPlanFindFree(plan, start, end, plan->items[i].size, pointers)
+           || !deviceFilterTcamPlanMove(plan, i, pointers))
+            return MSD_FALSE;
+        int newMin, newMax;
+        deviceFilterTcamItemRange(&plan->items[i], &newMin, &newMax);
+        start = newMax + 1;
+    }
+    return MSD_TRUE;
+}
+
+/**
+ * @brief deviceFilterTcamPlanNextStart 编号在itemIndex之后、已经有条目的第一个过滤器的最小条目，没有时为FILTER_TCAM_SCRATCH_END
+ */
+static int deviceFilterTcamPlanNextStart(const FilterTcamPlan *plan, int itemIndex)
+{
+    for(int k = itemIndex + 1; k < plan->itemCount; ++k){
+        if(!plan->items[k].isPlaced) continue;
+        int minPointer, maxPointer;
+        deviceFilterTcamItemRange(&plan->items[k], &minPointer, &maxPointer);
+        return minPointer;
+    }
+    return FILTER_TCAM_SCRATCH_END;
+}
+
+/**
+ * @brief deviceFilterTcamPlanPush
+ * 将first及之后的过滤器向后移动，使它们的条目都不小于minStart。从最后一个需要移动的过滤器开始移动，
+ * 每个过滤器只移动到前一个过滤器的条目之后、后一个过滤器的条目之前，移动过程中过滤器之间的先后顺序不变。
+ * 新的条目不能与原来的条目重叠，所以后一个过滤器要在前一个过滤器的原来的条目之后再留出它的条目个数
+ * @param keepMoves 调用者之后还需要的移动记录个数
+ * @return 是否可以完成，需要的条目超过FILTER_TCAM_SCRATCH_END或者移动记录不够时返回MSD_FALSE，不修改规划
+ */
+static MSD_BOOL deviceFilterTcamPlanPush(FilterTcamPlan *plan, int first, int minStart, int keepMoves)
+{
+    int start[FILTER_MAX_NUM + 1];
+    int last = first;
+    int need = minStart;
+    int moves = 0;
+    for(; last < plan->itemCount; ++last){
+        FilterTcamItem *item = &plan->items[last];
+        start[last] = need;
+        if(!item->isPlaced) continue;
+        int minPointer, maxPointer;
+        deviceFilterTcamItemRange(item, &minPointer, &maxPointer);
+        if(minPointer >= need) break;
+        need = (maxPointer + 1 > need ? maxPointer + 1 : need) + item->size;
+        ++moves;
+    }
+    if(need > deviceFilterTcamPlanNextStart(plan, last - 1) || plan->moveCount + moves + keepMoves > FILTER_TCAM_MOVE_MAX)
+        return MSD_FALSE;
+    for(int k = last - 1; k >= first; --k){
+        if(!plan->items[k].isPlaced) continue;
+        MSD_U32 pointers[MAX_FILTER_ENTRY_SIZE];
+        if(!deviceFilterTcamPlanFindFree(plan, start[k], deviceFilterTcamPlanNextStart(plan, k), plan->items[k].size, pointers)
+           || !deviceFilterTcamPlanMove(plan, k, pointers))
+            return MSD_FALSE;
+    }
+    return MSD_TRUE;
+}
+
+/**
+ * @brief deviceFilterTcamPlanFindScratch 过滤器的临时位置：目标位置之后、后一个过滤器之前，
+ * 优先使用[FILTER_TCAM_POINTER_END, FILTER_TCAM_SCRATCH_END)，这些条目不会再成为目标位置
+ */
+static MSD_BOOL deviceFilterTcamPlanFindScratch(const FilterTcamPlan *plan, int itemIndex, int targetEnd, MSD_U32 *pointers)
+{
+    int end = deviceFilterTcamPlanNextStart(plan, itemIndex);
+    int size = plan->items[itemIndex].size;
+    return deviceFilterTcamPlanFindFree(plan, targetEnd > FILTER_TCAM_POINTER_END ? targetEnd : FILTER_TCAM_POINTER_END, end, size, pointers)
+           || deviceFilterTcamPlanFindFree(plan, targetEnd, end < FILTER_TCAM_POINTER_END ? end : FILTER_TCAM_POINTER_END, size, pointers);
+}
+
+/**
+ * @brief deviceFilterTcamPlanCompact
+ * 按编号从条目0开始连续排列所有的过滤器，移动过程中过滤器之间的先后顺序一直不变：
+ * 过滤器已经按编号排列时，目标位置只可能被过滤器自己占用，或者被预留位置的过滤器之后的过滤器占用。
+ * 被自己占用时先移动到临时位置(deviceFilterTcamPlanFindScratch)，没有临时位置时先将之后的过滤器向后移动留出临时位置，
+ * 仍然不能完成时保留在原来的条目，之后的过滤器排在它后面；预留位置时先将之后的过滤器向后移动(deviceFilterTcamPlanPush)
+ * @return 是否可以完成，过滤器没有按编号排列时也返回MSD_FALSE
+ */
+static MSD_BOOL deviceFilterTcamPlanCompact(FilterTcamPlan *plan)
+{
+    int base = 0;
+    for(int i = 0; i < plan->itemCount; ++i){
+        FilterTcamItem *item = &plan->items[i];
+        if(base + item->size > FILTER_TCAM_POINTER_END) return MSD_FALSE;
+        int targetEnd = base + item->size;
+        MSD_U32 target[MAX_FILTER_ENTRY_SIZE];
+        MSD_BOOL isInPlace = item->isPlaced;
+        for(int j = 0; j < item->size; ++j){
+            target[j] = (MSD_U32)(base + j);
+            if(item->pointers[j] != target[j]) isInPlace = MSD_FALSE;
+        }
+        if(isInPlace){
+            base = targetEnd;
+            continue;
+        }
+        if(!item->isPlaced && !deviceFilterTcamPlanPush(plan, i + 1, targetEnd, 0))
+            return MSD_FALSE;
+        MSD_BOOL isOverlap = MSD_FALSE;
+        for(int j = 0; j < item->size; ++j){
+            int owner = plan->slotOwner[target[j]];
+            if(owner == i){
+                isOverlap = MSD_TRUE;
+            }else if(owner != FILTER_TCAM_SLOT_FREE){
+                return MSD_FALSE;
+            }
+        }
+        if(isOverlap){
+            int minPointer, maxPointer;
+            deviceFilterTcamItemRange(item, &minPointer, &maxPointer);
+            MSD_U32 scratch[MAX_FILTER_ENTRY_SIZE];
+            MSD_BOOL isFound = deviceFilterTcamPlanFindScratch(plan, i, targetEnd, scratch);
+            if(!isFound && deviceFilterTcamPlanPush(plan, i + 1, (maxPointer + 1 > targetEnd ? maxPointer + 1 : targetEnd) + item->size, 2))
+                isFound = deviceFilterTcamPlanFindScratch(plan, i, targetEnd, scratch);
+            if(!isFound){//没有临时位置，保留在原来的条目
+                base = maxPointer + 1;
+                continue;
+            }
+            if(!deviceFilterTcamPlanMove(plan, i, scratch))
+                return MSD_FALSE;
+        }
+        if(!deviceFilterTcamPlanMove(plan, i, target))
+            return MSD_FALSE;
+        base = targetEnd;
+    }
+    return MSD_TRUE;
+}
+
+/**
+ * @brief deviceFilterMoveFilterTcam
+ * 将过滤器的条目移动到pointers(已经确认未使用)：读取原来的条目，修改级联条目的nextId和第二个条目的pvid，
+ * 先写入第二个条目再写入第一个条目，然后先删除原来的第一个条目再删除原来的第二个条目。
+ * 任何一步失败时恢复为移动之前的状态：重新写入已经删除的原来的条目，再删除已经写入的新条目
+ * @param devNum
+ * @param filterEntry
+ * @param pointers
+ * @return
+ */
+static MSD_STATUS deviceFilterMoveFilterTcam(MSD_U8 devNum, FilterEntry *filterEntry, const MSD_U32 *pointers)
+{
+    int size = filterEntry->tcamPointerSize;
+    MSD_U32 *oldPointers = filterEntry->tcamPointer;
+    MSD_TCAM_DATA *tcamData = (MSD_TCAM_DATA *)pvPortMalloc(sizeof(MSD_TCAM_DATA) * MAX_FILTER_ENTRY_SIZE * 2);
+    if(tcamData == NULL) return MSD_FAIL;
+    MSD_TCAM_DATA *oldData = tcamData + MAX_FILTER_ENTRY_SIZE;//原来的条目，失败时用于恢复
+    MSD_BOOL isCascade[MAX_FILTER_ENTRY_SIZE] = {MSD_FALSE};//是否为级联的第二个条目
+    MSD_STATUS ret = MSD_OK;
+    for(int i = 0; i < size && ret == MSD_OK; ++i){
+        ret = msdTcamEntryRead(devNum, oldPointers[i], &oldData[i]);
+        tcamData[i] = oldData[i];
+    }
+    for(int i = 0; i < size && ret == MSD_OK; ++i){
+        if(tcamData[i].continu == 0) continue;
+        for(int j = 0; j < size; ++j){
+            if(tcamData[i].nextId == oldPointers[j]){
+                tcamData[i].nextId = (MSD_U16)pointers[j];
+                isCascade[j] = MSD_TRUE;
+            }
+        }
+    }
+    for(int i = 0; i < size; ++i){
+        if(isCascade[i] && ((tcamData[i].pvid ^ oldPointers[i]) & tcamData[i].pvidMask) == 0){
+            tcamData[i].pvid = (MSD_U16)pointers[i];
+        }
+    }
+    int written = 0;
+    int writtenIndex[MAX_FILTER_ENTRY_SIZE];//按写入的顺序保存
+    for(int pass = 0; pass < 2 && ret == MSD_OK; ++pass){//第一遍写入级联的第二个条目
+        for(int i = 0; i < size && ret == MSD_OK; ++i){
+            if(isCascade[i] != (pass == 0 ? MSD_TRUE : MSD_FALSE)) continue;
+            TcamOwnerType ownerType;
+            MSD_U16 ownerId;
+            ret = deviceTcamModuleGetOwner(devNum, pointers[i], &ownerType, &ownerId);
+            if(ret == MSD_OK && ownerType != TCAM_OWNER_FREE) ret = MSD_ALREADY_EXIST;
+            if(ret != MSD_OK) break;
+            ret = deviceTcamModuleReserveEntry(devNum, pointers[i], TCAM_OWNER_FILTER, filterEntry->filter.filterId);
+            if(ret != MSD_OK) break;
+            writtenIndex[written++] = i;
+            ret = msdTcamEntryAdd(devNum, pointers[i], &tcamData[i]);
+        }
+    }
+    int deleted = 0;
+    int deletedIndex[MAX_FILTER_ENTRY_SIZE];//按删除的顺序保存
+    for(int pass = 0; pass < 2 && ret == MSD_OK; ++pass){//第一遍删除第一个条目
+        for(int i = 0; i < size && ret == MSD_OK; ++i){
+            if(isCascade[i] != (pass == 0 ? MSD_FALSE : MSD_TRUE)) continue;
+            ret = msdTcamEntryDelete(devNum, oldPointers[i]);
+            if(ret == MSD_OK) deletedIndex[deleted++] = i;
+        }
+    }
+    if(ret != MSD_OK){
+        //按删除的相反顺序恢复原来的条目(先恢复级联的第二个条目)，原来的条目在TCAM分配表中一直属于该过滤器
+        for(int i = deleted - 1; i >= 0; --i){
+            if(msdTcamEntryAdd(devNum, oldPointers[deletedIndex[i]], &oldData[deletedIndex[i]]) != MSD_OK)
+                MSD_DBG_ERROR(("deviceFilterMoveFilterTcam restore tcam entry %u failed\n", (unsigned)oldPointers[deletedIndex[i]]));
+        }
+        //按写入的相反顺序删除新条目(先删除第一个条目)
+        for(int i = written - 1; i >= 0; --i){
+            msdTcamEntryDelete(devNum, pointers[writtenIndex[i]]);
+            deviceTcamModuleFreeEntries(devNum, &pointers[writtenIndex[i]], 1);
+        }
+        vPortFree(tcamData);
+        return ret;
+    }
+    vPortFree(tcamData);
+    deviceTcamModuleFreeEntries(devNum, oldPointers, size);
+    msdMemCpy(oldPointers, pointers, sizeof(MSD_U32) * size);
+    return MSD_OK;
+}
+
+/**
+ * @brief deviceFilterCompileTcam
+ * 按过滤器编号的优先级整理过滤器的条目，并为reserveFilterId预留reserveSize个条目的位置。
+ * 先尝试只移动没有排好顺序的过滤器，不能完成时从条目0开始连续排列所有的过滤器，两种方式都不能完成时返回MSD_NO_SPACE，不移动任何条目
+ * @param devNum
+ * @param reserveFilterId 需要预留位置的过滤器编号，-1为不需要预留
+ * @param reserveSize
+ * @param isCompact 是否直接连续排列所有的过滤器
+ * @param moveCount 移动的条目个数
+ * @return
+ */
+static MSD_STATUS deviceFilterCompileTcam(MSD_U8 devNum, int reserveFilterId, int reserveSize, MSD_BOOL isCompact, int *moveCount)
+{
+    *moveCount = 0;
+    FilterTcamPlan *plan = (FilterTcamPlan *)pvPortMalloc(sizeof(FilterTcamPlan));
+    if(plan == NULL) return MSD_FAIL;
+    MSD_STATUS ret = MSD_OK;
+    MSD_BOOL isPlanned = MSD_FALSE;
+    if(!isCompact){
+        ret = deviceFilterTcamPlanInit(devNum, plan, reserveFilterId, reserveSize);
+        if(ret == MSD_OK)
+            isPlanned = deviceFilterTcamPlanKeepOrdered(plan);
+    }
+    if(ret == MSD_OK && !isPlanned){
+        ret = deviceFilterTcamPlanInit(devNum, plan, reserveFilterId, reserveSize);
+        if(ret == MSD_OK)
+            isPlanned = deviceFilterTcamPlanCompact(plan);
+    }
+    if(ret == MSD_OK && !isPlanned)
+        ret = MSD_NO_SPACE;
+    for(int i = 0; i < plan->moveCount && ret == MSD_OK; ++i){
+        FilterTcamItem *item = &plan->items[plan->moves[i].itemIndex];
+        ret = deviceFilterMoveFilterTcam(devNum, item->filterEntry, plan->moves[i].pointers);
+        if(ret == MSD_OK)
+            *moveCount += item->size;
+    }
+    vPortFree(plan);
+    if(ret != MSD_OK && ret != MSD_NO_SPACE){
+        MSD_DBG_ERROR(("deviceFilterCompileTcam failed,the status is %d\n", ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief deviceFilterGetTcamWindow 过滤器的条目可以使用的范围[start, end)：编号比它小的过滤器的条目之后，编号比它大的过滤器的条目之前
+ */
+static void deviceFilterGetTcamWindow(MSD_U8 devNum, MSD_U8 filterId, MSD_U32 *start, MSD_U32 *end)
+{
+    *start = 0;
+    *end = FILTER_TCAM_POINTER_END;
+    listIter iter;
+    listRewind(s_filters[devNum], &iter);
+    listNode *node;
+    while((node = listNext(&iter)) != NULL){
+        FilterEntry *filterEntry = (FilterEntry *)node->value;
+        if(filterEntry->filter.filterId == filterId) continue;
+        for(int i = 0; i < filterEntry->tcamPointerSize; ++i){
+            MSD_U32 pointer = filterEntry->tcamPointer[i];
+            if(filterEntry->filter.filterId < filterId && pointer + 1 > *start){
+                *start = pointer + 1;
+            }else if(filterEntry->filter.filterId > filterId && pointer < *end){
+                *end = pointer;
+            }
+        }
+    }
+    if(*start > *end) *start = *end;
+}
+
 /****************************************************************************************************
- * @brief deviceFilterGetUnusedTcamPointers 找到没有使用的tcam entry条目
+ * @brief deviceFilterGetUnusedTcamPointers 从TCAM分配表中找到没有使用的tcam entry条目，不读取交换机
+ * 条目在按编号排列的前后过滤器之间，优先使用连续的条目，没有足够的条目时先整理过滤器的条目，找到的条目标记为该过滤器使用
  * @param devNum
+ * @param filterId 过滤器编号
  * @param tcam_pointer
  * @param tcamPointerSize 需要的tcma entry条数
  * @param isFound 如果找到指定未使用的tcam entry条目数，设置为msd_true
  * @return
  ****************************************************************************************************/
-static MSD_STATUS deviceFilterGetUnusedTcamPointers(MSD_U8 devNum, MSD_U32 *tcam_pointer, int tcamPointerSize, MSD_BOOL *isFound)
+static MSD_STATUS deviceFilterGetUnusedTcamPointers(MSD_U8 devNum, MSD_U8 filterId, MSD_U32 *tcam_pointer, int tcamPointerSize, MSD_BOOL *isFound)
 {
     *isFound = MSD_FALSE;
-    int count = 0;
     msdMemSet(tcam_pointer,0,sizeof(MSD_U32) * tcamPointerSize);
-    MSD_TCAM_DATA data;
-    MSD_STATUS status = MSD_OK;
-    int size = FILTER_MAX_NUM * MAX_FILTER_ENTRY_SIZE;//最大过滤器 * 一个过滤器可能最多需要的tcam entry条目
-    for (int i = 0; i < size;  ++i) {
-        status = msdTcamEntryRead(devNum, i, &data);
-        if (status != MSD_OK) break;
-        if (data.frameTypeMask == 0x0) {//没有使用的tcam entry
-            tcam_pointer[count++] = i;
-            if(count == tcamPointerSize){
-                *isFound = MSD_TRUE;
-                break;
-            }
+    MSD_U32 start, end;
+    deviceFilterGetTcamWindow(devNum, filterId, &start, &end);
+    MSD_STATUS status = MSD_NO_SPACE;
+    if (start < end) {
+        status = deviceTcamModuleAllocEntries(devNum, TCAM_OWNER_FILTER, filterId, start, end, tcamPointerSize, tcam_pointer);
+    }
+    if (status == MSD_NO_SPACE) {//前后过滤器之间没有足够的条目，整理之后再分配
+        int moveCount;
+        status = deviceFilterCompileTcam(devNum, filterId, tcamPointerSize, MSD_FALSE, &moveCount);
+        if (status == MSD_OK) {
+            deviceFilterGetTcamWindow(devNum, filterId, &start, &end);
+            status = start < end ? deviceTcamModuleAllocEntries(devNum, TCAM_OWNER_FILTER, filterId, start, end, tcamPointerSize, tcam_pointer) : MSD_NO_SPACE;
         }
     }
+    if (status == MSD_NO_SPACE) {//没有足够的条目
+        return MSD_OK;
+    }
+    if (status == MSD_OK) {
+        *isFound = MSD_TRUE;
+    }
+    return status;
+}
+
+/****************************************************************************************************
+ * @brief deviceFilterReleaseAllocTcamPointers
+ * 添加或者修改过滤器失败时，删除本次新分配的tcam entry条目(可能已经写入交换机)并释放
+ * @param devNum
+ * @param tcamPointer
+ * @param start 新分配条目的开始下标
+ * @param end 新分配条目的结束下标(不包含)
+ * @param status 失败的原因
+ * @return status
+ ****************************************************************************************************/
+static MSD_STATUS deviceFilterReleaseAllocTcamPointers(MSD_U8 devNum, MSD_U32 *tcamPointer, int start, int end, MSD_STATUS status)
+{
+    for (int i = start; i < end; ++i) {
+        msdTcamEntryDelete(devNum, tcamPointer[i]);
+    }
+    if (end > start) {
+        deviceTcamModuleFreeEntries(devNum, tcamPointer + start, end - start);
+    }
     return status;
 }
 
@@ -153,10 +662,12 @@ static MSD_STATUS deviceFilterGetUnusedTcamPointers(MSD_U8 devNum, MSD_U32 *tcam
  * @brief setDeviceFilterAllTcamPointer
  * 设置某个过滤器需要的tcam entry(均考虑到启用Qinq的情况，如果带标签帧(帧的TPID为寄存器adType的值)的时候，会匹配frameType为0x2的TCAM,否则就使用frameType为0x0的情况)
  * @param devNum  设备编号
+ * @param filterId  过滤器编号
  * @param filterEntry  过滤器条目
  * @param needTcamPointer 需要的TCAM Entry条目列表
  * @param needTcamPointerSize  need_tcam_pointer的大小
  * @param needTcamPointerCount 过滤器需要的TCAM Entry条数
+ * @param allocTcamPointerStart need_tcam_pointer中从该下标开始为本次新分配的TCAM Entry
  * @param releaseTcamPointer 需要释放的TCAM Entry条目列表
  * @param releaseTcamPointerSize release_tcam_pointer_size的大小
  * @param releaseTcamPointerCount 过滤器需要释放的TCAM Entry条数
@@ -164,14 +675,15 @@ static MSD_STATUS deviceFilterGetUnusedTcamPointers(MSD_U8 devNum, MSD_U32 *tcam
  * @param isNeedCheckQinqAndNotQinq 是否需要同时检测Qinq或者非QinQ标签帧
  * @return MSD_OK:success, others:error
  **************************************************************************************************************************************************/
-static MSD_STATUS setDeviceFilterAllTcamPointer(MSD_U8 devNum, FilterEntry *filterEntry,
-                                                MSD_U32 *needTcamPointer, int needTcamPointerSize,int *needTcamPointerCount,
+static MSD_STATUS setDeviceFilterAllTcamPointer(MSD_U8 devNum, MSD_U8 filterId, FilterEntry *filterEntry,
+                                                MSD_U32 *needTcamPointer, int needTcamPointerSize,int *needTcamPointerCount,int *allocTcamPointerStart,
                                                 MSD_U32 *releaseTcamPointer, int releaseTcamPointerSize,int *releaseTcamPointerCount,
                                                 FilterType ftype, MSD_BOOL isNeedCheckQinqAndNotQinq)
 {
     msdMemSet(needTcamPointer,0,needTcamPointerSize * sizeof(MSD_U32));
     msdMemSet(releaseTcamPointer,0,releaseTcamPointerSize * sizeof(MSD_U32));
     *needTcamPointerCount = 0;
+    *allocTcamPointerStart = 0;
     *releaseTcamPointerCount = 0;
     MSD_STATUS ret = MSD_OK;
     int needTcamSize = 0;//
@@ -202,14 +714,15 @@ static MSD_STATUS setDeviceFilterAllTcamPointer(MSD_U8 devNum, FilterEntry *filt
                 needTcamPointer[i] = filterEntry->tcamPointer[i];
             }
         }else if(needTcamSize > 0){//需要从未使用的tcam entry中获取
-            for(int i = 0; i < tcamEntrySize; ++i){ //
-                needTcamPointer[i] = filterEntry->tcamPointer[i];
-            }
             MSD_BOOL isFound;
-            ret = deviceFilterGetUnusedTcamPointers(devNum, needTcamPointer,needTcamSize,&isFound);
+            //新分配的条目放在保留的条目之后
+            ret = deviceFilterGetUnusedTcamPointers(devNum, filterId, needTcamPointer + tcamEntrySize,needTcamSize,&isFound);
             if(ret != MSD_OK || !isFound){//无法获取到条目
                 return MSD_FAIL;
             }
+            for(int i = 0; i < tcamEntrySize; ++i){ //分配时可能整理过条目，分配之后再获取保留的条目
+                needTcamPointer[i] = filterEntry->tcamPointer[i];
+            }
         }else{ //需要释放对应的tcam entry
             int releaseSize = -needTcamSize;//释放的条目数
             *releaseTcamPointerCount = releaseSize;
@@ -224,6 +737,7 @@ static MSD_STATUS setDeviceFilterAllTcamPointer(MSD_U8 devNum, FilterEntry *filt
             }
         }
         *needTcamPointerCount = tcamEntrySize + needTcamSize;
+        *allocTcamPointerStart = needTcamSize > 0 ? tcamEntrySize : *needTcamPointerCount;
     }else{//新增过滤器,需要从未使用的tcam entry中获取
         if(ftype == FILTER_TYPE_ALL){
             //在qinq模式下，如果帧带有双标签，则需要tcam entry的frameType = 0x2,同时如果帧不带双标签，则frameType=0x0.因此我们这里统一设置为需要2个TCAM Entry
@@ -243,7 +757,7 @@ static MSD_STATUS setDeviceFilterAllTcamPointer(MSD_U8 devNum, FilterEntry *filt
 
         }
         MSD_BOOL is_found;
-        ret = deviceFilterGetUnusedTcamPointers(devNum, needTcamPointer,needTcamSize,&is_found);
+        ret = deviceFilterGetUnusedTcamPointers(devNum, filterId, needTcamPointer,needTcamSize,&is_found);
         if(ret != MSD_OK || !is_found){//无法获取到条目
             return MSD_FAIL;
         }
@@ -949,6 +1463,7 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
     }
     MSD_U32  needTcamEntryPointer[MAX_FILTER_ENTRY_SIZE] = {0};//保存本次过滤条目对应的tcam entry编号
     int needTcamEntrySize;
+    int allocTcamEntryStart;//从该下标开始为本次新分配的tcam entry
     MSD_U32 releaseTcamEntryPointer[MAX_FILTER_ENTRY_SIZE] = {0};
     int releaseTcamEntrySize;
     //如果添加了其他类型的过滤器，则从以下代码开始修改
@@ -956,9 +1471,10 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
     if(isCheckNotQinqVlan == isCheckQinqVlan){//当这2个标志同时设置或者同时没有设置的时候即代表要同时检测双标签
         isNeedCheckQinqAndNotQinq = MSD_TRUE;
     }
-    ret =  setDeviceFilterAllTcamPointer(devNum,filterEntry,needTcamEntryPointer,MAX_FILTER_ENTRY_SIZE,&needTcamEntrySize,
+    ret =  setDeviceFilterAllTcamPointer(devNum,filterNum,filterEntry,needTcamEntryPointer,MAX_FILTER_ENTRY_SIZE,&needTcamEntrySize,&allocTcamEntryStart,
                                         releaseTcamEntryPointer,MAX_FILTER_ENTRY_SIZE,&releaseTcamEntrySize,ftype,isNeedCheckQinqAndNotQinq);
     if(ret != MSD_OK) return ret;
+    int heldTcamEntrySize = needTcamEntrySize;//过滤器当前占用的tcam entry条数，IP过滤器实际使用的条数可能更少
     if(ftype != FILTER_TYPE_IP_TCP_OR_UDP){// 非IP帧或者过滤所有帧,依然可以过滤ip帧,但是如果需要过滤ip字段或者tcp/udp，则使用非ip过滤器类型，则不能对其进行过滤
         MSD_TCAM_DATA tcamData1,tcamData2;
         msdMemSet(&tcamData1, 0, sizeof(MSD_TCAM_DATA));
@@ -970,14 +1486,14 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
         setEgressPortsAndFilterType(MSD_TRUE, &tcamData1,egressPortVecBit,etype);//将设置过滤的转发端口和端口的动作设置到TCAM Entry 1
         if(ftype == FILTER_TYPE_ALL){ //filter all
             ret = msdTcamEntryAdd(devNum, needTcamEntryPointer[0], &tcamData1);//add tcam entry 1
-            if(ret != MSD_OK) return ret;
+            if(ret != MSD_OK) return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,heldTcamEntrySize,ret);
             tcamData2.frameType = 0x2;//provider port shoud be set 0x2,netowrk port should be set 0x0
             tcamData2.frameTypeMask = 0x3; //有效的TCAM ，Mask这2位必须为1
             tcamData2.spv = 0x0;//设置为全0，spvMask相应位设置为0，则代表相应端口需要做入口过滤
             tcamData2.spvMask = ~ingressPortVecBit;
             setEgressPortsAndFilterType(MSD_TRUE, &tcamData2,egressPortVecBit,etype);//将设置过滤的转发端口和端口的动作设置到TCAM Entry 2
             ret = msdTcamEntryAdd(devNum, needTcamEntryPointer[1], &tcamData2);//add tcam entry 2
-            if(ret != MSD_OK) return ret;
+            if(ret != MSD_OK) return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,heldTcamEntrySize,ret);
         }else { //
             if(isCheckQinqVlan && !isCheckNotQinqVlan){//匹配Qinq标签帧，不匹配非QinQ标签帧
                 tcamData1.frameType = 0x2;//provider port shoud be set 0x2,netowrk port should be set 0x0
@@ -1077,7 +1593,7 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
                 }
             }
             ret = msdTcamEntryAdd(devNum, needTcamEntryPointer[0], &tcamData1);
-            if(ret != MSD_OK) return ret;
+            if(ret != MSD_OK) return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,heldTcamEntrySize,ret);
             if(isNeedCheckQinqAndNotQinq){//如果既需要匹配非QinQ，又要匹配QinQ时,在使用一个TCAM ENTRY用以匹配QinQ标签
                 tcamData1.frameType = 0x2;//provider port shoud be set 0x2,netowrk port should be set 0x0
                 tcamData1.frameTypeMask = 0x3; //有效的TCAM ，Mask这2位必须为1
@@ -1100,7 +1616,7 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
                     tcamData1.pvidMask = (MSD_U16)(qinqVidMask & (MSD_U16)0xfff);
                 }
                 ret = msdTcamEntryAdd(devNum, needTcamEntryPointer[1], &tcamData1);
-                if(ret != MSD_OK) return ret;
+                if(ret != MSD_OK) return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,heldTcamEntrySize,ret);
             }
         }
     }else{ //IPv4/IPv6， UDP /TCP
@@ -1221,7 +1737,7 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
 
         ret = msdTcamAdvConfig(devNum, pktType, needTcamEntryPointer[0], needTcamEntryPointer[1], &keyMaskPtr, &keyPtr,
                                &maskPtr, &patternPtr, &actionPtr, &entry2Used);
-        if(ret != MSD_OK) return ret;
+        if(ret != MSD_OK) return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,heldTcamEntrySize,ret);
         if(!entry2Used){//only use one tcam entry
             needTcamEntrySize = 1;
             // ret = msdTcamEntryDelete(dev_num,need_tcam_entry_pointer[1]);//释放第二个tcam entry
@@ -1257,7 +1773,7 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
             }
             ret = msdTcamAdvConfig(devNum, pktType, tcamEntryPointer1, tcamEntryPointer2, &keyMaskPtr, &keyPtr,
                                    &maskPtr, &patternPtr, &actionPtr, &entry2Used);
-            if(ret != MSD_OK) return ret;
+            if(ret != MSD_OK) return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,heldTcamEntrySize,ret);
             if(!entry2Used){
                 needTcamEntrySize = 2;
             }else{
@@ -1265,16 +1781,26 @@ MSD_STATUS deviceFilterModuleAddFilter(IN MSD_U8 devNum, IN MSD_U8 filterId, con
             }
         }
     }
+    //IP过滤器仅使用了一个tcam entry时，多分配的条目不再占用，之前已经写入交换机的条目需要删除
+    for(int i = needTcamEntrySize; i < heldTcamEntrySize; ++i){
+        if(i < allocTcamEntryStart){
+            ret = msdTcamEntryDelete(devNum,needTcamEntryPointer[i]);
+            if(ret != MSD_OK)
+                return ret;
+        }
+        deviceTcamModuleFreeEntries(devNum,&needTcamEntryPointer[i],1);
+    }
     for(int i = 0; i < releaseTcamEntrySize; ++i){
         ret = msdTcamEntryDelete(devNum,releaseTcamEntryPointer[i]);
         if(ret != MSD_OK)
             return ret;
+        deviceTcamModuleFreeEntries(devNum,&releaseTcamEntryPointer[i],1);
     }
     MSD_BOOL isSuccess = addOrModifyFilterEntryToList(filterEntry,devNum,filterNum,filterName,ingressPortVecBit,
                                                       etype,egressPortVecBit,ftype,filterParam,needTcamEntryPointer,needTcamEntrySize);//
     if(isSuccess)
         return MSD_OK;
-    return MSD_FAIL;
+    return deviceFilterReleaseAllocTcamPointers(devNum,needTcamEntryPointer,allocTcamEntryStart,needTcamEntrySize,MSD_FAIL);
 }
 
 /****************************************************************************************************************
@@ -1309,6 +1835,7 @@ static MSD_STATUS removeFilterByNameOrId(MSD_U8 devNum, MSD_BOOL isFilterId, voi
         ret = msdTcamEntryDelete(devNum, tcamPointer[i]);
         if(ret != MSD_OK) return ret;
     }
+    deviceTcamModuleFreeEntries(devNum, tcamPointer, tcamSize);
     listDelNode(s_filters[devNum],filterNode);
     return ret;
 }
@@ -1328,14 +1855,31 @@ MSD_STATUS deviceFilterModuleClearFilters(MSD_U8 devNum)
 {
     MSD_STATUS ret = checkDevNumAndIsEnable(devNum);
     if(ret != MSD_OK) return ret;
-    ret = msdTcamAllDelete(devNum);
-    if(ret == MSD_OK){
-        s_filterModuleInit[devNum].filterIndex = 0;//reset filter index
-        listEmpty(s_filters[devNum]);
+    //只删除过滤器使用的条目，QinQ VLAN使用的条目保留
+    listIter iter;
+    listRewind(s_filters[devNum], &iter);
+    listNode *node;
+    while((node = listNext(&iter)) != NULL){
+        FilterEntry *filterEntry = (FilterEntry *)node->value;
+        for(int i = 0; i < filterEntry->tcamPointerSize; ++i){
+            ret = msdTcamEntryDelete(devNum, filterEntry->tcamPointer[i]);
+            if(ret != MSD_OK) return ret;
+        }
+        deviceTcamModuleFreeEntries(devNum, filterEntry->tcamPointer, filterEntry->tcamPointerSize);
+        listDelNode(s_filters[devNum], node);
     }
+    s_filterModuleInit[devNum].filterIndex = 0;//reset filter index
     return ret;
 }
 
+MSD_STATUS deviceFilterModuleDefragTcam(MSD_U8 devNum, int *moveCount)
+{
+    MSD_STATUS ret = checkDevNumAndIsEnable(devNum);
+    if(ret != MSD_OK) return ret;
+    if(moveCount == NULL) return MSD_BAD_PARAM;
+    return deviceFilterCompileTcam(devNum, -1, 0, MSD_TRUE, moveCount);
+}
+
 
 
 void copyDeviceFilterParam(DeviceFilter *src, DeviceFilter *dest)
@@ -3,16 +3,13 @@
 #include <deviceVlanModule.h>
 #include <string.h>
 #include <stdlib.h>
-#include "adlist.h"
 
 #define  DEFAULT_FID_VALUE 1 //默认的操作的FID
 #define  DEFAULT_AGE_TIME_MINUTE 5//默认超时时间
-#define  VID_FLAG_ARRAY_SIZE 128
 
-//每个设备最多支持512 * 8 = 4096个fid,如FID_SET_ARRAY[0][0]的bit0被设置为1，代表设备0的fid 0 存在MAC条目，如果为0，则代表fid 0不存在mac条目。加快查询所有FID的MAC地址条目速度
-//#define  FID_ARRAY_LENGTH 512
-//static MSD_U8 FID_SET_ARRAY[MAX_SOHO_DEVICES][FID_ARRAY_LENGTH];//sk32144不能这么做，没有这么大的内存可以，需要存放所有的fid。
-static list *s_fids[MAX_SOHO_DEVICES];
+//每个设备最多支持512 * 8 = 4096个fid,如s_fids[0]的fid 0被设置，代表设备0的fid 0 存在MAC条目，如果没有设置，则代表fid 0不存在mac条目。加快查询所有FID的MAC地址条目速度
+//每个设备512个字节，设置和查询都不需要申请内存
+static FidSet s_fids[MAX_SOHO_DEVICES];
 
 /**
  * 用于描述ATU条目的相关属性状态
@@ -24,18 +21,77 @@ typedef struct {
     //MSD_BOOL is_auto;//是否是动态地址
 }AtuEntryStatus;
 
+#if MSD_MAX_SWITCH_PORTS > 12
+#error "PackedMacEntry only stores 12 bit port vectors"
+#endif
+
+/**
+ * 内存中保存的MAC条目，10个字节，对外接口仍然使用MacEntry
+ */
+typedef struct {
+    MSD_ETHERADDR address;//mac地址
+    MSD_U8  ageAndFlag;//同MacEntry的ageAndFlag
+    MSD_U8  vidPortVec[3];//bit 0 ~ bit 11:VID, bit 12 ~ bit 23:portVec
+}PackedMacEntry;
+
+#ifdef ATU_SHADOW_STATIC_ONLY
+#define  SHADOW_AUTO_ENTRIES   0   //动态条目不保存在内存中，需要时从交换机中读取
+#define  VID_HEAD_BITS     7
+#else
+#define  SHADOW_AUTO_ENTRIES   MAX_AUTO_ATU_ENTRIES
+#define  VID_HEAD_BITS     10
+#endif
+
+//MAC条目索引：slot 0 ~ SHADOW_AUTO_ENTRIES-1 对应autoEntry的下标，之后的slot对应staticEntry的下标
+#define  MAC_INDEX_NIL     0xFFFF  //空slot
+#define  MAC_SLOT_COUNT    (SHADOW_AUTO_ENTRIES + MAX_STATIC_ATU_ENTRIES)
+#define  MAC_HASH_SIZE     (MAC_SLOT_COUNT + MAC_SLOT_COUNT / 4)  //哈希表大小，满载时负载因子为0.8
+//有条目的VID的链表头表，开放寻址，表项为链表头的slot，VID从链表头条目中读取
+#define  VID_HEAD_SIZE     (1U << VID_HEAD_BITS)
+//最多有条目的VID个数，VLAN模块最多配置ALLOW_OPERATION_MAX_VLAN_NUM个VLAN，交换机只在这些VLAN和端口默认FID中学习
+#define  VID_HEAD_MAX      (VID_HEAD_SIZE * 3 / 4)
+#ifdef ATU_SHADOW_STATIC_ONLY
+#define  MAC_SLOT_IS_STATIC(slot)  ((void)(slot), MSD_TRUE)  //只有静态条目
+#else
+#define  MAC_SLOT_IS_STATIC(slot)  (((slot) >= SHADOW_AUTO_ENTRIES) ? MSD_TRUE : MSD_FALSE)
+#endif
+#define  MAC_ENTRY_MARK_BIT  6  //ageAndFlag的bit 6:刷新时标记从交换机读到的条目
+
+#define  ATU_CHANGE_JOURNAL_SIZE  256  //变更记录的条数，2的幂
+
+/**
+ * 一条变更记录，generation为g的记录存放在journal[g % ATU_CHANGE_JOURNAL_SIZE]
+ */
+typedef struct {
+    MSD_U32 generation;
+    PackedMacEntry entry;//变更之后的条目，删除和老化时为删除之前的条目
+    MSD_U8  changeType;//AtuChangeType
+    MSD_U8  reserved;
+}AtuJournalRecord;
+
 /**
  * ATU Module init type
  */
 typedef struct {
     short fidNum;//设备使用的MAC -1:代表使用设备所有的fid，大于0的fid则使用指定的fid
-    MacEntry  staticEntry[MAX_STATIC_ATU_ENTRIES];//用以存储所有有VID关联的静态MAC条目（最多允许的数据有限制）
+    PackedMacEntry  staticEntry[MAX_STATIC_ATU_ENTRIES];//用以存储所有有VID关联的静态MAC条目（最多允许的数据有限制）
     MSD_U8 staticEntryCount;//当前静态条目的条数
-    MacEntry  autoEntry[MAX_AUTO_ATU_ENTRIES];//用以存储所有有VID关联的动态MAC条目
+#ifndef ATU_SHADOW_STATIC_ONLY
+    PackedMacEntry  autoEntry[MAX_AUTO_ATU_ENTRIES];//用以存储所有有VID关联的动态MAC条目
+#endif
     MSD_U16  autoEntryCount;//当前动态条目的条数
     UseMacEntryType useEntryType;//使用条目的方式：使用静态条目，还是结合使用
-    MSD_U32 vidArrayFlag[VID_FLAG_ARRAY_SIZE];//当对应的下标被设置为真时，有MAC条目的VID为该值，该VID条目不能被删除
-    MSD_U16  allMacEntryVidSize;//当前所有MAC条目的所有VID集合,如果为0，则可以删除所有的VLAN条目。
+    MSD_U16  allMacEntryVidSize;//有MAC条目的VID个数(vidHead中的表项个数),如果为0，则可以删除所有的VLAN条目。由条目增删维护
+    MSD_U32  autoDropCount;//没有空闲位置而没有保存的动态条目个数
+    MSD_U32  getNextOps;//读取和查找交换机条目下发的GetNext操作的累计个数
+    MSD_U32  dumpFrames;//通过RMU读取ATU表的dump帧的累计个数
+    MSD_U16  macHash[MAC_HASH_SIZE];//以(MAC,VID)为键的开放寻址(线性探测)哈希表，存放slot，MAC_INDEX_NIL为空
+    MSD_U16  slotNext[MAC_SLOT_COUNT];//有效slot:同一VID链表的下一个slot; 无效slot:空闲链表的下一个slot
+    MSD_U16  vidHead[VID_HEAD_SIZE];//以VID为键的开放寻址哈希表，存放VID的MAC条目(静态和动态)链表头，MAC_INDEX_NIL为空
+    MSD_U16  autoFreeHead;//autoEntry空闲链表头
+    MSD_U16  staticFreeHead;//staticEntry空闲链表头
+    MSD_U32  generation;//每次条目变更加1，0代表还没有变更
+    AtuJournalRecord journal[ATU_CHANGE_JOURNAL_SIZE];//最近ATU_CHANGE_JOURNAL_SIZE次变更，也用于查询条目最后一次变更的generation
 }AtuModuleInitType;
 
 static AtuModuleInitType s_atuModuleInitType[MAX_SOHO_DEVICES] = { 0 };
@@ -55,100 +111,445 @@ extern MSD_STATUS deviceVlanModuleGetVlanEgressMode(IN MSD_U8 devNum, OUT VlanEg
 static void deviceMacEntryAddToList(IN AtuEntryType entryType, IN MSD_ATU_ENTRY* checkAtuEntry, OUT MSD_ATU_ENTRY* atuEntry, OUT int* atuEntryCount);
 static MSD_STATUS deviceAtuModuleSetUseMacEntryTypeToConfiguration(IN MSD_U8 devNum, IN UseMacEntryType useMacType);
 
+static inline MSD_U16 packedEntryVid(const PackedMacEntry* entry)
+{
+    return (MSD_U16)(entry->vidPortVec[0] | ((entry->vidPortVec[1] & 0xF) << 8));
+}
+
+static inline MSD_U32 packedEntryPortVec(const PackedMacEntry* entry)
+{
+    return (MSD_U32)((entry->vidPortVec[1] >> 4) | (entry->vidPortVec[2] << 4));
+}
+
+static inline void packedEntrySetVidPortVec(PackedMacEntry* entry, MSD_U16 vid, MSD_U32 portVec)
+{
+    entry->vidPortVec[0] = (MSD_U8)(vid & 0xFF);
+    entry->vidPortVec[1] = (MSD_U8)(((vid >> 8) & 0xF) | ((portVec & 0xF) << 4));
+    entry->vidPortVec[2] = (MSD_U8)((portVec >> 4) & 0xFF);
+}
+
+static void packedEntryToMacEntry(const PackedMacEntry* entry, OUT MacEntry* macEntry)
+{
+    msdMemSet(macEntry, 0, sizeof(MacEntry));
+    macEntry->address = entry->address;
+    macEntry->ageAndFlag = entry->ageAndFlag;
+    macEntry->vid = packedEntryVid(entry);
+    macEntry->portVec = packedEntryPortVec(entry);
+}
+
+static inline PackedMacEntry* macSlotEntry(AtuModuleInitType* atu, MSD_U16 slot)
+{
+#ifdef ATU_SHADOW_STATIC_ONLY
+    return &atu->staticEntry[slot];
+#else
+    return MAC_SLOT_IS_STATIC(slot) ? &atu->staticEntry[slot - SHADOW_AUTO_ENTRIES] : &atu->autoEntry[slot];
+#endif
+}
+
 /**
- * @brief vlanNumHasMacEntry 判断是否具有指定的VID的MAC条目，用于在VLAN执行删除操作时是否删除指定VLAN的目的
- * 注：如果VLAN执行删除VID条目时，如果还存在对应的MAC条目，则不执行VLAN条目的删除操作
- * @param devNum 设备编号
- * @param vidNum VID编号
- * @return
+ * @brief macHashHome 计算(MAC,VID)在哈希表中的起始位置(乘法哈希，取高位映射到[0, MAC_HASH_SIZE))
  */
-static MSD_BOOL vlanNumHasMacEntry(MSD_U8 devNum, MSD_U16 vidNum) {
-    for (int i = 0; i < MAX_AUTO_ATU_ENTRIES; ++i) {
-        if (s_atuModuleInitType[devNum].autoEntry[i].vid == vidNum) {
-            return MSD_TRUE;
+static inline MSD_U32 macHashHome(const MSD_ETHERADDR* address, MSD_U16 vid)
+{
+    MSD_U32 high = ((MSD_U32)address->arEther[0] << 24) | ((MSD_U32)address->arEther[1] << 16) | vid;
+    MSD_U32 low = ((MSD_U32)address->arEther[2] << 24) | ((MSD_U32)address->arEther[3] << 16) |
+                  ((MSD_U32)address->arEther[4] << 8) | address->arEther[5];
+    MSD_U32 hash = (low ^ (high * 0x9E3779B1U)) * 0x85EBCA6BU;
+    return (MSD_U32)(((MSD_U64)hash * MAC_HASH_SIZE) >> 32);
+}
+
+static inline MSD_U32 macHashNext(MSD_U32 pos)
+{
+    return pos + 1 == MAC_HASH_SIZE ? 0 : pos + 1;
+}
+
+/**
+ * @brief macHashDistance 从from向后探测到to的距离
+ */
+static inline MSD_U32 macHashDistance(MSD_U32 from, MSD_U32 to)
+{
+    return to >= from ? to - from : to + MAC_HASH_SIZE - from;
+}
+
+static inline MSD_U32 vidHeadHome(MSD_U16 vid)
+{
+    return ((MSD_U32)vid * 0x9E3779B1U) >> (32 - VID_HEAD_BITS);
+}
+
+/**
+ * @brief vidHeadPos 查找VID在链表头表中的位置
+ * @return VID有条目时返回其表项的位置，否则返回可以插入的空表项的位置
+ */
+static MSD_U32 vidHeadPos(AtuModuleInitType* atu, MSD_U16 vid)
+{
+    MSD_U32 pos = vidHeadHome(vid);
+    MSD_U16 head;
+    while ((head = atu->vidHead[pos]) != MAC_INDEX_NIL && packedEntryVid(macSlotEntry(atu, head)) != vid) {
+        pos = (pos + 1) & (VID_HEAD_SIZE - 1);
+    }
+    return pos;
+}
+
+/**
+ * @brief vidHeadOf VID的MAC条目链表头，没有条目时返回MAC_INDEX_NIL
+ */
+static inline MSD_U16 vidHeadOf(AtuModuleInitType* atu, MSD_U16 vid)
+{
+    return atu->vidHead[vidHeadPos(atu, vid)];
+}
+
+/**
+ * @brief vidHeadRemoveAt VID的最后一个条目删除时删除其链表头表项，后续探测链上的表项前移填补空位
+ */
+static void vidHeadRemoveAt(AtuModuleInitType* atu, MSD_U32 hole)
+{
+    MSD_U32 pos = hole;
+    while (1) {
+        pos = (pos + 1) & (VID_HEAD_SIZE - 1);
+        MSD_U16 moved = atu->vidHead[pos];
+        if (moved == MAC_INDEX_NIL)
+            break;
+        MSD_U32 home = vidHeadHome(packedEntryVid(macSlotEntry(atu, moved)));
+        if (((pos - home) & (VID_HEAD_SIZE - 1)) >= ((pos - hole) & (VID_HEAD_SIZE - 1))) {//空位在该表项的探测路径上
+            atu->vidHead[hole] = moved;
+            hole = pos;
         }
     }
-    for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
-        if (s_atuModuleInitType[devNum].staticEntry[i].vid == vidNum) {
-            return MSD_TRUE;
+    atu->vidHead[hole] = MAC_INDEX_NIL;
+    atu->allMacEntryVidSize--;
+}
+
+/**
+ * @brief atuJournalAppend 记录slot条目的一次变更，更新generation
+ */
+static void atuJournalAppend(AtuModuleInitType* atu, MSD_U16 slot, AtuChangeType changeType)
+{
+    MSD_U32 generation = ++atu->generation;
+    AtuJournalRecord* record = &atu->journal[generation & (ATU_CHANGE_JOURNAL_SIZE - 1)];
+    record->generation = generation;
+    record->entry = *macSlotEntry(atu, slot);
+    record->changeType = (MSD_U8)changeType;
+}
+
+/**
+ * @brief macSlotGeneration 从变更记录中查找slot条目最后一次变更的generation，不为每个条目保存generation
+ * @return 变更已经被覆盖时返回保留的最早一条记录之前的generation，不小于条目实际的generation
+ */
+static MSD_U32 macSlotGeneration(AtuModuleInitType* atu, MSD_U16 slot)
+{
+    PackedMacEntry* entry = macSlotEntry(atu, slot);
+    MSD_BOOL isStatic = MAC_SLOT_IS_STATIC(slot);
+    MSD_U16 vid = packedEntryVid(entry);
+    MSD_U32 generation = atu->generation;
+    for (MSD_U32 n = 0; n < ATU_CHANGE_JOURNAL_SIZE && generation != 0; ++n, --generation) {
+        const AtuJournalRecord* record = &atu->journal[generation & (ATU_CHANGE_JOURNAL_SIZE - 1)];
+        if (record->generation != generation)//批量清空时没有逐条记录，之前的条目已经全部删除
+            break;
+        if ((IS_BIT_SET(record->entry.ageAndFlag, 0) ? MSD_TRUE : MSD_FALSE) == isStatic && packedEntryVid(&record->entry) == vid &&
+            MAC_IS_EQUAL(record->entry.address, entry->address))
+            return generation;
+    }
+    return generation;
+}
+
+/**
+ * @brief macIndexInit 清空所有条目，重建空闲链表
+ */
+static void macIndexInit(AtuModuleInitType* atu)
+{
+    for (MSD_U32 i = 0; i < MAC_HASH_SIZE; ++i) {
+        atu->macHash[i] = MAC_INDEX_NIL;
+    }
+    for (MSD_U32 i = 0; i < VID_HEAD_SIZE; ++i) {
+        atu->vidHead[i] = MAC_INDEX_NIL;
+    }
+    for (MSD_U32 i = 0; i < MAC_SLOT_COUNT; ++i) {
+        CLEAR_BIT(macSlotEntry(atu, (MSD_U16)i)->ageAndFlag, 2);//设置为无效状态
+        atu->slotNext[i] = (MSD_U16)(i + 1);
+    }
+#ifdef ATU_SHADOW_STATIC_ONLY
+    atu->autoFreeHead = MAC_INDEX_NIL;
+#else
+    atu->slotNext[SHADOW_AUTO_ENTRIES - 1] = MAC_INDEX_NIL;
+    atu->autoFreeHead = 0;
+#endif
+    atu->slotNext[MAC_SLOT_COUNT - 1] = MAC_INDEX_NIL;
+    atu->staticFreeHead = SHADOW_AUTO_ENTRIES;
+    atu->autoEntryCount = 0;
+    atu->staticEntryCount = 0;
+    atu->allMacEntryVidSize = 0;
+}
+
+/**
+ * @brief macIndexFind 查找(MAC,VID)对应的静态或者动态条目
+ * @return 找到返回slot，否则返回MAC_INDEX_NIL
+ */
+static MSD_U16 macIndexFind(AtuModuleInitType* atu, const MSD_ETHERADDR* address, MSD_U16 vid, MSD_BOOL isStatic)
+{
+    if (vid > MAX_FID_VALUE)
+        return MAC_INDEX_NIL;
+    MSD_U32 pos = macHashHome(address, vid);
+    MSD_U16 slot;
+    while ((slot = atu->macHash[pos]) != MAC_INDEX_NIL) {
+        PackedMacEntry* entry = macSlotEntry(atu, slot);
+        if (MAC_SLOT_IS_STATIC(slot) == isStatic && packedEntryVid(entry) == vid && MAC_IS_EQUAL(entry->address, *address))
+            return slot;
+        pos = macHashNext(pos);
+    }
+    return MAC_INDEX_NIL;
+}
+
+/**
+ * @brief macIndexInsert 插入(MAC,VID)条目，已存在则返回已有的slot。新条目只设置了地址，VID和有效标志
+ * @param isNew 是否是新插入的条目
+ * @return 条目的slot，没有空闲slot或者有条目的VID个数已达到VID_HEAD_MAX时返回MAC_INDEX_NIL
+ */
+static MSD_U16 macIndexInsert(AtuModuleInitType* atu, const MSD_ETHERADDR* address, MSD_U16 vid, MSD_BOOL isStatic, OUT MSD_BOOL* isNew)
+{
+    *isNew = MSD_FALSE;
+    if (vid > MAX_FID_VALUE)
+        return MAC_INDEX_NIL;
+    MSD_U32 pos = macHashHome(address, vid);
+    MSD_U16 slot;
+    while ((slot = atu->macHash[pos]) != MAC_INDEX_NIL) {
+        PackedMacEntry* entry = macSlotEntry(atu, slot);
+        if (MAC_SLOT_IS_STATIC(slot) == isStatic && packedEntryVid(entry) == vid && MAC_IS_EQUAL(entry->address, *address))
+            return slot;
+        pos = macHashNext(pos);
+    }
+    MSD_U32 headPos = vidHeadPos(atu, vid);
+    MSD_U16 head = atu->vidHead[headPos];
+    if (head == MAC_INDEX_NIL && atu->allMacEntryVidSize >= VID_HEAD_MAX)
+        return MAC_INDEX_NIL;
+    //从空闲链表取slot
+    MSD_U16* freeHead = isStatic ? &atu->staticFreeHead : &atu->autoFreeHead;
+    slot = *freeHead;
+    if (slot == MAC_INDEX_NIL)
+        return MAC_INDEX_NIL;
+    *freeHead = atu->slotNext[slot];
+    atu->macHash[pos] = slot;
+
+    PackedMacEntry* entry = macSlotEntry(atu, slot);
+    entry->address = *address;
+    packedEntrySetVidPortVec(entry, vid, 0);
+    entry->ageAndFlag = 0;
+    SET_BIT(entry->ageAndFlag, 2);
+    *isNew = MSD_TRUE;
+
+    //加入VID链表头
+    atu->slotNext[slot] = head;
+    atu->vidHead[headPos] = slot;
+    if (head == MAC_INDEX_NIL)
+        atu->allMacEntryVidSize++;
+
+    if (isStatic)
+        atu->staticEntryCount++;
+    else
+        atu->autoEntryCount++;
+    return slot;
+}
+
+/**
+ * @brief macIndexUnlink 删除有效的slot，放回空闲链表
+ * @param prev slot在VID链表中的上一个slot，slot是链表头时为MAC_INDEX_NIL
+ * @param changeType 记录到变更记录中的类型(ATU_CHANGE_DELETE或者ATU_CHANGE_AGE_OUT)
+ */
+static void macIndexUnlink(AtuModuleInitType* atu, MSD_U16 slot, MSD_U16 prev, AtuChangeType changeType)
+{
+    atuJournalAppend(atu, slot, changeType);
+    PackedMacEntry* entry = macSlotEntry(atu, slot);
+    MSD_U16 vid = packedEntryVid(entry);
+    MSD_U32 hole = macHashHome(&entry->address, vid);
+    while (atu->macHash[hole] != slot) {
+        hole = macHashNext(hole);
+    }
+    //线性探测的后移删除，后续探测链上的条目前移填补空位，不需要墓碑标记
+    MSD_U32 pos = hole;
+    while (1) {
+        pos = macHashNext(pos);
+        MSD_U16 moved = atu->macHash[pos];
+        if (moved == MAC_INDEX_NIL)
+            break;
+        PackedMacEntry* movedEntry = macSlotEntry(atu, moved);
+        MSD_U32 home = macHashHome(&movedEntry->address, packedEntryVid(movedEntry));
+        if (macHashDistance(home, pos) >= macHashDistance(hole, pos)) {//空位在该条目的探测路径上
+            atu->macHash[hole] = moved;
+            hole = pos;
         }
     }
-    return MSD_FALSE;
+    atu->macHash[hole] = MAC_INDEX_NIL;
+
+    //从VID链表中删除
+    MSD_U16 next = atu->slotNext[slot];
+    if (prev != MAC_INDEX_NIL) {
+        atu->slotNext[prev] = next;
+    }
+    else {
+        MSD_U32 headPos = vidHeadPos(atu, vid);
+        if (next != MAC_INDEX_NIL)
+            atu->vidHead[headPos] = next;
+        else
+            vidHeadRemoveAt(atu, headPos);
+    }
+
+    CLEAR_BIT(entry->ageAndFlag, 2);//not Valid
+    if (MAC_SLOT_IS_STATIC(slot)) {
+        atu->slotNext[slot] = atu->staticFreeHead;
+        atu->staticFreeHead = slot;
+        atu->staticEntryCount--;
+    }
+    else {
+        atu->slotNext[slot] = atu->autoFreeHead;
+        atu->autoFreeHead = slot;
+        atu->autoEntryCount--;
+    }
 }
 
 /**
- * @brief deviceAtuModuleSetMacEntryVidFlagAndSize 设置对应的VID条目为flag设置的标志，如果flag为真，即将其对应的VID条目标志设置为真。
- * @param devNum 设备编号
- * @param vidNum vid
- * @param flag 将VID条目设置为是否对应MAC条目的标志，如果设置为MSD_FALSE，告知VLAN条目操作可以删除对应的VTU
- * @return
- *   MSD_TRUE:当flag设置为TRUE，返回MSD_TRUE,或者vid对应的mac条目标志可以设置为FLASE时
- *   MSD_false:当vid对应的mac条目标志不能设置为FLASE时
+ * @brief macIndexRemove 删除有效的slot。VID链表是单向链表，从链表头查找上一个slot
+ * @param changeType 记录到变更记录中的类型(ATU_CHANGE_DELETE或者ATU_CHANGE_AGE_OUT)
  */
-MSD_BOOL deviceAtuModuleSetMacEntryVidFlagAndSize(MSD_U8 devNum, MSD_U16 vidNum, MSD_BOOL flag)
+static void macIndexRemove(AtuModuleInitType* atu, MSD_U16 slot, AtuChangeType changeType)
 {
-	MSD_U16 arrayIndex = vidNum / 32;//在数组下标的位置
-	MSD_U8 bitIndex = vidNum % 32;//在某个数下的坐标位置
-	MSD_BOOL vidFlag = IS_BIT_SET(s_atuModuleInitType[devNum].vidArrayFlag[arrayIndex], bitIndex);
-    if (flag == vidFlag)//要设置的vid标志和之前的一样，不做任何操作
-        return MSD_TRUE;
-    if (flag) {//如果设置为TRUE.
-        s_atuModuleInitType[devNum].allMacEntryVidSize++;
-        SET_BIT(s_atuModuleInitType[devNum].vidArrayFlag[arrayIndex], bitIndex);
-        //s_atuModuleInitType[devNum].allMacEntryVid[vidNum] = MSD_TRUE;
-        return MSD_TRUE;//
-    }
-    else {//设置为FLASE
-        //判断是否可以设置为FALSE
-        if (!vlanNumHasMacEntry(devNum, vidNum)) {//如果不存在对应的VID的相应MAC条目，则可以将其对应的VTU条目标志设置为FALSE.VLAN操作可以VTU条目删除
-            s_atuModuleInitType[devNum].allMacEntryVidSize--;
-            CLEAR_BIT(s_atuModuleInitType[devNum].vidArrayFlag[arrayIndex], bitIndex);
-            //s_atuModuleInitType[devNum].allMacEntryVid[vidNum] = MSD_FALSE;
-            return MSD_TRUE;
+    MSD_U16 prev = MAC_INDEX_NIL;
+    for (MSD_U16 cur = vidHeadOf(atu, packedEntryVid(macSlotEntry(atu, slot))); cur != slot; cur = atu->slotNext[cur]) {
+        prev = cur;
+    }
+    macIndexUnlink(atu, slot, prev, changeType);
+}
+
+/**
+ * 批量删除时判断条目是否需要删除
+ */
+typedef MSD_BOOL (*MacSlotFilter)(PackedMacEntry* entry, MSD_U16 slot, MSD_U32 arg);
+
+/**
+ * @brief macIndexRemoveIf 沿VID链表删除filter返回MSD_TRUE的条目，每个链表只遍历一次
+ * @param vid 只处理该VID的条目，UNVALID_VID处理所有VID
+ * @param arg 传给filter的参数
+ * @param changeType 记录到变更记录中的类型
+ */
+static void macIndexRemoveIf(AtuModuleInitType* atu, int vid, MacSlotFilter filter, MSD_U32 arg, AtuChangeType changeType)
+{
+    MSD_U32 first = vid == UNVALID_VID ? 0 : (MSD_U32)vid;
+    MSD_U32 last = vid == UNVALID_VID ? MAX_FID_VALUE : (MSD_U32)vid;
+    for (MSD_U32 v = first; v <= last && atu->allMacEntryVidSize != 0; ++v) {
+        MSD_U16 prev = MAC_INDEX_NIL;
+        MSD_U16 slot = vidHeadOf(atu, (MSD_U16)v);
+        while (slot != MAC_INDEX_NIL) {
+            MSD_U16 next = atu->slotNext[slot];
+            if (filter(macSlotEntry(atu, slot), slot, arg))
+                macIndexUnlink(atu, slot, prev, changeType);
+            else
+                prev = slot;
+            slot = next;
         }
-        return MSD_FALSE;//不能设置为FALSE.
     }
 }
 
 /**
- * @brief deviceAtuModuleClearMacEntryVidFlag
- * 将所有的VID条目标志设置为FALSE.即VLAN操作可以清空所有的VLAN条目，否则VLAN操作不能执行删除所有的VLAN条目
- * @param devNum
+ * @brief macSlotIsType 是否是arg指定的静态(MSD_TRUE)或者动态(MSD_FALSE)条目
  */
-static void deviceAtuModuleClearMacEntryVidFlag(MSD_U8 devNum)
+static MSD_BOOL macSlotIsType(PackedMacEntry* entry, MSD_U16 slot, MSD_U32 arg)
 {
-    for(int i = 0; i < VID_FLAG_ARRAY_SIZE; ++i){
-    	s_atuModuleInitType[devNum].vidArrayFlag[i] = 0;
+    (void)entry;
+    return MAC_SLOT_IS_STATIC(slot) == (MSD_BOOL)arg ? MSD_TRUE : MSD_FALSE;
+}
+
+/**
+ * @brief macSlotIsUnmarked 是否是arg指定类型的没有标记的条目，有标记的条目清除标记
+ */
+static MSD_BOOL macSlotIsUnmarked(PackedMacEntry* entry, MSD_U16 slot, MSD_U32 arg)
+{
+    if (!macSlotIsType(entry, slot, arg))
+        return MSD_FALSE;
+    if (IS_BIT_SET(entry->ageAndFlag, MAC_ENTRY_MARK_BIT)) {
+        CLEAR_BIT(entry->ageAndFlag, MAC_ENTRY_MARK_BIT);
+        return MSD_FALSE;
     }
-    s_atuModuleInitType[devNum].allMacEntryVidSize = 0;
+    return MSD_TRUE;
+}
+
+/**
+ * @brief macIndexClear 删除所有的静态条目或者动态条目
+ */
+static void macIndexClear(AtuModuleInitType* atu, MSD_BOOL isStatic)
+{
+    MSD_U32 count = isStatic ? atu->staticEntryCount : atu->autoEntryCount;
+    if (count == 0)
+        return;
+    if (count >= ATU_CHANGE_JOURNAL_SIZE && (isStatic ? atu->autoEntryCount : atu->staticEntryCount) == 0) {
+        //另一类条目为空，直接全部清空。删除的条目超过了变更记录的条数，不再逐条记录，读取变更时需要重新同步
+        macIndexInit(atu);
+        atu->generation += count;
+        return;
+    }
+    macIndexRemoveIf(atu, UNVALID_VID, macSlotIsType, (MSD_U32)isStatic, ATU_CHANGE_DELETE);
 }
 
+/**
+ * @brief macIndexSweep 删除刷新时没有被标记(MAC_ENTRY_MARK_BIT)的静态条目或者动态条目，并清除标记
+ * @param changeType 记录到变更记录中的类型
+ */
+static void macIndexSweep(AtuModuleInitType* atu, MSD_BOOL isStatic, AtuChangeType changeType)
+{
+    macIndexRemoveIf(atu, UNVALID_VID, macSlotIsUnmarked, (MSD_U32)isStatic, changeType);
+}
 
-static inline int searchFid(void *listFidParam, void *findFidParam)
+/**
+ * @brief macIndexClearMarks 刷新读取不完整时不删除条目，只清除静态条目或者动态条目的标记
+ */
+static void macIndexClearMarks(AtuModuleInitType* atu, MSD_BOOL isStatic)
 {
-    MSD_U16 listFid = (MSD_U16)listFidParam;//地址直接转换为数字
-    MSD_U16 findFid = (MSD_U16)findFidParam;
-    return listFid == findFid;
+    MSD_U32 first = isStatic ? SHADOW_AUTO_ENTRIES : 0;
+    MSD_U32 last = isStatic ? MAC_SLOT_COUNT : SHADOW_AUTO_ENTRIES;
+    for (MSD_U32 slot = first; slot < last; ++slot) {
+        CLEAR_BIT(macSlotEntry(atu, (MSD_U16)slot)->ageAndFlag, MAC_ENTRY_MARK_BIT);
+    }
+}
+
+/**
+ * @brief vlanNumHasMacEntry 判断是否具有指定的VID的MAC条目，用于在VLAN执行删除操作时是否删除指定VLAN的目的
+ * 注：如果VLAN执行删除VID条目时，如果还存在对应的MAC条目，则不执行VLAN条目的删除操作
+ * @param devNum 设备编号
+ * @param vidNum VID编号
+ * @return
+ */
+static MSD_BOOL vlanNumHasMacEntry(MSD_U8 devNum, MSD_U16 vidNum) {
+    if (vidNum > MAX_FID_VALUE)
+        return MSD_FALSE;
+    return vidHeadOf(&s_atuModuleInitType[devNum], vidNum) != MAC_INDEX_NIL ? MSD_TRUE : MSD_FALSE;
+}
+
+/**
+ * @brief deviceAtuModuleSetMacEntryVidFlagAndSize VID是否有MAC条目由内存中该VID的条目链表决定，添加和删除条目时自动更新，
+ * 这里只返回VID条目标志能否设置为flag
+ * @param devNum 设备编号
+ * @param vidNum vid
+ * @param flag 将VID条目设置为是否对应MAC条目的标志，如果设置为MSD_FALSE，告知VLAN条目操作可以删除对应的VTU
+ * @return
+ *   MSD_TRUE:当flag设置为TRUE，返回MSD_TRUE,或者vid不存在对应的mac条目时
+ *   MSD_false:当vid还存在对应的mac条目时
+ */
+MSD_BOOL deviceAtuModuleSetMacEntryVidFlagAndSize(MSD_U8 devNum, MSD_U16 vidNum, MSD_BOOL flag)
+{
+    if (flag)
+        return MSD_TRUE;
+    return vlanNumHasMacEntry(devNum, vidNum) ? MSD_FALSE : MSD_TRUE;
 }
 
 static void initialFidArray(void)
 {
     for (MSD_U8 j = 0; j < MAX_SOHO_DEVICES; ++j) {
-    	s_fids[j] = listCreate();
-    	listSetMatchMethod(s_fids[j],searchFid);//find id
+        fidSetClear(&s_fids[j]);
     }
 }
 
 MSD_STATUS setFidValue(MSD_U8 devNum, IN MSD_U16 fid)
 {
-
-//	MSD_U16 *param = (MSD_U16 *)malloc(sizeof(MSD_U16));
-//	*param = fid;
-	if((listSearchKey(s_fids[devNum],(void *)fid)) == NULL){//不存在fid值，add
-		if((listAddNodeHead(s_fids[devNum],(void *)fid)) == NULL){
-			return MSD_FAIL;
-		}
-	}
+    if (devNum >= MAX_SOHO_DEVICES || fid > MAX_FID_VALUE)
+        return MSD_BAD_PARAM;
+    fidSetAdd(&s_fids[devNum], fid);
     return MSD_OK;
 }
 
@@ -156,17 +557,14 @@ static MSD_STATUS unsetFidValue(MSD_U8 devNum, IN MSD_U16 fid)
 {
     if (fid == 0 || fid == 1)//FID 0和FID 1始终要查询
         return MSD_OK;
-    listNode *fidNode = listSearchKey(s_fids[devNum],(void *)fid);//地址直接存储MSD_U16
-    if(fidNode != NULL){//如果存在，则删除
-    	listDelNode(s_fids[devNum],fidNode);
-    }
+    fidSetRemove(&s_fids[devNum], fid);
     return MSD_OK;
 }
 
 static MSD_STATUS clearFidValues(MSD_U8 devNum)
 {
     //FID 0 和 1 做特殊处理，不清空
-    listEmpty(s_fids[devNum]);
+    fidSetClear(&s_fids[devNum]);
     setFidValue(devNum,0);
     setFidValue(devNum,1);
     return MSD_OK;
@@ -174,7 +572,8 @@ static MSD_STATUS clearFidValues(MSD_U8 devNum)
 
 void releaseAllFidValues(MSD_U8 devNum)
 {
-	listRelease(s_fids[devNum]);
+    if (devNum < MAX_SOHO_DEVICES)
+        fidSetClear(&s_fids[devNum]);
 }
 
 MSD_STATUS deviceAtuModuleGetAllFidHasValues(IN MSD_U8 devNum, INOUT MSD_U16 fidArr[], IN int fidSize, OUT int* fidCount)
@@ -189,14 +588,11 @@ MSD_STATUS deviceAtuModuleGetAllFidHasValues(IN MSD_U8 devNum, INOUT MSD_U16 fid
         return MSD_BAD_PARAM;
     msdMemSet(fidArr, 0, fidSize * sizeof(MSD_U16));
 
-    listIter * liter = listGetIterator(s_fids[devNum],AL_START_HEAD);
-	listNode *node = NULL;
-	int index = 0;
-	while ((node = listNext(liter)) != NULL) {
-		fidArr[index++] = (MSD_U16)node->value;
-	}
-	*fidCount = index;
-	listReleaseIterator(liter);
+    int index = 0;
+    for (int fid = fidSetNext(&s_fids[devNum], 0); fid >= 0 && index < fidSize; fid = fidSetNext(&s_fids[devNum], fid + 1)) {
+        fidArr[index++] = (MSD_U16)fid;
+    }
+    *fidCount = index;
     return MSD_OK;
 }
 
@@ -219,6 +615,7 @@ static MSD_STATUS getFirstAtuEntryInFid(IN MSD_U8 devNum, IN MSD_U32 fid, OUT MS
         start_atu_entry_mac.arEther[i] = 0xff;
     }
     MSD_STATUS ret = msdFdbEntryNextGet(devNum, &start_atu_entry_mac, fid, resultEntry);
+    s_atuModuleInitType[devNum].getNextOps++;
     return ret;
 }
 
@@ -233,6 +630,7 @@ static MSD_STATUS deviceMacEntryGetListInFid(IN MSD_U8 devNum, IN MSD_U32 fid, O
     while (1) {
         //获取下一个条目
         ret = msdFdbEntryNextGet(devNum, &resultEntry.macAddr, fid, &resultEntry);
+        s_atuModuleInitType[devNum].getNextOps++;
         if(ret != MSD_OK) {
             if (ret == MSD_NO_SUCH) {//无更多条目
                 ret = MSD_OK;
@@ -248,6 +646,67 @@ static MSD_STATUS deviceMacEntryGetListInFid(IN MSD_U8 devNum, IN MSD_U32 fid, O
     return ret;
 }
 
+/**
+ * @brief deviceMacEntryGetListByRmu 通过RMU Dump ATU帧读取整个ATU表，只保留fid(ALL_FID_VALUE为s_fids中的所有fid)的条目
+ * 每帧最多返回MSD_RMU_MAX_ATUS个条目，代替逐条调用msdFdbEntryNextGet的SMI访问
+ * @return
+ * MSD_OK  - on success
+ * MSD_NOT_SUPPORTED - 没有使用RMU访问或dump缓冲区申请失败，未读取任何条目，调用者应使用SMI逐条读取
+ * MSD_NO_SPACE - atuEntries空间不足
+ */
+static MSD_STATUS deviceMacEntryGetListByRmu(IN MSD_U8 devNum, IN int fid, OUT int* atuEntryCount, IN AtuEntryType entryType, OUT MSD_ATU_ENTRY* atuEntries, IN int atuEntryMaxSize)
+{
+    MSD_QD_DEV* dev = sohoDevGet(devNum);
+    if (dev == NULL || !IS_RMU_SUPPORTED(dev) || dev->SwitchDevObj.RMUObj.grmuAtuDump == NULL)
+        return MSD_NOT_SUPPORTED;//先判断RMU，SMI访问时不申请内存
+    //一次申请条目和指针数组，避免占用调用任务的栈空间
+    MSD_ATU_ENTRY* dumpEntries = (MSD_ATU_ENTRY*)pvPortMalloc(MSD_RMU_MAX_ATUS * (sizeof(MSD_ATU_ENTRY) + sizeof(MSD_ATU_ENTRY*)));
+    if (dumpEntries == NULL) return MSD_NOT_SUPPORTED;//堆不足时退化为SMI逐条读取
+    MSD_ATU_ENTRY** dumpPtrs = (MSD_ATU_ENTRY**)(void*)&dumpEntries[MSD_RMU_MAX_ATUS];
+    for (MSD_U32 i = 0; i < MSD_RMU_MAX_ATUS; ++i) {
+        dumpPtrs[i] = &dumpEntries[i];
+    }
+    MSD_STATUS ret = MSD_OK;
+    MSD_U32 startAddr = 0;//从头开始dump，返回0代表已dump完整个ATU表
+    do {
+        MSD_U32 numOfEntry = 0;
+        ret = msdRMUAtuEntryDump(devNum, &startAddr, &numOfEntry, dumpPtrs);
+        s_atuModuleInitType[devNum].dumpFrames++;
+        if (ret != MSD_OK) break;
+        for (MSD_U32 i = 0; i < numOfEntry && ret == MSD_OK; ++i) {
+            if (fid == ALL_FID_VALUE ? !fidSetHas(&s_fids[devNum], dumpEntries[i].fid) : (dumpEntries[i].fid != fid))
+                continue;//不是需要的fid
+            if ((*atuEntryCount) == atuEntryMaxSize) {
+                ret = MSD_NO_SPACE;
+                break;
+            }
+            deviceMacEntryAddToList(entryType, &dumpEntries[i], atuEntries, atuEntryCount);
+        }
+    } while (ret == MSD_OK && startAddr != 0);
+    vPortFree(dumpEntries);
+    return ret;
+}
+
+/**
+ * @brief deviceMacEntryGetListInFids 获取fid的ATU条目，fid为ALL_FID_VALUE时获取s_fids中所有FID的条目
+ * 使用RMU时整表dump一次，否则逐个FID通过SMI读取
+ */
+static MSD_STATUS deviceMacEntryGetListInFids(IN MSD_U8 devNum, IN int fid, OUT int* atuEntryCount, IN AtuEntryType entryType, OUT MSD_ATU_ENTRY* atuEntries, IN int atuEntryMaxSize)
+{
+    if (fid == ALL_FID_VALUE && fidSetNext(&s_fids[devNum], 0) < 0) return MSD_OK;
+    MSD_STATUS ret = deviceMacEntryGetListByRmu(devNum, fid, atuEntryCount, entryType, atuEntries, atuEntryMaxSize);
+    if (ret != MSD_NOT_SUPPORTED) return ret;
+    if (fid != ALL_FID_VALUE)
+        return deviceMacEntryGetListInFid(devNum, (MSD_U32)fid, atuEntryCount, entryType, atuEntries, atuEntryMaxSize);
+    ret = MSD_OK;
+    for (int i = fidSetNext(&s_fids[devNum], 0); i >= 0; i = fidSetNext(&s_fids[devNum], i + 1)) {
+        ret = deviceMacEntryGetListInFid(devNum, (MSD_U32)i, atuEntryCount, entryType, atuEntries, atuEntryMaxSize);
+        if (ret != MSD_OK)
+            break;
+    }
+    return ret;
+}
+
 MSD_STATUS deviceMacModuleInitialMacInfo(IN MSD_U8 devNum)
 {
     MSD_STATUS status = deviceAtuModuleSetUseMacEntryTypeToConfiguration(devNum, USE_MAC_ENTRY_TYPE_STATIC_AND_DYNAMIC);//
@@ -318,20 +777,12 @@ MSD_STATUS deviceAtuModuleInitial(void)
     for (MSD_U8 i = 0; i < MAX_SOHO_DEVICES; ++i) {
 
         msdMemSet(&s_atuConfiguration[i], 0, sizeof(AtuConfiguration));
-        s_atuModuleInitType[i].autoEntryCount = 0;
-        s_atuModuleInitType[i].staticEntryCount = 0;
-        s_atuModuleInitType[i].allMacEntryVidSize = 0;
         s_atuModuleInitType[i].fidNum = ALL_FID_VALUE;
-        for(int i = 0; i < VID_FLAG_ARRAY_SIZE; ++i){
-           	s_atuModuleInitType[i].vidArrayFlag[i] = 0;
-        }
         //set_fid_value(i, ALL_FID_VALUE);//默认检测该fid的值（）
-        for (int j = 0; j < MAX_AUTO_ATU_ENTRIES; ++j) {
-        	CLEAR_BIT(s_atuModuleInitType[i].autoEntry[j].ageAndFlag, 2);//设置为无效状态
-        }
-        for (int j = 0; j < MAX_STATIC_ATU_ENTRIES; ++j) {
-        	CLEAR_BIT(s_atuModuleInitType[i].staticEntry[j].ageAndFlag, 2);//设置为无效状态
-        }
+        AtuModuleInitType* atu = &s_atuModuleInitType[i];
+        MSD_U32 count = atu->staticEntryCount + atu->autoEntryCount;
+        macIndexInit(atu);//所有条目设置为无效状态
+        atu->generation += count;//和批量清空一样不逐条记录，读取变更时需要重新同步
         //默认需要访问FID 1和FID 0的MAC条目
         setFidValue(i, 1);
         setFidValue(i, 0);
@@ -399,39 +850,51 @@ MSD_STATUS deviceAtuModuleGetPortDefaultFid(MSD_U8 devNum, IN MSD_U8 portNum, OU
 #define FIR_GLOBAL2_DEV_ADDRESS   0x1c
 
 /**
- * @brief checkStaticEntryIsExist 根据提供的VID和MAC地址判断MAC条目是否存在于对应的ATU条目中
+ * @brief setEntryToModuleIndex 添加或者替换指定类型的MAC条目，新条目和端口改变的条目会加入变更记录
  * @param devNum 设备编号
- * @param address 查询的MAC地址
- * @param vid 查询的VID
- * @param index如果找到，则存储下标，否则存储-1
- * @return 如果找到返回MSD_TRUE,否则返回MSD_FALSE
+ * @param address MAC地址
+ * @param vid 对应的VID值
+ * @param portVec 出口vec
+ * @param isStatic 是否是静态条目
+ * @param age 动态条目的age(1-7)
+ * @return 条目的slot，没有空间时返回MAC_INDEX_NIL
  */
-static MSD_BOOL checkStaticEntryIsExist(MSD_U8 devNum, IN MSD_ETHERADDR address, IN MSD_U32 vid, MSD_BOOL isStatic, int* index)
+static MSD_U16 setEntryToModuleIndex(IN MSD_U8 devNum, IN MSD_ETHERADDR address, IN MSD_U16 vid, MSD_U32 portVec, MSD_BOOL isStatic, int age)
 {
-    *index = -1;
-    if(isStatic){
-        for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
-            //if (s_atuModuleInitType[devNum].staticEntry[i].isVaild) {
-        	 if(IS_BIT_SET(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2)){
-                if (s_atuModuleInitType[devNum].staticEntry[i].vid == vid && MAC_IS_EQUAL(address, s_atuModuleInitType[devNum].staticEntry[i].address)) {
-                    *index = i;
-                    break;
-                }
-            }
-        }
-    }else{
-        for (int i = 0; i < MAX_AUTO_ATU_ENTRIES; ++i) {
-        	if(IS_BIT_SET(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2)){
-                if (s_atuModuleInitType[devNum].autoEntry[i].vid == vid && MAC_IS_EQUAL(address, s_atuModuleInitType[devNum].autoEntry[i].address)) {
-                    *index = i;
-                    break;
-                }
-            }
-        }
+#ifdef ATU_SHADOW_STATIC_ONLY
+    if (!isStatic)//动态条目不保存在内存中
+        return MAC_INDEX_NIL;
+#endif
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_BOOL isNew;
+    MSD_U16 slot = macIndexInsert(atu, &address, vid, isStatic, &isNew);//已存在则替换
+    if (slot == MAC_INDEX_NIL) {
+        MSD_DBG_ERROR(("addEntryToModuleIndex failed, no free %s mac entry!\n", isStatic ? "static" : "auto"));
+        if (!isStatic)
+            atu->autoDropCount++;
+        return MAC_INDEX_NIL;
+    }
+    PackedMacEntry* entry = macSlotEntry(atu, slot);
+    MSD_U32 oldPortVec = packedEntryPortVec(entry);
+    entry->ageAndFlag = 0;
+    if (isStatic) {
+        SET_BIT(entry->ageAndFlag, 0);
     }
-    if (*index == -1)
-        return MSD_FALSE;
-    return MSD_TRUE;
+    if (IS_UNICAST_MAC(address.arEther)) {//单播
+        SET_BIT(entry->ageAndFlag, 1);
+    }
+    SET_BIT(entry->ageAndFlag, 2);
+    if (!isStatic) {
+        entry->ageAndFlag |= ((age & 0x7) << 3);//设置age
+    }
+    packedEntrySetVidPortVec(entry, vid, portVec);
+    if (isNew) {
+        atuJournalAppend(atu, slot, ATU_CHANGE_ADD);
+    }
+    else if (oldPortVec != packedEntryPortVec(entry)) {//只有age改变时不记录
+        atuJournalAppend(atu, slot, ATU_CHANGE_MOVE);
+    }
+    return slot;
 }
 
 /**
@@ -444,72 +907,12 @@ static MSD_BOOL checkStaticEntryIsExist(MSD_U8 devNum, IN MSD_ETHERADDR address,
  */
 static void addEntryToModuleIndex(IN MSD_U8 devNum, IN MSD_ETHERADDR address, IN MSD_U16 vid, MSD_U32 portVec,int entryState)
 {
-    int index = -1;
     MSD_BOOL isUnicast = IS_UNICAST_MAC(address.arEther);
     MSD_BOOL isStatic = MSD_TRUE;
     if(entryState > 0 && entryState <= 7 && isUnicast){//如果为单播地址，并且条目状态小于7大于0，则为动态条目
         isStatic = MSD_FALSE;
     }
-    do {
-        MSD_BOOL isExist = checkStaticEntryIsExist(devNum, address, vid,isStatic, &index);
-        if (isExist)//找到对应的静态或者动态MAC条目,替换
-            break;
-        if(isStatic){
-            for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
-                //if (!s_atuModuleInitType[devNum].staticEntry[i].isVaild) {//序号没有被使用,使用该序号
-            	if(!IS_BIT_SET(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2)){
-                    index = i;
-                    break;
-                }
-            }
-        }else{
-            for(int i = 0; i < MAX_AUTO_ATU_ENTRIES; ++i) {
-                //if (!s_atuModuleInitType[devNum].autoEntry[i].isVaild) {//序号没有被使用,使用该序号
-            	if(!IS_BIT_SET(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2)){
-                    index = i;
-                    break;
-                }
-            }
-        }
-    } while (0);
-    if (index != -1) {
-        MSD_BOOL isMul = IS_MULTICAST_MAC(address.arEther);
-        if(isStatic){ //static entry
-            for (unsigned i = 0; i < MSD_ETHERNET_HEADER_SIZE; ++i) {
-                s_atuModuleInitType[devNum].staticEntry[index].address.arEther[i] = address.arEther[i];
-            }
-//            s_atuModuleInitType[devNum].staticEntry[index].isStatic = MSD_TRUE;
-//            s_atuModuleInitType[devNum].staticEntry[index].isUnicast = !isMul;
-//            s_atuModuleInitType[devNum].staticEntry[index].isVaild = MSD_TRUE;
-            SET_BIT(s_atuModuleInitType[devNum].staticEntry[index].ageAndFlag,0);
-            if(isMul){//多播
-            	CLEAR_BIT(s_atuModuleInitType[devNum].staticEntry[index].ageAndFlag,1);
-            }else{//单播
-            	SET_BIT(s_atuModuleInitType[devNum].staticEntry[index].ageAndFlag,1);
-            }
-            SET_BIT(s_atuModuleInitType[devNum].staticEntry[index].ageAndFlag,2);
-            s_atuModuleInitType[devNum].staticEntry[index].portVec = portVec;
-            s_atuModuleInitType[devNum].staticEntry[index].vid = vid;
-            //s_atuModuleInitType[devNum].staticEntry[index].age = 0xfff;//静态条目不用管
-            s_atuModuleInitType[devNum].staticEntryCount++;
-        }else{//auto entry
-            for (unsigned i = 0; i < MSD_ETHERNET_HEADER_SIZE; ++i) {
-                s_atuModuleInitType[devNum].autoEntry[index].address.arEther[i] = address.arEther[i];
-            }
-            CLEAR_BIT(s_atuModuleInitType[devNum].autoEntry[index].ageAndFlag,0);
-			if(isMul){//多播
-				CLEAR_BIT(s_atuModuleInitType[devNum].autoEntry[index].ageAndFlag,1);
-			}else{//单播
-				SET_BIT(s_atuModuleInitType[devNum].autoEntry[index].ageAndFlag,1);
-			}
-			SET_BIT(s_atuModuleInitType[devNum].staticEntry[index].ageAndFlag,2);
-            s_atuModuleInitType[devNum].autoEntry[index].portVec = portVec;
-            s_atuModuleInitType[devNum].autoEntry[index].vid = vid;
-            s_atuModuleInitType[devNum].autoEntry[index].ageAndFlag |= ((entryState & 0x7) << 3);//设置age
-//            s_atuModuleInitType[devNum].autoEntry[index].age = entryState & 0x7;
-            s_atuModuleInitType[devNum].autoEntryCount++;
-        }
-    }
+    setEntryToModuleIndex(devNum, address, vid, portVec, isStatic, entryState);
 }
 
 /**
@@ -527,31 +930,12 @@ static void removeStaticOrAutoMacEntryToModuleIndex(IN MSD_U8 devNum, IN MSD_ETH
     if(entryState > 0 && entryState <= 7 && isUnicast){//如果为单播地址，并且条目状态小于7大于0，则为动态条目
         isStatic = MSD_FALSE;
     }
-    if (isStatic) {//静态条目
-        for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
-//            if (s_atuModuleInitType[devNum].staticEntry[i].isVaild) {
-        	  if(IS_BIT_SET(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2)){
-                if (s_atuModuleInitType[devNum].staticEntry[i].vid == vid && MAC_IS_EQUAL(address, s_atuModuleInitType[devNum].staticEntry[i].address)) {
-//                    s_atuModuleInitType[devNum].staticEntry[i].isVaild = MSD_FALSE;
-                	CLEAR_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2);//not Valid
-                    s_atuModuleInitType[devNum].staticEntryCount--;
-                    break;
-                }
-            }
-        }
-    }
-    else {
-        for (int i = 0; i < MAX_AUTO_ATU_ENTRIES; ++i) {
-//            if (s_atuModuleInitType[devNum].autoEntry[i].isVaild) {
-        	  if(IS_BIT_SET(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2)){
-                if (s_atuModuleInitType[devNum].autoEntry[i].vid == vid && MAC_IS_EQUAL(address, s_atuModuleInitType[devNum].autoEntry[i].address)) {
-//                    s_atuModuleInitType[devNum].autoEntry[i].isVaild = MSD_FALSE;
-                	CLEAR_BIT(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2);////not Valid
-                    s_atuModuleInitType[devNum].autoEntryCount--;
-                    break;
-                }
-            }
-        }
+    if (vid > MAX_FID_VALUE)
+        return;
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_U16 slot = macIndexFind(atu, &address, (MSD_U16)vid, isStatic);
+    if (slot != MAC_INDEX_NIL) {
+        macIndexRemove(atu, slot, ATU_CHANGE_DELETE);
     }
 }
 
@@ -564,45 +948,17 @@ static void removeStaticOrAutoMacEntryToModuleIndex(IN MSD_U8 devNum, IN MSD_ETH
  */
 static void setStaticOrAutoMacEntryUnvalid(IN MSD_U8 devNum, IN int vid, MSD_BOOL isStatic)
 {
-    if (isStatic) {
-        if (vid == UNVALID_VID) {//设置所有VID的静态条目的无效
-            for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
-//                s_atuModuleInitType[devNum].staticEntry[i].isVaild = MSD_FALSE;
-            	CLEAR_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2);//not Valid
-            }
-            s_atuModuleInitType[devNum].staticEntryCount = 0;
-        }
-        else {//设置指定VID的所有静态条目为无效
-            for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
-                if ((s_atuModuleInitType[devNum].staticEntry[i].vid == vid) && IS_BIT_SET(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2)) {
-//                    s_atuModuleInitType[devNum].staticEntry[i].isVaild = MSD_FALSE;
-                	CLEAR_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2);////not Valid
-                    s_atuModuleInitType[devNum].staticEntryCount--;
-                }
-            }
-        }
-    }
-    else {
-        if (vid == UNVALID_VID) {//设置所有VID的atuo条目无效
-            for (int i = 0; i < MAX_AUTO_ATU_ENTRIES; ++i) {
-                //s_atuModuleInitType[devNum].autoEntry[i].isVaild = MSD_FALSE;
-                CLEAR_BIT(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2);////not Valid
-            }
-            s_atuModuleInitType[devNum].autoEntryCount = 0;
-        }
-        else {//设置指定VID的所有auto条目无效
-            for (int i = 0; i < MAX_AUTO_ATU_ENTRIES; ++i) {
-                if (s_atuModuleInitType[devNum].autoEntry[i].vid == vid && IS_BIT_SET(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2)) {
-//                    s_atuModuleInitType[devNum].autoEntry[i].isVaild = MSD_FALSE;
-                	CLEAR_BIT(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2);////not Valid
-                    s_atuModuleInitType[devNum].autoEntryCount--;
-                }
-            }
-        }
-    }
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    if (vid == UNVALID_VID) {//设置所有VID的静态条目或者动态条目无效
+        macIndexClear(atu, isStatic);
+        return;
+    }
+    if (vid < 0 || vid > MAX_FID_VALUE)
+        return;
+    //设置指定VID的条目为无效，只遍历该VID的链表
+    macIndexRemoveIf(atu, vid, macSlotIsType, (MSD_U32)isStatic, ATU_CHANGE_DELETE);
 }
 
-
 /**
  * @brief checkVlanEntry 检测是否需要添加或者修改相应的VTU条目
  * @param devNum 设备编号
@@ -650,8 +1006,6 @@ MSD_STATUS checkVlanEntry(IN MSD_U8 devNum, IN MSD_U16 vid, OUT MSD_BOOL* isAdd)
         }
 
     }
-    //设置VLAN有对应的MAC条目不能删除
-    deviceAtuModuleSetMacEntryVidFlagAndSize(devNum, vid, MSD_TRUE);
     return MSD_OK;
 }
 
@@ -730,7 +1084,6 @@ MSD_STATUS deviceAtuModuleDeleteEntry(MSD_U8 devNum, IN MSD_ETHERADDR macAddr)
         if (ret == MSD_OK) {
             MSD_U16 vid = fid;
             removeStaticOrAutoMacEntryToModuleIndex(devNum, macAddr, vid, atuEntry.entryState);
-            deviceAtuModuleSetMacEntryVidFlagAndSize(devNum, vid, MSD_FALSE);
             MSD_ATU_ENTRY resultEntry;
             ret = getFirstAtuEntryInFid(devNum, fid, &resultEntry);
             if (ret == MSD_NO_SUCH) {//删除之后该fid不存在对应的MAC条目，将fid删除
@@ -746,13 +1099,7 @@ MSD_STATUS deviceAtuModuleDeleteEntry(MSD_U8 devNum, IN MSD_ETHERADDR macAddr)
         }
     }
     else { //删除所有fid的条目
-        int fidSize = MAX_FID_VALUE + 1;
-        MSD_U16* fidArray = (MSD_U16*)calloc(fidSize, sizeof(MSD_U16));
-        if (fidArray == NULL) return MSD_NO_SPACE;
-        int fidCount = 0;
-        deviceAtuModuleGetAllFidHasValues(devNum, fidArray, fidSize, &fidCount);
-        for (int i = 0; i < fidCount; ++i) {
-            int fid = fidArray[i];
+        for (fid = fidSetNext(&s_fids[devNum], 0); fid >= 0; fid = fidSetNext(&s_fids[devNum], fid + 1)) {
             ret = msdFdbMacEntryFind(devNum,&macAddr,fid,&atuEntry,&isFound);
             if(ret != MSD_OK){
                 return ret;
@@ -771,9 +1118,9 @@ MSD_STATUS deviceAtuModuleDeleteEntry(MSD_U8 devNum, IN MSD_ETHERADDR macAddr)
                 }
                 MSD_ATU_ENTRY result_entry;
                 msdMemSet(&result_entry, 0, sizeof(MSD_ATU_ENTRY));
-                ret = getFirstAtuEntryInFid(devNum, fidArray[i], &result_entry);
+                ret = getFirstAtuEntryInFid(devNum, fid, &result_entry);
                 if (ret == MSD_NO_SUCH) {//删除之后该fid不存在对应的MAC条目，将fid删除
-                    unsetFidValue(devNum, fidArray[i]);
+                    unsetFidValue(devNum, fid);
                     ret = MSD_OK;
                 }
                 else if (ret != MSD_OK) {
@@ -785,8 +1132,6 @@ MSD_STATUS deviceAtuModuleDeleteEntry(MSD_U8 devNum, IN MSD_ETHERADDR macAddr)
             }
 
         }
-        vPortFree(fidArray);
-        fidArray = NULL;
     }
     return ret;
 }
@@ -844,63 +1189,131 @@ static inline void checkMacEntryIsStaticOrDynamicMac(IN MSD_ATU_ENTRY* atuEntry,
     }
 }
 
+#define  ATU_FLUSH_WALK_MAX_ENTRIES  8 //FID的条目不超过该值时直接遍历删除，比再读一次非静态条目计数(每个bin一次ATU操作)便宜
+static AtuFlushStats s_lastFlushStats[MAX_SOHO_DEVICES];//最近一次清空静态条目下发的ATU操作个数
+
 /**
  * @brief deviceMacEntryFlushStaticInFid 清空指定fid的所有静态条目
+ * 先读FID的条目计数：没有条目或者没有静态条目时跳过，否则遍历FID逐条删除静态条目。不支持计数时直接遍历
+ * 只有静态条目的FID也不使用FID flush(MSD_FLUSH_ALL)：读计数之后新学习的动态条目会被一起删除，
+ * 交换机也不支持只清空静态条目的flush
  * @param devNum
  * @param fid
+ * @param stats 累加下发的ATU操作个数
  * @return
  */
-static MSD_STATUS deviceMacEntryFlushStaticInFid(IN MSD_U8 devNum, IN MSD_U32 fid)
+static MSD_STATUS deviceMacEntryFlushStaticInFid(IN MSD_U8 devNum, IN MSD_U32 fid, INOUT AtuFlushStats* stats)
 {
-    //MSD_BOOL is_find_broadcast = MSD_FALSE;//需要判断广播地址是否在地址表中，如果存在，使用msdFdbEntryNextGet找到最后一个MAC地址时，再次调用时，会一直返回MSD_OK，个人认为这是API的一个BUG。这里根据地址相同来判断是否是最后一个地址
-
-    MSD_ATU_ENTRY resultEntry;
-    MSD_STATUS ret = getFirstAtuEntryInFid(devNum, fid, &resultEntry);
-    if (ret != MSD_OK) //数据库条目为空或者错误
-    {
-        if (ret == MSD_NO_SUCH) {
+    stats->fidCount++;
+    MSD_U32 totalCount = 0;
+    MSD_U32 nonStaticCount = 0;
+    MSD_STATUS ret = msdFdbEntryCountPerFidGet(devNum, fid, &totalCount);
+    if (ret == MSD_OK) {
+        stats->countReads++;
+        if (totalCount == 0) {//数据库条目为空
+            stats->skippedFids++;
             unsetFidValue(devNum, fid);
-            ret = MSD_OK;
+            return MSD_OK;
         }
+        if (totalCount > ATU_FLUSH_WALK_MAX_ENTRIES) {
+            ret = msdFdbEntryCountNonStaticPerFidGet(devNum, fid, &nonStaticCount);
+            if (ret == MSD_OK) {
+                stats->countReads++;
+                if (nonStaticCount == totalCount) {//没有静态条目
+                    stats->skippedFids++;
+                    return MSD_OK;
+                }
+            }
+            else if (ret != MSD_NOT_SUPPORTED) {
+                return ret;
+            }
+        }
+    }
+    else if (ret != MSD_NOT_SUPPORTED) {
         return ret;
     }
-    MSD_ETHERADDR  prevEntryMac;//保存上一条MAC地址条目的MAC地址，用于判断是否找到最后一个地址。
-    msdMemCpy(prevEntryMac.arEther, resultEntry.macAddr.arEther, MSD_ETHERNET_HEADER_SIZE);
-    MSD_DBG_INFO(("device_mac_entry_flush_static_in_fid MAC:%02x:%02x:%02x:%02x:%02x:%02x\n", resultEntry.macAddr.arEther[0], resultEntry.macAddr.arEther[1],
-                  resultEntry.macAddr.arEther[2], resultEntry.macAddr.arEther[3], resultEntry.macAddr.arEther[4], resultEntry.macAddr.arEther[5]));
+
+    //静态条目和动态条目混合，遍历逐条删除静态条目
+    stats->walkedFids++;
+    MSD_U32 remainCount = 0;//删除之后FID中剩余的条目个数
+    MSD_ATU_ENTRY resultEntry;
+    msdMemSet(&resultEntry, 0, sizeof(MSD_ATU_ENTRY));
+    for (size_t i = 0; i < MSD_ETHERNET_HEADER_SIZE; ++i) {//从广播条目开始查询
+        resultEntry.macAddr.arEther[i] = 0xff;
+    }
     AtuEntryStatus atuEntryStatus;
     while (1) {
-        //判断单播还是多播（arEther[0]为偶数则为单播，如果为奇数则为多播）
-        checkMacEntryIsStaticOrDynamicMac(&resultEntry,&atuEntryStatus);
+        ret = msdFdbEntryNextGet(devNum, &resultEntry.macAddr, fid, &resultEntry);
+        stats->getNextOps++;
+        if (ret != MSD_OK) {
+            if (ret == MSD_NO_SUCH) {//无更多条目
+                ret = MSD_OK;
+            }
+            break;
+        }
+        checkMacEntryIsStaticOrDynamicMac(&resultEntry, &atuEntryStatus);
         if (atuEntryStatus.entryType == ATU_ENTRY_TYPE_STATIC_MULTICAST ||
             atuEntryStatus.entryType == ATU_ENTRY_TYPE_STATIC_BROCASTCAST ||
             atuEntryStatus.entryType == ATU_ENTRY_TYPE_STATIC_UNICAST) {
             ret = msdFdbMacEntryDelete(devNum, &resultEntry.macAddr, fid);
             if (ret != MSD_OK)
                 break;
+            stats->deleteOps++;
+            stats->deletedEntries++;
         }
-        ret = msdFdbEntryNextGet(devNum, &resultEntry.macAddr, fid, &resultEntry);
-        MSD_DBG_INFO(("device_mac_entry_flush_static_in_fid MAC:%02x:%02x:%02x:%02x:%02x:%02x\n", resultEntry.macAddr.arEther[0], resultEntry.macAddr.arEther[1],
-                      resultEntry.macAddr.arEther[2], resultEntry.macAddr.arEther[3], resultEntry.macAddr.arEther[4], resultEntry.macAddr.arEther[5]));
-        if (ret != MSD_OK || MAC_IS_EQUAL(prevEntryMac, resultEntry.macAddr)) {
-            if (ret == MSD_NO_SUCH) {//fid中所有ATU项都删除成功
-                ret = MSD_OK;
-            }
+        else {
+            remainCount++;
+        }
+        if (MSD_IS_BROADCAST_MAC(resultEntry.macAddr)) {//广播条目是FID中的最后一个条目
             break;
         }
-        msdMemCpy(prevEntryMac.arEther, resultEntry.macAddr.arEther, MSD_ETHERNET_HEADER_SIZE);
-    }
-    //要判断当前fid是否还存在条目，如果不存在，应该删除对应fid，否则调用显示列表，不会显示任何数据。
-    msdMemSet(&resultEntry, 0, sizeof(MSD_ATU_ENTRY));
-    ret = getFirstAtuEntryInFid(devNum, fid, &resultEntry);
-    //if (ret == MSD_NO_SUCH && is_unset_fid) {//删除之后该fid不存在对应的MAC条目（注意广播条目需要单独判断），将fid删除
-    if (ret == MSD_NO_SUCH) {
-        ret = MSD_OK;
-        unsetFidValue(devNum, fid);
     }
+    //删除之后该fid不存在对应的MAC条目，将fid删除，否则调用显示列表，不会显示任何数据。
+    if (ret == MSD_OK && remainCount == 0)
+        unsetFidValue(devNum, fid);
+    return ret;
+}
+
+MSD_STATUS deviceAtuModuleFlushStaticEntries(IN MSD_U8 devNum, IN int fid, OUT AtuFlushStats* stats)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (fid < ALL_FID_VALUE || fid > MAX_FID_VALUE)
+        return MSD_BAD_PARAM;
+    AtuFlushStats localStats;
+    if (stats == NULL)
+        stats = &localStats;
+    msdMemSet(stats, 0, sizeof(AtuFlushStats));
+    MSD_STATUS ret = MSD_OK;
+    if (fid == ALL_FID_VALUE) {//删除所有的fid的静态条目
+        for (int i = fidSetNext(&s_fids[devNum], 0); i >= 0; i = fidSetNext(&s_fids[devNum], i + 1)) {
+            ret = deviceMacEntryFlushStaticInFid(devNum, (MSD_U32)i, stats);
+            if (ret != MSD_OK)
+                break;
+        }
+        setStaticOrAutoMacEntryUnvalid(devNum, UNVALID_VID, MSD_TRUE);
+    }
+    else {//删除指定的FID的静态条目
+        ret = deviceMacEntryFlushStaticInFid(devNum, (MSD_U32)fid, stats);
+        if (ret == MSD_OK) {
+            setStaticOrAutoMacEntryUnvalid(devNum, fid, MSD_TRUE);
+        }
+    }
+    s_lastFlushStats[devNum] = *stats;
+    MSD_DBG_INFO(("flush static mac entries: %u fids, %u skipped, %u walked, %u count reads, %u getnext, %u delete ops\n",
+                  (unsigned)stats->fidCount, (unsigned)stats->skippedFids, (unsigned)stats->walkedFids,
+                  (unsigned)stats->countReads, (unsigned)stats->getNextOps, (unsigned)stats->deleteOps));
     return ret;
 }
 
+MSD_STATUS deviceAtuModuleGetLastFlushStats(IN MSD_U8 devNum, OUT AtuFlushStats* stats)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (stats == NULL)
+        return MSD_BAD_PARAM;
+    *stats = s_lastFlushStats[devNum];
+    return MSD_OK;
+}
+
 MSD_STATUS deviceAtuModuleFlushEntries(MSD_U8 devNum, IN MSD_FLUSH_CMD flushCmd)
 {
 	CHECK_DEV_NUM_IS_CORRECT;
@@ -909,48 +1322,23 @@ MSD_STATUS deviceAtuModuleFlushEntries(MSD_U8 devNum, IN MSD_FLUSH_CMD flushCmd)
         return MSD_BAD_PARAM;
     }
     int fid = s_atuModuleInitType[devNum].fidNum;
-    int fidArraySize = MAX_FID_VALUE + 1;
-    MSD_U16* fidArray = (MSD_U16*)calloc(fidArraySize, sizeof(MSD_U16));
-    int fidCount = 0;
-    if (fidArray == NULL) {
-        return MSD_NO_SPACE;
-    }
     MSD_STATUS ret = MSD_OK;
     if (flushCmd == MSD_FLUSH_ALL_STATIC) { //删除静态条目
-        if (fid == ALL_FID_VALUE) //删除所有的fid的静态条目
-        {
-            deviceAtuModuleGetAllFidHasValues(devNum, fidArray, fidArraySize, &fidCount);
-            for (int i = 0; i < fidCount; ++i) { //
-                ret = deviceMacEntryFlushStaticInFid(devNum,fidArray[i]);
-                if (ret != MSD_OK)
-                    break;
-                deviceAtuModuleSetMacEntryVidFlagAndSize(devNum, fidArray[i], MSD_FALSE);//如果vid还存在对应的MAC条目，则不能设置成功
-            }
-            setStaticOrAutoMacEntryUnvalid(devNum, UNVALID_VID, MSD_TRUE);
-        }
-        else {//删除指定的FID的静态条目
-            deviceMacEntryFlushStaticInFid(devNum, fid);
-            if (ret == MSD_OK) {
-                setStaticOrAutoMacEntryUnvalid(devNum, fid, MSD_TRUE);
-            }
-            deviceAtuModuleSetMacEntryVidFlagAndSize(devNum, fid, MSD_FALSE);
-        }
+        ret = deviceAtuModuleFlushStaticEntries(devNum, fid, NULL);
     }
     else { //刷新所有条目 或者非静态条目
         if (fid == ALL_FID_VALUE) {
             ret = msdFdbAllDelete(devNum, flushCmd);
             if (ret == MSD_OK) {
-                deviceAtuModuleGetAllFidHasValues(devNum, fidArray, fidArraySize, &fidCount);
                 if (flushCmd == MSD_FLUSH_ALL_NONSTATIC) {//清空所有fid的非静态条目
-                    for (int i = 0; i < fidCount; ++i) {
+                    for (int i = fidSetNext(&s_fids[devNum], 0); i >= 0; i = fidSetNext(&s_fids[devNum], i + 1)) {
                         MSD_ATU_ENTRY result_entry;
                         msdMemSet(&result_entry, 0, sizeof(MSD_ATU_ENTRY));
-                        ret = getFirstAtuEntryInFid(devNum, fidArray[i], &result_entry);//
+                        ret = getFirstAtuEntryInFid(devNum, i, &result_entry);//
                         if (ret == MSD_NO_SUCH) {//删除之后该fid不存在对应的MAC条目，将fid删除
-                            unsetFidValue(devNum, fidArray[i]);
+                            unsetFidValue(devNum, i);
                             ret = MSD_OK;
                         }
-                        deviceAtuModuleSetMacEntryVidFlagAndSize(devNum, fidArray[i], MSD_FALSE);
                     }
                     setStaticOrAutoMacEntryUnvalid(devNum, UNVALID_VID, MSD_FALSE);
                 }
@@ -959,7 +1347,6 @@ MSD_STATUS deviceAtuModuleFlushEntries(MSD_U8 devNum, IN MSD_FLUSH_CMD flushCmd)
                     clearFidValues(devNum);
                     setStaticOrAutoMacEntryUnvalid(devNum, UNVALID_VID, MSD_TRUE);
                     setStaticOrAutoMacEntryUnvalid(devNum, UNVALID_VID, MSD_FALSE);
-                    deviceAtuModuleClearMacEntryVidFlag(devNum);//
                 }
             }
         }
@@ -991,8 +1378,6 @@ MSD_STATUS deviceAtuModuleFlushEntries(MSD_U8 devNum, IN MSD_FLUSH_CMD flushCmd)
             }
         }
     }
-    vPortFree(fidArray);
-    fidArray = NULL;
     return ret;
 }
 
@@ -1054,29 +1439,8 @@ MSD_STATUS deviceAtuModuleGetList(MSD_U8 devNum, AtuEntryType entryType, OUT MSD
         return MSD_BAD_PARAM;
     }
     msdMemSet(atuEntry,0,sizeof(MSD_ATU_ENTRY) * atuEntryMaxSize);
-    int fid = s_atuModuleInitType[devNum].fidNum;
-    MSD_STATUS ret = MSD_OK;
-    if (fid != ALL_FID_VALUE) {//查询某个FID的条目
-        ret = deviceMacEntryGetListInFid(devNum, fid, atuEntryCount, entryType, atuEntry, atuEntryMaxSize);
-    }
-    else { //查询所有FID的条目
-        int fidSize = MAX_FID_VALUE + 1;
-        MSD_U16* fidArray = (MSD_U16*)pvPortMalloc(sizeof(MSD_U16) * fidSize);
-        if (fidArray == NULL) return MSD_NO_SPACE;
-        msdMemSet(fidArray, 0, sizeof(int) * fidSize);
-        int fidCount = 0;
-        deviceAtuModuleGetAllFidHasValues(devNum, fidArray, fidSize, &fidCount);
-        for (int i = 0; i < fidCount; ++i) { //
-            ret = deviceMacEntryGetListInFid(devNum, fidArray[i], atuEntryCount, entryType, atuEntry, atuEntryMaxSize);
-            if (ret != MSD_OK){
-                break;
-            }
-
-        }
-        vPortFree(fidArray);
-        fidArray = NULL;
-    }
-    return ret;
+    int fid = s_atuModuleInitType[devNum].fidNum;//ALL_FID_VALUE时查询所有FID的条目，否则查询某个FID的条目
+    return deviceMacEntryGetListInFids(devNum, fid, atuEntryCount, entryType, atuEntry, atuEntryMaxSize);
 }
 
 MSD_STATUS deviceAtuModuleFindEntry(IN MSD_U8 devNum, IN int fid, IN  MSD_ETHERADDR* macAddr, OUT MSD_ATU_ENTRY* atuEntry, OUT MSD_BOOL* isFound)
@@ -1126,6 +1490,7 @@ static MSD_STATUS addOneVidStaticEntry(IN MSD_U8 devNum, IN MSD_ETHERADDR addres
     int fid = vid;//这里检查指定的fid的MAC地址条目是否存在，这样一个FID对应的VID就能和相同的MAC条目对应。
     MSD_BOOL isFoundMac;
     ret = msdFdbMacEntryFind(devNum, &address, fid, &macEntry, &isFoundMac);
+    s_atuModuleInitType[devNum].getNextOps++;
     if (ret != MSD_OK)
         return ret;
     //设置传递的参数，如果存在，则是修改，如果不存在，则是添加。
@@ -1324,18 +1689,7 @@ MSD_STATUS deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(IN MSD_U8 de
 {
 	CHECK_DEV_NUM_IS_CORRECT;
     MSD_STATUS ret = MSD_OK;
-    int fidSize = MAX_FID_VALUE + 1;
-    MSD_U16* fidArray = (MSD_U16*)pvPortMalloc(sizeof(MSD_U16) * fidSize);
-    if (fidArray == NULL) return MSD_NO_SPACE;
-    int fidCount = 0;
-    deviceAtuModuleGetAllFidHasValues(devNum, fidArray, fidSize, &fidCount);//获取所有有MAC条目的FID
-
-    //清空之前的静态条目
-    for (int j = 0; j < MAX_AUTO_ATU_ENTRIES; ++j) {
-        //s_atuModuleInitType[devNum].staticEntry[j].isVaild = MSD_FALSE;
-    	CLEAR_BIT(s_atuModuleInitType[devNum].staticEntry[j].ageAndFlag,2);
-    }
-    s_atuModuleInitType[devNum].staticEntryCount = 0;
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
 
     //清空所有的静态配置条目
     s_atuConfiguration[devNum].staticMacEntryCount = 0;
@@ -1343,45 +1697,29 @@ MSD_STATUS deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(IN MSD_U8 de
 
     MSD_ATU_ENTRY* atuEntry = (MSD_ATU_ENTRY*)pvPortMalloc(sizeof(MSD_ATU_ENTRY) * MAX_AUTO_ATU_ENTRIES);
     if (atuEntry == NULL) {
-    	vPortFree(fidArray);
         return MSD_NO_SPACE;
     }
     msdMemSet(atuEntry, 0, sizeof(MSD_ATU_ENTRY) * MAX_AUTO_ATU_ENTRIES);
     do {
         int atuEntryCount = 0;//MAC条目个数
-        for (int i = 0; i < fidCount; ++i) { //
-            ret = deviceMacEntryGetListInFid(devNum, fidArray[i], &atuEntryCount, ATU_ENTRY_TYPE_STATIC, atuEntry, MAX_AUTO_ATU_ENTRIES);
-            if (ret != MSD_OK)
-                break;
+        ret = deviceMacEntryGetListInFids(devNum, ALL_FID_VALUE, &atuEntryCount, ATU_ENTRY_TYPE_STATIC, atuEntry, MAX_AUTO_ATU_ENTRIES);
+        MSD_BOOL isComplete = (ret == MSD_OK && atuEntryCount <= MAX_STATIC_ATU_ENTRIES) ? MSD_TRUE : MSD_FALSE;
+        if (atuEntryCount > MAX_STATIC_ATU_ENTRIES) {//超过可以保存的静态条目个数
+            MSD_DBG_ERROR(("refresh static entries: %d static mac entries, only %d are kept!\n", atuEntryCount, MAX_STATIC_ATU_ENTRIES));
+            atuEntryCount = MAX_STATIC_ATU_ENTRIES;
         }
         s_atuConfiguration[devNum].staticMacEntryCount = atuEntryCount;
-        s_atuModuleInitType[devNum].staticEntryCount = atuEntryCount;
         for (int i = 0; i < atuEntryCount; ++i) {
 
             MSD_BOOL is_uni = IS_UNICAST_MAC(atuEntry[i].macAddr.arEther);
 
-            for (size_t j = 0; j < MSD_ETHERNET_HEADER_SIZE; ++j) {
-
-                s_atuModuleInitType[devNum].staticEntry[i].address.arEther[j] = atuEntry[i].macAddr.arEther[j];
+            MSD_U16 slot = setEntryToModuleIndex(devNum, atuEntry[i].macAddr, atuEntry[i].fid, atuEntry[i].portVec, MSD_TRUE, 0);//vid为其fid值
+            if (slot != MAC_INDEX_NIL)
+                SET_BIT(macSlotEntry(atu, slot)->ageAndFlag, MAC_ENTRY_MARK_BIT);
 
+            for (size_t j = 0; j < MSD_ETHERNET_HEADER_SIZE; ++j) {
                 s_atuConfiguration[devNum].staticMacEntry[i].address.arEther[j] = atuEntry[i].macAddr.arEther[j];
             }
-
-            //s_atuModuleInitType[devNum].staticEntry[i].age = -1;
-//            s_atuModuleInitType[devNum].staticEntry[i].isStatic = MSD_TRUE;
-//            s_atuModuleInitType[devNum].staticEntry[i].isUnicast = is_uni;
-//            s_atuModuleInitType[devNum].staticEntry[i].isVaild = MSD_TRUE;
-
-            SET_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,0);
-		    if(!is_uni){//多播
-			CLEAR_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,1);
-		    }else{//单播
-			SET_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,1);
-		    }
-		    SET_BIT(s_atuModuleInitType[devNum].staticEntry[i].ageAndFlag,2);
-
-            s_atuModuleInitType[devNum].staticEntry[i].portVec = atuEntry[i].portVec;
-            s_atuModuleInitType[devNum].staticEntry[i].vid = atuEntry[i].fid;//vid为其fid值
             //设置静态配置条目
             //s_atuConfiguration[devNum].staticMacEntry[i].age = -1;
 
@@ -1402,10 +1740,13 @@ MSD_STATUS deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(IN MSD_U8 de
             s_atuConfiguration[devNum].staticMacEntry[i].vid = atuEntry[i].fid;
 
         }
+        //读取完整时删除交换机中已经不存在的静态条目，否则没有读到的条目可能仍然存在
+        if (isComplete)
+            macIndexSweep(atu, MSD_TRUE, ATU_CHANGE_DELETE);
+        else
+            macIndexClearMarks(atu, MSD_TRUE);
     } while (0);
 
-    vPortFree(fidArray);
-    fidArray = NULL;
     vPortFree(atuEntry);
     atuEntry = NULL;
     return ret;
@@ -1495,73 +1836,79 @@ MSD_STATUS deviceAtuModuleGetAllVidAutoEntriesFromConfiguration(MSD_U8 devNum, O
     }
     *macEntryCount = 0;
     msdMemSet(macEntries,0,sizeof(MacEntry) * (macEntrySize));
+#ifdef ATU_SHADOW_STATIC_ONLY
+    //动态条目不保存在内存中，从交换机中读取，最多读取macEntrySize条
+    MSD_ATU_ENTRY* atuEntry = (MSD_ATU_ENTRY*)pvPortMalloc(sizeof(MSD_ATU_ENTRY) * macEntrySize);
+    if (atuEntry == NULL) {
+        return MSD_NO_SPACE;
+    }
+    int atuEntryCount = 0;
+    MSD_STATUS ret = deviceMacEntryGetListInFids(devNum, ALL_FID_VALUE, &atuEntryCount, ATU_ENTRY_TYPE_AUTO, atuEntry, (int)macEntrySize);
+    if (ret == MSD_NO_SPACE) {//超过macEntrySize的条目不返回
+        ret = MSD_OK;
+    }
+    for (int i = 0; i < atuEntryCount; ++i) {
+        macEntries[i].address = atuEntry[i].macAddr;
+        macEntries[i].vid = atuEntry[i].fid;//vid为其fid值
+        macEntries[i].portVec = atuEntry[i].portVec;
+        macEntries[i].ageAndFlag = (MSD_U8)((atuEntry[i].entryState & 0x7) << 3);//设置age
+        SET_BIT(macEntries[i].ageAndFlag, 1);
+        SET_BIT(macEntries[i].ageAndFlag, 2);
+    }
+    *macEntryCount = (MSD_U32)atuEntryCount;
+    vPortFree(atuEntry);
+    return ret;
+#else
     MSD_U32 temp = 0;
     for (int j = 0; j < MAX_AUTO_ATU_ENTRIES; ++j) {
         //if (s_atuModuleInitType[devNum].autoEntry[j].isVaild) {
     	if(IS_BIT_SET(s_atuModuleInitType[devNum].autoEntry[j].ageAndFlag,2)){
             //copyMacEntry(&macEntries[temp], &s_atuModuleInitType[devNum].autoEntry[j]);
-    		macEntries[temp] = s_atuModuleInitType[devNum].autoEntry[j];
+    		packedEntryToMacEntry(&s_atuModuleInitType[devNum].autoEntry[j], &macEntries[temp]);
             if ((++temp) == macEntrySize) break;
             if (temp == s_atuModuleInitType[devNum].autoEntryCount) break;
         }
     }
     *macEntryCount = temp;
     return MSD_OK;
+#endif
 }
 
 
 MSD_STATUS deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(IN MSD_U8 devNum)
 {
 	CHECK_DEV_NUM_IS_CORRECT;
-    int fidSize = MAX_FID_VALUE + 1;
-    MSD_U16* fidArray = (MSD_U16*)pvPortMalloc(sizeof(MSD_U16) * fidSize);
-    if (fidArray == NULL) return MSD_NO_SPACE;
-    msdMemSet(fidArray, 0, sizeof(int) * fidSize);
-    int fidCount = 0;
-    deviceAtuModuleGetAllFidHasValues(devNum, fidArray, fidSize, &fidCount);//获取所有有MAC条目的FID
+#ifdef ATU_SHADOW_STATIC_ONLY
+    return MSD_OK;//动态条目不保存在内存中，获取时直接从交换机读取
+#else
     MSD_STATUS ret = MSD_OK;
 
     int atuEntryCount = 0;//MAC条目个数
     MSD_ATU_ENTRY* atuEntry = (MSD_ATU_ENTRY*)pvPortMalloc(MAX_AUTO_ATU_ENTRIES * sizeof(MSD_ATU_ENTRY));
     if (atuEntry == NULL) {
-    	vPortFree(fidArray);
         return MSD_NO_SPACE;
     }
     msdMemSet(atuEntry, 0, sizeof(MSD_ATU_ENTRY) * MAX_AUTO_ATU_ENTRIES);
 
-    for (int i = 0; i < fidCount; ++i) { //
-        ret = deviceMacEntryGetListInFid(devNum, fidArray[i], &atuEntryCount, ATU_ENTRY_TYPE_AUTO, atuEntry, MAX_AUTO_ATU_ENTRIES);
-        if (ret != MSD_OK)
-            break;
-    }
-
-    //清空之前的动态条目
-    msdMemSet(&s_atuModuleInitType[devNum].autoEntry, 0, sizeof(MacEntry) * MAX_AUTO_ATU_ENTRIES);
+    ret = deviceMacEntryGetListInFids(devNum, ALL_FID_VALUE, &atuEntryCount, ATU_ENTRY_TYPE_AUTO, atuEntry, MAX_AUTO_ATU_ENTRIES);
 
-    s_atuModuleInitType[devNum].autoEntryCount = atuEntryCount;
+    //只更新有变化的动态条目，新条目和端口改变的条目加入变更记录
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
     for (int i = 0; i < atuEntryCount; ++i) {
-
-        for (size_t j = 0; j < MSD_ETHERNET_HEADER_SIZE; ++j) {
-            s_atuModuleInitType[devNum].autoEntry[i].address.arEther[j] = atuEntry[i].macAddr.arEther[j];
-        }
-//        s_atuModuleInitType[devNum].autoEntry[i].age = atuEntry[i].entryState;
-//        s_atuModuleInitType[devNum].autoEntry[i].isStatic = MSD_FALSE;
-//        s_atuModuleInitType[devNum].autoEntry[i].isUnicast = MSD_TRUE;
-//        s_atuModuleInitType[devNum].autoEntry[i].isVaild = MSD_TRUE;
-        s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag |= ((atuEntry[i].entryState & 0x7) << 3);//设置age
-        CLEAR_BIT(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,0);
-		SET_BIT(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,1);
-		SET_BIT(s_atuModuleInitType[devNum].autoEntry[i].ageAndFlag,2);
-
-        s_atuModuleInitType[devNum].autoEntry[i].portVec = atuEntry[i].portVec;
-        s_atuModuleInitType[devNum].autoEntry[i].vid = atuEntry[i].fid;//vid为其fid值
+        MSD_U16 slot = setEntryToModuleIndex(devNum, atuEntry[i].macAddr, atuEntry[i].fid, atuEntry[i].portVec, MSD_FALSE, atuEntry[i].entryState);//vid为其fid值
+        if (slot != MAC_INDEX_NIL)
+            SET_BIT(macSlotEntry(atu, slot)->ageAndFlag, MAC_ENTRY_MARK_BIT);
     }
+    //读取完整时交换机中已经不存在的动态条目视为老化，否则没有读到的条目可能仍然存在
+    if (ret == MSD_OK)
+        macIndexSweep(atu, MSD_FALSE, ATU_CHANGE_AGE_OUT);
+    else
+        macIndexClearMarks(atu, MSD_FALSE);
 
-    vPortFree(fidArray);
-    fidArray = NULL;
     vPortFree(atuEntry);
     atuEntry = NULL;
     return ret;
+#endif
 }
 
 
@@ -1622,6 +1969,143 @@ MSD_STATUS deviceAtuModuleSetAtuConfiguration(MSD_U8 devNum, IN AtuConfiguration
     return MSD_OK;
 }
 
+/**
+ * @brief staticEntryStateOf 静态条目在交换机中的EntryState
+ */
+static inline MSD_U8 staticEntryStateOf(const MSD_ETHERADDR* address)
+{
+    return IS_MULTICAST_MAC(address->arEther) ? (MSD_U8)MULTICAST_MAC_ENTRY_STATE : (MSD_U8)UNICAST_MAC_ENTRY_STATE;
+}
+
+/**
+ * @brief applyStaticConfigurationByRewrite 清空交换机中所有的静态条目，再添加所有配置的静态条目
+ * 交换机中的静态条目太多，无法一次读出比较时使用
+ */
+static MSD_STATUS applyStaticConfigurationByRewrite(IN MSD_U8 devNum, OUT AtuApplyStats* stats)
+{
+    stats->isFullRewrite = MSD_TRUE;
+    stats->deleteCount = s_atuModuleInitType[devNum].staticEntryCount;//按内存中的静态条目数计算
+    int fid = s_atuModuleInitType[devNum].fidNum;
+    s_atuModuleInitType[devNum].fidNum = ALL_FID_VALUE;
+    MSD_STATUS ret = deviceAtuModuleFlushEntries(devNum, MSD_FLUSH_ALL_STATIC);
+    s_atuModuleInitType[devNum].fidNum = fid;
+    if (ret != MSD_OK) return ret;
+
+    for (int i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
+        MacEntry* entry = &s_atuConfiguration[devNum].staticMacEntry[i];
+        if (!IS_BIT_SET(entry->ageAndFlag, 2))
+            continue;
+        ret = addOneVidStaticEntry(devNum, entry->address, entry->vid, entry->portVec);
+        if (ret != MSD_OK) return ret;
+        stats->addCount++;
+    }
+    return MSD_OK;
+}
+
+/**
+ * @brief markStaticEntryInModuleIndex 标记内存中交换机里存在的静态条目，应用结束后没有被标记的静态条目从内存中删除
+ */
+static void markStaticEntryInModuleIndex(IN MSD_U8 devNum, IN const MSD_ETHERADDR* address, IN MSD_U16 vid)
+{
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_U16 slot = macIndexFind(atu, address, vid, MSD_TRUE);
+    if (slot != MAC_INDEX_NIL)
+        SET_BIT(macSlotEntry(atu, slot)->ageAndFlag, MAC_ENTRY_MARK_BIT);
+}
+
+/**
+ * @brief applyStaticConfigurationByDiff 比较从交换机读取的静态条目和配置，只下发有变化的条目
+ * @param hwEntries 交换机中的全部静态条目
+ */
+static MSD_STATUS applyStaticConfigurationByDiff(IN MSD_U8 devNum, IN MSD_ATU_ENTRY* hwEntries, IN int hwEntryCount, OUT AtuApplyStats* stats)
+{
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_STATUS ret = MSD_OK;
+    MSD_U32 matched[(MAX_STATIC_ATU_ENTRIES + 31) / 32] = { 0 };//bit n表示staticMacEntry[n]在交换机中已经存在
+    for (int i = 0; i < hwEntryCount && ret == MSD_OK; ++i) {
+        MSD_ATU_ENTRY* hwEntry = &hwEntries[i];
+        int index = -1;
+        if (!checkStaticMacEntryIsInConfiguration(devNum, hwEntry->macAddr, hwEntry->fid, &index)) {//配置中已经没有该条目，删除
+            ret = msdFdbMacEntryDelete(devNum, &hwEntry->macAddr, hwEntry->fid);
+            if (ret != MSD_OK) break;
+            stats->deleteCount++;
+            removeStaticOrAutoMacEntryToModuleIndex(devNum, hwEntry->macAddr, hwEntry->fid, hwEntry->entryState);
+            //删除之后该fid不存在对应的MAC条目，将fid删除
+            MSD_ATU_ENTRY firstEntry;
+            if (getFirstAtuEntryInFid(devNum, hwEntry->fid, &firstEntry) == MSD_NO_SUCH)
+                unsetFidValue(devNum, hwEntry->fid);
+            continue;
+        }
+        SET_BIT(matched[index / 32], index % 32);
+        MacEntry* entry = &s_atuConfiguration[devNum].staticMacEntry[index];
+        if (hwEntry->portVec != entry->portVec || hwEntry->entryState != staticEntryStateOf(&entry->address)) {//修改端口
+            ret = addOneVidStaticEntry(devNum, entry->address, entry->vid, entry->portVec);
+            if (ret == MSD_OK)
+                stats->modifyCount++;
+        }
+        else {//没有变化，只同步内存中的条目
+            addEntryToModuleIndex(devNum, entry->address, entry->vid, entry->portVec, UNICAST_MAC_ENTRY_STATE);
+        }
+        if (ret == MSD_OK)
+            markStaticEntryInModuleIndex(devNum, &entry->address, entry->vid);
+    }
+
+    //添加交换机中还不存在的配置条目
+    for (int i = 0; i < MAX_STATIC_ATU_ENTRIES && ret == MSD_OK; ++i) {
+        MacEntry* entry = &s_atuConfiguration[devNum].staticMacEntry[i];
+        if (!IS_BIT_SET(entry->ageAndFlag, 2) || IS_BIT_SET(matched[i / 32], i % 32))
+            continue;
+        ret = addOneVidStaticEntry(devNum, entry->address, entry->vid, entry->portVec);
+        if (ret == MSD_OK) {
+            stats->addCount++;
+            markStaticEntryInModuleIndex(devNum, &entry->address, entry->vid);
+        }
+    }
+    //全部下发成功时，内存中没有被标记的静态条目在交换机中已经不存在，从内存中删除
+    if (ret == MSD_OK) {
+        MSD_U32 staticCount = atu->staticEntryCount;
+        macIndexSweep(atu, MSD_TRUE, ATU_CHANGE_DELETE);
+        stats->sweepCount = staticCount - atu->staticEntryCount;
+    }
+    else {
+        macIndexClearMarks(atu, MSD_TRUE);
+    }
+    return ret;
+}
+
+MSD_STATUS deviceAtuModuleApplyStaticConfiguration(IN MSD_U8 devNum, OUT AtuApplyStats* stats)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    AtuApplyStats localStats;
+    if (stats == NULL)
+        stats = &localStats;
+    msdMemSet(stats, 0, sizeof(AtuApplyStats));
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_U32 getNextOps = atu->getNextOps;
+    MSD_U32 dumpFrames = atu->dumpFrames;
+
+    //交换机中的静态条目，最多读取配置个数的两倍，超过时清空后重新添加
+    int hwEntryMaxSize = MAX_STATIC_ATU_ENTRIES * 2;
+    MSD_ATU_ENTRY* hwEntries = (MSD_ATU_ENTRY*)pvPortMalloc(sizeof(MSD_ATU_ENTRY) * hwEntryMaxSize);
+    if (hwEntries == NULL) {
+        return MSD_NO_SPACE;
+    }
+    int hwEntryCount = 0;
+    MSD_STATUS ret = deviceMacEntryGetListInFids(devNum, ALL_FID_VALUE, &hwEntryCount, ATU_ENTRY_TYPE_STATIC, hwEntries, hwEntryMaxSize);
+    if (ret == MSD_NO_SPACE)
+        ret = applyStaticConfigurationByRewrite(devNum, stats);
+    else if (ret == MSD_OK)
+        ret = applyStaticConfigurationByDiff(devNum, hwEntries, hwEntryCount, stats);
+    vPortFree(hwEntries);
+    hwEntries = NULL;
+    stats->getNextOps = atu->getNextOps - getNextOps;
+    stats->dumpFrames = atu->dumpFrames - dumpFrames;
+    MSD_DBG_INFO(("apply static mac entries: add %u, delete %u, modify %u, sweep %u, %u GetNext, %u dump frames\n",
+                  (unsigned)stats->addCount, (unsigned)stats->deleteCount, (unsigned)stats->modifyCount,
+                  (unsigned)stats->sweepCount, (unsigned)stats->getNextOps, (unsigned)stats->dumpFrames));
+    return ret;
+}
+
 MSD_STATUS deviceAtuModuleSaveAtuConfiguration(MSD_U8 devNum)
 {
 	CHECK_DEV_NUM_IS_CORRECT;
@@ -1633,19 +2117,446 @@ MSD_STATUS deviceAtuModuleSaveAtuConfiguration(MSD_U8 devNum)
     ret = deviceAtuModuleSetUseMacEntryTypeToConfiguration(devNum, useType);
     if (ret != MSD_OK) return ret;
 
-    //先清空所有的静态条目
-    int fid = s_atuModuleInitType[devNum].fidNum;
-    s_atuModuleInitType[devNum].fidNum = ALL_FID_VALUE;
-    ret = deviceAtuModuleFlushEntries(devNum, MSD_FLUSH_ALL_STATIC);
-    if (ret != MSD_OK) return ret;
-    s_atuModuleInitType[devNum].fidNum = fid;
+    //只下发和交换机中不同的静态条目
+    return deviceAtuModuleApplyStaticConfiguration(devNum, NULL);
+}
 
-    int macCount = s_atuConfiguration[devNum].staticMacEntryCount;
-    for (int i = 0; i < macCount; ++i) {
-        ret = addOneVidStaticEntry(devNum, s_atuConfiguration[devNum].staticMacEntry[i].address, s_atuConfiguration[devNum].staticMacEntry[i].vid,
-                                   s_atuConfiguration[devNum].staticMacEntry[i].portVec);
-        if (ret != MSD_OK) return ret;
+MSD_STATUS deviceAtuModuleGetGeneration(IN MSD_U8 devNum, OUT MSD_U32* generation)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (generation == NULL)
+        return MSD_BAD_PARAM;
+    *generation = s_atuModuleInitType[devNum].generation;
+    return MSD_OK;
+}
+
+MSD_STATUS deviceAtuModuleGetChangesSince(IN MSD_U8 devNum, IN MSD_U32 generation, OUT AtuChange* changes, IN int changeMaxSize,
+    OUT int* changeCount, OUT MSD_U32* lastGeneration, OUT MSD_BOOL* needResync)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (changes == NULL || changeMaxSize < 0 || changeCount == NULL || lastGeneration == NULL || needResync == NULL)
+        return MSD_BAD_PARAM;
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    *changeCount = 0;
+    *needResync = MSD_FALSE;
+    *lastGeneration = generation;
+
+    //generation比当前的还新(模块重新初始化过)，或者需要的变更已经被覆盖
+    if (generation > atu->generation || atu->generation - generation > ATU_CHANGE_JOURNAL_SIZE) {
+        *needResync = MSD_TRUE;
+        *lastGeneration = atu->generation;
+        return MSD_OK;
+    }
+    int count = 0;
+    for (MSD_U32 g = generation + 1; g <= atu->generation && count < changeMaxSize; ++g) {
+        const AtuJournalRecord* record = &atu->journal[g & (ATU_CHANGE_JOURNAL_SIZE - 1)];
+        if (record->generation != g) {//批量清空时没有逐条记录
+            *needResync = MSD_TRUE;
+            *lastGeneration = atu->generation;
+            return MSD_OK;
+        }
+        changes[count].generation = g;
+        changes[count].changeType = (AtuChangeType)record->changeType;
+        packedEntryToMacEntry(&record->entry, &changes[count].entry);
+        ++count;
+        *lastGeneration = g;
+    }
+    *changeCount = count;
+    return MSD_OK;
+}
+
+MSD_STATUS deviceAtuModuleGetEntryGeneration(IN MSD_U8 devNum, IN MSD_ETHERADDR address, IN MSD_U16 vid, IN MSD_BOOL isStatic, OUT MSD_U32* generation)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (generation == NULL)
+        return MSD_BAD_PARAM;
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_U16 slot = macIndexFind(atu, &address, vid, isStatic);
+    if (slot == MAC_INDEX_NIL)
+        return MSD_NO_SUCH;
+    *generation = macSlotGeneration(atu, slot);
+    return MSD_OK;
+}
+
+#define  ATU_ITERATOR_STATE_FID_START  0
+#define  ATU_ITERATOR_STATE_IN_FID  1
+#define  ATU_ITERATOR_STATE_END  2
+
+MSD_STATUS deviceAtuModuleIteratorOpen(IN MSD_U8 devNum, OUT AtuIterator* iterator, IN AtuEntryType entryType, IN int vid, IN MSD_U32 portVec)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (iterator == NULL || entryType < 1 || entryType > ATU_ENTRY_TYPE_SIZE || vid < ALL_FID_VALUE || vid > MAX_FID_VALUE)
+        return MSD_BAD_PARAM;
+    msdMemSet(iterator, 0, sizeof(AtuIterator));
+    iterator->devNum = devNum;
+    iterator->entryType = (MSD_U8)entryType;
+    iterator->portVec = portVec;
+    iterator->state = ATU_ITERATOR_STATE_FID_START;
+    if (vid == ALL_FID_VALUE) {
+        iterator->vid = MAX_FID_VALUE + 1;
+        int fid = fidSetNext(&s_fids[devNum], 0);
+        if (fid < 0)
+            iterator->state = ATU_ITERATOR_STATE_END;
+        else
+            iterator->fid = (MSD_U16)fid;
+    }
+    else {
+        iterator->vid = (MSD_U16)vid;
+        iterator->fid = (MSD_U16)vid;
+    }
+    return MSD_OK;
+}
+
+/**
+ * @brief atuIteratorNextFid 当前FID已经读取完成，移到下一个FID
+ */
+static void atuIteratorNextFid(AtuIterator* iterator)
+{
+    int fid = -1;
+    if (iterator->vid > MAX_FID_VALUE)
+        fid = fidSetNext(&s_fids[iterator->devNum], iterator->fid + 1);
+    if (fid < 0) {
+        iterator->state = ATU_ITERATOR_STATE_END;
+        return;
+    }
+    iterator->fid = (MSD_U16)fid;
+    iterator->state = ATU_ITERATOR_STATE_FID_START;
+}
+
+MSD_STATUS deviceAtuModuleIteratorNext(INOUT AtuIterator* iterator, OUT MSD_ATU_ENTRY* atuEntries, IN int atuEntryMaxSize,
+    OUT int* atuEntryCount, OUT MSD_BOOL* isEnd)
+{
+    if (iterator == NULL || atuEntries == NULL || atuEntryMaxSize <= 0 || atuEntryCount == NULL || isEnd == NULL)
+        return MSD_BAD_PARAM;
+    MSD_U8 devNum = iterator->devNum;
+    CHECK_DEV_NUM_IS_CORRECT;
+    *atuEntryCount = 0;
+    MSD_STATUS ret = MSD_OK;
+    MSD_ATU_ENTRY resultEntry;
+    while (iterator->state != ATU_ITERATOR_STATE_END && *atuEntryCount < atuEntryMaxSize) {
+        if (iterator->state == ATU_ITERATOR_STATE_FID_START) {//从广播条目开始查询
+            for (size_t i = 0; i < MSD_ETHERNET_HEADER_SIZE; ++i) {
+                iterator->lastMac.arEther[i] = 0xff;
+            }
+        }
+        msdMemSet(&resultEntry, 0, sizeof(MSD_ATU_ENTRY));
+        ret = msdFdbEntryNextGet(devNum, &iterator->lastMac, iterator->fid, &resultEntry);
+        if (ret == MSD_NO_SUCH) {//该FID无更多条目
+            ret = MSD_OK;
+            atuIteratorNextFid(iterator);
+            continue;
+        }
+        if (ret != MSD_OK)
+            break;//游标不变，可以重试
+        iterator->lastMac = resultEntry.macAddr;
+        iterator->state = ATU_ITERATOR_STATE_IN_FID;
+        if (iterator->portVec == ATU_ITERATOR_ALL_PORTS || (resultEntry.portVec & iterator->portVec) != 0)
+            deviceMacEntryAddToList((AtuEntryType)iterator->entryType, &resultEntry, atuEntries, atuEntryCount);
+        if (MSD_IS_BROADCAST_MAC(resultEntry.macAddr))//广播条目是FID中的最后一个条目
+            atuIteratorNextFid(iterator);
+    }
+    *isEnd = (iterator->state == ATU_ITERATOR_STATE_END) ? MSD_TRUE : MSD_FALSE;
+    return ret;
+}
+
+void deviceAtuModuleIteratorClose(INOUT AtuIterator* iterator)
+{
+    if (iterator != NULL)
+        iterator->state = ATU_ITERATOR_STATE_END;
+}
+
+MSD_STATUS deviceAtuModuleCheckConsistency(IN MSD_U8 devNum)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    AtuModuleInitType* atu = &s_atuModuleInitType[devNum];
+    MSD_STATUS ret = MSD_OK;
+    MSD_U32 staticTotal = 0, autoTotal = 0, vidSize = 0, validSlots = 0, headCells = 0;
+    //沿每个VID链表重新计数，和增量维护的计数比较
+    for (MSD_U32 vid = 0; vid <= MAX_FID_VALUE; ++vid) {
+        MSD_U32 staticCount = 0, autoCount = 0, steps = 0;
+        for (MSD_U16 slot = vidHeadOf(atu, (MSD_U16)vid); slot != MAC_INDEX_NIL; slot = atu->slotNext[slot]) {
+            PackedMacEntry* entry = macSlotEntry(atu, slot);
+            MSD_BOOL isStatic = MAC_SLOT_IS_STATIC(slot);
+            if (++steps > MAC_SLOT_COUNT || !IS_BIT_SET(entry->ageAndFlag, 2) || packedEntryVid(entry) != vid ||
+                macIndexFind(atu, &entry->address, (MSD_U16)vid, isStatic) != slot) {
+                MSD_DBG_ERROR(("atu consistency: vid %u chain is broken at slot %u\n", (unsigned)vid, (unsigned)slot));
+                ret = MSD_FAIL;
+                break;
+            }
+            if (isStatic)
+                staticCount++;
+            else
+                autoCount++;
+        }
+        if (staticCount + autoCount != 0)
+            vidSize++;
+        staticTotal += staticCount;
+        autoTotal += autoCount;
+    }
+    //链表头表中的每个表项都必须能由其VID找到
+    for (MSD_U32 pos = 0; pos < VID_HEAD_SIZE; ++pos) {
+        MSD_U16 head = atu->vidHead[pos];
+        if (head == MAC_INDEX_NIL)
+            continue;
+        headCells++;
+        if (vidHeadPos(atu, packedEntryVid(macSlotEntry(atu, head))) != pos) {
+            MSD_DBG_ERROR(("atu consistency: vid head %u of slot %u is not reachable\n", (unsigned)pos, (unsigned)head));
+            ret = MSD_FAIL;
+        }
+    }
+    for (MSD_U32 slot = 0; slot < MAC_SLOT_COUNT; ++slot) {
+        if (IS_BIT_SET(macSlotEntry(atu, (MSD_U16)slot)->ageAndFlag, 2))
+            validSlots++;
+    }
+    if (staticTotal != atu->staticEntryCount || autoTotal != atu->autoEntryCount || validSlots != staticTotal + autoTotal ||
+        vidSize != atu->allMacEntryVidSize || headCells != vidSize) {
+        MSD_DBG_ERROR(("atu consistency: counts %u static %u auto %u vids, chains have %u static %u auto %u vids, %u valid entries %u vid heads\n",
+                       (unsigned)atu->staticEntryCount, (unsigned)atu->autoEntryCount, (unsigned)atu->allMacEntryVidSize,
+                       (unsigned)staticTotal, (unsigned)autoTotal, (unsigned)vidSize, (unsigned)validSlots, (unsigned)headCells));
+        ret = MSD_FAIL;
+    }
+    return ret;
+}
+
+/**
+ * 每个设备的端口学习策略和运行状态
+ */
+typedef struct {
+    AtuLearnPolicy policy;
+    AtuLearnPolicyStatus status;
+    TickType_t lastRebalance;//最近一次再平衡的时间
+}AtuLearnPolicyState;
+
+static AtuLearnPolicyState s_learnPolicy[MAX_SOHO_DEVICES] = { 0 };
+
+static MSD_U8 learnPolicyPortCount(IN MSD_QD_DEV* dev)
+{
+    return dev->numOfPorts > MSD_MAX_SWITCH_PORTS ? (MSD_U8)MSD_MAX_SWITCH_PORTS : dev->numOfPorts;
+}
+
+#ifndef ATU_SHADOW_STATIC_ONLY
+/**
+ * @brief macSlotIsPortOnly 是否是只属于arg端口向量的动态条目
+ */
+static MSD_BOOL macSlotIsPortOnly(PackedMacEntry* entry, MSD_U16 slot, MSD_U32 arg)
+{
+    return !MAC_SLOT_IS_STATIC(slot) && packedEntryPortVec(entry) == arg ? MSD_TRUE : MSD_FALSE;
+}
+#endif
+
+/**
+ * @brief learnPolicyFlushPort 清空端口的动态条目，内存中只属于该端口的动态条目同步删除
+ */
+static MSD_STATUS learnPolicyFlushPort(IN MSD_U8 devNum, IN MSD_U8 port)
+{
+    MSD_STATUS ret = msdFdbPortRemove(devNum, MSD_MOVE_ALL_NONSTATIC, (MSD_LPORT)port);
+    if (ret != MSD_OK)
+        return ret;
+#ifndef ATU_SHADOW_STATIC_ONLY
+    macIndexRemoveIf(&s_atuModuleInitType[devNum], UNVALID_VID, macSlotIsPortOnly, 1U << port, ATU_CHANGE_DELETE);
+#endif
+    s_learnPolicy[devNum].status.learnCount[port] = 0;
+    return MSD_OK;
+}
+
+/**
+ * @brief learnPolicyRebalance 读取受管理端口的学习个数，按预算重新分配学习上限，只写入有变化的端口
+ * @param isShrink ATU满时为MSD_TRUE，把预算缩小到当前学习个数之和的7/8，否则预算恢复ATU_LEARN_POLICY_HEADROOM
+ */
+static MSD_STATUS learnPolicyRebalance(IN MSD_U8 devNum, IN MSD_U8 portCount, IN MSD_BOOL isShrink)
+{
+    AtuLearnPolicyState* lp = &s_learnPolicy[devNum];
+    AtuLearnPolicy* policy = &lp->policy;
+    AtuLearnPolicyStatus* status = &lp->status;
+    MSD_U32 demand[MSD_MAX_SWITCH_PORTS] = { 0 };
+    MSD_U32 sumMin = 0, sumExtra = 0, sumCount = 0;
+    MSD_STATUS ret = MSD_OK;
+    lp->lastRebalance = xTaskGetTickCount();
+    for (MSD_U8 port = 0; port < portCount; ++port) {
+        if (policy->minLimit[port] == 0)
+            continue;
+        MSD_U32 count = 0;
+        ret = msdFdbPortLearnCountGet(devNum, (MSD_LPORT)port, &count);
+        if (ret != MSD_OK)
+            return ret;
+        status->learnCount[port] = (MSD_U16)count;
+        MSD_U32 want = count + ATU_LEARN_POLICY_HEADROOM;//学满的端口在当前个数之上增加余量
+        if (want < policy->minLimit[port])
+            want = policy->minLimit[port];
+        if (want > policy->maxLimit[port])
+            want = policy->maxLimit[port];
+        demand[port] = want;
+        sumMin += policy->minLimit[port];
+        sumExtra += want - policy->minLimit[port];
+        sumCount += count;
+    }
+    if (isShrink) {
+        MSD_U32 budget = sumCount - sumCount / 8;
+        if (budget < sumMin)
+            budget = sumMin;
+        if (budget < status->budget)
+            status->budget = (MSD_U16)budget;
+    }
+    else if (status->budget < policy->totalBudget) {
+        MSD_U32 budget = (MSD_U32)status->budget + ATU_LEARN_POLICY_HEADROOM;
+        status->budget = (MSD_U16)(budget > policy->totalBudget ? policy->totalBudget : budget);
+    }
+    //先保证minLimit，剩余预算不够时按需求比例分配
+    MSD_U32 spare = status->budget - sumMin;
+    for (MSD_U8 port = 0; port < portCount; ++port) {
+        if (policy->minLimit[port] == 0)
+            continue;
+        MSD_U32 extra = demand[port] - policy->minLimit[port];
+        if (sumExtra > spare)
+            extra = extra * spare / sumExtra;
+        MSD_U16 limit = (MSD_U16)(policy->minLimit[port] + extra);
+        if (limit == status->limit[port])
+            continue;
+        ret = msdFdbPortLearnLimitSet(devNum, (MSD_LPORT)port, limit);
+        if (ret != MSD_OK)
+            return ret;
+        status->limit[port] = limit;
+    }
+    status->rebalanceCount++;
+    return MSD_OK;
+}
+
+MSD_STATUS deviceAtuModuleSetLearnPolicy(IN MSD_U8 devNum, IN const AtuLearnPolicy* policy)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (policy == NULL)
+        return MSD_BAD_PARAM;
+    MSD_U8 portCount = learnPolicyPortCount(dev);
+    AtuLearnPolicy newPolicy = *policy;
+    if (newPolicy.totalBudget == 0)
+        newPolicy.totalBudget = MAX_AUTO_ATU_ENTRIES - MAX_STATIC_ATU_ENTRIES;
+    if (newPolicy.totalBudget > MAX_AUTO_ATU_ENTRIES - MAX_STATIC_ATU_ENTRIES)
+        return MSD_BAD_PARAM;
+    MSD_U32 sumMin = 0;
+    for (MSD_U8 port = 0; port < MSD_MAX_SWITCH_PORTS; ++port) {
+        if (port >= portCount || !newPolicy.isEnable) {
+            newPolicy.minLimit[port] = 0;
+            newPolicy.maxLimit[port] = 0;
+            continue;
+        }
+        if (newPolicy.minLimit[port] > ATU_PORT_LEARN_LIMIT_MAX || newPolicy.maxLimit[port] > ATU_PORT_LEARN_LIMIT_MAX)
+            return MSD_BAD_PARAM;
+        if (newPolicy.maxLimit[port] < newPolicy.minLimit[port])
+            newPolicy.maxLimit[port] = newPolicy.minLimit[port];
+        sumMin += newPolicy.minLimit[port];
+    }
+    if (sumMin > newPolicy.totalBudget)
+        return MSD_BAD_PARAM;
+
+    AtuLearnPolicyState* lp = &s_learnPolicy[devNum];
+    MSD_STATUS ret = MSD_OK;
+    for (MSD_U8 port = 0; port < portCount && ret == MSD_OK; ++port) {
+        MSD_BOOL wasManaged = lp->status.limit[port] != 0 ? MSD_TRUE : MSD_FALSE;
+        MSD_BOOL isManaged = newPolicy.minLimit[port] != 0 ? MSD_TRUE : MSD_FALSE;
+        if (isManaged && !wasManaged) {
+            //交换机要求:关闭学习，清空动态条目，设置上限，再恢复学习。上限为0时学习计数不工作，不清空的话计数会少于实际条目
+            MSD_BOOL isLearn = MSD_TRUE;
+            ret = msdPortLearnEnableGet(devNum, (MSD_LPORT)port, &isLearn);
+            if (ret == MSD_OK)
+                ret = msdPortLearnEnableSet(devNum, (MSD_LPORT)port, MSD_FALSE);
+            if (ret == MSD_OK)
+                ret = learnPolicyFlushPort(devNum, port);
+            if (ret == MSD_OK)
+                ret = msdFdbPortLearnLimitSet(devNum, (MSD_LPORT)port, newPolicy.minLimit[port]);
+            if (ret == MSD_OK)
+                lp->status.limit[port] = newPolicy.minLimit[port];
+            MSD_STATUS learnRet = msdPortLearnEnableSet(devNum, (MSD_LPORT)port, isLearn);
+            if (ret == MSD_OK)
+                ret = learnRet;
+        }
+        else if (!isManaged && wasManaged) {
+            ret = msdFdbPortLearnLimitSet(devNum, (MSD_LPORT)port, 0);
+            if (ret == MSD_OK) {
+                lp->status.limit[port] = 0;
+                lp->status.learnCount[port] = 0;
+            }
+        }
     }
+    if (ret != MSD_OK) {
+        MSD_DBG_ERROR(("deviceAtuModuleSetLearnPolicy failed, the status is %d\n", ret));
+        return ret;
+    }
+    lp->policy = newPolicy;
+    lp->status.budget = newPolicy.totalBudget;
+    if (!newPolicy.isEnable)
+        return MSD_OK;
+    return learnPolicyRebalance(devNum, portCount, MSD_FALSE);
+}
 
+MSD_STATUS deviceAtuModuleGetLearnPolicy(IN MSD_U8 devNum, OUT AtuLearnPolicy* policy)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (policy == NULL)
+        return MSD_BAD_PARAM;
+    *policy = s_learnPolicy[devNum].policy;
+    return MSD_OK;
+}
+
+MSD_STATUS deviceAtuModuleGetLearnPolicyStatus(IN MSD_U8 devNum, OUT AtuLearnPolicyStatus* status)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (status == NULL)
+        return MSD_BAD_PARAM;
+    *status = s_learnPolicy[devNum].status;
+    status->shadowDrops = s_atuModuleInitType[devNum].autoDropCount;
+    return MSD_OK;
+}
+
+MSD_STATUS deviceAtuModuleLearnPolicyRebalance(IN MSD_U8 devNum)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (!s_learnPolicy[devNum].policy.isEnable)
+        return MSD_OK;
+    return learnPolicyRebalance(devNum, learnPolicyPortCount(dev), MSD_FALSE);
+}
+
+MSD_STATUS deviceAtuModuleLearnPolicyPoll(IN MSD_U8 devNum)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    AtuLearnPolicyState* lp = &s_learnPolicy[devNum];
+    if (!lp->policy.isEnable || xTaskGetTickCount() - lp->lastRebalance < pdMS_TO_TICKS(ATU_LEARN_POLICY_INTERVAL_MS))
+        return MSD_OK;
+    return learnPolicyRebalance(devNum, learnPolicyPortCount(dev), MSD_FALSE);
+}
+
+MSD_STATUS deviceAtuModuleLearnPolicyHandleViolation(IN MSD_U8 devNum, IN const MSD_ATU_INT_STATUS* atuIntStatus)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (atuIntStatus == NULL)
+        return MSD_BAD_PARAM;
+    AtuLearnPolicyState* lp = &s_learnPolicy[devNum];
+    if (!atuIntStatus->atuIntCause.fullVio || !lp->policy.isEnable)
+        return MSD_OK;
+    lp->status.fullViolations++;
+    MSD_U8 portCount = learnPolicyPortCount(dev);
+    MSD_STATUS ret = learnPolicyRebalance(devNum, portCount, MSD_TRUE);
+    if (ret != MSD_OK)
+        return ret;
+    //学习个数超出新上限最多的端口视为泛洪源，清空它的动态条目给其他端口腾出空间
+    MSD_U8 floodPort = MSD_MAX_SWITCH_PORTS;
+    MSD_U32 maxOver = 0;
+    for (MSD_U8 port = 0; port < portCount; ++port) {
+        if (lp->policy.minLimit[port] == 0 || lp->status.learnCount[port] <= lp->status.limit[port])
+            continue;
+        MSD_U32 over = (MSD_U32)lp->status.learnCount[port] - lp->status.limit[port];
+        if (over > maxOver) {
+            maxOver = over;
+            floodPort = port;
+        }
+    }
+    if (floodPort == MSD_MAX_SWITCH_PORTS)
+        return MSD_OK;
+    MSD_DBG_ERROR(("ATU full, flush %u auto entries of port %u, budget %u\n", (unsigned)lp->status.learnCount[floodPort],
+                   (unsigned)floodPort, (unsigned)lp->status.budget));
+    ret = learnPolicyFlushPort(devNum, floodPort);
+    if (ret == MSD_OK) {
+        lp->status.quarantineCount++;
+        lp->status.lastQuarantinePort = floodPort;
+    }
     return ret;
 }
@@ -0,0 +1,375 @@
+#include <apiInit.h>
+#include <deviceMacModule.h>
+#include <deviceMacTelemetryModule.h>
+#include <string.h>
+
+#define  MAC_TELEMETRY_TASK_PRIORITY  1  //与事件任务相同
+//任务栈(字)：采样经过RMU寄存器访问时请求和响应帧约1.9KB，读取失败时msdDbgPrint约1.2KB
+#define  MAC_TELEMETRY_TASK_STACK_SIZE  1024
+
+/**
+ * 每个设备的MAC学习统计状态，采样任务、ATU中断处理函数和查询接口通过lock互斥
+ */
+typedef struct {
+    SemaphoreHandle_t lock;
+    TaskHandle_t taskHandle;//采样任务，停止时删除
+    MSD_U8 devNum;
+    MacTelemetryStatus status;//汇总统计，ports的learnRate在查询时计算
+    MacTelemetrySample history[MAC_TELEMETRY_HISTORY_SIZE];//环形缓冲区
+    MSD_U16 historyHead;//下一个采样写入的位置
+    MSD_U16 historyCount;//保存的采样个数
+    MSD_U32 totalSampleCost;//所有采样开销的和，用于计算平均值
+    MacFlapEntry flaps[MAC_TELEMETRY_FLAP_TABLE_SIZE];//portVec为0的为空项
+}MacTelemetryState;
+
+static MacTelemetryState s_macTelemetry[MAX_SOHO_DEVICES] = { 0 };
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_U32 macTelemetryNowMs(void)
+{
+    return (MSD_U32)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/**
+ * @brief macTelemetryReadSample 读取一次采样：ATU条目个数，动态条目个数和每个端口的学习计数
+ * 每个计数都是交换机的寄存器，ATU条目计数需要按统计bin各做一次ATU操作
+ * @param devNum
+ * @param portCount
+ * @param sample
+ * @return
+ */
+static MSD_STATUS macTelemetryReadSample(IN MSD_U8 devNum, IN MSD_U8 portCount, OUT MacTelemetrySample* sample)
+{
+    MSD_U32 count = 0;
+    MSD_STATUS ret = msdFdbEntryCountGet(devNum, &count);
+    if (ret != MSD_OK)
+        return ret;
+    sample->entryCount = (MSD_U16)count;
+    ret = msdFdbEntryCountNonStaticGet(devNum, &count);
+    if (ret != MSD_OK)
+        return ret;
+    sample->nonStaticCount = (MSD_U16)count;
+    for (MSD_U8 port = 0; port < portCount; ++port) {
+        ret = msdFdbPortLearnCountGet(devNum, (MSD_LPORT)port, &count);
+        if (ret != MSD_OK)
+            return ret;
+        sample->learnCount[port] = (MSD_U16)count;
+    }
+    return MSD_OK;
+}
+
+/**
+ * @brief macTelemetryAddSample 保存采样，累加各端口学习计数的增减
+ */
+static void macTelemetryAddSample(IN MacTelemetryState* state, IN const MacTelemetrySample* sample, IN MSD_U32 cost)
+{
+    MacTelemetryStatus* status = &state->status;
+    if (state->historyCount > 0) {
+        const MacTelemetrySample* prev = &state->history[(state->historyHead + MAC_TELEMETRY_HISTORY_SIZE - 1) % MAC_TELEMETRY_HISTORY_SIZE];
+        for (MSD_U8 port = 0; port < status->portCount; ++port) {
+            if (sample->learnCount[port] >= prev->learnCount[port])
+                status->ports[port].learnedTotal += sample->learnCount[port] - prev->learnCount[port];
+            else
+                status->ports[port].removedTotal += prev->learnCount[port] - sample->learnCount[port];
+        }
+    }
+    state->history[state->historyHead] = *sample;
+    state->historyHead = (state->historyHead + 1) % MAC_TELEMETRY_HISTORY_SIZE;
+    if (state->historyCount < MAC_TELEMETRY_HISTORY_SIZE)
+        state->historyCount++;
+
+    status->sampleCount++;
+    status->entryCount = sample->entryCount;
+    status->nonStaticCount = sample->nonStaticCount;
+    for (MSD_U8 port = 0; port < status->portCount; ++port) {
+        status->ports[port].learnCount = sample->learnCount[port];
+    }
+    status->lastSampleCost = cost;
+    if (cost > status->maxSampleCost)
+        status->maxSampleCost = cost;
+    state->totalSampleCost += cost;
+}
+
+/**
+ * @brief macTelemetryTaskProc 采样任务，与事件任务一样在设备锁内访问交换机，正在调用API时跳过本次采样
+ */
+static void macTelemetryTaskProc(void* param)
+{
+    MacTelemetryState* state = (MacTelemetryState*)param;
+    DeviceConfig* deviceConfig = &g_allDevicesConfig[state->devNum];
+    MacTelemetrySample sample;
+    for (;;) {
+        if (!state->status.isRunning) {
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);//等待deviceMacTelemetryModuleStart
+            continue;
+        }
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(state->status.config.intervalMs));
+        if (!state->status.isRunning)
+            continue;
+
+        MSD_STATUS ret = MSD_FAIL;
+        MSD_U32 cost = 0;
+        msdMemSet(&sample, 0, sizeof(MacTelemetrySample));
+        if (!deviceConfig->isCallAPI && xSemaphoreTake(deviceConfig->xMutex, pdMS_TO_TICKS(state->status.config.intervalMs)) == pdTRUE) {
+            //等待设备锁期间可能开始了API调用(initStartCallAPI在设备锁内设置isCallAPI)，拿到锁后再检查一次
+            if (!deviceConfig->isCallAPI) {
+                MSD_U32 startTime = msdTimeStamp();
+                ret = macTelemetryReadSample(state->devNum, state->status.portCount, &sample);
+                cost = msdTimeStamp() - startTime;
+            }
+            xSemaphoreGive(deviceConfig->xMutex);
+        }
+        sample.timestamp = macTelemetryNowMs();
+
+        xSemaphoreTake(state->lock, portMAX_DELAY);
+        if (ret == MSD_OK)
+            macTelemetryAddSample(state, &sample, cost);
+        else
+            state->status.skippedSamples++;
+        xSemaphoreGive(state->lock);
+    }
+}
+
+MSD_STATUS deviceMacTelemetryModuleStart(IN MSD_U8 devNum, IN const MacTelemetryConfig* config)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    MacTelemetryState* state = &s_macTelemetry[devNum];
+    MacTelemetryConfig newConfig = { MAC_TELEMETRY_DEFAULT_INTERVAL_MS, MAC_TELEMETRY_DEFAULT_FLAP_WINDOW_MS, MAC_TELEMETRY_DEFAULT_FLAP_THRESHOLD };
+    if (config != NULL) {
+        if (config->intervalMs != 0)
+            newConfig.intervalMs = config->intervalMs;
+        if (config->flapWindowMs != 0)
+            newConfig.flapWindowMs = config->flapWindowMs;
+        if (config->flapThreshold != 0)
+            newConfig.flapThreshold = config->flapThreshold;
+    }
+    if (state->lock == NULL) {
+        state->lock = xSemaphoreCreateMutex();
+        if (state->lock == NULL)
+            return MSD_FAIL;
+    }
+
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    msdMemSet(&state->status, 0, sizeof(MacTelemetryStatus));
+    msdMemSet(state->flaps, 0, sizeof(state->flaps));
+    state->historyHead = 0;
+    state->historyCount = 0;
+    state->totalSampleCost = 0;
+    state->devNum = devNum;
+    state->status.config = newConfig;
+    state->status.portCount = dev->numOfPorts > MSD_MAX_SWITCH_PORTS ? MSD_MAX_SWITCH_PORTS : dev->numOfPorts;
+    state->status.isRunning = MSD_TRUE;
+    xSemaphoreGive(state->lock);
+
+    if (state->taskHandle == NULL) {
+        if (xTaskCreate(macTelemetryTaskProc, "macTelemetry", MAC_TELEMETRY_TASK_STACK_SIZE, state, MAC_TELEMETRY_TASK_PRIORITY, &state->taskHandle) != pdPASS) {
+            state->taskHandle = NULL;
+            state->status.isRunning = MSD_FALSE;
+            MSD_DBG_ERROR(("deviceMacTelemetryModuleStart create task failed\n"));
+            return MSD_FAIL;
+        }
+    }
+    else {
+        xTaskNotifyGive(state->taskHandle);
+    }
+    return MSD_OK;
+}
+
+MSD_STATUS deviceMacTelemetryModuleStop(IN MSD_U8 devNum)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    MacTelemetryState* state = &s_macTelemetry[devNum];
+    if (state->lock == NULL)
+        return MSD_OK;
+    //先拿到设备锁和统计锁再删除采样任务：任务不会持有这两个锁，也不会正在访问交换机，
+    //initCloseDevice之后删除设备锁时任务已经不存在
+    SemaphoreHandle_t deviceMutex = state->taskHandle != NULL ? g_allDevicesConfig[devNum].xMutex : NULL;
+    if (deviceMutex != NULL)
+        xSemaphoreTake(deviceMutex, portMAX_DELAY);
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    state->status.isRunning = MSD_FALSE;
+    if (state->taskHandle != NULL) {
+        vTaskDelete(state->taskHandle);
+        state->taskHandle = NULL;
+    }
+    xSemaphoreGive(state->lock);
+    if (deviceMutex != NULL)
+        xSemaphoreGive(deviceMutex);
+    return MSD_OK;
+}
+
+/**
+ * @brief macTelemetryFindFlap 查找MAC地址的跟踪项，不存在时返回空项或者最久没有出现的项
+ */
+static MacFlapEntry* macTelemetryFindFlap(IN MacTelemetryState* state, IN const MSD_ETHERADDR* macAddr, IN MSD_U16 fid, IN MSD_U32 now, OUT MSD_BOOL* isFound)
+{
+    MacFlapEntry* victim = &state->flaps[0];
+    for (int i = 0; i < MAC_TELEMETRY_FLAP_TABLE_SIZE; ++i) {
+        MacFlapEntry* entry = &state->flaps[i];
+        if (entry->portVec == 0) {
+            if (victim->portVec != 0)
+                victim = entry;
+            continue;
+        }
+        if (entry->fid == fid && MAC_IS_EQUAL(entry->macAddr, *macAddr)) {
+            *isFound = MSD_TRUE;
+            return entry;
+        }
+        if (victim->portVec != 0 && now - entry->lastSeen > now - victim->lastSeen)
+            victim = entry;
+    }
+    *isFound = MSD_FALSE;
+    return victim;
+}
+
+/**
+ * @brief macTelemetryTrackMove 记录MAC地址在某个端口上出现，判定窗口内端口切换达到阈值时判定为漂移
+ */
+static void macTelemetryTrackMove(IN MacTelemetryState* state, IN const MSD_ATU_INT_STATUS* atuIntStatus, IN MSD_U32 now)
+{
+    const MacTelemetryConfig* config = &state->status.config;
+    MSD_BOOL isFound = MSD_FALSE;
+    MacFlapEntry* entry = macTelemetryFindFlap(state, &atuIntStatus->macAddr, atuIntStatus->fid, now, &isFound);
+    if (!isFound) {
+        msdMemSet(entry, 0, sizeof(MacFlapEntry));
+        msdMemCpy(entry->macAddr.arEther, atuIntStatus->macAddr.arEther, MSD_ETHERNET_HEADER_SIZE);
+        entry->fid = atuIntStatus->fid;
+        entry->lastPort = atuIntStatus->spid;
+        entry->portVec = (MSD_U16)(1U << atuIntStatus->spid);
+        entry->windowStart = now;
+        entry->lastSeen = now;
+        return;
+    }
+    if (now - entry->windowStart > config->flapWindowMs) {//开始新的判定窗口
+        entry->windowStart = now;
+        entry->moveCount = 0;
+        entry->portVec = (MSD_U16)(1U << entry->lastPort);
+        entry->isFlapping = MSD_FALSE;
+    }
+    entry->lastSeen = now;
+    if (entry->lastPort == atuIntStatus->spid)
+        return;
+    entry->lastPort = atuIntStatus->spid;
+    entry->portVec |= (MSD_U16)(1U << atuIntStatus->spid);
+    entry->moveCount++;
+    state->status.moveCount++;
+    if (!entry->isFlapping && entry->moveCount >= config->flapThreshold) {
+        entry->isFlapping = MSD_TRUE;
+        state->status.flapEvents++;
+        MSD_DBG_ERROR(("MAC %02x:%02x:%02x:%02x:%02x:%02x fid %d flapping, %d moves, port vector 0x%x\n",
+                       entry->macAddr.arEther[0], entry->macAddr.arEther[1], entry->macAddr.arEther[2],
+                       entry->macAddr.arEther[3], entry->macAddr.arEther[4], entry->macAddr.arEther[5],
+                       entry->fid, entry->moveCount, entry->portVec));
+    }
+}
+
+MSD_STATUS deviceMacTelemetryModuleRecordViolation(IN MSD_U8 devNum, IN const MSD_ATU_INT_STATUS* atuIntStatus)
+{
+    if (devNum > (MSD_U8)(MAX_SOHO_DEVICES - 1) || atuIntStatus == NULL)
+        return MSD_BAD_PARAM;
+    MacTelemetryState* state = &s_macTelemetry[devNum];
+    if (state->lock == NULL)//没有开始统计
+        return MSD_OK;
+    MSD_U32 now = macTelemetryNowMs();
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    MacTelemetryStatus* status = &state->status;
+    if (status->isRunning) {
+        MSD_BOOL isPortValid = atuIntStatus->spid < status->portCount ? MSD_TRUE : MSD_FALSE;
+        if (atuIntStatus->atuIntCause.memberVio) {
+            status->memberViolations++;
+            if (isPortValid) {
+                status->ports[atuIntStatus->spid].memberViolations++;
+                macTelemetryTrackMove(state, atuIntStatus, now);
+            }
+        }
+        if (atuIntStatus->atuIntCause.missVio)
+            status->missViolations++;
+        if (atuIntStatus->atuIntCause.fullVio)
+            status->fullViolations++;
+        if (atuIntStatus->atuIntCause.ageOutVio) {
+            status->ageOutViolations++;
+            if (isPortValid)
+                status->ports[atuIntStatus->spid].ageOutViolations++;
+        }
+    }
+    xSemaphoreGive(state->lock);
+    return MSD_OK;
+}
+
+MSD_STATUS deviceMacTelemetryModuleGetStatus(IN MSD_U8 devNum, OUT MacTelemetryStatus* status)
+{
+    if (devNum > (MSD_U8)(MAX_SOHO_DEVICES - 1) || status == NULL)
+        return MSD_BAD_PARAM;
+    MacTelemetryState* state = &s_macTelemetry[devNum];
+    if (state->lock == NULL) {
+        msdMemSet(status, 0, sizeof(MacTelemetryStatus));
+        return MSD_OK;
+    }
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    *status = state->status;
+    if (status->sampleCount > 0)
+        status->avgSampleCost = state->totalSampleCost / status->sampleCount;
+    //学习速率:历史窗口内学习计数增加的总数换算为每分钟
+    if (state->historyCount > 1) {
+        MSD_U32 first = (state->historyHead + MAC_TELEMETRY_HISTORY_SIZE - state->historyCount) % MAC_TELEMETRY_HISTORY_SIZE;
+        MSD_U32 last = (state->historyHead + MAC_TELEMETRY_HISTORY_SIZE - 1) % MAC_TELEMETRY_HISTORY_SIZE;
+        MSD_U32 elapsed = state->history[last].timestamp - state->history[first].timestamp;
+        for (MSD_U8 port = 0; port < status->portCount && elapsed > 0; ++port) {
+            MSD_U32 learned = 0;
+            for (MSD_U32 i = 1, prev = first; i < state->historyCount; ++i) {
+                MSD_U32 cur = (prev + 1) % MAC_TELEMETRY_HISTORY_SIZE;
+                if (state->history[cur].learnCount[port] > state->history[prev].learnCount[port])
+                    learned += state->history[cur].learnCount[port] - state->history[prev].learnCount[port];
+                prev = cur;
+            }
+            MSD_U32 rate = (MSD_U32)(((MSD_U64)learned * 60000U) / elapsed);
+            status->ports[port].learnRate = rate > 0xFFFF ? 0xFFFF : (MSD_U16)rate;
+        }
+    }
+    xSemaphoreGive(state->lock);
+    return MSD_OK;
+}
+
+MSD_STATUS deviceMacTelemetryModuleGetHistory(IN MSD_U8 devNum, OUT MacTelemetrySample* samples, IN int samplesMaxSize, OUT int* samplesCount)
+{
+    if (devNum > (MSD_U8)(MAX_SOHO_DEVICES - 1) || samples == NULL || samplesCount == NULL || samplesMaxSize < 0)
+        return MSD_BAD_PARAM;
+    *samplesCount = 0;
+    MacTelemetryState* state = &s_macTelemetry[devNum];
+    if (state->lock == NULL)
+        return MSD_OK;
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    int count = state->historyCount < samplesMaxSize ? state->historyCount : samplesMaxSize;
+    //保留最新的count个采样
+    MSD_U32 index = (state->historyHead + MAC_TELEMETRY_HISTORY_SIZE - count) % MAC_TELEMETRY_HISTORY_SIZE;
+    for (int i = 0; i < count; ++i) {
+        samples[i] = state->history[index];
+        index = (index + 1) % MAC_TELEMETRY_HISTORY_SIZE;
+    }
+    *samplesCount = count;
+    xSemaphoreGive(state->lock);
+    return MSD_OK;
+}
+
+MSD_STATUS deviceMacTelemetryModuleGetFlaps(IN MSD_U8 devNum, OUT MacFlapEntry* entries, IN int entriesMaxSize, OUT int* entriesCount)
+{
+    if (devNum > (MSD_U8)(MAX_SOHO_DEVICES - 1) || entries == NULL || entriesCount == NULL || entriesMaxSize < 0)
+        return MSD_BAD_PARAM;
+    *entriesCount = 0;
+    MacTelemetryState* state = &s_macTelemetry[devNum];
+    if (state->lock == NULL)
+        return MSD_OK;
+    MSD_U32 now = macTelemetryNowMs();
+    xSemaphoreTake(state->lock, portMAX_DELAY);
+    for (int i = 0; i < MAC_TELEMETRY_FLAP_TABLE_SIZE && *entriesCount < entriesMaxSize; ++i) {
+        if (state->flaps[i].portVec == 0)
+            continue;
+        MacFlapEntry* entry = &entries[(*entriesCount)++];
+        *entry = state->flaps[i];
+        if (now - entry->windowStart > state->status.config.flapWindowMs)
+            entry->isFlapping = MSD_FALSE;
+    }
+    xSemaphoreGive(state->lock);
+    return MSD_OK;
+}
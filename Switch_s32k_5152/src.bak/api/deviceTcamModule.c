@@ -0,0 +1,221 @@
+#include <apiInit.h>
+#include <deviceTcamModule.h>
+#include <string.h>
+
+#define  TCAM_BITMAP_WORDS  (TCAM_MODULE_ENTRY_NUM / 32)
+#define  TCAM_OWNER_TAG(TYPE,ID)  ((MSD_U16)((((MSD_U16)(TYPE) & 0xF) << 12) | ((ID) & TCAM_MODULE_OWNER_ID_MAX)))
+#define  TCAM_OWNER_TAG_TYPE(TAG)  ((TcamOwnerType)(((TAG) >> 12) & 0xF))
+#define  TCAM_OWNER_TAG_ID(TAG)  ((MSD_U16)((TAG) & TCAM_MODULE_OWNER_ID_MAX))
+
+/**
+ * 每个设备的IngressTCAM分配表，调用者持有设备的互斥量
+ */
+typedef struct {
+    MSD_U32 usedBits[TCAM_BITMAP_WORDS];//已使用的条目，按位保存
+    MSD_U16 owner[TCAM_MODULE_ENTRY_NUM];//条目的所有者，高4位为TcamOwnerType，低12位为所有者编号
+    MSD_U32 allocCount;
+    MSD_U32 allocFailCount;
+    MSD_U32 rebuildOps;
+}TcamModuleState;
+
+static TcamModuleState s_tcamModule[MAX_SOHO_DEVICES];
+
+static MSD_BOOL tcamIsUsed(IN const TcamModuleState* state, IN MSD_U32 pointer)
+{
+    return (state->usedBits[pointer >> 5] & ((MSD_U32)1 << (pointer & 0x1F))) != 0 ? MSD_TRUE : MSD_FALSE;
+}
+
+static void tcamSetUsed(IN TcamModuleState* state, IN MSD_U32 pointer, IN MSD_U16 ownerTag)
+{
+    state->usedBits[pointer >> 5] |= ((MSD_U32)1 << (pointer & 0x1F));
+    state->owner[pointer] = ownerTag;
+}
+
+static void tcamSetFree(IN TcamModuleState* state, IN MSD_U32 pointer)
+{
+    state->usedBits[pointer >> 5] &= ~((MSD_U32)1 << (pointer & 0x1F));
+    state->owner[pointer] = TCAM_OWNER_TAG(TCAM_OWNER_FREE, 0);
+}
+
+/**
+ * @brief tcamFindFreeRange 在[start, end)中查找最小的count个连续未使用条目，整个字都已使用时跳过32个条目
+ * @return 连续条目的开始下标号，没有找到时返回-1
+ */
+static int tcamFindFreeRange(IN const TcamModuleState* state, IN MSD_U32 start, IN MSD_U32 end, IN int count)
+{
+    int run = 0;
+    MSD_U32 i = start;
+    while (i < end) {
+        if ((i & 0x1F) == 0 && state->usedBits[i >> 5] == 0xFFFFFFFF) {
+            run = 0;
+            i += 32;
+            continue;
+        }
+        if (tcamIsUsed(state, i)) {
+            run = 0;
+        }
+        else if (++run == count) {
+            return (int)(i + 1 - (MSD_U32)count);
+        }
+        ++i;
+    }
+    return -1;
+}
+
+MSD_STATUS deviceTcamModuleInitialTcamInfo(IN MSD_U8 devNum)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    TcamModuleState* state = &s_tcamModule[devNum];
+    msdMemSet(state, 0, sizeof(TcamModuleState));
+    //从最大的下标号开始Get Next，交换机返回下标号最小的有效条目，之后每次返回更大的有效条目，回绕或者没有更多条目时结束
+    MSD_TCAM_DATA tcamData;
+    MSD_U32 pointer = TCAM_MODULE_ENTRY_NUM - 1;
+    int lastPointer = -1;
+    MSD_STATUS ret = MSD_OK;
+    for (int i = 0; i < TCAM_MODULE_ENTRY_NUM; ++i) {
+        ret = msdTcamEntryGetNext(devNum, &pointer, &tcamData);
+        ++state->rebuildOps;
+        if (ret == MSD_NO_SUCH) {
+            ret = MSD_OK;
+            break;
+        }
+        if (ret != MSD_OK || pointer >= TCAM_MODULE_ENTRY_NUM || (int)pointer <= lastPointer) {
+            break;
+        }
+        tcamSetUsed(state, pointer, TCAM_OWNER_TAG(TCAM_OWNER_UNKNOWN, 0));
+        lastPointer = (int)pointer;
+    }
+    if (ret != MSD_OK) {
+        MSD_DBG_ERROR(("deviceTcamModuleInitialTcamInfo failed,the status is %d\n", ret));
+    }
+    return ret;
+}
+
+MSD_STATUS deviceTcamModuleReset(IN MSD_U8 devNum)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    TcamModuleState* state = &s_tcamModule[devNum];
+    msdMemSet(state->usedBits, 0, sizeof(state->usedBits));
+    msdMemSet(state->owner, 0, sizeof(state->owner));
+    return MSD_OK;
+}
+
+MSD_STATUS deviceTcamModuleAllocEntries(IN MSD_U8 devNum, IN TcamOwnerType ownerType, IN MSD_U16 ownerId,
+                                        IN MSD_U32 start, IN MSD_U32 end, IN int count, OUT MSD_U32* pointers)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (ownerType <= TCAM_OWNER_FREE || ownerType >= TCAM_OWNER_TYPE_NUM || ownerId > TCAM_MODULE_OWNER_ID_MAX) {
+        return MSD_BAD_PARAM;
+    }
+    if (end > TCAM_MODULE_ENTRY_NUM || start >= end || count <= 0 || pointers == NULL) {
+        return MSD_BAD_PARAM;
+    }
+    TcamModuleState* state = &s_tcamModule[devNum];
+    MSD_U16 ownerTag = TCAM_OWNER_TAG(ownerType, ownerId);
+    int first = tcamFindFreeRange(state, start, end, count);
+    if (first >= 0) {//有足够的连续条目
+        for (int i = 0; i < count; ++i) {
+            pointers[i] = (MSD_U32)first + (MSD_U32)i;
+            tcamSetUsed(state, pointers[i], ownerTag);
+        }
+        ++state->allocCount;
+        return MSD_OK;
+    }
+    //没有足够的连续条目，从小到大分配不连续的条目，先确认条目个数足够，避免分配一部分之后失败
+    int found = 0;
+    for (MSD_U32 i = start; i < end && found < count; ++i) {
+        if (!tcamIsUsed(state, i)) {
+            pointers[found++] = i;
+        }
+    }
+    if (found < count) {
+        ++state->allocFailCount;
+        return MSD_NO_SPACE;
+    }
+    for (int i = 0; i < count; ++i) {
+        tcamSetUsed(state, pointers[i], ownerTag);
+    }
+    ++state->allocCount;
+    return MSD_OK;
+}
+
+MSD_STATUS deviceTcamModuleReserveEntry(IN MSD_U8 devNum, IN MSD_U32 pointer, IN TcamOwnerType ownerType, IN MSD_U16 ownerId)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (pointer >= TCAM_MODULE_ENTRY_NUM || ownerType <= TCAM_OWNER_FREE || ownerType >= TCAM_OWNER_TYPE_NUM
+        || ownerId > TCAM_MODULE_OWNER_ID_MAX) {
+        return MSD_BAD_PARAM;
+    }
+    TcamModuleState* state = &s_tcamModule[devNum];
+    if (tcamIsUsed(state, pointer)) {
+        TcamOwnerType usedType = TCAM_OWNER_TAG_TYPE(state->owner[pointer]);
+        //初始化时已存在的条目可以被接管
+        if (usedType != ownerType && usedType != TCAM_OWNER_UNKNOWN) {
+            MSD_DBG_ERROR(("deviceTcamModuleReserveEntry failed,the tcam entry %u is used by owner %d!\n", (unsigned int)pointer, usedType));
+            return MSD_ALREADY_EXIST;
+        }
+    }
+    tcamSetUsed(state, pointer, TCAM_OWNER_TAG(ownerType, ownerId));
+    return MSD_OK;
+}
+
+MSD_STATUS deviceTcamModuleFreeEntries(IN MSD_U8 devNum, IN const MSD_U32* pointers, IN int count)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (pointers == NULL && count > 0) {
+        return MSD_BAD_PARAM;
+    }
+    TcamModuleState* state = &s_tcamModule[devNum];
+    for (int i = 0; i < count; ++i) {
+        if (pointers[i] >= TCAM_MODULE_ENTRY_NUM) {
+            return MSD_BAD_PARAM;
+        }
+        tcamSetFree(state, pointers[i]);
+    }
+    return MSD_OK;
+}
+
+MSD_STATUS deviceTcamModuleGetOwner(IN MSD_U8 devNum, IN MSD_U32 pointer, OUT TcamOwnerType* ownerType, OUT MSD_U16* ownerId)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (pointer >= TCAM_MODULE_ENTRY_NUM || ownerType == NULL || ownerId == NULL) {
+        return MSD_BAD_PARAM;
+    }
+    TcamModuleState* state = &s_tcamModule[devNum];
+    if (!tcamIsUsed(state, pointer)) {
+        *ownerType = TCAM_OWNER_FREE;
+        *ownerId = 0;
+    }
+    else {
+        *ownerType = TCAM_OWNER_TAG_TYPE(state->owner[pointer]);
+        *ownerId = TCAM_OWNER_TAG_ID(state->owner[pointer]);
+    }
+    return MSD_OK;
+}
+
+MSD_STATUS deviceTcamModuleGetUsage(IN MSD_U8 devNum, OUT TcamUsage* usage)
+{
+    CHECK_DEV_NUM_IS_CORRECT;
+    if (usage == NULL) {
+        return MSD_BAD_PARAM;
+    }
+    TcamModuleState* state = &s_tcamModule[devNum];
+    msdMemSet(usage, 0, sizeof(TcamUsage));
+    MSD_U16 freeRun = 0;
+    for (MSD_U32 i = 0; i < TCAM_MODULE_ENTRY_NUM; ++i) {
+        if (!tcamIsUsed(state, i)) {
+            ++usage->ownerCount[TCAM_OWNER_FREE];
+            if (++freeRun > usage->largestFreeRange) {
+                usage->largestFreeRange = freeRun;
+            }
+            continue;
+        }
+        freeRun = 0;
+        ++usage->usedCount;
+        ++usage->ownerCount[TCAM_OWNER_TAG_TYPE(state->owner[i])];
+    }
+    usage->allocCount = state->allocCount;
+    usage->allocFailCount = state->allocFailCount;
+    usage->rebuildOps = state->rebuildOps;
+    return MSD_OK;
+}
@@ -1,6 +1,8 @@
 #include <apiInit.h>
 #include <deviceVlanModule.h>
+#include <deviceTcamModule.h>
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <errno.h>
 #include <smiasscess.h>
@@ -10,7 +12,7 @@
 #define MSD_8021Q_MODEL_DEFAULT MSD_8021Q_FALLBACK  //默认使用802.1Q Fallback，后续可以更改为其他默认值
 #define DEFAULT_QINQ_TPID_VALUE 0x88a8  //默认的Provider Port的TPID值
 
-#define QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER 200 //QINQ VID 0的ingressTCAM
+#define QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER TCAM_MODULE_QINQ_START //QINQ VID 0的ingressTCAM
 
 //qinq 默认启用IngressTCAM的开始下标号，使用连续的标号来设置对应VLAN的出口方式 功能需要使用IngressTCAM和EgressTCAM来完成帧带标签或者去掉标签功能
 //注意，该值要足够大，因为TCAM查询时从下标号小的开始查询，由于小的编号用于实现过滤功能。需要留一些小的标号，如果需要支持更多的过滤器，则该编号需要设置更大一些
@@ -20,7 +22,14 @@
 #define QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_TAG_TCAM_POINTER  2 //QinQ模式下，带标签帧出口去除标签的的EgressTCAM的下标号
 #define QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_A_MEMBER_TCAM_POINTER 3 //QinQ模式下， 带标签帧不允许出口的EgressTCAM的下标号
 
-#define QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER 1 //QinQ模式下，无标签帧的EgressTCAM的出口条目TCAM ,其IngressTCAM的标号为265（201 + 64（VID的大小））
+#define QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER 1 //QinQ模式下，无标签帧的EgressTCAM的出口条目TCAM ,其IngressTCAM的标号为265（201 + QINQ_VLAN_TAG_FRAME_TCAM_NUM）
+
+#define QINQ_VLAN_TAG_FRAME_TCAM_NUM  64 //QinQ模式下标签帧使用的IngressTCAM个数(201 ~ 264)，即最多64个VID可以有端口Untagged出口，和ALLOW_OPERATION_MAX_VLAN_NUM无关
+#define QINQ_VLAN_INGRESS_TCAM_NUM  (QINQ_VLAN_TAG_FRAME_TCAM_NUM + 2) //QinQ使用的IngressTCAM个数(VID 0，每个VID，无标签帧)
+#define QINQ_VLAN_UNTAG_FRAME_INGRESS_TCAM_INDEX  (QINQ_VLAN_INGRESS_TCAM_NUM - 1) //无标签帧的IngressTCAM在QinqVlanImage中的下标
+#define QINQ_VLAN_EGRESS_TCAM_NUM  4 //QinQ使用的EgressTCAM下标号为1 ~ 3
+#define QINQ_VLAN_VALUE_UNSET  0xFF //QinqVlanImage中没有条目或者不设置
+#define VLAN_VTU_LOAD_CHUNK  64 //批量写入VTU条目时每次打包的条目个数，同时限制一次占用VTU寄存器的时间
 
 typedef struct {
     MSD_BOOL qModelIsGlobal;//所有端口是否使用同一种标签模式（MSD_TRUE:全部端口使用同一种模式，MSD_FALSE:端口使用不同的模式）
@@ -34,6 +43,33 @@ typedef struct {
 
 static VtuModuleInitType s_vtuModuleInitType[MAX_SOHO_DEVICES] = { 0 };
 
+/**
+ * @brief QinQ模式下由端口VLAN出口设置生成的交换机设置(QinQ的TCAM条目，VID 0的VTU条目和端口是否允许VID 0)
+ * 和上一次写入交换机的设置比较，只写入变化的部分
+ */
+typedef struct {
+    MSD_16 ingressVid[QINQ_VLAN_INGRESS_TCAM_NUM];//IngressTCAM(下标号从QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER开始)匹配的VID，UNVALID_VID为没有条目
+    MSD_U8 ingressEgAct[QINQ_VLAN_INGRESS_TCAM_NUM];//IngressTCAM的出口指针
+    MSD_U8 egressTag[QINQ_VLAN_EGRESS_TCAM_NUM][MSD_MAX_SWITCH_PORTS];//每个端口EgressTCAM的memberTag，QINQ_VLAN_VALUE_UNSET为没有条目
+    MSD_U8 allowVidZero[MSD_MAX_SWITCH_PORTS];//端口是否允许VID 0，QINQ_VLAN_VALUE_UNSET为不设置
+    MSD_BOOL hasVid0;//是否需要VID 0的VTU条目
+    MSD_BOOL isVid0Untagged[MSD_MAX_SWITCH_PORTS];//VID 0的VTU条目中memberTag为Untagged的端口
+}QinqVlanImage;
+
+/**
+ * @brief 设置VLAN出口方式的状态，调用者持有设备的互斥量
+ */
+typedef struct {
+    MSD_BOOL isSynced;//交换机和portVlanMemberTagInfo，applied是否一致，为MSD_FALSE时下一次设置需要清空之后重建
+    QinqVlanImage applied;//已经写入交换机的QinQ设置
+    QinqVlanImage target;//本次需要的QinQ设置
+    FIR_MSD_VTU_LOAD_WORDS vtuLoadWords[VLAN_VTU_LOAD_CHUNK];//等待批量写入的VTU条目(已转换为寄存器的值)
+    MSD_U16 vtuLoadIndex[VLAN_VTU_LOAD_CHUNK];//vtuLoadWords对应的VID在vlanInfo->vidInfo中的下标
+    VlanApplyStats stats;
+}VlanApplyState;
+
+static VlanApplyState s_vlanApplyState[MAX_SOHO_DEVICES];
+
 extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
 
 extern MSD_STATUS checkVlanEntry(IN MSD_U8 devNum, IN MSD_U16 vid, OUT MSD_BOOL* isAdd);
@@ -41,6 +77,109 @@ extern MSD_STATUS setFidValue(IN MSD_U8 devNum, IN MSD_U16 fid);
 extern MSD_STATUS deviceAtuModuleSetMacEntryVidFlagAndSize(IN MSD_U8 devNum, IN MSD_U16 vid_num, IN MSD_BOOL flag);
 
 
+/**
+ * @brief deviceVlanModuleInvalidateApplyState
+ * 清空VTU或者修改端口Q模式，802.1Q模式之后调用，下一次设置VLAN出口方式时清空之后重建
+ * @param devNum
+ */
+static void deviceVlanModuleInvalidateApplyState(IN MSD_U8 devNum)
+{
+    s_vlanApplyState[devNum].isSynced = MSD_FALSE;
+}
+
+/**
+ * @brief deviceVlanModuleVlanTableRank VID在vidInfo中的下标(VID不存在时为插入的位置)
+ * @param vlanInfo
+ * @param vid
+ * @return
+ */
+static int deviceVlanModuleVlanTableRank(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid)
+{
+    MSD_U32 lowBits = vlanInfo->vidBits[vid >> 5] & (((MSD_U32)1 << (vid & 0x1F)) - 1);//去掉不小于vid的位
+    return vlanInfo->rankBase[vid >> 5] + __builtin_popcount(lowBits);
+}
+
+/**
+ * @brief deviceVlanModulePackMemberTag 将所有端口的memberTag保存到VlanPerInfo.memberTags的格式
+ * @param memberTag
+ * @return
+ */
+static MSD_U32 deviceVlanModulePackMemberTag(IN const MSD_PORT_MEMBER_TAG* memberTag)
+{
+    MSD_U32 memberTags = 0;
+    for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+        VLAN_MEMBER_TAG_SET(memberTags, j, memberTag[j]);
+    }
+    return memberTags;
+}
+
+void deviceVlanModuleVlanTableReset(OUT VlanMemberTagAndEgressModeInfo* vlanInfo)
+{
+    msdMemSet(vlanInfo->vidBits, 0, sizeof(vlanInfo->vidBits));
+    msdMemSet(vlanInfo->rankBase, 0, sizeof(vlanInfo->rankBase));
+    msdMemSet(vlanInfo->vidInfo, 0, sizeof(vlanInfo->vidInfo));
+    vlanInfo->vidInfoSize = 0;
+}
+
+int deviceVlanModuleVlanTableFind(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid)
+{
+    if (vlanInfo == NULL || vid >= MAX_VID_VALUE) return -1;
+    if (((vlanInfo->vidBits[vid >> 5] >> (vid & 0x1F)) & 1U) == 0) return -1;
+    return deviceVlanModuleVlanTableRank(vlanInfo, vid);
+}
+
+MSD_STATUS deviceVlanModuleVlanTableSet(INOUT VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid,
+                                        IN const MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS], IN MSD_BOOL isShow)
+{
+    if (vlanInfo == NULL || memberTag == NULL || vid < PORT_DEFAULT_VID || vid > MAX_OPERATION_VID) {
+        return MSD_BAD_PARAM;
+    }
+    for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+        if (memberTag[j] < MSD_MEMBER_EGRESS_UNMODIFIED || memberTag[j] > MSD_NOT_A_MEMBER) {
+            return MSD_BAD_PARAM;
+        }
+    }
+    int index = deviceVlanModuleVlanTableRank(vlanInfo, vid);
+    MSD_U32 bit = (MSD_U32)1 << (vid & 0x1F);
+    if ((vlanInfo->vidBits[vid >> 5] & bit) == 0) {//不存在，插入到index，之后的记录后移
+        if (vlanInfo->vidInfoSize >= ALLOW_OPERATION_MAX_VLAN_NUM) {
+            return MSD_FEATRUE_NOT_ALLOW;
+        }
+        memmove(&vlanInfo->vidInfo[index + 1], &vlanInfo->vidInfo[index], (vlanInfo->vidInfoSize - (MSD_U32)index) * sizeof(VlanPerInfo));
+        vlanInfo->vidBits[vid >> 5] |= bit;
+        for (int w = (vid >> 5) + 1; w < VLAN_VID_BITMAP_WORDS; ++w) {
+            vlanInfo->rankBase[w]++;
+        }
+        vlanInfo->vidInfoSize++;
+    }
+    vlanInfo->vidInfo[index].vid = vid;
+    vlanInfo->vidInfo[index].isShow = isShow ? MSD_TRUE : MSD_FALSE;
+    vlanInfo->vidInfo[index].memberTags = deviceVlanModulePackMemberTag(memberTag);
+    return MSD_OK;
+}
+
+MSD_BOOL deviceVlanModuleVlanTableRemove(INOUT VlanMemberTagAndEgressModeInfo* vlanInfo, IN MSD_U16 vid)
+{
+    int index = deviceVlanModuleVlanTableFind(vlanInfo, vid);
+    if (index < 0) return MSD_FALSE;
+    memmove(&vlanInfo->vidInfo[index], &vlanInfo->vidInfo[index + 1], (vlanInfo->vidInfoSize - (MSD_U32)index - 1) * sizeof(VlanPerInfo));
+    vlanInfo->vidBits[vid >> 5] &= ~((MSD_U32)1 << (vid & 0x1F));
+    for (int w = (vid >> 5) + 1; w < VLAN_VID_BITMAP_WORDS; ++w) {
+        vlanInfo->rankBase[w]--;
+    }
+    vlanInfo->vidInfoSize--;
+    msdMemSet(&vlanInfo->vidInfo[vlanInfo->vidInfoSize], 0, sizeof(VlanPerInfo));
+    return MSD_TRUE;
+}
+
+void deviceVlanModuleVlanTableGetMemberTag(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN int index,
+                                           OUT MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS])
+{
+    for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+        memberTag[j] = VLAN_MEMBER_TAG_GET(vlanInfo->vidInfo[index].memberTags, j);
+    }
+}
+
 MSD_STATUS deviceVlanModuleGetVlanEgressMode(IN MSD_U8 devNum, OUT VlanEgressMode* vlanEgressMode) {
     for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; ++i) {
         vlanEgressMode[i] = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[i].egressMode;
@@ -59,11 +198,7 @@ MSD_STATUS deviceVlanModuleInitial(void)
             s_vtuModuleInitType[i].portQModel[j] = VLANMODEL_DISABLE;
             s_vtuModuleInitType[i].portVlanMemberTagInfo.portVlanInfo[j].egressMode = VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP;//允许指定的VLAN成员从端口出口
         }
-        for (int j = 0; j < ALLOW_OPERATION_MAX_VLAN_NUM; ++j) {
-            s_vtuModuleInitType[i].portVlanMemberTagInfo.vidInfo[j].vid = UNVALID_VID;
-            s_vtuModuleInitType[i].portVlanMemberTagInfo.vidInfo[j].isShow = MSD_FALSE;
-        }
-        s_vtuModuleInitType[i].portVlanMemberTagInfo.vidInfoSize = 0;
+        deviceVlanModuleVlanTableReset(&s_vtuModuleInitType[i].portVlanMemberTagInfo);
     }
     return MSD_OK;
 }
@@ -77,11 +212,6 @@ static void deviceVlanModuleInitialVlanConfigInfo(IN MSD_U8 devNum)
         s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[j].defaultVid = PORT_DEFAULT_VID;
         s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[j].egressMode = VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP;//允许指定的VLAN成员从端口出口
     }
-    for (int j = 0; j < ALLOW_OPERATION_MAX_VLAN_NUM; ++j) {
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[j].vid = UNVALID_VID;
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[j].isShow = MSD_FALSE;
-    }
-    s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize = 0;
 }
 
 /**
@@ -94,20 +224,23 @@ static MSD_STATUS deviceVlanModuleResetVlanInfo(IN MSD_U8 devNum)
 {
     MSD_STATUS status = deviceVlanModuleClearAllVlans(devNum);//清空所有VLAN
     if (status != MSD_OK) return status;
-    //添加VID 1  VID fff(Page 0 和 Page 1)
+    //添加VID 1  VID fff(Page 0 和 Page 1)，两个条目一次写入
+    MSD_QD_DEV* dev = sohoDevGet(devNum);
+    FIR_MSD_VTU_LOAD_WORDS loadWords[2];
     MSD_VTU_ENTRY vtuEntry;
     msdMemSet(&vtuEntry, 0, sizeof(MSD_VTU_ENTRY));
     vtuEntry.fid = (MSD_U16)1;
     vtuEntry.vid = (MSD_U16)1;
-    status = msdVlanEntryAdd(devNum, &vtuEntry);
+    status = Fir_gvtuPackEntryIntf(dev, &vtuEntry, &loadWords[0]);
     if (status != MSD_OK) return status;
     //设置VLAN 1 默认不能删除
     //device_atu_module_set_mac_entry_vid_flag_and_size(dev_num, 1, MSD_TRUE);
     vtuEntry.fid = (MSD_U16)0xfff;
     vtuEntry.vid = (MSD_U16)0xfff;
-    status = msdVlanEntryAdd(devNum, &vtuEntry);
+    status = Fir_gvtuPackEntryIntf(dev, &vtuEntry, &loadWords[1]);
+    if (status != MSD_OK) return status;
     //暂时不考虑Page 1的VID fff的条目
-    return status;
+    return Fir_gvtuLoadEntries(dev, loadWords, 2);
 }
 
 /**
@@ -230,38 +363,13 @@ static void copyFirVtuEntryToQVtuEntry(IN FirVlanEntry* qVtuEntry,IN FIR_MSD_VTU
 
 /**
  * @brief deviceVlanModuleAddOrModifyOneVidMemberTagInfo
- * 添加或者修改一个VTU条目的vid和memberTag到全局参数的相应下标中。
+ * 添加或者修改一个VTU条目的vid和memberTag到全局参数中，已经达到最大VID数目时不保存
  * @param devNum 设备编号
  * @param vtuEntry 要添加的VTU条目
- * @return 如果设置成功返回MSD_TRUE,如果没有下标可以存储，则返回MSD_FALSE
  */
 static void deviceVlanModuleAddOrModifyOneVidMemberTagInfo(IN MSD_U8 devNum, IN MSD_VTU_ENTRY* vtuEntry)
 {
-    int index = -1; //存储下标
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        int tempVid = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].vid;
-        if (tempVid == vtuEntry->vid) {//存在，则修改
-            index = i;
-            break;
-        }
-    }
-    if (index == -1) { //条目中不存在，则找到一个位置
-        for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-            int tempVid = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].vid;
-            if (tempVid == UNVALID_VID) {
-                s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize++;
-                index = i;
-                break;
-            }
-        }
-    }
-    if(index != -1){//找到存储VID的下标
-        for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
-            s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[index].memberTag[j] = vtuEntry->memberTagP[j];
-        }
-        s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[index].vid = vtuEntry->vid;
-        s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[index].isShow = MSD_TRUE;
-    }
+    deviceVlanModuleVlanTableSet(&s_vtuModuleInitType[devNum].portVlanMemberTagInfo, vtuEntry->vid, vtuEntry->memberTagP, MSD_TRUE);
 }
 
 MSD_STATUS deviceVlanModuleAddOrModifyVlan(IN MSD_U8 devNum, IN FirVlanEntry* vtuEntry)
@@ -282,7 +390,7 @@ MSD_STATUS deviceVlanModuleAddOrModifyVlan(IN MSD_U8 devNum, IN FirVlanEntry* vt
     if(ret != MSD_OK){
         return ret;
     }
-    if (!isExists && s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize == ALLOW_OPERATION_MAX_VLAN_NUM) {
+    if (!isExists && s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize >= ALLOW_OPERATION_MAX_VLAN_NUM) {
         MSD_DBG_ERROR(("device_vlan_module_add_or_modify_vlan failed, because operation vtu_entry numer is reach the max:%d\n", ALLOW_OPERATION_MAX_VLAN_NUM));
         return MSD_FEATRUE_NOT_ALLOW;
     }
@@ -303,13 +411,7 @@ MSD_STATUS deviceVlanModuleAddOrModifyVlan(IN MSD_U8 devNum, IN FirVlanEntry* vt
  */
 static void deviceVlanModuleRemoveOneVidMemberTagInfo(IN int devNum, IN int vlanId)
 {
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        int tempVid = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].vid;
-        if (tempVid == vlanId) {//找到条目
-            s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].vid = UNVALID_VID;//设置为无效项目
-            s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize--;
-        }
-    }
+    deviceVlanModuleVlanTableRemove(&s_vtuModuleInitType[devNum].portVlanMemberTagInfo, (MSD_U16)vlanId);
 }
 
 MSD_STATUS deviceVlanModuleDelVlan(IN MSD_U8 devNum, IN MSD_U16 vlanId)
@@ -339,23 +441,17 @@ MSD_STATUS deviceVlanModuleDelVlan(IN MSD_U8 devNum, IN MSD_U16 vlanId)
  */
 static void deviceVlanModuleResetAllVidMemberTagInfo(IN MSD_U8 devNum)
 {
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].vid = UNVALID_VID;
-        s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].isShow = MSD_FALSE;
-        for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
-            s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].memberTag[j] = MSD_MEMBER_EGRESS_UNMODIFIED;//默认帧不修改方式出口端口
-        }
-    }
+    deviceVlanModuleVlanTableReset(&s_vtuModuleInitType[devNum].portVlanMemberTagInfo);
     for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; ++i) {
         s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[i].egressMode = VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP;//默认允许所有VID的帧出口该端口
         s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[i].defaultVid = PORT_DEFAULT_VID;
     }
-    s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize = 0;
 }
 
 MSD_STATUS deviceVlanModuleClearAllVlans(IN MSD_U8 devNum)
 {
 	CHECK_DEV_NUM_IS_CORRECT;
+    deviceVlanModuleInvalidateApplyState(devNum);
     MSD_STATUS ret = msdVlanAllDelete(devNum);
     if (ret == MSD_OK) {
         deviceVlanModuleResetAllVidMemberTagInfo(devNum);
@@ -496,6 +592,7 @@ static MSD_STATUS deviceVlanModuleSetQModelInPort(IN MSD_U8 devNum, IN int portN
 
     MSD_STATUS ret = MSD_OK;
     MSD_BOOL isGlobal = s_vtuModuleInitType[devNum].qModelIsGlobal;
+    deviceVlanModuleInvalidateApplyState(devNum);//会修改802.1Q模式，默认VID和是否允许VID 0
     do {
         MSD_8021Q_MODE mode8021;
         if (s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo->egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
@@ -878,6 +975,7 @@ MSD_STATUS deviceVlanModuleSet8021Mode(IN MSD_U8 devNum, IN int portNum, IN MSD_
     }
     //设置
     MSD_STATUS ret = MSD_OK;
+    deviceVlanModuleInvalidateApplyState(devNum);
     do {
         if (mode8021 == MSD_8021Q_DISABLE) {
             if (s_vtuModuleInitType[devNum].qModelIsGlobal) {//全局标签模式
@@ -1036,25 +1134,13 @@ MSD_STATUS deviceVlanModuleGetInitailPriAndTagIfBoth(IN MSD_U8 devNum, IN MSD_U8
 }
 /**
  * @brief copyValidPortVlanMemberTagInfo
- * 将src中有效的VID memberTag条目拷贝到dest中的最前面，即最前面都是有效的VID对应的memberTag。
+ * 将src拷贝到dest中，VID记录已经按VID排列在最前面，即最前面都是有效的VID对应的memberTag。
  * @param dest
  * @param src
  */
-static void copyValidPortVlanMemberTagInfo(OUT VlanMemberTagAndEgressModeInfo* dest, IN VlanMemberTagAndEgressModeInfo* src)
+static void copyValidPortVlanMemberTagInfo(OUT VlanMemberTagAndEgressModeInfo* dest, IN const VlanMemberTagAndEgressModeInfo* src)
 {
-    msdMemSet(dest, 0, sizeof(VlanMemberTagAndEgressModeInfo));
-    dest->vidInfoSize = src->vidInfoSize;
-    for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; ++i) {
-        dest->portVlanInfo[i].egressMode = src->portVlanInfo[i].egressMode;
-        dest->portVlanInfo[i].defaultVid = src->portVlanInfo[i].defaultVid;
-    }
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        dest->vidInfo[i].vid = src->vidInfo[i].vid;
-        for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; j++) {
-            dest->vidInfo[i].memberTag[j] = src->vidInfo[i].memberTag[j];
-        }
-        dest->vidInfo[i].isShow = src->vidInfo[i].isShow;
-    }
+    *dest = *src;
 }
 /**
  * @brief isVidTagInfoHasExist 判断member_tag信息表中是否存在指定的vid的member_tag信息
@@ -1105,6 +1191,18 @@ static MSD_BOOL checkEesVlanInfoIsValid(IN int portNum, IN VlanMemberTagAndEgres
     if(allPortVlanMemberTag == NULL) return MSD_FALSE;
     int vidSize = allPortVlanMemberTag->vidInfoSize;
     if(vidSize > ALLOW_OPERATION_MAX_VLAN_NUM || vidSize < 0) return MSD_FALSE; //vid size 为0 可以
+    int vidCount = 0;//VID位图和索引需要与VID记录一致
+    for (int w = 0; w < VLAN_VID_BITMAP_WORDS; ++w) {
+        if (allPortVlanMemberTag->rankBase[w] != vidCount) {
+            MSD_DBG_ERROR(("check_ees_vlan_info_is_valid failed,the vid index is not match the vid bitmap!\n"));
+            return MSD_FALSE;
+        }
+        vidCount += __builtin_popcount(allPortVlanMemberTag->vidBits[w]);
+    }
+    if (vidCount != vidSize) {
+        MSD_DBG_ERROR(("check_ees_vlan_info_is_valid failed,the vid bitmap is not match the vid size!\n"));
+        return MSD_FALSE;
+    }
     for (int i = 1; i < portNum; ++i) {
         if (allPortVlanMemberTag->portVlanInfo[i].defaultVid < PORT_DEFAULT_VID || allPortVlanMemberTag->portVlanInfo[i].defaultVid > MAX_OPERATION_VID) {
             MSD_DBG_ERROR(("check_ees_vlan_info_is_valid failed,the default_vid param is out of range!\n"));
@@ -1117,15 +1215,15 @@ static MSD_BOOL checkEesVlanInfoIsValid(IN int portNum, IN VlanMemberTagAndEgres
     }
 
     for (int i = 0; i < vidSize; ++i) {
-        if (allPortVlanMemberTag->vidInfo[i].vid < PORT_DEFAULT_VID || allPortVlanMemberTag->vidInfo[i].vid > MAX_OPERATION_VID) {
+        MSD_U16 vid = allPortVlanMemberTag->vidInfo[i].vid;
+        if (vid < PORT_DEFAULT_VID || vid > MAX_OPERATION_VID) {
             MSD_DBG_ERROR(("check_ees_vlan_info_is_valid failed,the vid param is out of range!\n"));
             return MSD_FALSE;
         }
-        for (int j = 0; j < portNum; ++j) {
-            if (allPortVlanMemberTag->vidInfo[i].memberTag[j] < MSD_MEMBER_EGRESS_UNMODIFIED || allPortVlanMemberTag->vidInfo[i].memberTag[j] > MSD_NOT_A_MEMBER) {
-                MSD_DBG_ERROR(("check_ees_vlan_info_is_valid failed,the member_tag param is out of range!\n"));
-                return MSD_FALSE;
-            }
+        //VID记录按VID从小到大排列，并且在位图中(位图中VID的个数和记录的个数相同，因此位图和记录一致)
+        if ((i > 0 && vid <= allPortVlanMemberTag->vidInfo[i - 1].vid) || deviceVlanModuleVlanTableFind(allPortVlanMemberTag, vid) != i) {
+            MSD_DBG_ERROR(("check_ees_vlan_info_is_valid failed,the vid records is not sorted or not match the vid bitmap!\n"));
+            return MSD_FALSE;
         }
     }
     return MSD_TRUE;
@@ -1133,107 +1231,270 @@ static MSD_BOOL checkEesVlanInfoIsValid(IN int portNum, IN VlanMemberTagAndEgres
 
 /**
  * @brief deviceVlanModuleClearQinqVlanIngressAndEgressTcam
- *  清除所有与QinQ VLAN相关的IngressTCAM和EgressTCAM条目
+ *  清除所有与QinQ VLAN相关的IngressTCAM和EgressTCAM条目，分配表中没有使用的IngressTCAM条目不删除
  * @param devNum
+ * @param stats 累加实际删除的IngressTCAM和EgressTCAM条目个数
  * @return
  */
-static MSD_STATUS deviceVlanModuleClearQinqVlanIngressAndEgressTcam(IN MSD_U8 devNum)
+static MSD_STATUS deviceVlanModuleClearQinqVlanIngressAndEgressTcam(IN MSD_U8 devNum, INOUT VlanApplyStats* stats)
 {
-    int end = QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER + ALLOW_OPERATION_MAX_VLAN_NUM + 1;//前面用于表示所有VLAN相关(包括VID 0的优先级帧)的IngressTCAM,最后一条为qinq模式下，无标签帧匹配的IngressTCAM
+    int end = QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER + QINQ_VLAN_TAG_FRAME_TCAM_NUM + 1;//前面用于表示所有VLAN相关(包括VID 0的优先级帧)的IngressTCAM,最后一条为qinq模式下，无标签帧匹配的IngressTCAM
     MSD_STATUS ret = MSD_OK;
     for (int i = QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER; i <= end; ++i) {
+        MSD_U32 pointer = (MSD_U32)i;
+        TcamOwnerType ownerType;
+        MSD_U16 ownerId;
+        ret = deviceTcamModuleGetOwner(devNum, pointer, &ownerType, &ownerId);
+        if (ret != MSD_OK) return ret;
+        if (ownerType == TCAM_OWNER_FREE) continue;//分配表和交换机一致，没有使用的条目不需要删除
         ret = msdTcamEntryDelete(devNum, i);
-        if (ret != MSD_OK) break;
+        if (ret != MSD_OK) return ret;
+        deviceTcamModuleFreeEntries(devNum, &pointer, 1);
+        stats->ingressTcamDeletes++;
     }
     //删除出口条目
-    ret = msdEgrTcamEntryAllPortsDelete(devNum, QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER);
-    if (ret != MSD_OK) return ret;
-    ret = msdEgrTcamEntryAllPortsDelete(devNum, QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_A_MEMBER_TCAM_POINTER);
-    if (ret != MSD_OK) return ret;
-    ret = msdEgrTcamEntryAllPortsDelete(devNum, QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_TAG_TCAM_POINTER);
+    const MSD_U8 egressPointers[] = {
+        QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER,
+        QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_A_MEMBER_TCAM_POINTER,
+        QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_TAG_TCAM_POINTER
+    };
+    for (size_t i = 0; i < sizeof(egressPointers) / sizeof(egressPointers[0]); ++i) {
+        ret = msdEgrTcamEntryAllPortsDelete(devNum, egressPointers[i]);
+        if (ret != MSD_OK) return ret;
+        stats->egressTcamDeletes++;
+    }
     return ret;
 }
 
 /**
- * @brief deviceVlanModuleSetQinqVlanTagFramHandleTag
+ * @brief deviceVlanModuleResetQinqVlanImage 清空QinQ设置，即没有任何TCAM条目，没有VID 0
+ * @param image
+ */
+static void deviceVlanModuleResetQinqVlanImage(OUT QinqVlanImage* image)
+{
+    for (int i = 0; i < QINQ_VLAN_INGRESS_TCAM_NUM; ++i) {
+        image->ingressVid[i] = UNVALID_VID;
+        image->ingressEgAct[i] = 0;
+    }
+    msdMemSet(image->egressTag, QINQ_VLAN_VALUE_UNSET, sizeof(image->egressTag));
+    msdMemSet(image->allowVidZero, QINQ_VLAN_VALUE_UNSET, sizeof(image->allowVidZero));
+    image->hasVid0 = MSD_FALSE;
+    for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+        image->isVid0Untagged[j] = MSD_FALSE;
+    }
+}
+
+/**
+ * @brief deviceVlanModuleSetQinqImageTagFrame
  * 通过IngressTCAM和EgressTCAM实现移除标签帧的标签。QinQ不能通过设置VLAN memberTag来移除标签
  * 注：默认Provider Port在出口是带标签的。即使不带标签帧进入时出口时也是带DefaultVID的标签
- * @param devNum 设备编号
+ * IngressTCAM条目已经存在时不修改，只添加出口条目
+ * @param image
+ * @param index IngressTCAM在image中的下标
  * @param vid 要设置的VID
- * @param tcamNumber IngressTCAM pointer
  * @param memberTag 指定VID 某端口的memberTag
  * @param egressPorts
- * @return
+ * @param portNum 端口个数
  */
-static MSD_STATUS deviceVlanModuleSetQinqVlanTagFramHandleTag(IN MSD_U8 devNum,IN MSD_U16 vid, IN int tcamNumber, MSD_PORT_MEMBER_TAG memberTag, IN MSD_BOOL *egressPorts)
+static void deviceVlanModuleSetQinqImageTagFrame(INOUT QinqVlanImage* image, IN int index, IN MSD_16 vid, IN MSD_PORT_MEMBER_TAG memberTag,
+                                                 IN const MSD_BOOL* egressPorts, IN int portNum)
 {
-    MSD_TCAM_DATA tcamData;
-    msdMemSet(&tcamData, 0, sizeof(MSD_TCAM_DATA));
-    MSD_BOOL isFound = MSD_FALSE;
-    MSD_STATUS  ret = msdTcamEntryFind(devNum, tcamNumber, &tcamData, &isFound);
-    if (ret != MSD_OK) return ret;
-    MSD_QD_DEV* dev = sohoDevGet(devNum);
-    int num = dev->numOfPorts;
-
-    int egressTcamPointer = 0;//默认不设置出口
-
+    MSD_U8 egressTcamPointer = 0;//默认不设置出口
     if (memberTag == MSD_NOT_A_MEMBER) {
         egressTcamPointer = QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_A_MEMBER_TCAM_POINTER;
     }
-    else if(memberTag == MSD_MEMBER_EGRESS_UNTAGGED){
+    else if (memberTag == MSD_MEMBER_EGRESS_UNTAGGED) {
         egressTcamPointer = QINQ_VLAN_FOR_TAG_FRAME_EGRESS_NOT_TAG_TCAM_POINTER;//出口不带标签处理
     }
-
-    if (!isFound) {
-        MSD_BOOL ingressPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };
-        for (int i = 1; i < num; ++i) {//从Port 1开始设置，Port 0暂时不设置
-            ingressPorts[i] = MSD_TRUE;
+    if (image->ingressVid[index] == UNVALID_VID) {
+        image->ingressVid[index] = vid;
+        image->ingressEgAct[index] = egressTcamPointer;//设置入口条目的出口指针
+    }
+    for (int i = 1; i < portNum; ++i) {
+        if (egressPorts[i]) {
+            image->egressTag[egressTcamPointer][i] = (MSD_U8)memberTag;
         }
-        MSD_U16 ingressPortVec = (MSD_U16)boolarrayToInt(ingressPorts, num);//
-        tcamData.frameTypeMask = 0x3;//启用
-        tcamData.spvMask = (MSD_U16)~ingressPortVec;
-        tcamData.frameType = 0x2;//Provider Tag Frame
-        tcamData.pvid = vid;
-        tcamData.pvidMask = (MSD_U16)0xffff;
+    }
+}
 
-        tcamData.egActPoint = egressTcamPointer;//设置入口条目的出口指针
+/**
+ * @brief deviceVlanModuleSetQinqImageUntagFrame
+ * 无标签帧，使用IngressTCAM和EgressTCAM实现VLAN出口的处理，如果之前已存在相应的EgressTCAM条目，则直接替换。
+ * @param image
+ * @param memberTag 不带标签出口以何种方式（带标签，不带标签，不变化）
+ * @param egressPorts 出口条目的使用的端口列表集合
+ * @param portNum 端口个数
+ */
+static void deviceVlanModuleSetQinqImageUntagFrame(INOUT QinqVlanImage* image, IN MSD_PORT_MEMBER_TAG memberTag, IN const MSD_BOOL* egressPorts, IN int portNum)
+{
+    image->ingressVid[QINQ_VLAN_UNTAG_FRAME_INGRESS_TCAM_INDEX] = 0;
+    image->ingressEgAct[QINQ_VLAN_UNTAG_FRAME_INGRESS_TCAM_INDEX] = QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER;
+    for (int i = 1; i < portNum; ++i) {
+        if (egressPorts[i]) {
+            image->egressTag[QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER][i] = (MSD_U8)memberTag;
+        }
+    }
+}
 
-        ret = msdTcamEntryAdd(devNum, tcamNumber, &tcamData);
+/**
+ * @brief deviceVlanModuleGetApplyMemberTag 获取VID写入VTU条目的memberTag
+ * @param vlanInfo
+ * @param index VID在vlanInfo->vidInfo中的下标
+ * @param portNum 端口个数
+ * @param memberTag
+ */
+static void deviceVlanModuleGetApplyMemberTag(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN int index, IN int portNum, OUT MSD_PORT_MEMBER_TAG* memberTag)
+{
+    for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+        memberTag[j] = MSD_MEMBER_EGRESS_UNMODIFIED;//Port 0暂时不设置
+    }
+    for (int j = 1; j < portNum; ++j) {//vlan table 列
+        memberTag[j] = VLAN_MEMBER_TAG_GET(vlanInfo->vidInfo[index].memberTags, j);
+        //如果Port j允许所有VLAN帧出口，则需要将其非成员设置不加修改的方式传输帧
+        if (memberTag[j] == MSD_NOT_A_MEMBER
+            && vlanInfo->portVlanInfo[j].egressMode == VLAN_EGRESS_MODE_ALLOW_ALL) {
+            memberTag[j] = MSD_MEMBER_EGRESS_UNMODIFIED;
+        }
     }
-    else {
+}
 
+/**
+ * @brief deviceVlanModuleBuildQinqVlanImage 根据端口VLAN出口设置生成QinQ模式需要的交换机设置
+ * @param vlanInfo
+ * @param portNum 端口个数
+ * @param image
+ * @return
+ * MSD_OK - on success
+ * MSD_FEATRUE_NOT_ALLOW - 有端口Untagged出口的VID超过QINQ_VLAN_TAG_FRAME_TCAM_NUM个
+ */
+static MSD_STATUS deviceVlanModuleBuildQinqVlanImage(IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN int portNum, OUT QinqVlanImage* image)
+{
+    deviceVlanModuleResetQinqVlanImage(image);
+    //如果有ALL_MEMBER_SHIP的端口，添加VID 0
+    for (int i = 0; i < portNum; i++) {
+        if (vlanInfo->portVlanInfo[i].egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
+            image->hasVid0 = MSD_TRUE;
+        }
     }
-    if (ret != MSD_OK) return ret;
+    MSD_BOOL isPortDefaultVidUnset[MSD_MAX_SWITCH_PORTS];//记录端口是否被设置了默认VID
+    for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; ++i) {
+        isPortDefaultVidUnset[i] = MSD_TRUE;
+    }
+    MSD_BOOL qinqModelUntagFrameTaggedMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE}; //qinq 无标签帧带标签出口的集合
+    MSD_BOOL qinqModelUntagFrameUntaggedMemberPorts[MSD_MAX_SWITCH_PORTS] = {MSD_FALSE}; //qinq 无标签帧移除标签出口的集合
+    MSD_BOOL isSetUntaggedMember = MSD_FALSE;
+    MSD_BOOL qinqModelUntagFrameUnmodifiedMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };//qinq 无标签帧标签出口的集合(和untagged处理有一定的区别)
+    MSD_BOOL qinqModelDefaultTagFrameNotMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };//QINQ 默认VID，出口非成员的设置
+    MSD_BOOL isSetDefaultVidTagFrameNotMember = MSD_FALSE; //QINQ 默认VID，出口是否有非成员的设置
+    int ingressTcamIndex = 0;//下标0为VID 0的IngressTCAM
 
+    for (int i = 0; i < (int)vlanInfo->vidInfoSize; ++i) {//vlan table 行
+        MSD_16 vid = (MSD_16)vlanInfo->vidInfo[i].vid;
+        MSD_PORT_MEMBER_TAG memberTags[MSD_MAX_SWITCH_PORTS];
+        deviceVlanModuleGetApplyMemberTag(vlanInfo, i, portNum, memberTags);
+        MSD_BOOL qinqModelTagFrameUntaggedMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };//用以描述某个VID的标签帧出口是否取消标签
+        MSD_BOOL qinqModelTagFrameHasUntaggedMemberPort = MSD_FALSE;
+        for (int j = 1; j < portNum; ++j) {
+            MSD_PORT_MEMBER_TAG memberTag = memberTags[j];
+            if (memberTag == MSD_MEMBER_EGRESS_UNTAGGED) {//如果Port j 指定VID的memberTag为Untagged，qinq则需要移除标签。
+                qinqModelTagFrameUntaggedMemberPorts[j] = MSD_TRUE;
+                qinqModelTagFrameHasUntaggedMemberPort = MSD_TRUE;
+            }
+            //添加Provider Port 无标签帧的处理
+            if (vid != vlanInfo->portVlanInfo[j].defaultVid) continue;
+            isPortDefaultVidUnset[j] = MSD_FALSE;//Port j端口的默认VID被设置。
+            //如果端口的默认VID被设置为带标签，默认情况下，不带标签进入Provider Port会添加一个QinQ Tag,添加0x88a8(根据TPID的设置)，
+            //优先级和DEI都配置为C-TAG的优先级和DEI(如果存在)，不存在都设置为0,EES交换机的做法如果默认DefaultVID被设置，并且出口带标签的
+            //情况下，不管帧是否带C-TAG，其S-TAG的PCP和DEI都设置为0，这里按照EES的做法，将无标签的帧的PCP，DEI都设置为0
+            if (memberTag == MSD_MEMBER_EGRESS_TAGGED) {
+                qinqModelUntagFrameTaggedMemberPorts[j] = MSD_TRUE;
+                image->allowVidZero[j] = MSD_FALSE;//如果端口的默认VID被设置，则不允许VID 0出口（EES）
+            }
+            //无标签帧在出口UNMODIFIED和UNTAGGED的情况下，都统一将其S-TAG移除（默认情况下，会带一个标签）。
+            else if (memberTag == MSD_MEMBER_EGRESS_UNMODIFIED || memberTag == MSD_MEMBER_EGRESS_UNTAGGED) {
+                image->allowVidZero[j] = MSD_TRUE;//如果端口的默认VID被设置，则允许VID 0出口（EES）
+                if (memberTag == MSD_MEMBER_EGRESS_UNMODIFIED) {
+                    qinqModelUntagFrameUnmodifiedMemberPorts[j] = MSD_TRUE;
+                }
+                else {//MSD_MEMBER_EGRESS_UNTAGGED
+                    qinqModelUntagFrameUntaggedMemberPorts[j] = MSD_TRUE;
+                    isSetUntaggedMember = MSD_TRUE;
+                    if (vlanInfo->portVlanInfo[j].egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
+                        image->isVid0Untagged[j] = MSD_TRUE;//虽然双标签 UNTAGGED设置无效，但是利于观察。设置一下标签模式
+                    }
+                }
+            }
+            else {//not a member
+                qinqModelDefaultTagFrameNotMemberPorts[j] = MSD_TRUE;//某个端口的默认VID的memberTag设置为not a member,
+                isSetDefaultVidTagFrameNotMember = MSD_TRUE;
+            }
+        }
+        //指定VID，设置Port的memberTag为UNtagged的处理
+        if (qinqModelTagFrameHasUntaggedMemberPort) {
+            if (ingressTcamIndex == QINQ_VLAN_TAG_FRAME_TCAM_NUM) {
+                MSD_DBG_ERROR(("device_vlan_module_build_qinq_vlan_image failed,at most %d vids can have untagged ports in qinq model!\n", QINQ_VLAN_TAG_FRAME_TCAM_NUM));
+                return MSD_FEATRUE_NOT_ALLOW;
+            }
+            ingressTcamIndex++;
+            deviceVlanModuleSetQinqImageTagFrame(image, ingressTcamIndex, vid, MSD_MEMBER_EGRESS_UNTAGGED, qinqModelTagFrameUntaggedMemberPorts, portNum);
+        }
+    }
+    //在没有设置端口的DefaultVID时候(以MSD_MEMBER_EGRESS_UNMODIFIED转发)
+    for (int i = 1; i < portNum; ++i) {
+        if (isPortDefaultVidUnset[i]) {//端口没有设置默认VID
+            qinqModelUntagFrameUnmodifiedMemberPorts[i] = MSD_TRUE;
+        }
+    }
+    deviceVlanModuleSetQinqImageUntagFrame(image, MSD_MEMBER_EGRESS_UNMODIFIED, qinqModelUntagFrameUnmodifiedMemberPorts, portNum);
+    deviceVlanModuleSetQinqImageUntagFrame(image, MSD_MEMBER_EGRESS_UNTAGGED, qinqModelUntagFrameUntaggedMemberPorts, portNum);
+    //EES:如果默认VID出口删除标签，则VID 0的帧的S-TAG被移除。
+    if (isSetUntaggedMember) {//如果有端口的默认VID被设置Untagged，则需要将这些端口的VID 0出口时设置为不带Tag。
+        deviceVlanModuleSetQinqImageTagFrame(image, 0, 0, MSD_MEMBER_EGRESS_UNTAGGED, qinqModelUntagFrameUntaggedMemberPorts, portNum);
+    }
+    if (isSetDefaultVidTagFrameNotMember) {//端口的默认VID不允许出口
+        deviceVlanModuleSetQinqImageTagFrame(image, 0, 0, MSD_NOT_A_MEMBER, qinqModelDefaultTagFrameNotMemberPorts, portNum);
+    }
+    deviceVlanModuleSetQinqImageUntagFrame(image, MSD_MEMBER_EGRESS_TAGGED, qinqModelUntagFrameTaggedMemberPorts, portNum);
+    return MSD_OK;
+}
 
-    MSD_TCAM_EGR_DATA egressTcamData;
-    msdMemSet(&egressTcamData, 0, sizeof(MSD_TCAM_EGR_DATA));
-    egressTcamData.frameModeOverride = MSD_TRUE;//覆盖出口模式，frameMode为0x0时，则为Normal  Network
-    egressTcamData.tagModeOverride = MSD_TRUE;//覆盖出口标签模式，tagMode为0x0时，Egress the frame unmodified.
-    egressTcamData.tagMode = (MSD_U8)memberTag;
-    for (int i = 1; i < num; ++i) {
-        if (egressPorts[i]) {//
-            ret = msdEgrTcamEntryAdd(devNum, i, egressTcamPointer, &egressTcamData);
+/**
+ * @brief deviceVlanModuleQinqTcamIsOwned
+ * 从TCAM分配表判断QinQ的IngressTCAM是否和上一次写入的一致(过滤器初始化时会清空所有TCAM条目)，不读取交换机
+ * @param devNum
+ * @param applied 上一次写入交换机的QinQ设置
+ * @return
+ */
+static MSD_BOOL deviceVlanModuleQinqTcamIsOwned(IN MSD_U8 devNum, IN const QinqVlanImage* applied)
+{
+    for (int i = 0; i < QINQ_VLAN_INGRESS_TCAM_NUM; ++i) {
+        TcamOwnerType ownerType;
+        MSD_U16 ownerId;
+        if (deviceTcamModuleGetOwner(devNum, (MSD_U32)(QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER + i), &ownerType, &ownerId) != MSD_OK) {
+            return MSD_FALSE;
+        }
+        TcamOwnerType expectType = applied->ingressVid[i] == UNVALID_VID ? TCAM_OWNER_FREE : TCAM_OWNER_QINQ;
+        if (ownerType != expectType) {
+            return MSD_FALSE;
         }
     }
-    return ret;
+    return MSD_TRUE;
 }
 
 /**
- * @brief deviceVlanModuleSetQinqVlanUntagFramHandleTag
- * 无标签帧，使用IngressTCAM和EgressTCAM实现VLAN出口的处理，如果之前已存在相应的IngresTCAM和EgressTCAM条目，则直接替换。
- * @param devNum 设备编号
- * @param memberTag 不带标签出口以何种方式（带标签，不带标签，不变化）
- * @param egressPorts 出口条目的使用的端口列表集合
+ * @brief deviceVlanModuleWriteQinqIngressTcam 写入QinQ的IngressTCAM条目
+ * @param devNum
+ * @param index IngressTCAM在QinqVlanImage中的下标
+ * @param vid 匹配的VID，无标签帧的条目不匹配VID
+ * @param egressTcamPointer 入口条目的出口指针
  * @return
  */
-static MSD_STATUS deviceVlanModuleSetQinqVlanUntagFramHandleTag(IN MSD_U8 devNum, MSD_PORT_MEMBER_TAG memberTag,MSD_BOOL *egressPorts)
+static MSD_STATUS deviceVlanModuleWriteQinqIngressTcam(IN MSD_U8 devNum, IN int index, IN MSD_16 vid, IN MSD_U8 egressTcamPointer)
 {
-    //应该一个端口一个端口的设置，3个IngressTCAM对应3个EgressTCAM，
-    MSD_TCAM_DATA tcamData;
-    msdMemSet(&tcamData, 0, sizeof(MSD_TCAM_DATA));
     MSD_QD_DEV* dev = sohoDevGet(devNum);
     int num = dev->numOfPorts;
+    MSD_TCAM_DATA tcamData;
+    msdMemSet(&tcamData, 0, sizeof(MSD_TCAM_DATA));
     MSD_BOOL ingressPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };
     for (int i = 1; i < num; ++i) {//从Port 1开始设置，Port 0暂时不设置
         ingressPorts[i] = MSD_TRUE;
@@ -1241,35 +1502,239 @@ static MSD_STATUS deviceVlanModuleSetQinqVlanUntagFramHandleTag(IN MSD_U8 devNum
     MSD_U16 ingressPortVec = (MSD_U16)boolarrayToInt(ingressPorts, num);//
     tcamData.frameTypeMask = 0x3;//启用
     tcamData.spvMask = (MSD_U16)~ingressPortVec;
-
-    int egressTcamPointer = QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER;
-    int ingressTcamPointer = QINQ_VLAN_INGRESS_START_TCAM_POINTER + ALLOW_OPERATION_MAX_VLAN_NUM;
+    if (index != QINQ_VLAN_UNTAG_FRAME_INGRESS_TCAM_INDEX) {
+        tcamData.frameType = 0x2;//Provider Tag Frame
+        tcamData.pvid = (MSD_U16)vid;
+        tcamData.pvidMask = (MSD_U16)0xffff;
+    }
     tcamData.egActPoint = egressTcamPointer;//设置入口条目的出口指针
-
-    MSD_STATUS ret = msdTcamEntryAdd(devNum, ingressTcamPointer, &tcamData);
+    MSD_U32 tcamPointer = (MSD_U32)(QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER + index);
+    MSD_STATUS ret = msdTcamEntryAdd(devNum, tcamPointer, &tcamData);
     if (ret != MSD_OK) return ret;
+    return deviceTcamModuleReserveEntry(devNum, tcamPointer, TCAM_OWNER_QINQ, (MSD_U16)vid);
+}
+
+/**
+ * @brief deviceVlanModuleWriteQinqEgressTcam 写入端口QinQ的EgressTCAM条目
+ * @param devNum
+ * @param portNum 端口号
+ * @param egressTcamPointer EgressTCAM下标号
+ * @param memberTag 出口方式
+ * @return
+ */
+static MSD_STATUS deviceVlanModuleWriteQinqEgressTcam(IN MSD_U8 devNum, IN int portNum, IN int egressTcamPointer, IN MSD_PORT_MEMBER_TAG memberTag)
+{
     MSD_TCAM_EGR_DATA egressTcamData;
     msdMemSet(&egressTcamData, 0, sizeof(MSD_TCAM_EGR_DATA));
-    if (memberTag == MSD_MEMBER_EGRESS_TAGGED) { //显示S-TAG标签
+    if (egressTcamPointer != QINQ_VLAN_FOR_NO_TAG_FRAME_EGRESS_TCAM_POINTER) {//标签帧
+        egressTcamData.frameModeOverride = MSD_TRUE;//覆盖出口模式，frameMode为0x0时，则为Normal  Network
+        egressTcamData.tagModeOverride = MSD_TRUE;//覆盖出口标签模式，tagMode为0x0时，Egress the frame unmodified.
+        egressTcamData.tagMode = (MSD_U8)memberTag;
+    }
+    else if (memberTag == MSD_MEMBER_EGRESS_TAGGED) { //无标签帧显示S-TAG标签
         egressTcamData.frameModeOverride = MSD_TRUE;
         egressTcamData.frameMode = 0x2;//Provider_Tag模式
         //保证出口的Pri为0，如果不覆盖，则为C-TAG的Pri
         egressTcamData.egfpriModeOverride = MSD_TRUE;
         egressTcamData.egfpriMode = 0x2;
     }
-    else { //不显示标签的处理
+    else { //无标签帧不显示标签的处理
         egressTcamData.frameModeOverride = MSD_TRUE;//覆盖出口模式，frameMode为0x0时，则为Normal  Network
         egressTcamData.tagModeOverride = MSD_TRUE;//覆盖出口标签模式，tagMode为0x0时，Egress the frame unmodified.
         if (memberTag == MSD_MEMBER_EGRESS_UNTAGGED) {//移除标签的处理
             egressTcamData.tagMode = 0x1;
         }
     }
-    for (int i = 1; i < num; ++i) {
-        if (egressPorts[i]) {
-            ret = msdEgrTcamEntryAdd(devNum, i, egressTcamPointer, &egressTcamData);
-            if (ret != MSD_OK)
-                return ret;
+    return msdEgrTcamEntryAdd(devNum, (MSD_LPORT)portNum, (MSD_U32)egressTcamPointer, &egressTcamData);
+}
+
+/**
+ * @brief deviceVlanModuleApplyQinqVlanImage
+ * 比较target和applied，只写入变化的VID 0的VTU条目，端口是否允许VID 0，IngressTCAM和EgressTCAM条目，写入成功的部分同步到applied。
+ * 先写入EgressTCAM，再写入IngressTCAM，最后删除不再使用的EgressTCAM，入口条目不会指向没有写入的出口条目
+ * @param devNum
+ * @param portNum 端口个数
+ * @param applied 已经写入交换机的QinQ设置
+ * @param target 需要的QinQ设置
+ * @param stats 操作次数
+ * @return
+ */
+static MSD_STATUS deviceVlanModuleApplyQinqVlanImage(IN MSD_U8 devNum, IN int portNum, INOUT QinqVlanImage* applied,
+                                                     IN const QinqVlanImage* target, INOUT VlanApplyStats* stats)
+{
+    MSD_STATUS ret = MSD_OK;
+    MSD_BOOL isVid0Changed = target->hasVid0 != applied->hasVid0 ? MSD_TRUE : MSD_FALSE;
+    for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS && target->hasVid0 && !isVid0Changed; ++j) {
+        isVid0Changed = target->isVid0Untagged[j] != applied->isVid0Untagged[j] ? MSD_TRUE : MSD_FALSE;
+    }
+    if (isVid0Changed) {
+        if (target->hasVid0) {
+            MSD_VTU_ENTRY vtuEntry;
+            msdMemSet(&vtuEntry, 0, sizeof(MSD_VTU_ENTRY));
+            for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+                vtuEntry.memberTagP[j] = target->isVid0Untagged[j] ? MSD_MEMBER_EGRESS_UNTAGGED : MSD_MEMBER_EGRESS_UNMODIFIED;
+            }
+            ret = msdVlanEntryAdd(devNum, &vtuEntry);
+            if (ret != MSD_OK) return ret;
+            if (applied->hasVid0) ++stats->vtuModifies;
+            else ++stats->vtuAdds;
+        }
+        else {
+            ret = msdVlanEntryDelete(devNum, 0);
+            if (ret != MSD_OK) return ret;
+            ++stats->vtuDeletes;
+        }
+        applied->hasVid0 = target->hasVid0;
+        for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
+            applied->isVid0Untagged[j] = target->isVid0Untagged[j];
+        }
+    }
+    //不设置的端口保持之前的值
+    for (int j = 1; j < portNum; ++j) {
+        if (target->allowVidZero[j] == QINQ_VLAN_VALUE_UNSET || target->allowVidZero[j] == applied->allowVidZero[j]) continue;
+        ret = msdPortAllowVidZeroSet(devNum, (MSD_LPORT)j, target->allowVidZero[j] ? MSD_TRUE : MSD_FALSE);
+        if (ret != MSD_OK) return ret;
+        applied->allowVidZero[j] = target->allowVidZero[j];
+        ++stats->allowVidZeroWrites;
+    }
+    //添加或者修改EgressTCAM
+    for (int i = 1; i < QINQ_VLAN_EGRESS_TCAM_NUM; ++i) {
+        for (int j = 1; j < portNum; ++j) {
+            MSD_U8 memberTag = target->egressTag[i][j];
+            if (memberTag == QINQ_VLAN_VALUE_UNSET || memberTag == applied->egressTag[i][j]) continue;
+            ret = deviceVlanModuleWriteQinqEgressTcam(devNum, j, i, (MSD_PORT_MEMBER_TAG)memberTag);
+            if (ret != MSD_OK) return ret;
+            applied->egressTag[i][j] = memberTag;
+            ++stats->egressTcamWrites;
+        }
+    }
+    //IngressTCAM
+    for (int i = 0; i < QINQ_VLAN_INGRESS_TCAM_NUM; ++i) {
+        if (target->ingressVid[i] == applied->ingressVid[i] && target->ingressEgAct[i] == applied->ingressEgAct[i]) continue;
+        if (target->ingressVid[i] == UNVALID_VID) {
+            MSD_U32 tcamPointer = (MSD_U32)(QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER + i);
+            ret = msdTcamEntryDelete(devNum, tcamPointer);
+            if (ret != MSD_OK) return ret;
+            deviceTcamModuleFreeEntries(devNum, &tcamPointer, 1);
+            ++stats->ingressTcamDeletes;
+        }
+        else {
+            ret = deviceVlanModuleWriteQinqIngressTcam(devNum, i, target->ingressVid[i], target->ingressEgAct[i]);
+            if (ret != MSD_OK) return ret;
+            ++stats->ingressTcamWrites;
+        }
+        applied->ingressVid[i] = target->ingressVid[i];
+        applied->ingressEgAct[i] = target->ingressEgAct[i];
+    }
+    //删除不再使用的EgressTCAM
+    for (int i = 1; i < QINQ_VLAN_EGRESS_TCAM_NUM; ++i) {
+        for (int j = 1; j < portNum; ++j) {
+            if (target->egressTag[i][j] != QINQ_VLAN_VALUE_UNSET || applied->egressTag[i][j] == QINQ_VLAN_VALUE_UNSET) continue;
+            ret = msdEgrTcamEntryPerPortDelete(devNum, (MSD_LPORT)j, (MSD_U32)i);
+            if (ret != MSD_OK) return ret;
+            applied->egressTag[i][j] = QINQ_VLAN_VALUE_UNSET;
+            ++stats->egressTcamDeletes;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief deviceVlanModuleLoadVtuEntries
+ * 一次写入vtuLoadWords中打包的VTU条目，成功后更新memberTag信息表和FID
+ * 不检查VID是否已存在于交换机中，VID个数在checkEesVlanInfoIsValid中已经检查
+ * @param devNum
+ * @param vlanInfo 本次设置的VLAN信息
+ * @param portNum 端口个数
+ * @param loadCount vtuLoadWords中的条目个数
+ * @param stats 操作次数
+ * @return
+ */
+static MSD_STATUS deviceVlanModuleLoadVtuEntries(IN MSD_U8 devNum, IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN int portNum,
+                                                 IN int loadCount, INOUT VlanApplyStats* stats)
+{
+    VlanApplyState* state = &s_vlanApplyState[devNum];
+    VlanMemberTagAndEgressModeInfo* current = &s_vtuModuleInitType[devNum].portVlanMemberTagInfo;
+    MSD_STATUS ret = Fir_gvtuLoadEntries(sohoDevGet(devNum), state->vtuLoadWords, (MSD_U32)loadCount);
+    if (ret != MSD_OK) {
+        MSD_DBG_ERROR(("deviceVlanModuleLoadVtuEntries failed,the status is %d\n", ret));
+        return ret;
+    }
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    for (int k = 0; k < loadCount; ++k) {
+        int i = state->vtuLoadIndex[k];
+        MSD_U16 vid = vlanInfo->vidInfo[i].vid;
+        deviceVlanModuleGetApplyMemberTag(vlanInfo, i, portNum, memberTag);
+        if (deviceVlanModuleVlanTableFind(current, vid) >= 0) ++stats->vtuModifies;
+        else ++stats->vtuAdds;
+        setFidValue(devNum, vid);//添加了指定VTU条目，其FID对应MAC条目很可能就存在对应的MAC条目。
+        ret = deviceVlanModuleVlanTableSet(current, vid, memberTag, MSD_TRUE);
+        if (ret != MSD_OK) return ret;
+    }
+    return MSD_OK;
+}
+
+/**
+ * @brief deviceVlanModuleApplyVtuEntries
+ * 和memberTag信息表比较，先删除不再设置的VID(VID fff恢复为默认的条目)，再添加或者修改memberTag变化的VID
+ * 不在memberTag信息表中的VTU条目(MAC条目添加的VTU条目)不修改
+ * @param devNum
+ * @param vlanInfo 本次设置的VLAN信息
+ * @param portNum 端口个数
+ * @param stats 操作次数
+ * @return
+ */
+static MSD_STATUS deviceVlanModuleApplyVtuEntries(IN MSD_U8 devNum, IN const VlanMemberTagAndEgressModeInfo* vlanInfo, IN int portNum, INOUT VlanApplyStats* stats)
+{
+    MSD_STATUS ret = MSD_OK;
+    VlanMemberTagAndEgressModeInfo* current = &s_vtuModuleInitType[devNum].portVlanMemberTagInfo;
+    //从后往前删除，删除记录时只移动已经比较过的记录
+    for (int i = (int)current->vidInfoSize - 1; i >= 0; --i) {
+        MSD_U16 vid = current->vidInfo[i].vid;
+        if (deviceVlanModuleVlanTableFind(vlanInfo, vid) >= 0) continue;
+        if (vid == 0xfff) {//VID fff需要保留
+            MSD_VTU_ENTRY vtuEntry;
+            msdMemSet(&vtuEntry, 0, sizeof(MSD_VTU_ENTRY));
+            vtuEntry.fid = (MSD_U16)0xfff;
+            vtuEntry.vid = (MSD_U16)0xfff;
+            ret = msdVlanEntryAdd(devNum, &vtuEntry);
+            if (ret != MSD_OK) return ret;
+            deviceVlanModuleRemoveOneVidMemberTagInfo(devNum, vid);
+        }
+        else {
+            ret = deviceVlanModuleDelVlan(devNum, (MSD_U16)vid);
+            if (ret != MSD_OK) return ret;
+        }
+        ++stats->vtuDeletes;
+    }
+
+    //memberTag变化的VID先转换为寄存器的值，每VLAN_VTU_LOAD_CHUNK个一起写入
+    VlanApplyState* state = &s_vlanApplyState[devNum];
+    MSD_QD_DEV* dev = sohoDevGet(devNum);
+    int loadCount = 0;
+    MSD_VTU_ENTRY vtuEntry;
+    for (int i = 0; i < (int)vlanInfo->vidInfoSize; ++i) {//vlan table 行
+        MSD_U16 vid = vlanInfo->vidInfo[i].vid;
+        msdMemSet(&vtuEntry, 0, sizeof(MSD_VTU_ENTRY));
+        vtuEntry.vid = vid;
+        vtuEntry.fid = vid;//使用多数据库，fid设置为VID
+        deviceVlanModuleGetApplyMemberTag(vlanInfo, i, portNum, vtuEntry.memberTagP);
+        int index = deviceVlanModuleVlanTableFind(current, vid);
+        if (index >= 0 && current->vidInfo[index].memberTags == deviceVlanModulePackMemberTag(vtuEntry.memberTagP)) {
+            ++stats->vtuUnchanged;
+            continue;
         }
+        ret = Fir_gvtuPackEntryIntf(dev, &vtuEntry, &state->vtuLoadWords[loadCount]);
+        if (ret != MSD_OK) return ret;
+        state->vtuLoadIndex[loadCount++] = (MSD_U16)i;
+        if (loadCount == VLAN_VTU_LOAD_CHUNK) {
+            ret = deviceVlanModuleLoadVtuEntries(devNum, vlanInfo, portNum, loadCount, stats);
+            if (ret != MSD_OK) return ret;
+            loadCount = 0;
+        }
+    }
+    if (loadCount > 0) {
+        ret = deviceVlanModuleLoadVtuEntries(devNum, vlanInfo, portNum, loadCount, stats);
     }
     return ret;
 }
@@ -1291,194 +1756,73 @@ MSD_STATUS deviceVlanModuleSetVlanEgressModeAndMemberTagInfo(IN MSD_U8 devNum, I
         return MSD_BAD_PARAM;
     }
 
-    VlanMemberTagAndEgressModeInfo beforeSetPortVlanMemberTag;//已经存在的,使用外面传递的参数(以修改值为准)。
-    MSD_STATUS ret = deviceVlanModuleGetVlanEgressModeMemberTagInfo(devNum, &beforeSetPortVlanMemberTag);//
-    if (ret != MSD_OK) return ret;
-
-    ret = deviceVlanModuleClearQinqVlanIngressAndEgressTcam(devNum);//清除与QinQ相关的所有的IngressTCAM项
-    if (ret != MSD_OK) return ret;
+    VlanApplyState* state = &s_vlanApplyState[devNum];
+    VlanApplyStats* stats = &state->stats;
+    MSD_U32 applyCount = stats->applyCount + 1;
+    MSD_U32 fullRebuildCount = stats->fullRebuildCount;
+    msdMemSet(stats, 0, sizeof(VlanApplyStats));
+    stats->applyCount = applyCount;
+    stats->fullRebuildCount = fullRebuildCount;
 
-    ret = deviceVlanModuleResetVlanInfo(devNum); //保留VID 1和VID 0xfff
-    if (ret != MSD_OK) return ret;
-
-    VlanMemberTagAndEgressModeInfo tempVlanMemberTag;
-    msdMemSet(&tempVlanMemberTag, 0, sizeof(VlanMemberTagAndEgressModeInfo));
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        tempVlanMemberTag.vidInfo[i].vid = UNVALID_VID;
-    }
-    //    MSD_BOOL isReset = MSD_TRUE;//这里先代替参数。
-    //    if (!isReset) { //和之前的VLAN项目进行整合
-    //        combineVlanMemberTag(&beforeSetPortVlanMemberTag, portVlanMemberTag, &tempVlanMemberTag);
-    // }
-    // else {//替换之前的VLAN条目
-    copyValidPortVlanMemberTagInfo(&tempVlanMemberTag, portVlanMemberTag);//
-    // }
-    FirVlanEntry vtuEntry;
-    MSD_BOOL isFound;
     int portNum = dev->numOfPorts;
-
-    int allPortDefaultVids[MSD_MAX_SWITCH_PORTS] = { 0 };
-    for (int j = 0; j < portNum; ++j) {//
-
-        //如果所有端口都是Allow All(即允许所有VLAN出口)，所有出口端口都为 MSD_MEMBER_EGRESS_UNMODIFIED，则可以不用添加该VID条目(这里不做任何判断)
-        VlanEgressMode egressMode = tempVlanMemberTag.portVlanInfo[j].egressMode;
-        s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[j].egressMode = egressMode;
-        MSD_8021Q_MODE mode8021;
-        if (egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
-            mode8021 = MSD_8021Q_CHECK;//VID必须包含在VTU中，否则丢弃帧，出口端口必须为其成员，才能从端口出口
-        }
-        else {//Allow All or All All but exclusion the list
-            mode8021 = MSD_8021Q_FALLBACK;//VID不是必须在VTU列表中，如果VID包含在VTU列表中，出口必须为其成员
-        }
-        ret = deviceVlanModuleSet8021Mode(devNum, j, mode8021);//设置802.1 FallBack模式
+    VlanModel vlanModel = s_vtuModuleInitType[devNum].globalQModel;
+    if (vlanModel == VLANMODEL_QINQ) {
+        MSD_STATUS status = deviceVlanModuleBuildQinqVlanImage(portVlanMemberTag, portNum, &state->target);
+        if (status != MSD_OK) return status;
+    }
+    else {
+        deviceVlanModuleResetQinqVlanImage(&state->target);
+    }
+    //第一次设置，Q模式改变，VTU被清空，上一次设置失败或者QinQ的TCAM条目被删除时，清空之后重建
+    MSD_BOOL isFullRebuild = (!state->isSynced || !deviceVlanModuleQinqTcamIsOwned(devNum, &state->applied)) ? MSD_TRUE : MSD_FALSE;
+    state->isSynced = MSD_FALSE;//设置成功之后才一致
+    MSD_STATUS ret = MSD_OK;
+    if (isFullRebuild) {
+        ret = deviceVlanModuleClearQinqVlanIngressAndEgressTcam(devNum, stats);//清除与QinQ相关的所有的IngressTCAM项
         if (ret != MSD_OK) return ret;
-        //设置DefaultVID
-        MSD_U16 defaultVid = tempVlanMemberTag.portVlanInfo[j].defaultVid;
-        allPortDefaultVids[j] = defaultVid;
-        s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[j].defaultVid = defaultVid;
-        ret = msdPortDefaultVlanIdSet(devNum, j, defaultVid);//设置默认VID
+        ret = deviceVlanModuleResetVlanInfo(devNum); //保留VID 1和VID 0xfff
         if (ret != MSD_OK) return ret;
+        stats->vtuDeletes++;
+        stats->vtuAdds += 2;
+        deviceVlanModuleResetQinqVlanImage(&state->applied);
+        stats->isFullRebuild = MSD_TRUE;
+        stats->fullRebuildCount++;
     }
 
-    //添加VID条目
-    MSD_BOOL isPortDefaultVidUnset[MSD_MAX_SWITCH_PORTS];//记录端口是否被设置了默认VID
-    VlanModel vlanModel = s_vtuModuleInitType[devNum].globalQModel;
-    MSD_BOOL isAddVtu0 = MSD_FALSE;
-    for (int i = 0; i < portNum; i++) {
-        isPortDefaultVidUnset[i] = MSD_TRUE;//所有端口都没有设置默认VID
-
-        //如果为ALL_MEMBER_SHIP并且为Q_QINQ模式，添加VID 0
-        if (!isAddVtu0) {
-            if (vlanModel == VLANMODEL_QINQ && tempVlanMemberTag.portVlanInfo[i].egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
-                MSD_VTU_ENTRY vtuEntry;
-                MSD_BOOL isFound;
-                msdMemSet(&vtuEntry, 0, sizeof(MSD_VTU_ENTRY));
-                ret = msdVlanEntryFind(devNum, 0, &vtuEntry, &isFound);
-                if (ret != MSD_OK) return ret;
-                if (!isFound) {
-                    ret = msdVlanEntryAdd(devNum, &vtuEntry);
-                    if (ret != MSD_OK) return ret;
-                    isAddVtu0 = MSD_TRUE;
-                }
-            }
-        }
-    }
-    MSD_BOOL qinqModelUntagFrameTaggedMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE}; //qinq 无标签帧带标签出口的集合
-    MSD_BOOL qinqModelUntagFrameUntaggedMemberPorts[MSD_MAX_SWITCH_PORTS] = {MSD_FALSE}; //qinq 无标签帧移除标签出口的集合
-    MSD_BOOL isSetUntaggedMember = MSD_FALSE;
-    MSD_BOOL qinqModelUntagFrameUnmodifiedMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };//qinq 无标签帧标签出口的集合(和untagged处理有一定的区别)
-
-    int ingressTcamIndex = -1;
-    MSD_BOOL qinqModelDefaultTagFrameNotMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };//QINQ 默认VID，出口非成员的设置
-    MSD_BOOL isSetDefaultVidTagFrameNotMember = MSD_FALSE; //QINQ 默认VID，出口是否有非成员的设置
-
-    for (size_t i = 0; i < tempVlanMemberTag.vidInfoSize; ++i) {//vlan table 行
-        //       if (tempVlanMemberTag.vidInfo[i].vid == UNVALID_VID) { //没有设置
-        // 	continue;
-        // }
-        int vid = tempVlanMemberTag.vidInfo[i].vid;
-        MSD_BOOL qinqModelTagFrameUntaggedMemberPorts[MSD_MAX_SWITCH_PORTS] = { MSD_FALSE };//用以描述某个VID的标签帧出口是否取消标签
-        MSD_BOOL qinqModelTagFrameHasUntaggedMemberPort = MSD_FALSE;
-        msdMemSet(&vtuEntry, 0, sizeof(FirVlanEntry));
-        ret = msdVlanEntryFind(devNum, tempVlanMemberTag.vidInfo[i].vid, &vtuEntry.entry, &isFound);
-        if (ret != MSD_OK) break;
-        vtuEntry.entry.vid = vid;
-        vtuEntry.entry.fid = vid;//使用多数据库，fid设置为VID
-        for (int j = 1; j < portNum; ++j) {//vlan table 列
-            //如果Port j允许所有VLAN帧出口，则需要将其非成员设置不加修改的方式传输帧
-            MSD_PORT_MEMBER_TAG memberTag = tempVlanMemberTag.vidInfo[i].memberTag[j];
-            if (memberTag == MSD_NOT_A_MEMBER
-                && tempVlanMemberTag.portVlanInfo[j].egressMode == VLAN_EGRESS_MODE_ALLOW_ALL) {
-                memberTag = MSD_MEMBER_EGRESS_UNMODIFIED;
-            }
-
-            if (vlanModel == VLANMODEL_QINQ) {
-                if (memberTag == MSD_MEMBER_EGRESS_UNTAGGED) {//如果Port j 指定VID的memberTag为Untagged，qinq则需要移除标签。
-                    qinqModelTagFrameUntaggedMemberPorts[j] = MSD_TRUE;
-                    qinqModelTagFrameHasUntaggedMemberPort = MSD_TRUE;
-                }
-                //添加Provider Port 无标签帧的处理
-                if (vid == allPortDefaultVids[j]) {//Port j端口的默认VID被设置。
-                    isPortDefaultVidUnset[j] = MSD_FALSE;
-                    //如果端口的默认VID被设置为带标签，默认情况下，不带标签进入Provider Port会添加一个QinQ Tag,添加0x88a8(根据TPID的设置)，
-                    //优先级和DEI都配置为C-TAG的优先级和DEI(如果存在)，不存在都设置为0,EES交换机的做法如果默认DefaultVID被设置，并且出口带标签的
-                    //情况下，不管帧是否带C-TAG，其S-TAG的PCP和DEI都设置为0，这里按照EES的做法，将无标签的帧的PCP，DEI都设置为0
-                    if (memberTag == MSD_MEMBER_EGRESS_TAGGED) {
-                        qinqModelUntagFrameTaggedMemberPorts[j] = MSD_TRUE;
-                        //如果端口的默认VID被设置，则不允许VID 0出口（EES）
-                        ret = msdPortAllowVidZeroSet(devNum, (MSD_LPORT)j, MSD_FALSE);
-                        if (ret != MSD_OK)
-                            return ret;
-                    }
-                    //无标签帧在出口UNMODIFIED和UNTAGGED的情况下，都统一将其S-TAG移除（默认情况下，会带一个标签）。
-                    else if (memberTag == MSD_MEMBER_EGRESS_UNMODIFIED || memberTag == MSD_MEMBER_EGRESS_UNTAGGED) {
-                        ret = msdPortAllowVidZeroSet(devNum, (MSD_LPORT)j, MSD_TRUE);//允许
-                        if (ret != MSD_OK)
-                            return ret;
-                        //如果端口的默认VID被设置，则允许VID 0出口（EES）
-                        if (memberTag == MSD_MEMBER_EGRESS_UNMODIFIED) {
-                            qinqModelUntagFrameUnmodifiedMemberPorts[j] = MSD_TRUE;
-                        }
-                        else {//MSD_MEMBER_EGRESS_UNTAGGED
-                            qinqModelUntagFrameUntaggedMemberPorts[j] = MSD_TRUE;
-                            isSetUntaggedMember = MSD_TRUE;
-                            ////EES:如果默认VID出口删除标签，则VID 0的帧的S-TAG被移除。
-                            //ret = device_vlan_module_set_qinq_vlan_tag_fram_handle_tag(dev_num, 0, QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER, j, member_tag);
-                            //if (ret != MSD_OK) return ret;
-                            if (tempVlanMemberTag.portVlanInfo[j].egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
-                                ret = msdVlanMemberTagSet(devNum, 0, j, MSD_MEMBER_EGRESS_UNTAGGED);//虽然双标签 UNTAGGED设置无效，但是利于观察。设置一下标签模式
-                                if (ret != MSD_OK) return ret;
-                            }
-
-                        }
-                    }
-                    else {//not a member
-                        qinqModelDefaultTagFrameNotMemberPorts[j] = MSD_TRUE;//某个端口的默认VID的memberTag设置为not a member,
-                        isSetDefaultVidTagFrameNotMember = MSD_TRUE;
-                    }
-                }
+    VlanPerPortVlanInfo* currentPortInfo = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo;
+    for (int j = 0; j < portNum; ++j) {//
+        //如果所有端口都是Allow All(即允许所有VLAN出口)，所有出口端口都为 MSD_MEMBER_EGRESS_UNMODIFIED，则可以不用添加该VID条目(这里不做任何判断)
+        VlanEgressMode egressMode = portVlanMemberTag->portVlanInfo[j].egressMode;
+        if (isFullRebuild || currentPortInfo[j].egressMode != egressMode) {
+            MSD_8021Q_MODE mode8021;
+            if (egressMode == VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP) {
+                mode8021 = MSD_8021Q_CHECK;//VID必须包含在VTU中，否则丢弃帧，出口端口必须为其成员，才能从端口出口
             }
-            vtuEntry.entry.memberTagP[j] = memberTag;
-        }
-        if (vlanModel == VLANMODEL_QINQ) {
-            //指定VID，设置Port的memberTag为UNtagged的处理
-            if (qinqModelTagFrameHasUntaggedMemberPort) {
-                ingressTcamIndex++;
-                int tcam_pointer = QINQ_VLAN_INGRESS_START_TCAM_POINTER + ingressTcamIndex;
-                ret = deviceVlanModuleSetQinqVlanTagFramHandleTag(devNum, vid, tcam_pointer, MSD_MEMBER_EGRESS_UNTAGGED, qinqModelTagFrameUntaggedMemberPorts);
-                if (ret != MSD_OK) return ret;
+            else {//Allow All or All All but exclusion the list
+                mode8021 = MSD_8021Q_FALLBACK;//VID不是必须在VTU列表中，如果VID包含在VTU列表中，出口必须为其成员
             }
-        }
-
-        ret = deviceVlanModuleAddOrModifyVlan(devNum, &vtuEntry);
-        if (ret != MSD_OK) return ret;
-    }
-    //QinQ: 端口被设置为Provider Port的情况下
-    if (vlanModel == VLANMODEL_QINQ) {
-        //在没有设置端口的DefaultVID时候(以MSD_MEMBER_EGRESS_UNMODIFIED转发)
-        for (int i = 1; i < portNum; ++i) {
-            if (isPortDefaultVidUnset[i]) {//端口没有设置默认VID
-                qinqModelUntagFrameUnmodifiedMemberPorts[i] = MSD_TRUE;
-            }
-        }
-
-        ret = deviceVlanModuleSetQinqVlanUntagFramHandleTag(devNum, MSD_MEMBER_EGRESS_UNMODIFIED, qinqModelUntagFrameUnmodifiedMemberPorts);
-        if (ret != MSD_OK) return ret;
-        ret = deviceVlanModuleSetQinqVlanUntagFramHandleTag(devNum, MSD_MEMBER_EGRESS_UNTAGGED, qinqModelUntagFrameUntaggedMemberPorts);
-        if (ret != MSD_OK) return ret;
-        int vid0TcamPointer = QINQ_VLAN_VLAN_0_INGRESS_TCAM_POINTER;
-        //EES:如果默认VID出口删除标签，则VID 0的帧的S-TAG被移除。
-        if (isSetUntaggedMember) {//如果有端口的默认VID被设置Untagged，则需要将这些端口的VID 0出口时设置为不带Tag。
-            ret = deviceVlanModuleSetQinqVlanTagFramHandleTag(devNum, 0, vid0TcamPointer, MSD_MEMBER_EGRESS_UNTAGGED, qinqModelUntagFrameUntaggedMemberPorts);
+            //全局模式下deviceVlanModuleSet8021Mode会设置所有端口，这里只设置该端口
+            ret = msdPort8021qModeSet(devNum, j, mode8021);
             if (ret != MSD_OK) return ret;
+            currentPortInfo[j].egressMode = egressMode;
+            stats->portModeWrites++;
         }
-        if (isSetDefaultVidTagFrameNotMember) {//端口的默认VID不允许出口
-            ret = deviceVlanModuleSetQinqVlanTagFramHandleTag(devNum, 0, vid0TcamPointer, MSD_NOT_A_MEMBER, qinqModelDefaultTagFrameNotMemberPorts);
+        //设置DefaultVID
+        MSD_U16 defaultVid = portVlanMemberTag->portVlanInfo[j].defaultVid;
+        if (isFullRebuild || currentPortInfo[j].defaultVid != defaultVid) {
+            ret = msdPortDefaultVlanIdSet(devNum, j, defaultVid);//设置默认VID
             if (ret != MSD_OK) return ret;
+            currentPortInfo[j].defaultVid = defaultVid;
+            stats->defaultVidWrites++;
         }
-        ret = deviceVlanModuleSetQinqVlanUntagFramHandleTag(devNum, MSD_MEMBER_EGRESS_TAGGED, qinqModelUntagFrameTaggedMemberPorts);
-        if (ret != MSD_OK) return ret;
     }
+
+    ret = deviceVlanModuleApplyVtuEntries(devNum, portVlanMemberTag, portNum, stats);
+    if (ret != MSD_OK) return ret;
+    //QinQ: 端口被设置为Provider Port的情况下，VID 0和TCAM的处理；其他模式下删除之前QinQ模式的设置
+    ret = deviceVlanModuleApplyQinqVlanImage(devNum, portNum, &state->applied, &state->target, stats);
+    if (ret != MSD_OK) return ret;
+    state->isSynced = MSD_TRUE;
     return ret;
 }
 
@@ -1493,6 +1837,16 @@ MSD_STATUS deviceVlanModuleGetVlanEgressModeMemberTagInfo(IN MSD_U8 devNum, OUT
     return MSD_OK;
 }
 
+MSD_STATUS deviceVlanModuleGetApplyStats(IN MSD_U8 devNum, OUT VlanApplyStats* stats)
+{
+	CHECK_DEV_NUM_IS_CORRECT;
+    if (stats == NULL) {
+        return MSD_BAD_PARAM;
+    }
+    *stats = s_vlanApplyState[devNum].stats;
+    return MSD_OK;
+}
+
 #define PROVIDER_PORT_DEAL_WITH_NO_PROVIDER_TAG_VID   0 //Provider Port处理非Provider Tag帧的默认VID
 
 //MSD_STATUS deviceVlanModuleSetProviderPortDealWithNoProviderTagFrame(IN MSD_U8 devNum, IN int portNum, IN int fid, IN MSD_LPORT* ports, IN int portsSize)
@@ -1597,44 +1951,6 @@ MSD_STATUS deviceVlanModuleGetModePort(IN MSD_U8 devNum, OUT int* ports, IN int
     return ret;
 }
 
-/**
- * @brief deviceVlanModuleFindVlanConfigIndex
- *  查询是否可以将VID存储到相应的VLAN配置文件的相应下标中，如果当前配置的VLAN条目已达到ALLOW_OPERATION_MAX_VLAN_NUM，则返回MSD_FALSE
- * @param devNum 设备编号
- * @param vid 要查询的VID
- * @param index 存储的下标中
- * @param isExist 如果为真，则配置中存在查询的VID，否则将VLAN 配置中不存在查询的VID
- * @return
- */
-static MSD_BOOL deviceVlanModuleFindVlanConfigIndex(IN MSD_U8 devNum, IN MSD_U16 vid, OUT int* index, OUT MSD_BOOL* isExist)
-{
-    (*index) = -1;
-    *isExist = MSD_FALSE;
-    int temp = -1;
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        MSD_16 tempVid = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].vid;
-        if (tempVid == vid) {//存在对应的vid
-            *index = i;
-            temp = i;
-            *isExist = MSD_TRUE;
-            break;
-        }
-    }
-    if (temp == -1) { //条目中不存在，则找到一个没有使用的位置
-        for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-            MSD_16 tempVid = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].vid;
-            if (tempVid == UNVALID_VID) {
-                (*index) = i;
-                temp = i;
-                break;
-            }
-        }
-    }
-    if (temp != -1)//找到合适的位置
-        return MSD_TRUE;
-    return MSD_FALSE;//没有找到
-}
-
 MSD_STATUS deviceVlanModuleAddOrModifyVlanWithVidAndMemberTagToConfig(IN MSD_U8 devNum, IN MSD_U16 vid, IN MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS], IN MSD_U8 memberTagSize)
 {
     MSD_STATUS ret = MSD_OK;
@@ -1651,29 +1967,29 @@ MSD_STATUS deviceVlanModuleAddOrModifyVlanWithVidAndMemberTagToConfig(IN MSD_U8
         MSD_DBG_ERROR(("device_vlan_module_add_or_modify_vlan_with_vid_and_member_tag failed,the default_vid param range is %d ~ %d !\n", PORT_DEFAULT_VID, MAX_OPERATION_VID));
         return MSD_BAD_PARAM;
     }
-    int index;
-    MSD_BOOL isExist;
-    deviceVlanModuleFindVlanConfigIndex(devNum, vid, &index, &isExist);
-    if (index != -1) {
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].vid = vid;
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].isShow = MSD_TRUE;
-        if(memberTag == NULL) memberTagSize = 0;
-        if (memberTagSize < dev->numOfPorts) {
-            //如果member_tag的参数的个数小于端口数，则将后续的端口memberTag设置为MSD_MEMBER_EGRESS_UNMODIFIED
-            for (int i = memberTagSize; i < dev->numOfPorts; ++i) {
-                s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].memberTag[i] = MSD_MEMBER_EGRESS_UNMODIFIED;
-            }
-        }
-        for (int i = 0; i < memberTagSize; ++i) {
-            s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].memberTag[i] = memberTag[i];
-        }
-        if (!isExist) {//如果VLAN不存在，则将其操作值+1
-            s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize++;
+    VlanMemberTagAndEgressModeInfo* vlanInfo = &s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo;
+    MSD_PORT_MEMBER_TAG tags[MSD_MAX_SWITCH_PORTS];
+    int index = deviceVlanModuleVlanTableFind(vlanInfo, vid);
+    if (index >= 0) {
+        deviceVlanModuleVlanTableGetMemberTag(vlanInfo, index, tags);
+    }
+    else {
+        for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; ++i) {
+            tags[i] = MSD_MEMBER_EGRESS_UNMODIFIED;
         }
     }
-    else {//条目已达最大值，不能添加VLAN了。
+    if (memberTag == NULL) memberTagSize = 0;
+    if (memberTagSize > MSD_MAX_SWITCH_PORTS) memberTagSize = MSD_MAX_SWITCH_PORTS;
+    //如果member_tag的参数的个数小于端口数，则将后续的端口memberTag设置为MSD_MEMBER_EGRESS_UNMODIFIED
+    for (int i = memberTagSize; i < dev->numOfPorts; ++i) {
+        tags[i] = MSD_MEMBER_EGRESS_UNMODIFIED;
+    }
+    for (int i = 0; i < memberTagSize; ++i) {
+        tags[i] = memberTag[i];
+    }
+    ret = deviceVlanModuleVlanTableSet(vlanInfo, vid, tags, MSD_TRUE);
+    if (ret == MSD_FEATRUE_NOT_ALLOW) {//条目已达最大值，不能添加VLAN了。
         MSD_DBG_ERROR(("device_vlan_module_add_or_modify_vlan_with_vid_and_member_tag_to_config failed, because vtu config's vtu numer is reach the max:%d\n", ALLOW_OPERATION_MAX_VLAN_NUM));
-        return MSD_FEATRUE_NOT_ALLOW;
     }
     return ret;
 }
@@ -1685,14 +2001,7 @@ MSD_STATUS deviceVlanModuleRemoveVlanFromConfig(IN MSD_U8 devNum, IN MSD_U16 vid
         MSD_DBG_ERROR(("device_vlan_module_remove_vlan_from_config failed,the vid param shoule between %d and %d!\n",PORT_DEFAULT_VID,MAX_OPERATION_VID));
         return MSD_BAD_PARAM;
     }
-    int index;
-    MSD_BOOL isExist;
-    deviceVlanModuleFindVlanConfigIndex(devNum, vid, &index, &isExist);
-    if (isExist) {//如果配置中存在对应的VID
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].vid = UNVALID_VID;
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].isShow = MSD_FALSE;
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize--;
-    }
+    deviceVlanModuleVlanTableRemove(&s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo, vid);
     return MSD_OK;
 }
 
@@ -1705,11 +2014,7 @@ MSD_STATUS deviceVlanModuleCleanAllVlanAndMemberTagFromConfig(IN MSD_U8 devNum,
     if(isResetVlanEgressMode != MSD_TRUE && isResetVlanEgressMode != MSD_FALSE){
         isResetVlanEgressMode = MSD_TRUE;
     }
-    s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize = 0;
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].vid = UNVALID_VID;
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].isShow = MSD_FALSE;
-    }
+    deviceVlanModuleVlanTableReset(&s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo);
     if (isResetDefaultVid) {
         for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; i++) {
             s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[i].defaultVid = PORT_DEFAULT_VID;
@@ -1743,26 +2048,7 @@ MSD_STATUS deviceVlanModuleSetQModeAndQinqTpidToConfig(IN MSD_U8 devNum, IN MSD_
  */
 static void  deviceVlanModuleGetAllVlanInfo(IN MSD_U8 devNum, OUT VlanMemberTagAndEgressModeInfo* vlanInfo)
 {
-    msdMemSet(vlanInfo, 0, sizeof(VlanMemberTagAndEgressModeInfo));
-    vlanInfo->vidInfoSize = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize;
-    for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; i++) {
-        vlanInfo->portVlanInfo[i].defaultVid = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[i].defaultVid;
-        vlanInfo->portVlanInfo[i].egressMode = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[i].egressMode;
-    }
-    int index = 0;
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        MSD_16 tempVid = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].vid;
-        if (tempVid != UNVALID_VID) {
-            vlanInfo->vidInfo[index].isShow = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].isShow;
-            vlanInfo->vidInfo[index].vid = tempVid;
-            for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; j++) {
-                vlanInfo->vidInfo[index].memberTag[j] = s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].memberTag[j];
-            }
-            index++;
-        }
-        if ((MSD_U32)index == vlanInfo->vidInfoSize) break;
-    }
-
+    copyValidPortVlanMemberTagInfo(vlanInfo, &s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo);
 }
 
 MSD_STATUS deviceVlanModuleExportAllVlanAndMemberTag(IN MSD_U8 devNum, OUT VlanMemberTagAndEgressModeInfo* vlanInfo)
@@ -1783,23 +2069,8 @@ MSD_STATUS deviceVlanModuleImportAllVlanAndMemberTag(IN MSD_U8 devNum, IN VlanMe
     if (!checkEesVlanInfoIsValid(dev->numOfPorts, vlanInfo)) {
         return MSD_BAD_PARAM;
     }
-    deviceVlanModuleCleanAllVlanAndMemberTagFromConfig(devNum, MSD_TRUE, MSD_TRUE);
-
-    s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize = vlanInfo->vidInfoSize;
-    for (size_t i = 0; i < vlanInfo->vidInfoSize; ++i) {
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].vid = vlanInfo->vidInfo[i].vid;
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].isShow = vlanInfo->vidInfo[i].isShow;
-        for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; j++) {
-            s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[i].memberTag[j] = vlanInfo->vidInfo[i].memberTag[j];
-        }
-    }
-    for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; i++) {
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[i].defaultVid = vlanInfo->portVlanInfo[i].defaultVid;
-    }
-
-    for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; i++) {
-        s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.portVlanInfo[i].egressMode = vlanInfo->portVlanInfo[i].egressMode;
-    }
+    //替换已有的vid配置和端口出口方式及其默认VID
+    copyValidPortVlanMemberTagInfo(&s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo, vlanInfo);
     return MSD_OK;
 }
 
@@ -1833,35 +2104,8 @@ MSD_STATUS deviceVlanModuleRefreshVlanConfigInfo(IN MSD_U8 devNum, OUT VlanConfi
         MSD_DBG_ERROR(("device_vlan_module_refresh_vlan_config_info failed, the vlan model is not global model"));
         return MSD_FEATRUE_NOT_ALLOW;
     }
-    deviceVlanModuleCleanAllVlanAndMemberTagFromConfig(devNum, MSD_TRUE, MSD_TRUE);
-
-
-    for (size_t i = 0; i < MSD_MAX_SWITCH_PORTS; ++i) {
-        vlanConfigInfo->portVlanMemberTagInfo.portVlanInfo[i].defaultVid = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[i].defaultVid;
-        vlanConfigInfo->portVlanMemberTagInfo.portVlanInfo[i].egressMode = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.portVlanInfo[i].egressMode;
-    }
-    vlanConfigInfo->portVlanMemberTagInfo.vidInfoSize = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize;
-    s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfoSize = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfoSize;
-    size_t index = 0;
-    for (int i = 0; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i) {
-        MSD_16 tempVid = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].vid;
-        if (tempVid != UNVALID_VID) {
-            vlanConfigInfo->portVlanMemberTagInfo.vidInfo[index].vid = tempVid;
-            s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].vid = tempVid;
-            MSD_BOOL isShow = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].isShow;
-            vlanConfigInfo->portVlanMemberTagInfo.vidInfo[index].isShow = isShow;
-            s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].isShow = isShow;
-            for (size_t j = 0; j < MSD_MAX_SWITCH_PORTS; ++j) {
-                MSD_PORT_MEMBER_TAG memberTag = s_vtuModuleInitType[devNum].portVlanMemberTagInfo.vidInfo[i].memberTag[j];
-                vlanConfigInfo->portVlanMemberTagInfo.vidInfo[index].memberTag[j] = memberTag;
-                s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo.vidInfo[index].memberTag[j] = memberTag;
-            }
-            index++;
-        }
-        if (index == vlanConfigInfo->portVlanMemberTagInfo.vidInfoSize) {//检测完毕
-            break;
-        }
-    }
+    copyValidPortVlanMemberTagInfo(&vlanConfigInfo->portVlanMemberTagInfo, &s_vtuModuleInitType[devNum].portVlanMemberTagInfo);
+    copyValidPortVlanMemberTagInfo(&s_vtuModuleInitType[devNum].vtuConfigInfo.portVlanMemberTagInfo, &s_vtuModuleInitType[devNum].portVlanMemberTagInfo);
     MSD_U16 eType;
     ret = msdPortEtherTypeByTypeGet(devNum, 1, MSD_ETHERTYPE_PROVIDER, &eType);//EES模式需要再全局模式下，因此Port 1的TPID就是所有端口的TPID。
     if (ret == MSD_OK) {
@@ -139,7 +139,7 @@ void msdDbgPrint(char* format, ...)
 	char dbgStr[1000] = "";
 
 	va_start(argP, format);
-    snprintf(dbgStr,1000,format,argP);
+    vsnprintf(dbgStr,1000,format,argP);
     //vsprintf_s(dbgStr, 1000, format, argP);
 	if (printCallback != NULL)
 		printCallback(dbgStr);
@@ -378,7 +378,7 @@ static MSD_STATUS InitDevObj_Fir(MSD_QD_DEV *dev)
 //    dev->SwitchDevObj.RMUObj.grmuEcidDump = &Fir_msdRmuEcidDumpIntf;
 //
 //    dev->SwitchDevObj.RMUObj.grmuGetID = &Fir_msdRmuGetIDIntf;
-//    dev->SwitchDevObj.RMUObj.grmuAtuDump = &Fir_msdRmuAtuDumpIntf;
+    dev->SwitchDevObj.RMUObj.grmuAtuDump = &Fir_msdRmuAtuDumpIntf;
 //    dev->SwitchDevObj.RMUObj.grmuMib2Dump = &Fir_msdRmuMib2DumpIntf;
 //    dev->SwitchDevObj.RMUObj.grmuMultiRegAccess = &Fir_msdRmuMultiRegAccessIntf;
 //    dev->SwitchDevObj.RMUObj.grmuRegDump = &Fir_msdRmuRegDump;
@@ -1177,78 +1177,3 @@ MSD_STATUS InitDevObj(MSD_QD_DEV *dev)
 	return retVal;
 }
 
-/*******************************************************************************
-* msdReserveFreeQueueSize
-*
-* DESCRIPTION:
-*       workaround for QC WatchDog trigger issue: reserve 16 free queue size, total 1024. Set threshold 
-*       for the free pool FIFO to 0x10. This means the recycle pointer will not be reused immediately, 
-*       16 pointers will be given to per-port module before this pointer can be used.
-*
-* INPUTS:
-*        dev - pointer to the structure for device.
-*
-* OUTPUTS:
-*        None.
-*
-* RETURNS:
-*       MSD_OK, if input is valid. MSD_FAIL, otherwise.
-*
-*******************************************************************************/
-static MSD_STATUS msdReserveFreeQueueSize(MSD_QD_DEV *qdev)
-{
-	MSD_U16 reg27, tempData;
-	MSD_STATUS retVal;
-
-	/*read back G1 offset 0x1b register value*/
-	retVal = msdGetAnyReg(qdev->devNum, (MSD_U8)0x1B, (MSD_U8)0x1B, &reg27);
-	if (retVal != 0)
-	{
-		MSD_DBG_ERROR(("msdGetAnyReg return failed, retval = %d.\n", retVal));
-		return MSD_FAIL;
-	}
-	/*Change the hidden block to QC Hidden registers, Hidden Block: 0x2*/
-	retVal = msdSetAnyReg(qdev->devNum, 0x1B, 0x1B, 0x2000);
-	if (retVal != 0)
-	{
-		MSD_DBG_ERROR(("msdSetAnyReg return failed, retval = %d.\n", retVal));
-		return MSD_FAIL;
-	}
-	/*wait QCHiddenCtrl register busy bit self clear*/
-	do
-	{
-		retVal = msdGetAnyReg(qdev->devNum, 0x1B, 0x1B, &tempData);
-		if (retVal != 0)
-		{
-			MSD_DBG_ERROR(("msdGetAnyReg return failed, retval = %d.\n", retVal));
-			return MSD_FAIL;
-		}
-	} while ((tempData & 0x8000) == 0x8000);
-
-	/*write data to QC Hidden Data, Device Offset 0x1B, Register Offset: 0x1A, reserve 16 free queue size*/
-	retVal = msdSetAnyReg(qdev->devNum, 0x1B, 0x1A, 0x8400);
-	if (retVal != 0)
-	{
-		MSD_DBG_ERROR(("msdSetAnyReg return failed, retval = %d.\n", retVal));
-		return MSD_FAIL;
-	}
-	/*write cmd register, QC Hidden Control, Device Offset 0x1B, Register Offset: 0x19*/
-	tempData = (0xE000 | (0x1F << 8) | 0xC);
-
-	retVal = msdSetAnyReg(qdev->devNum, 0x1B, 0x19, tempData);
-	if (retVal != 0)
-	{
-		MSD_DBG_ERROR(("msdSetAnyReg return failed, retval = %d.\n", retVal));
-		return MSD_FAIL;
-	}
-
-	/*restore the Hidden block*/
-	retVal = msdSetAnyReg(qdev->devNum, 0x1B, 0x1B, reg27);
-	if (retVal != 0)
-	{
-		MSD_DBG_ERROR(("msdSetAnyReg return failed, retval = %d.\n", retVal));
-		return MSD_FAIL;
-	}
-
-	return MSD_OK;
-}
@@ -19,6 +19,8 @@
 *
 *******************************************************************************/
 
+/* the traced functions are defined here, do not wrap them */
+#define MSD_TRACE_NO_WRAP
 #include <msdHwAccess.h>
 #include <msdSem.h>
 #include <msdUtils.h>
@@ -32,6 +34,10 @@ static MSD_STATUS msdMultiAddrWrite (MSD_QD_DEV* dev, MSD_U8 phyAddr , MSD_U8 re
 static void msdU32VauleCpy(MSD_U8 *ptr, MSD_U32 value);
 static void msdU16VauleCpy(MSD_U8 *ptr, MSD_U16 value);
 
+static MSD_BOOL msdRegCacheLookup(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, OUT MSD_U16* value);
+static void msdRegCacheUpdate(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, MSD_U16 value);
+static void msdRegCacheDrop(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr);
+
 
 /****************************************************************************/
 /* Switch Any registers direct R/W functions.                               */
@@ -109,6 +115,15 @@ MSD_STATUS msdSetAnyReg
 		}
 	}
 
+	if (retVal == MSD_OK)
+	{
+		msdRegCacheUpdate(dev, devAddr, regAddr, data);
+	}
+	else
+	{
+		msdRegCacheDrop(dev, devAddr, regAddr);
+	}
+
 	if (regAddr != OS_HW_SEMAPHORE_REG)
 	{
 		msdSemGive(devNum, dev->multiAddrSem);
@@ -161,7 +176,11 @@ MSD_STATUS msdGetAnyReg
 		msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
 	}
 
-    if (IS_RMU_SUPPORTED(dev))//
+	if (msdRegCacheLookup(dev, devAddr, regAddr, data) == MSD_TRUE)
+	{
+		retVal = MSD_OK;
+	}
+    else if (IS_RMU_SUPPORTED(dev))//
 	{
 		retVal = msdRmuRegRead(dev, devAddr, regAddr, data);
 	}
@@ -185,6 +204,11 @@ MSD_STATUS msdGetAnyReg
 			retVal = MSD_NOT_SUPPORTED;
 		}
 	}
+
+	if (retVal == MSD_OK)
+	{
+		msdRegCacheUpdate(dev, devAddr, regAddr, *data);
+	}
 	
 	if (regAddr != OS_HW_SEMAPHORE_REG)
 	{
@@ -319,6 +343,62 @@ MSD_STATUS msdGetAnyRegField
 	return retVal;
 }
 
+/*******************************************************************************
+* msdGetAnyRegBurst
+*
+* DESCRIPTION:
+*       This function reads count consecutive registers of one device address.
+*       Over RMU the reads travel in one register R/W frame; over SMI they use
+*       the BSP burst read (Clause 45 post-read-increment) when it is provided.
+*
+* INPUTS:
+*       devAddr - device address to read the registers for.
+*       regAddr - The first register's address.
+*       count   - number of registers, regAddr + count must not exceed 32.
+*
+* OUTPUTS:
+*       data    - The read registers' data, count entries.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS msdGetAnyRegBurst
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    count,
+    OUT MSD_U16   *data
+)
+{
+	MSD_STATUS retVal;
+	MSD_U8 i;
+
+	if ((data == NULL) || (count == 0U) || ((MSD_U32)regAddr + count > MSD_REG_BURST_MAX))
+	{
+		MSD_DBG_ERROR(("Bad burst regAddr 0x%02x count %d.\n", regAddr, count));
+		return MSD_BAD_PARAM;
+	}
+
+	/* a batch of consecutive reads is flushed as one RMU frame or one SMI burst */
+	retVal = msdRegBatchBegin(devNum);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+	for (i = 0; i < count; i++)
+	{
+		(void)msdRegBatchRead(devNum, devAddr, (MSD_U8)(regAddr + i), &data[i]);
+	}
+	return msdRegBatchCommit(devNum);
+}
+
 
 /*******************************************************************************
 * msdSetAnyExtendedReg
@@ -1205,6 +1285,9 @@ MSD_STATUS msdRmuTxRxPkt
 )
 {
 	MSD_STATUS retVal;
+#ifdef MSD_TRACE
+	MSD_U32 startTime = msdTimeStamp();
+#endif
 	if (dev->rmu_tx_rx)
 	{
 		retVal = dev->rmu_tx_rx(reqPkt, reqPktLen, rspPkt, rspPktLen);
@@ -1214,6 +1297,7 @@ MSD_STATUS msdRmuTxRxPkt
 		MSD_DBG_ERROR(("RMU_TX_RX API is NULL.\n"));
 		retVal = MSD_NOT_SUPPORTED;
 	}
+	MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_RMU, dev->devNum, 0, 0, startTime, retVal);
 
 	return retVal;
 }
@@ -1747,3 +1831,1287 @@ static MSD_STATUS msdMultiAddrWrite (MSD_QD_DEV* dev, MSD_U8 phyAddr , MSD_U8 re
 
     return MSD_OK;
 }
+
+/****************************************************************************/
+/* Batched register access functions.                                       */
+/****************************************************************************/
+
+static MSD_REG_BATCH msdRegBatches[MAX_SOHO_DEVICES];
+
+static MSD_STATUS msdRegBatchQueue(MSD_U8 devNum, MSD_REG_BATCH_CMD *cmd);
+static MSD_STATUS msdRegBatchFlush(MSD_QD_DEV* dev, MSD_REG_BATCH *batch);
+static MSD_STATUS msdRegBatchRmuFlush(MSD_QD_DEV* dev, MSD_REG_BATCH *batch);
+static MSD_STATUS msdRegBatchSmiFlush(MSD_QD_DEV* dev, MSD_REG_BATCH *batch);
+static MSD_STATUS msdRegBatchSmiRead(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, OUT MSD_U16* value);
+static MSD_STATUS msdRegBatchSmiReadBurst(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, MSD_U8 count, OUT MSD_U16* values);
+static MSD_STATUS msdRegBatchSmiWrite(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, MSD_U16 value);
+
+/*******************************************************************************
+* msdRegBatchBegin
+*
+* DESCRIPTION:
+*       This function opens a register batch on the device. The SMI/RMU access
+*       semaphore is taken here and held until msdRegBatchCommit.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       msdSetAnyReg/msdGetAnyReg must not be called between msdRegBatchBegin
+*       and msdRegBatchCommit, and batches must not be nested.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchBegin
+(
+    IN  MSD_U8    devNum
+)
+{
+	MSD_REG_BATCH *batch;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if ((NULL == dev) || (devNum >= MAX_SOHO_DEVICES))
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
+
+	batch = &msdRegBatches[devNum];
+	batch->active = MSD_TRUE;
+	batch->status = MSD_OK;
+	batch->nCmd = 0;
+
+	return MSD_OK;
+}
+
+/*******************************************************************************
+* msdRegBatchRead
+*
+* DESCRIPTION:
+*       This function queues a register read into the open batch.
+*
+* INPUTS:
+*       devNum  - physical device number
+*       devAddr - device address.
+*       regAddr - The register's address.
+*
+* OUTPUTS:
+*       data    - The read register's data, valid after msdRegBatchCommit.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Errors are latched in the batch and returned again by msdRegBatchCommit.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchRead
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    OUT MSD_U16   *data
+)
+{
+	MSD_REG_BATCH_CMD cmd;
+
+	cmd.op = (MSD_U8)MSD_REG_BATCH_OP_READ;
+	cmd.devAddr = devAddr;
+	cmd.regAddr = regAddr;
+	cmd.bitNum = 0;
+	cmd.data = 0;
+	cmd.readData = data;
+
+	return msdRegBatchQueue(devNum, &cmd);
+}
+
+/*******************************************************************************
+* msdRegBatchWrite
+*
+* DESCRIPTION:
+*       This function queues a register write into the open batch.
+*
+* INPUTS:
+*       devNum  - physical device number
+*       devAddr - device address.
+*       regAddr - The register's address.
+*       data    - The data to be written.
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Errors are latched in the batch and returned again by msdRegBatchCommit.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchWrite
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U16   data
+)
+{
+	MSD_REG_BATCH_CMD cmd;
+
+	MSD_DBG(("(LOG BW): devAddr 0x%02x, regAddr 0x%02x, data 0x%04x.\n",
+              devAddr, regAddr, data));
+
+	cmd.op = (MSD_U8)MSD_REG_BATCH_OP_WRITE;
+	cmd.devAddr = devAddr;
+	cmd.regAddr = regAddr;
+	cmd.bitNum = 0;
+	cmd.data = data;
+	cmd.readData = NULL;
+
+	return msdRegBatchQueue(devNum, &cmd);
+}
+
+/*******************************************************************************
+* msdRegBatchWaitOnBit
+*
+* DESCRIPTION:
+*       This function queues a command that waits until one bit of a register
+*       reaches the given value, e.g. the Busy bit of a table operation register.
+*
+* INPUTS:
+*       devNum   - physical device number
+*       devAddr  - device address.
+*       regAddr  - The register's address.
+*       bitNum   - The bit index. (0 - 15)
+*       bitValue - The value to wait for. (0 or 1)
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       On SMI the bit is polled at most MSD_REG_BATCH_WAIT_LOOP times.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchWaitOnBit
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    bitNum,
+    IN  MSD_U8    bitValue
+)
+{
+	MSD_REG_BATCH_CMD cmd;
+
+	if ((bitNum > (MSD_U8)15) || (bitValue > (MSD_U8)1))
+	{
+		MSD_DBG_ERROR(("Bad wait-on-bit parameter, bit %d value %d.\n", bitNum, bitValue));
+		return MSD_BAD_PARAM;
+	}
+
+	cmd.op = (MSD_U8)MSD_REG_BATCH_OP_WAIT_ON_BIT;
+	cmd.devAddr = devAddr;
+	cmd.regAddr = regAddr;
+	cmd.bitNum = bitNum;
+	cmd.data = bitValue;
+	cmd.readData = NULL;
+
+	return msdRegBatchQueue(devNum, &cmd);
+}
+
+/*******************************************************************************
+* msdRegBatchCommit
+*
+* DESCRIPTION:
+*       This function executes the queued commands in order, stores the read
+*       results and releases the semaphore taken by msdRegBatchBegin.
+*       With RMU the commands are sent as one MSD_RegRW frame, on SMI they are
+*       executed back to back under a single semaphore hold.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_NOT_SUPPORTED - device not support
+*
+* COMMENTS:
+*       Queueing more than MSD_REG_BATCH_MAX_CMDS commands flushes the batch
+*       early, so a read result is only guaranteed after this call.
+*
+*******************************************************************************/
+MSD_STATUS msdRegBatchCommit
+(
+    IN  MSD_U8    devNum
+)
+{
+	MSD_STATUS retVal;
+	MSD_REG_BATCH *batch;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if ((NULL == dev) || (devNum >= MAX_SOHO_DEVICES))
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	batch = &msdRegBatches[devNum];
+	if (batch->active != MSD_TRUE)
+	{
+		MSD_DBG_ERROR(("No register batch opened for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	if (batch->status == MSD_OK)
+	{
+		batch->status = msdRegBatchFlush(dev, batch);
+	}
+	retVal = batch->status;
+
+	batch->active = MSD_FALSE;
+	batch->nCmd = 0;
+
+	msdSemGive(devNum, dev->multiAddrSem);
+
+	return retVal;
+}
+
+/****************************************************************************/
+/* Internal functions.                                                      */
+/****************************************************************************/
+
+static MSD_STATUS msdRegBatchQueue(MSD_U8 devNum, MSD_REG_BATCH_CMD *cmd)
+{
+	MSD_REG_BATCH *batch;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if ((NULL == dev) || (devNum >= MAX_SOHO_DEVICES))
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	batch = &msdRegBatches[devNum];
+	if (batch->active != MSD_TRUE)
+	{
+		MSD_DBG_ERROR(("No register batch opened for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	/* Once a command failed the rest of the batch is dropped */
+	if (batch->status != MSD_OK)
+	{
+		return batch->status;
+	}
+
+	if (batch->nCmd == MSD_REG_BATCH_MAX_CMDS)
+	{
+		batch->status = msdRegBatchFlush(dev, batch);
+		if (batch->status != MSD_OK)
+		{
+			return batch->status;
+		}
+	}
+
+	msdMemCpy(&batch->cmd[batch->nCmd], cmd, sizeof(MSD_REG_BATCH_CMD));
+	batch->nCmd++;
+
+	return MSD_OK;
+}
+
+static MSD_STATUS msdRegBatchFlush(MSD_QD_DEV* dev, MSD_REG_BATCH *batch)
+{
+	MSD_STATUS retVal;
+	MSD_U32 i;
+	MSD_REG_BATCH_CMD *cmd;
+
+	if (batch->nCmd == 0U)
+	{
+		return MSD_OK;
+	}
+
+	if (IS_RMU_SUPPORTED(dev))
+	{
+		retVal = msdRegBatchRmuFlush(dev, batch);
+	}
+	else
+	{
+		retVal = msdRegBatchSmiFlush(dev, batch);
+	}
+
+	for (i = 0; i < batch->nCmd; i++)
+	{
+		cmd = &batch->cmd[i];
+		if (retVal != MSD_OK)
+		{
+			/* It is unknown which writes reached the hardware */
+			msdRegCacheDrop(dev, cmd->devAddr, cmd->regAddr);
+		}
+		else if (cmd->op == (MSD_U8)MSD_REG_BATCH_OP_WRITE)
+		{
+			msdRegCacheUpdate(dev, cmd->devAddr, cmd->regAddr, cmd->data);
+		}
+		else if ((cmd->op == (MSD_U8)MSD_REG_BATCH_OP_READ) && (cmd->readData != NULL))
+		{
+			msdRegCacheUpdate(dev, cmd->devAddr, cmd->regAddr, *cmd->readData);
+		}
+		else
+		{
+			/* wait on bit, nothing to cache */
+		}
+	}
+
+	batch->nCmd = 0;
+	return retVal;
+}
+
+/*****************************************************************************
+* msdRegBatchRmuFlush
+*
+* DESCRIPTION:
+*       This function sends all queued commands in one RMU multiple register
+*       R/W frame and copies the read results back from the response.
+*
+* INPUTS:
+*       batch - The queued commands.
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       The response carries every command word at the same offset as the
+*       request, the low 16 bits of a read command hold the register value.
+*
+*******************************************************************************/
+static MSD_STATUS msdRegBatchRmuFlush(MSD_QD_DEV* dev, MSD_REG_BATCH *batch)
+{
+	MSD_Packet ReqPkt;
+	MSD_U8 reqEthPacket[512];
+	MSD_U8 rspEthPacket[512];
+	MSD_U32 req_pktlen, rsp_pktlen;
+	MSD_STATUS retVal;
+	MSD_U8 delta;
+	MSD_U32 i, offset;
+	MSD_REG_BATCH_CMD *cmd;
+
+	MSD_RMU_CMD rmuCmd = MSD_RegRW;
+
+	MSD_U8 *rspEthPacketPtr = &(rspEthPacket[0]);
+
+	if (dev->rmuMode == MSD_RMU_DSA_MODE)
+		delta = 4;
+	else
+		delta = 0;
+
+	retVal = msdRmuReqPktCreate(dev, rmuCmd, &ReqPkt);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+
+	ReqPkt.reqData._regRWData.nCmd = batch->nCmd;
+	for (i = 0; i < batch->nCmd; i++)
+	{
+		cmd = &batch->cmd[i];
+		ReqPkt.reqData._regRWData.regCmd[i].devAddr = cmd->devAddr;
+		ReqPkt.reqData._regRWData.regCmd[i].regAddr = cmd->regAddr;
+		switch (cmd->op)
+		{
+			case MSD_REG_BATCH_OP_READ:
+				ReqPkt.reqData._regRWData.regCmd[i].isWaitOnBit = MSD_RMU_WAIT_ON_BIT_FALSE;
+				ReqPkt.reqData._regRWData.regCmd[i].opCode = MSD_RMU_REQ_OPCODE_READ;
+				ReqPkt.reqData._regRWData.regCmd[i].data = 0x0;
+				break;
+			case MSD_REG_BATCH_OP_WRITE:
+				ReqPkt.reqData._regRWData.regCmd[i].isWaitOnBit = MSD_RMU_WAIT_ON_BIT_FALSE;
+				ReqPkt.reqData._regRWData.regCmd[i].opCode = MSD_RMU_REQ_OPCODE_WRITE;
+				ReqPkt.reqData._regRWData.regCmd[i].data = cmd->data;
+				break;
+			default:
+				ReqPkt.reqData._regRWData.regCmd[i].isWaitOnBit = MSD_RMU_WAIT_ON_BIT_TRUE;
+				ReqPkt.reqData._regRWData.regCmd[i].opCode = (cmd->data == 0U) ? MSD_RMU_WAIT_ON_BIT_VAL0 : MSD_RMU_WAIT_ON_BIT_VAL1;
+				ReqPkt.reqData._regRWData.regCmd[i].data = cmd->bitNum;
+				break;
+		}
+	}
+
+	msdMemSet(reqEthPacket, 0, sizeof(reqEthPacket));
+	retVal = msdRmuPackEthReqPkt(&ReqPkt, rmuCmd, reqEthPacket);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+	req_pktlen = MSD_RMU_PACKET_PREFIX_SIZE - delta + (batch->nCmd + 1U)*MSD_RMU_REGCMD_WORD_SIZE;
+
+	retVal = msdRmuTxRxPkt(dev, reqEthPacket, req_pktlen,
+		&rspEthPacketPtr, &rsp_pktlen);
+	if ((retVal != MSD_OK) || (rsp_pktlen == 0U)) {
+		MSD_DBG_ERROR(("rmu_tx_rx returned: %s with rsp_pktLen %d.\n", msdDisplayStatus(retVal), (int)rsp_pktlen));
+		return MSD_FAIL;
+	}
+
+	if (rsp_pktlen < req_pktlen) {
+		MSD_DBG_ERROR(("response_pktlen [%d] < request_pktlen [%d]\n",
+			rsp_pktlen, req_pktlen));
+		return MSD_FAIL;
+	}
+
+	for (i = 0; i < batch->nCmd; i++)
+	{
+		cmd = &batch->cmd[i];
+		if ((cmd->op == (MSD_U8)MSD_REG_BATCH_OP_READ) && (cmd->readData != NULL))
+		{
+			offset = MSD_RMU_PACKET_PREFIX_SIZE - delta + (i * MSD_RMU_REGCMD_WORD_SIZE) + 2U;
+			*cmd->readData = (MSD_U16)(((*(rspEthPacketPtr + offset) & 0xff) << 8) | (*(rspEthPacketPtr + offset + 1U) & 0xff));
+		}
+	}
+
+	return MSD_OK;
+}
+
+static MSD_STATUS msdRegBatchSmiFlush(MSD_QD_DEV* dev, MSD_REG_BATCH *batch)
+{
+	MSD_STATUS retVal = MSD_OK;
+	MSD_U32 i, j, n;
+	MSD_U16 data;
+	MSD_U16 burst[MSD_REG_BURST_MAX];
+	MSD_REG_BATCH_CMD *cmd;
+	volatile unsigned int timeOut;
+
+	for (i = 0; (i < batch->nCmd) && (retVal == MSD_OK); i++)
+	{
+		cmd = &batch->cmd[i];
+		switch (cmd->op)
+		{
+			case MSD_REG_BATCH_OP_READ:
+				/* reads of consecutive registers on one device address go out as a single burst */
+				for (n = 1; (i + n < batch->nCmd) && (n < MSD_REG_BURST_MAX); n++)
+				{
+					if ((batch->cmd[i + n].op != (MSD_U8)MSD_REG_BATCH_OP_READ) ||
+						(batch->cmd[i + n].devAddr != cmd->devAddr) ||
+						(batch->cmd[i + n].regAddr != (MSD_U8)(cmd->regAddr + n)))
+					{
+						break;
+					}
+				}
+				retVal = msdRegBatchSmiReadBurst(dev, cmd->devAddr, cmd->regAddr, (MSD_U8)n, burst);
+				if (retVal == MSD_OK)
+				{
+					for (j = 0; j < n; j++)
+					{
+						if (batch->cmd[i + j].readData != NULL)
+						{
+							*batch->cmd[i + j].readData = burst[j];
+						}
+					}
+				}
+				i += n - 1U;
+				break;
+			case MSD_REG_BATCH_OP_WRITE:
+				retVal = msdRegBatchSmiWrite(dev, cmd->devAddr, cmd->regAddr, cmd->data);
+				break;
+			default:
+				timeOut = MSD_REG_BATCH_WAIT_LOOP;
+				do
+				{
+					retVal = msdRegBatchSmiRead(dev, cmd->devAddr, cmd->regAddr, &data);
+					if (retVal != MSD_OK)
+					{
+						break;
+					}
+					if (timeOut-- < 1)
+					{
+						MSD_DBG_ERROR(("Wait on devAddr 0x%02x regAddr 0x%02x bit %d timed out.\n",
+							cmd->devAddr, cmd->regAddr, cmd->bitNum));
+						retVal = MSD_FAIL;
+						break;
+					}
+				} while (((data >> cmd->bitNum) & 0x1U) != cmd->data);
+				break;
+		}
+	}
+
+	return retVal;
+}
+
+static MSD_STATUS msdRegBatchSmiRead(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, OUT MSD_U16* value)
+{
+	MSD_STATUS retVal;
+
+	if (IS_SMI_MULTICHIP_SUPPORTED(dev))
+	{
+		retVal = msdMultiAddrRead(dev, devAddr, regAddr, value);
+	}
+	else if (dev->fgtReadMii)
+	{
+		retVal = dev->fgtReadMii(dev->devNum, devAddr, regAddr, value);
+	}
+	else
+	{
+		MSD_DBG_ERROR(("FMSD_READ_MII API is NULL.\n"));
+		retVal = MSD_NOT_SUPPORTED;
+	}
+
+	return retVal;
+}
+
+static MSD_STATUS msdRegBatchSmiReadBurst(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, MSD_U8 count, OUT MSD_U16* values)
+{
+	MSD_STATUS retVal = MSD_OK;
+	MSD_U8 i;
+
+	if ((count > 1U) && (!IS_SMI_MULTICHIP_SUPPORTED(dev)) && (dev->fgtReadMiiBurst != NULL))
+	{
+		return dev->fgtReadMiiBurst(dev->devNum, devAddr, regAddr, count, values);
+	}
+
+	for (i = 0; (i < count) && (retVal == MSD_OK); i++)
+	{
+		retVal = msdRegBatchSmiRead(dev, devAddr, (MSD_U8)(regAddr + i), &values[i]);
+	}
+
+	return retVal;
+}
+
+static MSD_STATUS msdRegBatchSmiWrite(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, MSD_U16 value)
+{
+	MSD_STATUS retVal;
+
+	if (IS_SMI_MULTICHIP_SUPPORTED(dev))
+	{
+		retVal = msdMultiAddrWrite(dev, devAddr, regAddr, value);
+	}
+	else if (dev->fgtWriteMii)
+	{
+		retVal = dev->fgtWriteMii(dev->devNum, devAddr, regAddr, value);
+	}
+	else
+	{
+		MSD_DBG_ERROR(("FMSD_WRITE_MII API is NULL.\n"));
+		retVal = MSD_NOT_SUPPORTED;
+	}
+
+	return retVal;
+}
+
+/****************************************************************************/
+/* Pipelined RMU functions.                                                 */
+/****************************************************************************/
+
+static MSD_RMU_PIPE msdRmuPipes[MAX_SOHO_DEVICES];
+
+static MSD_STATUS msdRmuPipeService(MSD_QD_DEV* dev, MSD_RMU_PIPE *pipe);
+static MSD_STATUS msdRmuPipeWait(MSD_QD_DEV* dev, MSD_RMU_PIPE *pipe, MSD_U32 maxPending);
+static MSD_STATUS msdRmuPipeSync(MSD_QD_DEV* dev, MSD_RMU_PIPE *pipe, MSD_U8 *reqPkt, MSD_U32 reqPktLen,
+	MSD_RMU_DONE_CB done, void *arg);
+
+/* DSA SeqNum is the last byte of the DSA tag: DA(6)+SA(6)+[ETYPE(4)]+DSA(4) */
+static MSD_U32 msdRmuSeqNumOffset(MSD_QD_DEV* dev)
+{
+	return (dev->rmuMode == MSD_RMU_ETHERT_TYPE_DSA_MODE) ? 19U : 15U;
+}
+
+MSD_STATUS msdRmuPipeBegin
+(
+    IN  MSD_U8    devNum
+)
+{
+	MSD_RMU_PIPE *pipe;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	if ((dev->rmu_tx_rx == NULL) && ((dev->rmu_tx == NULL) || (dev->rmu_rx == NULL)))
+	{
+		MSD_DBG_ERROR(("RMU send/receive API is NULL.\n"));
+		return MSD_NOT_SUPPORTED;
+	}
+
+	pipe = &msdRmuPipes[devNum];
+	/* active is only read and written with the semaphore held, a session of another task ends before the check */
+	msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
+	if (pipe->active == MSD_TRUE)
+	{
+		msdSemGive(devNum, dev->multiAddrSem);
+		MSD_DBG_ERROR(("RMU pipe already active for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	msdMemSet(pipe->slot, 0, sizeof(pipe->slot));
+	pipe->nPending = 0;
+	pipe->status = MSD_OK;
+	pipe->active = MSD_TRUE;
+
+	return MSD_OK;
+}
+
+MSD_STATUS msdRmuPipeSubmit
+(
+    IN  MSD_U8          devNum,
+    IN  MSD_U8          *reqPkt,
+    IN  MSD_U32         reqPktLen,
+    IN  MSD_RMU_DONE_CB done,
+    IN  void            *arg
+)
+{
+	MSD_STATUS retVal;
+	MSD_RMU_PIPE *pipe;
+	MSD_RMU_PIPE_SLOT *slot = NULL;
+	MSD_U32 i;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	pipe = &msdRmuPipes[devNum];
+	if (pipe->active != MSD_TRUE)
+	{
+		MSD_DBG_ERROR(("msdRmuPipeBegin is not called.\n"));
+		return MSD_FAIL;
+	}
+
+	if ((reqPkt == NULL) || (done == NULL) || (reqPktLen > MSD_RMU_PIPE_REQ_SIZE) ||
+		(reqPktLen <= msdRmuSeqNumOffset(dev)))
+	{
+		MSD_DBG_ERROR(("Bad RMU request, length %d.\n", (int)reqPktLen));
+		return MSD_BAD_PARAM;
+	}
+
+	if ((dev->rmu_tx == NULL) || (dev->rmu_rx == NULL))
+	{
+		return msdRmuPipeSync(dev, pipe, reqPkt, reqPktLen, done, arg);
+	}
+
+	retVal = msdRmuPipeWait(dev, pipe, MSD_RMU_PIPE_DEPTH - 1U);
+	if (retVal != MSD_OK)
+	{
+		return retVal;
+	}
+
+	for (i = 0; i < MSD_RMU_PIPE_DEPTH; i++)
+	{
+		if (pipe->slot[i].used != MSD_TRUE)
+		{
+			slot = &pipe->slot[i];
+			break;
+		}
+	}
+	if (slot == NULL)
+	{
+		return MSD_FAIL;
+	}
+
+	msdMemCpy(slot->req, reqPkt, reqPktLen);
+	slot->reqLen = reqPktLen;
+	slot->seqNum = reqPkt[msdRmuSeqNumOffset(dev)];
+	slot->retry = 0;
+	slot->done = done;
+	slot->arg = arg;
+#ifdef MSD_TRACE
+	slot->startTime = msdTimeStamp();
+#endif
+
+	retVal = dev->rmu_tx(slot->req, slot->reqLen);
+	if (retVal != MSD_OK)
+	{
+		MSD_DBG_ERROR(("rmu_tx returned: %s.\n", msdDisplayStatus(retVal)));
+		if (pipe->status == MSD_OK)
+		{
+			pipe->status = retVal;
+		}
+		return retVal;
+	}
+
+	slot->used = MSD_TRUE;
+	pipe->nPending++;
+
+	return MSD_OK;
+}
+
+MSD_STATUS msdRmuPipeEnd
+(
+    IN  MSD_U8    devNum
+)
+{
+	MSD_STATUS retVal;
+	MSD_RMU_PIPE *pipe;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	pipe = &msdRmuPipes[devNum];
+	if (pipe->active != MSD_TRUE)
+	{
+		MSD_DBG_ERROR(("msdRmuPipeBegin is not called.\n"));
+		return MSD_FAIL;
+	}
+
+	(void)msdRmuPipeWait(dev, pipe, 0U);
+
+	retVal = pipe->status;
+	pipe->active = MSD_FALSE;
+	msdSemGive(devNum, dev->multiAddrSem);
+
+	return retVal;
+}
+
+/*****************************************************************************
+* msdRmuPipeService
+*
+* DESCRIPTION:
+*       This function waits for one response frame and completes the request
+*       with the same DSA SeqNum. On timeout every request in flight is sent
+*       again, a request that used up its retries is completed with MSD_FAIL.
+*
+* INPUTS:
+*       pipe - The pipeline of the device.
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - a request completed
+*       MSD_FAIL  - timeout or unmatched frame
+*
+* COMMENTS:
+*       The slot is released before the callback runs, so the callback may
+*       submit the next request without recursion.
+*
+*******************************************************************************/
+static MSD_STATUS msdRmuPipeService(MSD_QD_DEV* dev, MSD_RMU_PIPE *pipe)
+{
+	MSD_STATUS retVal;
+	MSD_RMU_PIPE_SLOT *slot;
+	MSD_U32 rspLen = MSD_RMU_PIPE_RSP_SIZE;
+	MSD_U32 seqOffset = msdRmuSeqNumOffset(dev);
+	MSD_U32 i;
+
+	retVal = dev->rmu_rx(pipe->rsp, &rspLen, MSD_RMU_PIPE_TIMEOUT);
+	if ((retVal == MSD_OK) && (rspLen > seqOffset))
+	{
+		for (i = 0; i < MSD_RMU_PIPE_DEPTH; i++)
+		{
+			slot = &pipe->slot[i];
+			if ((slot->used == MSD_TRUE) && (slot->seqNum == pipe->rsp[seqOffset]))
+			{
+				slot->used = MSD_FALSE;
+				pipe->nPending--;
+				MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_RMU, dev->devNum, 0, 0, slot->startTime, MSD_OK);
+				slot->done(dev->devNum, MSD_OK, pipe->rsp, rspLen, slot->arg);
+				return MSD_OK;
+			}
+		}
+
+		/* late answer to a request that was already retried or failed */
+		MSD_DBG(("Drop RMU response with SeqNum %d.\n", pipe->rsp[seqOffset]));
+		return MSD_FAIL;
+	}
+
+	for (i = 0; i < MSD_RMU_PIPE_DEPTH; i++)
+	{
+		slot = &pipe->slot[i];
+		if (slot->used != MSD_TRUE)
+		{
+			continue;
+		}
+
+		if (slot->retry < MSD_RMU_PIPE_RETRY)
+		{
+			slot->retry++;
+			MSD_DBG(("Resend RMU request with SeqNum %d, retry %d.\n", slot->seqNum, slot->retry));
+			if (dev->rmu_tx(slot->req, slot->reqLen) == MSD_OK)
+			{
+				continue;
+			}
+		}
+
+		MSD_DBG_ERROR(("RMU request with SeqNum %d failed.\n", slot->seqNum));
+		slot->used = MSD_FALSE;
+		pipe->nPending--;
+		MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_RMU, dev->devNum, 0, 0, slot->startTime, MSD_FAIL);
+		if (pipe->status == MSD_OK)
+		{
+			pipe->status = MSD_FAIL;
+		}
+		slot->done(dev->devNum, MSD_FAIL, NULL, 0, slot->arg);
+	}
+
+	return MSD_FAIL;
+}
+
+/*****************************************************************************
+* msdRmuPipeWait
+*
+* DESCRIPTION:
+*       This function services responses until at most maxPending requests
+*       are in flight. A frame that completes nothing, either a timeout or
+*       an unmatched frame, counts as an idle round. After
+*       MSD_RMU_PIPE_MAX_IDLE idle rounds in a row every request still in
+*       flight is completed with MSD_FAIL.
+*
+* INPUTS:
+*       pipe       - The pipeline of the device.
+*       maxPending - requests allowed to stay in flight
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - at most maxPending requests are in flight
+*       MSD_FAIL  - the pipeline was aborted
+*
+* COMMENTS:
+*       Without the idle bound a link that keeps delivering foreign frames
+*       would never let the retry counters run out.
+*
+*******************************************************************************/
+static MSD_STATUS msdRmuPipeWait(MSD_QD_DEV* dev, MSD_RMU_PIPE *pipe, MSD_U32 maxPending)
+{
+	MSD_RMU_PIPE_SLOT *slot;
+	MSD_U32 idle = 0;
+	MSD_U32 i;
+
+	while (pipe->nPending > maxPending)
+	{
+		if (msdRmuPipeService(dev, pipe) == MSD_OK)
+		{
+			idle = 0;
+			continue;
+		}
+		if (++idle < MSD_RMU_PIPE_MAX_IDLE)
+		{
+			continue;
+		}
+
+		MSD_DBG_ERROR(("RMU pipe gave up with %d requests in flight.\n", (int)pipe->nPending));
+		if (pipe->status == MSD_OK)
+		{
+			pipe->status = MSD_FAIL;
+		}
+		for (i = 0; i < MSD_RMU_PIPE_DEPTH; i++)
+		{
+			slot = &pipe->slot[i];
+			if (slot->used != MSD_TRUE)
+			{
+				continue;
+			}
+			slot->used = MSD_FALSE;
+			pipe->nPending--;
+			MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_RMU, dev->devNum, 0, 0, slot->startTime, MSD_FAIL);
+			slot->done(dev->devNum, MSD_FAIL, NULL, 0, slot->arg);
+		}
+		return MSD_FAIL;
+	}
+
+	return MSD_OK;
+}
+
+static MSD_STATUS msdRmuPipeSync(MSD_QD_DEV* dev, MSD_RMU_PIPE *pipe, MSD_U8 *reqPkt, MSD_U32 reqPktLen,
+	MSD_RMU_DONE_CB done, void *arg)
+{
+	MSD_STATUS retVal = MSD_FAIL;
+	MSD_U8 *rspPkt = pipe->rsp;
+	MSD_U32 rspLen = 0;
+	MSD_U32 retry;
+
+	for (retry = 0; retry <= MSD_RMU_PIPE_RETRY; retry++)
+	{
+		rspPkt = pipe->rsp;
+		retVal = msdRmuTxRxPkt(dev, reqPkt, reqPktLen, &rspPkt, &rspLen);
+		if ((retVal == MSD_OK) && (rspLen != 0U))
+		{
+			done(dev->devNum, MSD_OK, rspPkt, rspLen, arg);
+			return MSD_OK;
+		}
+	}
+
+	MSD_DBG_ERROR(("rmu_tx_rx returned: %s with rsp_pktLen %d.\n", msdDisplayStatus(retVal), (int)rspLen));
+	if (pipe->status == MSD_OK)
+	{
+		pipe->status = MSD_FAIL;
+	}
+	done(dev->devNum, MSD_FAIL, NULL, 0, arg);
+	return MSD_FAIL;
+}
+
+/****************************************************************************/
+/* Shadow register cache functions.                                         */
+/****************************************************************************/
+
+#define MSD_REG_CACHE_INDEX(devAddr, regAddr)   ((((MSD_U32)(devAddr)) << 5) | ((MSD_U32)(regAddr)))
+#define MSD_REG_CACHE_BIT_TEST(map, idx)        (((map)[(idx) >> 5] >> ((idx) & 0x1FU)) & 0x1U)
+#define MSD_REG_CACHE_BIT_SET(map, idx)         ((map)[(idx) >> 5] |= (MSD_U32)(1UL << ((idx) & 0x1FU)))
+#define MSD_REG_CACHE_BIT_CLR(map, idx)         ((map)[(idx) >> 5] &= ~(MSD_U32)(1UL << ((idx) & 0x1FU)))
+
+/*******************************************************************************
+* msdRegCacheEnable
+*
+* DESCRIPTION:
+*       This function enables or disables the shadow register cache. When it
+*       is enabled, reads of the registers marked cacheable are served from
+*       RAM after the first hardware access, writes go through to the
+*       hardware and update the RAM copy.
+*
+* INPUTS:
+*       devNum - physical device number
+*       enable - MSD_TRUE to enable, MSD_FALSE to disable
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Every cached value is dropped, the next read of each register goes
+*       to the hardware. The cacheable set is kept.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheEnable
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_BOOL  enable
+)
+{
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
+	msdMemSet(dev->regCache.valid, 0, sizeof(dev->regCache.valid));
+	dev->regCache.hits = 0;
+	dev->regCache.misses = 0;
+	dev->regCache.enable = enable;
+	msdSemGive(devNum, dev->multiAddrSem);
+
+	return MSD_OK;
+}
+
+/*******************************************************************************
+* msdRegCacheSetCacheable
+*
+* DESCRIPTION:
+*       This function marks one register as cacheable (static configuration)
+*       or volatile. Reads of a volatile register always access the hardware.
+*
+* INPUTS:
+*       devNum    - physical device number
+*       devAddr   - device register.
+*       regAddr   - The register's address.
+*       cacheable - MSD_TRUE for a static register, MSD_FALSE for a volatile one
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       Every register is volatile after msdLoadDriver. The hardware
+*       semaphore register can never be cached.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheSetCacheable
+(
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_BOOL  cacheable
+)
+{
+	MSD_U32 idx;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	if ((devAddr > 0x1FU) || (regAddr > 0x1FU) || (regAddr == OS_HW_SEMAPHORE_REG))
+	{
+		MSD_DBG_ERROR(("Bad register devAddr 0x%02x regAddr 0x%02x.\n", devAddr, regAddr));
+		return MSD_BAD_PARAM;
+	}
+
+	idx = MSD_REG_CACHE_INDEX(devAddr, regAddr);
+
+	msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
+	MSD_REG_CACHE_BIT_CLR(dev->regCache.valid, idx);
+	if (cacheable == MSD_TRUE)
+	{
+		MSD_REG_CACHE_BIT_SET(dev->regCache.cacheable, idx);
+	}
+	else
+	{
+		MSD_REG_CACHE_BIT_CLR(dev->regCache.cacheable, idx);
+	}
+	msdSemGive(devNum, dev->multiAddrSem);
+
+	return MSD_OK;
+}
+
+/*******************************************************************************
+* msdRegCacheInvalidate
+*
+* DESCRIPTION:
+*       This function drops every cached value, the next read of each
+*       register goes to the hardware.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None.
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       Must be called after anything changes the switch registers behind the
+*       driver, such as a switch reset, an EEPROM load or another SMI master.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheInvalidate
+(
+    IN  MSD_U8    devNum
+)
+{
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
+	msdMemSet(dev->regCache.valid, 0, sizeof(dev->regCache.valid));
+	msdSemGive(devNum, dev->multiAddrSem);
+
+	return MSD_OK;
+}
+
+/*******************************************************************************
+* msdRegCacheResync
+*
+* DESCRIPTION:
+*       This function reads back every cached register from the hardware,
+*       refreshes the RAM copy and counts the registers that did not match.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       mismatch - number of cached values that differed from the hardware,
+*                  may be NULL
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*
+* COMMENTS:
+*       A register that fails to read is dropped from the cache.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheResync
+(
+    IN  MSD_U8    devNum,
+    OUT MSD_U32   *mismatch
+)
+{
+	MSD_STATUS retVal = MSD_OK;
+	MSD_STATUS status;
+	MSD_U32 idx;
+	MSD_U32 count = 0;
+	MSD_U16 data;
+	MSD_U8 devAddr, regAddr;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	msdSemTake(devNum, dev->multiAddrSem, OS_WAIT_FOREVER);
+	for (idx = 0; idx < MSD_REG_CACHE_SIZE; idx++)
+	{
+		if (MSD_REG_CACHE_BIT_TEST(dev->regCache.valid, idx) == 0U)
+		{
+			continue;
+		}
+
+		devAddr = (MSD_U8)(idx >> 5);
+		regAddr = (MSD_U8)(idx & 0x1FU);
+		if (IS_RMU_SUPPORTED(dev))
+		{
+			status = msdRmuRegRead(dev, devAddr, regAddr, &data);
+		}
+		else
+		{
+			status = msdRegBatchSmiRead(dev, devAddr, regAddr, &data);
+		}
+
+		if (status != MSD_OK)
+		{
+			MSD_REG_CACHE_BIT_CLR(dev->regCache.valid, idx);
+			retVal = status;
+			continue;
+		}
+
+		if (dev->regCache.data[idx] != data)
+		{
+			MSD_DBG_ERROR(("Cache mismatch devAddr 0x%02x regAddr 0x%02x: 0x%04x != 0x%04x.\n",
+				devAddr, regAddr, dev->regCache.data[idx], data));
+			dev->regCache.data[idx] = data;
+			count++;
+		}
+	}
+	msdSemGive(devNum, dev->multiAddrSem);
+
+	if (mismatch != NULL)
+	{
+		*mismatch = count;
+	}
+
+	return retVal;
+}
+
+/*******************************************************************************
+* msdRegCacheStatsGet
+*
+* DESCRIPTION:
+*       This function gets the number of register reads served from RAM and
+*       the number of cacheable reads that went to the hardware since the
+*       cache was enabled.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       hits   - reads served from RAM
+*       misses - reads of cacheable registers that accessed the hardware
+*
+* RETURNS:
+*       MSD_OK  - on success
+*       MSD_FAIL  - on error
+*       MSD_BAD_PARAM - if invalid parameter is given
+*
+* COMMENTS:
+*       None.
+*
+*******************************************************************************/
+MSD_STATUS msdRegCacheStatsGet
+(
+    IN  MSD_U8    devNum,
+    OUT MSD_U32   *hits,
+    OUT MSD_U32   *misses
+)
+{
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		return MSD_FAIL;
+	}
+
+	if ((hits == NULL) || (misses == NULL))
+	{
+		MSD_DBG_ERROR(("Input param is NULL.\n"));
+		return MSD_BAD_PARAM;
+	}
+
+	*hits = dev->regCache.hits;
+	*misses = dev->regCache.misses;
+
+	return MSD_OK;
+}
+
+/* The helpers below are called with dev->multiAddrSem held */
+static MSD_BOOL msdRegCacheLookup(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, OUT MSD_U16* value)
+{
+	MSD_U32 idx;
+
+	if ((dev->regCache.enable != MSD_TRUE) || (devAddr > 0x1FU) || (regAddr > 0x1FU))
+	{
+		return MSD_FALSE;
+	}
+
+	idx = MSD_REG_CACHE_INDEX(devAddr, regAddr);
+	if (MSD_REG_CACHE_BIT_TEST(dev->regCache.cacheable, idx) == 0U)
+	{
+		return MSD_FALSE;
+	}
+
+	if (MSD_REG_CACHE_BIT_TEST(dev->regCache.valid, idx) == 0U)
+	{
+		dev->regCache.misses++;
+		return MSD_FALSE;
+	}
+
+	dev->regCache.hits++;
+	*value = dev->regCache.data[idx];
+	return MSD_TRUE;
+}
+
+static void msdRegCacheUpdate(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr, MSD_U16 value)
+{
+	MSD_U32 idx;
+
+	if ((dev->regCache.enable != MSD_TRUE) || (devAddr > 0x1FU) || (regAddr > 0x1FU))
+	{
+		return;
+	}
+
+	idx = MSD_REG_CACHE_INDEX(devAddr, regAddr);
+	if (MSD_REG_CACHE_BIT_TEST(dev->regCache.cacheable, idx) != 0U)
+	{
+		dev->regCache.data[idx] = value;
+		MSD_REG_CACHE_BIT_SET(dev->regCache.valid, idx);
+	}
+}
+
+static void msdRegCacheDrop(MSD_QD_DEV* dev, MSD_U8 devAddr, MSD_U8 regAddr)
+{
+	MSD_U32 idx;
+
+	if ((devAddr > 0x1FU) || (regAddr > 0x1FU))
+	{
+		return;
+	}
+
+	idx = MSD_REG_CACHE_INDEX(devAddr, regAddr);
+	MSD_REG_CACHE_BIT_CLR(dev->regCache.valid, idx);
+}
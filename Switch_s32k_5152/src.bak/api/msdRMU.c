@@ -0,0 +1,81 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+
+/********************************************************************************
+* msdRMU.c
+*
+* DESCRIPTION:
+*       API definitions for RMU table dumps
+*
+* DEPENDENCIES:
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+#include <msdRMU.h>
+#include <msdApiTypes.h>
+#include <msdUtils.h>
+
+/*******************************************************************************
+* msdRMUAtuEntryDump
+*
+* DESCRIPTION:
+*       Dump ATU entries from the specified starting address through RMU.
+*       One call returns the entries of one Dump ATU response frame.
+*
+* INPUTS:
+*       devNum    - physical device number
+*       startAddr - starting address to search the valid entry, 0 for the
+*                   first call
+*
+* OUTPUTS:
+*       startAddr  - continuation code for the next call, 0 when the whole
+*                    table has been dumped
+*       numOfEntry - number of returned valid entries, at most MSD_RMU_MAX_ATUS
+*       atuEntry   - returned valid ATU entries
+*
+* RETURNS:
+*       MSD_OK - On success
+*		MSD_FAIL - On error
+*		MSD_BAD_PARAM - If invalid parameter is given
+*		MSD_NOT_SUPPORTED - Device not support, or RMU is not the register
+*                           access interface
+*
+* COMMENTS:
+*       atuEntry must hold MSD_RMU_MAX_ATUS pointers to valid storage.
+*
+*******************************************************************************/
+MSD_STATUS msdRMUAtuEntryDump
+(
+    IN MSD_U8 devNum,
+    INOUT MSD_U32 *startAddr,
+    OUT MSD_U32 *numOfEntry,
+    OUT MSD_ATU_ENTRY **atuEntry
+)
+{
+	MSD_STATUS  retVal;
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		MSD_DBG_ERROR(("Dev is NULL for devNum %d.\n", devNum));
+		retVal = MSD_FAIL;
+	}
+	else
+	{
+		if (dev->SwitchDevObj.RMUObj.grmuAtuDump != NULL)
+		{
+			retVal = dev->SwitchDevObj.RMUObj.grmuAtuDump(dev, startAddr, numOfEntry, atuEntry);
+		}
+		else
+		{
+			retVal = MSD_NOT_SUPPORTED;
+		}
+	}
+
+	return retVal;
+}
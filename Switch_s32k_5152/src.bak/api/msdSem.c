@@ -19,8 +19,179 @@
 
 #include <msdSem.h>
 #include <msdHwAccess.h>
+#include <msdUtils.h>
 
-static MSD_U32 refCnt = 0;
+/* The guard is taken through the BSP hook directly, msdSemTake would recurse into the hardware semaphore */
+static void hwSemGuardTake(MSD_QD_DEV* dev)
+{
+	if ((dev->semTake != NULL) && (dev->hwSem.guard != 0U))
+	{
+		(void)dev->semTake(dev->hwSem.guard, OS_WAIT_FOREVER);
+	}
+}
+
+static void hwSemGuardGive(MSD_QD_DEV* dev)
+{
+	if ((dev->semGive != NULL) && (dev->hwSem.guard != 0U))
+	{
+		(void)dev->semGive(dev->hwSem.guard);
+	}
+}
+
+/*******************************************************************************
+* hwSemAcquire
+*
+* DESCRIPTION:
+*       Take the hardware semaphore for the host. Nested takes only bump the
+*       hold count in RAM; the first take writes the semaphore value to G1
+*       offset 0x15 until it reads back, backing off exponentially once the
+*       first MSD_HW_SEM_FAST_SPINS attempts failed. The RAM guard is released
+*       while backing off, so another task of the host may take the hardware
+*       semaphore meanwhile; the waiting task then joins it as a nested take.
+*       msdDelay sleeps whole ticks of MSD_HW_SEM_TICK_US, so the time waited
+*       is counted in ticks against MSD_HW_SEM_TIMEOUT.
+*
+* RETURNS:
+*       MSD_OK   - on success
+*       MSD_BUSY - the semaphore was not released within MSD_HW_SEM_TIMEOUT
+*       MSD_FAIL - on register access error
+*
+*******************************************************************************/
+static MSD_STATUS hwSemAcquire
+(
+    IN MSD_U8  devNum,
+    IN MSD_QD_DEV* dev
+)
+{
+	MSD_STATUS retVal = MSD_OK;
+	MSD_HW_SEM_STATE *hwSem = &dev->hwSem;
+	MSD_U16 tmpSem = 0;
+	MSD_U32 spins = 0;
+	MSD_U32 backoff = MSD_HW_SEM_BACKOFF_MIN;
+	MSD_U32 waited = 0;     /* in ticks */
+
+	hwSemGuardTake(dev);
+
+	if (hwSem->holdCnt != 0U)
+	{
+		/* already held by this host, no register access */
+		hwSem->holdCnt += 1U;
+		hwSem->stats.nested += 1U;
+		hwSemGuardGive(dev);
+		return MSD_OK;
+	}
+
+	while (1)
+	{
+		/* write semaphore value to hardware G1, offset 0x15 */
+		retVal = msdSetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, dev->HWSemaphore);
+		if (retVal != MSD_OK)
+		{
+			break;
+		}
+
+		/* read back semaphore value from hardware G1, offset 0x15 */
+		retVal = msdGetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, &tmpSem);
+		if (retVal != MSD_OK)
+		{
+			break;
+		}
+		spins += 1U;
+
+		/* if read back value equal to 0x0 or semaphore value, means take hardware semaphore successfully */
+		if (tmpSem == 0U || tmpSem == (MSD_U16)dev->HWSemaphore)
+		{
+			hwSem->holdCnt = 1U;
+			hwSem->holdStart = msdTimeStamp();
+			hwSem->stats.acquires += 1U;
+			break;
+		}
+
+		if (spins >= MSD_HW_SEM_FAST_SPINS)
+		{
+			if (waited >= (MSD_HW_SEM_TIMEOUT / MSD_HW_SEM_TICK_US))
+			{
+				MSD_DBG_ERROR(("Hardware semaphore held by 0x%x, timeout.\n", tmpSem));
+				hwSem->stats.timeouts += 1U;
+				retVal = MSD_BUSY;
+				break;
+			}
+			hwSemGuardGive(dev);
+			msdDelay(backoff);
+			hwSemGuardTake(dev);
+			waited += (backoff + MSD_HW_SEM_TICK_US - 1U) / MSD_HW_SEM_TICK_US;
+			if (hwSem->holdCnt != 0U)
+			{
+				/* another task of this host took it while backing off */
+				hwSem->holdCnt += 1U;
+				hwSem->stats.nested += 1U;
+				break;
+			}
+			if (backoff < MSD_HW_SEM_BACKOFF_MAX)
+			{
+				backoff = ((backoff << 1) < MSD_HW_SEM_BACKOFF_MAX) ? (backoff << 1) : MSD_HW_SEM_BACKOFF_MAX;
+			}
+		}
+	}
+
+	if (spins > 1U)
+	{
+		hwSem->stats.contended += 1U;
+		hwSem->stats.spins += spins;
+	}
+	if (spins > hwSem->stats.maxSpins)
+	{
+		hwSem->stats.maxSpins = spins;
+	}
+
+	hwSemGuardGive(dev);
+	return retVal;
+}
+
+/*******************************************************************************
+* hwSemRelease
+*
+* DESCRIPTION:
+*       Drop one hold of the hardware semaphore, writing 0x0 to G1 offset 0x15
+*       when the last hold of the host is released.
+*
+*******************************************************************************/
+static MSD_STATUS hwSemRelease
+(
+    IN MSD_U8  devNum,
+    IN MSD_QD_DEV* dev
+)
+{
+	MSD_STATUS retVal = MSD_OK;
+	MSD_HW_SEM_STATE *hwSem = &dev->hwSem;
+	MSD_U32 held;
+
+	hwSemGuardTake(dev);
+
+	if (hwSem->holdCnt == 0U)
+	{
+		MSD_DBG_ERROR(("Hardware semaphore released without take.\n"));
+		hwSemGuardGive(dev);
+		return MSD_FAIL;
+	}
+
+	hwSem->holdCnt -= 1U;
+	if (hwSem->holdCnt == 0U)
+	{
+		held = msdTimeStamp() - hwSem->holdStart;
+		hwSem->stats.holdTime += held;
+		if (held > hwSem->stats.maxHoldTime)
+		{
+			hwSem->stats.maxHoldTime = held;
+		}
+
+		/* write 0x0 to hardware G1, offset 0x15 semaphore register, release semaphore */
+		retVal = msdSetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, 0x0);
+	}
+
+	hwSemGuardGive(dev);
+	return retVal;
+}
 
 /*******************************************************************************
 * msdSemCreate
@@ -147,8 +318,6 @@ MSD_STATUS msdSemTake
 )
 {
 	MSD_STATUS retVal;
-	MSD_U16 tmpSem = 0;
-	MSD_BOOL flag = MSD_TRUE;
 
 	/* initial device structure */
 	MSD_QD_DEV* dev = sohoDevGet(devNum);
@@ -160,47 +329,11 @@ MSD_STATUS msdSemTake
 	{
 		if (dev->HWSemaphore != MSD_HW_SEM_DISABLE)
 		{
-			/* read back semaphore value from hardware G1, offset 0x15 */
-			retVal = msdGetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, &tmpSem);
+			retVal = hwSemAcquire(devNum, dev);
 			if (retVal != MSD_OK)
 			{
 				return retVal;
 			}
-
-			/* if read back value match semaphore value, means already take hardware semaphore successfully */
-			if (tmpSem == dev->HWSemaphore)
-			{
-				/*  recursive semaphore count increment */
-				refCnt += 1U;
-			}
-			else
-			{
-				/* wait until semaphore take success */
-				while (flag == MSD_TRUE)
-				{
-					/* write semaphore value to hardware G1, offset 0x15 */
-					retVal = msdSetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, dev->HWSemaphore);
-					if (retVal != MSD_OK)
-					{
-						return retVal;
-					}
-
-					/* read back semaphore value from hardware G1, offset 0x15 */
-					retVal = msdGetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, &tmpSem);
-					if (retVal != MSD_OK)
-					{
-						return retVal;
-					}
-
-					/* if read back value equal to 0x0 or semaphore value, means take hardware semaphore successfully */
-					if (tmpSem == 0U || tmpSem == dev->HWSemaphore)
-					{
-						/*  recursive semaphore count increment */
-						refCnt += 1U;
-						break;
-					}
-				}
-			}
 		}
 
 		/* software semaphore takes */
@@ -212,6 +345,12 @@ MSD_STATUS msdSemTake
 		{
 			retVal = MSD_FAIL;
 		}
+
+		/* do not keep the hardware semaphore when the software one timed out, msdSemGive will not follow */
+		if ((retVal != MSD_OK) && (dev->semTake != NULL) && (dev->HWSemaphore != MSD_HW_SEM_DISABLE))
+		{
+			(void)hwSemRelease(devNum, dev);
+		}
 	}
 
 	return retVal;
@@ -253,17 +392,10 @@ MSD_STATUS msdSemGive
 	{
 		if (dev->HWSemaphore != MSD_HW_SEM_DISABLE)
 		{
-			/*  recursive semaphore count decrement*/
-			refCnt -= 1U;
-
-			/* write 0x0 to hardware G1, offset 0x15 semaphore register, release semaphore */
-			if (refCnt == 0U)
+			retVal = hwSemRelease(devNum, dev);
+			if (retVal != MSD_OK)
 			{
-				retVal = msdSetAnyReg(devNum, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, 0x0);
-				if (retVal != MSD_OK)
-				{
-					return retVal;
-				}
+				return retVal;
 			}
 		}
 
@@ -280,3 +412,80 @@ MSD_STATUS msdSemGive
 
 	return retVal;
 }
+
+/*******************************************************************************
+* msdHwSemStatsGet
+*
+* DESCRIPTION:
+*       Get the hardware semaphore statistics of the device.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       stats  - acquisition, contention and hold time counters
+*
+* RETURNS:
+*       MSD_OK   - on success
+*       MSD_FAIL - on error
+*
+* COMMENTS:
+*       Hold times are in msdTimeStamp units.
+*
+*******************************************************************************/
+MSD_STATUS msdHwSemStatsGet
+(
+    IN  MSD_U8	    devNum,
+    OUT MSD_HW_SEM_STATS *stats
+)
+{
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if ((NULL == dev) || (NULL == stats))
+	{
+		return MSD_FAIL;
+	}
+
+	hwSemGuardTake(dev);
+	msdMemCpy(stats, &dev->hwSem.stats, sizeof(MSD_HW_SEM_STATS));
+	hwSemGuardGive(dev);
+
+	return MSD_OK;
+}
+
+/*******************************************************************************
+* msdHwSemStatsClear
+*
+* DESCRIPTION:
+*       Clear the hardware semaphore statistics of the device.
+*
+* INPUTS:
+*       devNum - physical device number
+*
+* OUTPUTS:
+*       None
+*
+* RETURNS:
+*       MSD_OK   - on success
+*       MSD_FAIL - on error
+*
+* COMMENTS:
+*       None
+*
+*******************************************************************************/
+MSD_STATUS msdHwSemStatsClear
+(
+    IN MSD_U8	    devNum
+)
+{
+	MSD_QD_DEV* dev = sohoDevGet(devNum);
+	if (NULL == dev)
+	{
+		return MSD_FAIL;
+	}
+
+	hwSemGuardTake(dev);
+	msdMemSet(&dev->hwSem.stats, 0, sizeof(MSD_HW_SEM_STATS));
+	hwSemGuardGive(dev);
+
+	return MSD_OK;
+}
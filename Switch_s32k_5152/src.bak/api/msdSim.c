@@ -0,0 +1,1343 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+/********************************************************************************
+* msdSim.c
+*
+* DESCRIPTION:
+*       Register level Fir switch model implementing the MSD BSP callbacks.
+*       Compiled only when MSD_SIM is defined.
+*
+* DEPENDENCIES:
+*       None.
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+#include <msdSim.h>
+#include <msdHwAccess.h>
+#include <msdUtils.h>
+#include <Fir_msdDrvSwRegs.h>
+
+#ifdef MSD_SIM
+
+#define SIM_NUM_DEV_ADDR            32U
+#define SIM_NUM_REGS                32U
+#define SIM_BUSY_BIT                ((MSD_U16)0x8000)
+#define SIM_TCAM_PAGE_WORDS         26U     /* offsets 0x02 to 0x1B */
+#define SIM_TCAM_EGR_WORDS          4U      /* offsets 0x02 to 0x05 */
+#define SIM_TCAM_EGR_PORTS          16U
+#define SIM_TCAM_KEY1_INVALID       ((MSD_U16)0x00FF)
+#define SIM_NUM_PORTS               11U     /* width of the port vectors and the PAV */
+#define SIM_READ_LEARN_CNT          ((MSD_U16)0x8000)   /* Port ATU Control ReadLearnCnt */
+#define SIM_KEEP_OLD_LEARN_LIMIT    ((MSD_U16)0x1000)   /* Port ATU Control KeepOldLearnLimit */
+#define SIM_LEARN_LIMIT_MASK        ((MSD_U16)0x03FF)
+#define SIM_ATU_PROB                ((MSD_U16)0x0008)   /* Global Status ATUProb */
+#define SIM_ATU_FULL_VIOLATION      ((MSD_U16)0x0001)
+#define SIM_HW_SEMAPHORE_REG        0x15U   /* Global 1 hardware semaphore */
+#define SIM_MDIO_DEV_TYPE           3U      /* MMD device type of the switch registers */
+#define SIM_MDIO_REG_BASE           0x8000U /* Clause 45 address of register 0 */
+
+#define SIM_RMU_REQ_CODE_REGRW      0x2000U
+#define SIM_RMU_REQ_CODE_DUMP_ATU   0x1000U
+#define SIM_RMU_ATU_ENTRY_SIZE      14U     /* see FIR_RMU_ATU_ENTRY_SIZE */
+#define SIM_RMU_END_OF_FRAME        0xFFFFFFFFU
+#define SIM_RMU_WAIT_ON_BIT_LIMIT   1000U
+
+/* default latency model: 2.5MHz MDC, a Clause 45 access is two 64 bit frames */
+static const MSD_SIM_CONFIG s_simDefaultCfg =
+{
+	51200U,     /* smiAccessTime */
+	25600U,     /* burstReadTime */
+	40000U,     /* rmuFrameTime */
+	100U,       /* rmuCmdTime */
+	2000U,      /* atuOpTime */
+	1500U,      /* vtuOpTime */
+	3000U,      /* tcamOpTime */
+	1000U,      /* otherOpTime */
+	25600U,     /* mdioFrameTime, one 64 bit frame at 2.5MHz MDC */
+	NULL        /* delay */
+};
+
+typedef struct
+{
+	MSD_U16     fid;
+	MSD_U8      mac[6];
+	MSD_U16     data;       /* ATU Data register: LAG, port vector, entry state */
+	MSD_U16     pri;        /* ATU Operation register bits 10:8 and 2:0 */
+} SIM_ATU_ENTRY;
+
+/* the ATU violation latched until a service violations operation reads it */
+typedef struct
+{
+	MSD_BOOL    pending;
+	MSD_U16     cause;      /* ATU Operation register bits 7:4 */
+	MSD_U16     fid;
+	MSD_U8      mac[6];
+	MSD_U8      spid;
+} SIM_ATU_VIOLATION;
+
+typedef struct
+{
+	MSD_U16     key;        /* page << 12 | vid */
+	MSD_U16     sid;        /* STU SID register */
+	MSD_U16     fid;        /* VTU FID register */
+	MSD_U16     data1;
+	MSD_U16     data2;
+} SIM_VTU_ENTRY;
+
+/* self clearing operation registers, bit 15 is the busy/update bit */
+typedef struct
+{
+	MSD_U8      devAddr;
+	MSD_U8      regAddr;
+} SIM_OP_REG;
+
+static const SIM_OP_REG s_simOpRegs[] =
+{
+	{ FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION },
+	{ FIR_GLOBAL1_DEV_ADDR, FIR_ATU_OPERATION },
+	{ FIR_GLOBAL1_DEV_ADDR, FIR_EXTENDED_G_CONTROL_CMD },
+	{ FIR_GLOBAL1_DEV_ADDR, FIR_STATS_OPERATION },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_ROUTING_TBL },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_TRUNK_MASK_TBL },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_TRUNK_ROUTING },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_IGR_RATE_COMMAND },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_PVT_ADDR },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_SWITCH_MAC },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_PRIORITY_OVERRIDE },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_EEPROM_COMMAND },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_AVB_COMMAND },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_SMI_PHY_CMD },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_SCRATCH_MISC },
+	{ FIR_GLOBAL2_DEV_ADDR, FIR_QOS_WEIGHT },
+	{ FIR_TCAM_DEV_ADDR, FIR_TCAM_OPERATION }
+};
+#define SIM_NUM_OP_REGS     (sizeof(s_simOpRegs) / sizeof(s_simOpRegs[0]))
+
+static MSD_SIM_CONFIG s_simCfg;
+static MSD_SIM_STATS s_simStats;
+static MSD_U64 s_simClock = 0;
+
+static MSD_U16 s_simRegs[SIM_NUM_DEV_ADDR][SIM_NUM_REGS];
+static MSD_U64 s_simBusyUntil[SIM_NUM_DEV_ADDR][SIM_NUM_REGS];
+
+static SIM_ATU_ENTRY s_simAtu[MSD_SIM_ATU_SIZE];     /* sorted by fid, mac */
+static MSD_U32 s_simAtuCount = 0;
+static SIM_ATU_VIOLATION s_simAtuViolation;
+static SIM_VTU_ENTRY s_simVtu[MSD_SIM_VTU_SIZE];     /* sorted by key */
+static MSD_U32 s_simVtuCount = 0;
+static MSD_U16 s_simTcam[MSD_SIM_TCAM_SIZE][3][SIM_TCAM_PAGE_WORDS];
+static MSD_U16 s_simTcamEgr[SIM_TCAM_EGR_PORTS][MSD_SIM_TCAM_EGR_SIZE][SIM_TCAM_EGR_WORDS];
+
+static MSD_U16 s_simMdioAddr[SIM_NUM_DEV_ADDR];     /* Clause 45 address register per PHY address */
+static MSD_BOOL s_simMdioInc[SIM_NUM_DEV_ADDR];     /* the last frame was a post read increment frame */
+
+static MSD_32 s_simSemCount[MSD_SIM_MAX_SEMAPHORES];
+static MSD_BOOL s_simSemUsed[MSD_SIM_MAX_SEMAPHORES];
+
+/****************************************************************************/
+/* Clock and register file                                                  */
+/****************************************************************************/
+
+static void simAdvance(MSD_U32 nSec)
+{
+	s_simClock += nSec;
+	if (s_simCfg.delay != NULL)
+	{
+		s_simCfg.delay(nSec);
+	}
+}
+
+static MSD_BOOL simIsOpReg(MSD_U8 devAddr, MSD_U8 regAddr)
+{
+	MSD_U32 i;
+
+	/* Extended Port Control Operation register of every port */
+	if ((devAddr < FIR_GLOBAL1_DEV_ADDR) && (regAddr == FIR_EXT_PORT_CTRL_CMD))
+	{
+		return MSD_TRUE;
+	}
+	for (i = 0; i < SIM_NUM_OP_REGS; i++)
+	{
+		if ((s_simOpRegs[i].devAddr == devAddr) && (s_simOpRegs[i].regAddr == regAddr))
+		{
+			return MSD_TRUE;
+		}
+	}
+	return MSD_FALSE;
+}
+
+static MSD_U16 simAtuLearnCount(MSD_U8 port);
+
+static MSD_U16 simRegRead(MSD_U8 devAddr, MSD_U8 regAddr, MSD_U32 cost)
+{
+	MSD_U16 value;
+
+	devAddr &= (MSD_U8)(SIM_NUM_DEV_ADDR - 1U);
+	regAddr &= (MSD_U8)(SIM_NUM_REGS - 1U);
+
+	simAdvance(cost);
+	s_simStats.reads++;
+
+	value = s_simRegs[devAddr][regAddr];
+	if ((devAddr < FIR_GLOBAL1_DEV_ADDR) && (regAddr == FIR_PORT_ATU_CONTROL) && ((value & SIM_READ_LEARN_CNT) != 0U))
+	{
+		return (MSD_U16)((value & (MSD_U16)~SIM_LEARN_LIMIT_MASK) | simAtuLearnCount(devAddr));
+	}
+	if (((value & SIM_BUSY_BIT) != 0U) && (simIsOpReg(devAddr, regAddr) == MSD_TRUE))
+	{
+		if (s_simClock >= s_simBusyUntil[devAddr][regAddr])
+		{
+			value &= (MSD_U16)~SIM_BUSY_BIT;
+			s_simRegs[devAddr][regAddr] = value;
+		}
+		else
+		{
+			s_simStats.busyPolls++;
+		}
+	}
+	return value;
+}
+
+/****************************************************************************/
+/* ATU                                                                      */
+/****************************************************************************/
+
+static int simAtuCmp(MSD_U16 fid, const MSD_U8 *mac, const SIM_ATU_ENTRY *entry)
+{
+	MSD_U32 i;
+
+	if (fid != entry->fid)
+	{
+		return (fid < entry->fid) ? -1 : 1;
+	}
+	for (i = 0; i < 6U; i++)
+	{
+		if (mac[i] != entry->mac[i])
+		{
+			return (mac[i] < entry->mac[i]) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+/* index of the first entry not below fid/mac, or above it when upper is set */
+static MSD_U32 simAtuSearch(MSD_U16 fid, const MSD_U8 *mac, MSD_BOOL upper)
+{
+	MSD_U32 lo = 0;
+	MSD_U32 hi = s_simAtuCount;
+	MSD_U32 mid;
+	int cmp;
+
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2U;
+		cmp = simAtuCmp(fid, mac, &s_simAtu[mid]);
+		if ((cmp > 0) || ((cmp == 0) && (upper == MSD_TRUE)))
+		{
+			lo = mid + 1U;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static MSD_BOOL simAtuIsStatic(const SIM_ATU_ENTRY *entry)
+{
+	/* multicast entries are always static, unicast states 0x8 to 0xF are static */
+	return (((entry->mac[0] & 0x1U) != 0U) || ((entry->data & 0xFU) >= 0x8U)) ? MSD_TRUE : MSD_FALSE;
+}
+
+/* dynamic entries of the port, counted only while its learn limit is set */
+static MSD_U16 simAtuLearnCount(MSD_U8 port)
+{
+	MSD_U16 portVec = (MSD_U16)(1U << port);
+	MSD_U16 count = 0;
+	MSD_U32 i;
+
+	if ((s_simRegs[port][FIR_PORT_ATU_CONTROL] & SIM_LEARN_LIMIT_MASK) == 0U)
+	{
+		return 0;
+	}
+	for (i = 0; i < s_simAtuCount; i++)
+	{
+		if ((simAtuIsStatic(&s_simAtu[i]) == MSD_FALSE) && (((s_simAtu[i].data >> 4) & 0x7FFU) == portVec))
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+static void simAtuMacGet(MSD_U8 *mac)
+{
+	MSD_U32 i;
+	MSD_U16 data;
+
+	for (i = 0; i < 3U; i++)
+	{
+		data = s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_MAC_BASE + i];
+		mac[2U * i] = (MSD_U8)(data >> 8);
+		mac[(2U * i) + 1U] = (MSD_U8)(data & 0xFFU);
+	}
+}
+
+static void simAtuMacSet(const MSD_U8 *mac)
+{
+	MSD_U32 i;
+
+	for (i = 0; i < 3U; i++)
+	{
+		s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_MAC_BASE + i] = (MSD_U16)(((MSD_U16)mac[2U * i] << 8) | mac[(2U * i) + 1U]);
+	}
+}
+
+static void simAtuRemove(MSD_U32 index)
+{
+	MSD_U32 i;
+
+	for (i = index + 1U; i < s_simAtuCount; i++)
+	{
+		s_simAtu[i - 1U] = s_simAtu[i];
+	}
+	s_simAtuCount--;
+}
+
+static void simAtuLoadPurge(MSD_U16 fid, MSD_U16 opReg)
+{
+	MSD_U8 mac[6];
+	MSD_U16 data = s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_DATA_REG];
+	MSD_U32 index, i;
+	MSD_BOOL found;
+
+	simAtuMacGet(mac);
+	index = simAtuSearch(fid, mac, MSD_FALSE);
+	found = ((index < s_simAtuCount) && (simAtuCmp(fid, mac, &s_simAtu[index]) == 0)) ? MSD_TRUE : MSD_FALSE;
+
+	if ((data & 0xFU) == 0U)
+	{
+		if (found == MSD_TRUE)
+		{
+			simAtuRemove(index);
+		}
+		return;
+	}
+
+	if (found == MSD_FALSE)
+	{
+		if (s_simAtuCount >= MSD_SIM_ATU_SIZE)
+		{
+			/* ATU full, the entry is dropped */
+			return;
+		}
+		for (i = s_simAtuCount; i > index; i--)
+		{
+			s_simAtu[i] = s_simAtu[i - 1U];
+		}
+		s_simAtuCount++;
+		s_simAtu[index].fid = fid;
+		msdMemCpy(s_simAtu[index].mac, mac, 6);
+	}
+	s_simAtu[index].data = data;
+	s_simAtu[index].pri = (MSD_U16)(opReg & 0x0707U);
+}
+
+static void simAtuGetNext(MSD_U16 fid)
+{
+	static const MSD_U8 bcast[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	static const MSD_U8 zero[6] = { 0, 0, 0, 0, 0, 0 };
+	MSD_U8 mac[6];
+	MSD_U32 index;
+	MSD_U16 *opReg = &s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_OPERATION];
+
+	/* the search starts over after the broadcast address */
+	simAtuMacGet(mac);
+	if ((mac[0] & mac[1] & mac[2] & mac[3] & mac[4] & mac[5]) == 0xFFU)
+	{
+		index = simAtuSearch(fid, zero, MSD_FALSE);
+	}
+	else
+	{
+		index = simAtuSearch(fid, mac, MSD_TRUE);
+	}
+
+	if ((index < s_simAtuCount) && (s_simAtu[index].fid == fid))
+	{
+		simAtuMacSet(s_simAtu[index].mac);
+		s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_DATA_REG] = s_simAtu[index].data;
+		*opReg = (MSD_U16)((*opReg & (MSD_U16)~0x0707U) | s_simAtu[index].pri);
+	}
+	else
+	{
+		simAtuMacSet(bcast);
+		s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_DATA_REG] = 0;
+		*opReg &= (MSD_U16)~0x0707U;
+	}
+}
+
+static void simAtuFlush(MSD_U16 fid, MSD_BOOL inDb, MSD_BOOL nonStaticOnly)
+{
+	MSD_U16 data = s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_DATA_REG];
+	MSD_BOOL move = ((data & 0xFU) == 0xFU) ? MSD_TRUE : MSD_FALSE;
+	MSD_U16 fromPort = (MSD_U16)((data >> 4) & 0x1FU);
+	MSD_U16 toPort = (MSD_U16)((data >> 9) & 0x1FU);
+	MSD_U16 portVec;
+	MSD_U32 i = 0;
+	SIM_ATU_ENTRY *entry;
+
+	while (i < s_simAtuCount)
+	{
+		entry = &s_simAtu[i];
+		if (((inDb == MSD_TRUE) && (entry->fid != fid)) ||
+			((nonStaticOnly == MSD_TRUE) && (simAtuIsStatic(entry) == MSD_TRUE)))
+		{
+			i++;
+			continue;
+		}
+
+		if (move == MSD_TRUE)
+		{
+			portVec = (MSD_U16)((entry->data >> 4) & 0x7FFU);
+			if (((entry->data & 0x8000U) != 0U) || ((portVec & (1U << fromPort)) == 0U))
+			{
+				i++;
+				continue;
+			}
+			portVec &= (MSD_U16)~(1U << fromPort);
+			if (toPort != 0x1FU)
+			{
+				portVec |= (MSD_U16)(1U << toPort);
+			}
+			if (portVec != 0U)
+			{
+				entry->data = (MSD_U16)((entry->data & 0x800FU) | (portVec << 4));
+				i++;
+				continue;
+			}
+		}
+		simAtuRemove(i);
+	}
+}
+
+/* hand out the latched violation and clear ATUProb */
+static void simAtuServiceViolation(void)
+{
+	MSD_U16 *g1 = s_simRegs[FIR_GLOBAL1_DEV_ADDR];
+
+	g1[FIR_ATU_OPERATION] &= (MSD_U16)~0x00F0U;
+	if (s_simAtuViolation.pending == MSD_FALSE)
+	{
+		return;
+	}
+	g1[FIR_ATU_OPERATION] |= (MSD_U16)(s_simAtuViolation.cause << 4);
+	g1[FIR_ATU_FID_REG] = (MSD_U16)((g1[FIR_ATU_FID_REG] & (MSD_U16)~0xFFFU) | s_simAtuViolation.fid);
+	g1[FIR_ATU_DATA_REG] = (MSD_U16)((g1[FIR_ATU_DATA_REG] & (MSD_U16)~0xFU) | s_simAtuViolation.spid);
+	simAtuMacSet(s_simAtuViolation.mac);
+	g1[FIR_GLOBAL_STATUS] &= (MSD_U16)~SIM_ATU_PROB;
+	s_simAtuViolation.pending = MSD_FALSE;
+}
+
+static void simAtuOperation(MSD_U16 opReg)
+{
+	MSD_U16 fid = (MSD_U16)(s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_FID_REG] & 0xFFFU);
+
+	s_simStats.atuOps++;
+	switch ((opReg >> 12) & 0x7U)
+	{
+		case 1U:    /* flush all */
+			simAtuFlush(fid, MSD_FALSE, MSD_FALSE);
+			break;
+		case 2U:    /* flush all non static */
+			simAtuFlush(fid, MSD_FALSE, MSD_TRUE);
+			break;
+		case 3U:    /* load or purge */
+			simAtuLoadPurge(fid, opReg);
+			break;
+		case 4U:    /* get next */
+			simAtuGetNext(fid);
+			break;
+		case 5U:    /* flush all in FID */
+			simAtuFlush(fid, MSD_TRUE, MSD_FALSE);
+			break;
+		case 6U:    /* flush all non static in FID */
+			simAtuFlush(fid, MSD_TRUE, MSD_TRUE);
+			break;
+		case 7U:    /* service violations */
+			simAtuServiceViolation();
+			break;
+		default:
+			break;
+	}
+}
+
+/* ATU Stats register: count the entries of the selected bin */
+static void simAtuStats(MSD_U16 data)
+{
+	MSD_U16 mode = (MSD_U16)((data >> 14) & 0x3U);
+	MSD_U16 fidReg = s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_ATU_FID_REG];
+	MSD_U16 binMask = ((fidReg & 0x8000U) != 0U) ? 0x3U : 0x7U;
+	MSD_U16 bin = (MSD_U16)((data >> 11) & binMask);
+	MSD_U32 count = 0;
+	MSD_U32 i;
+
+	for (i = 0; i < s_simAtuCount; i++)
+	{
+		if ((s_simAtu[i].mac[5] & binMask) != bin)
+		{
+			continue;
+		}
+		if (((mode & 0x1U) != 0U) && (simAtuIsStatic(&s_simAtu[i]) == MSD_TRUE))
+		{
+			continue;
+		}
+		if (((mode & 0x2U) != 0U) && (s_simAtu[i].fid != (fidReg & 0xFFFU)))
+		{
+			continue;
+		}
+		count++;
+	}
+	if (count > 0x7FFU)
+	{
+		count = 0x7FFU;
+	}
+	s_simRegs[FIR_GLOBAL2_DEV_ADDR][FIR_ATU_STATS] = (MSD_U16)((data & 0xF800U) | count);
+}
+
+/****************************************************************************/
+/* VTU                                                                      */
+/****************************************************************************/
+
+static MSD_U32 simVtuSearch(MSD_U16 key, MSD_BOOL upper)
+{
+	MSD_U32 lo = 0;
+	MSD_U32 hi = s_simVtuCount;
+	MSD_U32 mid;
+
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2U;
+		if ((key > s_simVtu[mid].key) || ((key == s_simVtu[mid].key) && (upper == MSD_TRUE)))
+		{
+			lo = mid + 1U;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static void simVtuLoadPurge(void)
+{
+	MSD_U16 *g1 = s_simRegs[FIR_GLOBAL1_DEV_ADDR];
+	MSD_U16 vidReg = g1[FIR_VTU_VID_REG];
+	MSD_U16 key = (MSD_U16)((((vidReg >> 13) & 0x1U) << 12) | (vidReg & 0xFFFU));
+	MSD_U32 index = simVtuSearch(key, MSD_FALSE);
+	MSD_U32 i;
+	MSD_BOOL found = ((index < s_simVtuCount) && (s_simVtu[index].key == key)) ? MSD_TRUE : MSD_FALSE;
+
+	if ((vidReg & 0x1000U) == 0U)
+	{
+		if (found == MSD_TRUE)
+		{
+			for (i = index + 1U; i < s_simVtuCount; i++)
+			{
+				s_simVtu[i - 1U] = s_simVtu[i];
+			}
+			s_simVtuCount--;
+		}
+		return;
+	}
+
+	if (found == MSD_FALSE)
+	{
+		if (s_simVtuCount >= MSD_SIM_VTU_SIZE)
+		{
+			return;
+		}
+		for (i = s_simVtuCount; i > index; i--)
+		{
+			s_simVtu[i] = s_simVtu[i - 1U];
+		}
+		s_simVtuCount++;
+		s_simVtu[index].key = key;
+	}
+	s_simVtu[index].sid = g1[FIR_STU_SID_REG];
+	s_simVtu[index].fid = g1[FIR_VTU_FID_REG];
+	s_simVtu[index].data1 = g1[FIR_VTU_DATA1_REG];
+	s_simVtu[index].data2 = g1[FIR_VTU_DATA2_REG];
+}
+
+static void simVtuGetNext(void)
+{
+	MSD_U16 *g1 = s_simRegs[FIR_GLOBAL1_DEV_ADDR];
+	MSD_U16 vidReg = g1[FIR_VTU_VID_REG];
+	MSD_U16 key = (MSD_U16)((((vidReg >> 13) & 0x1U) << 12) | (vidReg & 0xFFFU));
+	MSD_U32 index;
+	const SIM_VTU_ENTRY *entry;
+
+	/* the search starts over after vid 0xFFF of page 1 */
+	index = (key == 0x1FFFU) ? 0U : simVtuSearch(key, MSD_TRUE);
+	if (index < s_simVtuCount)
+	{
+		entry = &s_simVtu[index];
+		g1[FIR_VTU_VID_REG] = (MSD_U16)((((entry->key >> 12) & 0x1U) << 13) | 0x1000U | (entry->key & 0xFFFU));
+		g1[FIR_STU_SID_REG] = entry->sid;
+		g1[FIR_VTU_FID_REG] = entry->fid;
+		g1[FIR_VTU_DATA1_REG] = entry->data1;
+		g1[FIR_VTU_DATA2_REG] = entry->data2;
+	}
+	else
+	{
+		g1[FIR_VTU_VID_REG] = 0x2FFFU;
+	}
+}
+
+static void simVtuOperation(MSD_U16 opReg)
+{
+	s_simStats.vtuOps++;
+	switch ((opReg >> 12) & 0x7U)
+	{
+		case 1U:    /* flush all */
+			s_simVtuCount = 0;
+			break;
+		case 3U:    /* load or purge */
+			simVtuLoadPurge();
+			break;
+		case 4U:    /* get next */
+			simVtuGetNext();
+			break;
+		case 7U:    /* no violations without traffic */
+			s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_VTU_VID_REG] = 0;
+			s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_VTU_OPERATION] &= (MSD_U16)~0x0070U;
+			break;
+		default:    /* STU operations keep no state */
+			break;
+	}
+}
+
+/****************************************************************************/
+/* TCAM                                                                     */
+/****************************************************************************/
+
+static void simTcamFlushEntry(MSD_U32 index)
+{
+	msdMemSet(s_simTcam[index], 0, sizeof(s_simTcam[index]));
+	s_simTcam[index][0][0] = SIM_TCAM_KEY1_INVALID;
+}
+
+static MSD_BOOL simTcamEgrValid(const MSD_U16 *words)
+{
+	MSD_U32 i;
+
+	for (i = 0; i < SIM_TCAM_EGR_WORDS; i++)
+	{
+		if (words[i] != 0U)
+		{
+			return MSD_TRUE;
+		}
+	}
+	return MSD_FALSE;
+}
+
+static void simTcamGetNext(MSD_U16 *tcam, MSD_U32 page, MSD_U32 port, MSD_U32 index)
+{
+	MSD_U32 i;
+
+	if (page == 3U)
+	{
+		index &= (MSD_SIM_TCAM_EGR_SIZE - 1U);
+		for (i = (index == (MSD_SIM_TCAM_EGR_SIZE - 1U)) ? 0U : (index + 1U); i < MSD_SIM_TCAM_EGR_SIZE; i++)
+		{
+			if (simTcamEgrValid(s_simTcamEgr[port][i]) == MSD_TRUE)
+			{
+				break;
+			}
+		}
+		if (i < MSD_SIM_TCAM_EGR_SIZE)
+		{
+			tcam[FIR_TCAM_OPERATION] = (MSD_U16)((tcam[FIR_TCAM_OPERATION] & (MSD_U16)~0x1FFU) | i);
+			msdMemCpy(&tcam[2], s_simTcamEgr[port][i], SIM_TCAM_EGR_WORDS * sizeof(MSD_U16));
+		}
+		else
+		{
+			tcam[FIR_TCAM_OPERATION] = (MSD_U16)((tcam[FIR_TCAM_OPERATION] & (MSD_U16)~0x1FFU) | (MSD_SIM_TCAM_EGR_SIZE - 1U));
+			msdMemSet(&tcam[2], 0, SIM_TCAM_EGR_WORDS * sizeof(MSD_U16));
+		}
+		return;
+	}
+
+	for (i = (index == 0x1FFU) ? 0U : (index + 1U); i < MSD_SIM_TCAM_SIZE; i++)
+	{
+		if (s_simTcam[i][0][0] != SIM_TCAM_KEY1_INVALID)
+		{
+			break;
+		}
+	}
+	if (i < MSD_SIM_TCAM_SIZE)
+	{
+		tcam[FIR_TCAM_OPERATION] = (MSD_U16)((tcam[FIR_TCAM_OPERATION] & (MSD_U16)~0x1FFU) | i);
+		tcam[FIR_TCAM_P0_KEYS_1] = s_simTcam[i][0][0];
+	}
+	else
+	{
+		tcam[FIR_TCAM_OPERATION] |= 0x1FFU;
+		tcam[FIR_TCAM_P0_KEYS_1] = SIM_TCAM_KEY1_INVALID;
+	}
+}
+
+static void simTcamOperation(MSD_U16 opReg)
+{
+	MSD_U16 *tcam = s_simRegs[FIR_TCAM_DEV_ADDR];
+	MSD_U32 page = (MSD_U32)((opReg >> 10) & 0x3U);
+	MSD_U32 index = (MSD_U32)(opReg & 0x1FFU);
+	MSD_U32 port = (MSD_U32)(tcam[1] & (SIM_TCAM_EGR_PORTS - 1U));
+	MSD_U32 i;
+
+	s_simStats.tcamOps++;
+	if ((page == 3U) && (index >= MSD_SIM_TCAM_EGR_SIZE))
+	{
+		index &= (MSD_SIM_TCAM_EGR_SIZE - 1U);
+	}
+
+	switch ((opReg >> 12) & 0x7U)
+	{
+		case 1U:    /* flush all */
+			for (i = 0; i < MSD_SIM_TCAM_SIZE; i++)
+			{
+				simTcamFlushEntry(i);
+			}
+			msdMemSet(s_simTcamEgr, 0, sizeof(s_simTcamEgr));
+			break;
+		case 2U:    /* flush entry */
+			if (page == 3U)
+			{
+				msdMemSet(s_simTcamEgr[port][index], 0, sizeof(s_simTcamEgr[port][index]));
+			}
+			else if (index < MSD_SIM_TCAM_SIZE)
+			{
+				simTcamFlushEntry(index);
+			}
+			break;
+		case 3U:    /* load page */
+			if (page == 3U)
+			{
+				msdMemCpy(s_simTcamEgr[port][index], &tcam[2], SIM_TCAM_EGR_WORDS * sizeof(MSD_U16));
+			}
+			else if (index < MSD_SIM_TCAM_SIZE)
+			{
+				msdMemCpy(s_simTcam[index][page], &tcam[2], SIM_TCAM_PAGE_WORDS * sizeof(MSD_U16));
+			}
+			break;
+		case 4U:    /* get next */
+			simTcamGetNext(tcam, page, port, index);
+			break;
+		case 5U:    /* read page */
+			if (page == 3U)
+			{
+				msdMemCpy(&tcam[2], s_simTcamEgr[port][index], SIM_TCAM_EGR_WORDS * sizeof(MSD_U16));
+			}
+			else if (index < MSD_SIM_TCAM_SIZE)
+			{
+				msdMemCpy(&tcam[2], s_simTcam[index][page], SIM_TCAM_PAGE_WORDS * sizeof(MSD_U16));
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/****************************************************************************/
+/* Register write and operation dispatch                                    */
+/****************************************************************************/
+
+static void simRegWrite(MSD_U8 devAddr, MSD_U8 regAddr, MSD_U16 value, MSD_U32 cost)
+{
+	MSD_U32 opTime;
+
+	devAddr &= (MSD_U8)(SIM_NUM_DEV_ADDR - 1U);
+	regAddr &= (MSD_U8)(SIM_NUM_REGS - 1U);
+
+	simAdvance(cost);
+	s_simStats.writes++;
+
+	/* LearnLimit is not written while ReadLearnCnt or KeepOldLearnLimit is set */
+	if ((devAddr < FIR_GLOBAL1_DEV_ADDR) && (regAddr == FIR_PORT_ATU_CONTROL) &&
+		((value & (SIM_READ_LEARN_CNT | SIM_KEEP_OLD_LEARN_LIMIT)) != 0U))
+	{
+		value = (MSD_U16)((value & (MSD_U16)~SIM_LEARN_LIMIT_MASK) | (s_simRegs[devAddr][regAddr] & SIM_LEARN_LIMIT_MASK));
+	}
+	/* the hardware semaphore only changes owner through 0x0 */
+	if ((devAddr == FIR_GLOBAL1_DEV_ADDR) && (regAddr == SIM_HW_SEMAPHORE_REG) &&
+		(value != 0U) && (s_simRegs[devAddr][regAddr] != 0U))
+	{
+		return;
+	}
+	s_simRegs[devAddr][regAddr] = value;
+
+	if ((devAddr == FIR_GLOBAL2_DEV_ADDR) && (regAddr == FIR_ATU_STATS))
+	{
+		simAtuStats(value);
+		return;
+	}
+	if (((value & SIM_BUSY_BIT) == 0U) || (simIsOpReg(devAddr, regAddr) == MSD_FALSE))
+	{
+		return;
+	}
+
+	/* the table is updated at once, the busy bit reads back set until opTime elapsed */
+	if ((devAddr == FIR_GLOBAL1_DEV_ADDR) && (regAddr == FIR_ATU_OPERATION))
+	{
+		simAtuOperation(value);
+		opTime = s_simCfg.atuOpTime;
+	}
+	else if ((devAddr == FIR_GLOBAL1_DEV_ADDR) && (regAddr == FIR_VTU_OPERATION))
+	{
+		simVtuOperation(value);
+		opTime = s_simCfg.vtuOpTime;
+	}
+	else if ((devAddr == FIR_TCAM_DEV_ADDR) && (regAddr == FIR_TCAM_OPERATION))
+	{
+		simTcamOperation(value);
+		opTime = s_simCfg.tcamOpTime;
+	}
+	else
+	{
+		opTime = s_simCfg.otherOpTime;
+	}
+	s_simBusyUntil[devAddr][regAddr] = s_simClock + opTime;
+}
+
+/****************************************************************************/
+/* BSP callbacks                                                            */
+/****************************************************************************/
+
+static MSD_STATUS simReadMii(MSD_U8 devNum, MSD_U8 phyAddr, MSD_U8 miiReg, MSD_U16 *value)
+{
+	(void)devNum;
+	*value = simRegRead(phyAddr, miiReg, s_simCfg.smiAccessTime);
+	return MSD_OK;
+}
+
+static MSD_STATUS simWriteMii(MSD_U8 devNum, MSD_U8 phyAddr, MSD_U8 miiReg, MSD_U16 value)
+{
+	(void)devNum;
+	simRegWrite(phyAddr, miiReg, value, s_simCfg.smiAccessTime);
+	return MSD_OK;
+}
+
+static MSD_STATUS simReadMiiBurst(MSD_U8 devNum, MSD_U8 phyAddr, MSD_U8 miiReg, MSD_U8 count, MSD_U16 *values)
+{
+	MSD_U8 i;
+
+	(void)devNum;
+	if ((MSD_U32)miiReg + count > SIM_NUM_REGS)
+	{
+		return MSD_BAD_PARAM;
+	}
+	s_simStats.bursts++;
+	for (i = 0; i < count; i++)
+	{
+		values[i] = simRegRead(phyAddr, (MSD_U8)(miiReg + i), (i == 0U) ? s_simCfg.smiAccessTime : s_simCfg.burstReadTime);
+	}
+	return MSD_OK;
+}
+
+/* the switch register the address register of phyAddr points at */
+static MSD_STATUS simMdioReg(MSD_U8 phyAddr, MSD_U8 devType, MSD_U8 *regAddr)
+{
+	MSD_U16 address = s_simMdioAddr[phyAddr];
+
+	if ((devType != SIM_MDIO_DEV_TYPE) || (address < SIM_MDIO_REG_BASE) || (address >= SIM_MDIO_REG_BASE + SIM_NUM_REGS))
+	{
+		return MSD_FAIL;
+	}
+	*regAddr = (MSD_U8)(address - SIM_MDIO_REG_BASE);
+	return MSD_OK;
+}
+
+static MSD_U32 simGetU32(const MSD_U8 *ptr)
+{
+	return ((MSD_U32)ptr[0] << 24) | ((MSD_U32)ptr[1] << 16) | ((MSD_U32)ptr[2] << 8) | (MSD_U32)ptr[3];
+}
+
+static void simPutU16(MSD_U8 *ptr, MSD_U16 value)
+{
+	ptr[0] = (MSD_U8)(value >> 8);
+	ptr[1] = (MSD_U8)(value & 0xFFU);
+}
+
+/* Dump ATU: up to MSD_RMU_MAX_ATUS entries from the table index in the request, the continuation code is the next index */
+static MSD_STATUS simRmuAtuDump(MSD_U8 *req_pkt, MSD_U32 req_pkt_len, MSD_U32 prefix, MSD_U8 *rsp, MSD_U32 *rsp_pkt_len)
+{
+	MSD_U32 index, n, offset;
+	const SIM_ATU_ENTRY *entry;
+
+	if (req_pkt_len < (prefix + 2U))
+	{
+		return MSD_BAD_PARAM;
+	}
+	index = ((MSD_U32)req_pkt[prefix] << 8) | req_pkt[prefix + 1U];
+
+	s_simStats.rmuFrames++;
+	simAdvance(s_simCfg.rmuFrameTime);
+	msdMemCpy(rsp, req_pkt, prefix);
+	offset = prefix + 2U;
+	for (n = 0; (n < MSD_RMU_MAX_ATUS) && (index < s_simAtuCount); n++, index++)
+	{
+		entry = &s_simAtu[index];
+		simPutU16(&rsp[offset], entry->data);
+		msdMemCpy(&rsp[offset + 2U], entry->mac, 6);
+		simPutU16(&rsp[offset + 8U], entry->fid);
+		simPutU16(&rsp[offset + 10U], entry->pri);
+		simPutU16(&rsp[offset + 12U], 0);
+		offset += SIM_RMU_ATU_ENTRY_SIZE;
+		simAdvance(s_simCfg.rmuCmdTime);
+	}
+	/* an entry with EntryState 0 ends a short list */
+	if (n < MSD_RMU_MAX_ATUS)
+	{
+		msdMemSet(&rsp[offset], 0, SIM_RMU_ATU_ENTRY_SIZE);
+		offset += SIM_RMU_ATU_ENTRY_SIZE;
+	}
+	simPutU16(&rsp[prefix], (MSD_U16)((index < s_simAtuCount) ? index : 0U));
+
+	*rsp_pkt_len = offset;
+	return MSD_OK;
+}
+
+/* multiple register R/W frames are served with a response mirroring the request, and Dump ATU frames */
+static MSD_STATUS simRmuTxRx(MSD_U8 *req_pkt, MSD_U32 req_pkt_len, MSD_U8 **rsp_pkt, MSD_U32 *rsp_pkt_len)
+{
+	MSD_U32 prefix;
+	MSD_U32 offset, word, n;
+	MSD_U8 devAddr, regAddr, bit;
+	MSD_U16 data, expect;
+	MSD_U8 *rsp = *rsp_pkt;
+
+	*rsp_pkt_len = 0;
+	/* a From_CPU DSA tag right after SA means DSA mode, otherwise the Ether type comes first */
+	prefix = ((req_pkt[12] & 0xC0U) == 0x40U) ? (MSD_RMU_PACKET_PREFIX_SIZE - 4U) : MSD_RMU_PACKET_PREFIX_SIZE;
+	if ((req_pkt_len < prefix) || (req_pkt_len > 512U))
+	{
+		return MSD_BAD_PARAM;
+	}
+	if ((((MSD_U32)req_pkt[prefix - 2U] << 8) | req_pkt[prefix - 1U]) == SIM_RMU_REQ_CODE_DUMP_ATU)
+	{
+		return simRmuAtuDump(req_pkt, req_pkt_len, prefix, rsp, rsp_pkt_len);
+	}
+	if ((((MSD_U32)req_pkt[prefix - 2U] << 8) | req_pkt[prefix - 1U]) != SIM_RMU_REQ_CODE_REGRW)
+	{
+		return MSD_NOT_SUPPORTED;
+	}
+
+	s_simStats.rmuFrames++;
+	simAdvance(s_simCfg.rmuFrameTime);
+	msdMemCpy(rsp, req_pkt, req_pkt_len);
+
+	for (offset = prefix; (offset + MSD_RMU_REGCMD_WORD_SIZE) <= req_pkt_len; offset += MSD_RMU_REGCMD_WORD_SIZE)
+	{
+		word = simGetU32(&req_pkt[offset]);
+		if (word == SIM_RMU_END_OF_FRAME)
+		{
+			break;
+		}
+		s_simStats.rmuCmds++;
+		devAddr = (MSD_U8)((((word >> 24) & 0x3U) << 3) | ((word >> 21) & 0x7U));
+		regAddr = (MSD_U8)((word >> 16) & 0x1FU);
+
+		if (((word >> 28) & 0x1U) == MSD_RMU_WAIT_ON_BIT_TRUE)
+		{
+			bit = (MSD_U8)((word >> 8) & 0xFU);
+			expect = (((word >> 26) & 0x3U) == MSD_RMU_WAIT_ON_BIT_VAL1) ? 1U : 0U;
+			for (n = 0; n < SIM_RMU_WAIT_ON_BIT_LIMIT; n++)
+			{
+				data = simRegRead(devAddr, regAddr, s_simCfg.rmuCmdTime);
+				if (((data >> bit) & 0x1U) == expect)
+				{
+					break;
+				}
+			}
+			if (n == SIM_RMU_WAIT_ON_BIT_LIMIT)
+			{
+				return MSD_FAIL;
+			}
+		}
+		else if (((word >> 26) & 0x3U) == MSD_RMU_REQ_OPCODE_READ)
+		{
+			data = simRegRead(devAddr, regAddr, s_simCfg.rmuCmdTime);
+			rsp[offset + 2U] = (MSD_U8)(data >> 8);
+			rsp[offset + 3U] = (MSD_U8)(data & 0xFFU);
+		}
+		else if (((word >> 26) & 0x3U) == MSD_RMU_REQ_OPCODE_WRITE)
+		{
+			simRegWrite(devAddr, regAddr, (MSD_U16)(word & 0xFFFFU), s_simCfg.rmuCmdTime);
+		}
+		else
+		{
+			return MSD_FAIL;
+		}
+	}
+
+	*rsp_pkt_len = req_pkt_len;
+	return MSD_OK;
+}
+
+static MSD_SEM simSemCreate(MSD_SEM_BEGIN_STATE state)
+{
+	MSD_U32 i;
+
+	for (i = 0; i < MSD_SIM_MAX_SEMAPHORES; i++)
+	{
+		if (s_simSemUsed[i] == MSD_FALSE)
+		{
+			s_simSemUsed[i] = MSD_TRUE;
+			s_simSemCount[i] = (state == MSD_SEM_FULL) ? 1 : 0;
+			return (MSD_SEM)(i + 1U);
+		}
+	}
+	return 0;
+}
+
+static MSD_STATUS simSemDelete(MSD_SEM smid)
+{
+	if ((smid == 0U) || (smid > MSD_SIM_MAX_SEMAPHORES))
+	{
+		return MSD_FAIL;
+	}
+	s_simSemUsed[smid - 1U] = MSD_FALSE;
+	return MSD_OK;
+}
+
+static MSD_STATUS simSemTake(MSD_SEM smid, MSD_U32 timeOut)
+{
+	(void)timeOut;
+	if ((smid == 0U) || (smid > MSD_SIM_MAX_SEMAPHORES) || (s_simSemCount[smid - 1U] <= 0))
+	{
+		/* single threaded, waiting would never end */
+		return MSD_FAIL;
+	}
+	s_simSemCount[smid - 1U]--;
+	return MSD_OK;
+}
+
+static MSD_STATUS simSemGive(MSD_SEM smid)
+{
+	if ((smid == 0U) || (smid > MSD_SIM_MAX_SEMAPHORES))
+	{
+		return MSD_FAIL;
+	}
+	s_simSemCount[smid - 1U]++;
+	return MSD_OK;
+}
+
+/****************************************************************************/
+/* Exported functions                                                       */
+/****************************************************************************/
+
+MSD_STATUS msdSimInit
+(
+    IN const MSD_SIM_CONFIG *cfg
+)
+{
+	MSD_U32 i;
+
+	msdMemCpy(&s_simCfg, (cfg != NULL) ? cfg : &s_simDefaultCfg, sizeof(MSD_SIM_CONFIG));
+	msdMemSet(&s_simStats, 0, sizeof(s_simStats));
+	msdMemSet(s_simRegs, 0, sizeof(s_simRegs));
+	msdMemSet(s_simBusyUntil, 0, sizeof(s_simBusyUntil));
+	s_simAtuCount = 0;
+	msdMemSet(&s_simAtuViolation, 0, sizeof(s_simAtuViolation));
+	s_simVtuCount = 0;
+	for (i = 0; i < MSD_SIM_TCAM_SIZE; i++)
+	{
+		simTcamFlushEntry(i);
+	}
+	msdMemSet(s_simTcamEgr, 0, sizeof(s_simTcamEgr));
+	msdMemSet(s_simMdioAddr, 0, sizeof(s_simMdioAddr));
+	msdMemSet(s_simMdioInc, 0, sizeof(s_simMdioInc));
+
+	for (i = 0; i < FIR_GLOBAL1_DEV_ADDR; i++)
+	{
+		s_simRegs[i][FIR_SWITCH_ID] = (MSD_U16)MSD_SIM_DEVICE_ID;
+	}
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimConfigGet
+(
+    OUT MSD_SIM_CONFIG *cfg
+)
+{
+	if (cfg == NULL)
+	{
+		return MSD_BAD_PARAM;
+	}
+	msdMemCpy(cfg, &s_simCfg, sizeof(MSD_SIM_CONFIG));
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimConfigSet
+(
+    IN const MSD_SIM_CONFIG *cfg
+)
+{
+	msdMemCpy(&s_simCfg, (cfg != NULL) ? cfg : &s_simDefaultCfg, sizeof(MSD_SIM_CONFIG));
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimBspGet
+(
+    OUT MSD_BSP_FUNCTIONS *bsp
+)
+{
+	if (bsp == NULL)
+	{
+		return MSD_BAD_PARAM;
+	}
+
+	msdMemSet(bsp, 0, sizeof(MSD_BSP_FUNCTIONS));
+	bsp->readMii = simReadMii;
+	bsp->writeMii = simWriteMii;
+	bsp->readMiiBurst = simReadMiiBurst;
+	bsp->rmu_tx_rx = simRmuTxRx;
+	bsp->semCreate = simSemCreate;
+	bsp->semDelete = simSemDelete;
+	bsp->semTake = simSemTake;
+	bsp->semGive = simSemGive;
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimLearn
+(
+    IN MSD_U8 port,
+    IN MSD_U16 fid,
+    IN const MSD_ETHERADDR *macAddr
+)
+{
+	MSD_U16 portVec;
+	MSD_U16 limit;
+	MSD_U32 index, i;
+	SIM_ATU_ENTRY *entry;
+
+	if ((macAddr == NULL) || (port >= SIM_NUM_PORTS) || (fid > 0xFFFU) || ((macAddr->arEther[0] & 0x1U) != 0U))
+	{
+		return MSD_BAD_PARAM;
+	}
+	portVec = (MSD_U16)(1U << port);
+	/* learning is disabled while the port's own bit is clear in its PAV */
+	if ((s_simRegs[port][FIR_PAV] & portVec) == 0U)
+	{
+		return MSD_FAIL;
+	}
+
+	index = simAtuSearch(fid, macAddr->arEther, MSD_FALSE);
+	if ((index < s_simAtuCount) && (simAtuCmp(fid, macAddr->arEther, &s_simAtu[index]) == 0))
+	{
+		/* a known address only moves to the new port, static entries stay */
+		entry = &s_simAtu[index];
+		if (simAtuIsStatic(entry) == MSD_FALSE)
+		{
+			entry->data = (MSD_U16)((portVec << 4) | 0x7U);
+		}
+		return MSD_OK;
+	}
+
+	limit = (MSD_U16)(s_simRegs[port][FIR_PORT_ATU_CONTROL] & SIM_LEARN_LIMIT_MASK);
+	if ((limit != 0U) && (simAtuLearnCount(port) >= limit))
+	{
+		/* the frame is discarded without a violation */
+		return MSD_NO_SPACE;
+	}
+	if (s_simAtuCount >= MSD_SIM_ATU_SIZE)
+	{
+		if (s_simAtuViolation.pending == MSD_FALSE)
+		{
+			s_simAtuViolation.pending = MSD_TRUE;
+			s_simAtuViolation.cause = SIM_ATU_FULL_VIOLATION;
+			s_simAtuViolation.fid = fid;
+			msdMemCpy(s_simAtuViolation.mac, macAddr->arEther, 6);
+			s_simAtuViolation.spid = port;
+			s_simRegs[FIR_GLOBAL1_DEV_ADDR][FIR_GLOBAL_STATUS] |= SIM_ATU_PROB;
+		}
+		return MSD_NO_SPACE;
+	}
+
+	for (i = s_simAtuCount; i > index; i--)
+	{
+		s_simAtu[i] = s_simAtu[i - 1U];
+	}
+	s_simAtuCount++;
+	entry = &s_simAtu[index];
+	entry->fid = fid;
+	msdMemCpy(entry->mac, macAddr->arEther, 6);
+	entry->data = (MSD_U16)((portVec << 4) | 0x7U);
+	entry->pri = 0;
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimMdioC22Read
+(
+    IN  MSD_U8  phyAddr,
+    IN  MSD_U8  regAddr,
+    OUT MSD_U16 *value
+)
+{
+	if (value == NULL)
+	{
+		return MSD_BAD_PARAM;
+	}
+	*value = simRegRead(phyAddr, regAddr, s_simCfg.mdioFrameTime);
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimMdioC22Write
+(
+    IN MSD_U8  phyAddr,
+    IN MSD_U8  regAddr,
+    IN MSD_U16 value
+)
+{
+	simRegWrite(phyAddr, regAddr, value, s_simCfg.mdioFrameTime);
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimMdioC45Address
+(
+    IN MSD_U8  phyAddr,
+    IN MSD_U8  devType,
+    IN MSD_U16 address
+)
+{
+	(void)devType;
+	phyAddr &= (MSD_U8)(SIM_NUM_DEV_ADDR - 1U);
+	simAdvance(s_simCfg.mdioFrameTime);
+	s_simStats.addrFrames++;
+	s_simMdioAddr[phyAddr] = address;
+	s_simMdioInc[phyAddr] = MSD_FALSE;
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimMdioC45Read
+(
+    IN  MSD_U8   phyAddr,
+    IN  MSD_U8   devType,
+    IN  MSD_BOOL postIncrement,
+    OUT MSD_U16  *value
+)
+{
+	MSD_U8 regAddr;
+
+	if (value == NULL)
+	{
+		return MSD_BAD_PARAM;
+	}
+	phyAddr &= (MSD_U8)(SIM_NUM_DEV_ADDR - 1U);
+	if (simMdioReg(phyAddr, devType, &regAddr) != MSD_OK)
+	{
+		simAdvance(s_simCfg.mdioFrameTime);
+		return MSD_FAIL;
+	}
+	*value = simRegRead(phyAddr, regAddr, s_simCfg.mdioFrameTime);
+	if (postIncrement == MSD_TRUE)
+	{
+		if (s_simMdioInc[phyAddr] == MSD_FALSE)
+		{
+			s_simStats.bursts++;
+			s_simMdioInc[phyAddr] = MSD_TRUE;
+		}
+		s_simMdioAddr[phyAddr]++;
+	}
+	else
+	{
+		s_simMdioInc[phyAddr] = MSD_FALSE;
+	}
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimMdioC45Write
+(
+    IN MSD_U8  phyAddr,
+    IN MSD_U8  devType,
+    IN MSD_U16 value
+)
+{
+	MSD_U8 regAddr;
+
+	phyAddr &= (MSD_U8)(SIM_NUM_DEV_ADDR - 1U);
+	if (simMdioReg(phyAddr, devType, &regAddr) != MSD_OK)
+	{
+		simAdvance(s_simCfg.mdioFrameTime);
+		return MSD_FAIL;
+	}
+	simRegWrite(phyAddr, regAddr, value, s_simCfg.mdioFrameTime);
+	s_simMdioInc[phyAddr] = MSD_FALSE;
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimHwSemSet
+(
+    IN MSD_U16 owner
+)
+{
+	s_simRegs[FIR_GLOBAL1_DEV_ADDR][SIM_HW_SEMAPHORE_REG] = owner;
+	return MSD_OK;
+}
+
+MSD_STATUS msdSimStatsGet
+(
+    OUT MSD_SIM_STATS *stats
+)
+{
+	if (stats == NULL)
+	{
+		return MSD_BAD_PARAM;
+	}
+	msdMemCpy(stats, &s_simStats, sizeof(MSD_SIM_STATS));
+	stats->clock = s_simClock;
+	return MSD_OK;
+}
+
+void msdSimStatsClear
+(
+    void
+)
+{
+	msdMemSet(&s_simStats, 0, sizeof(s_simStats));
+}
+
+void msdSimStatsDump
+(
+    void
+)
+{
+	MSD_U32 i, tcamUsed = 0;
+
+	for (i = 0; i < MSD_SIM_TCAM_SIZE; i++)
+	{
+		if (s_simTcam[i][0][0] != SIM_TCAM_KEY1_INVALID)
+		{
+			tcamUsed++;
+		}
+	}
+
+	MSG(("clock %lu us\n", (unsigned long)(s_simClock / 1000U)));
+	MSG(("reads %lu writes %lu bursts %lu busyPolls %lu\n", (unsigned long)s_simStats.reads,
+		(unsigned long)s_simStats.writes, (unsigned long)s_simStats.bursts, (unsigned long)s_simStats.busyPolls));
+	MSG(("rmuFrames %lu rmuCmds %lu\n", (unsigned long)s_simStats.rmuFrames, (unsigned long)s_simStats.rmuCmds));
+	MSG(("atuOps %lu vtuOps %lu tcamOps %lu\n", (unsigned long)s_simStats.atuOps,
+		(unsigned long)s_simStats.vtuOps, (unsigned long)s_simStats.tcamOps));
+	MSG(("ATU %lu/%u VTU %lu/%u TCAM %lu/%u\n", (unsigned long)s_simAtuCount, MSD_SIM_ATU_SIZE,
+		(unsigned long)s_simVtuCount, MSD_SIM_VTU_SIZE, (unsigned long)tcamUsed, MSD_SIM_TCAM_SIZE));
+}
+
+#endif /* MSD_SIM */
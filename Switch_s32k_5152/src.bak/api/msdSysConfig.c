@@ -408,6 +408,13 @@ MSD_STATUS msdLoadDriver
 		msdUnLoadDriver(dev->devNum);
 		return MSD_FAIL;
 	}
+	/* Initialize the hardware semaphore guard.    */
+	if ((dev->hwSem.guard = msdSemCreate(dev->devNum, MSD_SEM_FULL)) == 0)
+	{
+		MSD_DBG_ERROR(("hwSem guard semCreate Failed.\n"));
+		msdUnLoadDriver(dev->devNum);
+		return MSD_FAIL;
+	}
     dev->devEnabled = 1;
     InitDevObj(dev);
 
@@ -555,6 +562,12 @@ MSD_STATUS msdUnLoadDriver
 		MSD_DBG_ERROR(("apbRegsSem semDelete Failed.\n"));
 		return MSD_FAIL;
 	}
+	/* Delete the hardware semaphore guard.    */
+	if (msdSemDelete(devNum, dev->hwSem.guard) != MSD_OK)
+	{
+		MSD_DBG_ERROR(("hwSem guard semDelete Failed.\n"));
+		return MSD_FAIL;
+	}
 
 	msdMemSet((void*)dev, 0, sizeof(MSD_QD_DEV));
 
@@ -1148,6 +1161,11 @@ MSD_STATUS msdDisableHwSemaphore
 		{
 			return MSD_NOT_SUPPORTED;
 		}
+		if (dev->hwSem.holdCnt != 0U)
+		{
+			MSD_DBG_ERROR(("Hardware semaphore is still held.\n"));
+			return MSD_BUSY;
+		}
 	    dev->HWSemaphore = MSD_HW_SEM_DISABLE;
 		retVal = MSD_OK;
 	}
@@ -1165,6 +1183,9 @@ MSD_STATUS msdDisableHwSemaphore
 *            allows QuarterDeck driver to read QuarterDeck device registers.
 *        2) MII Write - (Input, must provice)
 *            allows QuarterDeck driver to write QuarterDeck device registers.
+*        MII Burst Read - (Input, optional)
+*            reads consecutive registers with a single address phase, used by
+*            msdGetAnyRegBurst and register batches when provided.
 *        3) Semaphore Create - (Input, optional)
 *            OS specific Semaphore Creat function.
 *        4) Semaphore Delete - (Input, optional)
@@ -1192,9 +1213,15 @@ static MSD_BOOL msdRegister(MSD_QD_DEV *dev, const MSD_BSP_FUNCTIONS* pBSPFuncti
 {
 
 	dev->rmu_tx_rx = pBSPFunctions->rmu_tx_rx;
+	dev->rmu_tx = pBSPFunctions->rmu_tx;
+	dev->rmu_rx = pBSPFunctions->rmu_rx;
 
     dev->fgtReadMii =  pBSPFunctions->readMii;
     dev->fgtWriteMii = pBSPFunctions->writeMii;
+    dev->fgtReadMiiBurst = pBSPFunctions->readMiiBurst;
+#ifdef MSD_TRACE
+    msdTraceHookBus(dev);
+#endif
     
     dev->semCreate = pBSPFunctions->semCreate;
     dev->semDelete = pBSPFunctions->semDelete;
@@ -0,0 +1,425 @@
+/**********************************************************************************************
+* Copyright (c) 2023 Marvell.
+* All rights reserved.
+* Use of this source code is governed by a BSD3 license that
+* can be found in the LICENSE file and also at https://opensource.org/licenses/BSD-3-Clause
+**********************************************************************************************/
+
+/********************************************************************************
+* msdTrace.c
+*
+* DESCRIPTION:
+*       Register access tracing: a ring of the last bus transactions plus per
+*       caller counters and latency histograms. Compiled only when MSD_TRACE
+*       is defined.
+*
+* DEPENDENCIES:
+*       msdTimeStamp provided by the MSD user.
+*
+* FILE REVISION NUMBER:
+*******************************************************************************/
+
+/* the wrappers call the real functions */
+#define MSD_TRACE_NO_WRAP
+#include <msdHwAccess.h>
+#include <msdTrace.h>
+#include <msdUtils.h>
+
+#ifdef MSD_TRACE
+
+static MSD_TRACE_RECORD s_traceRing[MSD_TRACE_RING_SIZE];
+static MSD_U32 s_traceHead = 0;
+static MSD_TRACE_STATS s_traceStats[MSD_TRACE_MAX_TAGS];
+static MSD_U32 s_traceDropped = 0;    /* accesses of callers beyond MSD_TRACE_MAX_TAGS */
+
+static const char *s_traceOpName[MSD_TRACE_OP_NUM] = { "rd", "wr", "bst", "rmu" };
+
+/* tag of the traced call running on each device */
+static const char *s_traceDevTag[MAX_SOHO_DEVICES];
+
+/* BSP functions replaced by msdTraceHookBus */
+static MSD_FMSD_READ_MII s_traceReadMii[MAX_SOHO_DEVICES];
+static MSD_FMSD_WRITE_MII s_traceWriteMii[MAX_SOHO_DEVICES];
+static MSD_FMSD_READ_MII_BURST s_traceReadMiiBurst[MAX_SOHO_DEVICES];
+
+/* find the counters of tag, claiming a free slot on first use */
+static MSD_TRACE_STATS* traceStatsOf(const char *tag)
+{
+	MSD_U32 i;
+	const char *cur;
+
+	for (i = 0; i < MSD_TRACE_MAX_TAGS; i++)
+	{
+		cur = __atomic_load_n(&s_traceStats[i].tag, __ATOMIC_ACQUIRE);
+		if (cur == NULL)
+		{
+			if (__atomic_compare_exchange_n(&s_traceStats[i].tag, &cur, tag, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			{
+				return &s_traceStats[i];
+			}
+			/* another task claimed the slot, cur now holds its tag */
+		}
+		if (cur == tag)
+		{
+			return &s_traceStats[i];
+		}
+	}
+	return NULL;
+}
+
+static MSD_U32 traceHistBucket(MSD_U32 latency)
+{
+	MSD_U32 bucket = 0;
+
+	while ((latency != 0U) && (bucket < MSD_TRACE_HIST_BUCKETS - 1U))
+	{
+		latency >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+void msdTraceRecord
+(
+    IN const char   *tag,
+    IN MSD_TRACE_OP op,
+    IN MSD_U8       devNum,
+    IN MSD_U8       devAddr,
+    IN MSD_U8       regAddr,
+    IN MSD_U32      startTime,
+    IN MSD_STATUS   status
+)
+{
+	MSD_U32 latency = msdTimeStamp() - startTime;
+	MSD_U32 index = __atomic_fetch_add(&s_traceHead, 1U, __ATOMIC_RELAXED) & (MSD_TRACE_RING_SIZE - 1U);
+	MSD_TRACE_RECORD *rec = &s_traceRing[index];
+	MSD_TRACE_STATS *stats;
+	MSD_U32 maxTime;
+
+	rec->tag = tag;
+	rec->timeStamp = startTime;
+	rec->latency = latency;
+	rec->devNum = devNum;
+	rec->devAddr = devAddr;
+	rec->regAddr = regAddr;
+	rec->op = (MSD_U8)op;
+	rec->status = (MSD_U8)status;
+
+	stats = traceStatsOf(tag);
+	if (stats == NULL)
+	{
+		__atomic_fetch_add(&s_traceDropped, 1U, __ATOMIC_RELAXED);
+		return;
+	}
+
+	__atomic_fetch_add(&stats->count[op], 1U, __ATOMIC_RELAXED);
+	if (status != MSD_OK)
+	{
+		__atomic_fetch_add(&stats->errors, 1U, __ATOMIC_RELAXED);
+	}
+	__atomic_fetch_add(&stats->totalTime, latency, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->hist[traceHistBucket(latency)], 1U, __ATOMIC_RELAXED);
+
+	maxTime = __atomic_load_n(&stats->maxTime, __ATOMIC_RELAXED);
+	while (latency > maxTime)
+	{
+		if (__atomic_compare_exchange_n(&stats->maxTime, &maxTime, latency, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		{
+			break;
+		}
+	}
+}
+
+const char* msdTraceTagSet
+(
+    IN MSD_U8       devNum,
+    IN const char   *tag
+)
+{
+	const char *prev;
+
+	if (devNum >= MAX_SOHO_DEVICES)
+	{
+		return NULL;
+	}
+	prev = s_traceDevTag[devNum];
+	s_traceDevTag[devNum] = tag;
+	return prev;
+}
+
+const char* msdTraceTagGet
+(
+    IN MSD_U8       devNum
+)
+{
+	if ((devNum >= MAX_SOHO_DEVICES) || (s_traceDevTag[devNum] == NULL))
+	{
+		return MSD_TRACE_TAG_NONE;
+	}
+	return s_traceDevTag[devNum];
+}
+
+static MSD_STATUS traceReadMii(MSD_U8 devNum, MSD_U8 phyAddr, MSD_U8 miiReg, MSD_U16* value)
+{
+	MSD_U32 startTime = msdTimeStamp();
+	MSD_STATUS retVal = s_traceReadMii[devNum](devNum, phyAddr, miiReg, value);
+
+	MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_READ, devNum, phyAddr, miiReg, startTime, retVal);
+	return retVal;
+}
+
+static MSD_STATUS traceWriteMii(MSD_U8 devNum, MSD_U8 phyAddr, MSD_U8 miiReg, MSD_U16 value)
+{
+	MSD_U32 startTime = msdTimeStamp();
+	MSD_STATUS retVal = s_traceWriteMii[devNum](devNum, phyAddr, miiReg, value);
+
+	MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_WRITE, devNum, phyAddr, miiReg, startTime, retVal);
+	return retVal;
+}
+
+static MSD_STATUS traceReadMiiBurst(MSD_U8 devNum, MSD_U8 phyAddr, MSD_U8 miiReg, MSD_U8 count, MSD_U16* values)
+{
+	MSD_U32 startTime = msdTimeStamp();
+	MSD_STATUS retVal = s_traceReadMiiBurst[devNum](devNum, phyAddr, miiReg, count, values);
+
+	MSD_TRACE_BUS_ACCESS(MSD_TRACE_OP_READ_BURST, devNum, phyAddr, miiReg, startTime, retVal);
+	return retVal;
+}
+
+void msdTraceHookBus
+(
+    INOUT MSD_QD_DEV *dev
+)
+{
+	if ((dev == NULL) || (dev->devNum >= MAX_SOHO_DEVICES))
+	{
+		return;
+	}
+
+	s_traceDevTag[dev->devNum] = NULL;
+	if ((dev->fgtReadMii != NULL) && (dev->fgtReadMii != traceReadMii))
+	{
+		s_traceReadMii[dev->devNum] = dev->fgtReadMii;
+		dev->fgtReadMii = traceReadMii;
+	}
+	if ((dev->fgtWriteMii != NULL) && (dev->fgtWriteMii != traceWriteMii))
+	{
+		s_traceWriteMii[dev->devNum] = dev->fgtWriteMii;
+		dev->fgtWriteMii = traceWriteMii;
+	}
+	if ((dev->fgtReadMiiBurst != NULL) && (dev->fgtReadMiiBurst != traceReadMiiBurst))
+	{
+		s_traceReadMiiBurst[dev->devNum] = dev->fgtReadMiiBurst;
+		dev->fgtReadMiiBurst = traceReadMiiBurst;
+	}
+}
+
+MSD_STATUS msdTraceGetAnyReg
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    OUT MSD_U16   *data
+)
+{
+	const char *prev = msdTraceTagSet(devNum, tag);
+	MSD_STATUS retVal = msdGetAnyReg(devNum, devAddr, regAddr, data);
+
+	(void)msdTraceTagSet(devNum, prev);
+	return retVal;
+}
+
+MSD_STATUS msdTraceSetAnyReg
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U16   data
+)
+{
+	const char *prev = msdTraceTagSet(devNum, tag);
+	MSD_STATUS retVal = msdSetAnyReg(devNum, devAddr, regAddr, data);
+
+	(void)msdTraceTagSet(devNum, prev);
+	return retVal;
+}
+
+MSD_STATUS msdTraceGetAnyRegField
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    fieldOffset,
+    IN  MSD_U8    fieldLength,
+    OUT MSD_U16   *data
+)
+{
+	const char *prev = msdTraceTagSet(devNum, tag);
+	MSD_STATUS retVal = msdGetAnyRegField(devNum, devAddr, regAddr, fieldOffset, fieldLength, data);
+
+	(void)msdTraceTagSet(devNum, prev);
+	return retVal;
+}
+
+MSD_STATUS msdTraceSetAnyRegField
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum,
+    IN  MSD_U8    devAddr,
+    IN  MSD_U8    regAddr,
+    IN  MSD_U8    fieldOffset,
+    IN  MSD_U8    fieldLength,
+    IN  MSD_U16   data
+)
+{
+	const char *prev = msdTraceTagSet(devNum, tag);
+	MSD_STATUS retVal = msdSetAnyRegField(devNum, devAddr, regAddr, fieldOffset, fieldLength, data);
+
+	(void)msdTraceTagSet(devNum, prev);
+	return retVal;
+}
+
+/* a batch or pipeline keeps the tag of its owner from Begin to Commit/End */
+MSD_STATUS msdTraceRegBatchBegin
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+)
+{
+	MSD_STATUS retVal = msdRegBatchBegin(devNum);
+
+	if (retVal == MSD_OK)
+	{
+		(void)msdTraceTagSet(devNum, tag);
+	}
+	return retVal;
+}
+
+MSD_STATUS msdTraceRegBatchCommit
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+)
+{
+	MSD_STATUS retVal = msdRegBatchCommit(devNum);
+
+	(void)tag;
+	(void)msdTraceTagSet(devNum, NULL);
+	return retVal;
+}
+
+MSD_STATUS msdTraceRmuPipeBegin
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+)
+{
+	MSD_STATUS retVal = msdRmuPipeBegin(devNum);
+
+	if (retVal == MSD_OK)
+	{
+		(void)msdTraceTagSet(devNum, tag);
+	}
+	return retVal;
+}
+
+MSD_STATUS msdTraceRmuPipeEnd
+(
+    IN  const char *tag,
+    IN  MSD_U8    devNum
+)
+{
+	MSD_STATUS retVal = msdRmuPipeEnd(devNum);
+
+	(void)tag;
+	(void)msdTraceTagSet(devNum, NULL);
+	return retVal;
+}
+
+MSD_STATUS msdTraceStatsGet
+(
+    IN  MSD_U32 index,
+    OUT MSD_TRACE_STATS *stats
+)
+{
+	if ((index >= MSD_TRACE_MAX_TAGS) || (stats == NULL))
+	{
+		return MSD_BAD_PARAM;
+	}
+	if (__atomic_load_n(&s_traceStats[index].tag, __ATOMIC_ACQUIRE) == NULL)
+	{
+		return MSD_NO_SUCH;
+	}
+
+	msdMemCpy(stats, &s_traceStats[index], sizeof(MSD_TRACE_STATS));
+	return MSD_OK;
+}
+
+void msdTraceClear
+(
+    void
+)
+{
+	msdMemSet(s_traceStats, 0, sizeof(s_traceStats));
+	msdMemSet(s_traceRing, 0, sizeof(s_traceRing));
+	__atomic_store_n(&s_traceHead, 0U, __ATOMIC_RELAXED);
+	__atomic_store_n(&s_traceDropped, 0U, __ATOMIC_RELAXED);
+}
+
+void msdTraceDump
+(
+    IN MSD_U32 numOfRecord
+)
+{
+	MSD_U32 i, j;
+	MSD_U32 head;
+	MSD_TRACE_STATS *stats;
+	MSD_TRACE_RECORD *rec;
+
+	MSG(("%-32s %6s %6s %6s %6s %5s %9s %6s\n", "caller", "rd", "wr", "bst", "rmu", "err", "total", "max"));
+	for (i = 0; i < MSD_TRACE_MAX_TAGS; i++)
+	{
+		stats = &s_traceStats[i];
+		if (stats->tag == NULL)
+		{
+			continue;
+		}
+		MSG(("%-32s %6lu %6lu %6lu %6lu %5lu %9lu %6lu\n", stats->tag,
+			(unsigned long)stats->count[MSD_TRACE_OP_READ], (unsigned long)stats->count[MSD_TRACE_OP_WRITE],
+			(unsigned long)stats->count[MSD_TRACE_OP_READ_BURST], (unsigned long)stats->count[MSD_TRACE_OP_RMU],
+			(unsigned long)stats->errors,
+			(unsigned long)stats->totalTime, (unsigned long)stats->maxTime));
+		MSG(("    hist:"));
+		for (j = 0; j < MSD_TRACE_HIST_BUCKETS; j++)
+		{
+			MSG((" %lu", (unsigned long)stats->hist[j]));
+		}
+		MSG(("\n"));
+	}
+	if (s_traceDropped != 0U)
+	{
+		MSG(("%lu accesses of untracked callers\n", (unsigned long)s_traceDropped));
+	}
+
+	head = __atomic_load_n(&s_traceHead, __ATOMIC_RELAXED);
+	if (numOfRecord > MSD_TRACE_RING_SIZE)
+	{
+		numOfRecord = MSD_TRACE_RING_SIZE;
+	}
+	if (numOfRecord > head)
+	{
+		numOfRecord = head;
+	}
+	for (i = head - numOfRecord; i != head; i++)
+	{
+		rec = &s_traceRing[i & (MSD_TRACE_RING_SIZE - 1U)];
+		MSG(("%10lu %6lu dev%u %-3s 0x%02x 0x%02x st%u %s\n", (unsigned long)rec->timeStamp, (unsigned long)rec->latency,
+			rec->devNum, (rec->op < (MSD_U8)MSD_TRACE_OP_NUM) ? s_traceOpName[rec->op] : "?",
+			rec->devAddr, rec->regAddr, rec->status, (rec->tag != NULL) ? rec->tag : ""));
+	}
+}
+
+#endif /* MSD_TRACE */
@@ -0,0 +1,181 @@
+/*
+ * smi.c
+ *
+ * GPIO模拟MDIO时序，只在定义MDIO_USE_GPIO时编译，由smiaccess.c的g_mdioGpioBackend使用
+ * 需要在Pins工具中把MDC配置为GPIO输出，MDIO配置为GPIO(输入输出)，并定义：
+ * MDIO_CPU_PORT/MDIO_CPU_PIN/MDIO_CPU_MSCR_BASE、MDC_CPU_PORT/MDC_CPU_PIN
+ */
+
+#ifdef MDIO_USE_GPIO
+
+#include "smi.h"
+#include "Siul2_Dio_Ip.h"
+#include "Siul2_Port_Ip.h"
+
+#if !defined(MDIO_CPU_PORT) || !defined(MDIO_CPU_PIN) || !defined(MDIO_CPU_MSCR_BASE) || !defined(MDC_CPU_PORT) || !defined(MDC_CPU_PIN)
+#error "MDIO_USE_GPIO需要定义MDIO_CPU_PORT/MDIO_CPU_PIN/MDIO_CPU_MSCR_BASE/MDC_CPU_PORT/MDC_CPU_PIN"
+#endif
+
+#define MDIO_PREAMBLE_BITS	32
+#define MDIO_CL45_ST		0x0		//Clause 45帧起始00
+#define MDIO_CL22_ST		0x1		//Clause 22帧起始01
+#define MDIO_TA_WRITE		0x2		//写帧由MAC发送TA 10
+
+static void mdio_delay(unsigned int count)
+{
+	for (volatile unsigned int i = 0; i < count; ++i) {
+	}
+}
+
+void mdc_port_ini(void)
+{
+	mdc_low();
+}
+
+void mdio_port_write_ini(void)
+{
+	Siul2_Port_Ip_SetPinDirection(MDIO_MSCR_BASE_, MDIO_PIN_, SIUL2_PORT_OUT);
+}
+
+void mdio_port_read_ini(void)
+{
+	Siul2_Port_Ip_SetPinDirection(MDIO_MSCR_BASE_, MDIO_PIN_, SIUL2_PORT_IN);
+}
+
+void mdc_high(void)
+{
+	Siul2_Dio_Ip_WritePin(MDC_PORT_, MDC_PIN_, 1U);
+}
+
+void mdc_low(void)
+{
+	Siul2_Dio_Ip_WritePin(MDC_PORT_, MDC_PIN_, 0U);
+}
+
+uint8 mdio_get_bit(void)
+{
+	return (uint8)Siul2_Dio_Ip_ReadPin(MDIO_PORT_, MDIO_PIN_);
+}
+
+void mdio_set_bit(uint8 val)
+{
+	Siul2_Dio_Ip_WritePin(MDIO_PORT_, MDIO_PIN_, (val != 0U) ? 1U : 0U);
+}
+
+//PHY在MDC上升沿采样
+void mdio_write_bit(uint8 val)
+{
+	mdio_set_bit(val);
+	mdio_delay(MDIO_DELAY);
+	mdc_high();
+	mdio_delay(MDIO_DELAY);
+	mdc_low();
+}
+
+//高位先发
+void mdio_write_bits_num(unsigned int value, int nBits)
+{
+	for (int i = nBits - 1; i >= 0; --i) {
+		mdio_write_bit((uint8)((value >> i) & 0x1U));
+	}
+}
+
+//PHY在MDC上升沿之后输出数据，在下一个上升沿之前采样
+uint8 mdio_read_bit(void)
+{
+	mdio_delay(MDIO_READ_DELAY);
+	uint8 val = mdio_get_bit();
+	mdc_high();
+	mdio_delay(MDIO_DELAY);
+	mdc_low();
+	return val;
+}
+
+int mdio_read_bits_num(int nBits)
+{
+	int value = 0;
+	for (int i = 0; i < nBits; ++i) {
+		value = (value << 1) | (int)mdio_read_bit();
+	}
+	return value;
+}
+
+//发送前导码和帧头(ST OP PHYAD REGAD/DEVAD)，MDIO保持输出
+static void mdio_frame_header(unsigned int st, unsigned int op, int phyAddr, int regOrDev)
+{
+	mdio_port_write_ini();
+	mdio_write_bits_num(0xFFFFFFFFU, MDIO_PREAMBLE_BITS);
+	mdio_write_bits_num(st, 2);
+	mdio_write_bits_num(op, 2);
+	mdio_write_bits_num((unsigned int)phyAddr & 0x1FU, 5);
+	mdio_write_bits_num((unsigned int)regOrDev & 0x1FU, 5);
+}
+
+//写帧：TA 10后发送16位数据，然后释放总线
+static void mdio_frame_write(unsigned int st, unsigned int op, int phyAddr, int regOrDev, unsigned int data)
+{
+	mdio_frame_header(st, op, phyAddr, regOrDev);
+	mdio_write_bits_num(MDIO_TA_WRITE, 2);
+	mdio_write_bits_num(data & 0xFFFFU, 16);
+	mdio_port_read_ini();
+	(void)mdio_read_bit();//空闲一个周期
+}
+
+//读帧：TA第一位高阻，第二位由PHY拉低，没有PHY应答时总线被上拉为1，返回-1
+static int mdio_frame_read(unsigned int st, unsigned int op, int phyAddr, int regOrDev)
+{
+	mdio_frame_header(st, op, phyAddr, regOrDev);
+	mdio_port_read_ini();
+	(void)mdio_read_bit();
+	if (mdio_read_bit() != 0U) {
+		(void)mdio_read_bits_num(16);
+		return -1;
+	}
+	int data = mdio_read_bits_num(16);
+	(void)mdio_read_bit();//空闲一个周期
+	return data;
+}
+
+void cl45_mdio_frame_addr(int phyAddr, int device, int regAddr)
+{
+	mdio_frame_write(MDIO_CL45_ST, MDIO_CL45_ADDR, phyAddr, device, (unsigned int)regAddr);
+}
+
+void cl45_mdio_frame_write(int phyAddr, int device, int data)
+{
+	mdio_frame_write(MDIO_CL45_ST, MDIO_CL45_WRITE, phyAddr, device, (unsigned int)data);
+}
+
+int cl45_mdio_frame_read(int phyAddr, int device)
+{
+	return mdio_frame_read(MDIO_CL45_ST, MDIO_CL45_READ, phyAddr, device);
+}
+
+int cl45_mdio_frame_read_inc(int phyAddr, int device)
+{
+	return mdio_frame_read(MDIO_CL45_ST, MDIO_CL45_READ_INC, phyAddr, device);
+}
+
+void cl45_mdio_write(int phyAddr, int device, int regAddr, int data)
+{
+	cl45_mdio_frame_addr(phyAddr, device, regAddr);
+	cl45_mdio_frame_write(phyAddr, device, data);
+}
+
+int cl45_mdio_read(int phyAddr, int device, int regAddr)
+{
+	cl45_mdio_frame_addr(phyAddr, device, regAddr);
+	return cl45_mdio_frame_read(phyAddr, device);
+}
+
+void cl22_mdio_write(int phyAddr, int regAddr, int data)
+{
+	mdio_frame_write(MDIO_CL22_ST, MDIO_CL22_WRITE, phyAddr, regAddr, (unsigned int)data);
+}
+
+int cl22_mdio_read(int phyAddr, int regAddr)
+{
+	return mdio_frame_read(MDIO_CL22_ST, MDIO_CL22_READ, phyAddr, regAddr);
+}
+
+#endif
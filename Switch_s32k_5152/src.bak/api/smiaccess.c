@@ -7,34 +7,268 @@
 // QdCppWrapper.cpp : source file that includes just the standard includes
 
 #include <smiasscess.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "Gmac_Ip.h"
+#ifdef MDIO_USE_GPIO
+#include "smi.h"
+#endif
 
 
 static int g_semcount = 1; //
 
+#define MDIO_GMAC_TIMEOUT_MS	2U	//GMAC MDIO单次访问超时时间
+#define MDIO_MAX_PHY_ADDR		32U
 
+/********************************** GMAC MDIO控制器 **********************************/
+static int gmacC22Read(unsigned int phyAddr, unsigned int regAddr)
+{
+	uint16 data = 0;
+	if (Gmac_Ip_MDIORead(INST_GMAC_0, (uint8)phyAddr, (uint8)regAddr, &data, MDIO_GMAC_TIMEOUT_MS) != GMAC_STATUS_SUCCESS)
+		return -1;
+	return (int)data;
+}
 
-int readRegister(unsigned int phyAddr,unsigned int regAddr)
+static int gmacC22Write(unsigned int phyAddr, unsigned int regAddr, unsigned int data)
 {
+	if (Gmac_Ip_MDIOWrite(INST_GMAC_0, (uint8)phyAddr, (uint8)regAddr, (uint16)data, MDIO_GMAC_TIMEOUT_MS) != GMAC_STATUS_SUCCESS)
+		return -1;
 	return 0;
 }
 
-int writeRegister(unsigned int phyAddr,unsigned int regAddr,unsigned int data)
+//控制器每次访问都会自动发送ADDRESS帧
+static int gmacC45Read(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr)
 {
+	uint16 data = 0;
+	if (Gmac_Ip_MDIOReadMMD(INST_GMAC_0, (uint8)phyAddr, (uint8)devAddr, (uint16)regAddr, &data, MDIO_GMAC_TIMEOUT_MS) != GMAC_STATUS_SUCCESS)
+		return -1;
+	return (int)data;
+}
+
+static int gmacC45Write(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int data)
+{
+	if (Gmac_Ip_MDIOWriteMMD(INST_GMAC_0, (uint8)phyAddr, (uint8)devAddr, (uint16)regAddr, (uint16)data, MDIO_GMAC_TIMEOUT_MS) != GMAC_STATUS_SUCCESS)
+		return -1;
 	return 0;
 }
 
-int readC45Register(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr)
+const MdioBackend g_mdioGmacBackend = {
+	.name = "gmac",
+	.c22Read = gmacC22Read,
+	.c22Write = gmacC22Write,
+	.c45Read = gmacC45Read,
+	.c45Write = gmacC45Write,
+};
+
+#ifdef MDIO_USE_GPIO
+/********************************** GPIO模拟MDIO **********************************/
+//需要链接smi.h中GPIO模拟时序的实现
+static int gpioC22Read(unsigned int phyAddr, unsigned int regAddr)
+{
+	return cl22_mdio_read((int)phyAddr, (int)regAddr);
+}
+
+static int gpioC22Write(unsigned int phyAddr, unsigned int regAddr, unsigned int data)
 {
+	cl22_mdio_write((int)phyAddr, (int)regAddr, (int)data);
 	return 0;
 }
 
-int writeC45Register(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int data)
+static int gpioC45AddrFrame(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr)
+{
+	cl45_mdio_frame_addr((int)phyAddr, (int)devAddr, (int)regAddr);
+	return 0;
+}
+
+static int gpioC45ReadFrame(unsigned int phyAddr, unsigned int devAddr)
+{
+	return cl45_mdio_frame_read((int)phyAddr, (int)devAddr);
+}
+
+static int gpioC45WriteFrame(unsigned int phyAddr, unsigned int devAddr, unsigned int data)
+{
+	cl45_mdio_frame_write((int)phyAddr, (int)devAddr, (int)data);
+	return 0;
+}
+
+static int gpioC45ReadIncFrame(unsigned int phyAddr, unsigned int devAddr)
+{
+	return cl45_mdio_frame_read_inc((int)phyAddr, (int)devAddr);
+}
+
+const MdioBackend g_mdioGpioBackend = {
+	.name = "gpio",
+	.c22Read = gpioC22Read,
+	.c22Write = gpioC22Write,
+	.c45AddrFrame = gpioC45AddrFrame,
+	.c45ReadFrame = gpioC45ReadFrame,
+	.c45WriteFrame = gpioC45WriteFrame,
+	.c45ReadIncFrame = gpioC45ReadIncFrame,
+};
+#endif
+
+/********************************** 后端选择 **********************************/
+#ifdef MDIO_USE_GPIO
+static const MdioBackend* s_mdioBackend = &g_mdioGpioBackend;
+#else
+static const MdioBackend* s_mdioBackend = &g_mdioGmacBackend;
+#endif
+static SemaphoreHandle_t s_mdioMutex = NULL;//一个ADDRESS帧和数据帧之间不能插入其他访问
+
+#ifdef MDIO_USE_GPIO
+//每个PHY地址最后一次ADDRESS帧写入的(devAddr << 16) | regAddr，只有单独发送ADDRESS帧的GPIO后端需要
+static unsigned int s_c45Addr[MDIO_MAX_PHY_ADDR];
+static unsigned int s_c45AddrValid = 0;//bit n表示s_c45Addr[n]有效
+#define C45_ADDR_CACHED(index, addr)	(((s_c45AddrValid >> (index)) & 1U) != 0U && s_c45Addr[index] == (addr))
+#define C45_ADDR_SET(index, addr)		do { s_c45Addr[index] = (addr); s_c45AddrValid |= 1U << (index); } while (0)
+#define C45_ADDR_DROP(index)			(s_c45AddrValid &= ~(1U << (index)))
+#define C45_ADDR_RESET()				(s_c45AddrValid = 0)
+#else
+//GMAC控制器每次访问都自动发送ADDRESS帧，不缓存地址
+#define C45_ADDR_CACHED(index, addr)	((void)(index), (void)(addr), 0)
+#define C45_ADDR_SET(index, addr)		((void)(index), (void)(addr))
+#define C45_ADDR_DROP(index)			((void)(index))
+#define C45_ADDR_RESET()				((void)0)
+#endif
+
+int mdioInit(const MdioBackend* backend)
 {
+	if (s_mdioMutex == NULL) {
+		s_mdioMutex = xSemaphoreCreateMutex();
+		if (s_mdioMutex == NULL)
+			return -1;
+	}
+	xSemaphoreTake(s_mdioMutex, portMAX_DELAY);
+	if (backend != NULL)
+		s_mdioBackend = backend;
+	C45_ADDR_RESET();
+	xSemaphoreGive(s_mdioMutex);
 	return 0;
 }
 
+static void mdioLock(void)
+{
+	if (s_mdioMutex != NULL)
+		xSemaphoreTake(s_mdioMutex, portMAX_DELAY);
+}
 
+static void mdioUnlock(void)
+{
+	if (s_mdioMutex != NULL)
+		xSemaphoreGive(s_mdioMutex);
+}
 
+/**
+ * @brief mdioC45Address 发送Clause 45 ADDRESS帧，如果PHY的地址寄存器已经是该地址则跳过
+ */
+static int mdioC45Address(const MdioBackend* backend, unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr)
+{
+	unsigned int addr = (devAddr << 16) | (regAddr & 0xFFFFU);
+	unsigned int index = phyAddr & (MDIO_MAX_PHY_ADDR - 1U);
 
+	if (C45_ADDR_CACHED(index, addr))
+		return 0;
+	int ret = backend->c45AddrFrame(phyAddr, devAddr, regAddr);
+	if (ret < 0) {
+		C45_ADDR_DROP(index);
+		return ret;
+	}
+	C45_ADDR_SET(index, addr);
+	return 0;
+}
 
+int readRegister(unsigned int phyAddr,unsigned int regAddr)
+{
+	mdioLock();
+	int ret = s_mdioBackend->c22Read(phyAddr, regAddr);
+	mdioUnlock();
+	return ret;
+}
 
+int writeRegister(unsigned int phyAddr,unsigned int regAddr,unsigned int data)
+{
+	mdioLock();
+	int ret = s_mdioBackend->c22Write(phyAddr, regAddr, data);
+	mdioUnlock();
+	return ret;
+}
+
+int readC45Register(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr)
+{
+	const MdioBackend* backend;
+	int ret;
+
+	mdioLock();
+	backend = s_mdioBackend;
+	if (backend->c45AddrFrame != NULL) {
+		ret = mdioC45Address(backend, phyAddr, devAddr, regAddr);
+		if (ret >= 0)
+			ret = backend->c45ReadFrame(phyAddr, devAddr);
+	}
+	else {
+		ret = backend->c45Read(phyAddr, devAddr, regAddr);
+	}
+	mdioUnlock();
+	return ret;
+}
+
+int writeC45Register(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int data)
+{
+	const MdioBackend* backend;
+	int ret;
+
+	mdioLock();
+	backend = s_mdioBackend;
+	if (backend->c45AddrFrame != NULL) {
+		ret = mdioC45Address(backend, phyAddr, devAddr, regAddr);
+		if (ret >= 0)
+			ret = backend->c45WriteFrame(phyAddr, devAddr, data);
+	}
+	else {
+		ret = backend->c45Write(phyAddr, devAddr, regAddr, data);
+	}
+	mdioUnlock();
+	return ret;
+}
+
+int readC45RegisterBurst(unsigned int phyAddr, unsigned int devAddr, unsigned int regAddr, unsigned int count, unsigned short* values)
+{
+	const MdioBackend* backend;
+	unsigned int i;
+	int ret = 0;
+
+	mdioLock();
+	backend = s_mdioBackend;
+	if (backend->c45AddrFrame != NULL && backend->c45ReadIncFrame != NULL) {
+		ret = mdioC45Address(backend, phyAddr, devAddr, regAddr);
+		for (i = 0; i < count && ret >= 0; ++i) {
+			ret = backend->c45ReadIncFrame(phyAddr, devAddr);
+			if (ret >= 0)
+				values[i] = (unsigned short)ret;
+		}
+		//PHY地址寄存器已经自增，缓存的地址失效，只有全部成功时才知道当前地址
+		unsigned int index = phyAddr & (MDIO_MAX_PHY_ADDR - 1U);
+		if (ret >= 0) {
+			C45_ADDR_SET(index, (devAddr << 16) | ((regAddr + count) & 0xFFFFU));
+		}
+		else {
+			C45_ADDR_DROP(index);
+		}
+	}
+	else {
+		for (i = 0; i < count && ret >= 0; ++i) {
+			if (backend->c45AddrFrame != NULL) {
+				ret = mdioC45Address(backend, phyAddr, devAddr, regAddr + i);
+				if (ret >= 0)
+					ret = backend->c45ReadFrame(phyAddr, devAddr);
+			}
+			else {
+				ret = backend->c45Read(phyAddr, devAddr, regAddr + i);
+			}
+			if (ret >= 0)
+				values[i] = (unsigned short)ret;
+		}
+	}
+	mdioUnlock();
+	return ret < 0 ? ret : 0;
+}
@@ -29,5 +29,37 @@ int numberIsInArr(int* arr, int arrSize, int num)
     return -1;
 }
 
+void fidSetClear(FidSet* set)
+{
+    for (int i = 0; i < FID_SET_WORDS; i++) {
+        set->bits[i] = 0;
+    }
+}
 
+int fidSetCount(const FidSet* set)
+{
+    int count = 0;
+    for (int i = 0; i < FID_SET_WORDS; i++) {
+        count += __builtin_popcount(set->bits[i]);
+    }
+    return count;
+}
 
+int fidSetNext(const FidSet* set, int fid)
+{
+    if (fid < 0) {
+        fid = 0;
+    }
+    int index = fid >> 5;
+    if (index >= FID_SET_WORDS) {
+        return -1;
+    }
+    MSD_U32 word = set->bits[index] & (0xFFFFFFFFU << (fid & 0x1F));//去掉小于fid的位
+    while (word == 0) {
+        if (++index == FID_SET_WORDS) {
+            return -1;
+        }
+        word = set->bits[index];
+    }
+    return (index << 5) + __builtin_ctz(word);
+}
@@ -6,6 +6,9 @@
 // #include "hal.h"
 
 #include "mongoose_glue.h"
+#include "apiInit.h"
+#include "deviceMacModule.h"
+#include "deviceMacTelemetryModule.h"
 
 void glue_init(void) {
   MG_DEBUG(("Custom init done"));
@@ -197,6 +200,175 @@ size_t glue_graph_get_graph1(uint32_t from, uint32_t to,
   return i;
 }
 
+// mac_table
+#define MAC_TABLE_DEV_NUM 0
+
+// Each batch of ATU calls runs as one API session (initStartCallAPI holds
+// off the event and telemetry tasks), the session ends between batches so
+// they can run while the previous batch is being sent
+static bool mac_table_begin(void) {
+  if (initStartCallAPI(MAC_TABLE_DEV_NUM) == MSD_OK) return true;
+  MG_ERROR(("initStartCallAPI failed"));
+  return false;
+}
+
+static void mac_table_end(void) {
+  (void) initStopCallAPI(MAC_TABLE_DEV_NUM);
+}
+
+bool glue_mac_table_open(uint32_t *cursor, int type, int vid,
+                         unsigned long port_vec) {
+  bool ok;
+  if (sizeof(AtuIterator) > GLUE_MAC_TABLE_CURSOR * sizeof(uint32_t)) {
+    MG_ERROR(("GLUE_MAC_TABLE_CURSOR too small, need %lu bytes",
+              (unsigned long) sizeof(AtuIterator)));
+    return false;
+  }
+  if (type == 0) type = ATU_ENTRY_TYPE_ALL_VALID;
+  if (!mac_table_begin()) return false;
+  ok = deviceAtuModuleIteratorOpen(MAC_TABLE_DEV_NUM, (AtuIterator *) cursor,
+                                   (AtuEntryType) type, vid,
+                                   (MSD_U32) port_vec) == MSD_OK;
+  mac_table_end();
+  return ok;
+}
+
+// Print the next batch of entries. Arguments: uint32_t *cursor, bool *first,
+// bool *end. Prints at least one character so that the chunk is not empty
+size_t glue_mac_table_print(void (*out)(char, void *), void *ptr, va_list *ap) {
+  AtuIterator *it = (AtuIterator *) va_arg(*ap, uint32_t *);
+  bool *first = va_arg(*ap, bool *);
+  bool *end = va_arg(*ap, bool *);
+  MSD_ATU_ENTRY entries[GLUE_MAC_TABLE_BATCH];
+  MSD_BOOL is_end = MSD_FALSE;
+  int i, count = 0;
+  MSD_STATUS ret = MSD_FAIL;
+  size_t len = 0;
+  if (mac_table_begin()) {
+    ret = deviceAtuModuleIteratorNext(it, entries, GLUE_MAC_TABLE_BATCH, &count,
+                                      &is_end);
+    mac_table_end();
+  }
+  if (ret != MSD_OK) {
+    MG_ERROR(("ATU read failed, MAC table truncated"));
+    deviceAtuModuleIteratorClose(it);
+    is_end = MSD_TRUE;
+  }
+  for (i = 0; i < count; i++) {
+    len += mg_xprintf(out, ptr, "%s{%m:\"%M\",%m:%u,%m:%lu,%m:%u}",
+                      *first ? "" : ",", MG_ESC("mac"), mg_print_mac,
+                      entries[i].macAddr.arEther, MG_ESC("vid"),
+                      (unsigned) entries[i].fid, MG_ESC("ports"),
+                      (unsigned long) entries[i].portVec, MG_ESC("state"),
+                      (unsigned) entries[i].entryState);
+    *first = false;
+  }
+  *end = is_end == MSD_TRUE;
+  if (len == 0) len += mg_xprintf(out, ptr, " ");
+  return len;
+}
+
+// mac_telemetry
+bool glue_mac_telemetry_set(bool enable, unsigned long interval_ms,
+                            unsigned long flap_window_ms,
+                            unsigned long flap_threshold) {
+  MacTelemetryConfig config;
+  if (!enable) return deviceMacTelemetryModuleStop(MAC_TABLE_DEV_NUM) == MSD_OK;
+  config.intervalMs = (MSD_U32) interval_ms;
+  config.flapWindowMs = (MSD_U32) flap_window_ms;
+  config.flapThreshold = (MSD_U32) flap_threshold;
+  return deviceMacTelemetryModuleStart(MAC_TABLE_DEV_NUM, &config) == MSD_OK;
+}
+
+static size_t print_learn_counts(void (*out)(char, void *), void *ptr,
+                                 va_list *ap) {
+  const MSD_U16 *counts = va_arg(*ap, const MSD_U16 *);
+  int i, n = va_arg(*ap, int);
+  size_t len = 0;
+  for (i = 0; i < n; i++) {
+    len += mg_xprintf(out, ptr, "%s%u", i == 0 ? "" : ",", (unsigned) counts[i]);
+  }
+  return len;
+}
+
+// Print the telemetry status as one JSON object. The history is read in
+// a heap buffer, it is too large for the web task stack
+size_t glue_mac_telemetry_print(void (*out)(char, void *), void *ptr,
+                                va_list *ap) {
+  MacTelemetryStatus st;
+  MacFlapEntry flaps[MAC_TELEMETRY_FLAP_TABLE_SIZE];
+  MacTelemetrySample *history;
+  int i, count = 0;
+  size_t len = 0;
+  (void) ap;
+  deviceMacTelemetryModuleGetStatus(MAC_TABLE_DEV_NUM, &st);
+  len += mg_xprintf(out, ptr,
+                    "{%m:%s,%m:%lu,%m:%lu,%m:%lu,%m:%lu,%m:%lu,"
+                    "%m:{%m:%lu,%m:%lu,%m:%lu},%m:%u,%m:%u,"
+                    "%m:{%m:%lu,%m:%lu,%m:%lu,%m:%lu},%m:%lu,%m:%lu,%m:[",
+                    MG_ESC("running"), st.isRunning ? "true" : "false",
+                    MG_ESC("interval"), (unsigned long) st.config.intervalMs,
+                    MG_ESC("flapWindow"), (unsigned long) st.config.flapWindowMs,
+                    MG_ESC("flapThreshold"),
+                    (unsigned long) st.config.flapThreshold, MG_ESC("samples"),
+                    (unsigned long) st.sampleCount, MG_ESC("skipped"),
+                    (unsigned long) st.skippedSamples, MG_ESC("cost"),
+                    MG_ESC("last"), (unsigned long) st.lastSampleCost,
+                    MG_ESC("max"), (unsigned long) st.maxSampleCost,
+                    MG_ESC("avg"), (unsigned long) st.avgSampleCost,
+                    MG_ESC("entries"), (unsigned) st.entryCount,
+                    MG_ESC("nonStatic"), (unsigned) st.nonStaticCount,
+                    MG_ESC("violations"), MG_ESC("member"),
+                    (unsigned long) st.memberViolations, MG_ESC("miss"),
+                    (unsigned long) st.missViolations, MG_ESC("full"),
+                    (unsigned long) st.fullViolations, MG_ESC("ageOut"),
+                    (unsigned long) st.ageOutViolations, MG_ESC("moves"),
+                    (unsigned long) st.moveCount, MG_ESC("flapEvents"),
+                    (unsigned long) st.flapEvents, MG_ESC("ports"));
+  for (i = 0; i < st.portCount; i++) {
+    const MacTelemetryPortStats *p = &st.ports[i];
+    len += mg_xprintf(out, ptr, "%s{%m:%u,%m:%u,%m:%lu,%m:%lu,%m:%lu,%m:%lu}",
+                      i == 0 ? "" : ",", MG_ESC("learnCount"),
+                      (unsigned) p->learnCount, MG_ESC("learnRate"),
+                      (unsigned) p->learnRate, MG_ESC("learned"),
+                      (unsigned long) p->learnedTotal, MG_ESC("removed"),
+                      (unsigned long) p->removedTotal, MG_ESC("member"),
+                      (unsigned long) p->memberViolations, MG_ESC("ageOut"),
+                      (unsigned long) p->ageOutViolations);
+  }
+  len += mg_xprintf(out, ptr, "],%m:[", MG_ESC("flaps"));
+  deviceMacTelemetryModuleGetFlaps(MAC_TABLE_DEV_NUM, flaps,
+                                   MAC_TELEMETRY_FLAP_TABLE_SIZE, &count);
+  for (i = 0; i < count; i++) {
+    len += mg_xprintf(out, ptr, "%s{%m:\"%M\",%m:%u,%m:%u,%m:%u,%m:%u,%m:%s}",
+                      i == 0 ? "" : ",", MG_ESC("mac"), mg_print_mac,
+                      flaps[i].macAddr.arEther, MG_ESC("vid"),
+                      (unsigned) flaps[i].fid, MG_ESC("port"),
+                      (unsigned) flaps[i].lastPort, MG_ESC("ports"),
+                      (unsigned) flaps[i].portVec, MG_ESC("moves"),
+                      (unsigned) flaps[i].moveCount, MG_ESC("flapping"),
+                      flaps[i].isFlapping ? "true" : "false");
+  }
+  len += mg_xprintf(out, ptr, "],%m:[", MG_ESC("history"));
+  history = (MacTelemetrySample *) calloc(MAC_TELEMETRY_HISTORY_SIZE,
+                                          sizeof(*history));
+  count = 0;
+  if (history != NULL) {
+    deviceMacTelemetryModuleGetHistory(MAC_TABLE_DEV_NUM, history,
+                                       MAC_TELEMETRY_HISTORY_SIZE, &count);
+  }
+  for (i = 0; i < count; i++) {
+    len += mg_xprintf(out, ptr, "%s[%lu,%u,%u,[%M]]", i == 0 ? "" : ",",
+                      (unsigned long) history[i].timestamp,
+                      (unsigned) history[i].entryCount,
+                      (unsigned) history[i].nonStaticCount, print_learn_counts,
+                      history[i].learnCount, (int) st.portCount);
+  }
+  free(history);
+  len += mg_xprintf(out, ptr, "]}");
+  return len;
+}
+
 static struct state s_state = {42, 27, 70, 10, "1.0.0", true, false, 83};
 void glue_get_state(struct state *data) {
   *data = s_state;  // Sync with your device
@@ -228,6 +228,12 @@ struct action_state {
   bool (*fn)(void);  // Action status function
 };
 
+struct mac_table_state {
+  char marker;  // Tells that we're streaming the MAC table
+  bool first;   // No entry printed yet
+  uint32_t cursor[GLUE_MAC_TABLE_CURSOR];  // glue_mac_table_open() cursor
+};
+
 static void close_uploaded_file(struct upload_state *us) {
   us->marker = 0;
   if (us->fn_close != NULL && us->fp != NULL) {
@@ -431,6 +437,71 @@ static void handle_graph(struct mg_connection *c, struct mg_http_message *hm,
                 values, count);
 }
 
+static void handle_mac_table(struct mg_connection *c,
+                             struct mg_http_message *hm) {
+  struct mac_table_state *ms = (struct mac_table_state *) c->data;
+  char buf[12];
+  int type = 0, vid = -1;
+  unsigned long port_vec = 0;
+  if (sizeof(*ms) > sizeof(c->data)) {
+    mg_error(
+        c, "FAILURE: sizeof(c->data) == %lu, need %lu. Set -DMG_DATA_SIZE=XXX",
+        sizeof(c->data), sizeof(*ms));
+    return;
+  }
+  if (mg_http_get_var(&hm->query, "type", buf, sizeof(buf)) > 0) type = atoi(buf);
+  if (mg_http_get_var(&hm->query, "vid", buf, sizeof(buf)) > 0) vid = atoi(buf);
+  if (mg_http_get_var(&hm->query, "ports", buf, sizeof(buf)) > 0) {
+    port_vec = strtoul(buf, NULL, 0);
+  }
+  memset(ms, 0, sizeof(*ms));
+  if (!glue_mac_table_open(ms->cursor, type, vid, port_vec)) {
+    mg_http_reply(c, 400, JSON_HEADERS, "Bad parameter\n");
+    return;
+  }
+  mg_printf(c, "HTTP/1.1 200 OK\r\n" JSON_HEADERS
+               "Transfer-Encoding: chunked\r\n\r\n");
+  mg_http_printf_chunk(c, "[");
+  ms->marker = 'M';
+  ms->first = true;
+}
+
+// Send the next batch once the previous one has left the send buffer,
+// so the table is streamed in fixed memory whatever its size
+static void send_mac_table(struct mg_connection *c) {
+  struct mac_table_state *ms = (struct mac_table_state *) c->data;
+  bool end = false;
+  if (c->send.len > 0) return;
+  mg_http_printf_chunk(c, "%M", glue_mac_table_print, ms->cursor, &ms->first,
+                       &end);
+  if (end) {
+    mg_http_printf_chunk(c, "]\n");
+    mg_http_printf_chunk(c, "");
+    memset(ms, 0, sizeof(*ms));
+  }
+}
+
+// POST {"enable":true,"interval":1000,"flapWindow":10000,"flapThreshold":3}
+// starts or stops sampling, zero or missing values select the defaults
+static void handle_mac_telemetry(struct mg_connection *c,
+                                 struct mg_http_message *hm) {
+  if (hm->body.len > 0) {
+    bool enable = true;
+    long interval = mg_json_get_long(hm->body, "$.interval", 0);
+    long window = mg_json_get_long(hm->body, "$.flapWindow", 0);
+    long threshold = mg_json_get_long(hm->body, "$.flapThreshold", 0);
+    mg_json_get_bool(hm->body, "$.enable", &enable);
+    if (interval < 0 || window < 0 || threshold < 0 ||
+        !glue_mac_telemetry_set(enable, (unsigned long) interval,
+                                (unsigned long) window,
+                                (unsigned long) threshold)) {
+      mg_http_reply(c, 400, JSON_HEADERS, "Bad parameter\n");
+      return;
+    }
+  }
+  mg_http_reply(c, 200, JSON_HEADERS, "%M\n", glue_mac_telemetry_print);
+}
+
 static void handle_api_call(struct mg_connection *c, struct mg_http_message *hm,
                             struct apihandler *h) {
   if (strcmp(h->type, "object") == 0) {
@@ -453,7 +524,9 @@ void glue_update_state(void) {
 void http_ev_handler(struct mg_connection *c, int ev, void *ev_data) {
 #if WIZARD_ENABLE_HTTP_UI
   handle_uploads(c, ev, ev_data);
-  if (ev == MG_EV_POLL && c->data[0] == 'A') {
+  if ((ev == MG_EV_POLL || ev == MG_EV_WRITE) && c->data[0] == 'M') {
+    send_mac_table(c);
+  } else if (ev == MG_EV_POLL && c->data[0] == 'A') {
     // Check if action in progress is complete
     struct action_state *as = (struct action_state *) c->data;
     if (as->fn() == false) {
@@ -482,6 +555,10 @@ void http_ev_handler(struct mg_connection *c, int ev, void *ev_data) {
 #endif
         if (mg_match(hm->uri, mg_str("/api/ok"), NULL)) {
       mg_http_reply(c, 200, JSON_HEADERS, "true\n");
+    } else if (mg_match(hm->uri, mg_str("/api/mac_table"), NULL)) {
+      handle_mac_table(c, hm);
+    } else if (mg_match(hm->uri, mg_str("/api/mac_telemetry"), NULL)) {
+      handle_mac_telemetry(c, hm);
     } else if (mg_match(hm->uri, mg_str("/api/heartbeat"), NULL)) {
       mg_http_reply(c, 200, JSON_HEADERS, "{%m:%lu}\n", MG_ESC("version"),
                     s_device_change_version);
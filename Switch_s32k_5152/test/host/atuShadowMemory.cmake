@@ -0,0 +1,36 @@
+# Prints the size of the shadow ATU (s_atuModuleInitType) in the full and the
+# ATU_SHADOW_STATIC_ONLY build of deviceMacModule.c, and fails unless the
+# static only shadow is smaller and the full shadow is no larger than the
+# array shadow it replaced (4160 16 byte MacEntry plus the 4096 bit VID
+# flags and counters, 67092 bytes).
+#
+#   cmake -DNM=<nm> -DFULL=<objects> -DSTATIC_ONLY=<objects> -P atuShadowMemory.cmake
+
+function(shadow_size objects result)
+    foreach(object ${objects})
+        if(object MATCHES "deviceMacModule")
+            execute_process(COMMAND ${NM} -S ${object} OUTPUT_VARIABLE symbols)
+            string(REGEX MATCH "[0-9a-fA-F]+ ([0-9a-fA-F]+) [bBdD] s_atuModuleInitType" line "${symbols}")
+            if(NOT line)
+                message(FATAL_ERROR "s_atuModuleInitType not found in ${object}")
+            endif()
+            math(EXPR size "0x${CMAKE_MATCH_1}")
+            set(${result} ${size} PARENT_SCOPE)
+            return()
+        endif()
+    endforeach()
+    message(FATAL_ERROR "deviceMacModule object not found")
+endfunction()
+
+shadow_size("${FULL}" full)
+shadow_size("${STATIC_ONLY}" staticOnly)
+message("shadow ATU full        ${full} bytes")
+message("shadow ATU static only ${staticOnly} bytes")
+set(baseline 67092)
+message("shadow ATU baseline    ${baseline} bytes")
+if(NOT staticOnly LESS full)
+    message(FATAL_ERROR "the static only shadow is not smaller")
+endif()
+if(full GREATER baseline)
+    message(FATAL_ERROR "the full shadow is larger than the baseline")
+endif()
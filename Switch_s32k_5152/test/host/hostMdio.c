@@ -0,0 +1,80 @@
+/*
+ * hostMdio.c - the MDIO bus under smiaccess.c for the host build. The GPIO
+ * frame functions of smi.h and the GMAC MDIO functions send their frames to
+ * the simulator (msdSimMdioXxx), so apiInit.c reaches the registers through
+ * readC45Register/writeC45Register/readC45RegisterBurst as on the board,
+ * with the Clause 45 address cache of the GPIO backend in between.
+ */
+#include <msdSim.h>
+#include "Gmac_Ip.h"
+#include "smi.h"
+
+/* Clause 22 */
+int cl22_mdio_read(int phyAddr, int regAddr)
+{
+    MSD_U16 value = 0;
+    if (msdSimMdioC22Read((MSD_U8)phyAddr, (MSD_U8)regAddr, &value) != MSD_OK)
+        return -1;
+    return (int)value;
+}
+
+void cl22_mdio_write(int phyAddr, int regAddr, int data)
+{
+    (void)msdSimMdioC22Write((MSD_U8)phyAddr, (MSD_U8)regAddr, (MSD_U16)data);
+}
+
+/* Clause 45, one frame each */
+void cl45_mdio_frame_addr(int phyAddr, int device, int regAddr)
+{
+    (void)msdSimMdioC45Address((MSD_U8)phyAddr, (MSD_U8)device, (MSD_U16)regAddr);
+}
+
+void cl45_mdio_frame_write(int phyAddr, int device, int data)
+{
+    (void)msdSimMdioC45Write((MSD_U8)phyAddr, (MSD_U8)device, (MSD_U16)data);
+}
+
+static int hostC45ReadFrame(int phyAddr, int device, MSD_BOOL postIncrement)
+{
+    MSD_U16 value = 0;
+    if (msdSimMdioC45Read((MSD_U8)phyAddr, (MSD_U8)device, postIncrement, &value) != MSD_OK)
+        return -1;
+    return (int)value;
+}
+
+int cl45_mdio_frame_read(int phyAddr, int device)
+{
+    return hostC45ReadFrame(phyAddr, device, MSD_FALSE);
+}
+
+int cl45_mdio_frame_read_inc(int phyAddr, int device)
+{
+    return hostC45ReadFrame(phyAddr, device, MSD_TRUE);
+}
+
+/* GMAC controller, a Clause 45 access is an ADDRESS frame and a data frame */
+Gmac_Ip_StatusType Gmac_Ip_MDIORead(uint8 Instance, uint8 PhyAddr, uint8 PhyReg, uint16* Data, uint32 TimeoutMs)
+{
+    (void)Instance; (void)TimeoutMs;
+    return msdSimMdioC22Read(PhyAddr, PhyReg, Data) == MSD_OK ? GMAC_STATUS_SUCCESS : GMAC_STATUS_TIMEOUT;
+}
+
+Gmac_Ip_StatusType Gmac_Ip_MDIOWrite(uint8 Instance, uint8 PhyAddr, uint8 PhyReg, uint16 Data, uint32 TimeoutMs)
+{
+    (void)Instance; (void)TimeoutMs;
+    return msdSimMdioC22Write(PhyAddr, PhyReg, Data) == MSD_OK ? GMAC_STATUS_SUCCESS : GMAC_STATUS_TIMEOUT;
+}
+
+Gmac_Ip_StatusType Gmac_Ip_MDIOReadMMD(uint8 Instance, uint8 PhyAddr, uint8 Mmd, uint16 PhyReg, uint16* Data, uint32 TimeoutMs)
+{
+    (void)Instance; (void)TimeoutMs;
+    (void)msdSimMdioC45Address(PhyAddr, Mmd, PhyReg);
+    return msdSimMdioC45Read(PhyAddr, Mmd, MSD_FALSE, Data) == MSD_OK ? GMAC_STATUS_SUCCESS : GMAC_STATUS_TIMEOUT;
+}
+
+Gmac_Ip_StatusType Gmac_Ip_MDIOWriteMMD(uint8 Instance, uint8 PhyAddr, uint8 Mmd, uint16 PhyReg, uint16 Data, uint32 TimeoutMs)
+{
+    (void)Instance; (void)TimeoutMs;
+    (void)msdSimMdioC45Address(PhyAddr, Mmd, PhyReg);
+    return msdSimMdioC45Write(PhyAddr, Mmd, Data) == MSD_OK ? GMAC_STATUS_SUCCESS : GMAC_STATUS_TIMEOUT;
+}
@@ -0,0 +1,315 @@
+/*
+ * hostRtos.c - host implementation of the FreeRTOS shim
+ *
+ * Outside hostTaskRun everything is single threaded: created tasks do not
+ * run, a blocking call of the test itself only moves the tick count. Inside
+ * hostTaskRun the tasks run cooperatively on their own ucontext stacks, a
+ * task switches back to the scheduler whenever it blocks (vTaskDelay,
+ * ulTaskNotifyTake, xSemaphoreTake on a taken mutex), and the tick count
+ * jumps to the next wake up time when no task is ready.
+ */
+#include <stdlib.h>
+#include <ucontext.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#define HOST_TASK_MAX           16
+#define HOST_TASK_STACK_SIZE    (256 * 1024)    /* host frames, usStackDepth is ignored */
+
+struct HostSemaphore_ {
+    TaskHandle_t holder;
+    int taken;
+};
+
+struct HostTask_ {
+    TaskFunction_t code;
+    void *param;
+    uint32_t notifyValue;
+    int suspended;
+    int deleted;
+    ucontext_t context;
+    void *stack;
+    /* why the task is blocked, cleared when it runs again */
+    int waitNotify;
+    SemaphoreHandle_t waitSemaphore;
+    TickType_t wakeTick;            /* portMAX_DELAY waits without timeout */
+    int isBlocked;
+};
+
+static TickType_t s_tickCount;
+static UBaseType_t s_taskCount;
+static struct HostTask_ s_mainTask;
+static TaskHandle_t s_tasks[HOST_TASK_MAX];
+static TaskHandle_t s_current;          /* running task inside hostTaskRun, NULL outside */
+static ucontext_t s_schedulerContext;
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return malloc(xWantedSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+void hostTickAdvance(TickType_t ticks)
+{
+    s_tickCount += ticks;
+}
+
+static void hostTaskFree(TaskHandle_t task)
+{
+    for (int i = 0; i < HOST_TASK_MAX; ++i) {
+        if (s_tasks[i] == task)
+            s_tasks[i] = NULL;
+    }
+    free(task->stack);
+    free(task);
+}
+
+/* switch from the running task back to the scheduler until it picks the task again */
+static void hostTaskBlock(TickType_t ticks)
+{
+    TaskHandle_t task = s_current;
+    task->isBlocked = 1;
+    task->wakeTick = ticks == portMAX_DELAY ? portMAX_DELAY : s_tickCount + ticks;
+    swapcontext(&task->context, &s_schedulerContext);
+    task->isBlocked = 0;
+    task->waitNotify = 0;
+    task->waitSemaphore = NULL;
+}
+
+static int hostTaskTimedOut(TaskHandle_t task)
+{
+    return task->wakeTick != portMAX_DELAY && s_tickCount >= task->wakeTick;
+}
+
+static int hostTaskReady(TaskHandle_t task)
+{
+    if (task->suspended || task->deleted)
+        return 0;
+    if (!task->isBlocked)
+        return 1;
+    if (task->waitNotify && task->notifyValue != 0U)
+        return 1;
+    if (task->waitSemaphore != NULL && !task->waitSemaphore->taken)
+        return 1;
+    return hostTaskTimedOut(task);
+}
+
+static void hostTaskEntry(void)
+{
+    s_current->code(s_current->param);
+    /* a FreeRTOS task must not return, treat it as deleting itself */
+    vTaskDelete(NULL);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint16_t usStackDepth,
+                       void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+    struct HostTask_ *task = (struct HostTask_ *)calloc(1, sizeof(struct HostTask_));
+    int slot = 0;
+    (void)pcName;
+    (void)usStackDepth;
+    (void)uxPriority;
+    while (slot < HOST_TASK_MAX && s_tasks[slot] != NULL)
+        slot++;
+    if (task == NULL || slot == HOST_TASK_MAX) {
+        free(task);
+        return pdFAIL;
+    }
+    task->stack = malloc(HOST_TASK_STACK_SIZE);
+    if (task->stack == NULL) {
+        free(task);
+        return pdFAIL;
+    }
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = HOST_TASK_STACK_SIZE;
+    task->context.uc_link = &s_schedulerContext;
+    makecontext(&task->context, hostTaskEntry, 0);
+    task->code = pxTaskCode;
+    task->param = pvParameters;
+    s_tasks[slot] = task;
+    s_taskCount++;
+    if (pxCreatedTask != NULL)
+        *pxCreatedTask = task;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTask)
+{
+    if (xTask == NULL)
+        xTask = s_current;
+    if (xTask == NULL || xTask == &s_mainTask || xTask->deleted)
+        return;
+    xTask->deleted = 1;
+    s_taskCount--;
+    if (xTask == s_current) {
+        /* the scheduler frees the stack once it is off it */
+        swapcontext(&xTask->context, &s_schedulerContext);
+        return;
+    }
+    hostTaskFree(xTask);
+}
+
+void vTaskSuspend(TaskHandle_t xTask)
+{
+    if (xTask == NULL)
+        xTask = s_current;
+    if (xTask == NULL)
+        return;
+    xTask->suspended = 1;
+    if (xTask == s_current)
+        hostTaskBlock(0);
+}
+
+void vTaskResume(TaskHandle_t xTask)
+{
+    if (xTask != NULL)
+        xTask->suspended = 0;
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    if (s_current != NULL)
+        hostTaskBlock(xTicksToDelay);
+    else
+        s_tickCount += xTicksToDelay;
+}
+
+void vTaskStartScheduler(void)
+{
+    /* the tasks only run inside hostTaskRun */
+}
+
+void hostTaskRun(TickType_t ticks)
+{
+    TickType_t end = s_tickCount + ticks;
+    int next = 0;
+    for (;;) {
+        TaskHandle_t task = NULL;
+        for (int n = 0; n < HOST_TASK_MAX && task == NULL; ++n) {
+            int i = (next + n) % HOST_TASK_MAX;
+            if (s_tasks[i] != NULL && hostTaskReady(s_tasks[i])) {
+                task = s_tasks[i];
+                next = i + 1;
+            }
+        }
+        if (task != NULL) {
+            s_current = task;
+            swapcontext(&s_schedulerContext, &task->context);
+            s_current = NULL;
+            if (task->deleted)
+                hostTaskFree(task);
+            continue;
+        }
+        /* nothing ready, jump to the next timeout */
+        TickType_t wake = end;
+        for (int i = 0; i < HOST_TASK_MAX; ++i) {
+            TaskHandle_t blocked = s_tasks[i];
+            if (blocked != NULL && !blocked->suspended && blocked->isBlocked && blocked->wakeTick != portMAX_DELAY &&
+                blocked->wakeTick < wake)
+                wake = blocked->wakeTick;
+        }
+        if (s_tickCount >= end)
+            break;
+        s_tickCount = wake;
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return s_tickCount;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current != NULL ? s_current : &s_mainTask;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    if (xTaskToNotify != NULL)
+        xTaskToNotify->notifyValue++;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    (void)xTaskNotifyGive(xTaskToNotify);
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (task->notifyValue == 0U && xTicksToWait != 0U) {
+        if (s_current != NULL) {
+            task->waitNotify = 1;
+            hostTaskBlock(xTicksToWait);
+        }
+        else if (xTicksToWait != portMAX_DELAY) {
+            s_tickCount += xTicksToWait;
+        }
+    }
+    uint32_t value = task->notifyValue;
+    task->notifyValue = (xClearCountOnExit != pdFALSE || value == 0U) ? 0U : value - 1U;
+    return value;
+}
+
+UBaseType_t hostTaskCount(void)
+{
+    return s_taskCount;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return (SemaphoreHandle_t)calloc(1, sizeof(struct HostSemaphore_));
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    free(xSemaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    if (xSemaphore == NULL)
+        return pdFALSE;
+    if (xSemaphore->taken && s_current != NULL && xSemaphore->holder != s_current) {
+        /* wait for the holding task to give it back */
+        TickType_t start = s_tickCount;
+        while (xSemaphore->taken && xBlockTime != 0U) {
+            TickType_t left = xBlockTime;
+            if (xBlockTime != portMAX_DELAY) {
+                if (s_tickCount - start >= xBlockTime)
+                    break;
+                left = xBlockTime - (s_tickCount - start);
+            }
+            s_current->waitSemaphore = xSemaphore;
+            hostTaskBlock(left);
+        }
+    }
+    if (xSemaphore->taken) {
+        /* nobody else can give it back on a single thread */
+        if (s_current == NULL && xBlockTime != portMAX_DELAY)
+            s_tickCount += xBlockTime;
+        return pdFALSE;
+    }
+    xSemaphore->taken = 1;
+    xSemaphore->holder = xTaskGetCurrentTaskHandle();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    if (xSemaphore == NULL || !xSemaphore->taken)
+        return pdFALSE;
+    xSemaphore->taken = 0;
+    xSemaphore->holder = NULL;
+    return pdTRUE;
+}
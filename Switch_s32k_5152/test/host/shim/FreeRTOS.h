@@ -0,0 +1,48 @@
+/*
+ * FreeRTOS.h - host shim
+ *
+ * Just enough of the FreeRTOS API for the driver and the device modules to
+ * build and run on the host against the switch simulator. Tasks only run
+ * when a test calls hostTaskRun, cooperatively, see hostRtos.c. Otherwise the
+ * tick count only moves when msdDelay/vTaskDelay is called or a test
+ * advances it with hostTickAdvance.
+ */
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+
+#define configTICK_RATE_HZ      ((TickType_t)1000)
+#define configMINIMAL_STACK_SIZE ((uint16_t)128)
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * configTICK_RATE_HZ) / (TickType_t)1000U))
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+
+void *pvPortMalloc(size_t xWantedSize);
+void vPortFree(void *pv);
+
+/* host only: move the tick count forward */
+void hostTickAdvance(TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_FREERTOS_H */
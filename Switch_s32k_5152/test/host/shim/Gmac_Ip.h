@@ -0,0 +1,23 @@
+/*
+ * Gmac_Ip.h - host shim, the MDIO functions of the GMAC driver used by the
+ * GMAC backend of smiaccess.c. hostMdio.c serves them from the simulator.
+ */
+#ifndef HOST_GMAC_IP_H
+#define HOST_GMAC_IP_H
+
+#include <PlatformTypes.h>
+
+#define INST_GMAC_0     (0U)
+
+typedef enum {
+    GMAC_STATUS_SUCCESS = 0x000U,
+    GMAC_STATUS_ERROR   = 0x001U,
+    GMAC_STATUS_TIMEOUT = 0x003U
+} Gmac_Ip_StatusType;
+
+Gmac_Ip_StatusType Gmac_Ip_MDIORead(uint8 Instance, uint8 PhyAddr, uint8 PhyReg, uint16* Data, uint32 TimeoutMs);
+Gmac_Ip_StatusType Gmac_Ip_MDIOWrite(uint8 Instance, uint8 PhyAddr, uint8 PhyReg, uint16 Data, uint32 TimeoutMs);
+Gmac_Ip_StatusType Gmac_Ip_MDIOReadMMD(uint8 Instance, uint8 PhyAddr, uint8 Mmd, uint16 PhyReg, uint16* Data, uint32 TimeoutMs);
+Gmac_Ip_StatusType Gmac_Ip_MDIOWriteMMD(uint8 Instance, uint8 PhyAddr, uint8 Mmd, uint16 PhyReg, uint16 Data, uint32 TimeoutMs);
+
+#endif /* HOST_GMAC_IP_H */
@@ -0,0 +1,15 @@
+/*
+ * OsIf.h - host shim, the system timer is off so msdTimeStamp uses the
+ * FreeRTOS tick.
+ */
+#ifndef HOST_OSIF_H
+#define HOST_OSIF_H
+
+#define STD_ON                  1U
+#define STD_OFF                 0U
+#define OSIF_USE_SYSTEM_TIMER   STD_OFF
+#define OSIF_COUNTER_SYSTEM     1U
+
+#define OsIf_GetCounter(counter) (0U)
+
+#endif /* HOST_OSIF_H */
@@ -0,0 +1,14 @@
+/*
+ * PlatformTypes.h - host shim, the AUTOSAR integer types used by smi.h and
+ * Gmac_Ip.h.
+ */
+#ifndef HOST_PLATFORM_TYPES_H
+#define HOST_PLATFORM_TYPES_H
+
+#include <stdint.h>
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+
+#endif /* HOST_PLATFORM_TYPES_H */
@@ -0,0 +1,8 @@
+/*
+ * Siul2_Port_Ip_Cfg.h - host shim, the MDIO/MDC pins of smi.h are not used
+ * by the host MDIO frames in hostMdio.c.
+ */
+#ifndef HOST_SIUL2_PORT_IP_CFG_H
+#define HOST_SIUL2_PORT_IP_CFG_H
+
+#endif /* HOST_SIUL2_PORT_IP_CFG_H */
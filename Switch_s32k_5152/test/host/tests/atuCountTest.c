@@ -0,0 +1,124 @@
+/*
+ * atuCountTest.c - the per-VID entry counts of the shadow ATU under churn.
+ * After every operation the counts are rebuilt from the VID chains by
+ * deviceAtuModuleCheckConsistency, and "VID has no MAC entry" must agree
+ * with the per-FID entry count read from the switch.
+ * A static refresh that reads more static entries than the shadow keeps must
+ * not delete the shadow entries it did not get to.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+#include <deviceVlanModule.h>
+
+#define COUNT_MACS      48
+#define COUNT_VIDS      6
+#define COUNT_OPS       400
+
+static MSD_U32 s_seed = 2024;
+
+static MSD_U32 countRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+static MSD_U16 countVid(MSD_U32 vidIndex)
+{
+    return (MSD_U16)(PORT_DEFAULT_VID + vidIndex);
+}
+
+static void countCheck(int op)
+{
+    MSD_STATUS ret = deviceAtuModuleCheckConsistency(HOST_DEV);
+    if (ret != MSD_OK)
+        printf("operation %d: inconsistent counts\n", op);
+    HOST_CHECK(ret == MSD_OK);
+    for (MSD_U32 v = 0; v < COUNT_VIDS; ++v) {
+        MSD_U32 hwCount = 0;
+        HOST_CHECK_OK(msdFdbEntryCountPerFidGet(HOST_DEV, countVid(v), &hwCount));
+        MSD_BOOL isFree = deviceAtuModuleSetMacEntryVidFlagAndSize(HOST_DEV, countVid(v), MSD_FALSE);
+        if (isFree != (hwCount == 0 ? MSD_TRUE : MSD_FALSE))
+            printf("operation %d: vid %u has %u entries in the switch, the shadow says %s\n", op, (unsigned)countVid(v),
+                   (unsigned)hwCount, isFree ? "none" : "some");
+        HOST_CHECK(isFree == (hwCount == 0 ? MSD_TRUE : MSD_FALSE));
+    }
+}
+
+static void countOne(void)
+{
+    MSD_ATU_ENTRY entry;
+    MSD_U32 op = countRandom(20);
+    MSD_U32 index = countRandom(COUNT_MACS);
+    MSD_U32 vidIndex = countRandom(COUNT_VIDS);
+    /* the first quarter of the MACs is static */
+    MSD_BOOL isStatic = index < COUNT_MACS / 4 ? MSD_TRUE : MSD_FALSE;
+
+    memset(&entry, 0, sizeof(entry));
+    hostMac(&entry.macAddr, index);
+    entry.fid = countVid(vidIndex);
+    if (op < 10) {
+        entry.portVec = 1U << (1 + countRandom(8));
+        entry.entryState = isStatic ? 0xF : 0x7;
+        HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+    }
+    else if (op < 14) {
+        HOST_CHECK_OK(deviceAtuModuleDeleteEntry(HOST_DEV, entry.macAddr));
+    }
+    else if (op < 17) {
+        (void)msdFdbMacEntryDelete(HOST_DEV, &entry.macAddr, entry.fid);
+        HOST_CHECK_OK(deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(HOST_DEV));
+        HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    }
+    else if (op < 19) {
+        HOST_CHECK_OK(deviceAtuModuleFlushStaticEntries(HOST_DEV, entry.fid, NULL));
+    }
+    else {
+        HOST_CHECK_OK(deviceAtuModuleFlushEntries(HOST_DEV, MSD_FLUSH_ALL_NONSTATIC));
+        HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    }
+}
+
+static void countTruncatedRefresh(void)
+{
+    MSD_ATU_ENTRY entry;
+    MSD_ETHERADDR mac;
+    MSD_U32 generation;
+
+    HOST_CHECK_OK(deviceAtuModuleFlushEntries(HOST_DEV, MSD_FLUSH_ALL));
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(HOST_DEV));
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    memset(&entry, 0, sizeof(entry));
+    entry.fid = countVid(0);
+    entry.portVec = 1U << 1;
+    entry.entryState = 0xF;
+    /* a full shadow, then as many static entries behind its back with lower MACs, so they are read first */
+    for (MSD_U32 i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
+        hostMac(&entry.macAddr, 0x2000 + i);
+        HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+    }
+    for (MSD_U32 i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
+        hostMac(&entry.macAddr, 0x1000 + i);
+        HOST_CHECK_OK(msdFdbMacEntryAdd(HOST_DEV, &entry));
+    }
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(HOST_DEV));
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+    for (MSD_U32 i = 0; i < MAX_STATIC_ATU_ENTRIES; ++i) {
+        hostMac(&mac, 0x2000 + i);
+        HOST_CHECK_OK(deviceAtuModuleGetEntryGeneration(HOST_DEV, mac, countVid(0), MSD_TRUE, &generation));
+    }
+    HOST_CHECK_OK(deviceAtuModuleFlushEntries(HOST_DEV, MSD_FLUSH_ALL));
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    countCheck(0);
+    for (int op = 1; op <= COUNT_OPS; ++op) {
+        countOne();
+        countCheck(op);
+    }
+    countTruncatedRefresh();
+    hostClose();
+    return hostResult("atuCountTest");
+}
@@ -0,0 +1,77 @@
+/*
+ * atuDumpBench.c - time to read a full ATU of 4096 entries through
+ * deviceAtuModuleGetList, over SMI with one GetNext operation per entry and
+ * over RMU with MSD_DumpATU frames of MSD_RMU_MAX_ATUS entries. Both reads
+ * must return the same entries, the RMU one in a handful of frames and in
+ * less bus time.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+
+#define BENCH_FIDS          2       /* the FIDs read by default, see setFidValue */
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_ATU_ENTRY s_smiList[MSD_SIM_ATU_SIZE];
+static MSD_ATU_ENTRY s_rmuList[MSD_SIM_ATU_SIZE];
+
+/* MSD_SIM_ATU_SIZE entries spread over FID 0 and 1, every fourth one dynamic */
+static void benchFill(void)
+{
+    MSD_ATU_ENTRY entry;
+
+    HOST_CHECK_OK(deviceAtuModuleFlushEntries(HOST_DEV, MSD_FLUSH_ALL));
+    for (MSD_U32 i = 0; i < MSD_SIM_ATU_SIZE; ++i) {
+        memset(&entry, 0, sizeof(entry));
+        hostMac(&entry.macAddr, i);
+        entry.fid = (MSD_U16)(i % BENCH_FIDS);
+        entry.portVec = 1U << (1 + i % 8);
+        entry.entryState = i % 4 == 0 ? 0x7 : 0xE;
+        HOST_CHECK_OK(msdFdbMacEntryAdd(HOST_DEV, &entry));
+    }
+}
+
+/* reads the whole ATU, returns the bus time in uSec */
+static double benchDump(MSD_INTERFACE channel, MSD_ATU_ENTRY* list, int* count, MSD_SIM_STATS* cost)
+{
+    MSD_SIM_STATS before, after;
+
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, channel));
+    msdSimStatsGet(&before);
+    HOST_CHECK_OK(deviceAtuModuleGetList(HOST_DEV, ATU_ENTRY_TYPE_ALL, list, MSD_SIM_ATU_SIZE, count));
+    msdSimStatsGet(&after);
+    cost->atuOps = after.atuOps - before.atuOps;
+    cost->rmuFrames = after.rmuFrames - before.rmuFrames;
+    double us = (double)(after.clock - before.clock) / 1000.0;
+    printf("%s %4d entries: %12.1f us, %5u ATU operations, %4u RMU frames\n",
+           channel == MSD_INTERFACE_RMU ? "RMU" : "SMI", *count, us, (unsigned)cost->atuOps,
+           (unsigned)cost->rmuFrames);
+    return us;
+}
+
+int main(void)
+{
+    MSD_SIM_STATS smiCost, rmuCost;
+    int smiCount = 0, rmuCount = 0;
+
+    if (hostOpen() != 0)
+        return 1;
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    benchFill();
+    double smiUs = benchDump(MSD_INTERFACE_SMI, s_smiList, &smiCount, &smiCost);
+    double rmuUs = benchDump(MSD_INTERFACE_RMU, s_rmuList, &rmuCount, &rmuCost);
+    printf("RMU dump is %.1f times faster\n", rmuUs > 0.0 ? smiUs / rmuUs : 0.0);
+
+    HOST_CHECK(smiCount == MSD_SIM_ATU_SIZE);
+    HOST_CHECK(rmuCount == smiCount);
+    HOST_CHECK(memcmp(s_smiList, s_rmuList, sizeof(s_smiList)) == 0);
+    /* one GetNext per entry and one more per FID that finds no further entry */
+    HOST_CHECK(smiCost.atuOps == MSD_SIM_ATU_SIZE + BENCH_FIDS);
+    HOST_CHECK(rmuCost.atuOps == 0);
+    HOST_CHECK(rmuCost.rmuFrames <= (MSD_SIM_ATU_SIZE + MSD_RMU_MAX_ATUS - 1) / MSD_RMU_MAX_ATUS + 1);
+    HOST_CHECK(rmuUs < smiUs);
+
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, MSD_INTERFACE_SMI));
+    hostClose();
+    return hostResult("atuDumpBench");
+}
@@ -0,0 +1,152 @@
+/*
+ * atuFlushTest.c - before/after check of the static entry flush.
+ * Every FID is read from the switch before and after
+ * deviceAtuModuleFlushStaticEntries: all static entries must be gone, every
+ * dynamic entry must survive (including one written straight to the switch
+ * as if it had been learned), and the reported operation counts must match
+ * the ATU operations the simulator saw.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+#include <deviceVlanModule.h>
+
+#define FLUSH_FIDS      4
+
+typedef struct {
+    MSD_U32 staticCount;
+    MSD_U32 dynamicCount;
+} FlushFidCount;
+
+static MSD_U16 flushFid(MSD_U32 index)
+{
+    return (MSD_U16)(PORT_DEFAULT_VID + index);
+}
+
+static MSD_U32 flushAtuOps(void)
+{
+    MSD_SIM_STATS stats;
+    msdSimStatsGet(&stats);
+    return stats.atuOps;
+}
+
+static void flushCount(FlushFidCount counts[FLUSH_FIDS])
+{
+    memset(counts, 0, sizeof(FlushFidCount) * FLUSH_FIDS);
+    for (MSD_U32 f = 0; f < FLUSH_FIDS; ++f) {
+        MSD_ATU_ENTRY entry;
+        memset(&entry, 0, sizeof(entry));
+        memset(entry.macAddr.arEther, 0xff, sizeof(entry.macAddr.arEther));
+        while (msdFdbEntryNextGet(HOST_DEV, &entry.macAddr, flushFid(f), &entry) == MSD_OK) {
+            if (entry.entryState == 0xF)
+                counts[f].staticCount++;
+            else
+                counts[f].dynamicCount++;
+            if (MSD_IS_BROADCAST_MAC(entry.macAddr))
+                break;
+        }
+    }
+}
+
+static void flushAdd(MSD_U32 index, MSD_U32 fidIndex, MSD_BOOL isStatic)
+{
+    MSD_ATU_ENTRY entry;
+    memset(&entry, 0, sizeof(entry));
+    hostMac(&entry.macAddr, index);
+    entry.fid = flushFid(fidIndex);
+    entry.portVec = 1U << (1 + index % 8);
+    entry.entryState = isStatic ? 0xF : 0x7;
+    HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+
+    /*
+     * fid 0: 12 static entries only, large enough to read the non-static count
+     * fid 1: 10 dynamic entries only, skipped from the counts
+     * fid 2: 12 static and 4 dynamic entries
+     * fid 3: 3 static and 2 dynamic entries, small enough to walk directly
+     * Dynamic entries go first, the module refuses adds once 64 are static.
+     */
+    MSD_U32 index = 0;
+    for (MSD_U32 i = 0; i < 10; ++i)
+        flushAdd(index++, 1, MSD_FALSE);
+    for (MSD_U32 i = 0; i < 4; ++i)
+        flushAdd(index++, 2, MSD_FALSE);
+    for (MSD_U32 i = 0; i < 2; ++i)
+        flushAdd(index++, 3, MSD_FALSE);
+    for (MSD_U32 i = 0; i < 12; ++i)
+        flushAdd(index++, 0, MSD_TRUE);
+    for (MSD_U32 i = 0; i < 12; ++i)
+        flushAdd(index++, 2, MSD_TRUE);
+    for (MSD_U32 i = 0; i < 3; ++i)
+        flushAdd(index++, 3, MSD_TRUE);
+
+    /* a dynamic entry the module does not know about, as if learned after the shadow was built */
+    MSD_ATU_ENTRY learned;
+    memset(&learned, 0, sizeof(learned));
+    hostMac(&learned.macAddr, index++);
+    learned.fid = flushFid(0);
+    learned.portVec = 1U << 3;
+    learned.entryState = 0x7;
+    HOST_CHECK_OK(msdFdbMacEntryAdd(HOST_DEV, &learned));
+
+    /* cost of one count read, in ATU operations */
+    MSD_U32 count = 0;
+    MSD_U32 before = flushAtuOps();
+    HOST_CHECK_OK(msdFdbEntryCountPerFidGet(HOST_DEV, flushFid(0), &count));
+    MSD_U32 countReadOps = flushAtuOps() - before;
+
+    FlushFidCount countsBefore[FLUSH_FIDS];
+    FlushFidCount countsAfter[FLUSH_FIDS];
+    flushCount(countsBefore);
+    HOST_CHECK(countsBefore[0].staticCount == 12 && countsBefore[0].dynamicCount == 1);
+    HOST_CHECK(countsBefore[1].staticCount == 0 && countsBefore[1].dynamicCount == 10);
+
+    MSD_U32 staticBefore = 0;
+    for (MSD_U32 f = 0; f < FLUSH_FIDS; ++f)
+        staticBefore += countsBefore[f].staticCount;
+
+    AtuFlushStats stats;
+    before = flushAtuOps();
+    HOST_CHECK_OK(deviceAtuModuleFlushStaticEntries(HOST_DEV, ALL_FID_VALUE, &stats));
+    MSD_U32 flushOps = flushAtuOps() - before;
+    flushCount(countsAfter);
+
+    for (MSD_U32 f = 0; f < FLUSH_FIDS; ++f) {
+        if (countsAfter[f].staticCount != 0 || countsAfter[f].dynamicCount != countsBefore[f].dynamicCount)
+            printf("fid %u: %u/%u static/dynamic before, %u/%u after\n", (unsigned)flushFid(f),
+                   (unsigned)countsBefore[f].staticCount, (unsigned)countsBefore[f].dynamicCount,
+                   (unsigned)countsAfter[f].staticCount, (unsigned)countsAfter[f].dynamicCount);
+        HOST_CHECK(countsAfter[f].staticCount == 0);
+        HOST_CHECK(countsAfter[f].dynamicCount == countsBefore[f].dynamicCount);
+    }
+    /* the device also has the FIDs set up by initOpenDevice, none of them holds a static entry */
+    HOST_CHECK(stats.fidCount >= FLUSH_FIDS);
+    HOST_CHECK(stats.walkedFids == 3);
+    HOST_CHECK(stats.skippedFids == stats.fidCount - stats.walkedFids);
+    HOST_CHECK(stats.deletedEntries == staticBefore);
+    HOST_CHECK(stats.deleteOps == staticBefore);
+    HOST_CHECK(flushOps == stats.countReads * countReadOps + stats.getNextOps + stats.deleteOps);
+
+    AtuFlushStats last;
+    HOST_CHECK_OK(deviceAtuModuleGetLastFlushStats(HOST_DEV, &last));
+    HOST_CHECK(memcmp(&last, &stats, sizeof(stats)) == 0);
+
+    printf("flush of %u static entries in %u fids: %u count reads (%u ops each), %u getnext, %u delete, %u ATU ops\n",
+           (unsigned)staticBefore, (unsigned)stats.fidCount, (unsigned)stats.countReads, (unsigned)countReadOps,
+           (unsigned)stats.getNextOps, (unsigned)stats.deleteOps, (unsigned)flushOps);
+
+    /* the flush command path reports through deviceAtuModuleGetLastFlushStats */
+    flushAdd(index++, 0, MSD_TRUE);
+    HOST_CHECK_OK(deviceAtuModuleFlushEntries(HOST_DEV, MSD_FLUSH_ALL_STATIC));
+    HOST_CHECK_OK(deviceAtuModuleGetLastFlushStats(HOST_DEV, &last));
+    HOST_CHECK(last.deletedEntries == 1);
+    flushCount(countsAfter);
+    HOST_CHECK(countsAfter[0].staticCount == 0 && countsAfter[0].dynamicCount == 1);
+
+    hostClose();
+    return hostResult("atuFlushTest");
+}
@@ -0,0 +1,140 @@
+/*
+ * atuIndexBench.c - the shadow ATU index at full occupancy: 64 static and
+ * 4032 dynamic entries. Times (MAC, VID) lookups in host time, since they do
+ * not touch the bus, and checks the index after a refresh with no changes and
+ * after half of the dynamic entries aged out of the switch.
+ */
+#include <time.h>
+#include "hostTest.h"
+#include <deviceMacModule.h>
+
+#define BENCH_STATIC_COUNT  MAX_STATIC_ATU_ENTRIES
+#define BENCH_AUTO_COUNT    (MAX_AUTO_ATU_ENTRIES - MAX_STATIC_ATU_ENTRIES)
+#define BENCH_AUTO_VIDS     256
+#define BENCH_ROUNDS        200
+
+static double hostNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static MSD_U16 benchVid(MSD_U32 index, MSD_BOOL isStatic)
+{
+    return isStatic ? (MSD_U16)(2 + index) : (MSD_U16)(2 + index % BENCH_AUTO_VIDS);
+}
+
+/* static entries use MACs from 0x10000, dynamic ones from 0 */
+static MSD_U32 benchMacIndex(MSD_U32 index, MSD_BOOL isStatic)
+{
+    return isStatic ? 0x10000U + index : index;
+}
+
+static void benchFill(void)
+{
+    MSD_ATU_ENTRY entry;
+    MSD_U32 i;
+    /* dynamic entries first, deviceAtuModuleAddEntry refuses every add once the static part is full */
+    for (i = 0; i < BENCH_AUTO_COUNT + BENCH_STATIC_COUNT; ++i) {
+        MSD_BOOL isStatic = i >= BENCH_AUTO_COUNT ? MSD_TRUE : MSD_FALSE;
+        MSD_U32 index = isStatic ? i - BENCH_AUTO_COUNT : i;
+        memset(&entry, 0, sizeof(entry));
+        hostMac(&entry.macAddr, benchMacIndex(index, isStatic));
+        entry.fid = benchVid(index, isStatic);
+        entry.portVec = 1U << (1 + index % 8);
+        entry.entryState = isStatic ? 0xF : 0x7;
+        HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+    }
+}
+
+static MSD_U32 benchCountFound(MSD_U32 count, MSD_BOOL isStatic, MSD_U32 macOffset)
+{
+    MSD_ETHERADDR mac;
+    MSD_U32 generation;
+    MSD_U32 found = 0;
+    MSD_U32 i;
+    for (i = 0; i < count; ++i) {
+        hostMac(&mac, benchMacIndex(i, isStatic) + macOffset);
+        if (deviceAtuModuleGetEntryGeneration(HOST_DEV, mac, benchVid(i, isStatic), isStatic, &generation) == MSD_OK)
+            found++;
+    }
+    return found;
+}
+
+static void benchLookup(void)
+{
+    MSD_U32 hits = 0, misses = 0;
+    int round;
+    double start = hostNowNs();
+    for (round = 0; round < BENCH_ROUNDS; ++round) {
+        hits += benchCountFound(BENCH_AUTO_COUNT, MSD_FALSE, 0);
+        hits += benchCountFound(BENCH_STATIC_COUNT, MSD_TRUE, 0);
+    }
+    double hitNs = (hostNowNs() - start) / ((double)BENCH_ROUNDS * (BENCH_AUTO_COUNT + BENCH_STATIC_COUNT));
+    start = hostNowNs();
+    for (round = 0; round < BENCH_ROUNDS; ++round)
+        misses += BENCH_AUTO_COUNT - benchCountFound(BENCH_AUTO_COUNT, MSD_FALSE, 0x100000U);
+    double missNs = (hostNowNs() - start) / ((double)BENCH_ROUNDS * BENCH_AUTO_COUNT);
+
+    printf("lookup hit  %8.1f ns\n", hitNs);
+    printf("lookup miss %8.1f ns\n", missNs);
+    HOST_CHECK(hits == (MSD_U32)BENCH_ROUNDS * (BENCH_AUTO_COUNT + BENCH_STATIC_COUNT));
+    HOST_CHECK(misses == (MSD_U32)BENCH_ROUNDS * BENCH_AUTO_COUNT);
+}
+
+static void benchCheckCounts(MSD_U32 staticCount, MSD_U32 autoCount)
+{
+    static MacEntry entries[MAX_AUTO_ATU_ENTRIES];
+    MSD_U32 count = 0;
+    HOST_CHECK_OK(deviceAtuModuleGetAllVidAutoEntriesFromConfiguration(HOST_DEV, entries, MAX_AUTO_ATU_ENTRIES, &count));
+    HOST_CHECK(count == autoCount);
+    HOST_CHECK(benchCountFound(BENCH_STATIC_COUNT, MSD_TRUE, 0) == staticCount);
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+}
+
+static void benchRefresh(void)
+{
+    MSD_U32 before = 0, after = 0;
+    MSD_ETHERADDR mac;
+    MSD_U32 i;
+
+    HOST_CHECK_OK(deviceAtuModuleGetGeneration(HOST_DEV, &before));
+    double start = hostNowNs();
+    hostClockReset();
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    printf("refresh, no change  %8.1f us host %10.1f us bus\n", (hostNowNs() - start) / 1000.0, hostClockUs());
+    HOST_CHECK_OK(deviceAtuModuleGetGeneration(HOST_DEV, &after));
+    HOST_CHECK(after == before);
+    benchCheckCounts(BENCH_STATIC_COUNT, BENCH_AUTO_COUNT);
+
+    /* age out every other dynamic entry behind the module's back */
+    for (i = 0; i < BENCH_AUTO_COUNT; i += 2) {
+        hostMac(&mac, benchMacIndex(i, MSD_FALSE));
+        HOST_CHECK_OK(msdFdbMacEntryDelete(HOST_DEV, &mac, benchVid(i, MSD_FALSE)));
+    }
+    start = hostNowNs();
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    printf("refresh, half aged  %8.1f us host\n", (hostNowNs() - start) / 1000.0);
+    HOST_CHECK_OK(deviceAtuModuleGetGeneration(HOST_DEV, &after));
+    HOST_CHECK(after == before + BENCH_AUTO_COUNT / 2);
+    benchCheckCounts(BENCH_STATIC_COUNT, BENCH_AUTO_COUNT / 2);
+    for (i = 0; i < BENCH_AUTO_COUNT; ++i) {
+        MSD_U32 generation;
+        hostMac(&mac, benchMacIndex(i, MSD_FALSE));
+        HOST_CHECK((deviceAtuModuleGetEntryGeneration(HOST_DEV, mac, benchVid(i, MSD_FALSE), MSD_FALSE, &generation) == MSD_OK) ==
+                   (i % 2 == 1));
+    }
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    benchFill();
+    benchCheckCounts(BENCH_STATIC_COUNT, BENCH_AUTO_COUNT);
+    benchLookup();
+    benchRefresh();
+    hostClose();
+    return hostResult("atuIndexBench");
+}
@@ -0,0 +1,219 @@
+/*
+ * atuIteratorTest.c - the ATU cursor iterator behind /api/mac_table.
+ * The table is read in small batches while entries are added and deleted
+ * between the batches, and checked against a model: entries are returned
+ * in FID then MAC order without duplicates, every entry that stays in the
+ * table is returned once, and an entry added ahead of the cursor is still
+ * returned, also when the entry under the cursor itself was deleted. The VID,
+ * port and entry type filters are checked on a fixed table.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+#include <deviceVlanModule.h>
+
+#define ITER_FIDS       3
+#define ITER_MACS       120     /* MAC indexes per FID */
+#define ITER_SEED_MACS  80      /* entries per FID at the start */
+#define ITER_STATICS    4       /* the first MACs of each FID are static */
+#define ITER_BATCH      7
+
+typedef struct {
+    MSD_BOOL present;
+    MSD_BOOL mustReturn;        /* in the table from a point ahead of the cursor until the end */
+    MSD_U32 returned;
+    MSD_U32 portVec;
+} IterModel;
+
+static const MSD_U16 s_fidList[ITER_FIDS] = { PORT_DEFAULT_VID, 100, 300 };
+static IterModel s_model[ITER_FIDS][ITER_MACS];
+static MSD_U32 s_seed = 77;
+
+static MSD_U32 iterRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+static MSD_U32 iterPortVec(MSD_U32 f, MSD_U32 m)
+{
+    return 1U << (1 + (f * 5 + m) % 9);
+}
+
+static void iterEntry(MSD_U32 f, MSD_U32 m, MSD_ATU_ENTRY* entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    hostMac(&entry->macAddr, m);
+    entry->fid = s_fidList[f];
+    entry->portVec = iterPortVec(f, m);
+    entry->entryState = m < ITER_STATICS ? 0xF : 0x7;
+}
+
+static void iterAdd(MSD_U32 f, MSD_U32 m)
+{
+    MSD_ATU_ENTRY entry;
+    iterEntry(f, m, &entry);
+    HOST_CHECK_OK(msdFdbMacEntryAdd(HOST_DEV, &entry));
+    s_model[f][m].present = MSD_TRUE;
+    s_model[f][m].portVec = entry.portVec;
+}
+
+static void iterDelete(MSD_U32 f, MSD_U32 m)
+{
+    MSD_ETHERADDR mac;
+    hostMac(&mac, m);
+    HOST_CHECK_OK(msdFdbMacEntryDelete(HOST_DEV, &mac, s_fidList[f]));
+    s_model[f][m].present = MSD_FALSE;
+    s_model[f][m].mustReturn = MSD_FALSE;
+}
+
+static MSD_BOOL iterFind(const MSD_ATU_ENTRY* entry, MSD_U32* f, MSD_U32* m)
+{
+    for (*f = 0; *f < ITER_FIDS && s_fidList[*f] != entry->fid; ++*f)
+        ;
+    *m = ((MSD_U32)entry->macAddr.arEther[4] << 8) | entry->macAddr.arEther[5];
+    return *f < ITER_FIDS && *m < ITER_MACS ? MSD_TRUE : MSD_FALSE;
+}
+
+static void iterSeed(void)
+{
+    MSD_ATU_ENTRY entry;
+    HOST_CHECK_OK(deviceAtuModuleFlushEntries(HOST_DEV, MSD_FLUSH_ALL));
+    memset(s_model, 0, sizeof(s_model));
+    for (MSD_U32 f = 0; f < ITER_FIDS; ++f) {
+        /* through the module once so the FID is iterated */
+        iterEntry(f, 0, &entry);
+        HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+        s_model[f][0].present = MSD_TRUE;
+        s_model[f][0].portVec = entry.portVec;
+        for (MSD_U32 m = 1; m < ITER_SEED_MACS; ++m)
+            iterAdd(f, m);
+    }
+}
+
+/* adds and deletes between two batches, the cursor is at (curF, curM) */
+static void iterChurn(MSD_U32 curF, MSD_U32 curM)
+{
+    for (int op = 0; op < 6; ++op) {
+        MSD_U32 f = iterRandom(ITER_FIDS);
+        MSD_U32 m = ITER_STATICS + iterRandom(ITER_MACS - ITER_STATICS);
+        if (s_model[f][m].present) {
+            iterDelete(f, m);
+        }
+        else {
+            iterAdd(f, m);
+            if (f > curF || (f == curF && m > curM))
+                s_model[f][m].mustReturn = MSD_TRUE;
+        }
+    }
+}
+
+static void iterChurnRun(void)
+{
+    AtuIterator iterator;
+    MSD_ATU_ENTRY batch[ITER_BATCH];
+    MSD_BOOL isEnd = MSD_FALSE;
+    MSD_U32 lastF = 0, lastM = 0, batches = 0;
+    MSD_BOOL hasLast = MSD_FALSE;
+
+    iterSeed();
+    for (MSD_U32 f = 0; f < ITER_FIDS; ++f) {
+        for (MSD_U32 m = 0; m < ITER_MACS; ++m)
+            s_model[f][m].mustReturn = s_model[f][m].present;
+    }
+    HOST_CHECK_OK(deviceAtuModuleIteratorOpen(HOST_DEV, &iterator, ATU_ENTRY_TYPE_ALL_VALID, ALL_FID_VALUE, ATU_ITERATOR_ALL_PORTS));
+    while (!isEnd) {
+        int count = 0;
+        HOST_CHECK_OK(deviceAtuModuleIteratorNext(&iterator, batch, ITER_BATCH, &count, &isEnd));
+        HOST_CHECK(count == ITER_BATCH || isEnd);
+        for (int i = 0; i < count; ++i) {
+            MSD_U32 f, m;
+            if (!iterFind(&batch[i], &f, &m)) {
+                HOST_CHECK(MSD_FALSE);
+                continue;
+            }
+            /* strictly ascending, so no entry twice */
+            HOST_CHECK(!hasLast || f > lastF || (f == lastF && m > lastM));
+            HOST_CHECK(s_model[f][m].present);
+            HOST_CHECK(batch[i].portVec == s_model[f][m].portVec);
+            s_model[f][m].returned++;
+            lastF = f;
+            lastM = m;
+            hasLast = MSD_TRUE;
+        }
+        batches++;
+        if (isEnd)
+            break;
+        /* every third batch the next one resumes from a MAC that is gone */
+        if (batches % 3 == 0 && lastM >= ITER_STATICS)
+            iterDelete(lastF, lastM);
+        iterChurn(lastF, lastM);
+    }
+    MSD_U32 total = 0;
+    for (MSD_U32 f = 0; f < ITER_FIDS; ++f) {
+        for (MSD_U32 m = 0; m < ITER_MACS; ++m) {
+            HOST_CHECK(s_model[f][m].returned <= 1);
+            if (s_model[f][m].mustReturn && s_model[f][m].returned != 1)
+                printf("fid %u mac %u was in the table ahead of the cursor but not returned\n",
+                       (unsigned)s_fidList[f], (unsigned)m);
+            HOST_CHECK(!s_model[f][m].mustReturn || s_model[f][m].returned == 1);
+            total += s_model[f][m].returned;
+        }
+    }
+    printf("churn: %u entries in %u batches of %d\n", (unsigned)total, (unsigned)batches, ITER_BATCH);
+}
+
+/* read the whole table through a filtered iterator and compare with the model */
+static void iterFilterRun(AtuEntryType entryType, int vid, MSD_U32 portVec)
+{
+    AtuIterator iterator;
+    MSD_ATU_ENTRY batch[ITER_BATCH];
+    MSD_BOOL isEnd = MSD_FALSE;
+    MSD_U32 returned = 0, expected = 0;
+
+    HOST_CHECK_OK(deviceAtuModuleIteratorOpen(HOST_DEV, &iterator, entryType, vid, portVec));
+    while (!isEnd) {
+        int count = 0;
+        HOST_CHECK_OK(deviceAtuModuleIteratorNext(&iterator, batch, ITER_BATCH, &count, &isEnd));
+        for (int i = 0; i < count; ++i) {
+            MSD_U32 f, m;
+            HOST_CHECK(iterFind(&batch[i], &f, &m));
+            HOST_CHECK(vid == ALL_FID_VALUE || batch[i].fid == vid);
+            HOST_CHECK(portVec == ATU_ITERATOR_ALL_PORTS || (batch[i].portVec & portVec) != 0);
+            HOST_CHECK(entryType != ATU_ENTRY_TYPE_STATIC || m < ITER_STATICS);
+            returned++;
+        }
+    }
+    for (MSD_U32 f = 0; f < ITER_FIDS; ++f) {
+        for (MSD_U32 m = 0; m < ITER_MACS; ++m) {
+            if (s_model[f][m].present && (vid == ALL_FID_VALUE || s_fidList[f] == vid) &&
+                (portVec == ATU_ITERATOR_ALL_PORTS || (s_model[f][m].portVec & portVec) != 0) &&
+                (entryType != ATU_ENTRY_TYPE_STATIC || m < ITER_STATICS))
+                expected++;
+        }
+    }
+    HOST_CHECK(returned == expected);
+
+    /* a closed iterator returns nothing */
+    int count = 0;
+    deviceAtuModuleIteratorClose(&iterator);
+    HOST_CHECK_OK(deviceAtuModuleIteratorNext(&iterator, batch, ITER_BATCH, &count, &isEnd));
+    HOST_CHECK(count == 0 && isEnd == MSD_TRUE);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    for (int run = 0; run < 4; ++run)
+        iterChurnRun();
+
+    iterSeed();
+    iterFilterRun(ATU_ENTRY_TYPE_ALL_VALID, ALL_FID_VALUE, ATU_ITERATOR_ALL_PORTS);
+    iterFilterRun(ATU_ENTRY_TYPE_ALL_VALID, s_fidList[1], ATU_ITERATOR_ALL_PORTS);
+    iterFilterRun(ATU_ENTRY_TYPE_ALL_VALID, ALL_FID_VALUE, (1U << 2) | (1U << 7));
+    iterFilterRun(ATU_ENTRY_TYPE_ALL_VALID, s_fidList[2], 1U << 3);
+    iterFilterRun(ATU_ENTRY_TYPE_STATIC, ALL_FID_VALUE, ATU_ITERATOR_ALL_PORTS);
+
+    hostClose();
+    return hostResult("atuIteratorTest");
+}
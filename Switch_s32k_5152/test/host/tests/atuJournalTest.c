@@ -0,0 +1,194 @@
+/*
+ * atuJournalTest.c - replays a random add/move/delete/age-out churn against
+ * the shadow ATU and keeps a mirror up to date only through
+ * deviceAtuModuleGetChangesSince. After every batch the mirror must equal
+ * the shadow, entry by entry and generation by generation. Ends with a
+ * journal overrun, which must ask for a resync.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+#include <deviceVlanModule.h>
+
+#define CHURN_AUTO_MACS     96
+#define CHURN_STATIC_MACS   16
+#define CHURN_VIDS          4
+#define CHURN_BATCHES       60
+#define CHURN_BATCH_OPS     12
+#define CHURN_JOURNAL_SIZE  256     /* ATU_CHANGE_JOURNAL_SIZE in deviceMacModule.c */
+
+/* static entries use MACs from 0x10000 so they never replace a dynamic one */
+#define CHURN_STATIC_BASE   0x10000U
+
+typedef struct {
+    MSD_U32 portVec;        /* 0 - no entry */
+    MSD_U32 generation;
+} MirrorEntry;
+
+static MirrorEntry s_mirror[2][CHURN_AUTO_MACS][CHURN_VIDS];
+static MSD_U32 s_synced;
+static MSD_U32 s_seed = 12345;
+
+static MSD_U32 churnRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+static MSD_U16 churnVid(MSD_U32 vidIndex)
+{
+    return (MSD_U16)(PORT_DEFAULT_VID + vidIndex);
+}
+
+static MSD_U32 churnMacIndex(MSD_BOOL isStatic, MSD_U32 index)
+{
+    return isStatic ? CHURN_STATIC_BASE + index : index;
+}
+
+static MirrorEntry* mirrorFind(const MacEntry* entry, MSD_BOOL isStatic)
+{
+    MSD_U32 index = ((MSD_U32)entry->address.arEther[4] << 8) | entry->address.arEther[5];
+    MSD_U32 vidIndex = (MSD_U32)(entry->vid - PORT_DEFAULT_VID);
+    if (index >= CHURN_AUTO_MACS || vidIndex >= CHURN_VIDS)
+        return NULL;
+    return &s_mirror[isStatic ? 1 : 0][index][vidIndex];
+}
+
+/* pull every change since the last sync into the mirror */
+static void mirrorSync(void)
+{
+    AtuChange changes[32];
+    int count = 0;
+    MSD_BOOL needResync = MSD_FALSE;
+    do {
+        HOST_CHECK_OK(deviceAtuModuleGetChangesSince(HOST_DEV, s_synced, changes, 32, &count, &s_synced, &needResync));
+        HOST_CHECK(!needResync);
+        for (int i = 0; i < count; ++i) {
+            MSD_BOOL isStatic = IS_BIT_SET(changes[i].entry.ageAndFlag, 0) ? MSD_TRUE : MSD_FALSE;
+            MirrorEntry* mirror = mirrorFind(&changes[i].entry, isStatic);
+            HOST_CHECK(mirror != NULL);
+            if (mirror == NULL)
+                continue;
+            if (changes[i].changeType == ATU_CHANGE_ADD || changes[i].changeType == ATU_CHANGE_MOVE) {
+                HOST_CHECK((mirror->portVec == 0) == (changes[i].changeType == ATU_CHANGE_ADD));
+                mirror->portVec = changes[i].entry.portVec;
+            }
+            else {
+                HOST_CHECK(mirror->portVec != 0);
+                mirror->portVec = 0;
+            }
+            mirror->generation = changes[i].generation;
+        }
+    } while (count == 32);
+}
+
+static void mirrorCompare(void)
+{
+    static MacEntry entries[MAX_AUTO_ATU_ENTRIES];
+    MSD_U32 count = 0, expected = 0;
+    MSD_ETHERADDR mac;
+    MSD_U32 generation, current;
+
+    HOST_CHECK_OK(deviceAtuModuleGetGeneration(HOST_DEV, &current));
+    HOST_CHECK_OK(deviceAtuModuleGetAllVidAutoEntriesFromConfiguration(HOST_DEV, entries, MAX_AUTO_ATU_ENTRIES, &count));
+    for (MSD_U32 i = 0; i < count; ++i) {
+        MirrorEntry* mirror = mirrorFind(&entries[i], MSD_FALSE);
+        HOST_CHECK(mirror != NULL && mirror->portVec == entries[i].portVec);
+    }
+    for (MSD_U32 index = 0; index < CHURN_AUTO_MACS; ++index) {
+        for (MSD_U32 v = 0; v < CHURN_VIDS; ++v) {
+            for (int isStatic = 0; isStatic < 2; ++isStatic) {
+                const MirrorEntry* mirror = &s_mirror[isStatic][index][v];
+                if (isStatic && index >= CHURN_STATIC_MACS)
+                    continue;
+                hostMac(&mac, churnMacIndex((MSD_BOOL)isStatic, index));
+                MSD_STATUS ret = deviceAtuModuleGetEntryGeneration(HOST_DEV, mac, churnVid(v), (MSD_BOOL)isStatic, &generation);
+                HOST_CHECK((ret == MSD_OK) == (mirror->portVec != 0));
+                /* exact while the last change is still journaled, an upper bound after that */
+                if (ret == MSD_OK && current - mirror->generation < CHURN_JOURNAL_SIZE)
+                    HOST_CHECK(generation == mirror->generation);
+                else if (ret == MSD_OK)
+                    HOST_CHECK(generation >= mirror->generation);
+                if (!isStatic && mirror->portVec != 0)
+                    expected++;
+            }
+        }
+    }
+    HOST_CHECK(count == expected);
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+}
+
+static void churnAdd(MSD_BOOL isStatic, MSD_U32 index, MSD_U32 vidIndex, MSD_U32 portVec)
+{
+    MSD_ATU_ENTRY entry;
+    memset(&entry, 0, sizeof(entry));
+    hostMac(&entry.macAddr, churnMacIndex(isStatic, index));
+    entry.fid = churnVid(vidIndex);
+    entry.portVec = portVec;
+    entry.entryState = isStatic ? 0xF : 0x7;
+    HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+}
+
+static void churnOne(void)
+{
+    MSD_ETHERADDR mac;
+    MSD_U32 op = churnRandom(10);
+    MSD_BOOL isStatic = churnRandom(4) == 0 ? MSD_TRUE : MSD_FALSE;
+    MSD_U32 index = churnRandom(isStatic ? CHURN_STATIC_MACS : CHURN_AUTO_MACS);
+    MSD_U32 vidIndex = churnRandom(CHURN_VIDS);
+    hostMac(&mac, churnMacIndex(isStatic, index));
+
+    if (op < 5) {           /* add, or move when it exists */
+        churnAdd(isStatic, index, vidIndex, 1U << (1 + churnRandom(8)));
+    }
+    else if (op < 8) {      /* delete in every VID */
+        HOST_CHECK_OK(deviceAtuModuleDeleteEntry(HOST_DEV, mac));
+    }
+    else {                  /* age out behind the module's back, seen at the next refresh */
+        (void)msdFdbMacEntryDelete(HOST_DEV, &mac, churnVid(vidIndex));
+        if (isStatic)
+            HOST_CHECK_OK(deviceAtuModuleRefreshAllVidStaticEntriesToConfiguration(HOST_DEV));
+        else
+            HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    }
+}
+
+static void churnOverrun(void)
+{
+    AtuChange changes[4];
+    int count = 0;
+    MSD_U32 last = 0;
+    MSD_BOOL needResync = MSD_FALSE;
+    MSD_U32 generation = 0;
+    MSD_ETHERADDR mac;
+
+    mirrorSync();
+    for (MSD_U32 i = 0; i < CHURN_AUTO_MACS; ++i) {
+        hostMac(&mac, i);
+        HOST_CHECK_OK(deviceAtuModuleDeleteEntry(HOST_DEV, mac));
+    }
+    for (MSD_U32 round = 0; round < 2; ++round) {
+        for (MSD_U32 i = 0; i < CHURN_AUTO_MACS; ++i)
+            churnAdd(MSD_FALSE, i, 0, 1U << (1 + round));
+    }
+    HOST_CHECK_OK(deviceAtuModuleGetGeneration(HOST_DEV, &generation));
+    HOST_CHECK(generation - s_synced > 256);
+    HOST_CHECK_OK(deviceAtuModuleGetChangesSince(HOST_DEV, s_synced, changes, 4, &count, &last, &needResync));
+    HOST_CHECK(needResync && count == 0 && last == generation);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    HOST_CHECK_OK(deviceAtuModuleGetGeneration(HOST_DEV, &s_synced));
+    for (int batch = 0; batch < CHURN_BATCHES; ++batch) {
+        for (int op = 0; op < CHURN_BATCH_OPS; ++op)
+            churnOne();
+        mirrorSync();
+        mirrorCompare();
+    }
+    printf("replayed %d operations, generation %u\n", CHURN_BATCHES * CHURN_BATCH_OPS, (unsigned)s_synced);
+    churnOverrun();
+    hostClose();
+    return hostResult("atuJournalTest");
+}
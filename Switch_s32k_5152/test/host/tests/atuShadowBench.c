@@ -0,0 +1,72 @@
+/*
+ * atuShadowBench.c - latency of the ATU module calls that depend on the
+ * shadow mode, built once with the full shadow and once with
+ * ATU_SHADOW_STATIC_ONLY. The RAM each mode uses is measured by
+ * atuShadowMemory.cmake.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+
+#ifdef ATU_SHADOW_STATIC_ONLY
+#define BENCH_MODE  "static only"
+#else
+#define BENCH_MODE  "full"
+#endif
+
+#define BENCH_STATIC_COUNT  32
+#define BENCH_AUTO_COUNT    1024
+
+static MacEntry s_entries[MAX_AUTO_ATU_ENTRIES];
+
+static void benchTime(const char* name, int calls)
+{
+    printf("%-12s %-30s %6d calls %12.1f us bus\n", BENCH_MODE, name, calls, hostClockUs());
+}
+
+int main(void)
+{
+    MSD_ATU_ENTRY entry;
+    MSD_U32 count = 0;
+    MSD_U32 generation = 0;
+    MSD_U32 i;
+
+    if (hostOpen() != 0)
+        return 1;
+
+    hostClockReset();
+    for (i = 0; i < BENCH_AUTO_COUNT + BENCH_STATIC_COUNT; ++i) {
+        MSD_BOOL isStatic = i >= BENCH_AUTO_COUNT ? MSD_TRUE : MSD_FALSE;
+        memset(&entry, 0, sizeof(entry));
+        hostMac(&entry.macAddr, i);
+        entry.fid = (MSD_U16)(2 + i % 16);
+        entry.portVec = 1U << (1 + i % 8);
+        entry.entryState = isStatic ? 0xF : 0x7;
+        HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+    }
+    benchTime("add", BENCH_AUTO_COUNT + BENCH_STATIC_COUNT);
+
+    hostClockReset();
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    benchTime("refresh dynamic", 1);
+
+    hostClockReset();
+    HOST_CHECK_OK(deviceAtuModuleGetAllVidAutoEntriesFromConfiguration(HOST_DEV, s_entries, MAX_AUTO_ATU_ENTRIES, &count));
+    benchTime("get all dynamic", 1);
+    HOST_CHECK(count == BENCH_AUTO_COUNT);
+
+    hostClockReset();
+    HOST_CHECK_OK(deviceAtuModuleGetAllVidStaticEntriesFromConfiguration(HOST_DEV, s_entries, MAX_STATIC_ATU_ENTRIES, &count));
+    benchTime("get all static", 1);
+
+    hostClockReset();
+    for (i = BENCH_AUTO_COUNT; i < BENCH_AUTO_COUNT + BENCH_STATIC_COUNT; ++i) {
+        hostMac(&entry.macAddr, i);
+        HOST_CHECK_OK(deviceAtuModuleGetEntryGeneration(HOST_DEV, entry.macAddr, (MSD_U16)(2 + i % 16), MSD_TRUE, &generation));
+    }
+    benchTime("static lookup", BENCH_STATIC_COUNT);
+    HOST_CHECK(hostClockUs() == 0.0);
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+
+    hostClose();
+    return hostResult("atuShadowBench " BENCH_MODE);
+}
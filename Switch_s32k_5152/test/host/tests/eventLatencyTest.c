@@ -0,0 +1,174 @@
+/*
+ * eventLatencyTest.c - latency of the event task from a switch interrupt to
+ * its handler, run on the cooperative host scheduler. A test handler is
+ * installed for the StatsDone bit of the Global Status register and the bit
+ * is raised by hand. With the INTn notification (initNotifyEventFromISR) the
+ * handler runs in the same tick, without it the fallback poll picks it up
+ * within EVENT_POLL_FALLBACK_MS. A source the handler cannot clear must not
+ * keep the task busy, and initCloseDevice deletes the task.
+ */
+#include "hostTest.h"
+#include <Fir_msdDrvSwRegs.h>
+
+#define EVENT_CAUSE         MSD_STATS_DONE
+#define EVENT_FALLBACK_MS   1000        /* EVENT_POLL_FALLBACK_MS of apiInit.c */
+#define EVENT_ROUNDS        (8 * (4 + 1))   /* EVENT_MAX_DRAIN_COUNT rounds for the wake up and each of EVENT_MAX_SELF_NOTIFY */
+#define EVENT_SAMPLES       16
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_BOOL s_clearSource = MSD_TRUE;
+static int s_calls = 0;
+static TickType_t s_handledTick;
+static MSD_U64 s_handledClock;
+static TickType_t s_watchTicks = 0;
+static MSD_U32 s_seed = 5;
+
+static MSD_U32 eventRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+static MSD_U64 eventClock(void)
+{
+    MSD_SIM_STATS stats;
+    msdSimStatsGet(&stats);
+    return stats.clock;
+}
+
+static MSD_STATUS eventHandler(MSD_U8 devNum)
+{
+    MSD_U16 status = 0;
+    s_calls++;
+    s_handledTick = xTaskGetTickCount();
+    s_handledClock = eventClock();
+    if (!s_clearSource)
+        return MSD_OK;
+    MSD_STATUS ret = msdGetAnyReg(devNum, FIR_GLOBAL1_DEV_ADDR, FIR_GLOBAL_STATUS, &status);
+    if (ret == MSD_OK)
+        ret = msdSetAnyReg(devNum, FIR_GLOBAL1_DEV_ADDR, FIR_GLOBAL_STATUS, (MSD_U16)(status & ~EVENT_CAUSE));
+    return ret;
+}
+
+static void eventRaise(void)
+{
+    MSD_U16 status = 0;
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_GLOBAL_STATUS, &status));
+    HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_GLOBAL_STATUS, (MSD_U16)(status | EVENT_CAUSE)));
+}
+
+static void eventClear(void)
+{
+    HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_GLOBAL_STATUS, 0));
+}
+
+/* raise the cause at a random point of the poll period and wait for the handler, returns the latency in ticks */
+static TickType_t eventOne(MSD_BOOL notify, double* busUs)
+{
+    hostTaskRun(eventRandom(EVENT_FALLBACK_MS));
+    int calls = s_calls;
+    eventRaise();
+    TickType_t start = xTaskGetTickCount();
+    MSD_U64 clock = eventClock();
+    if (notify) {
+        BaseType_t woken = pdFALSE;
+        initNotifyEventFromISR(HOST_DEV, &woken);
+    }
+    while (s_calls == calls && xTaskGetTickCount() - start <= EVENT_FALLBACK_MS)
+        hostTaskRun(1);
+    HOST_CHECK(s_calls == calls + 1);
+    *busUs = (double)(s_handledClock - clock) / 1000.0;
+    return s_handledTick - start;
+}
+
+static void eventLatency(MSD_BOOL notify)
+{
+    TickType_t maxTicks = 0, sumTicks = 0;
+    double maxUs = 0.0;
+
+    for (int i = 0; i < EVENT_SAMPLES; ++i) {
+        double us = 0.0;
+        TickType_t ticks = eventOne(notify, &us);
+        sumTicks += ticks;
+        if (ticks > maxTicks)
+            maxTicks = ticks;
+        if (us > maxUs)
+            maxUs = us;
+    }
+    printf("%s: handler after %.1f ticks on average, at most %u ticks, %.1f us bus time\n",
+           notify ? "INTn notification" : "fallback poll", (double)sumTicks / EVENT_SAMPLES, (unsigned)maxTicks, maxUs);
+    if (notify)
+        HOST_CHECK(maxTicks == 0);
+    else
+        HOST_CHECK(maxTicks <= EVENT_FALLBACK_MS);
+}
+
+static void eventWatchProc(void* param)
+{
+    (void)param;
+    for (;;) {
+        vTaskDelay(1);
+        s_watchTicks++;
+    }
+}
+
+/* a cause the handler never clears costs a bounded number of rounds per wake up */
+static void eventStuck(void)
+{
+    TaskHandle_t watch = NULL;
+
+    s_clearSource = MSD_FALSE;
+    s_watchTicks = 0;
+    HOST_CHECK(xTaskCreate(eventWatchProc, "watch", 512, NULL, 1, &watch) == pdPASS);
+    hostTaskRun(0);
+    int calls = s_calls;
+    eventRaise();
+    BaseType_t woken = pdFALSE;
+    initNotifyEventFromISR(HOST_DEV, &woken);
+    hostTaskRun(3 * EVENT_FALLBACK_MS);
+    int rounds = s_calls - calls;
+    printf("stuck source: %d handler calls in %d ms, other task ran %u ticks\n", rounds, 3 * EVENT_FALLBACK_MS,
+           (unsigned)s_watchTicks);
+    /* the notified wake up and three fallback polls */
+    HOST_CHECK(rounds >= EVENT_ROUNDS && rounds <= 4 * EVENT_ROUNDS);
+    HOST_CHECK(s_watchTicks >= 3 * EVENT_FALLBACK_MS - 1);
+
+    s_clearSource = MSD_TRUE;
+    eventClear();
+    calls = s_calls;
+    hostTaskRun(2 * EVENT_FALLBACK_MS);
+    HOST_CHECK(s_calls == calls);
+    vTaskDelete(watch);
+}
+
+/* initCloseDevice deletes the event task, a reopened device has one again */
+static void eventClose(void)
+{
+    UBaseType_t tasks = hostTaskCount();
+    hostClose();
+    HOST_CHECK(g_allDevicesConfig[HOST_DEV].eventLoopHandle == NULL);
+    HOST_CHECK(hostTaskCount() == tasks - 1);
+    hostTaskRun(EVENT_FALLBACK_MS);
+    HOST_CHECK(hostOpen() == 0);
+    HOST_CHECK(g_allDevicesConfig[HOST_DEV].eventLoopHandle != NULL);
+    HOST_CHECK(hostTaskCount() == tasks);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    HOST_CHECK_OK(initSetEventHandler(HOST_DEV, EVENT_CAUSE, eventHandler));
+    HOST_CHECK(initSetEventHandler(HOST_DEV, 0x8000, eventHandler) == MSD_BAD_PARAM);
+    hostTaskRun(0);
+
+    eventLatency(MSD_TRUE);
+    eventLatency(MSD_FALSE);
+    eventStuck();
+
+    HOST_CHECK_OK(initSetEventHandler(HOST_DEV, EVENT_CAUSE, NULL));
+    eventClose();
+    hostClose();
+    return hostResult("eventLatencyTest");
+}
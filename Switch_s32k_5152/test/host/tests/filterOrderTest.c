@@ -0,0 +1,259 @@
+/*
+ * filterOrderTest.c - the TCAM priority order of the filters. The TCAM
+ * matches the lowest index first and a lower filter id has the higher
+ * priority, so every slot of a lower id filter must sit before every slot of
+ * a higher id filter. This is checked after every add, modify, remove and
+ * defrag of a random churn, and also between any two register accesses
+ * through the simulator delay hook, so a filter parked in a scratch slot
+ * while the TCAM is reorganized is caught too. A moved IPv6 TCP filter is
+ * read back to check that its cascaded pairs (nextId and pvid) follow the move.
+ */
+#include "hostTest.h"
+#include <deviceFilterModule.h>
+#include <deviceTcamModule.h>
+
+#define ORDER_OPS       400
+
+static MSD_U32 s_seed = 11;
+static MSD_U32 s_nextKey = 0;
+static MSD_BOOL s_hookEnabled = MSD_FALSE;
+static MSD_U32 s_hookChecks = 0;
+static MSD_U32 s_hookViolations = 0;
+
+static MSD_U32 orderRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+/* the filter owned slots in index order must have non decreasing filter ids */
+static MSD_BOOL orderIsSorted(MSD_U32* badSlot)
+{
+    int lastId = -1;
+    for (MSD_U32 i = 0; i < TCAM_MODULE_QINQ_START; ++i) {
+        TcamOwnerType ownerType = TCAM_OWNER_FREE;
+        MSD_U16 ownerId = 0;
+        if (deviceTcamModuleGetOwner(HOST_DEV, i, &ownerType, &ownerId) != MSD_OK || ownerType != TCAM_OWNER_FILTER)
+            continue;
+        if ((int)ownerId < lastId) {
+            *badSlot = i;
+            return MSD_FALSE;
+        }
+        lastId = ownerId;
+    }
+    return MSD_TRUE;
+}
+
+/* called by the simulator on every register access */
+static void orderHook(MSD_U32 nSec)
+{
+    MSD_U32 badSlot;
+    (void)nSec;
+    if (!s_hookEnabled)
+        return;
+    s_hookChecks++;
+    if (!orderIsSorted(&badSlot))
+        s_hookViolations++;
+}
+
+static void orderCheck(int op)
+{
+    MSD_U32 badSlot = 0;
+    MSD_BOOL isSorted = orderIsSorted(&badSlot);
+    if (!isSorted)
+        printf("operation %d: slot %u belongs to a lower id filter than the slot before it\n", op, (unsigned)badSlot);
+    HOST_CHECK(isSorted);
+    if (s_hookViolations != 0)
+        printf("operation %d: out of order between two register accesses\n", op);
+    HOST_CHECK(s_hookViolations == 0);
+    s_hookViolations = 0;
+}
+
+static MSD_STATUS orderAdd(MSD_U8 id, const char* name, FilterType type, MSD_U8 pktType)
+{
+    FilterParam param;
+    MSD_U32 key = s_nextKey++;
+
+    memset(&param, 0, sizeof(param));
+    if (type == FILTER_TYPE_SECOND_LAYER) {
+        hostMac((MSD_ETHERADDR*)param.secondLayerParam.destMacData, key);
+        memset(param.secondLayerParam.destMacMask, 0xFF, sizeof(param.secondLayerParam.destMacMask));
+        param.secondLayerParam.checkEtherFlag = CHECK_ETHER_DEST_MAC_FLAG;
+    }
+    else if (type == FILTER_TYPE_IP_TCP_OR_UDP && pktType == MSD_TCAM_TYPE_IPV4_TCP) {
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.pktType = MSD_TCAM_TYPE_IPV4_TCP;
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.data.ipv4Tcp.tcp.destPort = (MSD_U16)(1000 + key);
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.mask.ipv4Tcp.tcp.destPort = 0xFFFF;
+    }
+    else if (type == FILTER_TYPE_IP_TCP_OR_UDP) {
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.pktType = MSD_TCAM_TYPE_IPV6_TCP;
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.data.ipv6Tcp.tcp.destPort = (MSD_U16)(1000 + key);
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.mask.ipv6Tcp.tcp.destPort = 0xFFFF;
+    }
+    return deviceFilterModuleAddFilter(HOST_DEV, id, name, (MSD_U16)(2U + (key % 0x3FDU)), EGRESS_TYPE_DROP, 0x4, type,
+                                       type == FILTER_TYPE_ALL ? NULL : &param);
+}
+
+static MSD_STATUS orderAddRandom(MSD_U8 id, const char* name)
+{
+    switch (orderRandom(4)) {
+    case 0:
+        return orderAdd(id, name, FILTER_TYPE_SECOND_LAYER, 0);
+    case 1:
+        return orderAdd(id, name, FILTER_TYPE_IP_TCP_OR_UDP, MSD_TCAM_TYPE_IPV4_TCP);
+    case 2:
+        return orderAdd(id, name, FILTER_TYPE_IP_TCP_OR_UDP, MSD_TCAM_TYPE_IPV6_TCP);
+    default:
+        return orderAdd(id, name, FILTER_TYPE_ALL, 0);
+    }
+}
+
+static void orderChurn(void)
+{
+    DeviceFilter filters[FILTER_MAX_NUM];
+    int defrags = 0, moved = 0;
+
+    for (int op = 1; op <= ORDER_OPS; ++op) {
+        int filterCount = 0;
+        MSD_U32 kind = orderRandom(40);
+        MSD_BOOL isFound = MSD_FALSE;
+        MSD_STATUS ret;
+
+        HOST_CHECK_OK(deviceFilterModuleGetAllFilters(HOST_DEV, filters, FILTER_MAX_NUM, &filterCount));
+        if (kind < 24 && (kind < 16 || filterCount == 0)) {
+            char name[FILTER_NUM_NAME_MAX_LEN];
+            snprintf(name, sizeof(name), "order%u", (unsigned)s_nextKey);
+            ret = orderAddRandom(0, name);
+            HOST_CHECK(ret == MSD_OK || (ret == MSD_NO_SPACE && filterCount == FILTER_MAX_NUM));
+        }
+        else if (kind < 24) {
+            DeviceFilter* filter = &filters[orderRandom((MSD_U32)filterCount)];
+            ret = orderAddRandom(filter->filterId, filter->filterName);
+            HOST_CHECK(ret == MSD_OK || ret == MSD_NO_SPACE);
+        }
+        else if (kind < 36) {
+            MSD_U8 id = filterCount > 0 ? filters[orderRandom((MSD_U32)filterCount)].filterId : 1;
+            HOST_CHECK_OK(deviceFilterModuleRemoveFilterById(HOST_DEV, id, &isFound));
+        }
+        else {
+            int moveCount = 0;
+            HOST_CHECK_OK(deviceFilterModuleDefragTcam(HOST_DEV, &moveCount));
+            defrags++;
+            moved += moveCount;
+        }
+        orderCheck(op);
+    }
+    printf("churn: %d operations, %d defrags moved %d entries, %u accesses checked\n", ORDER_OPS, defrags, moved,
+           (unsigned)s_hookChecks);
+}
+
+/* the slots of a filter in index order */
+static int orderFilterSlots(MSD_U8 filterId, MSD_U32* slots)
+{
+    int count = 0;
+    for (MSD_U32 i = 0; i < TCAM_MODULE_QINQ_START; ++i) {
+        TcamOwnerType ownerType = TCAM_OWNER_FREE;
+        MSD_U16 ownerId = 0;
+        HOST_CHECK_OK(deviceTcamModuleGetOwner(HOST_DEV, i, &ownerType, &ownerId));
+        if (ownerType == TCAM_OWNER_FILTER && ownerId == filterId)
+            slots[count++] = i;
+    }
+    return count;
+}
+
+/* every cascaded entry continues to a slot of the same filter, which matches on its own index */
+static void orderCheckCascade(MSD_U8 filterId)
+{
+    MSD_U32 slots[TCAM_MODULE_QINQ_START];
+    int cascades = 0;
+
+    int count = orderFilterSlots(filterId, slots);
+    HOST_CHECK(count == 4);
+    for (int i = 0; i < count; ++i) {
+        MSD_TCAM_DATA data, next;
+        HOST_CHECK_OK(msdTcamEntryRead(HOST_DEV, slots[i], &data));
+        if (data.continu == 0)
+            continue;
+        int j = 0;
+        while (j < count && slots[j] != data.nextId)
+            j++;
+        HOST_CHECK(j < count && j != i);
+        if (j == count)
+            continue;
+        HOST_CHECK_OK(msdTcamEntryRead(HOST_DEV, slots[j], &next));
+        HOST_CHECK(next.pvidMask != 0);
+        HOST_CHECK(((next.pvid ^ slots[j]) & next.pvidMask) == 0);
+        cascades++;
+    }
+    HOST_CHECK(cascades == 2);
+}
+
+static MSD_U8 orderFilterId(const char* name)
+{
+    DeviceFilter filter;
+    MSD_BOOL isFound = MSD_FALSE;
+    HOST_CHECK_OK(deviceFilterModuleFindFilterByFilterName(HOST_DEV, name, &filter, &isFound));
+    HOST_CHECK(isFound == MSD_TRUE);
+    return filter.filterId;
+}
+
+/*
+ * The IPv6 TCP filter (4 entries, QinQ and not QinQ) moves down over a removed
+ * layer 2 filter (2 entries) before it. Its target overlaps its own entries, so it goes through a
+ * scratch slot first: behind the filters when it is the last one, otherwise
+ * the filter after it is pushed back to make room.
+ */
+static void orderMoveCascade(MSD_BOOL hasTail)
+{
+    MSD_U32 before[TCAM_MODULE_QINQ_START], after[TCAM_MODULE_QINQ_START];
+    int moveCount = 0;
+    MSD_BOOL isFound = MSD_FALSE;
+
+    HOST_CHECK_OK(deviceFilterModuleClearFilters(HOST_DEV));
+    HOST_CHECK_OK(orderAdd(0, "head", FILTER_TYPE_SECOND_LAYER, 0));
+    HOST_CHECK_OK(orderAdd(0, "ipv6", FILTER_TYPE_IP_TCP_OR_UDP, MSD_TCAM_TYPE_IPV6_TCP));
+    if (hasTail)
+        HOST_CHECK_OK(orderAdd(0, "tail", FILTER_TYPE_SECOND_LAYER, 0));
+    MSD_U8 ipv6Id = orderFilterId("ipv6");
+    HOST_CHECK(orderFilterSlots(ipv6Id, before) == 4);
+    HOST_CHECK(before[0] == 2);
+    orderCheckCascade(ipv6Id);
+
+    HOST_CHECK_OK(deviceFilterModuleRemoveFilterById(HOST_DEV, orderFilterId("head"), &isFound));
+    HOST_CHECK(isFound == MSD_TRUE);
+    HOST_CHECK_OK(deviceFilterModuleDefragTcam(HOST_DEV, &moveCount));
+    HOST_CHECK(orderFilterSlots(ipv6Id, after) == 4);
+    for (int i = 0; i < 4; ++i)
+        HOST_CHECK(after[i] == (MSD_U32)i);
+    orderCheckCascade(ipv6Id);
+    if (hasTail) {
+        MSD_U32 tail[TCAM_MODULE_QINQ_START];
+        HOST_CHECK(orderFilterSlots(orderFilterId("tail"), tail) == 2);
+        HOST_CHECK(tail[0] == 4 && tail[1] == 5);
+    }
+    printf("%s: defrag moved %d entries\n", hasTail ? "ipv6 before a filter" : "ipv6 last", moveCount);
+    HOST_CHECK(moveCount >= 8);
+    orderCheck(0);
+    HOST_CHECK_OK(deviceFilterModuleClearFilters(HOST_DEV));
+}
+
+int main(void)
+{
+    MSD_SIM_CONFIG cfg;
+
+    if (hostOpen() != 0)
+        return 1;
+    HOST_CHECK_OK(deviceFilterModuleSetIsEnableFilter(HOST_DEV, MSD_TRUE));
+    HOST_CHECK_OK(msdSimConfigGet(&cfg));
+    cfg.delay = orderHook;
+    HOST_CHECK_OK(msdSimConfigSet(&cfg));
+    s_hookEnabled = MSD_TRUE;
+
+    orderMoveCascade(MSD_FALSE);
+    orderMoveCascade(MSD_TRUE);
+    orderChurn();
+
+    s_hookEnabled = MSD_FALSE;
+    hostClose();
+    return hostResult("filterOrderTest");
+}
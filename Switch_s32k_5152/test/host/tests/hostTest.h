@@ -0,0 +1,86 @@
+/*
+ * hostTest.h - helpers shared by the host tests and benchmarks
+ *
+ * Each test is one executable which opens device 0 on the simulator through
+ * initOpenDevice, runs its checks and returns the number of failed checks.
+ * Times are simulated bus time from msdSimStatsGet, so they do not depend on
+ * the speed of the host.
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+#include <apiInit.h>
+#include <msdSim.h>
+
+#define HOST_DEV    0
+
+static int s_hostFailures = 0;
+
+#define HOST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            s_hostFailures++; \
+        } \
+    } while (0)
+
+#define HOST_CHECK_OK(expr) \
+    do { \
+        MSD_STATUS hostStatus_ = (expr); \
+        if (hostStatus_ != MSD_OK) { \
+            printf("%s:%d: %s returned %d\n", __FILE__, __LINE__, #expr, (int)hostStatus_); \
+            s_hostFailures++; \
+        } \
+    } while (0)
+
+/* open device 0 on a freshly reset simulator */
+static int hostOpen(void)
+{
+    if (initOpenDevice(HOST_DEV) != MSD_OK) {
+        printf("initOpenDevice failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+static void hostClose(void)
+{
+    initCloseDevice(HOST_DEV);
+}
+
+/* simulated time in uSec since the last hostClockReset */
+static MSD_U64 s_hostClockStart = 0;
+
+static void hostClockReset(void)
+{
+    MSD_SIM_STATS stats;
+    msdSimStatsGet(&stats);
+    s_hostClockStart = stats.clock;
+}
+
+static double hostClockUs(void)
+{
+    MSD_SIM_STATS stats;
+    msdSimStatsGet(&stats);
+    return (double)(stats.clock - s_hostClockStart) / 1000.0;
+}
+
+static void hostMac(MSD_ETHERADDR* mac, MSD_U32 index)
+{
+    mac->arEther[0] = 0x02;
+    mac->arEther[1] = 0x00;
+    mac->arEther[2] = (MSD_U8)(index >> 24);
+    mac->arEther[3] = (MSD_U8)(index >> 16);
+    mac->arEther[4] = (MSD_U8)(index >> 8);
+    mac->arEther[5] = (MSD_U8)index;
+}
+
+static int hostResult(const char* name)
+{
+    printf("%s: %s\n", name, s_hostFailures == 0 ? "passed" : "FAILED");
+    return s_hostFailures == 0 ? 0 : 1;
+}
+
+#endif /* HOST_TEST_H */
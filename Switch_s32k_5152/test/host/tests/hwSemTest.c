@@ -0,0 +1,198 @@
+/*
+ * hwSemTest.c - the hardware semaphore backoff of msdSemTake, run on the
+ * cooperative host scheduler. Another host holds the semaphore in the
+ * simulator while two tasks of this host wait for it: the RAM guard is free
+ * while they back off, the task that wakes second joins the first one as a
+ * nested take, and the semaphore is written back to 0x0 after the last give.
+ * A semaphore that is never released times out after MSD_HW_SEM_TIMEOUT
+ * counted in ticks.
+ */
+#include "hostTest.h"
+#include <msdSem.h>
+#include <semphr.h>
+
+#define SEM_TASK_BASE       0x1000U     /* semaphore ids handed out by the task semaphores */
+#define SEM_TASK_MAX        4
+#define SEM_OTHER_HOST      0x2U        /* semaphore value of the other host */
+#define SEM_OTHER_HOLD      20          /* ticks the other host keeps it */
+#define SEM_HOLD            5           /* ticks a task keeps the software semaphore */
+#define SEM_STATS_AT        2           /* tick the statistics are read while the tasks back off */
+
+typedef struct {
+    MSD_STATUS status;
+    TickType_t takenTick;
+    TickType_t doneTick;
+} SemTaskState;
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static SemaphoreHandle_t s_taskSems[SEM_TASK_MAX];
+static int s_taskSemCount = 0;
+static MSD_FMSD_SEM_DELETE s_bspDelete;
+static MSD_FMSD_SEM_TAKE s_bspTake;
+static MSD_FMSD_SEM_GIVE s_bspGive;
+static MSD_SEM s_testSem;
+static SemTaskState s_states[2];
+static TickType_t s_statsWait;
+static MSD_HW_SEM_STATS s_statsSeen;
+
+/* the guard and the test semaphore are host mutexes, other ids go to the BSP hooks of the device (none in the host build) */
+static MSD_SEM taskSemCreate(MSD_SEM_BEGIN_STATE state)
+{
+    if (s_taskSemCount == SEM_TASK_MAX)
+        return 0;
+    SemaphoreHandle_t sem = xSemaphoreCreateMutex();
+    if (state == MSD_SEM_EMPTY)
+        (void)xSemaphoreTake(sem, 0);
+    s_taskSems[s_taskSemCount] = sem;
+    return SEM_TASK_BASE + (MSD_SEM)s_taskSemCount++;
+}
+
+static MSD_STATUS taskSemDelete(MSD_SEM smid)
+{
+    if (smid < SEM_TASK_BASE)
+        return s_bspDelete != NULL ? s_bspDelete(smid) : MSD_OK;
+    vSemaphoreDelete(s_taskSems[smid - SEM_TASK_BASE]);
+    s_taskSems[smid - SEM_TASK_BASE] = NULL;
+    return MSD_OK;
+}
+
+static MSD_STATUS taskSemTake(MSD_SEM smid, MSD_U32 timeOut)
+{
+    if (smid < SEM_TASK_BASE)
+        return s_bspTake != NULL ? s_bspTake(smid, timeOut) : MSD_FAIL;
+    TickType_t wait = timeOut == OS_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeOut);
+    return xSemaphoreTake(s_taskSems[smid - SEM_TASK_BASE], wait) == pdTRUE ? MSD_OK : MSD_FAIL;
+}
+
+static MSD_STATUS taskSemGive(MSD_SEM smid)
+{
+    if (smid < SEM_TASK_BASE)
+        return s_bspGive != NULL ? s_bspGive(smid) : MSD_FAIL;
+    return xSemaphoreGive(s_taskSems[smid - SEM_TASK_BASE]) == pdTRUE ? MSD_OK : MSD_FAIL;
+}
+
+static void semInstall(MSD_QD_DEV* dev)
+{
+    s_bspDelete = dev->semDelete;
+    s_bspTake = dev->semTake;
+    s_bspGive = dev->semGive;
+    dev->semCreate = taskSemCreate;
+    dev->semDelete = taskSemDelete;
+    dev->semTake = taskSemTake;
+    dev->semGive = taskSemGive;
+    (void)msdSemDelete(HOST_DEV, dev->hwSem.guard);
+    dev->hwSem.guard = msdSemCreate(HOST_DEV, MSD_SEM_FULL);
+    s_testSem = msdSemCreate(HOST_DEV, MSD_SEM_FULL);
+}
+
+static void semTaskProc(void* param)
+{
+    SemTaskState* state = (SemTaskState*)param;
+    state->status = msdSemTake(HOST_DEV, s_testSem, OS_WAIT_FOREVER);
+    state->takenTick = xTaskGetTickCount();
+    if (state->status == MSD_OK) {
+        vTaskDelay(SEM_HOLD);
+        (void)msdSemGive(HOST_DEV, s_testSem);
+    }
+    state->doneTick = xTaskGetTickCount();
+}
+
+static void semOtherHostProc(void* param)
+{
+    (void)param;
+    vTaskDelay(SEM_OTHER_HOLD);
+    (void)msdSimHwSemSet(0);
+}
+
+/* takes the RAM guard while both tasks back off */
+static void semStatsProc(void* param)
+{
+    (void)param;
+    vTaskDelay(SEM_STATS_AT);
+    TickType_t start = xTaskGetTickCount();
+    (void)msdHwSemStatsGet(HOST_DEV, &s_statsSeen);
+    s_statsWait = xTaskGetTickCount() - start;
+}
+
+static MSD_U16 semRegister(void)
+{
+    MSD_U16 value = 0xFFFF;
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, OS_HW_SEMAPHORE_DEV_REG, OS_HW_SEMAPHORE_REG, &value));
+    return value;
+}
+
+static void semContention(MSD_QD_DEV* dev)
+{
+    MSD_HW_SEM_STATS stats;
+
+    HOST_CHECK_OK(msdHwSemStatsClear(HOST_DEV));
+    memset(s_states, 0, sizeof(s_states));
+    s_statsWait = portMAX_DELAY;
+    HOST_CHECK_OK(msdSimHwSemSet(SEM_OTHER_HOST));
+    TickType_t start = xTaskGetTickCount();
+    HOST_CHECK(xTaskCreate(semTaskProc, "semA", 512, &s_states[0], 1, NULL) == pdPASS);
+    HOST_CHECK(xTaskCreate(semTaskProc, "semB", 512, &s_states[1], 1, NULL) == pdPASS);
+    HOST_CHECK(xTaskCreate(semOtherHostProc, "other", 512, NULL, 1, NULL) == pdPASS);
+    HOST_CHECK(xTaskCreate(semStatsProc, "stats", 512, NULL, 1, NULL) == pdPASS);
+    hostTaskRun(SEM_OTHER_HOLD + 4 * SEM_HOLD);
+
+    HOST_CHECK_OK(msdHwSemStatsGet(HOST_DEV, &stats));
+    printf("contention: taken at ticks %u and %u, guard wait %u ticks, %u spins\n",
+           (unsigned)(s_states[0].takenTick - start), (unsigned)(s_states[1].takenTick - start),
+           (unsigned)s_statsWait, (unsigned)stats.spins);
+    HOST_CHECK(s_states[0].status == MSD_OK && s_states[1].status == MSD_OK);
+    /* the guard is not held across the backoff */
+    HOST_CHECK(s_statsWait == 0);
+    HOST_CHECK(s_statsSeen.acquires == 0);
+    /* one task writes the semaphore, the other joins as a nested take */
+    HOST_CHECK(stats.acquires == 1);
+    HOST_CHECK(stats.nested == 1);
+    HOST_CHECK(stats.contended == 2);
+    HOST_CHECK(stats.timeouts == 0);
+    TickType_t first = s_states[0].takenTick < s_states[1].takenTick ? s_states[0].takenTick : s_states[1].takenTick;
+    TickType_t second = s_states[0].takenTick < s_states[1].takenTick ? s_states[1].takenTick : s_states[0].takenTick;
+    HOST_CHECK(first - start >= SEM_OTHER_HOLD && first - start <= SEM_OTHER_HOLD + 1);
+    /* the software semaphore still serializes the two tasks */
+    HOST_CHECK(second - first >= SEM_HOLD);
+    HOST_CHECK(dev->hwSem.holdCnt == 0);
+    HOST_CHECK(semRegister() == 0);
+}
+
+static void semTimeout(MSD_QD_DEV* dev)
+{
+    MSD_HW_SEM_STATS stats;
+
+    HOST_CHECK_OK(msdHwSemStatsClear(HOST_DEV));
+    memset(s_states, 0, sizeof(s_states));
+    HOST_CHECK_OK(msdSimHwSemSet(SEM_OTHER_HOST));
+    TickType_t start = xTaskGetTickCount();
+    HOST_CHECK(xTaskCreate(semTaskProc, "semA", 512, &s_states[0], 1, NULL) == pdPASS);
+    hostTaskRun(2 * (MSD_HW_SEM_TIMEOUT / MSD_HW_SEM_TICK_US));
+
+    HOST_CHECK_OK(msdHwSemStatsGet(HOST_DEV, &stats));
+    printf("timeout after %u ticks\n", (unsigned)(s_states[0].takenTick - start));
+    HOST_CHECK(s_states[0].status == MSD_BUSY);
+    HOST_CHECK(s_states[0].takenTick - start == MSD_HW_SEM_TIMEOUT / MSD_HW_SEM_TICK_US);
+    HOST_CHECK(stats.timeouts == 1 && stats.acquires == 0);
+    HOST_CHECK(dev->hwSem.holdCnt == 0);
+    HOST_CHECK(semRegister() == SEM_OTHER_HOST);
+    HOST_CHECK_OK(msdSimHwSemSet(0));
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    MSD_QD_DEV* dev = sohoDevGet(HOST_DEV);
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    semInstall(dev);
+    HOST_CHECK_OK(msdEnableHwSemaphore(HOST_DEV));
+
+    semContention(dev);
+    semTimeout(dev);
+
+    HOST_CHECK_OK(msdDisableHwSemaphore(HOST_DEV));
+    hostClose();
+    return hostResult("hwSemTest");
+}
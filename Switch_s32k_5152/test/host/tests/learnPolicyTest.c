@@ -0,0 +1,181 @@
+/*
+ * learnPolicyTest.c - a MAC flood against the port learn policy.
+ * Addresses are learned through msdSimLearn. A flooding managed port must
+ * stop at its learn limit while the other managed ports keep their
+ * guaranteed share, and when an unmanaged port fills the ATU the full
+ * violation must shrink the budget and flush the flooding port only.
+ * After the flood and after the flush the memory index must pass
+ * deviceAtuModuleCheckConsistency and hold what a full refresh reads back
+ * from the switch.
+ */
+#include <stdlib.h>
+#include "hostTest.h"
+#include <deviceMacModule.h>
+#include <deviceVlanModule.h>
+
+#define FLOOD_PORT      1
+#define QUIET_FIRST     2
+#define QUIET_LAST      4
+#define UPLINK_PORT     5
+#define MIN_LIMIT       64
+#define MAX_LIMIT       512
+#define QUIET_MACS      32
+
+extern MSD_STATUS setFidValue(IN MSD_U8 devNum, IN MSD_U16 fid);
+
+static MSD_U32 s_nextMac = 0;
+static MacEntry s_shadow[MAX_AUTO_ATU_ENTRIES];
+static MacEntry s_refreshed[MAX_AUTO_ATU_ENTRIES];
+
+/* learn count new addresses on the port, returns how many were learned */
+static MSD_U32 learnFlood(MSD_U8 port, MSD_U32 count, MSD_STATUS* lastStatus)
+{
+    MSD_U32 learned = 0;
+    MSD_ETHERADDR mac;
+    for (MSD_U32 i = 0; i < count; ++i) {
+        hostMac(&mac, s_nextMac++);
+        *lastStatus = msdSimLearn(port, PORT_DEFAULT_VID, &mac);
+        if (*lastStatus == MSD_OK)
+            learned++;
+    }
+    return learned;
+}
+
+static MSD_U32 learnCount(MSD_U8 port)
+{
+    MSD_U32 count = 0;
+    HOST_CHECK_OK(msdFdbPortLearnCountGet(HOST_DEV, (MSD_LPORT)port, &count));
+    return count;
+}
+
+static int macEntryCmp(const void* a, const void* b)
+{
+    const MacEntry* x = (const MacEntry*)a;
+    const MacEntry* y = (const MacEntry*)b;
+    if (x->vid != y->vid)
+        return x->vid < y->vid ? -1 : 1;
+    return memcmp(x->address.arEther, y->address.arEther, sizeof(x->address.arEther));
+}
+
+/* the dynamic entries of the memory index, sorted by VID then MAC */
+static MSD_U32 shadowEntries(MacEntry* entries)
+{
+    MSD_U32 count = 0;
+    HOST_CHECK_OK(deviceAtuModuleGetAllVidAutoEntriesFromConfiguration(HOST_DEV, entries, MAX_AUTO_ATU_ENTRIES, &count));
+    qsort(entries, count, sizeof(MacEntry), macEntryCmp);
+    return count;
+}
+
+/* the index is consistent before and after a refresh from the switch, returns the refreshed entry count */
+static MSD_U32 refreshCheck(void)
+{
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+    HOST_CHECK_OK(deviceAtuModuleRefreshAllVidAutoEntriesToConfiguration(HOST_DEV));
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+    return shadowEntries(s_refreshed);
+}
+
+/* the incrementally maintained index holds exactly the entries a refresh reads back, returns their count */
+static MSD_U32 refreshCompare(void)
+{
+    MSD_U32 count = shadowEntries(s_shadow);
+    HOST_CHECK(refreshCheck() == count);
+    for (MSD_U32 i = 0; i < count; ++i) {
+        HOST_CHECK(macEntryCmp(&s_shadow[i], &s_refreshed[i]) == 0);
+        HOST_CHECK(s_shadow[i].portVec == s_refreshed[i].portVec);
+    }
+    return count;
+}
+
+static MSD_U32 portEntries(const MacEntry* entries, MSD_U32 count, MSD_U8 port)
+{
+    MSD_U32 found = 0;
+    for (MSD_U32 i = 0; i < count; ++i) {
+        if (entries[i].portVec == (1U << port))
+            found++;
+    }
+    return found;
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    for (MSD_U8 port = FLOOD_PORT; port <= UPLINK_PORT; ++port)
+        HOST_CHECK_OK(msdPortLearnEnableSet(HOST_DEV, (MSD_LPORT)port, MSD_TRUE));
+    /* the refresh reads the FIDs of the VLAN module, the flood VLAN has no VTU entry here */
+    HOST_CHECK_OK(setFidValue(HOST_DEV, PORT_DEFAULT_VID));
+
+    AtuLearnPolicy policy;
+    memset(&policy, 0, sizeof(policy));
+    policy.isEnable = MSD_TRUE;
+    for (MSD_U8 port = FLOOD_PORT; port <= QUIET_LAST; ++port) {
+        policy.minLimit[port] = MIN_LIMIT;
+        policy.maxLimit[port] = MAX_LIMIT;
+    }
+    HOST_CHECK_OK(deviceAtuModuleSetLearnPolicy(HOST_DEV, &policy));
+
+    AtuLearnPolicyStatus status;
+    HOST_CHECK_OK(deviceAtuModuleGetLearnPolicyStatus(HOST_DEV, &status));
+    HOST_CHECK(status.limit[FLOOD_PORT] == MIN_LIMIT);
+    HOST_CHECK(status.limit[UPLINK_PORT] == 0);
+
+    /* the flooding port stops at its limit, the quiet ports still learn */
+    MSD_STATUS last = MSD_OK;
+    HOST_CHECK(learnFlood(FLOOD_PORT, 1000, &last) == MIN_LIMIT);
+    HOST_CHECK(last == MSD_NO_SPACE);
+    for (MSD_U8 port = QUIET_FIRST; port <= QUIET_LAST; ++port)
+        HOST_CHECK(learnFlood(port, QUIET_MACS, &last) == QUIET_MACS);
+    HOST_CHECK(learnCount(FLOOD_PORT) == MIN_LIMIT);
+
+    /* rebalancing gives the full port headroom, the others keep their minimum */
+    HOST_CHECK_OK(deviceAtuModuleLearnPolicyRebalance(HOST_DEV));
+    HOST_CHECK_OK(deviceAtuModuleGetLearnPolicyStatus(HOST_DEV, &status));
+    HOST_CHECK(status.learnCount[FLOOD_PORT] == MIN_LIMIT);
+    HOST_CHECK(status.limit[FLOOD_PORT] == MIN_LIMIT + ATU_LEARN_POLICY_HEADROOM);
+    HOST_CHECK(status.limit[QUIET_FIRST] == MIN_LIMIT);
+    MSD_U32 limit = 0;
+    HOST_CHECK_OK(msdFdbPortLearnLimitGet(HOST_DEV, (MSD_LPORT)QUIET_FIRST, &limit));
+    HOST_CHECK(limit == MIN_LIMIT);
+    HOST_CHECK(learnFlood(FLOOD_PORT, 1000, &last) == ATU_LEARN_POLICY_HEADROOM);
+
+    /* the unmanaged uplink fills the ATU and raises the full violation */
+    MSD_U32 uplinkLearned = learnFlood(UPLINK_PORT, MAX_AUTO_ATU_ENTRIES, &last);
+    HOST_CHECK(last == MSD_NO_SPACE);
+    MSD_ATU_INT_STATUS violation;
+    memset(&violation, 0, sizeof(violation));
+    HOST_CHECK_OK(msdFdbViolationGet(HOST_DEV, &violation));
+    HOST_CHECK(violation.atuIntCause.fullVio == MSD_TRUE);
+    HOST_CHECK(violation.spid == UPLINK_PORT);
+
+    /* the flood was learned by the switch alone, a refresh brings it into the index */
+    MSD_U32 refreshed = refreshCheck();
+    HOST_CHECK(refreshed == MIN_LIMIT + ATU_LEARN_POLICY_HEADROOM + (QUIET_LAST - QUIET_FIRST + 1) * QUIET_MACS + uplinkLearned);
+    HOST_CHECK(portEntries(s_refreshed, refreshed, FLOOD_PORT) == MIN_LIMIT + ATU_LEARN_POLICY_HEADROOM);
+    HOST_CHECK(portEntries(s_refreshed, refreshed, UPLINK_PORT) == uplinkLearned);
+
+    HOST_CHECK_OK(deviceAtuModuleLearnPolicyHandleViolation(HOST_DEV, &violation));
+    HOST_CHECK_OK(deviceAtuModuleGetLearnPolicyStatus(HOST_DEV, &status));
+    HOST_CHECK(status.fullViolations == 1);
+    HOST_CHECK(status.quarantineCount == 1);
+    HOST_CHECK(status.lastQuarantinePort == FLOOD_PORT);
+    HOST_CHECK(status.budget == (QUIET_LAST - FLOOD_PORT + 1) * MIN_LIMIT);
+    HOST_CHECK(learnCount(FLOOD_PORT) == 0);
+    for (MSD_U8 port = QUIET_FIRST; port <= QUIET_LAST; ++port)
+        HOST_CHECK(learnCount(port) == QUIET_MACS);
+    /* the flush removed the flooding port from the index without a refresh */
+    MSD_U32 flushed = refreshCompare();
+    HOST_CHECK(flushed == refreshed - MIN_LIMIT - ATU_LEARN_POLICY_HEADROOM);
+    HOST_CHECK(portEntries(s_refreshed, flushed, FLOOD_PORT) == 0);
+
+    /* the violation was serviced, the freed space goes to the flooding port up to its new limit */
+    memset(&violation, 0, sizeof(violation));
+    HOST_CHECK_OK(msdFdbViolationGet(HOST_DEV, &violation));
+    HOST_CHECK(violation.atuIntCause.fullVio == MSD_FALSE);
+    HOST_CHECK(learnFlood(FLOOD_PORT, 1000, &last) == MIN_LIMIT);
+
+    printf("flood: uplink learned %u entries before the ATU was full, budget %u after the violation\n",
+           (unsigned)uplinkLearned, (unsigned)status.budget);
+    hostClose();
+    return hostResult("learnPolicyTest");
+}
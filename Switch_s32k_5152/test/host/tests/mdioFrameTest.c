@@ -0,0 +1,158 @@
+/*
+ * mdioFrameTest.c - the Clause 45 address cache of smiaccess.c and the burst
+ * reads of the register batch, on the MDIO frames the simulator serves
+ * through hostMdio.c. A repeated access to one register sends one ADDRESS
+ * frame, each PHY address keeps its own address, mdioInit forgets them, a
+ * successful burst leaves the address after its last register and a failed
+ * burst drops it. Consecutive reads of a batch go out as one ADDRESS frame
+ * followed by post read increment frames.
+ */
+#include "hostTest.h"
+#include <msdHwAccess.h>
+#include <smiasscess.h>
+
+#define MDIO_PORT           9
+#define MDIO_OTHER_PORT     8
+#define MDIO_DEV_TYPE       3
+#define MDIO_REG(reg)       (0x8000U | (reg))
+#define MDIO_FIRST_REG      0x11    /* plain registers of the port, no operation or learn count bits */
+#define MDIO_REG_COUNT      6
+#define MDIO_LAST_REGS      0x1E    /* a burst of four from here runs past register 31 */
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_U16 mdioValue(int port, int reg)
+{
+    return (MSD_U16)(0x5A00 | (port << 5) | reg);
+}
+
+static MSD_U32 mdioAddrFrames(void)
+{
+    MSD_SIM_STATS stats;
+    msdSimStatsGet(&stats);
+    return stats.addrFrames;
+}
+
+static void mdioFill(void)
+{
+    for (int reg = MDIO_FIRST_REG; reg < MDIO_FIRST_REG + MDIO_REG_COUNT; ++reg) {
+        HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, MDIO_PORT, (MSD_U8)reg, mdioValue(MDIO_PORT, reg)));
+        HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, MDIO_OTHER_PORT, (MSD_U8)reg, mdioValue(MDIO_OTHER_PORT, reg)));
+    }
+    HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, MDIO_PORT, MDIO_LAST_REGS, mdioValue(MDIO_PORT, MDIO_LAST_REGS)));
+    HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, MDIO_PORT, MDIO_LAST_REGS + 1, mdioValue(MDIO_PORT, MDIO_LAST_REGS + 1)));
+}
+
+/* one ADDRESS frame per register and PHY address until mdioInit */
+static void mdioAddressCache(void)
+{
+    MSD_U32 frames = mdioAddrFrames();
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(mdioAddrFrames() == frames + 1);
+    for (int i = 0; i < 3; ++i)
+        HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(mdioAddrFrames() == frames + 1);
+
+    /* the write of a polled register and the polls share the address */
+    HOST_CHECK(writeC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG), 0x1234) == 0);
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == 0x1234);
+    HOST_CHECK(mdioAddrFrames() == frames + 1);
+    HOST_CHECK(writeC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG), mdioValue(MDIO_PORT, MDIO_FIRST_REG)) == 0);
+
+    /* another PHY address has its own address register */
+    HOST_CHECK(readC45Register(MDIO_OTHER_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_OTHER_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(mdioAddrFrames() == frames + 2);
+
+    /* a new register moves the address */
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG + 1)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG + 1));
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(mdioAddrFrames() == frames + 4);
+
+    /* mdioInit forgets every address */
+    HOST_CHECK(mdioInit(NULL) == 0);
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(readC45Register(MDIO_OTHER_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG)) == mdioValue(MDIO_OTHER_PORT, MDIO_FIRST_REG));
+    HOST_CHECK(mdioAddrFrames() == frames + 6);
+}
+
+/* after a burst the address register is past the last register read, or unknown if the burst failed */
+static void mdioBurstAddress(void)
+{
+    unsigned short values[4];
+    MSD_SIM_STATS before, after;
+
+    /* the address register already points at the first register */
+    msdSimStatsGet(&before);
+    HOST_CHECK(readC45RegisterBurst(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG), 4, values) == 0);
+    msdSimStatsGet(&after);
+    for (int i = 0; i < 4; ++i)
+        HOST_CHECK(values[i] == mdioValue(MDIO_PORT, MDIO_FIRST_REG + i));
+    HOST_CHECK(after.addrFrames == before.addrFrames);
+    HOST_CHECK(after.bursts == before.bursts + 1);
+    HOST_CHECK(after.reads == before.reads + 4);
+    /* the next register is where the burst left the address */
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG + 4)) == mdioValue(MDIO_PORT, MDIO_FIRST_REG + 4));
+    HOST_CHECK(mdioAddrFrames() == after.addrFrames);
+    /* and a burst from there continues without an ADDRESS frame */
+    HOST_CHECK(readC45RegisterBurst(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_FIRST_REG + 4), 2, values) == 0);
+    HOST_CHECK(values[0] == mdioValue(MDIO_PORT, MDIO_FIRST_REG + 4) && values[1] == mdioValue(MDIO_PORT, MDIO_FIRST_REG + 5));
+    HOST_CHECK(mdioAddrFrames() == after.addrFrames);
+
+    /* the third frame runs past register 31 and fails after the address register moved twice */
+    msdSimStatsGet(&before);
+    HOST_CHECK(readC45RegisterBurst(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_LAST_REGS), 4, values) < 0);
+    HOST_CHECK(values[0] == mdioValue(MDIO_PORT, MDIO_LAST_REGS) && values[1] == mdioValue(MDIO_PORT, MDIO_LAST_REGS + 1));
+    msdSimStatsGet(&after);
+    HOST_CHECK(after.addrFrames == before.addrFrames + 1);
+    /* the address of the failed burst is not trusted, the read sends a new ADDRESS frame */
+    HOST_CHECK(readC45Register(MDIO_PORT, MDIO_DEV_TYPE, MDIO_REG(MDIO_LAST_REGS)) == mdioValue(MDIO_PORT, MDIO_LAST_REGS));
+    HOST_CHECK(mdioAddrFrames() == after.addrFrames + 1);
+}
+
+/* runs of consecutive reads in a batch become bursts */
+static void mdioBatchBurst(void)
+{
+    MSD_U16 port[MDIO_REG_COUNT], other[3];
+    MSD_U16 single = 0;
+    MSD_SIM_STATS before, after;
+
+    memset(port, 0, sizeof(port));
+    memset(other, 0, sizeof(other));
+    HOST_CHECK(mdioInit(NULL) == 0);
+    msdSimStatsGet(&before);
+    HOST_CHECK_OK(msdRegBatchBegin(HOST_DEV));
+    for (int i = 0; i < MDIO_REG_COUNT; ++i)
+        HOST_CHECK_OK(msdRegBatchRead(HOST_DEV, MDIO_PORT, (MSD_U8)(MDIO_FIRST_REG + i), &port[i]));
+    for (int i = 0; i < 3; ++i)
+        HOST_CHECK_OK(msdRegBatchRead(HOST_DEV, MDIO_OTHER_PORT, (MSD_U8)(MDIO_FIRST_REG + i), &other[i]));
+    /* not consecutive, read on its own */
+    HOST_CHECK_OK(msdRegBatchRead(HOST_DEV, MDIO_PORT, MDIO_LAST_REGS, &single));
+    HOST_CHECK_OK(msdRegBatchCommit(HOST_DEV));
+    msdSimStatsGet(&after);
+
+    for (int i = 0; i < MDIO_REG_COUNT; ++i)
+        HOST_CHECK(port[i] == mdioValue(MDIO_PORT, MDIO_FIRST_REG + i));
+    for (int i = 0; i < 3; ++i)
+        HOST_CHECK(other[i] == mdioValue(MDIO_OTHER_PORT, MDIO_FIRST_REG + i));
+    HOST_CHECK(single == mdioValue(MDIO_PORT, MDIO_LAST_REGS));
+    printf("batch of %d reads: %u ADDRESS frames, %u bursts, %.1f us\n", MDIO_REG_COUNT + 4,
+           (unsigned)(after.addrFrames - before.addrFrames), (unsigned)(after.bursts - before.bursts),
+           (double)(after.clock - before.clock) / 1000.0);
+    HOST_CHECK(after.bursts == before.bursts + 2);
+    HOST_CHECK(after.addrFrames == before.addrFrames + 3);
+    HOST_CHECK(after.reads == before.reads + MDIO_REG_COUNT + 4);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    mdioFill();
+    mdioAddressCache();
+    mdioBurstAddress();
+    mdioBatchBurst();
+    hostClose();
+    return hostResult("mdioFrameTest");
+}
@@ -0,0 +1,307 @@
+/*
+ * moduleBench.c - timing of the common MAC, VLAN and filter module calls on
+ * the simulator, with a check of every result. Prints simulated bus time per
+ * call and the register traffic behind it. A VTU walk with the GetNext register
+ * sequence of Fir_vtuOperationPerform is run once with one msdGetAnyReg or
+ * msdSetAnyReg call per register, as the drivers did before msdRegBatch, and
+ * once batched, over SMI and RMU, to count the bus transactions saved.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+#include <deviceVlanModule.h>
+#include <deviceFilterModule.h>
+#include <Fir_msdApiInternal.h>
+#include <Fir_msdDrvSwRegs.h>
+
+#define BENCH_MAC_COUNT     48
+#define BENCH_VLAN_COUNT    64
+#define BENCH_FILTER_COUNT  16
+#define BENCH_WALK_COUNT    32
+#define BENCH_BUSY_LOOP     1000
+
+static MSD_SIM_STATS s_benchStart;
+
+static void benchBegin(void)
+{
+    msdSimStatsGet(&s_benchStart);
+}
+
+static void benchEnd(const char* name, int calls)
+{
+    MSD_SIM_STATS stats;
+    msdSimStatsGet(&stats);
+    double us = (double)(stats.clock - s_benchStart.clock) / 1000.0;
+    printf("%-28s %6d calls %12.1f us %10.1f us/call %8u rd %8u wr\n", name, calls, us,
+           calls > 0 ? us / calls : 0.0, stats.reads - s_benchStart.reads, stats.writes - s_benchStart.writes);
+}
+
+static void benchMac(void)
+{
+    MSD_ATU_ENTRY entry;
+    MSD_ATU_ENTRY found;
+    MSD_BOOL isFound = MSD_FALSE;
+    int i;
+
+    benchBegin();
+    for (i = 0; i < BENCH_MAC_COUNT; ++i) {
+        memset(&entry, 0, sizeof(entry));
+        hostMac(&entry.macAddr, (MSD_U32)i);
+        entry.portVec = 1U << (i % 8);
+        entry.fid = (MSD_U16)(1 + i % 4);
+        entry.entryState = 0xF;
+        HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+    }
+    benchEnd("mac add static", BENCH_MAC_COUNT);
+
+    benchBegin();
+    for (i = 0; i < BENCH_MAC_COUNT; ++i) {
+        hostMac(&entry.macAddr, (MSD_U32)i);
+        HOST_CHECK_OK(deviceAtuModuleFindEntry(HOST_DEV, 1 + i % 4, &entry.macAddr, &found, &isFound));
+        HOST_CHECK(isFound && found.portVec == (1U << (i % 8)));
+    }
+    benchEnd("mac find", BENCH_MAC_COUNT);
+
+    benchBegin();
+    for (i = 0; i < BENCH_MAC_COUNT; ++i) {
+        hostMac(&entry.macAddr, (MSD_U32)i);
+        HOST_CHECK_OK(deviceAtuModuleDeleteEntry(HOST_DEV, entry.macAddr));
+    }
+    benchEnd("mac delete", BENCH_MAC_COUNT);
+    hostMac(&entry.macAddr, 0);
+    HOST_CHECK_OK(deviceAtuModuleFindEntry(HOST_DEV, 1, &entry.macAddr, &found, &isFound));
+    HOST_CHECK(!isFound);
+}
+
+static void benchVlan(void)
+{
+    FirVlanEntry vlan;
+    MSD_BOOL isFound = MSD_FALSE;
+    MSD_U16 vid;
+    int port;
+
+    benchBegin();
+    for (vid = PORT_DEFAULT_VID; vid < PORT_DEFAULT_VID + BENCH_VLAN_COUNT; ++vid) {
+        memset(&vlan, 0, sizeof(vlan));
+        vlan.entry.vid = vid;
+        vlan.entry.fid = vid;
+        for (port = 0; port < MSD_MAX_SWITCH_PORTS; ++port)
+            vlan.entry.memberTagP[port] = (port % 2 == 0) ? MSD_MEMBER_EGRESS_TAGGED : MSD_MEMBER_EGRESS_UNTAGGED;
+        HOST_CHECK_OK(deviceVlanModuleAddOrModifyVlan(HOST_DEV, &vlan));
+    }
+    benchEnd("vlan add", BENCH_VLAN_COUNT);
+
+    benchBegin();
+    for (vid = PORT_DEFAULT_VID; vid < PORT_DEFAULT_VID + BENCH_VLAN_COUNT; ++vid) {
+        memset(&vlan, 0, sizeof(vlan));
+        vlan.entry.vid = vid;
+        HOST_CHECK_OK(deviceVlanModuleFindVlan(HOST_DEV, &vlan, &isFound));
+        HOST_CHECK(isFound && vlan.entry.fid == vid && vlan.entry.memberTagP[1] == MSD_MEMBER_EGRESS_UNTAGGED);
+    }
+    benchEnd("vlan find", BENCH_VLAN_COUNT);
+
+    benchBegin();
+    for (vid = PORT_DEFAULT_VID; vid < PORT_DEFAULT_VID + BENCH_VLAN_COUNT; ++vid)
+        HOST_CHECK_OK(deviceVlanModuleDelVlan(HOST_DEV, vid));
+    benchEnd("vlan delete", BENCH_VLAN_COUNT);
+    memset(&vlan, 0, sizeof(vlan));
+    vlan.entry.vid = PORT_DEFAULT_VID;
+    HOST_CHECK_OK(deviceVlanModuleFindVlan(HOST_DEV, &vlan, &isFound));
+    HOST_CHECK(!isFound);
+}
+
+/* the VTU result registers of one GetNext */
+typedef struct {
+    MSD_U16 vid;
+    MSD_U16 sid;
+    MSD_U16 fid;
+    MSD_U16 data1;
+    MSD_U16 data2;
+} BenchVtuRegs;
+
+static MSD_STATUS benchBusyWait(void)
+{
+    MSD_U16 data = 0x8000;
+    for (int i = 0; i < BENCH_BUSY_LOOP && (data & 0x8000) != 0; ++i) {
+        MSD_STATUS status = msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, &data);
+        if (status != MSD_OK)
+            return status;
+    }
+    return (data & 0x8000) == 0 ? MSD_OK : MSD_FAIL;
+}
+
+/* one GetNext register by register, each access is a transaction of its own */
+static void benchGetNextSingle(MSD_U16 vid, BenchVtuRegs* regs)
+{
+    MSD_U16 opReg = 0;
+
+    HOST_CHECK_OK(benchBusyWait());
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, &opReg));
+    HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, vid));
+    HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION,
+                               (MSD_U16)((opReg & 0xC00) | 0x8000 | (FIR_GET_NEXT_ENTRY << 12))));
+    HOST_CHECK_OK(benchBusyWait());
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, &regs->vid));
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, &regs->sid));
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, &regs->fid));
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, &regs->data1));
+    HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, &regs->data2));
+}
+
+/* the same GetNext in the two batches of Fir_vtuOperationPerform */
+static void benchGetNextBatch(MSD_U16 vid, BenchVtuRegs* regs)
+{
+    MSD_U16 opReg = 0;
+
+    HOST_CHECK_OK(msdRegBatchBegin(HOST_DEV));
+    (void)msdRegBatchWaitOnBit(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, 15, 0);
+    (void)msdRegBatchRead(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, &opReg);
+    HOST_CHECK_OK(msdRegBatchCommit(HOST_DEV));
+
+    HOST_CHECK_OK(msdRegBatchBegin(HOST_DEV));
+    (void)msdRegBatchWrite(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, vid);
+    (void)msdRegBatchWrite(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION,
+                           (MSD_U16)((opReg & 0xC00) | 0x8000 | (FIR_GET_NEXT_ENTRY << 12)));
+    (void)msdRegBatchWaitOnBit(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_OPERATION, 15, 0);
+    (void)msdRegBatchRead(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_VID_REG, &regs->vid);
+    (void)msdRegBatchRead(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_STU_SID_REG, &regs->sid);
+    (void)msdRegBatchRead(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_FID_REG, &regs->fid);
+    (void)msdRegBatchRead(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA1_REG, &regs->data1);
+    (void)msdRegBatchRead(HOST_DEV, FIR_GLOBAL1_DEV_ADDR, FIR_VTU_DATA2_REG, &regs->data2);
+    HOST_CHECK_OK(msdRegBatchCommit(HOST_DEV));
+}
+
+/* walks the whole VTU from VID 0xFFF of page 1, returns the number of valid entries */
+static int benchWalk(MSD_BOOL isBatch, BenchVtuRegs* walk, MSD_SIM_STATS* cost)
+{
+    MSD_SIM_STATS before, after;
+    MSD_U16 vid = 0x2FFF;
+    int count = 0;
+
+    msdSimStatsGet(&before);
+    for (;;) {
+        BenchVtuRegs regs;
+        memset(&regs, 0, sizeof(regs));
+        if (isBatch)
+            benchGetNextBatch(vid, &regs);
+        else
+            benchGetNextSingle(vid, &regs);
+        if ((regs.vid & 0x1000) == 0 || count == BENCH_WALK_COUNT)
+            break;
+        walk[count++] = regs;
+        vid = regs.vid & 0x2FFF;
+    }
+    msdSimStatsGet(&after);
+    cost->clock = after.clock - before.clock;
+    cost->reads = after.reads - before.reads;
+    cost->writes = after.writes - before.writes;
+    cost->bursts = after.bursts - before.bursts;
+    cost->addrFrames = after.addrFrames - before.addrFrames;
+    cost->rmuFrames = after.rmuFrames - before.rmuFrames;
+    cost->vtuOps = after.vtuOps - before.vtuOps;
+    return count;
+}
+
+static void benchBatchPrint(MSD_INTERFACE channel, const char* name, const MSD_SIM_STATS* cost)
+{
+    printf("%s vtu walk %-8s %10.1f us %6u rd %6u wr %5u bursts %6u addr %5u rmu frames\n",
+           channel == MSD_INTERFACE_RMU ? "RMU" : "SMI", name, (double)cost->clock / 1000.0,
+           (unsigned)cost->reads, (unsigned)cost->writes, (unsigned)cost->bursts, (unsigned)cost->addrFrames,
+           (unsigned)cost->rmuFrames);
+}
+
+static void benchBatch(MSD_INTERFACE channel)
+{
+    static BenchVtuRegs singleWalk[BENCH_WALK_COUNT];
+    static BenchVtuRegs batchWalk[BENCH_WALK_COUNT];
+    MSD_SIM_STATS single, batch;
+
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, channel));
+    int singleCount = benchWalk(MSD_FALSE, singleWalk, &single);
+    int batchCount = benchWalk(MSD_TRUE, batchWalk, &batch);
+    benchBatchPrint(channel, "single", &single);
+    benchBatchPrint(channel, "batched", &batch);
+
+    HOST_CHECK(singleCount == BENCH_WALK_COUNT);
+    HOST_CHECK(batchCount == singleCount);
+    HOST_CHECK(memcmp(singleWalk, batchWalk, sizeof(singleWalk)) == 0);
+    HOST_CHECK(batch.vtuOps == single.vtuOps);
+    HOST_CHECK(batch.clock < single.clock);
+    if (channel == MSD_INTERFACE_RMU) {
+        /* two frames per GetNext instead of one per register access */
+        HOST_CHECK(batch.rmuFrames == 2 * single.vtuOps);
+        HOST_CHECK(single.rmuFrames >= 9 * single.vtuOps);
+    } else {
+        /* the five result registers are read in one burst */
+        HOST_CHECK(batch.bursts >= single.vtuOps);
+        HOST_CHECK(batch.addrFrames < single.addrFrames);
+    }
+}
+
+/* BENCH_WALK_COUNT VLANs for the VTU walk, 7 VIDs apart so the GetNext skips free VIDs */
+static void benchBatchRun(void)
+{
+    MSD_VTU_ENTRY entry;
+
+    HOST_CHECK_OK(msdVlanAllDelete(HOST_DEV));
+    for (int i = 0; i < BENCH_WALK_COUNT; ++i) {
+        memset(&entry, 0, sizeof(entry));
+        entry.vid = (MSD_U16)(PORT_DEFAULT_VID + i * 7);
+        entry.fid = entry.vid;
+        entry.sid = (MSD_U8)(i % 4);
+        for (int port = 0; port < MSD_MAX_SWITCH_PORTS; ++port)
+            entry.memberTagP[port] = (MSD_PORT_MEMBER_TAG)((i + port) % 4);
+        HOST_CHECK_OK(msdVlanEntryAdd(HOST_DEV, &entry));
+    }
+    benchBatch(MSD_INTERFACE_SMI);
+    benchBatch(MSD_INTERFACE_RMU);
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, MSD_INTERFACE_SMI));
+    HOST_CHECK_OK(msdVlanAllDelete(HOST_DEV));
+}
+
+static void benchFilter(void)
+{
+    FilterParam param;
+    DeviceFilter filter;
+    MSD_BOOL isFound = MSD_FALSE;
+    char name[FILTER_NUM_NAME_MAX_LEN];
+    int i;
+
+    HOST_CHECK_OK(deviceFilterModuleSetIsEnableFilter(HOST_DEV, MSD_TRUE));
+    benchBegin();
+    for (i = 0; i < BENCH_FILTER_COUNT; ++i) {
+        memset(&param, 0, sizeof(param));
+        hostMac((MSD_ETHERADDR*)param.secondLayerParam.destMacData, (MSD_U32)i);
+        memset(param.secondLayerParam.destMacMask, 0xFF, sizeof(param.secondLayerParam.destMacMask));
+        param.secondLayerParam.checkEtherFlag = CHECK_ETHER_DEST_MAC_FLAG;
+        snprintf(name, sizeof(name), "bench%d", i);
+        HOST_CHECK_OK(deviceFilterModuleAddFilter(HOST_DEV, (MSD_U8)(i + 1), name, 0x2, EGRESS_TYPE_DROP, 0x4,
+                                                  FILTER_TYPE_SECOND_LAYER, &param));
+    }
+    benchEnd("filter add", BENCH_FILTER_COUNT);
+
+    for (i = 0; i < BENCH_FILTER_COUNT; ++i) {
+        HOST_CHECK_OK(deviceFilterModuleFindFilterByFilterNum(HOST_DEV, (MSD_U8)(i + 1), &filter, &isFound));
+        HOST_CHECK(isFound && filter.etype == EGRESS_TYPE_DROP);
+    }
+
+    benchBegin();
+    for (i = 0; i < BENCH_FILTER_COUNT; ++i) {
+        HOST_CHECK_OK(deviceFilterModuleRemoveFilterById(HOST_DEV, (MSD_U8)(i + 1), &isFound));
+        HOST_CHECK(isFound);
+    }
+    benchEnd("filter remove", BENCH_FILTER_COUNT);
+}
+
+int main(void)
+{
+    benchBegin();
+    if (hostOpen() != 0)
+        return 1;
+    benchEnd("initOpenDevice", 1);
+    benchMac();
+    benchVlan();
+    benchFilter();
+    benchBatchRun();
+    hostClose();
+    return hostResult("moduleBench");
+}
@@ -0,0 +1,100 @@
+/*
+ * regCacheTest.c - register reads of a VLAN port and segmentation save with
+ * the shadow register cache on and off. Built against switch_host_reg_cache
+ * (USE_REG_CACHE, apiInit enables the cache) the save is run once to fill the
+ * cache, again with the cache warm and again after msdRegCacheEnable(MSD_FALSE).
+ * The warm save must read at least ten times fewer registers from the switch
+ * and leave the same port registers. Built against switch_host the cache
+ * stays off and the same saves are counted for comparison.
+ */
+#include "hostTest.h"
+#include <deviceVlanModule.h>
+#include <devicePortSegmentationModule.h>
+#include <Fir_msdDrvSwRegs.h>
+
+#define CACHE_ROUNDS        4
+#define CACHE_PORT_REGS     16
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_U16 s_regsOn[MSD_MAX_SWITCH_PORTS][CACHE_PORT_REGS];
+static MSD_U16 s_regsOff[MSD_MAX_SWITCH_PORTS][CACHE_PORT_REGS];
+
+/* the per port VLAN settings and the port based VLAN map of every port, CACHE_ROUNDS times */
+static void cacheSave(void)
+{
+    int portNum = sohoDevGet(HOST_DEV)->numOfPorts;
+
+    for (int round = 0; round < CACHE_ROUNDS; ++round) {
+        HOST_CHECK_OK(deviceVlanModuleSet8021Mode(HOST_DEV, ALL_PORT_PARAM,
+                                                  round % 2 == 0 ? MSD_8021Q_SECURE : MSD_8021Q_CHECK));
+        for (int port = 0; port < portNum; ++port) {
+            HOST_CHECK_OK(deviceVlanModuleSetDefaultVlanId(HOST_DEV, (MSD_U8)port, (MSD_U16)(PORT_DEFAULT_VID + round)));
+        }
+        HOST_CHECK_OK(devicePortSegmentationModuleResetSegmentation(HOST_DEV));
+        HOST_CHECK_OK(devicePortSegmentationModuleSaveSegmentation(HOST_DEV));
+    }
+}
+
+/* reads of the save as counted by the simulator, hits of the cache during the save */
+static MSD_U32 cacheRun(MSD_U32* hits)
+{
+    MSD_SIM_STATS before, after;
+    MSD_U32 hitsBefore = 0, hitsAfter = 0, misses = 0;
+
+    HOST_CHECK_OK(msdRegCacheStatsGet(HOST_DEV, &hitsBefore, &misses));
+    msdSimStatsGet(&before);
+    cacheSave();
+    msdSimStatsGet(&after);
+    HOST_CHECK_OK(msdRegCacheStatsGet(HOST_DEV, &hitsAfter, &misses));
+    *hits = hitsAfter - hitsBefore;
+    return after.reads - before.reads;
+}
+
+static void cacheDump(MSD_U16 regs[MSD_MAX_SWITCH_PORTS][CACHE_PORT_REGS])
+{
+    int portNum = sohoDevGet(HOST_DEV)->numOfPorts;
+
+    HOST_CHECK_OK(msdRegCacheEnable(HOST_DEV, MSD_FALSE));
+    for (int port = 0; port < portNum; ++port) {
+        for (int reg = 0; reg < CACHE_PORT_REGS; ++reg)
+            HOST_CHECK_OK(msdGetAnyReg(HOST_DEV, (MSD_U8)(FIR_PORT_START_ADDR + port), (MSD_U8)reg, &regs[port][reg]));
+    }
+}
+
+int main(void)
+{
+    MSD_U32 hits = 0;
+
+    if (hostOpen() != 0)
+        return 1;
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    HOST_CHECK_OK(devicePortSegmentationModuleSetEnableSegmentation(HOST_DEV, MSD_TRUE));
+    /* the first save changes the registers left by the init, the second one is measured */
+    MSD_U32 firstReads = cacheRun(&hits);
+#ifdef USE_REG_CACHE
+    MSD_U32 onReads = cacheRun(&hits);
+    MSD_U32 onHits = hits;
+    cacheDump(s_regsOn);
+
+    /* the cache off, every read goes to the switch */
+    MSD_U32 offReads = cacheRun(&hits);
+    cacheDump(s_regsOff);
+    printf("save: %u reads the first time, %u with the cache and %u served from RAM, %u without the cache\n",
+           (unsigned)firstReads, (unsigned)onReads, (unsigned)onHits, (unsigned)offReads);
+    HOST_CHECK(hits == 0);
+    HOST_CHECK(onHits > 0);
+    HOST_CHECK(firstReads < offReads);
+    HOST_CHECK(onReads * 10 <= offReads);
+    HOST_CHECK(memcmp(s_regsOn, s_regsOff, sizeof(s_regsOn)) == 0);
+#else
+    MSD_U32 offReads = cacheRun(&hits);
+    printf("save: %u reads the first time, %u after, built without USE_REG_CACHE\n", (unsigned)firstReads,
+           (unsigned)offReads);
+    HOST_CHECK(hits == 0);
+    (void)s_regsOn;
+    (void)s_regsOff;
+#endif
+    hostClose();
+    return hostResult("regCacheTest");
+}
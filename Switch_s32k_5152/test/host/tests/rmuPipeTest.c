@@ -0,0 +1,368 @@
+/*
+ * rmuPipeTest.c - the pipelined RMU engine (msdRmuPipeBegin/Submit/End) on a
+ * loopback link. rmu_tx queues the request frames, rmu_rx answers them from
+ * the simulator in the order the link chooses: in order, newest first, with
+ * a frame lost so the engine sends the requests in flight again, or with a
+ * frame answered late so a duplicate answer arrives, also in the next
+ * session. Each request reads one register and must complete exactly once
+ * with its own value. Two tasks that open a session at the same time are
+ * serialized on the device semaphore.
+ */
+#include "hostTest.h"
+#include <msdHwAccess.h>
+#include <semphr.h>
+
+#define PIPE_PORT           9
+#define PIPE_FIRST_REG      0x11
+#define PIPE_REQUESTS       10
+#define PIPE_QUEUE          16
+#define PIPE_WIRE_TICKS     1       /* one response frame on the wire, in the task test */
+#define PIPE_SEM_BASE       0x1000U
+#define PIPE_SEM_MAX        2
+
+typedef enum { LINK_IN_ORDER, LINK_NEWEST_FIRST } LinkOrder;
+
+typedef struct {
+    MSD_U8 frame[MSD_RMU_PIPE_REQ_SIZE];
+    MSD_U32 len;
+} LinkFrame;
+
+typedef struct {
+    MSD_U16 expect;
+    MSD_U16 value;
+    MSD_STATUS status;
+    int calls;
+} PipeRequest;
+
+typedef struct {
+    MSD_STATUS begin;
+    MSD_STATUS end;
+    TickType_t beginTick;
+    TickType_t endTick;
+    PipeRequest requests[3];
+} PipeSession;
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static LinkFrame s_queue[PIPE_QUEUE];
+static int s_queued = 0;
+static LinkOrder s_order = LINK_IN_ORDER;
+static int s_dropIndex = -1;        /* transmission lost on the link, counted from the first one */
+static int s_lateIndex = -1;        /* transmission answered only after the next timeout */
+static LinkFrame s_late;
+static MSD_BOOL s_lateHeld = MSD_FALSE;
+static MSD_BOOL s_dropAll = MSD_FALSE;
+static MSD_U8 s_dropSeq;            /* with s_dropAll, every transmission of this SeqNum is lost */
+static int s_txCount = 0;
+static int s_maxQueued = 0;
+static TickType_t s_wireTicks = 0;
+static MSD_RMU_TX_RX_PAK s_simTxRx;
+
+static SemaphoreHandle_t s_taskSems[PIPE_SEM_MAX];
+static int s_taskSemCount = 0;
+static PipeSession s_sessions[2];
+
+static MSD_U32 pipeSeqOffset(MSD_QD_DEV* dev)
+{
+    return dev->rmuMode == MSD_RMU_ETHERT_TYPE_DSA_MODE ? 19U : 15U;
+}
+
+static MSD_STATUS linkTx(MSD_U8* reqPkt, MSD_U32 reqPktLen)
+{
+    MSD_QD_DEV* dev = sohoDevGet(HOST_DEV);
+    int index = s_txCount++;
+    if (index == s_dropIndex || (s_dropAll && reqPkt[pipeSeqOffset(dev)] == s_dropSeq))
+        return MSD_OK;
+    if (index == s_lateIndex) {
+        memcpy(s_late.frame, reqPkt, reqPktLen);
+        s_late.len = reqPktLen;
+        s_lateHeld = MSD_TRUE;
+        return MSD_OK;
+    }
+    if (s_queued == PIPE_QUEUE)
+        return MSD_FAIL;
+    memcpy(s_queue[s_queued].frame, reqPkt, reqPktLen);
+    s_queue[s_queued].len = reqPktLen;
+    s_queued++;
+    if (s_queued > s_maxQueued)
+        s_maxQueued = s_queued;
+    return MSD_OK;
+}
+
+/* the switch answers the chosen queued request */
+static MSD_STATUS linkRx(MSD_U8* rspPkt, MSD_U32* rspPktLen, MSD_U32 timeOut)
+{
+    if (s_queued == 0) {
+        vTaskDelay(pdMS_TO_TICKS(timeOut));
+        /* the held frame arrives behind the timeout and meets the resent request */
+        if (s_lateHeld) {
+            s_queue[s_queued++] = s_late;
+            s_lateHeld = MSD_FALSE;
+        }
+        return MSD_FAIL;
+    }
+    int index = s_order == LINK_IN_ORDER ? 0 : s_queued - 1;
+    LinkFrame frame = s_queue[index];
+    memmove(&s_queue[index], &s_queue[index + 1], sizeof(LinkFrame) * (size_t)(s_queued - index - 1));
+    s_queued--;
+    if (s_wireTicks != 0)
+        vTaskDelay(s_wireTicks);
+
+    MSD_U8* rsp = rspPkt;
+    MSD_U32 len = 0;
+    if (s_simTxRx(frame.frame, frame.len, &rsp, &len) != MSD_OK || len > *rspPktLen)
+        return MSD_FAIL;
+    *rspPktLen = len;
+    return MSD_OK;
+}
+
+/* frames still on the link stay queued */
+static void linkReset(LinkOrder order)
+{
+    s_order = order;
+    s_dropIndex = -1;
+    s_lateIndex = -1;
+    s_lateHeld = MSD_FALSE;
+    s_dropAll = MSD_FALSE;
+    s_txCount = 0;
+    s_maxQueued = 0;
+}
+
+static MSD_U16 pipeValue(int i)
+{
+    return (MSD_U16)(0xC300 | i);
+}
+
+static void pipeDone(MSD_U8 devNum, MSD_STATUS status, MSD_U8* rspPkt, MSD_U32 rspPktLen, void* arg)
+{
+    PipeRequest* request = (PipeRequest*)arg;
+    MSD_QD_DEV* dev = sohoDevGet(devNum);
+    MSD_U32 offset = MSD_RMU_PACKET_PREFIX_SIZE - (dev->rmuMode == MSD_RMU_DSA_MODE ? 4U : 0U) + 2U;
+
+    request->calls++;
+    request->status = status;
+    if (status == MSD_OK && rspPktLen >= offset + 2U)
+        request->value = (MSD_U16)((rspPkt[offset] << 8) | rspPkt[offset + 1]);
+}
+
+/* one MSD_RegRW frame reading register PIPE_FIRST_REG + i of the port, returns its SeqNum */
+static MSD_U8 pipeSubmit(int i, PipeRequest* request, MSD_STATUS expect)
+{
+    MSD_QD_DEV* dev = sohoDevGet(HOST_DEV);
+    MSD_Packet packet;
+    MSD_U8 frame[MSD_RMU_PIPE_REQ_SIZE];
+    MSD_U32 delta = dev->rmuMode == MSD_RMU_DSA_MODE ? 4U : 0U;
+
+    memset(request, 0, sizeof(*request));
+    request->expect = pipeValue(i);
+    HOST_CHECK_OK(msdRmuReqPktCreate(dev, MSD_RegRW, &packet));
+    packet.reqData._regRWData.nCmd = 1;
+    packet.reqData._regRWData.regCmd[0].devAddr = PIPE_PORT;
+    packet.reqData._regRWData.regCmd[0].regAddr = (MSD_U8)(PIPE_FIRST_REG + i);
+    packet.reqData._regRWData.regCmd[0].isWaitOnBit = MSD_RMU_WAIT_ON_BIT_FALSE;
+    packet.reqData._regRWData.regCmd[0].opCode = MSD_RMU_REQ_OPCODE_READ;
+    memset(frame, 0, sizeof(frame));
+    HOST_CHECK_OK(msdRmuPackEthReqPkt(&packet, MSD_RegRW, frame));
+    HOST_CHECK(msdRmuPipeSubmit(HOST_DEV, frame, MSD_RMU_PACKET_PREFIX_SIZE - delta + 2U * MSD_RMU_REGCMD_WORD_SIZE,
+                                pipeDone, request) == expect);
+    return frame[pipeSeqOffset(dev)];
+}
+
+static void pipeCheck(const PipeRequest* requests, int count, int failed)
+{
+    for (int i = 0; i < count; ++i) {
+        HOST_CHECK(requests[i].calls == 1);
+        if (i == failed) {
+            HOST_CHECK(requests[i].status == MSD_FAIL);
+            continue;
+        }
+        HOST_CHECK(requests[i].status == MSD_OK);
+        HOST_CHECK(requests[i].value == requests[i].expect);
+    }
+}
+
+/* every request completes once with its own register, whatever order the responses come in */
+static void pipeOrder(LinkOrder order, int dropIndex, int lateIndex)
+{
+    PipeRequest requests[PIPE_REQUESTS];
+
+    linkReset(order);
+    s_dropIndex = dropIndex;
+    s_lateIndex = lateIndex;
+    HOST_CHECK_OK(msdRmuPipeBegin(HOST_DEV));
+    for (int i = 0; i < PIPE_REQUESTS; ++i)
+        (void)pipeSubmit(i, &requests[i], MSD_OK);
+    HOST_CHECK_OK(msdRmuPipeEnd(HOST_DEV));
+    pipeCheck(requests, PIPE_REQUESTS, -1);
+    printf("%s%s%s: %d frames sent for %d requests, at most %d in flight\n",
+           order == LINK_IN_ORDER ? "in order" : "newest first", dropIndex >= 0 ? ", one frame lost" : "",
+           lateIndex >= 0 ? ", one frame late" : "", s_txCount, PIPE_REQUESTS, s_maxQueued);
+    HOST_CHECK(s_maxQueued <= (int)MSD_RMU_PIPE_DEPTH + 1);
+    if (dropIndex < 0 && lateIndex < 0)
+        HOST_CHECK(s_txCount == PIPE_REQUESTS);
+    else
+        HOST_CHECK(s_txCount > PIPE_REQUESTS);
+    /* the answer to the resent request completed it, the late one is still on the link */
+    HOST_CHECK(s_queued == (lateIndex >= 0 ? 1 : 0));
+}
+
+/* a late answer from the last session matches nothing and is dropped */
+static void pipeStale(void)
+{
+    PipeRequest requests[3];
+
+    HOST_CHECK(s_queued == 1);
+    linkReset(LINK_IN_ORDER);
+    HOST_CHECK_OK(msdRmuPipeBegin(HOST_DEV));
+    for (int i = 0; i < 3; ++i)
+        (void)pipeSubmit(i, &requests[i], MSD_OK);
+    HOST_CHECK_OK(msdRmuPipeEnd(HOST_DEV));
+    pipeCheck(requests, 3, -1);
+    HOST_CHECK(s_txCount == 3);
+    HOST_CHECK(s_queued == 0);
+}
+
+/* a request whose frames are always lost fails after its retries, the others still complete */
+static void pipeLost(void)
+{
+    PipeRequest requests[PIPE_REQUESTS];
+    int lost = 3;
+
+    linkReset(LINK_IN_ORDER);
+    HOST_CHECK_OK(msdRmuPipeBegin(HOST_DEV));
+    for (int i = 0; i < PIPE_REQUESTS; ++i) {
+        if (i == lost) {
+            /* the SeqNum of the next request is known before it is sent */
+            s_dropSeq = (MSD_U8)sohoDevGet(HOST_DEV)->reqSeqNum;
+            s_dropAll = MSD_TRUE;
+        }
+        (void)pipeSubmit(i, &requests[i], MSD_OK);
+    }
+    HOST_CHECK(msdRmuPipeEnd(HOST_DEV) == MSD_FAIL);
+    pipeCheck(requests, PIPE_REQUESTS, lost);
+    /* the session is closed, a new one opens; the device semaphore does not block here, so a nested call reaches the active check */
+    linkReset(LINK_IN_ORDER);
+    HOST_CHECK_OK(msdRmuPipeBegin(HOST_DEV));
+    HOST_CHECK(msdRmuPipeBegin(HOST_DEV) == MSD_FAIL);
+    (void)pipeSubmit(0, &requests[0], MSD_OK);
+    HOST_CHECK_OK(msdRmuPipeEnd(HOST_DEV));
+    pipeCheck(requests, 1, -1);
+}
+
+/* the device semaphore is a host mutex so a second session blocks */
+static MSD_SEM taskSemCreate(MSD_SEM_BEGIN_STATE state)
+{
+    if (s_taskSemCount == PIPE_SEM_MAX)
+        return 0;
+    SemaphoreHandle_t sem = xSemaphoreCreateMutex();
+    if (state == MSD_SEM_EMPTY)
+        (void)xSemaphoreTake(sem, 0);
+    s_taskSems[s_taskSemCount] = sem;
+    return PIPE_SEM_BASE + (MSD_SEM)s_taskSemCount++;
+}
+
+static MSD_STATUS taskSemDelete(MSD_SEM smid)
+{
+    if (smid >= PIPE_SEM_BASE)
+        vSemaphoreDelete(s_taskSems[smid - PIPE_SEM_BASE]);
+    return MSD_OK;
+}
+
+/* the other semaphores of the device were created without OS semaphores in the host build */
+static MSD_STATUS taskSemTake(MSD_SEM smid, MSD_U32 timeOut)
+{
+    if (smid < PIPE_SEM_BASE)
+        return MSD_OK;
+    TickType_t wait = timeOut == OS_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeOut);
+    return xSemaphoreTake(s_taskSems[smid - PIPE_SEM_BASE], wait) == pdTRUE ? MSD_OK : MSD_FAIL;
+}
+
+static MSD_STATUS taskSemGive(MSD_SEM smid)
+{
+    if (smid < PIPE_SEM_BASE)
+        return MSD_OK;
+    return xSemaphoreGive(s_taskSems[smid - PIPE_SEM_BASE]) == pdTRUE ? MSD_OK : MSD_FAIL;
+}
+
+static void pipeSessionProc(void* param)
+{
+    PipeSession* session = (PipeSession*)param;
+    if (session == &s_sessions[1])
+        vTaskDelay(PIPE_WIRE_TICKS);
+    session->begin = msdRmuPipeBegin(HOST_DEV);
+    session->beginTick = xTaskGetTickCount();
+    if (session->begin != MSD_OK)
+        return;
+    for (int i = 0; i < 3; ++i)
+        (void)pipeSubmit(i, &session->requests[i], MSD_OK);
+    session->end = msdRmuPipeEnd(HOST_DEV);
+    session->endTick = xTaskGetTickCount();
+}
+
+/* a session opened while another task's session is active waits for it instead of failing */
+static void pipeTwoTasks(MSD_QD_DEV* dev)
+{
+    MSD_SEM oldSem = dev->multiAddrSem;
+    MSD_FMSD_SEM_CREATE oldCreate = dev->semCreate;
+    MSD_FMSD_SEM_DELETE oldDelete = dev->semDelete;
+    MSD_FMSD_SEM_TAKE oldTake = dev->semTake;
+    MSD_FMSD_SEM_GIVE oldGive = dev->semGive;
+
+    dev->semCreate = taskSemCreate;
+    dev->semDelete = taskSemDelete;
+    dev->semTake = taskSemTake;
+    dev->semGive = taskSemGive;
+    dev->multiAddrSem = msdSemCreate(HOST_DEV, MSD_SEM_FULL);
+
+    linkReset(LINK_IN_ORDER);
+    s_wireTicks = PIPE_WIRE_TICKS;
+    memset(s_sessions, 0, sizeof(s_sessions));
+    HOST_CHECK(xTaskCreate(pipeSessionProc, "pipeA", 512, &s_sessions[0], 1, NULL) == pdPASS);
+    HOST_CHECK(xTaskCreate(pipeSessionProc, "pipeB", 512, &s_sessions[1], 1, NULL) == pdPASS);
+    hostTaskRun(20 * PIPE_WIRE_TICKS);
+    s_wireTicks = 0;
+
+    printf("two tasks: A %u..%u, B %u..%u\n", (unsigned)s_sessions[0].beginTick, (unsigned)s_sessions[0].endTick,
+           (unsigned)s_sessions[1].beginTick, (unsigned)s_sessions[1].endTick);
+    for (int t = 0; t < 2; ++t) {
+        HOST_CHECK(s_sessions[t].begin == MSD_OK);
+        HOST_CHECK(s_sessions[t].end == MSD_OK);
+        pipeCheck(s_sessions[t].requests, 3, -1);
+    }
+    HOST_CHECK(s_sessions[1].beginTick >= s_sessions[0].endTick);
+
+    (void)msdSemDelete(HOST_DEV, dev->multiAddrSem);
+    dev->multiAddrSem = oldSem;
+    dev->semCreate = oldCreate;
+    dev->semDelete = oldDelete;
+    dev->semTake = oldTake;
+    dev->semGive = oldGive;
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    MSD_QD_DEV* dev = sohoDevGet(HOST_DEV);
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    for (int i = 0; i < PIPE_REQUESTS; ++i)
+        HOST_CHECK_OK(msdSetAnyReg(HOST_DEV, PIPE_PORT, (MSD_U8)(PIPE_FIRST_REG + i), pipeValue(i)));
+
+    s_simTxRx = dev->rmu_tx_rx;
+    dev->rmu_tx = linkTx;
+    dev->rmu_rx = linkRx;
+
+    pipeOrder(LINK_IN_ORDER, -1, -1);
+    pipeOrder(LINK_NEWEST_FIRST, -1, -1);
+    pipeOrder(LINK_IN_ORDER, 2, -1);
+    pipeOrder(LINK_NEWEST_FIRST, 5, -1);
+    pipeOrder(LINK_IN_ORDER, -1, 4);
+    pipeStale();
+    pipeLost();
+    pipeTwoTasks(dev);
+
+    dev->rmu_tx = NULL;
+    dev->rmu_rx = NULL;
+    hostClose();
+    return hostResult("rmuPipeTest");
+}
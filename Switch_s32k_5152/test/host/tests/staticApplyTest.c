@@ -0,0 +1,166 @@
+/*
+ * staticApplyTest.c - deviceAtuModuleApplyStaticConfiguration. A second apply
+ * of the same configuration only reads the switch, a changed port of one
+ * entry writes that entry only, a static entry that is gone from the switch
+ * is swept from the memory index, and more statics in the switch than the
+ * diff can read fall back to a flush and rewrite. The ATU operations of the
+ * apply are counted by the simulator and must match the reported GetNext
+ * operations plus the writes.
+ */
+#include "hostTest.h"
+#include <deviceMacModule.h>
+
+#define APPLY_VID           10
+#define APPLY_ENTRIES       16
+#define APPLY_EDIT          5
+#define APPLY_SWEEP_MAC     0x800
+#define APPLY_EXTRA_MAC     0x900
+#define APPLY_EXTRA         (MAX_STATIC_ATU_ENTRIES * 2 + 1)     /* more than the diff reads */
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_ATU_ENTRY s_list[MAX_AUTO_ATU_ENTRIES];
+
+static MSD_U32 applyPortVec(int index)
+{
+    return 1U << (1 + index % 8);
+}
+
+/* applies the configuration, returns the ATU operations the simulator counted */
+static MSD_U32 applyRun(AtuApplyStats* stats)
+{
+    MSD_SIM_STATS before, after;
+    msdSimStatsGet(&before);
+    HOST_CHECK_OK(deviceAtuModuleApplyStaticConfiguration(HOST_DEV, stats));
+    msdSimStatsGet(&after);
+    HOST_CHECK_OK(deviceAtuModuleCheckConsistency(HOST_DEV));
+    return after.atuOps - before.atuOps;
+}
+
+/* the static entries of the switch match the configuration */
+static void applyCheckSwitch(int count)
+{
+    int listCount = 0;
+    HOST_CHECK_OK(deviceAtuModuleGetList(HOST_DEV, ATU_ENTRY_TYPE_STATIC, s_list, MAX_AUTO_ATU_ENTRIES, &listCount));
+    HOST_CHECK(listCount == count);
+    for (int i = 0; i < listCount; ++i) {
+        int index = ((int)s_list[i].macAddr.arEther[4] << 8) | s_list[i].macAddr.arEther[5];
+        HOST_CHECK(index < APPLY_ENTRIES);
+        HOST_CHECK(s_list[i].fid == APPLY_VID);
+        HOST_CHECK(s_list[i].portVec == (index == APPLY_EDIT ? 1U : applyPortVec(index)));
+    }
+}
+
+static void applyBuild(void)
+{
+    MSD_ETHERADDR mac;
+    HOST_CHECK_OK(deviceAtuModuleClearAllVidStaticEntriesFromConfiguration(HOST_DEV));
+    for (int i = 0; i < APPLY_ENTRIES; ++i) {
+        hostMac(&mac, (MSD_U32)i);
+        HOST_CHECK_OK(deviceAtuModuleAddMacStaticEntryToConfiguration(HOST_DEV, mac, APPLY_VID, applyPortVec(i)));
+    }
+}
+
+/* the first apply adds everything, the same configuration again writes nothing */
+static void applyNoChange(void)
+{
+    AtuApplyStats stats;
+
+    applyBuild();
+    MSD_U32 ops = applyRun(&stats);
+    HOST_CHECK(stats.addCount == APPLY_ENTRIES);
+    HOST_CHECK(stats.deleteCount == 0 && stats.modifyCount == 0 && stats.sweepCount == 0);
+    HOST_CHECK(stats.isFullRewrite == MSD_FALSE);
+    /* each add looks the entry up once before loading it */
+    HOST_CHECK(ops == stats.getNextOps + APPLY_ENTRIES);
+
+    ops = applyRun(&stats);
+    printf("no change: %u GetNext operations, %u ATU operations\n", (unsigned)stats.getNextOps, (unsigned)ops);
+    HOST_CHECK(stats.addCount == 0 && stats.deleteCount == 0 && stats.modifyCount == 0 && stats.sweepCount == 0);
+    HOST_CHECK(stats.getNextOps > APPLY_ENTRIES);
+    HOST_CHECK(stats.dumpFrames == 0);
+    HOST_CHECK(ops == stats.getNextOps);
+}
+
+/* one entry moves to port 0 */
+static void applyOneChange(void)
+{
+    AtuApplyStats stats;
+    MSD_ETHERADDR mac;
+    MSD_BOOL found = MSD_FALSE;
+
+    hostMac(&mac, APPLY_EDIT);
+    HOST_CHECK_OK(deviceAtuModuleRemoveMacStaticEntryFromConfiguration(HOST_DEV, mac, APPLY_VID, &found));
+    HOST_CHECK(found == MSD_TRUE);
+    HOST_CHECK_OK(deviceAtuModuleAddMacStaticEntryToConfiguration(HOST_DEV, mac, APPLY_VID, 1U));
+    MSD_U32 ops = applyRun(&stats);
+    printf("one change: %u GetNext operations, %u ATU operations\n", (unsigned)stats.getNextOps, (unsigned)ops);
+    HOST_CHECK(stats.modifyCount == 1);
+    HOST_CHECK(stats.addCount == 0 && stats.deleteCount == 0 && stats.sweepCount == 0);
+    HOST_CHECK(ops == stats.getNextOps + 1);
+    applyCheckSwitch(APPLY_ENTRIES);
+}
+
+/* a static entry deleted from the switch behind the module is swept from the index */
+static void applySweep(void)
+{
+    AtuApplyStats stats;
+    MSD_ATU_ENTRY entry;
+
+    memset(&entry, 0, sizeof(entry));
+    hostMac(&entry.macAddr, APPLY_SWEEP_MAC);
+    entry.fid = APPLY_VID;
+    entry.portVec = 1U << 2;
+    entry.entryState = 0xE;
+    HOST_CHECK_OK(deviceAtuModuleAddEntry(HOST_DEV, &entry));
+    HOST_CHECK_OK(msdFdbMacEntryDelete(HOST_DEV, &entry.macAddr, APPLY_VID));
+
+    MSD_U32 ops = applyRun(&stats);
+    HOST_CHECK(stats.sweepCount == 1);
+    HOST_CHECK(stats.addCount == 0 && stats.deleteCount == 0 && stats.modifyCount == 0);
+    HOST_CHECK(ops == stats.getNextOps);
+    MSD_ATU_ENTRY found;
+    MSD_BOOL isFound = MSD_TRUE;
+    HOST_CHECK_OK(deviceAtuModuleFindEntry(HOST_DEV, APPLY_VID, &entry.macAddr, &found, &isFound));
+    HOST_CHECK(isFound == MSD_FALSE);
+}
+
+/* more statics in the switch than the diff reads, the apply flushes and rewrites them */
+static void applyRewrite(void)
+{
+    AtuApplyStats stats;
+    MSD_ATU_ENTRY entry;
+
+    for (int i = 0; i < APPLY_EXTRA; ++i) {
+        memset(&entry, 0, sizeof(entry));
+        hostMac(&entry.macAddr, APPLY_EXTRA_MAC + (MSD_U32)i);
+        entry.fid = APPLY_VID;
+        entry.portVec = 1U << 3;
+        entry.entryState = 0xE;
+        HOST_CHECK_OK(msdFdbMacEntryAdd(HOST_DEV, &entry));
+    }
+    MSD_U32 ops = applyRun(&stats);
+    printf("rewrite: %u GetNext operations, %u ATU operations\n", (unsigned)stats.getNextOps, (unsigned)ops);
+    HOST_CHECK(stats.isFullRewrite == MSD_TRUE);
+    HOST_CHECK(stats.addCount == APPLY_ENTRIES);
+    HOST_CHECK(stats.getNextOps >= 2 * MAX_STATIC_ATU_ENTRIES);
+    applyCheckSwitch(APPLY_ENTRIES);
+
+    /* back on the diff path */
+    applyRun(&stats);
+    HOST_CHECK(stats.isFullRewrite == MSD_FALSE);
+    HOST_CHECK(stats.addCount == 0 && stats.deleteCount == 0 && stats.modifyCount == 0 && stats.sweepCount == 0);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    applyNoChange();
+    applyOneChange();
+    applySweep();
+    applyRewrite();
+    hostClose();
+    return hostResult("staticApplyTest");
+}
@@ -0,0 +1,247 @@
+/*
+ * tcamSlotTest.c - the in-RAM ingress TCAM slot table under filter churn.
+ * Random filter adds, modifies (a new type changes the entry count),
+ * removes, clears and defrags are run, and after every transaction the
+ * slot table must match the switch: a slot is used exactly when the
+ * switch holds a valid entry there, and every filter-owned slot belongs
+ * to a filter that exists.
+ * The bus cost of each new filter is counted: an add that does not have to
+ * reorganize the TCAM only loads its entries (3 page loads and 4 busy bit
+ * waits each) and never reads the TCAM. The old add path probed the TCAM
+ * with msdTcamEntryRead from entry 0 until it had found enough free
+ * entries, its cost is computed from the slot table before each add.
+ */
+#include "hostTest.h"
+#include <deviceFilterModule.h>
+#include <deviceTcamModule.h>
+
+#define SLOT_OPS        300
+#define SLOT_LOAD_OPS   3       /* TCAM operations to load one entry, one per page */
+#define SLOT_LOAD_WAITS 4       /* busy bit reads to load one entry */
+#define SLOT_PROBE_END  (FILTER_MAX_NUM * 4)    /* the old probe covered 4 entries per filter */
+
+static MSD_U32 s_seed = 7;
+static MSD_U32 s_nextKey = 0;
+
+static MSD_U32 slotRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+static DeviceFilter s_filters[FILTER_MAX_NUM];
+static int s_filterCount = 0;
+static FilterType s_lastType;
+
+/* bus cost of the adds which did not reorganize the TCAM, and of the old probe for the same adds */
+static MSD_SIM_STATS s_probeRead;
+static MSD_U32 s_plainAdds = 0, s_compactAdds = 0;
+static MSD_U32 s_addReads = 0, s_addTcamOps = 0;
+static MSD_U32 s_probeReads = 0, s_probeTcamOps = 0;
+
+static void slotLoadFilters(void)
+{
+    s_filterCount = 0;
+    HOST_CHECK_OK(deviceFilterModuleGetAllFilters(HOST_DEV, s_filters, FILTER_MAX_NUM, &s_filterCount));
+}
+
+static void slotCheck(int op)
+{
+    int filterSlots[FILTER_MAX_NUM] = { 0 };
+    MSD_U16 usedCount = 0;
+
+    slotLoadFilters();
+    for (MSD_U32 i = 0; i < TCAM_MODULE_ENTRY_NUM; ++i) {
+        TcamOwnerType ownerType = TCAM_OWNER_FREE;
+        MSD_U16 ownerId = 0;
+        MSD_TCAM_DATA data;
+        MSD_BOOL found = MSD_FALSE;
+        HOST_CHECK_OK(deviceTcamModuleGetOwner(HOST_DEV, i, &ownerType, &ownerId));
+        HOST_CHECK_OK(msdTcamEntryFind(HOST_DEV, i, &data, &found));
+        MSD_BOOL isUsed = ownerType != TCAM_OWNER_FREE ? MSD_TRUE : MSD_FALSE;
+        if (isUsed != found)
+            printf("operation %d: slot %u is %s in RAM but %s in the switch\n", op, (unsigned)i,
+                   isUsed ? "used" : "free", found ? "valid" : "invalid");
+        HOST_CHECK(isUsed == found);
+        if (isUsed)
+            usedCount++;
+        if (ownerType != TCAM_OWNER_FILTER)
+            continue;
+        HOST_CHECK(i < TCAM_MODULE_QINQ_START);
+        int index = 0;
+        while (index < s_filterCount && s_filters[index].filterId != ownerId)
+            index++;
+        if (index == s_filterCount)
+            printf("operation %d: slot %u belongs to filter %u which does not exist\n", op, (unsigned)i, (unsigned)ownerId);
+        HOST_CHECK(index < s_filterCount);
+        if (index < s_filterCount)
+            filterSlots[index]++;
+    }
+    for (int index = 0; index < s_filterCount; ++index) {
+        if (filterSlots[index] == 0)
+            printf("operation %d: filter %u owns no slot\n", op, (unsigned)s_filters[index].filterId);
+        HOST_CHECK(filterSlots[index] > 0);
+    }
+
+    TcamUsage usage;
+    HOST_CHECK_OK(deviceTcamModuleGetUsage(HOST_DEV, &usage));
+    HOST_CHECK(usage.usedCount == usedCount);
+    HOST_CHECK(usage.ownerCount[TCAM_OWNER_FREE] == TCAM_MODULE_ENTRY_NUM - usedCount);
+}
+
+/* add a new filter (id 0), or modify the given one with a new type and key */
+static MSD_STATUS slotAdd(MSD_U8 id, const char* name)
+{
+    FilterParam param;
+    FilterType type;
+    MSD_U32 key = s_nextKey++;
+
+    memset(&param, 0, sizeof(param));
+    switch (slotRandom(4)) {
+    case 0:
+        type = FILTER_TYPE_SECOND_LAYER;
+        hostMac((MSD_ETHERADDR*)param.secondLayerParam.destMacData, key);
+        memset(param.secondLayerParam.destMacMask, 0xFF, sizeof(param.secondLayerParam.destMacMask));
+        param.secondLayerParam.checkEtherFlag = CHECK_ETHER_DEST_MAC_FLAG;
+        break;
+    case 1:
+        type = FILTER_TYPE_IP_TCP_OR_UDP;
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.pktType = MSD_TCAM_TYPE_IPV4_TCP;
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.data.ipv4Tcp.tcp.destPort = (MSD_U16)(1000 + key);
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.mask.ipv4Tcp.tcp.destPort = 0xFFFF;
+        break;
+    case 2:
+        type = FILTER_TYPE_IP_TCP_OR_UDP;
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.pktType = MSD_TCAM_TYPE_IPV6_TCP;
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.data.ipv6Tcp.tcp.destPort = (MSD_U16)(1000 + key);
+        param.thirdAndAboveLayerParam.ipTcpOrUdpFilter.mask.ipv6Tcp.tcp.destPort = 0xFFFF;
+        break;
+    default:
+        type = FILTER_TYPE_ALL;
+        break;
+    }
+    s_lastType = type;
+    /* the ingress ports tell FILTER_TYPE_ALL filters apart */
+    return deviceFilterModuleAddFilter(HOST_DEV, id, name, (MSD_U16)(2U + (key % 0x3FDU)), EGRESS_TYPE_DROP, 0x4, type,
+                                       type == FILTER_TYPE_ALL ? NULL : &param);
+}
+
+/* the old probe stopped at the entry where it had found all the entries it needed */
+static MSD_U32 slotProbeCount(FilterType type)
+{
+    MSD_U32 need = type == FILTER_TYPE_IP_TCP_OR_UDP ? 4 : 2;
+    MSD_U32 found = 0;
+    for (MSD_U32 i = 0; i < SLOT_PROBE_END; ++i) {
+        TcamOwnerType ownerType = TCAM_OWNER_FREE;
+        MSD_U16 ownerId = 0;
+        HOST_CHECK_OK(deviceTcamModuleGetOwner(HOST_DEV, i, &ownerType, &ownerId));
+        if (ownerType == TCAM_OWNER_FREE && ++found == need)
+            return i + 1;
+    }
+    return SLOT_PROBE_END;
+}
+
+static MSD_STATUS slotAddNew(int op, const char* name)
+{
+    MSD_SIM_STATS before, after;
+    TcamUsage usageBefore, usageAfter;
+
+    /* slotAdd picks the type, so the old probe length is computed for each type before the add */
+    MSD_U32 probes[FILTER_TYPE_ALL + 1];
+    probes[FILTER_TYPE_ALL] = slotProbeCount(FILTER_TYPE_ALL);
+    probes[FILTER_TYPE_IP_TCP_OR_UDP] = slotProbeCount(FILTER_TYPE_IP_TCP_OR_UDP);
+    probes[FILTER_TYPE_SECOND_LAYER] = probes[FILTER_TYPE_ALL];
+    HOST_CHECK_OK(deviceTcamModuleGetUsage(HOST_DEV, &usageBefore));
+    msdSimStatsGet(&before);
+    MSD_STATUS ret = slotAdd(0, name);
+    msdSimStatsGet(&after);
+    HOST_CHECK_OK(deviceTcamModuleGetUsage(HOST_DEV, &usageAfter));
+    if (ret != MSD_OK)
+        return ret;
+
+    MSD_U32 entries = (MSD_U32)(usageAfter.usedCount - usageBefore.usedCount);
+    MSD_U32 reads = after.reads - before.reads;
+    MSD_U32 tcamOps = after.tcamOps - before.tcamOps;
+    if (tcamOps != SLOT_LOAD_OPS * entries) {
+        /* moved other filters first, a move reads the entries it moves */
+        s_compactAdds++;
+        return ret;
+    }
+    if (reads != SLOT_LOAD_WAITS * entries)
+        printf("operation %d: adding %u entries read %u registers\n", op, (unsigned)entries, (unsigned)reads);
+    HOST_CHECK(reads == SLOT_LOAD_WAITS * entries);
+    s_plainAdds++;
+    s_addReads += reads;
+    s_addTcamOps += tcamOps;
+    s_probeReads += probes[s_lastType] * s_probeRead.reads;
+    s_probeTcamOps += probes[s_lastType] * s_probeRead.tcamOps;
+    return ret;
+}
+
+static void slotOne(int op)
+{
+    MSD_U32 kind = slotRandom(40);
+    MSD_BOOL isFound = MSD_FALSE;
+    MSD_STATUS ret;
+
+    if (kind < 24 && (kind < 14 || s_filterCount == 0)) {
+        char name[FILTER_NUM_NAME_MAX_LEN];
+        snprintf(name, sizeof(name), "slot%u", (unsigned)s_nextKey);
+        ret = slotAddNew(op, name);
+        HOST_CHECK(ret == MSD_OK || (ret == MSD_NO_SPACE && s_filterCount == FILTER_MAX_NUM));
+    }
+    else if (kind < 24) {
+        DeviceFilter* filter = &s_filters[slotRandom((MSD_U32)s_filterCount)];
+        ret = slotAdd(filter->filterId, filter->filterName);
+        if (ret != MSD_OK && ret != MSD_NO_SPACE)
+            printf("operation %d: modifying filter %u returned %d\n", op, (unsigned)filter->filterId, (int)ret);
+        HOST_CHECK(ret == MSD_OK || ret == MSD_NO_SPACE);
+    }
+    else if (kind < 36) {
+        MSD_U8 id = s_filterCount > 0 ? s_filters[slotRandom((MSD_U32)s_filterCount)].filterId : 1;
+        HOST_CHECK_OK(deviceFilterModuleRemoveFilterById(HOST_DEV, id, &isFound));
+        HOST_CHECK(isFound == (s_filterCount > 0 ? MSD_TRUE : MSD_FALSE));
+    }
+    else if (kind < 39) {
+        int moveCount = 0;
+        HOST_CHECK_OK(deviceFilterModuleDefragTcam(HOST_DEV, &moveCount));
+    }
+    else {
+        HOST_CHECK_OK(deviceFilterModuleClearFilters(HOST_DEV));
+    }
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    HOST_CHECK_OK(deviceFilterModuleSetIsEnableFilter(HOST_DEV, MSD_TRUE));
+    /* one probe of the old add path */
+    MSD_SIM_STATS before;
+    MSD_TCAM_DATA data;
+    msdSimStatsGet(&before);
+    HOST_CHECK_OK(msdTcamEntryRead(HOST_DEV, 0, &data));
+    msdSimStatsGet(&s_probeRead);
+    s_probeRead.reads -= before.reads;
+    s_probeRead.tcamOps -= before.tcamOps;
+    slotCheck(0);
+    for (int op = 1; op <= SLOT_OPS; ++op) {
+        slotOne(op);
+        slotCheck(op);
+    }
+
+    TcamUsage usage;
+    HOST_CHECK_OK(deviceTcamModuleGetUsage(HOST_DEV, &usage));
+    printf("%d transactions: %u slots used, %u allocations, %u failed\n", SLOT_OPS, (unsigned)usage.usedCount,
+           (unsigned)usage.allocCount, (unsigned)usage.allocFailCount);
+    HOST_CHECK(s_plainAdds > 0);
+    if (s_plainAdds > 0) {
+        printf("%u adds (%u more reorganized the TCAM): %.1f TCAM operations and %.1f reads per add, "
+               "the old probe added %.1f TCAM operations and %.1f reads per add\n",
+               (unsigned)s_plainAdds, (unsigned)s_compactAdds, (double)s_addTcamOps / s_plainAdds,
+               (double)s_addReads / s_plainAdds, (double)s_probeTcamOps / s_plainAdds, (double)s_probeReads / s_plainAdds);
+    }
+    HOST_CHECK(s_addReads < s_probeReads);
+    hostClose();
+    return hostResult("tcamSlotTest");
+}
@@ -0,0 +1,41 @@
+/*
+ * telemetryStopTest.c - the MAC telemetry sampling task must be gone once
+ * deviceMacTelemetryModuleStop returns, so initCloseDevice can delete the
+ * device mutex the task samples under.
+ */
+#include "hostTest.h"
+#include <deviceMacTelemetryModule.h>
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    UBaseType_t baseTasks = hostTaskCount();
+
+    HOST_CHECK_OK(deviceMacTelemetryModuleStart(HOST_DEV, NULL));
+    HOST_CHECK(hostTaskCount() == baseTasks + 1);
+    HOST_CHECK_OK(deviceMacTelemetryModuleStop(HOST_DEV));
+    HOST_CHECK(hostTaskCount() == baseTasks);
+
+    /* both locks are released again */
+    HOST_CHECK(xSemaphoreTake(g_allDevicesConfig[HOST_DEV].xMutex, 0) == pdTRUE);
+    xSemaphoreGive(g_allDevicesConfig[HOST_DEV].xMutex);
+
+    /* stop twice, then restart with a new task */
+    HOST_CHECK_OK(deviceMacTelemetryModuleStop(HOST_DEV));
+    HOST_CHECK(hostTaskCount() == baseTasks);
+    HOST_CHECK_OK(deviceMacTelemetryModuleStart(HOST_DEV, NULL));
+    HOST_CHECK(hostTaskCount() == baseTasks + 1);
+    MacTelemetryStatus status;
+    HOST_CHECK_OK(deviceMacTelemetryModuleGetStatus(HOST_DEV, &status));
+    HOST_CHECK(status.isRunning == MSD_TRUE);
+
+    /* closing the device with sampling running deletes the task first */
+    hostClose();
+    HOST_CHECK(hostTaskCount() <= baseTasks);
+    HOST_CHECK_OK(deviceMacTelemetryModuleStop(HOST_DEV));
+
+    return hostResult("telemetryStopTest");
+}
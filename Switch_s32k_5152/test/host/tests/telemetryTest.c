@@ -0,0 +1,204 @@
+/*
+ * telemetryTest.c - the MAC telemetry sampling task, run on the cooperative
+ * host scheduler. Checks the sampling period, the learn rate computed from
+ * the history, the bus cost of one sample, that a sample is skipped while an
+ * API session holds the device (also when the session starts while the task
+ * waits for the device mutex) and the MAC flap detection.
+ */
+#include "hostTest.h"
+#include <deviceMacTelemetryModule.h>
+#include <deviceVlanModule.h>
+
+#define TELEMETRY_PORT          1
+#define TELEMETRY_INTERVAL_MS   100
+#define TELEMETRY_WINDOW_MS     1000
+#define TELEMETRY_THRESHOLD     3
+#define TELEMETRY_MACS_PER_RUN  20
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static MSD_U32 s_nextMac = 0;
+
+static void telemetryStart(void)
+{
+    MacTelemetryConfig config = { TELEMETRY_INTERVAL_MS, TELEMETRY_WINDOW_MS, TELEMETRY_THRESHOLD };
+    HOST_CHECK_OK(deviceMacTelemetryModuleStart(HOST_DEV, &config));
+}
+
+static void telemetryStatus(MacTelemetryStatus* status)
+{
+    HOST_CHECK_OK(deviceMacTelemetryModuleGetStatus(HOST_DEV, status));
+}
+
+static void telemetryLearn(MSD_U32 count)
+{
+    MSD_ETHERADDR mac;
+    for (MSD_U32 i = 0; i < count; ++i) {
+        hostMac(&mac, s_nextMac++);
+        HOST_CHECK_OK(msdSimLearn(TELEMETRY_PORT, PORT_DEFAULT_VID, &mac));
+    }
+}
+
+/* one sample every interval, timestamped with the tick count */
+static void telemetrySampling(void)
+{
+    MacTelemetryStatus status;
+    MacTelemetrySample samples[MAC_TELEMETRY_HISTORY_SIZE];
+    int count = 0;
+
+    telemetryStart();
+    TickType_t start = xTaskGetTickCount();
+    hostTaskRun(pdMS_TO_TICKS(10 * TELEMETRY_INTERVAL_MS));
+    telemetryStatus(&status);
+    HOST_CHECK(status.sampleCount == 10);
+    HOST_CHECK(status.skippedSamples == 0);
+    HOST_CHECK_OK(deviceMacTelemetryModuleGetHistory(HOST_DEV, samples, MAC_TELEMETRY_HISTORY_SIZE, &count));
+    HOST_CHECK(count == 10);
+    for (int i = 0; i < count; ++i)
+        HOST_CHECK(samples[i].timestamp == start + (MSD_U32)(i + 1) * TELEMETRY_INTERVAL_MS);
+}
+
+/* 20 addresses per interval is 12000 a minute */
+static void telemetryLearnRate(void)
+{
+    MacTelemetryStatus status;
+
+    /* restarting wakes the task, which samples at once */
+    telemetryStart();
+    hostTaskRun(0);
+    for (int run = 0; run < 10; ++run) {
+        telemetryLearn(TELEMETRY_MACS_PER_RUN);
+        hostTaskRun(pdMS_TO_TICKS(TELEMETRY_INTERVAL_MS));
+    }
+    telemetryStatus(&status);
+    HOST_CHECK(status.sampleCount == 11);
+    HOST_CHECK(status.nonStaticCount == 10 * TELEMETRY_MACS_PER_RUN);
+    HOST_CHECK(status.ports[TELEMETRY_PORT].learnCount == 10 * TELEMETRY_MACS_PER_RUN);
+    HOST_CHECK(status.ports[TELEMETRY_PORT].learnedTotal == 10 * TELEMETRY_MACS_PER_RUN);
+    HOST_CHECK(status.ports[TELEMETRY_PORT].learnRate == TELEMETRY_MACS_PER_RUN * 60000 / TELEMETRY_INTERVAL_MS);
+    HOST_CHECK(status.ports[TELEMETRY_PORT + 1].learnRate == 0);
+    printf("learn rate: port %d %u/min, %u learned\n", TELEMETRY_PORT, (unsigned)status.ports[TELEMETRY_PORT].learnRate,
+           (unsigned)status.ports[TELEMETRY_PORT].learnedTotal);
+}
+
+/* bus cost of one sample: two ATU counts of 8 statistics bins each and a learn count read per port */
+static void telemetrySampleCost(void)
+{
+    MacTelemetryStatus status;
+    MSD_SIM_STATS before, after;
+
+    telemetryStatus(&status);
+    MSD_U32 sampleCount = status.sampleCount;
+    msdSimStatsGet(&before);
+    hostTaskRun(pdMS_TO_TICKS(TELEMETRY_INTERVAL_MS));
+    msdSimStatsGet(&after);
+    telemetryStatus(&status);
+    HOST_CHECK(status.sampleCount == sampleCount + 1);
+    printf("one sample: %u reads, %u writes, %u ATU operations, %.1f us\n", (unsigned)(after.reads - before.reads),
+           (unsigned)(after.writes - before.writes), (unsigned)(after.atuOps - before.atuOps),
+           (double)(after.clock - before.clock) / 1000.0);
+    HOST_CHECK(after.atuOps - before.atuOps == 2 * 8);
+    HOST_CHECK(after.reads - before.reads >= status.portCount);
+    HOST_CHECK(status.lastSampleCost <= status.maxSampleCost);
+    HOST_CHECK(status.avgSampleCost <= status.maxSampleCost);
+}
+
+/* no bus access while an API session holds the device */
+static void telemetrySkip(void)
+{
+    DeviceConfig* config = &g_allDevicesConfig[HOST_DEV];
+    MacTelemetryStatus status;
+    MSD_SIM_STATS before, after;
+
+    telemetryStatus(&status);
+    MSD_U32 sampleCount = status.sampleCount;
+    MSD_U32 skipped = status.skippedSamples;
+    msdSimStatsGet(&before);
+    HOST_CHECK_OK(initStartCallAPI(HOST_DEV));
+    hostTaskRun(pdMS_TO_TICKS(3 * TELEMETRY_INTERVAL_MS));
+    HOST_CHECK_OK(initStopCallAPI(HOST_DEV));
+    vTaskSuspend(config->eventLoopHandle);
+
+    /* the session starts while the task waits for the device mutex */
+    HOST_CHECK(xSemaphoreTake(config->xMutex, 0) == pdTRUE);
+    hostTaskRun(pdMS_TO_TICKS(TELEMETRY_INTERVAL_MS));
+    config->isCallAPI = MSD_TRUE;
+    xSemaphoreGive(config->xMutex);
+    hostTaskRun(pdMS_TO_TICKS(TELEMETRY_INTERVAL_MS / 2));
+    msdSimStatsGet(&after);
+    HOST_CHECK_OK(initStopCallAPI(HOST_DEV));
+    vTaskSuspend(config->eventLoopHandle);
+
+    telemetryStatus(&status);
+    HOST_CHECK(status.sampleCount == sampleCount);
+    HOST_CHECK(status.skippedSamples == skipped + 4);
+    HOST_CHECK(after.reads == before.reads);
+    HOST_CHECK(after.atuOps == before.atuOps);
+}
+
+static void telemetryMove(MSD_U8 port)
+{
+    MSD_ATU_INT_STATUS violation;
+    memset(&violation, 0, sizeof(violation));
+    hostMac(&violation.macAddr, 0xF1A9);
+    violation.fid = PORT_DEFAULT_VID;
+    violation.spid = port;
+    violation.atuIntCause.memberVio = MSD_TRUE;
+    HOST_CHECK_OK(deviceMacTelemetryModuleRecordViolation(HOST_DEV, &violation));
+}
+
+/* three port moves inside the window flag the address, a new window clears it */
+static void telemetryFlap(void)
+{
+    MacTelemetryStatus status;
+    MacFlapEntry flaps[MAC_TELEMETRY_FLAP_TABLE_SIZE];
+    int count = 0;
+
+    telemetryStart();
+    telemetryMove(1);
+    telemetryMove(2);
+    telemetryMove(1);
+    telemetryStatus(&status);
+    HOST_CHECK(status.moveCount == 2);
+    HOST_CHECK(status.flapEvents == 0);
+    telemetryMove(3);
+    telemetryStatus(&status);
+    HOST_CHECK(status.moveCount == 3);
+    HOST_CHECK(status.flapEvents == 1);
+    HOST_CHECK(status.memberViolations == 4);
+    HOST_CHECK(status.ports[1].memberViolations == 2);
+    HOST_CHECK_OK(deviceMacTelemetryModuleGetFlaps(HOST_DEV, flaps, MAC_TELEMETRY_FLAP_TABLE_SIZE, &count));
+    HOST_CHECK(count == 1);
+    HOST_CHECK(flaps[0].isFlapping == MSD_TRUE);
+    HOST_CHECK(flaps[0].moveCount == 3);
+    HOST_CHECK(flaps[0].portVec == ((1U << 1) | (1U << 2) | (1U << 3)));
+
+    hostTickAdvance(pdMS_TO_TICKS(TELEMETRY_WINDOW_MS + 1));
+    HOST_CHECK_OK(deviceMacTelemetryModuleGetFlaps(HOST_DEV, flaps, MAC_TELEMETRY_FLAP_TABLE_SIZE, &count));
+    HOST_CHECK(count == 1 && flaps[0].isFlapping == MSD_FALSE);
+    /* a single move in the new window does not flag it again */
+    telemetryMove(1);
+    telemetryStatus(&status);
+    HOST_CHECK(status.flapEvents == 1);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    /* only the sampling task touches the bus */
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    HOST_CHECK_OK(msdPortLearnEnableSet(HOST_DEV, (MSD_LPORT)TELEMETRY_PORT, MSD_TRUE));
+    /* the switch only counts learned addresses on a port with a learn limit */
+    HOST_CHECK_OK(msdFdbPortLearnLimitSet(HOST_DEV, (MSD_LPORT)TELEMETRY_PORT, 1000));
+
+    telemetrySampling();
+    telemetryLearnRate();
+    telemetrySampleCost();
+    telemetrySkip();
+    telemetryFlap();
+
+    HOST_CHECK_OK(deviceMacTelemetryModuleStop(HOST_DEV));
+    hostClose();
+    return hostResult("telemetryTest");
+}
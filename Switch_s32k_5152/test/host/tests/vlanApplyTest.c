@@ -0,0 +1,194 @@
+/*
+ * vlanApplyTest.c - the incremental apply of
+ * deviceVlanModuleSetVlanEgressModeAndMemberTagInfo. After a full apply an
+ * edit of one port only writes what changed: a memberTag change of one VID
+ * modifies that VTU entry, an egress mode change writes the port 802.1Q mode
+ * and the VIDs whose non member becomes unmodified. The counts come from
+ * deviceVlanModuleGetApplyStats, the VTU contents are read back from the
+ * switch. In QinQ mode the full apply counts the TCAM entries it deleted.
+ */
+#include "hostTest.h"
+#include <deviceTcamModule.h>
+#include <deviceVlanModule.h>
+
+#define APPLY_VIDS          8
+#define APPLY_EDIT_PORT     3
+#define APPLY_MODE_PORT     4
+
+extern DeviceConfig g_allDevicesConfig[MAX_SOHO_DEVICES];
+
+static VlanMemberTagAndEgressModeInfo s_info;
+
+static MSD_U16 applyVid(int index)
+{
+    return (MSD_U16)(10 + index * 10);
+}
+
+static MSD_PORT_MEMBER_TAG applyTag(int index, int port)
+{
+    return (MSD_PORT_MEMBER_TAG)((index + port) % 4);
+}
+
+static void applyBuild(void)
+{
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    int portNum = sohoDevGet(HOST_DEV)->numOfPorts;
+
+    memset(&s_info, 0, sizeof(s_info));
+    deviceVlanModuleVlanTableReset(&s_info);
+    for (int port = 0; port < portNum; ++port) {
+        s_info.portVlanInfo[port].defaultVid = PORT_DEFAULT_VID;
+        s_info.portVlanInfo[port].egressMode = VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP;
+    }
+    for (int i = 0; i < APPLY_VIDS; ++i) {
+        for (int port = 0; port < MSD_MAX_SWITCH_PORTS; ++port)
+            memberTag[port] = applyTag(i, port);
+        HOST_CHECK_OK(deviceVlanModuleVlanTableSet(&s_info, applyVid(i), memberTag, MSD_TRUE));
+    }
+}
+
+static void applyRun(VlanApplyStats* stats)
+{
+    HOST_CHECK_OK(deviceVlanModuleSetVlanEgressModeAndMemberTagInfo(HOST_DEV, &s_info));
+    HOST_CHECK_OK(deviceVlanModuleGetApplyStats(HOST_DEV, stats));
+}
+
+/* memberTag the switch should hold for a VID, port 0 is not set */
+static MSD_PORT_MEMBER_TAG applyExpectTag(int index, int port)
+{
+    if (port == 0)
+        return MSD_MEMBER_EGRESS_UNMODIFIED;
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    deviceVlanModuleVlanTableGetMemberTag(&s_info, index, memberTag);
+    if (memberTag[port] == MSD_NOT_A_MEMBER && s_info.portVlanInfo[port].egressMode == VLAN_EGRESS_MODE_ALLOW_ALL)
+        return MSD_MEMBER_EGRESS_UNMODIFIED;
+    return memberTag[port];
+}
+
+static void applyCheckVtu(void)
+{
+    int portNum = sohoDevGet(HOST_DEV)->numOfPorts;
+    for (int i = 0; i < (int)s_info.vidInfoSize; ++i) {
+        MSD_VTU_ENTRY entry;
+        MSD_BOOL found = MSD_FALSE;
+        memset(&entry, 0, sizeof(entry));
+        HOST_CHECK_OK(msdVlanEntryFind(HOST_DEV, s_info.vidInfo[i].vid, &entry, &found));
+        HOST_CHECK(found == MSD_TRUE);
+        HOST_CHECK(entry.fid == s_info.vidInfo[i].vid);
+        for (int port = 0; port < portNum; ++port)
+            HOST_CHECK(entry.memberTagP[port] == applyExpectTag(i, port));
+    }
+}
+
+static void applyCheckStats(const VlanApplyStats* stats, int adds, int modifies, int deletes, int portModes)
+{
+    HOST_CHECK(stats->isFullRebuild == MSD_FALSE);
+    HOST_CHECK(stats->vtuAdds == adds);
+    HOST_CHECK(stats->vtuModifies == modifies);
+    HOST_CHECK(stats->vtuDeletes == deletes);
+    HOST_CHECK(stats->vtuUnchanged == APPLY_VIDS - adds - modifies);
+    HOST_CHECK(stats->portModeWrites == portModes);
+    HOST_CHECK(stats->defaultVidWrites == 0);
+}
+
+static void applyCheckNoTcam(const VlanApplyStats* stats)
+{
+    HOST_CHECK(stats->ingressTcamWrites == 0 && stats->ingressTcamDeletes == 0);
+    HOST_CHECK(stats->egressTcamWrites == 0 && stats->egressTcamDeletes == 0);
+}
+
+static void applyOnePortEdit(VlanModel model)
+{
+    VlanApplyStats stats;
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    int portNum = sohoDevGet(HOST_DEV)->numOfPorts;
+
+    HOST_CHECK_OK(deviceVlanModuleSetQModeIsGlobal(HOST_DEV, MSD_TRUE, model));
+    applyBuild();
+    applyRun(&stats);
+    HOST_CHECK(stats.isFullRebuild == MSD_TRUE);
+    HOST_CHECK(stats.portModeWrites == portNum);
+    HOST_CHECK(stats.defaultVidWrites == portNum);
+    /* the QinQ ingress entries were not in use before, the three egress pointers are always cleared */
+    HOST_CHECK(stats.ingressTcamDeletes == 0);
+    HOST_CHECK(stats.egressTcamDeletes == 3);
+    applyCheckVtu();
+    printf("%s full apply: %u adds, %u deletes, %u port modes, %u ingress TCAM writes\n",
+           model == VLANMODEL_QINQ ? "QinQ" : "VLAN", (unsigned)stats.vtuAdds, (unsigned)stats.vtuDeletes,
+           (unsigned)stats.portModeWrites, (unsigned)stats.ingressTcamWrites);
+
+    /* the same setting again writes nothing */
+    applyRun(&stats);
+    applyCheckStats(&stats, 0, 0, 0, 0);
+    applyCheckNoTcam(&stats);
+
+    /* one port of one VID becomes tagged, in QinQ mode this also moves its untagged TCAM entries */
+    deviceVlanModuleVlanTableGetMemberTag(&s_info, 2, memberTag);
+    HOST_CHECK(memberTag[APPLY_EDIT_PORT] != MSD_MEMBER_EGRESS_TAGGED);
+    memberTag[APPLY_EDIT_PORT] = MSD_MEMBER_EGRESS_TAGGED;
+    HOST_CHECK_OK(deviceVlanModuleVlanTableSet(&s_info, applyVid(2), memberTag, MSD_TRUE));
+    applyRun(&stats);
+    applyCheckStats(&stats, 0, 1, 0, 0);
+    if (model == VLANMODEL_VLAN)
+        applyCheckNoTcam(&stats);
+    applyCheckVtu();
+
+    /* one port allows all VLANs, its non member VIDs become unmodified */
+    int nonMembers = 0;
+    for (int i = 0; i < APPLY_VIDS; ++i) {
+        deviceVlanModuleVlanTableGetMemberTag(&s_info, i, memberTag);
+        if (memberTag[APPLY_MODE_PORT] == MSD_NOT_A_MEMBER)
+            nonMembers++;
+    }
+    HOST_CHECK(nonMembers > 0);
+    s_info.portVlanInfo[APPLY_MODE_PORT].egressMode = VLAN_EGRESS_MODE_ALLOW_ALL;
+    applyRun(&stats);
+    applyCheckStats(&stats, 0, nonMembers, 0, 1);
+    if (model == VLANMODEL_VLAN)
+        applyCheckNoTcam(&stats);
+    applyCheckVtu();
+
+    /* one VID is removed */
+    HOST_CHECK(deviceVlanModuleVlanTableRemove(&s_info, applyVid(APPLY_VIDS - 1)) == MSD_TRUE);
+    applyRun(&stats);
+    HOST_CHECK(stats.isFullRebuild == MSD_FALSE);
+    HOST_CHECK(stats.vtuAdds == 0 && stats.vtuModifies == 0 && stats.vtuDeletes == 1);
+    HOST_CHECK(stats.vtuUnchanged == APPLY_VIDS - 1);
+    MSD_VTU_ENTRY entry;
+    MSD_BOOL found = MSD_TRUE;
+    HOST_CHECK_OK(msdVlanEntryFind(HOST_DEV, applyVid(APPLY_VIDS - 1), &entry, &found));
+    HOST_CHECK(found == MSD_FALSE);
+}
+
+/* a full QinQ apply after a QinQ setting deletes exactly the ingress entries in use */
+static void applyQinqRebuild(void)
+{
+    VlanApplyStats stats;
+    TcamUsage before, after;
+
+    HOST_CHECK_OK(deviceTcamModuleGetUsage(HOST_DEV, &before));
+    HOST_CHECK(before.ownerCount[TCAM_OWNER_QINQ] > 0);
+    /* setting the 802.1Q mode outside the apply forces the next apply to rebuild */
+    HOST_CHECK_OK(deviceVlanModuleSet8021Mode(HOST_DEV, ALL_PORT_PARAM, MSD_8021Q_CHECK));
+    applyRun(&stats);
+    HOST_CHECK(stats.isFullRebuild == MSD_TRUE);
+    HOST_CHECK(stats.ingressTcamDeletes == before.ownerCount[TCAM_OWNER_QINQ]);
+    HOST_CHECK(stats.egressTcamDeletes == 3);
+    HOST_CHECK_OK(deviceTcamModuleGetUsage(HOST_DEV, &after));
+    HOST_CHECK(stats.ingressTcamWrites == after.ownerCount[TCAM_OWNER_QINQ]);
+    printf("QinQ rebuild: %u ingress TCAM deletes, %u writes\n", (unsigned)stats.ingressTcamDeletes,
+           (unsigned)stats.ingressTcamWrites);
+    applyCheckVtu();
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    vTaskSuspend(g_allDevicesConfig[HOST_DEV].eventLoopHandle);
+    applyOnePortEdit(VLANMODEL_VLAN);
+    applyOnePortEdit(VLANMODEL_QINQ);
+    applyQinqRebuild();
+    hostClose();
+    return hostResult("vlanApplyTest");
+}
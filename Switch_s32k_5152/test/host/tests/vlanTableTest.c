@@ -0,0 +1,164 @@
+/*
+ * vlanTableTest.c - the VID indexed VLAN table of VlanMemberTagAndEgressModeInfo.
+ * Random VIDs are set, changed and removed through deviceVlanModuleVlanTableSet
+ * and deviceVlanModuleVlanTableRemove and checked against a reference array:
+ * deviceVlanModuleVlanTableFind returns the rank of every present VID, the
+ * records stay sorted by VID with their memberTag, and a new VID is refused
+ * once ALLOW_OPERATION_MAX_VLAN_NUM VIDs are present. The size of the table
+ * is printed for 64, 512 and 4096 VIDs.
+ */
+#include "hostTest.h"
+#include <deviceVlanModule.h>
+
+#define TABLE_OPS           40000
+#define TABLE_CHECK_EVERY   500
+
+/* the same layout as VlanMemberTagAndEgressModeInfo with vidCount records */
+#define VLAN_TABLE_LAYOUT(vidCount) struct { \
+    VlanPerPortVlanInfo portVlanInfo[MSD_MAX_SWITCH_PORTS]; \
+    MSD_U32 vidBits[VLAN_VID_BITMAP_WORDS]; \
+    MSD_U16 rankBase[VLAN_VID_BITMAP_WORDS]; \
+    VlanPerInfo vidInfo[vidCount]; \
+    MSD_U32 vidInfoSize; \
+}
+
+static VlanMemberTagAndEgressModeInfo s_info;
+static MSD_BOOL s_refPresent[MAX_VID_VALUE];
+static MSD_PORT_MEMBER_TAG s_refTag[MAX_VID_VALUE][MSD_MAX_SWITCH_PORTS];
+static MSD_BOOL s_refShow[MAX_VID_VALUE];
+static MSD_U32 s_refCount = 0;
+static MSD_U32 s_seed = 4242;
+
+static MSD_U32 tableRandom(MSD_U32 range)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return (s_seed >> 16) % range;
+}
+
+static void tableCheck(void)
+{
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    MSD_U32 rank = 0;
+
+    HOST_CHECK(s_info.vidInfoSize == s_refCount);
+    for (MSD_U32 vid = 0; vid < MAX_VID_VALUE; ++vid) {
+        int index = deviceVlanModuleVlanTableFind(&s_info, (MSD_U16)vid);
+        if (!s_refPresent[vid]) {
+            HOST_CHECK(index == -1);
+            continue;
+        }
+        HOST_CHECK(index == (int)rank);
+        if (index != (int)rank)
+            return;
+        HOST_CHECK(s_info.vidInfo[index].vid == vid);
+        HOST_CHECK(s_info.vidInfo[index].isShow == s_refShow[vid]);
+        deviceVlanModuleVlanTableGetMemberTag(&s_info, index, memberTag);
+        HOST_CHECK(memcmp(memberTag, s_refTag[vid], sizeof(memberTag)) == 0);
+        rank++;
+    }
+    /* the records after the last one are cleared */
+    for (MSD_U32 i = s_info.vidInfoSize; i < ALLOW_OPERATION_MAX_VLAN_NUM; ++i)
+        HOST_CHECK(s_info.vidInfo[i].vid == 0);
+}
+
+static void tableSet(MSD_U16 vid)
+{
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    MSD_BOOL isShow = tableRandom(4) != 0 ? MSD_TRUE : MSD_FALSE;
+
+    for (int port = 0; port < MSD_MAX_SWITCH_PORTS; ++port)
+        memberTag[port] = (MSD_PORT_MEMBER_TAG)tableRandom(4);
+    MSD_STATUS status = deviceVlanModuleVlanTableSet(&s_info, vid, memberTag, isShow);
+    if (!s_refPresent[vid] && s_refCount == ALLOW_OPERATION_MAX_VLAN_NUM) {
+        HOST_CHECK(status == MSD_FEATRUE_NOT_ALLOW);
+        return;
+    }
+    HOST_CHECK_OK(status);
+    if (!s_refPresent[vid])
+        s_refCount++;
+    s_refPresent[vid] = MSD_TRUE;
+    s_refShow[vid] = isShow;
+    memcpy(s_refTag[vid], memberTag, sizeof(memberTag));
+}
+
+static void tableRemove(MSD_U16 vid)
+{
+    HOST_CHECK(deviceVlanModuleVlanTableRemove(&s_info, vid) == s_refPresent[vid]);
+    if (s_refPresent[vid])
+        s_refCount--;
+    s_refPresent[vid] = MSD_FALSE;
+}
+
+/* the first present VID from vid on, vid itself when the table is empty */
+static MSD_U16 tablePresentFrom(MSD_U16 vid)
+{
+    for (MSD_U32 i = 0; i < MAX_VID_VALUE && s_refCount != 0; ++i) {
+        MSD_U16 next = (MSD_U16)((vid + i) % MAX_VID_VALUE);
+        if (s_refPresent[next])
+            return next;
+    }
+    return vid;
+}
+
+/* inserts dominate in the first half and fill the table, removes of present VIDs dominate in the second half */
+static void tableRandomRun(void)
+{
+    MSD_U32 full = 0;
+    for (int op = 0; op < TABLE_OPS; ++op) {
+        MSD_U16 vid = (MSD_U16)(PORT_DEFAULT_VID + tableRandom(MAX_OPERATION_VID - PORT_DEFAULT_VID + 1));
+        if (op < TABLE_OPS / 2 ? tableRandom(4) != 0 : tableRandom(3) == 0)
+            tableSet(vid);
+        else
+            tableRemove(tableRandom(4) != 0 ? tablePresentFrom(vid) : vid);
+        if (s_refCount == ALLOW_OPERATION_MAX_VLAN_NUM)
+            full++;
+        if (op % TABLE_CHECK_EVERY == 0)
+            tableCheck();
+    }
+    tableCheck();
+    printf("random: %d operations, %u of them on a full table, %u VIDs left\n", TABLE_OPS, (unsigned)full,
+           (unsigned)s_refCount);
+    HOST_CHECK(full > 0);
+}
+
+/* the smallest and largest VIDs, and VIDs on both sides of a bitmap word */
+static void tableEdges(void)
+{
+    static const MSD_U16 edges[] = { PORT_DEFAULT_VID, 31, 32, 33, 63, 64, 2047, 2048, MAX_OPERATION_VID - 1, MAX_OPERATION_VID };
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+
+    deviceVlanModuleVlanTableReset(&s_info);
+    memset(s_refPresent, 0, sizeof(s_refPresent));
+    s_refCount = 0;
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i)
+        tableSet(edges[i]);
+    tableCheck();
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i += 2)
+        tableRemove(edges[i]);
+    tableCheck();
+
+    memset(memberTag, 0, sizeof(memberTag));
+    HOST_CHECK(deviceVlanModuleVlanTableSet(&s_info, PORT_DEFAULT_VID - 1, memberTag, MSD_TRUE) == MSD_BAD_PARAM);
+    HOST_CHECK(deviceVlanModuleVlanTableSet(&s_info, MAX_OPERATION_VID + 1, memberTag, MSD_TRUE) == MSD_BAD_PARAM);
+    memberTag[3] = (MSD_PORT_MEMBER_TAG)4;
+    HOST_CHECK(deviceVlanModuleVlanTableSet(&s_info, 100, memberTag, MSD_TRUE) == MSD_BAD_PARAM);
+    HOST_CHECK(deviceVlanModuleVlanTableFind(&s_info, MAX_VID_VALUE) == -1);
+    tableCheck();
+}
+
+static void tableSizes(void)
+{
+    HOST_CHECK(sizeof(VLAN_TABLE_LAYOUT(ALLOW_OPERATION_MAX_VLAN_NUM)) == sizeof(VlanMemberTagAndEgressModeInfo));
+    printf("sizeof(VlanMemberTagAndEgressModeInfo): %u bytes for 64 VIDs, %u for 512, %u for 4096, %u built with %d\n",
+           (unsigned)sizeof(VLAN_TABLE_LAYOUT(64)), (unsigned)sizeof(VLAN_TABLE_LAYOUT(512)),
+           (unsigned)sizeof(VLAN_TABLE_LAYOUT(4096)), (unsigned)sizeof(VlanMemberTagAndEgressModeInfo),
+           ALLOW_OPERATION_MAX_VLAN_NUM);
+}
+
+int main(void)
+{
+    tableSizes();
+    tableEdges();
+    tableRandomRun();
+    return hostResult("vlanTableTest");
+}
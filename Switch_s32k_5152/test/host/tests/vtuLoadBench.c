@@ -0,0 +1,183 @@
+/*
+ * vtuLoadBench.c - time to program 64 and 4096 VLANs into the VTU, over SMI
+ * and RMU. The same VLAN set is loaded once entry by entry with
+ * msdVlanEntryAdd and once packed with Fir_gvtuPackEntryIntf and streamed
+ * with Fir_gvtuLoadEntries in the 64 entry chunks used by deviceVlanModule.
+ * Both loads must leave identical VTU contents, one VTU operation per entry,
+ * and the bulk load must take less bus time. The same VLAN set, up to
+ * ALLOW_OPERATION_MAX_VLAN_NUM VLANs, is also timed through a full apply of
+ * deviceVlanModuleSetVlanEgressModeAndMemberTagInfo, which adds the port
+ * 802.1Q mode and default VID writes on top of the load.
+ */
+#include "hostTest.h"
+#include <msdBrgVtu.h>
+#include <Fir_msdBrgVtu.h>
+#include <deviceVlanModule.h>
+
+#define BENCH_LOAD_CHUNK    64
+#define BENCH_PORTS         11
+
+static MSD_VTU_ENTRY s_addDump[MSD_SIM_VTU_SIZE];
+static MSD_VTU_ENTRY s_loadDump[MSD_SIM_VTU_SIZE];
+static FIR_MSD_VTU_LOAD_WORDS s_words[BENCH_LOAD_CHUNK];
+static VlanMemberTagAndEgressModeInfo s_info;
+
+/* 64 VLANs are spread over the VID range, 4096 VLANs fill it */
+static MSD_U16 benchVid(MSD_U32 count, MSD_U32 index)
+{
+    return count == MSD_SIM_VTU_SIZE ? (MSD_U16)index : (MSD_U16)(2 + index * 13);
+}
+
+/* varied membership, priority override and SID so every register word changes */
+static void benchEntry(MSD_U16 vid, MSD_VTU_ENTRY* entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    entry->vid = vid;
+    entry->fid = vid;
+    for (MSD_U32 port = 0; port < BENCH_PORTS; ++port)
+        entry->memberTagP[port] = (MSD_PORT_MEMBER_TAG)((vid * 7 + port * 3) % 4);
+    if (vid % 5 == 0) {
+        entry->vidExInfo.useVIDQPri = MSD_TRUE;
+        entry->vidExInfo.vidQPri = (MSD_U8)(vid % 8);
+    }
+    entry->sid = (MSD_U8)(vid % 3 == 0 ? 0 : vid % 64);
+}
+
+static MSD_U32 benchDump(MSD_VTU_ENTRY* dump)
+{
+    MSD_U32 count = 0;
+    for (MSD_U32 vid = 0; vid < MSD_SIM_VTU_SIZE; ++vid) {
+        MSD_BOOL found = MSD_FALSE;
+        MSD_VTU_ENTRY entry;
+        memset(&entry, 0, sizeof(entry));
+        HOST_CHECK_OK(msdVlanEntryFind(HOST_DEV, (MSD_U16)vid, &entry, &found));
+        if (found)
+            dump[count++] = entry;
+    }
+    return count;
+}
+
+static double benchAdd(MSD_U32 count, MSD_SIM_STATS* ops)
+{
+    MSD_SIM_STATS before;
+    MSD_VTU_ENTRY entry;
+    msdSimStatsGet(&before);
+    hostClockReset();
+    for (MSD_U32 i = 0; i < count; ++i) {
+        benchEntry(benchVid(count, i), &entry);
+        HOST_CHECK_OK(msdVlanEntryAdd(HOST_DEV, &entry));
+    }
+    double us = hostClockUs();
+    msdSimStatsGet(ops);
+    ops->vtuOps -= before.vtuOps;
+    return us;
+}
+
+static double benchLoad(MSD_U32 count, MSD_SIM_STATS* ops)
+{
+    MSD_QD_DEV* dev = sohoDevGet(HOST_DEV);
+    MSD_SIM_STATS before;
+    MSD_VTU_ENTRY entry;
+    MSD_U32 packed = 0;
+    msdSimStatsGet(&before);
+    hostClockReset();
+    for (MSD_U32 i = 0; i < count; ++i) {
+        benchEntry(benchVid(count, i), &entry);
+        HOST_CHECK_OK(Fir_gvtuPackEntryIntf(dev, &entry, &s_words[packed++]));
+        if (packed == BENCH_LOAD_CHUNK || i + 1 == count) {
+            HOST_CHECK_OK(Fir_gvtuLoadEntries(dev, s_words, packed));
+            packed = 0;
+        }
+    }
+    double us = hostClockUs();
+    msdSimStatsGet(ops);
+    ops->vtuOps -= before.vtuOps;
+    return us;
+}
+
+/* the VLAN set of benchEntry as a module setting, VID 1 and the default VID are left out */
+static void benchBuildInfo(MSD_U32 count)
+{
+    MSD_VTU_ENTRY entry;
+    MSD_PORT_MEMBER_TAG memberTag[MSD_MAX_SWITCH_PORTS];
+    int portNum = sohoDevGet(HOST_DEV)->numOfPorts;
+
+    memset(&s_info, 0, sizeof(s_info));
+    deviceVlanModuleVlanTableReset(&s_info);
+    for (int port = 0; port < portNum; ++port) {
+        s_info.portVlanInfo[port].defaultVid = PORT_DEFAULT_VID;
+        s_info.portVlanInfo[port].egressMode = VLAN_EGRESS_MODE_ALLOW_MEMBERSHIP;
+    }
+    for (MSD_U32 i = 0; i < count; ++i) {
+        benchEntry((MSD_U16)(PORT_DEFAULT_VID + 1 + i * 7), &entry);
+        for (int port = 0; port < MSD_MAX_SWITCH_PORTS; ++port)
+            memberTag[port] = entry.memberTagP[port];
+        HOST_CHECK_OK(deviceVlanModuleVlanTableSet(&s_info, entry.vid, memberTag, MSD_TRUE));
+    }
+}
+
+static void benchApply(MSD_INTERFACE channel, MSD_U32 count)
+{
+    MSD_SIM_STATS before, after;
+    VlanApplyStats stats;
+
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, channel));
+    benchBuildInfo(count);
+    /* setting the 802.1Q mode outside the apply makes every run a full rebuild */
+    HOST_CHECK_OK(deviceVlanModuleSet8021Mode(HOST_DEV, ALL_PORT_PARAM, MSD_8021Q_CHECK));
+    msdSimStatsGet(&before);
+    hostClockReset();
+    HOST_CHECK_OK(deviceVlanModuleSetVlanEgressModeAndMemberTagInfo(HOST_DEV, &s_info));
+    double us = hostClockUs();
+    msdSimStatsGet(&after);
+    HOST_CHECK_OK(deviceVlanModuleGetApplyStats(HOST_DEV, &stats));
+
+    printf("%s %4u VLANs: full apply %10.1f us, %u VTU operations, %u port mode writes\n",
+           channel == MSD_INTERFACE_RMU ? "RMU" : "SMI", (unsigned)count, us,
+           (unsigned)(after.vtuOps - before.vtuOps), (unsigned)stats.portModeWrites);
+    HOST_CHECK(stats.isFullRebuild == MSD_TRUE);
+    HOST_CHECK(stats.vtuAdds >= count);
+    /* one VTU operation per added entry and one for the flush */
+    HOST_CHECK(after.vtuOps - before.vtuOps == (MSD_U32)stats.vtuAdds + stats.vtuDeletes);
+}
+
+static void benchRun(MSD_INTERFACE channel, MSD_U32 count)
+{
+    MSD_SIM_STATS addOps, loadOps;
+
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, channel));
+    HOST_CHECK_OK(msdVlanAllDelete(HOST_DEV));
+    double addUs = benchAdd(count, &addOps);
+    MSD_U32 addCount = benchDump(s_addDump);
+
+    HOST_CHECK_OK(msdVlanAllDelete(HOST_DEV));
+    double loadUs = benchLoad(count, &loadOps);
+    MSD_U32 loadCount = benchDump(s_loadDump);
+
+    printf("%s %4u VLANs: msdVlanEntryAdd %10.1f us, bulk load %10.1f us\n",
+           channel == MSD_INTERFACE_RMU ? "RMU" : "SMI", (unsigned)count, addUs, loadUs);
+    HOST_CHECK(addCount == count);
+    HOST_CHECK(loadCount == count);
+    HOST_CHECK(memcmp(s_addDump, s_loadDump, sizeof(MSD_VTU_ENTRY) * addCount) == 0);
+    HOST_CHECK(addOps.vtuOps == count);
+    HOST_CHECK(loadOps.vtuOps == count);
+    HOST_CHECK(loadUs < addUs);
+}
+
+int main(void)
+{
+    if (hostOpen() != 0)
+        return 1;
+    benchRun(MSD_INTERFACE_SMI, BENCH_LOAD_CHUNK);
+    benchRun(MSD_INTERFACE_SMI, MSD_SIM_VTU_SIZE);
+    benchRun(MSD_INTERFACE_RMU, BENCH_LOAD_CHUNK);
+    benchRun(MSD_INTERFACE_RMU, MSD_SIM_VTU_SIZE);
+    HOST_CHECK_OK(deviceVlanModuleSetQModeIsGlobal(HOST_DEV, MSD_TRUE, VLANMODEL_VLAN));
+    benchApply(MSD_INTERFACE_SMI, BENCH_LOAD_CHUNK);
+    benchApply(MSD_INTERFACE_SMI, ALLOW_OPERATION_MAX_VLAN_NUM);
+    benchApply(MSD_INTERFACE_RMU, BENCH_LOAD_CHUNK);
+    benchApply(MSD_INTERFACE_RMU, ALLOW_OPERATION_MAX_VLAN_NUM);
+    HOST_CHECK_OK(msdSetDriverInterface(HOST_DEV, MSD_INTERFACE_SMI));
+    hostClose();
+    return hostResult("vtuLoadBench");
+}